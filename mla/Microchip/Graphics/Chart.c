@@ -47,6 +47,7 @@
  *****************************************************************************/
 #include "Graphics/Graphics.h"
 #include <math.h>
+#include <string.h>
 
 #ifdef USE_CHART
 
@@ -58,6 +59,13 @@ GFX_COLOR   GetColorShade(GFX_COLOR color, BYTE shade);
 WORD        ChParseShowData(DATASERIES *pData);
 DATASERIES  *ChGetNextShowData(DATASERIES *pData);
 SHORT       ChSetDataSeries(CHART *pCh, WORD seriesNum, BYTE status);
+static void ChLinePlotArea(CHART *pCh, SHORT *pLeft, SHORT *pTop, SHORT *pRight, SHORT *pBottom);
+static WORD ChLineCacheBuild(CHART *pCh, DATASERIES *pVar, SHORT columns, SHORT rows);
+static void ChRingColumn(CHART *pCh, DATASERIES *pVar, WORD age, SHORT rows, CHARTCOLUMN *pColumn);
+static WORD ChLineDrawColumn(CHART *pCh, WORD column, SHORT left, SHORT top, SHORT bottom);
+
+// number of ring series samples summarized by one pixel column of a line chart
+#define ChRingSamplesPerColumn(pVar)    (((pVar)->samples + (pVar)->columns - 1) / (pVar)->columns)
 
 // array used to define the default colors used to draw the bars or sectors of the chart
 const GFX_COLOR  ChartVarClr[16] =  
@@ -451,6 +459,12 @@ WORD ChDraw(void *pObj)
         PIE_DRAW_SECTOR_LOOP_CONTINUE,
         PIE_DRAW_SECTOR_LOOP_CREATE_STRINGS,
         PIE_DRAW_SECTOR_LOOP_STRINGS_RUN,
+
+        // LINE type states
+        LINE_PREP,
+        LINE_AXIS_DRAW,
+        LINE_DATA_PREP,
+        LINE_DATA_DRAW,
     } CH_DRAW_STATES;
 
     static XCHAR tempXchar[2] = {'B',0};
@@ -477,6 +491,8 @@ WORD ChDraw(void *pObj)
     static WORD pieSectorXPos;
     static WORD pieSectorYPos;
 
+    static SHORT lineLeft, lineTop, lineRight, lineBottom;
+
     CHART *pCh;
 
     pCh = (CHART *)pObj;
@@ -514,8 +530,23 @@ WORD ChDraw(void *pObj)
             SetLineThickness(NORMAL_LINE);
             SetLineType(SOLID_LINE);
 
-            // check if we only need to refresh the data on the chart
-            if(GetState(pCh, CH_DRAW_DATA))
+            // line charts refresh the data from the column caches, only the newest
+            // column is drawn when a sample was appended to a ring series. A full
+            // redraw (CH_DRAW) takes the normal path so the frame and labels are drawn.
+            if(GetState(pCh, CH_LINE) && !GetState(pCh, CH_BAR | CH_PIE | CH_DRAW) && GetState(pCh, CH_DRAW_DATA | CH_DRAW_COLUMN))
+            {
+                ChLinePlotArea(pCh, &lineLeft, &lineTop, &lineRight, &lineBottom);
+                if(GetState(pCh, CH_DRAW_DATA))
+                    ctr = 0;
+                else
+                    ctr = lineRight - lineLeft;
+                state = LINE_DATA_PREP;
+                goto chrt_line_data_prep;
+            }
+
+            // check if we only need to refresh the data on the chart, line charts that
+            // get here are redrawn completely
+            if(GetState(pCh, CH_DRAW_DATA) && (!GetState(pCh, CH_LINE) || GetState(pCh, CH_BAR | CH_PIE)))
             {
 
                 // this is only performed when refreshing data in the chart
@@ -785,6 +816,11 @@ WORD ChDraw(void *pObj)
                 state = PIE_PREP;
                 goto chrt_pie_prep;
             }
+            else if(GetState(pCh, CH_LINE))
+            {
+                state = LINE_PREP;
+                goto chrt_line_prep;
+            }
             else
             {
                 state = REMOVE;
@@ -2760,6 +2796,75 @@ WORD ChDraw(void *pObj)
                                             pCh->hdr.bottom);
 #endif
             return (1);
+
+            /**************************************************************************/
+            // 					LINE CHART states
+            /**************************************************************************/
+
+            /*========================================================================*/
+            //					  Draw the axes
+            /*========================================================================*/
+    chrt_line_prep:
+
+        case LINE_PREP:
+            ChLinePlotArea(pCh, &lineLeft, &lineTop, &lineRight, &lineBottom);
+
+            // value axis
+            SetColor(pCh->hdr.pGolScheme->Color0);
+            if(!Bar(lineLeft - 1, lineTop, lineLeft - 1, lineBottom + 1))
+                return (0);
+            state = LINE_AXIS_DRAW;
+
+        case LINE_AXIS_DRAW:
+
+            // sample axis
+            SetColor(pCh->hdr.pGolScheme->Color0);
+            if(!Bar(lineLeft - 1, lineBottom + 1, lineRight, lineBottom + 1))
+                return (0);
+
+            ctr = 0;
+            state = LINE_DATA_PREP;
+
+            /*========================================================================*/
+            //					  Draw the traces
+            /*========================================================================*/
+    chrt_line_data_prep:
+
+        case LINE_DATA_PREP:
+
+            // Rebuild the column caches that are no longer valid. The samples are 
+            // only read here and in ChAppendSample(), drawing a column costs one
+            // span per data series regardless of the number of samples. A rebuilt
+            // cache is drawn completely.
+            pVar = pCh->pChData;
+            while(pVar != NULL)
+            {
+                if(ChGetShowSeriesStatus(pVar) == SHOW_DATA)
+                {
+                    if(ChLineCacheBuild(pCh, pVar, lineRight - lineLeft + 1, lineBottom - lineTop + 1))
+                        ctr = 0;
+                }
+                pVar = (DATASERIES *)pVar->pNextData;
+            }
+
+            state = LINE_DATA_DRAW;
+
+        case LINE_DATA_DRAW:
+            while((SHORT)(lineLeft + ctr) <= lineRight)
+            {
+                if(!ChLineDrawColumn(pCh, ctr, lineLeft, lineTop, lineBottom))
+                    return (0);
+                ctr++;
+            }
+
+            state = REMOVE;
+#ifdef USE_BISTABLE_DISPLAY_GOL_AUTO_REFRESH
+            GFX_DRIVER_CompleteDrawUpdate(   pCh->hdr.left,
+                                            pCh->hdr.top,
+                                            pCh->hdr.right,
+                                            pCh->hdr.bottom);
+#endif
+            return (1);
     }
 
 #ifdef USE_BISTABLE_DISPLAY_GOL_AUTO_REFRESH
@@ -2771,6 +2876,249 @@ WORD ChDraw(void *pObj)
     return (1);
 }
 
+/*********************************************************************
+* Function: static void ChLinePlotArea(CHART *pCh, SHORT *pLeft, SHORT *pTop, 
+*                                      SHORT *pRight, SHORT *pBottom)
+*
+* Notes: Returns the area of a line chart where the traces are drawn.
+*		 The axes are drawn on the left and below of this area.
+*
+********************************************************************/
+static void ChLinePlotArea(CHART *pCh, SHORT *pLeft, SHORT *pTop, SHORT *pRight, SHORT *pBottom)
+{
+    *pLeft = pCh->hdr.left + GOL_EMBOSS_SIZE + (CH_MARGIN << 1) + 1;
+    *pTop = pCh->hdr.top + (CH_MARGIN << 1) + GetTextHeight(pCh->prm.pTitleFont);
+    *pBottom = pCh->hdr.bottom - GOL_EMBOSS_SIZE - (CH_MARGIN << 1) - 1;
+
+    // leave space for the legend
+    if(GetState(pCh, CH_LEGEND) && (ChGetShowSeriesCount(pCh) != 1))
+        *pRight = pCh->hdr.right - (CH_MARGIN << 2) - GetLongestNameLength(pCh) - GetTextHeight(pCh->hdr.pGolScheme->pFont);
+    else
+        *pRight = pCh->hdr.right - GOL_EMBOSS_SIZE - (CH_MARGIN << 1);
+}
+
+/*********************************************************************
+* Function: static SHORT ChLineRow(CHART *pCh, WORD value, SHORT rows)
+*
+* Notes: Returns the row of the value in a plot area of the given 
+*		 height, values outside the value range are clipped.
+*
+********************************************************************/
+static SHORT ChLineRow(CHART *pCh, WORD value, SHORT rows)
+{
+    if(value <= ChGetValueMin(pCh))
+        return (rows - 1);
+    if(value >= ChGetValueMax(pCh))
+        return (0);
+
+    return ((rows - 1) - (SHORT)(((DWORD)(value - ChGetValueMin(pCh)) * (rows - 1)) / ChGetValueRange(pCh)));
+}
+
+/*********************************************************************
+* Function: static void ChLineSpan(CHART *pCh, DATASERIES *pVar, WORD first,
+*                                  WORD nSamples, SHORT rows, CHARTCOLUMN *pColumn)
+*
+* Notes: Finds the smallest and the largest of nSamples samples starting
+*		 at sample first and stores their rows in pColumn. The samples
+*		 of a ring series are counted from the oldest one.
+*
+********************************************************************/
+static void ChLineSpan(CHART *pCh, DATASERIES *pVar, WORD first, WORD nSamples, SHORT rows, CHARTCOLUMN *pColumn)
+{
+    WORD    *pSmple, *pEnd;
+    WORD    minValue = 0xFFFF, maxValue = 0;
+
+    if(nSamples == 0)
+    {
+        pColumn->top = CH_COLUMN_EMPTY;
+        pColumn->bottom = CH_COLUMN_EMPTY;
+        return;
+    }
+
+    if(pVar->ring)
+        pSmple = pVar->pData + (WORD)((pVar->total - pVar->count + first) % pVar->samples);
+    else
+        pSmple = pVar->pData + first;
+    pEnd = pVar->pData + pVar->samples;
+
+    while(nSamples--)
+    {
+        if(*pSmple < minValue)
+            minValue = *pSmple;
+        if(*pSmple > maxValue)
+            maxValue = *pSmple;
+
+        // ring series wrap around the end of the buffer
+        if(++pSmple == pEnd)
+            pSmple = pVar->pData;
+    }
+
+    pColumn->top = ChLineRow(pCh, maxValue, rows);
+    pColumn->bottom = ChLineRow(pCh, minValue, rows);
+}
+
+/*********************************************************************
+* Function: static void ChRingColumn(CHART *pCh, DATASERIES *pVar, WORD age, 
+*                                    SHORT rows, CHARTCOLUMN *pColumn)
+*
+* Notes: Computes a column of a ring series, age 0 is the newest column.
+*		 Columns hold ChRingSamplesPerColumn() samples and are aligned 
+*		 on the total number of appended samples, the newest column is 
+*		 the only one that can be partially filled. Only the columns 
+*		 that stay complete until they scroll out are shown, so a 
+*		 column never changes once the next one is started.
+*
+********************************************************************/
+static void ChRingColumn(CHART *pCh, DATASERIES *pVar, WORD age, SHORT rows, CHARTCOLUMN *pColumn)
+{
+    WORD    perColumn, newest;
+    DWORD   skip;
+
+    perColumn = ChRingSamplesPerColumn(pVar);
+
+    if((pVar->count == 0) || (age >= (pVar->samples / perColumn)))
+    {
+        ChLineSpan(pCh, pVar, 0, 0, rows, pColumn);
+        return;
+    }
+
+    // number of samples in the newest column
+    newest = (WORD)((pVar->total - 1) % perColumn) + 1;
+
+    if(age == 0)
+    {
+        ChLineSpan(pCh, pVar, pVar->count - newest, newest, rows, pColumn);
+        return;
+    }
+
+    skip = newest + (DWORD)age * perColumn;
+    if(skip > pVar->count)
+        ChLineSpan(pCh, pVar, 0, 0, rows, pColumn);
+    else
+        ChLineSpan(pCh, pVar, (WORD)(pVar->count - skip), perColumn, rows, pColumn);
+}
+
+/*********************************************************************
+* Function: static void ChLineCacheBuild(CHART *pCh, DATASERIES *pVar, 
+*                                        SHORT columns, SHORT rows)
+*
+* Notes: Decimates the data series to one min/max span per pixel column
+*		 unless the cache is still valid for the given plot width. 
+*		 Array series spread the sample range over the columns, ring 
+*		 series are aligned to the right edge of the plot. Returns 1 if
+*		 the cache was rebuilt.
+*
+********************************************************************/
+static WORD ChLineCacheBuild(CHART *pCh, DATASERIES *pVar, SHORT columns, SHORT rows)
+{
+    WORD    column, first, last, range;
+    DWORD   start, end;
+
+    if(pVar->cached && (pVar->columns == (WORD)columns))
+        return (0);
+
+    pVar->cached = 0;
+    if((columns <= 0) || (rows <= 0))
+        return (0);
+
+    if(pVar->columns != (WORD)columns)
+    {
+        if(pVar->pColumn != NULL)
+            GFX_free(pVar->pColumn);
+        pVar->pColumn = (CHARTCOLUMN *)GFX_malloc(columns * sizeof(CHARTCOLUMN));
+        if(pVar->pColumn == NULL)
+        {
+            pVar->columns = 0;
+            return (0);
+        }
+
+        pVar->columns = columns;
+    }
+
+    if(pVar->ring)
+    {
+        for(column = 0; column < (WORD)columns; column++)
+            ChRingColumn(pCh, pVar, columns - 1 - column, rows, &pVar->pColumn[column]);
+    }
+    else
+    {
+        // sample range is 1 based, an unset range shows all the samples
+        first = (ChGetSampleStart(pCh) != 0) ? ChGetSampleStart(pCh) - 1 : 0;
+        last = ((ChGetSampleEnd(pCh) != 0) && (ChGetSampleEnd(pCh) < pVar->samples)) ? ChGetSampleEnd(pCh) : pVar->samples;
+        range = (last > first) ? last - first : 0;
+
+        for(column = 0; column < (WORD)columns; column++)
+        {
+            start = ((DWORD)column * range) / columns;
+            end = ((DWORD)(column + 1) * range) / columns;
+
+            // with fewer samples than columns every column shows the sample under it
+            if((end == start) && range)
+                end = start + 1;
+
+            ChLineSpan(pCh, pVar, first + (WORD)start, (WORD)(end - start), rows, &pVar->pColumn[column]);
+        }
+    }
+
+    pVar->cached = 1;
+    return (1);
+}
+
+/*********************************************************************
+* Function: static WORD ChLineDrawColumn(CHART *pCh, WORD column, 
+*                                        SHORT left, SHORT top, SHORT bottom)
+*
+* Notes: Erases one pixel column of the plot area and draws the span of 
+*		 every shown data series in it. Each span is extended to reach 
+*		 the span of the previous column so that the trace stays 
+*		 connected. Returns 0 if the column has to be drawn again.
+*
+********************************************************************/
+static WORD ChLineDrawColumn(CHART *pCh, WORD column, SHORT left, SHORT top, SHORT bottom)
+{
+    DATASERIES  *pVar;
+    CHARTCOLUMN *pColumn;
+    SHORT       x, y1, y2;
+    WORD        clrCtr = 0;
+
+    x = left + column;
+
+    SetColor(pCh->hdr.pGolScheme->CommonBkColor);
+    if(!Bar(x, top, x, bottom))
+        return (0);
+
+    for(pVar = pCh->pChData; pVar != NULL; pVar = (DATASERIES *)pVar->pNextData)
+    {
+        if(ChGetShowSeriesStatus(pVar) != SHOW_DATA)
+            continue;
+
+        if(pVar->cached && (column < pVar->columns))
+        {
+            pColumn = &pVar->pColumn[column];
+            if(pColumn->top != CH_COLUMN_EMPTY)
+            {
+                y1 = pColumn->top;
+                y2 = pColumn->bottom;
+                if(column && (pColumn[-1].top != CH_COLUMN_EMPTY))
+                {
+                    if(y1 > pColumn[-1].bottom)
+                        y1 = pColumn[-1].bottom;
+                    if(y2 < pColumn[-1].top)
+                        y2 = pColumn[-1].top;
+                }
+
+                SetColor(pCh->prm.pColor[clrCtr]);
+                if(!Bar(x, top + y1, x, top + y2))
+                    return (0);
+            }
+        }
+
+        clrCtr++;
+    }
+
+    return (1);
+}
+
 /*********************************************************************
 * Function: ChAddDataSeries(CHART *pCh, WORD nSamples, WORD *pData, XCHAR *pName)
 *
@@ -2797,6 +3145,12 @@ DATASERIES *ChAddDataSeries(CHART *pCh, WORD nSamples, WORD *pData, XCHAR *pName
     pVar->pData = (WORD *)pData;
     pVar->show = SHOW_DATA;
     pVar->pNextData = NULL;
+    pVar->total = 0;
+    pVar->count = 0;
+    pVar->ring = 0;
+    pVar->cached = 0;
+    pVar->pColumn = NULL;
+    pVar->columns = 0;
 
     pListVar = pCh->pChData;
     if(pCh->pChData == NULL)
@@ -2814,6 +3168,83 @@ DATASERIES *ChAddDataSeries(CHART *pCh, WORD nSamples, WORD *pData, XCHAR *pName
     pCh->prm.seriesCount++;
     return (DATASERIES *)pVar;
 }
+
+/*********************************************************************
+* Function: ChAddRingSeries(CHART *pCh, WORD nSamples, WORD *pBuffer, XCHAR *pName)
+*
+*
+* Notes: Adds a data series that keeps the last nSamples samples given
+*		 to ChAppendSample() in pBuffer. 
+*
+********************************************************************/
+DATASERIES *ChAddRingSeries(CHART *pCh, WORD nSamples, WORD *pBuffer, XCHAR *pName)
+{
+    DATASERIES  *pVar;
+
+    if(nSamples == 0)
+        return (NULL);
+
+    pVar = ChAddDataSeries(pCh, nSamples, pBuffer, pName);
+    if(pVar != NULL)
+        pVar->ring = 1;
+
+    return (pVar);
+}
+
+/*********************************************************************
+* Function: void ChAppendSample(CHART *pCh, DATASERIES *pSeries, WORD value)
+*
+*
+* Notes: Stores the sample in the ring series and updates the newest 
+*		 column of the line chart cache. The whole trace is redrawn 
+*		 only when the sample starts a new column.
+*
+********************************************************************/
+void ChAppendSample(CHART *pCh, DATASERIES *pSeries, WORD value)
+{
+    SHORT   left, top, right, bottom;
+    WORD    perColumn, oldest;
+
+    // the new sample replaces the oldest one when the buffer is full
+    pSeries->pData[(WORD)(pSeries->total % pSeries->samples)] = value;
+    pSeries->total++;
+    if(pSeries->count < pSeries->samples)
+        pSeries->count++;
+
+    if(!GetState(pCh, CH_LINE) || (ChGetShowSeriesStatus(pSeries) != SHOW_DATA))
+    {
+        pSeries->cached = 0;
+        return;
+    }
+
+    if(!pSeries->cached)
+    {
+        SetState(pCh, CH_DRAW_DATA);
+        return;
+    }
+
+    ChLinePlotArea(pCh, &left, &top, &right, &bottom);
+    perColumn = ChRingSamplesPerColumn(pSeries);
+
+    if(((pSeries->total - 1) % perColumn) == 0)
+    {
+        // the sample starts a new column, scroll the columns to the left and 
+        // drop the one that is no longer shown
+        memmove(pSeries->pColumn, pSeries->pColumn + 1, (pSeries->columns - 1) * sizeof(CHARTCOLUMN));
+
+        oldest = pSeries->samples / perColumn;
+        if(oldest < pSeries->columns)
+            ChRingColumn(pCh, pSeries, oldest, bottom - top + 1, &pSeries->pColumn[pSeries->columns - 1 - oldest]);
+
+        SetState(pCh, CH_DRAW_DATA);
+    }
+    else
+    {
+        SetState(pCh, CH_DRAW_COLUMN);
+    }
+
+    ChRingColumn(pCh, pSeries, 0, bottom - top + 1, &pSeries->pColumn[pSeries->columns - 1]);
+}
 /*********************************************************************
 * Function: void ChFreeDataSeries(void *pObj)
 *
@@ -2838,6 +3269,8 @@ void ChFreeDataSeries(void *pObj)
     // check if there is only one entry
     if(pVar->pNextData == NULL)
     {
+        if(pVar->pColumn != NULL)
+            GFX_free(pVar->pColumn);
         GFX_free(pVar);
         pCh->pChData = NULL;
         return;
@@ -2850,6 +3283,8 @@ void ChFreeDataSeries(void *pObj)
         pVar = pVar->pNextData;
 
         // free the memory used by the item
+        if(pPrevVar->pColumn != NULL)
+            GFX_free(pPrevVar->pColumn);
         GFX_free(pPrevVar);
     }
 }
@@ -2876,6 +3311,8 @@ void ChRemoveDataSeries(CHART *pCh, WORD number)
     // check if there is only one entry
     if(pVar->pNextData == NULL)
     {
+        if(pVar->pColumn != NULL)
+            GFX_free(pVar->pColumn);
         GFX_free(pVar);
         pCh->pChData = NULL;
         return;
@@ -2891,6 +3328,8 @@ void ChRemoveDataSeries(CHART *pCh, WORD number)
             pVar = pVar->pNextData;
 
             // free the memory used by the item
+            if(pPrevVar->pColumn != NULL)
+                GFX_free(pPrevVar->pColumn);
             GFX_free(pPrevVar);
         }
 
@@ -2909,6 +3348,8 @@ void ChRemoveDataSeries(CHART *pCh, WORD number)
     pPrevVar->pNextData = pVar->pNextData;
 
     // free the memory used by the item
+    if(pVar->pColumn != NULL)
+        GFX_free(pVar->pColumn);
     GFX_free(pVar);
 
     return;
@@ -2970,6 +3411,12 @@ SHORT ChSetDataSeries(CHART *pCh, WORD seriesNum, BYTE status)
 ********************************************************************/
 void ChSetSampleRange(CHART *pCh, WORD start, WORD end)
 {
+    DATASERIES  *pVar;
+
+    // the line chart columns cover other samples now
+    for(pVar = pCh->pChData; pVar != NULL; pVar = (DATASERIES *)pVar->pNextData)
+        ChInvalidateSeries(pVar);
+
     pCh->prm.smplStart = start;
     if(end < start)
         pCh->prm.smplEnd = start;
@@ -2989,6 +3436,12 @@ void ChSetSampleRange(CHART *pCh, WORD start, WORD end)
 ********************************************************************/
 void ChSetValueRange(CHART *pCh, WORD min, WORD max)
 {
+    DATASERIES  *pVar;
+
+    // the line chart columns are stored as rows of the plot area
+    for(pVar = pCh->pChData; pVar != NULL; pVar = (DATASERIES *)pVar->pNextData)
+        ChInvalidateSeries(pVar);
+
     pCh->prm.valMin = min;
     if(max < min)
         pCh->prm.valMax = min;
@@ -0,0 +1,945 @@
+/*****************************************************************************
+ *  Module for Microchip Graphics Library
+ *  Host frame buffer display driver
+ *****************************************************************************
+ * FileName:        HostFrameBuffer.c
+ * Dependencies:    Graphics.h, stdio.h, string.h
+ * Processor:       Host (Linux, Windows)
+ * Compiler:        GCC
+ * Company:         Microchip Technology Incorporated
+ *
+ * Software License Agreement
+ *
+ * Copyright (C) 2012 Microchip Technology Inc.  All rights reserved.
+ * Microchip licenses to you the right to use, modify, copy and distribute
+ * Software only when embedded on a Microchip microcontroller or digital
+ * signal controller, which is integrated into your product or third party
+ * product (pursuant to the sublicense terms in the accompanying license
+ * agreement).  
+ *
+ * You should refer to the license agreement accompanying this Software
+ * for additional information regarding your rights and obligations.
+ *
+ * SOFTWARE AND DOCUMENTATION ARE PROVIDED "AS IS" WITHOUT WARRANTY OF ANY
+ * KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION, ANY WARRANTY
+ * OF MERCHANTABILITY, TITLE, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+ * PURPOSE. IN NO EVENT SHALL MICROCHIP OR ITS LICENSORS BE LIABLE OR
+ * OBLIGATED UNDER CONTRACT, NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION,
+ * BREACH OF WARRANTY, OR OTHER LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT
+ * DAMAGES OR EXPENSES INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL,
+ * INDIRECT, PUNITIVE OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA,
+ * COST OF PROCUREMENT OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY
+ * CLAIMS BY THIRD PARTIES (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF),
+ * OR OTHER SIMILAR COSTS.
+ *
+ * Date         Comment
+ *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * This driver renders into RGB565 pages in RAM so that the Graphics Library
+ * (primitives, widgets, fonts and images) can be built and profiled on a 
+ * host computer. Select it with GFX_USE_DISPLAY_CONTROLLER_HOST_FRAMEBUFFER
+ * in the hardware profile.
+ *****************************************************************************/
+#include "HardwareProfile.h"
+
+#if defined (GFX_USE_DISPLAY_CONTROLLER_HOST_FRAMEBUFFER)
+
+#include <stdio.h>
+#include <string.h>
+#include "Graphics/DisplayDriver.h"
+#include "Graphics/HostFrameBuffer.h"
+#include "Graphics/Primitive.h"
+
+// Clipping region control
+SHORT       _clipRgn;
+
+// Clipping region borders
+SHORT       _clipLeft;
+SHORT       _clipTop;
+SHORT       _clipRight;
+SHORT       _clipBottom; 
+
+// Color
+GFX_COLOR   _color;
+#ifdef USE_TRANSPARENT_COLOR
+GFX_COLOR   _colorTransparent;
+SHORT       _colorTransparentEnable;
+#endif
+
+#ifdef GFX_DRV_PAGE_COUNT
+volatile DWORD  _PageTable[GFX_DRV_PAGE_COUNT];
+#endif
+
+// Driver call and pixel counters
+HOST_FB_STATS   HostFrameBufferStats;
+
+// Pixels of all the pages
+static WORD     _hostFrameBuffer[HOST_FB_PAGE_COUNT * HOST_FB_PAGE_SIZE];
+
+// Offsets of the pages that are drawn and displayed
+static DWORD    _hostActivePage;
+static DWORD    _hostVisualPage;
+
+/*********************************************************************
+* Macros:  HostPixelAddress(page, x, y)
+*
+* Overview: Returns the address of the pixel x,y in the page that 
+*           starts at the given pixel offset.
+*
+********************************************************************/
+#define HostPixelAddress(page, x, y)  (&_hostFrameBuffer[(page) + ((DWORD)(y) * DISP_HOR_RESOLUTION) + (x)])
+
+/*********************************************************************
+* Function:  void ResetDevice()
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: clears all the pages and the counters, page 0 becomes the
+*           active and visual page
+*
+* Note: none
+*
+********************************************************************/
+void ResetDevice(void)
+{
+#ifdef GFX_DRV_PAGE_COUNT
+    WORD    page;
+
+    for(page = 0; page < GFX_DRV_PAGE_COUNT; page++)
+        _PageTable[page] = page * HOST_FB_PAGE_SIZE;
+#endif
+
+    _hostActivePage = 0;
+    _hostVisualPage = 0;
+    memset(_hostFrameBuffer, 0, sizeof(_hostFrameBuffer));
+    HostFrameBufferResetStats();
+}
+
+#ifdef USE_TRANSPARENT_COLOR
+/*********************************************************************
+* Function:  void TransparentColorEnable(GFX_COLOR color)
+*
+* Overview: Sets current transparent color.
+*
+* PreCondition: none
+*
+* Input: color - Color value chosen.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void TransparentColorEnable(GFX_COLOR color)
+{
+    _colorTransparent = color;    
+    _colorTransparentEnable = TRANSPARENT_COLOR_ENABLE;
+}
+#endif
+
+/*********************************************************************
+* Function: void PutPixel(SHORT x, SHORT y)
+*
+* PreCondition: none
+*
+* Input: x,y - pixel coordinates
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: puts pixel
+*
+* Note: pixels outside of the screen are dropped even if clipping 
+*       is disabled
+*
+********************************************************************/
+void PutPixel(SHORT x, SHORT y)
+{
+    HostFrameBufferStats.putPixel++;
+
+    if(_clipRgn)
+    {
+        if(x < _clipLeft)
+            return;
+        if(x > _clipRight)
+            return;
+        if(y < _clipTop)
+            return;
+        if(y > _clipBottom)
+            return;
+    }
+
+    if((x < 0) || (x > GetMaxX()) || (y < 0) || (y > GetMaxY()))
+        return;
+
+    *HostPixelAddress(_hostActivePage, x, y) = _color;
+    HostFrameBufferStats.pixelsWritten++;
+}
+
+/*********************************************************************
+* Function: void PutSpan(SHORT left, SHORT right, SHORT y)
+*
+* PreCondition: none
+*
+* Input: left,right - x coordinates of the first and last pixel,
+*        y - row of the span
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: fills the span with the current color
+*
+* Note: the span is already clipped by the caller
+*
+********************************************************************/
+void PutSpan(SHORT left, SHORT right, SHORT y)
+{
+    WORD    *pPixel;
+
+    HostFrameBufferStats.putSpan++;
+
+    if((y < 0) || (y > GetMaxY()))
+        return;
+    if(left < 0)
+        left = 0;
+    if(right > GetMaxX())
+        right = GetMaxX();
+
+    pPixel = HostPixelAddress(_hostActivePage, left, y);
+    while(left++ <= right)
+    {
+        *pPixel++ = _color;
+        HostFrameBufferStats.pixelsWritten++;
+    }
+}
+
+/*********************************************************************
+* Function: void PutSpanColors(SHORT left, SHORT right, SHORT y, GFX_COLOR *pColor)
+*
+* PreCondition: none
+*
+* Input: left,right - x coordinates of the first and last pixel,
+*        y - row of the span,
+*        pColor - one color for each pixel of the span
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: writes the span with the given colors
+*
+* Note: the span is already clipped by the caller
+*
+********************************************************************/
+void PutSpanColors(SHORT left, SHORT right, SHORT y, GFX_COLOR *pColor)
+{
+    HostFrameBufferStats.putSpanColors++;
+
+    if((y < 0) || (y > GetMaxY()))
+        return;
+    if(left < 0)
+    {
+        pColor -= left;
+        left = 0;
+    }
+    if(right > GetMaxX())
+        right = GetMaxX();
+    if(left > right)
+        return;
+
+    memcpy(HostPixelAddress(_hostActivePage, left, y), pColor, (right - left + 1) * sizeof(WORD));
+    HostFrameBufferStats.pixelsWritten += right - left + 1;
+}
+
+/*********************************************************************
+* Function: void GetSpanColors(SHORT left, SHORT right, SHORT y, GFX_COLOR *pColor)
+*
+* PreCondition: none
+*
+* Input: left,right - x coordinates of the first and last pixel,
+*        y - row of the span,
+*        pColor - receives one color for each pixel of the span
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: reads the span with one memcpy()
+*
+* Note: the span is already clipped by the caller
+*
+********************************************************************/
+void GetSpanColors(SHORT left, SHORT right, SHORT y, GFX_COLOR *pColor)
+{
+    HostFrameBufferStats.getSpanColors++;
+
+    if((y < 0) || (y > GetMaxY()) || (left < 0) || (right > GetMaxX()) || (left > right))
+        return;
+
+    memcpy(pColor, HostPixelAddress(_hostActivePage, left, y), (right - left + 1) * sizeof(WORD));
+    HostFrameBufferStats.pixelsRead += right - left + 1;
+}
+
+/*********************************************************************
+* Function: WORD ScrollWindow(SHORT left, SHORT top, SHORT right, 
+*                             SHORT bottom, SHORT dx, SHORT dy)
+*
+* PreCondition: none
+*
+* Input: left,top - top left corner of the window,
+*        right,bottom - bottom right corner of the window,
+*        dx,dy - distance the contents are moved
+*
+* Output: Always returns 1.
+*
+* Side Effects: none
+*
+* Overview: Moves the contents of the window with one memmove() per row.
+*
+* Note: none
+*
+********************************************************************/
+WORD ScrollWindow(SHORT left, SHORT top, SHORT right, SHORT bottom, SHORT dx, SHORT dy)
+{
+    SHORT   width, rows, y, rowStep;
+
+    HostFrameBufferStats.scrollWindow++;
+
+    if(left < 0)
+        left = 0;
+    if(top < 0)
+        top = 0;
+    if(right > GetMaxX())
+        right = GetMaxX();
+    if(bottom > GetMaxY())
+        bottom = GetMaxY();
+
+    width = right - left + 1 - ((dx < 0) ? -dx : dx);
+    rows = bottom - top + 1 - ((dy < 0) ? -dy : dy);
+    if((width <= 0) || (rows <= 0))
+        return (1);
+
+    if(dx < 0)
+        left -= dx;
+
+    // moving down starts with the bottom row
+    if(dy > 0)
+    {
+        y = bottom - dy;
+        rowStep = -1;
+    }
+    else
+    {
+        y = top - dy;
+        rowStep = 1;
+    }
+
+    HostFrameBufferStats.pixelsRead += (DWORD)width * rows;
+    HostFrameBufferStats.pixelsWritten += (DWORD)width * rows;
+
+    while(rows--)
+    {
+        memmove(HostPixelAddress(_hostActivePage, left + dx, y + dy), HostPixelAddress(_hostActivePage, left, y), width * sizeof(WORD));
+        y += rowStep;
+    }
+
+    return (1);
+}
+
+/*********************************************************************
+* Function: GFX_COLOR GetPixel(SHORT x, SHORT y)
+*
+* PreCondition: none
+*
+* Input: x,y - pixel coordinates 
+*
+* Output: pixel color, 0 outside of the screen
+*
+* Side Effects: none
+*
+* Overview: returns pixel color at x,y position
+*
+* Note: none
+*
+********************************************************************/
+GFX_COLOR GetPixel(SHORT x, SHORT y)
+{
+    HostFrameBufferStats.getPixel++;
+
+    if((x < 0) || (x > GetMaxX()) || (y < 0) || (y > GetMaxY()))
+        return (0);
+
+    HostFrameBufferStats.pixelsRead++;
+    return (*HostPixelAddress(_hostActivePage, x, y));
+}
+
+/*********************************************************************
+* Function: IsDeviceBusy()
+*
+* Overview: Returns non-zero if LCD controller is busy 
+*           (previous drawing operation is not completed).
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: Busy status, always 0.
+*
+* Side Effects: none
+*
+********************************************************************/
+WORD IsDeviceBusy(void)
+{  
+    return (0);
+}
+
+/*********************************************************************
+* Function: WORD Bar(SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* PreCondition: none
+*
+* Input: left,top - top left corner coordinates,
+*        right,bottom - bottom right corner coordinates
+*
+* Output: Always returns 1.
+*
+* Side Effects: none
+*
+* Overview: draws rectangle filled with current color
+*
+* Note: none
+*
+********************************************************************/
+WORD Bar(SHORT left, SHORT top, SHORT right, SHORT bottom)
+{
+    WORD    *pPixel;
+    SHORT   x, y;
+
+    HostFrameBufferStats.bar++;
+
+#ifdef USE_ALPHABLEND_LITE
+    if(GetAlpha() != 100) 
+        return (BarAlpha(left, top, right, bottom));
+#endif
+
+    if(_clipRgn)
+    {
+        if(left < _clipLeft)
+            left = _clipLeft;
+        if(right > _clipRight)
+            right = _clipRight;
+        if(top < _clipTop)
+            top = _clipTop;
+        if(bottom > _clipBottom)
+            bottom = _clipBottom;
+    }
+
+    if(left < 0)
+        left = 0;
+    if(right > GetMaxX())
+        right = GetMaxX();
+    if(top < 0)
+        top = 0;
+    if(bottom > GetMaxY())
+        bottom = GetMaxY();
+
+    for(y = top; y <= bottom; y++)
+    {
+        pPixel = HostPixelAddress(_hostActivePage, left, y);
+        for(x = left; x <= right; x++)
+            *pPixel++ = _color;
+    }
+
+    if((left <= right) && (top <= bottom))
+        HostFrameBufferStats.pixelsWritten += (DWORD)(right - left + 1) * (bottom - top + 1);
+
+    return (1);
+}
+
+/*********************************************************************
+* Function: void ClearDevice(void)
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: clears the active page with the current color
+*
+* Note: none
+*
+********************************************************************/
+void ClearDevice(void)
+{
+    WORD    *pPixel;
+    DWORD   counter;
+
+    HostFrameBufferStats.clearDevice++;
+
+    pPixel = HostPixelAddress(_hostActivePage, 0, 0);
+    for(counter = 0; counter < HOST_FB_PAGE_SIZE; counter++)
+        *pPixel++ = _color;
+
+    HostFrameBufferStats.pixelsWritten += HOST_FB_PAGE_SIZE;
+}
+
+/*********************************************************************
+* Function: WORD CopyBlock(DWORD srcAddr, DWORD dstAddr, 
+*                          DWORD srcOffset, DWORD dstOffset, 
+*                          WORD width, WORD height)
+*
+* PreCondition: none
+*
+* Input: srcAddr - the base address of the data to be moved
+*        dstAddr - the base address of the new location of the moved data 
+*        srcOffset - offset in pixels of the data to be moved with respect 
+*                    to the source base address.
+*        dstOffset - offset in pixels of the new location of the moved data 
+*                    with respect to the destination base address.
+*        width - width of the block of data to be moved
+*        height - height of the block of data to be moved
+*
+* Output: Always returns 1.
+*
+* Side Effects: none
+*
+* Overview: Copies a block of pixels, rows are DISP_HOR_RESOLUTION 
+*           pixels apart. The source and destination may overlap.
+*
+* Note: Addresses are pixel offsets into the pages, see GetPageAddress().
+*
+********************************************************************/
+WORD CopyBlock(DWORD srcAddr, DWORD dstAddr, DWORD srcOffset, DWORD dstOffset, WORD width, WORD height)
+{
+    WORD    *pSrc, *pDst;
+    WORD    row;
+
+    HostFrameBufferStats.copyWindow++;
+
+    pSrc = &_hostFrameBuffer[srcAddr + srcOffset];
+    pDst = &_hostFrameBuffer[dstAddr + dstOffset];
+
+    if(pDst > pSrc)
+    {
+        // copy from the bottom row up so that overlapping rows are not lost
+        pSrc += (DWORD)(height - 1) * DISP_HOR_RESOLUTION;
+        pDst += (DWORD)(height - 1) * DISP_HOR_RESOLUTION;
+        for(row = 0; row < height; row++)
+        {
+            memmove(pDst, pSrc, width * sizeof(WORD));
+            pSrc -= DISP_HOR_RESOLUTION;
+            pDst -= DISP_HOR_RESOLUTION;
+        }
+    }
+    else
+    {
+        for(row = 0; row < height; row++)
+        {
+            memmove(pDst, pSrc, width * sizeof(WORD));
+            pSrc += DISP_HOR_RESOLUTION;
+            pDst += DISP_HOR_RESOLUTION;
+        }
+    }
+
+    HostFrameBufferStats.pixelsRead += (DWORD)width * height;
+    HostFrameBufferStats.pixelsWritten += (DWORD)width * height;
+    return (1);
+}
+
+/*********************************************************************
+* Function: WORD CopyWindow(DWORD srcAddr, DWORD dstAddr, 
+*                           WORD srcX, WORD srcY, 
+*                           WORD dstX, WORD dstY, 
+*                           WORD width, WORD height)  
+*
+* PreCondition: none
+*
+* Input: srcAddr - base address of the source window,
+*        dstAddr - base address of the destination window,
+*        srcX, srcY - left top corner of the source window 
+*        dstX, dstY - left top corner of the destination window 
+*        width - the width in pixels of the window to copy
+*        height - the height in pixels of the window to copy
+*
+* Output: Always returns 1.
+*
+* Side Effects: none
+*
+* Overview: Copies a rectangular window, the source and destination 
+*           window may overlap.
+*
+********************************************************************/
+WORD CopyWindow(DWORD srcAddr, DWORD dstAddr,       \
+                WORD srcX, WORD srcY,               \
+                WORD dstX, WORD dstY,               \
+                WORD width, WORD height)                
+{
+    return (CopyBlock(srcAddr, dstAddr,
+                      ((DWORD)srcY * DISP_HOR_RESOLUTION) + srcX,
+                      ((DWORD)dstY * DISP_HOR_RESOLUTION) + dstX,
+                      width, height));
+}
+
+#ifdef GFX_DRV_PAGE_COUNT
+
+/*********************************************************************
+* Function: void CopyPageWindow(BYTE srcPage, BYTE dstPage, 
+*                               WORD srcX, WORD srcY, 
+*                               WORD dstX, WORD dstY, 
+*                               WORD width, WORD height)  
+*
+* PreCondition: none
+*
+* Input: srcPage - page number of the source window,
+*        dstPage - page number of the destination window,
+*        srcX, srcY - left top corner of the source window 
+*        dstX, dstY - left top corner of the destination window 
+*        width - the width in pixels of the window to copy
+*        height - the height in pixels of the window to copy
+*
+* Output: None
+*
+* Side Effects: none
+*
+* Overview: Copies a rectangular window from one page to another.
+*
+********************************************************************/
+void CopyPageWindow( BYTE srcPage, BYTE dstPage,       
+                     WORD srcX, WORD srcY,               
+                     WORD dstX, WORD dstY,               
+                     WORD width, WORD height)
+{
+    CopyWindow(GetPageAddress(srcPage), GetPageAddress(dstPage), srcX, srcY, dstX, dstY, width, height);
+}
+
+/*********************************************************************
+* Function: void SetActivePage(WORD page)
+*
+* PreCondition: none
+*
+* Input: page - page number
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: Sets the page used for rendering.
+*
+********************************************************************/
+void SetActivePage(WORD page)
+{
+    _hostActivePage = GetPageAddress(page);
+}
+
+/*********************************************************************
+* Function: void SetVisualPage(WORD page)
+*
+* PreCondition: none
+*
+* Input: page - page number
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: Sets the page that is displayed. HostFrameBufferSavePPM() 
+*           can store any page, the visual page is only recorded.
+*
+********************************************************************/
+void SetVisualPage(WORD page)
+{
+    _hostVisualPage = GetPageAddress(page);
+}
+
+#endif // #ifdef GFX_DRV_PAGE_COUNT
+
+/*********************************************************************
+* Function: void HostFrameBufferResetStats(void)
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: Clears all the driver counters.
+*
+********************************************************************/
+void HostFrameBufferResetStats(void)
+{
+    memset(&HostFrameBufferStats, 0, sizeof(HostFrameBufferStats));
+}
+
+/*********************************************************************
+* Function: WORD *HostFrameBufferGetPage(WORD page)
+*
+* PreCondition: none
+*
+* Input: page - page number
+*
+* Output: pointer to the first pixel of the page
+*
+* Side Effects: none
+*
+* Overview: Gives direct access to the pixels of a page, for example to
+*           compare the rendering with a reference image.
+*
+********************************************************************/
+WORD *HostFrameBufferGetPage(WORD page)
+{
+    return (&_hostFrameBuffer[(DWORD)page * HOST_FB_PAGE_SIZE]);
+}
+
+/*********************************************************************
+* Function: static void HostFrameBufferRowRGB(WORD *pPixel, BYTE *pRGB)
+*
+* PreCondition: none
+*
+* Input: pPixel - first pixel of the row
+*        pRGB - room for DISP_HOR_RESOLUTION * 3 bytes
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: Expands one row of RGB565 pixels to 8 bits per channel. The 
+*           low bits of each channel are filled with its high bits so 
+*           that white stays 255, 255, 255.
+*
+********************************************************************/
+static void HostFrameBufferRowRGB(WORD *pPixel, BYTE *pRGB)
+{
+    WORD    color;
+    WORD    counter;
+
+    for(counter = 0; counter < DISP_HOR_RESOLUTION; counter++)
+    {
+        color = *pPixel++;
+        *pRGB++ = ((color >> 8) & 0xF8) | (color >> 13);
+        *pRGB++ = ((color >> 3) & 0xFC) | ((color >> 9) & 0x03);
+        *pRGB++ = ((color << 3) & 0xF8) | ((color >> 2) & 0x07);
+    }
+}
+
+/*********************************************************************
+* Function: BYTE HostFrameBufferSavePPM(const char *fileName, WORD page)
+*
+* PreCondition: none
+*
+* Input: fileName - name of the file to create,
+*        page - page number
+*
+* Output: 0 when the file was written, 1 otherwise
+*
+* Side Effects: none
+*
+* Overview: Stores the page as a binary PPM (P6) image.
+*
+********************************************************************/
+BYTE HostFrameBufferSavePPM(const char *fileName, WORD page)
+{
+    FILE    *pFile;
+    WORD    *pPixel;
+    BYTE    rgb[DISP_HOR_RESOLUTION * 3];
+    WORD    row;
+    BYTE    result = 0;
+
+    if(page >= HOST_FB_PAGE_COUNT)
+        return (1);
+
+    pFile = fopen(fileName, "wb");
+    if(pFile == NULL)
+        return (1);
+
+    fprintf(pFile, "P6\n%d %d\n255\n", DISP_HOR_RESOLUTION, DISP_VER_RESOLUTION);
+
+    pPixel = HostFrameBufferGetPage(page);
+    for(row = 0; row < DISP_VER_RESOLUTION; row++)
+    {
+        HostFrameBufferRowRGB(pPixel, rgb);
+        pPixel += DISP_HOR_RESOLUTION;
+        if(fwrite(rgb, 1, sizeof(rgb), pFile) != sizeof(rgb))
+        {
+            result = 1;
+            break;
+        }
+    }
+
+    if(fclose(pFile) != 0)
+        result = 1;
+
+    return (result);
+}
+
+/*********************************************************************
+* Function: static BYTE HostFrameBufferPNGWrite(FILE *pFile, const BYTE *pData, 
+*                                               WORD length, DWORD *pCRC)
+*
+* PreCondition: none
+*
+* Input: pFile - file to write to
+*        pData - bytes to write
+*        length - number of bytes
+*        pCRC - CRC-32 of the chunk, updated with the bytes
+*
+* Output: 0 when the bytes were written, 1 otherwise
+*
+* Side Effects: none
+*
+* Overview: Writes part of a PNG chunk and adds it to the chunk CRC.
+*
+********************************************************************/
+static BYTE HostFrameBufferPNGWrite(FILE *pFile, const BYTE *pData, WORD length, DWORD *pCRC)
+{
+    WORD    counter;
+    BYTE    bit;
+
+    for(counter = 0; counter < length; counter++)
+    {
+        *pCRC ^= pData[counter];
+        for(bit = 0; bit < 8; bit++)
+            *pCRC = (*pCRC & 1) ? (*pCRC >> 1) ^ 0xEDB88320ul : (*pCRC >> 1);
+    }
+    return (fwrite(pData, 1, length, pFile) != length);
+}
+
+/*********************************************************************
+* Function: static BYTE HostFrameBufferPNGDWORD(FILE *pFile, DWORD value, DWORD *pCRC)
+*
+* PreCondition: none
+*
+* Input: pFile - file to write to
+*        value - value to write
+*        pCRC - CRC-32 of the chunk, or NULL outside of the CRC
+*
+* Output: 0 when the value was written, 1 otherwise
+*
+* Side Effects: none
+*
+* Overview: Writes a 32 bit value with the high byte first, as all the
+*           numbers of a PNG file are stored.
+*
+********************************************************************/
+static BYTE HostFrameBufferPNGDWORD(FILE *pFile, DWORD value, DWORD *pCRC)
+{
+    BYTE    data[4];
+    DWORD   crc = 0;
+
+    data[0] = (BYTE)(value >> 24);
+    data[1] = (BYTE)(value >> 16);
+    data[2] = (BYTE)(value >> 8);
+    data[3] = (BYTE)value;
+    return (HostFrameBufferPNGWrite(pFile, data, 4, (pCRC != NULL) ? pCRC : &crc));
+}
+
+/*********************************************************************
+* Function: BYTE HostFrameBufferSavePNG(const char *fileName, WORD page)
+*
+* PreCondition: none
+*
+* Input: fileName - name of the file to create,
+*        page - page number
+*
+* Output: 0 when the file was written, 1 otherwise
+*
+* Side Effects: none
+*
+* Overview: Stores the page as a 24 bit PNG image. The image data is a
+*           zlib stream of stored (not compressed) deflate blocks, one 
+*           per row, so no compression library is needed. The files are
+*           about as large as PPM files.
+*
+********************************************************************/
+BYTE HostFrameBufferSavePNG(const char *fileName, WORD page)
+{
+    static const BYTE   signature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    static const BYTE   header[5] = {8, 2, 0, 0, 0};    // 8 bits per channel, RGB, no interlace
+    static const BYTE   zlibHeader[2] = {0x78, 0x01};   // deflate with a 32K window, no dictionary
+    static const BYTE   filter = 0;                     // rows are stored unfiltered
+    FILE                *pFile;
+    WORD                *pPixel;
+    BYTE                rgb[DISP_HOR_RESOLUTION * 3];
+    BYTE                block[5];
+    WORD                row, counter;
+    DWORD               crc, adlerA, adlerB;
+    BYTE                result = 0;
+
+    if(page >= HOST_FB_PAGE_COUNT)
+        return (1);
+
+    pFile = fopen(fileName, "wb");
+    if(pFile == NULL)
+        return (1);
+
+    result |= (fwrite(signature, 1, sizeof(signature), pFile) != sizeof(signature));
+
+    // IHDR chunk
+    result |= HostFrameBufferPNGDWORD(pFile, 13, NULL);
+    crc = 0xFFFFFFFFul;
+    result |= HostFrameBufferPNGWrite(pFile, (const BYTE *)"IHDR", 4, &crc);
+    result |= HostFrameBufferPNGDWORD(pFile, DISP_HOR_RESOLUTION, &crc);
+    result |= HostFrameBufferPNGDWORD(pFile, DISP_VER_RESOLUTION, &crc);
+    result |= HostFrameBufferPNGWrite(pFile, header, sizeof(header), &crc);
+    result |= HostFrameBufferPNGDWORD(pFile, ~crc, NULL);
+
+    // IDAT chunk: zlib header, a stored block for each row (filter byte 
+    // and pixels) and the Adler-32 of the rows
+    result |= HostFrameBufferPNGDWORD(pFile, 
+        sizeof(zlibHeader) + (DWORD)DISP_VER_RESOLUTION * (sizeof(block) + 1 + sizeof(rgb)) + 4, NULL);
+    crc = 0xFFFFFFFFul;
+    result |= HostFrameBufferPNGWrite(pFile, (const BYTE *)"IDAT", 4, &crc);
+    result |= HostFrameBufferPNGWrite(pFile, zlibHeader, sizeof(zlibHeader), &crc);
+
+    adlerA = 1;
+    adlerB = 0;
+    pPixel = HostFrameBufferGetPage(page);
+    for(row = 0; (row < DISP_VER_RESOLUTION) && (result == 0); row++)
+    {
+        HostFrameBufferRowRGB(pPixel, rgb);
+        pPixel += DISP_HOR_RESOLUTION;
+
+        block[0] = (row == DISP_VER_RESOLUTION - 1) ? 1 : 0;    // last block of the stream
+        block[1] = (BYTE)(1 + sizeof(rgb));
+        block[2] = (BYTE)((1 + sizeof(rgb)) >> 8);
+        block[3] = ~block[1];
+        block[4] = ~block[2];
+        result |= HostFrameBufferPNGWrite(pFile, block, sizeof(block), &crc);
+        result |= HostFrameBufferPNGWrite(pFile, &filter, 1, &crc);
+        result |= HostFrameBufferPNGWrite(pFile, rgb, sizeof(rgb), &crc);
+
+        adlerB = (adlerB + adlerA) % 65521;
+        for(counter = 0; counter < sizeof(rgb); counter++)
+        {
+            adlerA = (adlerA + rgb[counter]) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+    }
+    result |= HostFrameBufferPNGDWORD(pFile, (adlerB << 16) | adlerA, &crc);
+    result |= HostFrameBufferPNGDWORD(pFile, ~crc, NULL);
+
+    // IEND chunk
+    result |= HostFrameBufferPNGDWORD(pFile, 0, NULL);
+    crc = 0xFFFFFFFFul;
+    result |= HostFrameBufferPNGWrite(pFile, (const BYTE *)"IEND", 4, &crc);
+    result |= HostFrameBufferPNGDWORD(pFile, ~crc, NULL);
+
+    if(fclose(pFile) != 0)
+        result = 1;
+
+    return (result);
+}
+
+#endif // #if defined (GFX_USE_DISPLAY_CONTROLLER_HOST_FRAMEBUFFER)
@@ -426,6 +426,66 @@ void PutPixel(SHORT x, SHORT y)
     DisplayDisable();
 }
 
+/*********************************************************************
+* Function: void PutSpan(SHORT left, SHORT right, SHORT y)
+*
+* PreCondition: none
+*
+* Input: left,right - x coordinates of the first and last pixel,
+*        y - row of the span
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: fills the span with the current color, the address is set 
+*           once for the whole span
+*
+* Note: the span is already clipped by the caller
+*
+********************************************************************/
+void PutSpan(SHORT left, SHORT right, SHORT y)
+{
+    DisplayEnable();
+    SetAddress(left, y);
+    while(left++ <= right)
+    {
+        WritePixel(_color);
+    }
+    DisplayDisable();
+}
+
+/*********************************************************************
+* Function: void PutSpanColors(SHORT left, SHORT right, SHORT y, GFX_COLOR *pColor)
+*
+* PreCondition: none
+*
+* Input: left,right - x coordinates of the first and last pixel,
+*        y - row of the span,
+*        pColor - one color for each pixel of the span
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: writes the span with the given colors, the address is set 
+*           once for the whole span
+*
+* Note: the span is already clipped by the caller
+*
+********************************************************************/
+void PutSpanColors(SHORT left, SHORT right, SHORT y, GFX_COLOR *pColor)
+{
+    DisplayEnable();
+    SetAddress(left, y);
+    while(left++ <= right)
+    {
+        WritePixel(*pColor);
+        pColor++;
+    }
+    DisplayDisable();
+}
+
 /*********************************************************************
 * Function: WORD GetPixel(SHORT x, SHORT y)
 *
@@ -73,6 +73,25 @@ OBJ_HEADER  *_pObjectFocused = NULL;
 
 #ifdef USE_GRADIENT
 GFX_GRADIENT_STYLE _gradientScheme;
+#endif
+
+#ifdef USE_DOUBLE_BUFFERING
+
+// Areas redrawn in the current GOLDraw() pass
+static struct
+{
+    SHORT   left;
+    SHORT   top;
+    SHORT   right;
+    SHORT   bottom;
+} _golDamage[GOL_MAX_DAMAGE_AREAS];
+
+// Number of areas in _golDamage[]
+static BYTE _golDamageCount = 0;
+
+// Set when the object being drawn reported its own changed areas
+static BYTE _golDamageReported = 0;
+
 #endif
 
     #ifdef USE_FOCUS
@@ -529,6 +548,222 @@ void GOLAddObject(OBJ_HEADER *object)
     object->pNxtObj = NULL;
 }
 
+#ifdef USE_DOUBLE_BUFFERING
+
+/*********************************************************************
+* Function: static DWORD GOLRectArea(SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* Overview: returns the number of pixels in the rectangle, zero if the 
+*           rectangle is empty
+*
+********************************************************************/
+static DWORD GOLRectArea(SHORT left, SHORT top, SHORT right, SHORT bottom)
+{
+    if((left > right) || (top > bottom))
+        return (0);
+
+    return ((DWORD)(right - left + 1) * (DWORD)(bottom - top + 1));
+}
+
+/*********************************************************************
+* Function: static DWORD GOLDamageWaste(BYTE index, SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* Overview: returns the number of pixels that are in neither the damage
+*           area nor the given rectangle but would be copied if the two
+*           were merged
+*
+********************************************************************/
+static DWORD GOLDamageWaste(BYTE index, SHORT left, SHORT top, SHORT right, SHORT bottom)
+{
+    DWORD   merged, overlap;
+
+    merged = GOLRectArea
+            (
+                (_golDamage[index].left < left) ? _golDamage[index].left : left,
+                (_golDamage[index].top < top) ? _golDamage[index].top : top,
+                (_golDamage[index].right > right) ? _golDamage[index].right : right,
+                (_golDamage[index].bottom > bottom) ? _golDamage[index].bottom : bottom
+            );
+
+    overlap = GOLRectArea
+            (
+                (_golDamage[index].left > left) ? _golDamage[index].left : left,
+                (_golDamage[index].top > top) ? _golDamage[index].top : top,
+                (_golDamage[index].right < right) ? _golDamage[index].right : right,
+                (_golDamage[index].bottom < bottom) ? _golDamage[index].bottom : bottom
+            );
+
+    return ((merged + overlap) -
+            (GOLRectArea(_golDamage[index].left, _golDamage[index].top, _golDamage[index].right, _golDamage[index].bottom) +
+             GOLRectArea(left, top, right, bottom)));
+}
+
+/*********************************************************************
+* Function: static void GOLDamageRemove(BYTE index, SHORT *pLeft, SHORT *pTop, SHORT *pRight, SHORT *pBottom)
+*
+* Overview: removes the damage area from the list and grows the given
+*           rectangle to include it
+*
+********************************************************************/
+static void GOLDamageRemove(BYTE index, SHORT *pLeft, SHORT *pTop, SHORT *pRight, SHORT *pBottom)
+{
+    if(_golDamage[index].left < *pLeft)
+        *pLeft = _golDamage[index].left;
+    if(_golDamage[index].top < *pTop)
+        *pTop = _golDamage[index].top;
+    if(_golDamage[index].right > *pRight)
+        *pRight = _golDamage[index].right;
+    if(_golDamage[index].bottom > *pBottom)
+        *pBottom = _golDamage[index].bottom;
+
+    _golDamage[index] = _golDamage[--_golDamageCount];
+}
+
+/*********************************************************************
+* Function: void GOLAddDamage(SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* PreCondition: none
+*
+* Input: left,top,right,bottom - changed area
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: adds the area to the damage list of the current GOLDraw()
+*           pass. The area is merged with each area for which the merge
+*           wastes no more than GOL_DAMAGE_MERGE_COST pixels. If the
+*           list is full, it is merged with the area that wastes the
+*           least.
+*
+* Note: none
+*
+********************************************************************/
+void GOLAddDamage(SHORT left, SHORT top, SHORT right, SHORT bottom)
+{
+    BYTE    index, best;
+    DWORD   waste, bestWaste;
+
+    _golDamageReported = 1;
+
+    if((left > right) || (top > bottom))
+        return;
+
+    // the merged area can become cheap to merge with an area already checked, so start over after every merge
+    index = 0;
+    while(index < _golDamageCount)
+    {
+        if(GOLDamageWaste(index, left, top, right, bottom) <= GOL_DAMAGE_MERGE_COST)
+        {
+            GOLDamageRemove(index, &left, &top, &right, &bottom);
+            index = 0;
+        }
+        else
+        {
+            index++;
+        }
+    }
+
+    if(_golDamageCount >= GOL_MAX_DAMAGE_AREAS)
+    {
+        best = 0;
+        bestWaste = GOLDamageWaste(0, left, top, right, bottom);
+        for(index = 1; index < _golDamageCount; index++)
+        {
+            waste = GOLDamageWaste(index, left, top, right, bottom);
+            if(waste < bestWaste)
+            {
+                bestWaste = waste;
+                best = index;
+            }
+        }
+
+        GOLDamageRemove(best, &left, &top, &right, &bottom);
+    }
+
+    _golDamage[_golDamageCount].left = left;
+    _golDamage[_golDamageCount].top = top;
+    _golDamage[_golDamageCount].right = right;
+    _golDamage[_golDamageCount].bottom = bottom;
+    _golDamageCount++;
+}
+
+/*********************************************************************
+* Function: static void GOLFlushDamage(void)
+*
+* Overview: invalidates the damage areas of the completed GOLDraw() 
+*           pass and empties the list
+*
+********************************************************************/
+static void GOLFlushDamage(void)
+{
+    while(_golDamageCount)
+    {
+        _golDamageCount--;
+        InvalidateRectangle(_golDamage[_golDamageCount].left, _golDamage[_golDamageCount].top,
+                            _golDamage[_golDamageCount].right, _golDamage[_golDamageCount].bottom);
+    }
+}
+
+#endif // USE_DOUBLE_BUFFERING
+
+#ifdef USE_NONBLOCKING_CONFIG
+
+// time allowed for each GOLDraw() call in microseconds, 0 = no limit
+static DWORD    _golDrawBudget = 0;
+
+GOL_DRAW_STATS  GOLDrawStats;
+
+/*********************************************************************
+* Function: void GOLSetDrawBudget(DWORD budget)
+*
+* PreCondition: none
+*
+* Input: budget - time allowed for each GOLDraw() call in microseconds,
+*                 0 removes the limit
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: sets the time slice used by GOLDraw()
+*
+* Note: none
+*
+********************************************************************/
+void GOLSetDrawBudget(DWORD budget)
+{
+    _golDrawBudget = budget;
+}
+
+/*********************************************************************
+* Function: void GOLResetDrawStats(void)
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: clears the GOLDraw() statistics
+*
+* Note: none
+*
+********************************************************************/
+void GOLResetDrawStats(void)
+{
+    GOLDrawStats.calls = 0;
+    GOLDrawStats.yields = 0;
+    GOLDrawStats.lastSlice = 0;
+    GOLDrawStats.maxSlice = 0;
+}
+
+#endif // USE_NONBLOCKING_CONFIG
+
+static WORD GOLDrawObjects(void);
+
 /*********************************************************************
 * Function: WORD GOLDraw()
 *
@@ -540,12 +775,56 @@ void GOLAddObject(OBJ_HEADER *object)
 *
 * Side Effects: none
 *
-* Overview: redraws objects in the current linked list
+* Overview: redraws objects in the current linked list. In the 
+*           non-blocking configuration the call returns when the time
+*           set by GOLSetDrawBudget() is used up.
 *
 * Note: none
 *
 ********************************************************************/
 WORD GOLDraw(void)
+{
+#ifdef USE_NONBLOCKING_CONFIG
+    WORD    done;
+
+    GFXTimeSliceStart(_golDrawBudget);
+
+    done = GOLDrawObjects();
+
+    GOLDrawStats.calls++;
+    if(!done && GFXTimeSliceExpired())
+        GOLDrawStats.yields++;
+    GOLDrawStats.lastSlice = GFXTimeSliceElapsed();
+    if(GOLDrawStats.lastSlice > GOLDrawStats.maxSlice)
+        GOLDrawStats.maxSlice = GOLDrawStats.lastSlice;
+
+    // primitives called outside of GOLDraw() are not limited
+    GFXTimeSliceStart(0);
+
+    return (done);
+#else
+    return (GOLDrawObjects());
+#endif
+}
+
+/*********************************************************************
+* Function: static WORD GOLDrawObjects(void)
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: non-zero if drawing is complete
+*
+* Side Effects: none
+*
+* Overview: redraws objects in the current linked list starting with
+*           the object left by the previous call
+*
+* Note: none
+*
+********************************************************************/
+static WORD GOLDrawObjects(void)
 {
     static OBJ_HEADER   *pCurrentObj = NULL;
     SHORT               done;
@@ -604,8 +883,13 @@ WORD GOLDraw(void)
 
 			#ifdef USE_DOUBLE_BUFFERING
 
-			    InvalidateRectangle(pCurrentObj->left, pCurrentObj->top,
-			                        pCurrentObj->right, pCurrentObj->bottom);
+                // objects that redraw only a part of themselves may have reported the changed areas
+                if(!_golDamageReported)
+                {
+                    GOLAddDamage(pCurrentObj->left, pCurrentObj->top,
+                                 pCurrentObj->right, pCurrentObj->bottom);
+                }
+                _golDamageReported = 0;
                 DisplayUpdated = 1;
 
 			#endif //USE_DOUBLE_BUFFERING
@@ -618,8 +902,22 @@ WORD GOLDraw(void)
         }
 
         pCurrentObj = (OBJ_HEADER *)pCurrentObj->pNxtObj;
+
+	#ifdef USE_NONBLOCKING_CONFIG
+
+        // the time slice is used up, the next call continues with this object
+        if((pCurrentObj != NULL) && GFXTimeSliceExpired())
+            return (0);
+
+	#endif
     }
 
+	#ifdef USE_DOUBLE_BUFFERING
+
+        GOLFlushDamage();
+
+	#endif //USE_DOUBLE_BUFFERING
+
 	#if defined(USE_TRANSITION_EFFECTS) && defined(USE_DOUBLE_BUFFERING)
 
         TransitionPendingStatus = GFXIsTransitionPending();
@@ -130,6 +130,35 @@ GFX_FONT_CURRENT currentFont;
 // bevel drawing type (0 = full bevel, 0xF0 - top bevel only, 0x0F - bottom bevel only
 BYTE _bevelDrawType; 
 
+#ifdef USE_NONBLOCKING_CONFIG
+
+// drawing time slice (see GFXTimeSliceStart())
+static GFX_TICKS_CALLBACK _pSliceTicksFn = NULL;
+static DWORD    _sliceTicksPerSecond;
+static QWORD    _sliceStart;
+static QWORD    _sliceEnd;
+static BYTE     _sliceLimited = 0;
+
+// Bar() stopped by the end of a time slice, continued at _barResumeY
+static SHORT    _barResumeLeft, _barResumeTop, _barResumeRight, _barResumeBottom;
+static SHORT    _barResumeY;
+static GFX_COLOR _barResumeColor;
+static BYTE     _barResumePending = 0;
+
+// Bar() does not stop while a primitive that ignores its return value 
+// is drawing
+static BYTE     _sliceHold = 0;
+
+#define GFXTimeSliceHold()      (_sliceHold++)
+#define GFXTimeSliceRelease()   (_sliceHold--)
+
+#else
+
+#define GFXTimeSliceHold()
+#define GFXTimeSliceRelease()
+
+#endif
+
 #define COSINETABLEENTRIES	90
 // Cosine table used to calculate angles when rendering circular objects and  arcs  
 // Make cosine values * 256 instead of 100 for easier math later
@@ -199,7 +228,310 @@ void __attribute__((weak)) SetClip(BYTE control)
     _clipRgn=control;
 }
 
+/*********************************************************************
+* Function: void PutSpan(SHORT left, SHORT right, SHORT y)
+*
+* PreCondition: none
+*
+* Input: left - x position of the first pixel.
+*        right - x position of the last pixel.
+*        y - y position of the span.
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: Fills the horizontal run of pixels from left to right on
+*           row y with the current color. The callers clip the span
+*           once before calling this function so left <= right and
+*           the whole span is inside the clipping region when
+*           clipping is enabled.
+*
+* Note: This function has a weak attribute, the driver layer
+*       may implement this same function to write the span after
+*       setting the address only once.
+*
+********************************************************************/
+void __attribute__((weak)) PutSpan(SHORT left, SHORT right, SHORT y)
+{
+    while(left <= right)
+        PutPixel(left++, y);
+}
+
+/*********************************************************************
+* Function: void PutSpanColors(SHORT left, SHORT right, SHORT y, GFX_COLOR *pColor)
+*
+* PreCondition: none
+*
+* Input: left,right - x coordinates of the first and last pixel,
+*        y - row of the span,
+*        pColor - one color for each pixel of the span
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: Writes a row of pixels with the given colors. The current 
+*           color is not changed.
+*
+* Note: The span is already clipped by the caller. This function has a 
+*       weak attribute, the driver layer may implement this same function 
+*       to write the colors after setting the address once.
+*
+********************************************************************/
+void __attribute__((weak)) PutSpanColors(SHORT left, SHORT right, SHORT y, GFX_COLOR *pColor)
+{
+    GFX_COLOR   color;
+
+    color = GetColor();
+    while(left <= right)
+    {
+        SetColor(*pColor++);
+        PutPixel(left++, y);
+    }
+    SetColor(color);
+}
+
+/*********************************************************************
+* Function: void GetSpanColors(SHORT left, SHORT right, SHORT y, GFX_COLOR *pColor)
+*
+* PreCondition: none
+*
+* Input: left,right - x coordinates of the first and last pixel,
+*        y - row of the span,
+*        pColor - receives one color for each pixel of the span
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: Reads a row of pixels.
+*
+* Note: The span is already clipped by the caller. This function has a 
+*       weak attribute, the driver layer may implement this same function 
+*       to read the colors after setting the address once.
+*
+********************************************************************/
+void __attribute__((weak)) GetSpanColors(SHORT left, SHORT right, SHORT y, GFX_COLOR *pColor)
+{
+    while(left <= right)
+        *pColor++ = GetPixel(left++, y);
+}
+
+/*********************************************************************
+* Function: WORD ScrollWindow(SHORT left, SHORT top, SHORT right, 
+*                             SHORT bottom, SHORT dx, SHORT dy)
+*
+* PreCondition: none
+*
+* Input: left,top - top left corner of the window,
+*        right,bottom - bottom right corner of the window,
+*        dx,dy - distance the contents are moved, positive values move
+*                them to the right and down.
+*
+* Output: Always returns 1.
+*
+* Side Effects: none
+*
+* Overview: Moves the contents of the window by dx, dy. Pixels moved out
+*           of the window are lost, the exposed strips keep their old 
+*           contents and are redrawn by the caller. Rows are copied in 
+*           the order that does not overwrite pixels not read yet, each
+*           row is read with GetPixel() in chunks of SCROLL_BUFFER_SIZE
+*           pixels and written back with PutSpanColors().
+*
+* Note: This function has a weak attribute, drivers with a frame buffer
+*       in memory or a copy engine should implement this same function.
+*
+********************************************************************/
+#define SCROLL_BUFFER_SIZE  32
+
+WORD __attribute__((weak)) ScrollWindow(SHORT left, SHORT top, SHORT right, SHORT bottom, SHORT dx, SHORT dy)
+{
+    GFX_COLOR   buffer[SCROLL_BUFFER_SIZE];
+    SHORT       x, y, width, rows, rowStep, offset, chunk, remaining, i;
+
+    if(left < 0)
+        left = 0;
+    if(top < 0)
+        top = 0;
+    if(right > GetMaxX())
+        right = GetMaxX();
+    if(bottom > GetMaxY())
+        bottom = GetMaxY();
+
+    width = right - left + 1 - ((dx < 0) ? -dx : dx);
+    rows = bottom - top + 1 - ((dy < 0) ? -dy : dy);
+    if((width <= 0) || (rows <= 0))
+        return (1);
+
+    // first source column
+    x = (dx < 0) ? left - dx : left;
+
+    // moving down starts with the bottom row
+    if(dy > 0)
+    {
+        y = bottom - dy;
+        rowStep = -1;
+    }
+    else
+    {
+        y = top - dy;
+        rowStep = 1;
+    }
+
+    while(rows--)
+    {
+        // moving right starts with the rightmost chunk
+        offset = (dx > 0) ? width : 0;
+        for(remaining = width; remaining > 0; remaining -= chunk)
+        {
+            chunk = (remaining > SCROLL_BUFFER_SIZE) ? SCROLL_BUFFER_SIZE : remaining;
+            if(dx > 0)
+                offset -= chunk;
+
+            for(i = 0; i < chunk; i++)
+                buffer[i] = GetPixel(x + offset + i, y);
+            PutSpanColors(x + dx + offset, x + dx + offset + chunk - 1, y + dy, buffer);
+
+            if(dx <= 0)
+                offset += chunk;
+        }
+
+        y += rowStep;
+    }
+
+    return (1);
+}
+
+/*********************************************************************
+* Function: static void LineSpanH(SHORT left, SHORT right, SHORT y)
+*
+* Overview: Clips a horizontal run of a solid line and sends it to
+*           PutSpan(). The run can be given in any order.
+*
+********************************************************************/
+static void LineSpanH(SHORT left, SHORT right, SHORT y)
+{
+    SHORT   temp;
+
+    if(left > right)
+    {
+        temp = left;
+        left = right;
+        right = temp;
+    }
+
+    if(_clipRgn)
+    {
+        if((y < _clipTop) || (y > _clipBottom))
+            return;
+        if(left < _clipLeft)
+            left = _clipLeft;
+        if(right > _clipRight)
+            right = _clipRight;
+    }
+
+    if(left <= right)
+        PutSpan(left, right, y);
+}
+
+/*********************************************************************
+* Function: static void LineSpanV(SHORT x, SHORT top, SHORT bottom)
+*
+* Overview: Clips a vertical run of a solid line and sends it to 
+*           PutSpan() one row at a time, like Bar() fills a bar that
+*           is one pixel wide. The run can be given in any order.
+*
+********************************************************************/
+static void LineSpanV(SHORT x, SHORT top, SHORT bottom)
+{
+    SHORT   temp;
+
+    if(top > bottom)
+    {
+        temp = top;
+        top = bottom;
+        bottom = temp;
+    }
+
+    if(_clipRgn)
+    {
+        if((x < _clipLeft) || (x > _clipRight))
+            return;
+        if(top < _clipTop)
+            top = _clipTop;
+        if(bottom > _clipBottom)
+            bottom = _clipBottom;
+    }
+
+    while(top <= bottom)
+        PutSpan(x, x, top++);
+}
+
+/*********************************************************************
+* Function: static void LineRun(SHORT start, SHORT end, SHORT pos, SHORT steep)
+*
+* Overview: Draws one run of a solid line (the pixels that share the
+*           same minor axis position), including the neighbor runs of
+*           a thick line.
+*
+********************************************************************/
+static void LineRun(SHORT start, SHORT end, SHORT pos, SHORT steep)
+{
+    if(steep)
+    {
+        LineSpanV(pos, start, end);
+        if(_lineThickness)
+        {
+            LineSpanV(pos + 1, start, end);
+            LineSpanV(pos - 1, start, end);
+        }
+    }
+    else
+    {
+        LineSpanH(start, end, pos);
+        if(_lineThickness)
+        {
+            LineSpanH(start, end, pos + 1);
+            LineSpanH(start, end, pos - 1);
+        }
+    }
+}
+
 #ifdef USE_ALPHABLEND_LITE
+#if (COLOR_DEPTH == 16)
+/*********************************************************************
+* Overview: Masks of ConvertColor50() and ConvertColor25() for two 
+*           RGB565 pixels packed in one DWORD. The masks clear the bits
+*           that would shift into the next channel or into the other 
+*           pixel, so blending a packed pair gives the same result as
+*           blending the two pixels one by one.
+*
+********************************************************************/
+#define ALPHA_MASK50_X2     0xF7DEF7DEul
+#define ALPHA_MASK25_X2     0xE79CE79Cul
+
+/*********************************************************************
+* Function: static DWORD AlphaScalePair(DWORD colors, BYTE quarters)
+*
+* Overview: Scales two packed RGB565 colors to 25% (quarters = 1), 50% (2) 
+*           or 75% (3) the same way ConvertColor25(), ConvertColor50() 
+*           and ConvertColor75() do. quarters = 0 gives black.
+*
+********************************************************************/
+static DWORD __attribute__((always_inline)) AlphaScalePair(DWORD colors, BYTE quarters)
+{
+    DWORD   scaled = 0;
+
+    if(quarters & 2)
+        scaled = (colors & ALPHA_MASK50_X2) >> 1;
+    if(quarters & 1)
+        scaled += (colors & ALPHA_MASK25_X2) >> 2;
+    return (scaled);
+}
+#endif
+
 /*********************************************************************
 * Function: void BarAlpha(SHORT left, SHORT top, SHORT right, SHORT bottom)
 *
@@ -221,60 +553,248 @@ void __attribute__((weak)) SetClip(BYTE control)
 *           and bottom. The alpha blending percentage used is the value set by 
 *           SetAlpha(). 
 *
-* Note: none
+* Note: The bar is clipped, then each row is read with GetSpanColors() 
+*       and written with PutSpanColors() in chunks of 
+*       BAR_ALPHA_BUFFER_SIZE pixels. In 16 bpp color depth two pixels 
+*       are blended at once, packed in one DWORD.
 *
 ********************************************************************/
+#define BAR_ALPHA_BUFFER_SIZE   32
+
 WORD __attribute__((weak)) BarAlpha(SHORT left, SHORT top,WORD  right, WORD bottom)
 {
+    GFX_COLOR  buffer[BAR_ALPHA_BUFFER_SIZE];
+    SHORT      x, y, r, b, chunk, i;
+    GFX_COLOR  fcolor;
+#if (COLOR_DEPTH == 16)
+    DWORD      colors, fterm, fdelta;
+    BYTE       quarters, replace;
+#else
+    GFX_COLOR  bcolor, newColor;
+#endif
 
-    SHORT x,y;
-    GFX_COLOR  fcolor, bcolor, newColor;
-    
     // save current color
-    newColor = fcolor = GetColor();
+    fcolor = GetColor();
+
+    // PutSpanColors() expects spans inside the screen and the clipping region
+    r = (SHORT)right;
+    b = (SHORT)bottom;
+    if(left < 0)
+        left = 0;
+    if(top < 0)
+        top = 0;
+    if(r > GetMaxX())
+        r = GetMaxX();
+    if(b > GetMaxY())
+        b = GetMaxY();
+    if(_clipRgn)
+    {
+        if(left < _clipLeft)
+            left = _clipLeft;
+        if(top < _clipTop)
+            top = _clipTop;
+        if(r > _clipRight)
+            r = _clipRight;
+        if(b > _clipBottom)
+            b = _clipBottom;
+    }
+
+#if (COLOR_DEPTH == 16)
+    // everything that does not depend on the background is computed once
+    switch(GetAlpha())
+    {
+        case 25: quarters = 1; break;
+        case 50: quarters = 2; break;
+        case 75: quarters = 3; break;
+        default: quarters = 0; break;
+    }
+    fterm = AlphaScalePair(((DWORD)fcolor << 16) | fcolor, quarters);
+    fdelta = 0;
+    replace = 0;
+
+    if(quarters == 0)
+    {
+        // unsupported alpha values paint the color itself
+        fterm = ((DWORD)fcolor << 16) | fcolor;
+    }
+    else if(GetPrevAlphaColor() != BLACK)
+    {
+        // the previous color is replaced: (bcolor - prev) + fcolor, 
+        // done as one addition per pixel that wraps at 16 bits
+        fdelta = fterm - AlphaScalePair(((DWORD)GetPrevAlphaColor() << 16) | GetPrevAlphaColor(), quarters);
+        fdelta = (fdelta & 0xFFFF) * 0x00010001ul;
+        replace = 1;
+    }
+#endif
 
-    for(y=top;y<bottom+1;y++)
+    for(y = top; y <= b; y++)
     {
-        if(GetPrevAlphaColor() != BLACK)
+        for(x = left; x <= r; x += chunk)
         {
-            for(x=left;x<right+1;x++)
+            chunk = r - x + 1;
+            if(chunk > BAR_ALPHA_BUFFER_SIZE)
+                chunk = BAR_ALPHA_BUFFER_SIZE;
+
+            GetSpanColors(x, x + chunk - 1, y, buffer);
+
+#if (COLOR_DEPTH == 16)
+            for(i = 0; i < chunk; i += 2)
             {
-                bcolor = GetPixel(x,y);
-                switch(GetAlpha())
+                colors = buffer[i];
+                if(i + 1 < chunk)
+                    colors |= (DWORD)buffer[i + 1] << 16;
+
+                if(replace)
+                    colors = ((colors & 0x7FFF7FFFul) + (fdelta & 0x7FFF7FFFul)) ^ ((colors ^ fdelta) & 0x80008000ul);
+                else
+                    colors = AlphaScalePair(colors, 4 - quarters) + fterm;
+
+                buffer[i] = (GFX_COLOR)colors;
+                if(i + 1 < chunk)
+                    buffer[i + 1] = (GFX_COLOR)(colors >> 16);
+            }
+#else
+            for(i = 0; i < chunk; i++)
+            {
+                bcolor = buffer[i];
+                if(GetPrevAlphaColor() != BLACK)
                 {
-                    case 50: newColor = (bcolor - ConvertColor50(GetPrevAlphaColor())) + ConvertColor50(fcolor);break;
-                    case 75: newColor = (bcolor - ConvertColor75(GetPrevAlphaColor())) + ConvertColor75(fcolor);break;
-                    case 25: newColor = (bcolor - ConvertColor25(GetPrevAlphaColor())) + ConvertColor25(fcolor);break;
-                    default: break;
+                    switch(GetAlpha())
+                    {
+                        case 50: newColor = (bcolor - ConvertColor50(GetPrevAlphaColor())) + ConvertColor50(fcolor);break;
+                        case 75: newColor = (bcolor - ConvertColor75(GetPrevAlphaColor())) + ConvertColor75(fcolor);break;
+                        case 25: newColor = (bcolor - ConvertColor25(GetPrevAlphaColor())) + ConvertColor25(fcolor);break;
+                        default: newColor = fcolor; break;
+                    }
                 }
-                SetColor(newColor);
-                PutPixel(x,y);
-            }     
-        }
-        else
-        {                          
-            for(x=left;x<right+1;x++)
-            {
-                bcolor = GetPixel(x,y);
-                switch(GetAlpha())
+                else
                 {
-                    case 50: newColor = ConvertColor50(fcolor) + ConvertColor50(bcolor); break;
-                    case 25: newColor = ConvertColor25(fcolor) + ConvertColor75(bcolor); break;
-                    case 75: newColor = ConvertColor75(fcolor) + ConvertColor25(bcolor); break;
-                    default: break;
-                } 
-                SetColor(newColor);
-                PutPixel(x,y);
-            } 
-        }        
+                    switch(GetAlpha())
+                    {
+                        case 50: newColor = ConvertColor50(fcolor) + ConvertColor50(bcolor); break;
+                        case 25: newColor = ConvertColor25(fcolor) + ConvertColor75(bcolor); break;
+                        case 75: newColor = ConvertColor75(fcolor) + ConvertColor25(bcolor); break;
+                        default: newColor = fcolor; break;
+                    }
+                }
+                buffer[i] = newColor;
+            }
+#endif
+
+            PutSpanColors(x, x + chunk - 1, y, buffer);
+        }
     }
 
-    // reset to original _color
-    SetColor(fcolor); 
     return (1);
 }
 #endif
 
+#ifdef USE_NONBLOCKING_CONFIG
+/*********************************************************************
+* Function: void GFXTimeSliceSourceRegister(GFX_TICKS_CALLBACK pTicksFn, 
+*                                           DWORD ticksPerSecond)
+*
+* PreCondition: none
+*
+* Input: pTicksFn - free running 64-bit timer, NULL to disable the slices
+*        ticksPerSecond - timer ticks per second
+*
+* Output: none
+*
+* Side Effects: ends the current time slice
+*
+* Overview: registers the timer used to measure the drawing time slices
+*
+* Note: none
+*
+********************************************************************/
+void GFXTimeSliceSourceRegister(GFX_TICKS_CALLBACK pTicksFn, DWORD ticksPerSecond)
+{
+    _pSliceTicksFn = pTicksFn;
+    _sliceTicksPerSecond = ticksPerSecond;
+    _sliceLimited = 0;
+}
+
+/*********************************************************************
+* Function: void GFXTimeSliceStart(DWORD budget)
+*
+* PreCondition: none
+*
+* Input: budget - length of the slice in microseconds, 0 = no limit
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: starts a drawing time slice
+*
+* Note: none
+*
+********************************************************************/
+void GFXTimeSliceStart(DWORD budget)
+{
+    _sliceLimited = 0;
+
+    if(_pSliceTicksFn == NULL)
+        return;
+
+    _sliceStart = _pSliceTicksFn();
+    if(budget)
+    {
+        _sliceEnd = _sliceStart + ((QWORD)budget * _sliceTicksPerSecond) / 1000000;
+        _sliceLimited = 1;
+    }
+}
+
+/*********************************************************************
+* Function: BYTE GFXTimeSliceExpired(void)
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: non-zero if the budget of the current slice is used up
+*
+* Side Effects: none
+*
+* Overview: checks the current drawing time slice
+*
+* Note: none
+*
+********************************************************************/
+BYTE GFXTimeSliceExpired(void)
+{
+    if(!_sliceLimited)
+        return (0);
+
+    return (_pSliceTicksFn() >= _sliceEnd);
+}
+
+/*********************************************************************
+* Function: DWORD GFXTimeSliceElapsed(void)
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: microseconds since the start of the current slice
+*
+* Side Effects: none
+*
+* Overview: measures the current drawing time slice
+*
+* Note: none
+*
+********************************************************************/
+DWORD GFXTimeSliceElapsed(void)
+{
+    if((_pSliceTicksFn == NULL) || (_sliceTicksPerSecond == 0))
+        return (0);
+
+    return ((DWORD)(((_pSliceTicksFn() - _sliceStart) * 1000000) / _sliceTicksPerSecond));
+}
+#endif // USE_NONBLOCKING_CONFIG
+
 /*********************************************************************
 * Function: WORD Bar(SHORT left, SHORT top, SHORT right, SHORT bottom)
 *
@@ -294,12 +814,17 @@ WORD __attribute__((weak)) BarAlpha(SHORT left, SHORT top,WORD  right, WORD bott
 *
 * Overview: draws rectangle filled with current color
 *
-* Note: none
+* Note: In the non-blocking configuration the bar is also stopped 
+*       after the current span when the drawing time slice is used 
+*       up, unless it is drawn by a primitive that does not check
+*       its return value. The next call with the same parameters 
+*       and color continues with the next span. Outside of a 
+*       limited slice the whole bar is drawn.
 *
 ********************************************************************/
 WORD __attribute__((weak)) Bar(SHORT left, SHORT top, SHORT right, SHORT bottom)
 {
-    SHORT   x, y;
+    SHORT   y;
 
 #ifndef USE_NONBLOCKING_CONFIG
     while(IsDeviceBusy() != 0) Nop();
@@ -321,9 +846,52 @@ WORD __attribute__((weak)) Bar(SHORT left, SHORT top, SHORT right, SHORT bottom)
         // since pixel colors will be replaced by the SetColor()
 #endif
     {
-        for(y = top; y < bottom + 1; y++)
-            for(x = left; x < right + 1; x++)
-                PutPixel(x, y);
+        if(_clipRgn)
+        {
+            if(left < _clipLeft)
+                left = _clipLeft;
+            if(right > _clipRight)
+                right = _clipRight;
+            if(top < _clipTop)
+                top = _clipTop;
+            if(bottom > _clipBottom)
+                bottom = _clipBottom;
+        }
+
+        if(left <= right)
+        {
+            y = top;
+
+#ifdef USE_NONBLOCKING_CONFIG
+            // a bar drawn outside of GOLDraw() is always drawn whole
+            if(_barResumePending)
+            {
+                _barResumePending = 0;
+                if(_sliceLimited && (_barResumeLeft == left) && (_barResumeTop == top) && (_barResumeRight == right) &&
+                   (_barResumeBottom == bottom) && (_barResumeColor == GetColor()))
+                    y = _barResumeY;
+            }
+#endif
+
+            for(; y < bottom + 1; y++)
+            {
+                PutSpan(left, right, y);
+
+#ifdef USE_NONBLOCKING_CONFIG
+                if((y < bottom) && (_sliceHold == 0) && GFXTimeSliceExpired())
+                {
+                    _barResumeLeft = left;
+                    _barResumeTop = top;
+                    _barResumeRight = right;
+                    _barResumeBottom = bottom;
+                    _barResumeColor = GetColor();
+                    _barResumeY = y + 1;
+                    _barResumePending = 1;
+                    return (0);
+                }
+#endif
+            }
+        }
     }
     return (1);
 }
@@ -369,6 +937,18 @@ WORD __attribute__((weak)) Line(SHORT x1, SHORT y1, SHORT x2, SHORT y2)
     // Move cursor
     MoveTo(x2, y2);
 
+    if((x1 == x2) && (_lineType == SOLID_LINE))
+    {
+        LineRun(y1, y2, x1, 1);
+        return (1);
+    }
+
+    if((y1 == y2) && (_lineType == SOLID_LINE))
+    {
+        LineRun(x1, x2, y1, 0);
+        return (1);
+    }
+
     if(x1 == x2)
     {
         if(y1 > y2)
@@ -472,11 +1052,6 @@ WORD __attribute__((weak)) Line(SHORT x1, SHORT y1, SHORT x2, SHORT y2)
         temp = stepX;
         stepX = stepY;
         stepY = temp;
-        PutPixel(y1, x1);
-    }
-    else
-    {
-        PutPixel(x1, y1);
     }
 
     // If the current error greater or equal zero
@@ -488,6 +1063,33 @@ WORD __attribute__((weak)) Line(SHORT x1, SHORT y1, SHORT x2, SHORT y2)
     // Error for the first pixel
     error = stepErrorLT - deltaX;
 
+    if(_lineType == SOLID_LINE)
+    {
+        // draw the pixels that share the same minor axis position as one run
+        temp = x1;
+        while(--deltaX >= 0)
+        {
+            if(error >= 0)
+            {
+                LineRun(temp, x1, y1, steep);
+                y1 += stepY;
+                error -= stepErrorGE;
+                temp = x1 + stepX;
+            }
+
+            x1 += stepX;
+            error += stepErrorLT;
+        }
+
+        LineRun(temp, x1, y1, steep);
+        return (1);
+    }
+
+    if(steep)
+        PutPixel(y1, x1);
+    else
+        PutPixel(x1, y1);
+
     style = 0;
     type = 1;
 
@@ -2416,6 +3018,296 @@ WORD __attribute__((weak)) OutCharRender(XCHAR ch, OUTCHAR_PARAM *pParam)
 
 }
 
+#ifdef USE_GLYPH_CACHE
+
+/*********************************************************************
+* Overview: One horizontal run of a cached glyph. A run covers the
+*           pixels of one glyph row that share the same level. For
+*           1 bpp fonts the level is always 1, for anti-aliased fonts
+*           it is the 2 bit pixel value (1 = 25%, 2 = 75%, 3 = 100%).
+*
+*********************************************************************/
+typedef struct
+{
+    BYTE    row;
+    BYTE    start;
+    BYTE    length;
+    BYTE    level;
+} GLYPH_RUN;
+
+/*********************************************************************
+* Overview: Glyph cache entry. Holds the character metrics and the
+*           run-length form of the glyph image so that a cached
+*           character is drawn without reading the font again.
+*
+*********************************************************************/
+typedef struct
+{
+    void        *pFont;                     // font of the glyph, NULL if the entry is free
+    XCHAR       ch;                         // character code
+    WORD        age;                        // value of _glyphCacheClock at the last use
+    BYTE        bpp;
+#ifdef USE_ANTIALIASED_FONTS
+    BYTE        antialiasType;              // anti-alias type the glyph was cached with (bpp > 1 only)
+#endif
+    BYTE        runCount;
+    SHORT       chGlyphWidth;
+    SHORT       xAdjust;
+    SHORT       yAdjust;
+    SHORT       xWidthAdjust;
+    SHORT       heightOvershoot;
+    GLYPH_RUN   run[GFX_GLYPH_CACHE_RUNS];
+} GLYPH_CACHE_ENTRY;
+
+static GLYPH_CACHE_ENTRY    _glyphCache[GFX_GLYPH_CACHE_ENTRIES];
+static WORD                 _glyphCacheClock;
+
+/*********************************************************************
+* Function: void GlyphCacheFlush(void)
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+* Overview: Drops all the glyphs kept in the glyph cache.
+*
+* Note: Call this after the contents of a font already used for
+*       rendering have been changed in place.
+*
+********************************************************************/
+void GlyphCacheFlush(void)
+{
+    BYTE    i;
+
+    for(i = 0; i < GFX_GLYPH_CACHE_ENTRIES; i++)
+        _glyphCache[i].pFont = NULL;
+}
+
+/*********************************************************************
+* Function: static GLYPH_CACHE_ENTRY *GlyphCacheFind(XCHAR ch, BYTE *pVictim)
+*
+* Overview: Looks up the character of the current font. Returns the
+*           entry on a hit, NULL on a miss. An anti-aliased glyph only
+*           hits with the anti-alias type it was cached with. pVictim
+*           is set to the free or least recently used entry.
+*
+********************************************************************/
+static GLYPH_CACHE_ENTRY *GlyphCacheFind(XCHAR ch, BYTE *pVictim)
+{
+    GLYPH_CACHE_ENTRY   *pEntry;
+    WORD                idle, maxIdle;
+    BYTE                i;
+
+    maxIdle = 0;
+    *pVictim = 0;
+    for(i = 0; i < GFX_GLYPH_CACHE_ENTRIES; i++)
+    {
+        pEntry = &_glyphCache[i];
+        if(pEntry->pFont == NULL)
+        {
+            // a free entry is always the best victim
+            maxIdle = 0xFFFF;
+            *pVictim = i;
+            continue;
+        }
+
+        if((pEntry->pFont == currentFont.pFont) && (pEntry->ch == ch)
+#ifdef USE_ANTIALIASED_FONTS
+            && ((pEntry->bpp == 1) || (pEntry->antialiasType == GFX_Font_GetAntiAliasType()))
+#endif
+          )
+        {
+            pEntry->age = ++_glyphCacheClock;
+            return (pEntry);
+        }
+
+        idle = _glyphCacheClock - pEntry->age;
+        if(idle > maxIdle)
+        {
+            maxIdle = idle;
+            *pVictim = i;
+        }
+    }
+
+    return (NULL);
+}
+
+/*********************************************************************
+* Function: static BYTE GlyphCacheFill(GLYPH_CACHE_ENTRY *pEntry, XCHAR ch, OUTCHAR_PARAM *pParam)
+*
+* Overview: Converts the glyph image gathered by OutCharGetInfoFlash()
+*           or OutCharGetInfoExternal() into runs. Returns 0 and leaves
+*           the entry free if the glyph does not fit into the entry.
+*
+********************************************************************/
+static BYTE GlyphCacheFill(GLYPH_CACHE_ENTRY *pEntry, XCHAR ch, OUTCHAR_PARAM *pParam)
+{
+    GFX_FONT_SPACE BYTE *pImage;
+    BYTE                temp = 0;
+    BYTE                mask, restoremask, shift = 0;
+    BYTE                val, level;
+    SHORT               xCnt, yCnt, rows, start = 0;
+    GLYPH_RUN           *pRun;
+
+    pEntry->pFont = NULL;
+
+    rows = currentFont.fontHeader.height + pParam->heightOvershoot;
+    if((rows > 0x100) || (pParam->chGlyphWidth > 0xFF))
+        return (0);
+
+    restoremask = (pParam->bpp == 1) ? 0x01 : 0x03;
+    pImage = pParam->pChImage;
+    pRun = pEntry->run;
+    pEntry->runCount = 0;
+
+    for(yCnt = 0; yCnt < rows; yCnt++)
+    {
+        mask = 0;
+        level = 0;
+
+        // one extra step closes the run that ends at the right edge
+        for(xCnt = 0; xCnt <= pParam->chGlyphWidth; xCnt++)
+        {
+            val = 0;
+            if(xCnt < pParam->chGlyphWidth)
+            {
+                if(mask == 0)
+                {
+                    temp = *pImage++;
+                    mask = restoremask;
+                    shift = 0;
+                }
+
+                val = (temp & mask) >> shift;
+                mask  <<= pParam->bpp;
+                shift  += pParam->bpp;
+            }
+
+            if(val == level)
+                continue;
+
+            if(level)
+            {
+                if(pEntry->runCount == GFX_GLYPH_CACHE_RUNS)
+                    return (0);
+                pRun->row = yCnt;
+                pRun->start = start;
+                pRun->length = xCnt - start;
+                pRun->level = level;
+                pRun++;
+                pEntry->runCount++;
+            }
+
+            level = val;
+            start = xCnt;
+        }
+    }
+
+    pEntry->bpp = pParam->bpp;
+#ifdef USE_ANTIALIASED_FONTS
+    pEntry->antialiasType = GFX_Font_GetAntiAliasType();
+#endif
+    pEntry->chGlyphWidth = pParam->chGlyphWidth;
+    pEntry->xAdjust = pParam->xAdjust;
+    pEntry->yAdjust = pParam->yAdjust;
+    pEntry->xWidthAdjust = pParam->xWidthAdjust;
+    pEntry->heightOvershoot = pParam->heightOvershoot;
+    pEntry->ch = ch;
+    pEntry->age = ++_glyphCacheClock;
+    pEntry->pFont = currentFont.pFont;
+
+    return (1);
+}
+
+/*********************************************************************
+* Function: static WORD GlyphCacheRender(GLYPH_CACHE_ENTRY *pEntry)
+*
+* Overview: Draws a cached glyph at the current cursor position, one
+*           clipped span per run, and moves the cursor the same way
+*           OutCharRender() does.
+*
+********************************************************************/
+static WORD GlyphCacheRender(GLYPH_CACHE_ENTRY *pEntry)
+{
+    GLYPH_RUN   *pRun;
+    BYTE        i;
+    SHORT       x, y;
+#ifdef USE_ANTIALIASED_FONTS
+    BYTE        level = 0;
+    GFX_COLOR   bgcolor;
+
+    if(pEntry->bpp > 1)
+    {
+        bgcolor = GetPixel(GetX(), GetY() + (currentFont.fontHeader.height >> 1));
+
+        if((_fgcolor100 != GetColor()) || (_bgcolor100 != bgcolor))
+        {
+            _fgcolor100 = GetColor();
+            _bgcolor100 = bgcolor;
+            calculateColors();
+        }
+    }
+#endif
+
+    pRun = pEntry->run;
+
+    if(_fontOrientation == ORIENT_HOR)
+    {
+        x = GetX() + pEntry->xAdjust;
+        y = GetY() + pEntry->yAdjust;
+    }
+    else
+    {
+        x = GetY() + pEntry->yAdjust;
+        y = GetX() + pEntry->xAdjust;
+    }
+
+    for(i = 0; i < pEntry->runCount; i++, pRun++)
+    {
+#ifdef USE_ANTIALIASED_FONTS
+        if((pEntry->bpp > 1) && (pRun->level != level))
+        {
+            level = pRun->level;
+            switch(level)
+            {
+                case 1: SetColor(_fgcolor25);
+                        break;
+
+                case 2: SetColor(_fgcolor75);
+                        break;
+
+                case 3: SetColor(_fgcolor100);
+            }
+        }
+#endif
+        if(_fontOrientation == ORIENT_HOR)
+            LineSpanH(x + pRun->start, x + pRun->start + pRun->length - 1, y + pRun->row);
+        else
+            LineSpanV(y + pRun->row, x - pRun->start, x - pRun->start - pRun->length + 1);
+    }
+
+    // move cursor
+    if(_fontOrientation == ORIENT_HOR)
+        _cursorX = x + pEntry->chGlyphWidth - pEntry->xAdjust - pEntry->xWidthAdjust;
+    else
+        _cursorY = x - pEntry->chGlyphWidth - pEntry->xAdjust;
+
+    // restore color
+#ifdef USE_ANTIALIASED_FONTS
+    if(pEntry->bpp > 1)
+    {
+        SetColor(_fgcolor100);
+    }
+#endif
+    return (1);
+}
+
+#endif // #ifdef USE_GLYPH_CACHE
+
 /*********************************************************************
 * Function: WORD OutChar(XCHAR ch)
 *
@@ -2439,6 +3331,10 @@ WORD __attribute__((weak)) OutCharRender(XCHAR ch, OUTCHAR_PARAM *pParam)
 WORD __attribute__((weak)) OutChar(XCHAR ch)
 {
     static OUTCHAR_PARAM OutCharParam;
+#ifdef USE_GLYPH_CACHE
+    GLYPH_CACHE_ENTRY   *pEntry;
+    BYTE                victim;
+#endif
 
     // initialize variables
 #ifdef USE_FONT_EXTERNAL	
@@ -2466,6 +3362,12 @@ WORD __attribute__((weak)) OutChar(XCHAR ch)
         return (0);
 #endif
 
+#ifdef USE_GLYPH_CACHE
+    pEntry = GlyphCacheFind(ch, &victim);
+    if(pEntry != NULL)
+        return (GlyphCacheRender(pEntry));
+#endif
+
     switch(*((SHORT *)currentFont.pFont))
     {
 
@@ -2480,6 +3382,21 @@ WORD __attribute__((weak)) OutChar(XCHAR ch)
         default:
             return 1;
     }    
+
+#ifdef USE_GLYPH_CACHE
+    // translucent anti-aliasing blends with every background pixel, 
+    // these glyphs are always rendered from the font
+    if((OutCharParam.bpp == 1) 
+#ifdef USE_ANTIALIASED_FONTS
+        || ((OutCharParam.bpp == 2) && (GFX_Font_GetAntiAliasType() == ANTIALIAS_OPAQUE))
+#endif
+      )
+    {
+        pEntry = &_glyphCache[victim];
+        if(GlyphCacheFill(pEntry, ch, &OutCharParam))
+            return (GlyphCacheRender(pEntry));
+    }
+#endif
     
     return (OutCharRender(ch, &OutCharParam));
 }
@@ -2975,6 +3892,180 @@ SHORT __attribute__((weak)) GetImageHeight(void *image)
     }
 }
 
+#if defined (USE_BITMAP_FLASH) || defined (USE_BITMAP_EXTERNAL)
+
+/*********************************************************************
+* Overview: Number of image pixels converted at a time by the row 
+*           blitters before they are written with PutSpanColors().
+*
+********************************************************************/
+#define IMAGE_ROW_COLORS    32
+
+#ifdef USE_PALETTE
+    #define IMAGE_COLOR(pPalette, index)    ((GFX_COLOR)(index))
+#else
+    #define IMAGE_COLOR(pPalette, index)    ((GFX_COLOR)(pPalette)[index])
+#endif
+
+#ifdef USE_TRANSPARENT_COLOR
+    #define IMAGE_IS_TRANSPARENT(color)     ((GetTransparentColor() == (color)) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE))
+#else
+    #define IMAGE_IS_TRANSPARENT(color)     0
+#endif
+
+/*********************************************************************
+* Function: static void ImageSpanPut(SHORT left, SHORT y, GFX_COLOR *pColor, WORD count)
+*
+* Overview: Clips a row of count colors starting at left,y and writes 
+*           it with PutSpanColors().
+*
+********************************************************************/
+static void ImageSpanPut(SHORT left, SHORT y, GFX_COLOR *pColor, WORD count)
+{
+    SHORT   right;
+
+    if(count == 0)
+        return;
+
+    right = left + count - 1;
+
+    if(_clipRgn)
+    {
+        if((y < _clipTop) || (y > _clipBottom))
+            return;
+        if(left < _clipLeft)
+        {
+            pColor += _clipLeft - left;
+            left = _clipLeft;
+        }
+        if(right > _clipRight)
+            right = _clipRight;
+    }
+
+    if(left <= right)
+        PutSpanColors(left, right, y, pColor);
+}
+
+/*********************************************************************
+* Function: static void ImageRowWrite(SHORT left, SHORT y, GFX_COLOR *pColor, 
+*                                     WORD count, BYTE stretch)
+*
+* Overview: Writes count converted image pixels. With IMAGE_X2 at most
+*           IMAGE_ROW_COLORS pixels are doubled and written on two rows.
+*           When the transparent color is enabled only the runs of 
+*           other colors are written.
+*
+********************************************************************/
+static void ImageRowWrite(SHORT left, SHORT y, GFX_COLOR *pColor, WORD count, BYTE stretch)
+{
+    GFX_COLOR   wide[2 * IMAGE_ROW_COLORS];
+    WORD        rows, i;
+
+    rows = 1;
+    if(stretch != IMAGE_NORMAL)
+    {
+        for(i = 0; i < count; i++)
+        {
+            wide[2 * i] = pColor[i];
+            wide[2 * i + 1] = pColor[i];
+        }
+        pColor = wide;
+        count <<= 1;
+        rows = 2;
+    }
+
+#ifdef USE_TRANSPARENT_COLOR
+    if(GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)
+    {
+        WORD    start, end;
+
+        start = 0;
+        while(start < count)
+        {
+            while((start < count) && (pColor[start] == GetTransparentColor()))
+                start++;
+            end = start;
+            while((end < count) && (pColor[end] != GetTransparentColor()))
+                end++;
+
+            for(i = 0; i < rows; i++)
+                ImageSpanPut(left + start, y + i, pColor + start, end - start);
+            start = end;
+        }
+        return;
+    }
+#endif
+
+    for(i = 0; i < rows; i++)
+        ImageSpanPut(left, y + i, pColor, count);
+}
+
+/*********************************************************************
+* Overview: Pixel readers of the uncompressed image formats. i is the
+*           index of the pixel in the row, 1 and 4 bpp rows start with 
+*           the least significant bits.
+*
+********************************************************************/
+#define IMAGE_PIXEL_1BPP(pRow, i)   IMAGE_COLOR(pPalette, ((pRow)[(i) >> 3] >> ((i) & 0x07)) & 0x01)
+#define IMAGE_PIXEL_4BPP(pRow, i)   IMAGE_COLOR(pPalette, ((pRow)[(i) >> 1] >> (((i) & 0x01) << 2)) & 0x0F)
+#define IMAGE_PIXEL_8BPP(pRow, i)   IMAGE_COLOR(pPalette, (BYTE)(pRow)[i])
+#define IMAGE_PIXEL_16BPP(pRow, i)  ((GFX_COLOR)(pRow)[i])
+
+/*********************************************************************
+* Overview: Generates a row blitter for one pixel format and source 
+*           memory. The blitter converts width pixels starting at 
+*           pixel index of pRow IMAGE_ROW_COLORS at a time and writes 
+*           them with ImageRowWrite(). Each instance has its own inner
+*           loop so the per pixel work is only the conversion.
+*
+********************************************************************/
+#define IMAGE_ROW_BLITTER(name, ROW_TYPE, PIXEL)                                    \
+static void name(SHORT left, SHORT y, ROW_TYPE *pRow, WORD index, WORD width,       \
+                 BYTE stretch, WORD *pPalette)                                      \
+{                                                                                   \
+    GFX_COLOR   color[IMAGE_ROW_COLORS];                                            \
+    WORD        count, i;                                                           \
+                                                                                    \
+    while(width)                                                                    \
+    {                                                                               \
+        count = (width > IMAGE_ROW_COLORS) ? IMAGE_ROW_COLORS : width;              \
+        for(i = 0; i < count; i++, index++)                                         \
+            color[i] = PIXEL(pRow, index);                                          \
+                                                                                    \
+        ImageRowWrite(left, y, color, count, stretch);                              \
+        left += (stretch == IMAGE_NORMAL) ? count : (count << 1);                   \
+        width -= count;                                                             \
+    }                                                                               \
+}
+
+    #ifdef USE_BITMAP_FLASH
+IMAGE_ROW_BLITTER(ImageRow1BPP, FLASH_BYTE, IMAGE_PIXEL_1BPP)
+        #if (COLOR_DEPTH >= 4)
+IMAGE_ROW_BLITTER(ImageRow4BPP, FLASH_BYTE, IMAGE_PIXEL_4BPP)
+        #endif
+        #if (COLOR_DEPTH >= 8)
+IMAGE_ROW_BLITTER(ImageRow8BPP, FLASH_BYTE, IMAGE_PIXEL_8BPP)
+        #endif
+        #if (COLOR_DEPTH == 16)
+IMAGE_ROW_BLITTER(ImageRow16BPP, FLASH_WORD, IMAGE_PIXEL_16BPP)
+        #endif
+    #endif
+
+    #ifdef USE_BITMAP_EXTERNAL
+IMAGE_ROW_BLITTER(ImageRow1BPPExt, BYTE, IMAGE_PIXEL_1BPP)
+        #if (COLOR_DEPTH >= 4)
+IMAGE_ROW_BLITTER(ImageRow4BPPExt, BYTE, IMAGE_PIXEL_4BPP)
+        #endif
+        #if (COLOR_DEPTH >= 8)
+IMAGE_ROW_BLITTER(ImageRow8BPPExt, BYTE, IMAGE_PIXEL_8BPP)
+        #endif
+        #if (COLOR_DEPTH == 16)
+IMAGE_ROW_BLITTER(ImageRow16BPPExt, WORD, IMAGE_PIXEL_16BPP)
+        #endif
+    #endif
+
+#endif // #if defined (USE_BITMAP_FLASH) || defined (USE_BITMAP_EXTERNAL)
+
     #ifdef USE_BITMAP_FLASH
 
 /*********************************************************************
@@ -2998,16 +4089,13 @@ SHORT __attribute__((weak)) GetImageHeight(void *image)
 ********************************************************************/
 void __attribute__((weak)) PutImage1BPP(SHORT left, SHORT top, FLASH_BYTE *image, BYTE stretch, PUTIMAGE_PARAM *pPartialImageData)
 {
-    register FLASH_BYTE *flashAddress, *tempFlashAddress;
-    BYTE                temp = 0;
+    register FLASH_BYTE *flashAddress;
     WORD                sizeX, sizeY;
-    WORD                x, y;
-    WORD                xc, yc;
+    WORD                y, yc;
     WORD                pallete[2];
-    WORD                mask;
-    WORD                addressOffset = 0, adjOffset;
-    WORD                OffsetFlag = 0x01;     //Offset from BYTE color bit0 for the partial image 
-                  
+    WORD                lineLength;
+    WORD                index = 0;
+
     // Move pointer to size information
     flashAddress = image + 2;
 
@@ -3021,172 +4109,24 @@ void __attribute__((weak)) PutImage1BPP(SHORT left, SHORT top, FLASH_BYTE *image
     pallete[1] = *((FLASH_WORD *)flashAddress);
     flashAddress += 2;
 
-    if (sizeX & 0x07)
-        adjOffset = 1; 
-    else
-        adjOffset = 0;
-
-    // compute for addressOffset this is the offset needed to jump to the 
-    // next line 
-    addressOffset = ((sizeX >> 3) + adjOffset); 
+    // bytes per line, lines start on a byte boundary
+    lineLength = (sizeX + 7) >> 3;
 
     if(pPartialImageData->width != 0)
     {
-        WORD mod3 = ((pPartialImageData->xoffset) & 0x07);
-
-        // adjust the flashAddress to the starting pixel location
-        // adjust one address if the data is not byte aligned
-        flashAddress += (pPartialImageData->yoffset*((sizeX >> 3) + adjOffset));
-
-        // adjust flashAddress for x offset (if xoffset is zero address stays the same)
-        flashAddress += ((pPartialImageData->xoffset) >> 3);
-
-        OffsetFlag <<= mod3;
-
+        flashAddress += (pPartialImageData->yoffset * lineLength) + (pPartialImageData->xoffset >> 3);
+        index = pPartialImageData->xoffset & 0x07;
         sizeY = pPartialImageData->height;
         sizeX = pPartialImageData->width;
     }
 
     yc = top;
-
-    // store current line data address 
-    tempFlashAddress = flashAddress;
-
-    // Note: For speed the code for loops are repeated. A small code size increase for performance
-    if (stretch == IMAGE_NORMAL)
+    for(y = 0; y < sizeY; y++)
     {
-
-        for(y = 0; y < sizeY; y++)
-        {
-            // get flash address location of current line being processed
-            flashAddress = tempFlashAddress;
-
-            xc = left;
-            if (OffsetFlag != 0x01)
-    		{
-                // grab the first set of data then set up the mask to the starting pixel
-    			temp = *flashAddress++;
-            }
-            mask = OffsetFlag;
- 
-            for(x = 0; x < sizeX; x++)
-            {
-
-            	// Read 8 pixels from flash
-                if(mask == 0x01)
-			    {
-				    temp = *flashAddress++;
-                    mask = 0x01;
-                }
-
-                // Set color
-                if(mask & temp)
-                {
-                // Set color
-                    #ifdef USE_PALETTE
-                        SetColor(1);
-                    #else
-                        SetColor(pallete[1]);
-                    #endif                
-                }
-                else
-                {
-                    // Set color
-                    #ifdef USE_PALETTE
-                        SetColor(0);
-                    #else
-                        SetColor(pallete[0]);
-                    #endif
-                }
-
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                        // Write pixel(s) to screen
-                        PutPixel(xc, yc);
-                    // adjust to next location
-                    xc++;
-
-                // Read 8 pixels from flash
-                if(mask == 0x80)
-                    mask = 0x01;
-                else
-                    // Shift to the next pixel
-                    mask <<= 1;
-            }  
-            tempFlashAddress += (addressOffset);          
-            yc++;
-        }
+        ImageRow1BPP(left, yc, flashAddress, index, sizeX, stretch, pallete);
+        flashAddress += lineLength;
+        yc += (stretch == IMAGE_NORMAL) ? 1 : 2;
     }
-    else
-    {
-        for(y = 0; y < sizeY; y++)
-        {
-            // get flash address location of current line being processed
-            flashAddress = tempFlashAddress;
-
-            xc = left;
-            if (OffsetFlag != 0x01)
-    		{
-                // grab the first set of data then set up the mask to the starting pixel
-    			temp = *flashAddress++;
-            }
-            mask = OffsetFlag;
-
-            for(x = 0; x < sizeX; x++)
-            {
-
-            	// Read 8 pixels from flash
-                if(mask == 0x01)
-			    {
-				    temp = *flashAddress++;
-                    mask = 0x01;
-                }
-
-                    // Set color
-                if(mask & temp)
-                {
-                    // Set color
-                    #ifdef USE_PALETTE
-                        SetColor(1);
-                    #else
-                        SetColor(pallete[1]);
-                    #endif                
-                }
-                else
-                {
-                    // Set color
-                    #ifdef USE_PALETTE
-                        SetColor(0);
-                    #else
-                        SetColor(pallete[0]);
-                    #endif
-                }
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                    {
-                        // Write pixel(s) to screen, basically writes a tile of 2x2 pixels to the screen
-                        PutPixel(xc,   yc);
-                        PutPixel(xc,   yc+1);  
-                        PutPixel(xc+1, yc);
-                        PutPixel(xc+1, yc+1);  
-                    }
-                    xc += 2;
-                                // Read 8 pixels from flash
-
-                // Read 8 pixels from flash
-                if(mask == 0x80)
-                    mask = 0x01;
-                else
-                    // Shift to the next pixel
-                    mask <<= 1;
-            }
-            tempFlashAddress += (addressOffset);
-            yc+=2;
-        }
-    }    
-
 }
 
 /*********************************************************************
@@ -3213,13 +4153,11 @@ void __attribute__((weak)) PutImage4BPP(SHORT left, SHORT top, FLASH_BYTE *image
 {
     register FLASH_BYTE *flashAddress;
     WORD                sizeX, sizeY;
-    register WORD       x, y;
-    WORD                xc, yc;
-    BYTE                temp = 0;
+    WORD                y, yc;
     WORD                pallete[16];
     WORD                counter;
-    WORD                addressOffset = 0;
-    BYTE                OffsetFlag = 0;
+    WORD                lineLength;
+    WORD                index = 0;
 
     // Move pointer to size information
     flashAddress = image + 2;
@@ -3237,131 +4175,24 @@ void __attribute__((weak)) PutImage4BPP(SHORT left, SHORT top, FLASH_BYTE *image
         flashAddress += 2;
     }
 
+    // bytes per line, lines start on a byte boundary
+    lineLength = (sizeX + 1) >> 1;
+
     if(pPartialImageData->width != 0)
     {
-         WORD mod1 = (sizeX & 1);
-         WORD mod2 = (pPartialImageData->width) & 1; 
-         WORD mod3 = (pPartialImageData->xoffset) & 1; 
-
-         flashAddress += (pPartialImageData->yoffset)*((sizeX>>1)+mod1);
-         flashAddress += ((pPartialImageData->xoffset)>>1);                
-
-         addressOffset = (sizeX>>1)+mod1;
-         addressOffset -= ((pPartialImageData->width)>>1);
-         addressOffset -= mod3;
-         OffsetFlag = (mod3);
-
-          if(OffsetFlag == 0)
-          {
-            addressOffset -= mod2;
-          }
-         
-         sizeY = pPartialImageData->height;
-         sizeX = pPartialImageData->width;
-         
+        flashAddress += (pPartialImageData->yoffset * lineLength) + (pPartialImageData->xoffset >> 1);
+        index = pPartialImageData->xoffset & 0x01;
+        sizeY = pPartialImageData->height;
+        sizeX = pPartialImageData->width;
     }
 
     yc = top;
-
-    // Note: For speed the code for loops are repeated. A small code size increase for performance
-    if (stretch == IMAGE_NORMAL)
+    for(y = 0; y < sizeY; y++)
     {
-        for(y = 0; y < sizeY; y++)
-        {
-            xc = left;
-            temp = *flashAddress;
-            flashAddress += OffsetFlag;
-
-            for(x = OffsetFlag; x < (sizeX+OffsetFlag); x++)
-            {
-                // Read 2 pixels from flash
-                if(x & 0x01)
-                {
-                // second pixel in byte
-                // Set color
-                #ifdef USE_PALETTE
-                    SetColor(temp >> 4);
-                #else
-                    SetColor(pallete[temp >> 4]);
-                #endif
-                }
-                else
-                {
-                    temp = *flashAddress++;
-                // first pixel in byte
-                // Set color
-                #ifdef USE_PALETTE
-                    SetColor(temp & 0x0f);
-                #else
-                    SetColor(pallete[temp & 0x0f]);
-                #endif
-                }
-
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                        // Write pixel(s) to screen
-                        PutPixel(xc, yc);
-                        xc++;
-            }  
-
-            flashAddress += addressOffset;
-  
-            yc++;
-        }
-
+        ImageRow4BPP(left, yc, flashAddress, index, sizeX, stretch, pallete);
+        flashAddress += lineLength;
+        yc += (stretch == IMAGE_NORMAL) ? 1 : 2;
     }
-    else
-    {
-        for(y = 0; y < sizeY; y++)
-        {
-            xc = left;
-            temp = *flashAddress;
-            flashAddress += OffsetFlag;
-
-            for(x = OffsetFlag; x < (sizeX+OffsetFlag); x++)
-            {
-
-               if(x & 0x01)
-               {
-
-                // second pixel in byte
-                // Set color
-                #ifdef USE_PALETTE
-                    SetColor(temp >> 4);
-                #else
-                    SetColor(pallete[temp >> 4]);
-                #endif
-                }
-                else
-                {
-                    temp = *flashAddress++;
-
-                // first pixel in byte
-                // Set color
-                #ifdef USE_PALETTE
-                    SetColor(temp & 0x0f);
-                #else
-                    SetColor(pallete[temp & 0x0f]);
-                #endif
-                }
-
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                    {
-                        // Write pixel(s) to screen, basically writes a tile of 2x2 pixels to the screen
-                        PutPixel(xc,   yc);
-                        PutPixel(xc,   yc+1);  
-                        PutPixel(xc+1, yc);
-                        PutPixel(xc+1, yc+1);  
-                    }
-                    xc += 2;
-            }
-            flashAddress += addressOffset;
-            yc+=2;
-        }
-    }    
 }
         #endif // #if (COLOR_DEPTH >= 4)
 
@@ -3389,12 +4220,10 @@ void __attribute__((weak)) PutImage8BPP(SHORT left, SHORT top, FLASH_BYTE *image
 {
     register FLASH_BYTE *flashAddress;
     WORD                sizeX, sizeY;
-    WORD                x, y;
-    WORD                xc, yc;
-    BYTE                temp;
+    WORD                y, yc;
     WORD                pallete[256];
     WORD                counter;
-    WORD                addressOffset = 0;
+    WORD                lineLength;
 
     // Move pointer to size information
     flashAddress = image + 2;
@@ -3412,77 +4241,22 @@ void __attribute__((weak)) PutImage8BPP(SHORT left, SHORT top, FLASH_BYTE *image
         flashAddress += 2;
     }
 
+    lineLength = sizeX;
+
     if(pPartialImageData->width != 0)
     {
          flashAddress += pPartialImageData->xoffset + pPartialImageData->yoffset*(sizeX);
-         addressOffset = sizeX - pPartialImageData->width;
          sizeY = pPartialImageData->height;
          sizeX = pPartialImageData->width;
     }
 
     yc = top;
-
-    // Note: For speed the code for loops are repeated. A small code size increase for performance
-    if (stretch == IMAGE_NORMAL)
+    for(y = 0; y < sizeY; y++)
     {
-        for(y = 0; y < sizeY; y++)
-        {
-            xc = left;
-            for(x = 0; x < sizeX; x++)
-            {
-                temp = *flashAddress++;
-
-                // Set color
-                #ifdef USE_PALETTE
-                    SetColor(temp);
-                #else
-                    SetColor(pallete[temp]);
-                #endif
-
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                        // Write pixel(s) to screen
-                        PutPixel(xc, yc);
-                    xc++;
-            }   
-            flashAddress += addressOffset;         
-            yc++;
-        }
+        ImageRow8BPP(left, yc, flashAddress, 0, sizeX, stretch, pallete);
+        flashAddress += lineLength;
+        yc += (stretch == IMAGE_NORMAL) ? 1 : 2;
     }
-    else
-    {
-        for(y = 0; y < sizeY; y++)
-        {
-            xc = left;
-            for(x = 0; x < sizeX; x++)
-            {
-                temp = *flashAddress++;
-
-                // Set color
-                #ifdef USE_PALETTE
-                    SetColor(temp);
-                #else
-                    SetColor(pallete[temp]);
-                #endif
-    
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                    {
-                        // Write pixel(s) to screen, basically writes a tile of 2x2 pixels to the screen
-                        PutPixel(xc,   yc);
-                        PutPixel(xc,   yc+1);  
-                        PutPixel(xc+1, yc);
-                        PutPixel(xc+1, yc+1);  
-                    }
-                    xc += 2;
-            }    
-            flashAddress += addressOffset;        
-            yc+=2;
-        }
-    }    
-
 }
         #endif // #if (COLOR_DEPTH >= 8)
 
@@ -3510,10 +4284,8 @@ void __attribute__((weak)) PutImage16BPP(SHORT left, SHORT top, FLASH_BYTE *imag
 {
     register FLASH_WORD *flashAddress;
     WORD                sizeX, sizeY;
-    register WORD       x, y;
-    WORD                xc, yc;
-    WORD                temp;
-    WORD                addressOffset = 0;
+    WORD                y, yc;
+    WORD                lineLength;
 
     // Move pointer to size information
     flashAddress = (FLASH_WORD *)image + 1;
@@ -3523,67 +4295,23 @@ void __attribute__((weak)) PutImage16BPP(SHORT left, SHORT top, FLASH_BYTE *imag
     flashAddress++;
     sizeX = *flashAddress;
     flashAddress++;
-    
+
+    lineLength = sizeX;
+
     if(pPartialImageData->width != 0)
     {
          flashAddress += pPartialImageData->xoffset + pPartialImageData->yoffset*(sizeX);
-         addressOffset = sizeX - pPartialImageData->width;
          sizeY = pPartialImageData->height;
          sizeX = pPartialImageData->width;
     }
 
     yc = top;
-
-    // Note: For speed the code for loops are repeated. A small code size increase for performance
-    if (stretch == IMAGE_NORMAL)
+    for(y = 0; y < sizeY; y++)
     {
-        for(y = 0; y < sizeY; y++)
-        {    
-            xc = left;
-            for(x = 0; x < sizeX; x++)
-            {
-                temp = *flashAddress++;
-                SetColor(temp);
-
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                        // Write pixel(s) to screen
-                        PutPixel(xc, yc);
-                    xc++;
-            }          
-            flashAddress += addressOffset;  
-            yc++;
-        }
+        ImageRow16BPP(left, yc, flashAddress, 0, sizeX, stretch, NULL);
+        flashAddress += lineLength;
+        yc += (stretch == IMAGE_NORMAL) ? 1 : 2;
     }
-    else
-    {
-        for(y = 0; y < sizeY; y++)
-        {
-            xc = left;
-            for(x = 0; x < sizeX; x++)
-            {
-                
-                temp = *flashAddress++;
-                SetColor(temp);
-    
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                    {
-                        // Write pixel(s) to screen, basically writes a tile of 2x2 pixels to the screen
-                        PutPixel(xc,   yc);
-                        PutPixel(xc,   yc+1);  
-                        PutPixel(xc+1, yc);
-                        PutPixel(xc+1, yc+1);  
-                    } 
-                    xc += 2;   
-            }      
-            flashAddress += addressOffset;      
-            yc+=2;
-        }
-    }    
-
 }
 
         #endif //#if (COLOR_DEPTH == 16)
@@ -3614,15 +4342,11 @@ void __attribute__((weak)) PutImage1BPPExt(SHORT left, SHORT top, void *image, B
     BITMAP_HEADER   bmp;
     WORD            pallete[2];
     BYTE            lineBuffer[((GetMaxX() + 1) / 8) + 1];
-    BYTE            *pData;
     SHORT           byteWidth;
 
-    BYTE            temp = 0;
-    BYTE            mask;
     WORD            sizeX, sizeY, lineLength;
-    WORD            x, y;
-    WORD            xc, yc;
-    BYTE                OffsetFlag = 0x01;     //Offset from BYTE color bit0 for the partial image 
+    WORD            y, yc;
+    WORD            index = 0;
 
     // Get image header
     ExternalMemoryCallback(image, 0, sizeof(BITMAP_HEADER), &bmp);
@@ -3634,17 +4358,13 @@ void __attribute__((weak)) PutImage1BPPExt(SHORT left, SHORT top, void *image, B
     memOffset = sizeof(BITMAP_HEADER) + 2 * sizeof(WORD);
 
     // Line width in bytes
-    byteWidth = (bmp.width >> 3);
-    if(bmp.width & 0x07)
-        byteWidth++;
+    byteWidth = (bmp.width + 7) >> 3;
 
     if(pPartialImageData->width != 0)
     {
-
          memOffset += pPartialImageData->yoffset*byteWidth;
          memOffset += (pPartialImageData->xoffset)>>3;
-
-         OffsetFlag <<= ((pPartialImageData->xoffset) & 0x07);
+         index = pPartialImageData->xoffset & 0x07;
 
          sizeY = pPartialImageData->height;
          sizeX = pPartialImageData->width;
@@ -3656,136 +4376,19 @@ void __attribute__((weak)) PutImage1BPPExt(SHORT left, SHORT top, void *image, B
         sizeY = bmp.height;
     }
 
-    // calculate the length of bytes needed per line
-    lineLength = (sizeX >> 3) + 1;
-    if (sizeX & 0x07)
-        lineLength++;
-    
-    yc = top;
-    
-    // Note: For speed the code for loops are repeated. A small code size increase for performance
-    if (stretch == IMAGE_NORMAL)
-    {
-        for(y = 0; y < sizeY; y++)
-        {
-            // Get line
-            ExternalMemoryCallback(image, memOffset, lineLength, lineBuffer);
-            memOffset += byteWidth;
-            
-            pData = lineBuffer;
-            mask = OffsetFlag;
-            temp = *pData++;
-            xc = left;
-            for(x = 0; x < sizeX; x++)
-            {
-                    // Set color
-                    if(mask & temp)
-                    {
-                        // Set color
-                        #ifdef USE_PALETTE
-                            SetColor(1);
-                        #else
-                            SetColor(pallete[1]);
-                        #endif
-                    }
-                    else
-                    {
-                        // Set color
-                        #ifdef USE_PALETTE
-                            SetColor(0);
-                        #else
-                            SetColor(pallete[0]);
-                        #endif
-                    }
-
-
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                        // Write pixel(s) to screen
-                        PutPixel(xc, yc);
-                    xc++;
-
-                // Read 8 pixels from flash
-                if(mask == 0x80)
-                {
-                    temp = *pData++;
-                    mask = 0x01;
-                }
-                else
-                {
-                    // Shift to the next pixel
-                    mask <<= 1;
-                }    
-            }            
-            yc++;
-        }
-    }
-    else
-    {
-        for(y = 0; y < sizeY; y++)
-        {
-            // Get line
-            ExternalMemoryCallback(image, memOffset, lineLength, lineBuffer);
-            memOffset += byteWidth;
-            
-            pData = lineBuffer;
-            mask = OffsetFlag;
-            temp = *pData++;
-            xc = left;
-
-            for(x = 0; x < sizeX; x++)
-            {
-                    // Set color
-                    if(mask & temp)
-                    {
-                        // Set color
-                        #ifdef USE_PALETTE
-                            SetColor(1);
-                        #else
-                            SetColor(pallete[1]);
-                        #endif
-                    }
-                    else
-                    {
-                        // Set color
-                        #ifdef USE_PALETTE
-                            SetColor(0);
-                        #else
-                            SetColor(pallete[0]);
-                        #endif
-                    }
-
-    
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                    {
-                        // Write pixel(s) to screen, basically writes a tile of 2x2 pixels to the screen
-                        PutPixel(xc,   yc);
-                        PutPixel(xc,   yc+1);  
-                        PutPixel(xc+1, yc);
-                        PutPixel(xc+1, yc+1);  
-                    }
-                    xc += 2;
-
-                // Read 8 pixels from flash
-                if(mask == 0x80)
-                {
-                    temp = *pData++;
-                    mask = 0x01;
-                }
-                else
-                {
-                    // Shift to the next pixel
-                    mask <<= 1;
-                }  
+    // bytes holding the pixels drawn from each line
+    lineLength = (index + sizeX + 7) >> 3;
 
-            }            
-            yc+=2;
-        }
-    }    
+    yc = top;
+    for(y = 0; y < sizeY; y++)
+    {
+        // Get line
+        ExternalMemoryCallback(image, memOffset, lineLength, lineBuffer);
+        memOffset += byteWidth;
 
+        ImageRow1BPPExt(left, yc, lineBuffer, index, sizeX, stretch, pallete);
+        yc += (stretch == IMAGE_NORMAL) ? 1 : 2;
+    }
 }
 
 /*********************************************************************
@@ -3814,15 +4417,11 @@ void __attribute__((weak)) PutImage4BPPExt(SHORT left, SHORT top, void *image, B
     BITMAP_HEADER   bmp;
     WORD            pallete[16];
     BYTE            lineBuffer[((GetMaxX() + 1) / 2) + 1];
-    BYTE            *pData;
     SHORT           byteWidth;
 
-    BYTE            temp = 0;
     WORD            sizeX, sizeY, lineLength;
-    WORD            x, y;
-    WORD            xc, yc;
-    WORD            nibbleOffset = 0; 
-
+    WORD            y, yc;
+    WORD            index = 0;
 
     // Get image header
     ExternalMemoryCallback(image, 0, sizeof(BITMAP_HEADER), &bmp);
@@ -3833,21 +4432,14 @@ void __attribute__((weak)) PutImage4BPPExt(SHORT left, SHORT top, void *image, B
     // Set offset to the image data
     memOffset = sizeof(BITMAP_HEADER) + 16 * sizeof(WORD);
 
-     // Line width in bytes
-    byteWidth = (bmp.width) >> 1;
-
-    // if the width is odd, add another byte count since the shift 1 caused
-    // us to loose a nibble
-    if(bmp.width & 0x01)
-        byteWidth++;
+    // Line width in bytes
+    byteWidth = (bmp.width + 1) >> 1;
 
     if(pPartialImageData->width != 0)
     {
-        // check the bit position of the starting pixel
-        nibbleOffset = pPartialImageData->xoffset & 0x01;
-
         memOffset += (pPartialImageData->yoffset)*byteWidth;
         memOffset += (pPartialImageData->xoffset) >> 1;
+        index = pPartialImageData->xoffset & 0x01;
 
         sizeY = pPartialImageData->height;
         sizeX = pPartialImageData->width;
@@ -3859,125 +4451,19 @@ void __attribute__((weak)) PutImage4BPPExt(SHORT left, SHORT top, void *image, B
         sizeY = bmp.height;
     }
 
-    // calculate the length of bytes needed per line
-    lineLength = (sizeX >> 1) + 1;
-    if (sizeX & 0x01)
-        lineLength++;
+    // bytes holding the pixels drawn from each line
+    lineLength = (index + sizeX + 1) >> 1;
 
     yc = top;
-
-    // Note: For speed the code for loops are repeated. A small code size increase for performance
-    if (stretch == IMAGE_NORMAL)
+    for(y = 0; y < sizeY; y++)
     {
-        for(y = 0; y < sizeY; y++)
-        {
-            // Get line
-            ExternalMemoryCallback(image, memOffset, lineLength, lineBuffer);
-            memOffset += byteWidth;
-            
-            pData = lineBuffer;
-            if (nibbleOffset)
-            {
-                temp = *pData++;
-            }
-            
-            xc = left;
-            for(x = nibbleOffset; x < (sizeX + nibbleOffset); x++)
-            {
-                
-                // Read 2 pixels from flash
-                if(x & 0x0001)
-                {
-
-                    // second pixel in byte
-                    // Set color
-                    #ifdef USE_PALETTE
-                        SetColor(temp >> 4);
-                    #else
-                        SetColor(pallete[temp >> 4]);
-                    #endif
-                }
-                else
-                {
-                    temp = *pData++;
-
-                    // first pixel in byte
-                    // Set color
-                    #ifdef USE_PALETTE
-                        SetColor(temp & 0x0f);
-                    #else
-                        SetColor(pallete[temp & 0x0f]);
-                    #endif
-                }
+        // Get line
+        ExternalMemoryCallback(image, memOffset, lineLength, lineBuffer);
+        memOffset += byteWidth;
 
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                        // Write pixel(s) to screen
-                        PutPixel(xc, yc);
-                    xc++;
-            }            
-            yc++;
-        }
+        ImageRow4BPPExt(left, yc, lineBuffer, index, sizeX, stretch, pallete);
+        yc += (stretch == IMAGE_NORMAL) ? 1 : 2;
     }
-    else
-    {
-        for(y = 0; y < sizeY; y++)
-        {
-            // Get line
-            ExternalMemoryCallback(image, memOffset, lineLength, lineBuffer);
-            memOffset += byteWidth;
-            
-            pData = lineBuffer;
-            if (nibbleOffset)
-            {
-                temp = *pData++;
-            }
-            
-            xc = left;
-            for(x = nibbleOffset; x < (sizeX + nibbleOffset); x++)
-            {
-
-                // Read 2 pixels from flash
-                if(x & 0x0001)
-                {
-
-                    // second pixel in byte
-                    // Set color
-                    #ifdef USE_PALETTE
-                        SetColor(temp >> 4);
-                    #else
-                        SetColor(pallete[temp >> 4]);
-                    #endif
-                }
-                else
-                {
-                    temp = *pData++;
-
-                    // first pixel in byte
-                    // Set color
-                    #ifdef USE_PALETTE
-                        SetColor(temp & 0x0f);
-                    #else
-                        SetColor(pallete[temp & 0x0f]);
-                    #endif
-                }
-
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                    {    
-                        // Write pixel(s) to screen, basically writes a tile of 2x2 pixels to the screen
-                        PutPixel(xc,   yc);
-                        PutPixel(xc,   yc+1);  
-                        PutPixel(xc+1, yc);
-                        PutPixel(xc+1, yc+1);  
-                    }
-                    xc += 2;
-            }            
-            yc+=2;
-        }
-    }    
 }
 
         #endif
@@ -4008,12 +4494,9 @@ void __attribute__((weak)) PutImage8BPPExt(SHORT left, SHORT top, void *image, B
     BITMAP_HEADER   bmp;
     WORD            pallete[256];
     BYTE            lineBuffer[(GetMaxX() + 1)];
-    BYTE            *pData;
 
-    BYTE            temp;
     WORD            sizeX, sizeY;
-    WORD            x, y;
-    WORD            xc, yc;
+    WORD            y, yc;
 
     // Get image header
     ExternalMemoryCallback(image, 0, sizeof(BITMAP_HEADER), &bmp);
@@ -4038,78 +4521,15 @@ void __attribute__((weak)) PutImage8BPPExt(SHORT left, SHORT top, void *image, B
     }
 
     yc = top;
-
-    // Note: For speed the code for loops are repeated. A small code size increase for performance
-    if (stretch == IMAGE_NORMAL)
-    {
-        for(y = 0; y < sizeY; y++)
-        {
-            // Get line
-            ExternalMemoryCallback(image, memOffset, sizeX, lineBuffer);
-            memOffset += bmp.width;
-            
-            pData = lineBuffer;
-            
-            xc = left;
-            for(x = 0; x < sizeX; x++)
-            {
-                temp = *pData++;
-                
-                // Set color
-                #ifdef USE_PALETTE
-                    SetColor(temp);
-                #else
-                    SetColor(pallete[temp]);
-                #endif
-
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                        // Write pixel(s) to screen
-                        PutPixel(xc, yc);
-                    xc++;
-            }            
-            yc++;
-        }
-    }
-    else
+    for(y = 0; y < sizeY; y++)
     {
-        for(y = 0; y < sizeY; y++)
-        {
-            // Get line
-            ExternalMemoryCallback(image, memOffset, sizeX, lineBuffer);
-            memOffset += bmp.width;
-            
-            pData = lineBuffer;
-            
-            xc = left;
-            for(x = 0; x < sizeX; x++)
-            {
-                temp = *pData++;
-
-                // Set color
-                #ifdef USE_PALETTE
-                    SetColor(temp);
-                #else
-                    SetColor(pallete[temp]);
-                #endif
-    
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                    {
-                        // Write pixel(s) to screen, basically writes a tile of 2x2 pixels to the screen
-                        PutPixel(xc,   yc);
-                        PutPixel(xc,   yc+1);  
-                        PutPixel(xc+1, yc);
-                        PutPixel(xc+1, yc+1);  
-                    }
-                    xc += 2;
-            }            
-            yc+=2;
-        }
-    }    
+        // Get line
+        ExternalMemoryCallback(image, memOffset, sizeX, lineBuffer);
+        memOffset += bmp.width;
 
+        ImageRow8BPPExt(left, yc, lineBuffer, 0, sizeX, stretch, pallete);
+        yc += (stretch == IMAGE_NORMAL) ? 1 : 2;
+    }
 }
 
         #endif
@@ -4139,13 +4559,10 @@ void __attribute__((weak)) PutImage16BPPExt(SHORT left, SHORT top, void *image,
     register DWORD  memOffset;
     BITMAP_HEADER   bmp;
     WORD            lineBuffer[(GetMaxX() + 1)];
-    WORD            *pData;
     WORD            byteWidth;
 
-    WORD            temp;
     WORD            sizeX, sizeY;
-    WORD            x, y;
-    WORD            xc, yc;
+    WORD            y, yc;
 
     // Get image header
     ExternalMemoryCallback(image, 0, sizeof(BITMAP_HEADER), &bmp);
@@ -4167,65 +4584,22 @@ void __attribute__((weak)) PutImage16BPPExt(SHORT left, SHORT top, void *image,
     }
 
     byteWidth = bmp.width << 1;
-    yc = top;
 
-    // Note: For speed the code for loops are repeated. A small code size increase for performance
-    if (stretch == IMAGE_NORMAL)
+    yc = top;
+    for(y = 0; y < sizeY; y++)
     {
-        for(y = 0; y < sizeY; y++)
-        {
-            // Get line
-            ExternalMemoryCallback(image, memOffset, byteWidth, lineBuffer);
-            memOffset += byteWidth;
-            
-            pData = lineBuffer;
-            
-            xc = left;
-            for(x = 0; x < sizeX; x++)
-                {
-                temp = *pData++;
-                SetColor(temp);
-
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                        // Write pixel(s) to screen
-                        PutPixel(xc, yc);
-                    xc++;
-            }            
-            yc++;
-        }
+        // Get line
+        ExternalMemoryCallback(image, memOffset, sizeX << 1, lineBuffer);
+        memOffset += byteWidth;
+
+        // the line is already in the display format, only stretched 
+        // lines have to be converted
+        if(stretch == IMAGE_NORMAL)
+            ImageRowWrite(left, yc, (GFX_COLOR *)lineBuffer, sizeX, stretch);
+        else
+            ImageRow16BPPExt(left, yc, lineBuffer, 0, sizeX, stretch, NULL);
+        yc += (stretch == IMAGE_NORMAL) ? 1 : 2;
     }
-    else
-    {
-        for(y = 0; y < sizeY; y++)
-        {
-            // Get line
-            ExternalMemoryCallback(image, memOffset, byteWidth, lineBuffer);
-            memOffset += byteWidth;
-            pData = lineBuffer;
-            
-            xc = left;
-            for(x = 0; x < sizeX; x++)
-                {
-                temp = *pData++;
-                SetColor(temp);
-    
-                #ifdef USE_TRANSPARENT_COLOR
-                    if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                #endif
-                    {
-                        // Write pixel(s) to screen, basically writes a tile of 2x2 pixels to the screen
-                        PutPixel(xc,   yc);
-                        PutPixel(xc,   yc+1);  
-                        PutPixel(xc+1, yc);
-                        PutPixel(xc+1, yc+1);  
-                    }
-                    xc += 2;
-            }            
-            yc+=2;
-        }
-    }    
 }
 
         #endif
@@ -4807,6 +5181,10 @@ WORD BevelGradient(SHORT left, SHORT top, SHORT right, SHORT bottom, SHORT rad,
         return (1);
     }
 
+    // the bars below are not checked, they must not stop at the end of
+    // a time slice
+    GFXTimeSliceHold();
+
     //Calculate the starting RGB values
     sred    = GetRed(color1);
     sgreen  = GetGreen(color1);
@@ -5175,12 +5553,14 @@ WORD BevelGradient(SHORT left, SHORT top, SHORT right, SHORT bottom, SHORT rad,
                 else
                 {
                     state = BEGIN;
+                    GFXTimeSliceRelease();
                     return (1);
                 }
 
             case WAITFORDONE:
                 while(IsDeviceBusy());
                 state = BEGIN;
+                GFXTimeSliceRelease();
                 return (1);
         }           // end of switch
     }               // end of while
@@ -5191,26 +5571,169 @@ WORD BevelGradient(SHORT left, SHORT top, SHORT right, SHORT bottom, SHORT rad,
 
 #ifdef USE_COMP_RLE
 
+/*********************************************************************
+* Overview: Number of literal colors collected before they are sent 
+*           to PutSpanColors() as one block.
+*
+********************************************************************/
+#define RLE_SPAN_COLORS     32
+
+/*********************************************************************
+* Overview: Output state of the RLE image blitter for the current row.
+*           Runs are drawn as one span of a single color, literal 
+*           pixels are converted through the palette into color[] and
+*           written as one block.
+*
+********************************************************************/
+typedef struct
+{
+    SHORT       x;                          // position of the next pixel
+    SHORT       y;                          // row being drawn
+    BYTE        stretch;                    // image stretch factor
+    BYTE        count;                      // colors waiting in color[]
+    GFX_COLOR   color[RLE_SPAN_COLORS];
+} RLE_SPAN;
+
+/*********************************************************************
+* Function: static void RLESpanFlush(RLE_SPAN *pSpan)
+*
+* Overview: Clips the collected literal colors and writes them with
+*           PutSpanColors().
+*
+********************************************************************/
+static void RLESpanFlush(RLE_SPAN *pSpan)
+{
+    ImageSpanPut(pSpan->x - pSpan->count, pSpan->y, pSpan->color, pSpan->count);
+    pSpan->count = 0;
+}
+
+/*********************************************************************
+* Function: static void RLESpanFill(RLE_SPAN *pSpan, GFX_COLOR color, WORD length)
+*
+* Overview: Draws a run of length image pixels of the same color as a
+*           single span.
+*
+********************************************************************/
+static void RLESpanFill(RLE_SPAN *pSpan, GFX_COLOR color, WORD length)
+{
+    WORD    width;
+
+    RLESpanFlush(pSpan);
+
+    width = length * pSpan->stretch;
+    if(width == 0)
+        return;
+
+    if(!IMAGE_IS_TRANSPARENT(color))
+    {
+        SetColor(color);
+        LineSpanH(pSpan->x, pSpan->x + width - 1, pSpan->y);
+    }
+    pSpan->x += width;
+}
+
+/*********************************************************************
+* Function: static void RLESpanPixel(RLE_SPAN *pSpan, GFX_COLOR color)
+*
+* Overview: Adds one literal pixel to the current block. Stretched and
+*           transparent pixels are handled as runs of one pixel.
+*
+********************************************************************/
+static void RLESpanPixel(RLE_SPAN *pSpan, GFX_COLOR color)
+{
+    if((pSpan->stretch > 1) || IMAGE_IS_TRANSPARENT(color))
+    {
+        RLESpanFill(pSpan, color, 1);
+        return;
+    }
+
+    pSpan->color[pSpan->count++] = color;
+    pSpan->x++;
+    if(pSpan->count == RLE_SPAN_COLORS)
+        RLESpanFlush(pSpan);
+}
+
+    #ifdef USE_BITMAP_EXTERNAL
+
+/*********************************************************************
+* Overview: Block reader for RLE images in external memory. The image 
+*           data is fetched RLE_EXTERNAL_BUFFER_SIZE bytes at a time 
+*           instead of a few bytes per code.
+*
+********************************************************************/
+typedef struct
+{
+    void        *image;
+    DWORD       address;                    // external memory address of buffer[0]
+    WORD        length;                     // valid bytes in buffer[]
+    WORD        index;                      // next byte to use
+    BYTE        buffer[RLE_EXTERNAL_BUFFER_SIZE];
+} RLE_EXT_SOURCE;
+
+/*********************************************************************
+* Function: static void RLEExtSeek(RLE_EXT_SOURCE *pSource, DWORD memAddress)
+*
+* Overview: Moves the reader to memAddress. The buffer is kept when the
+*           address is inside it (stretched images decode a row again).
+*
+********************************************************************/
+static void RLEExtSeek(RLE_EXT_SOURCE *pSource, DWORD memAddress)
+{
+    if((memAddress >= pSource->address) && (memAddress < pSource->address + pSource->length))
+    {
+        pSource->index = memAddress - pSource->address;
+    }
+    else
+    {
+        pSource->address = memAddress;
+        pSource->length = 0;
+        pSource->index = 0;
+    }
+}
+
+/*********************************************************************
+* Function: static BYTE RLEExtGet(RLE_EXT_SOURCE *pSource)
+*
+* Overview: Returns the next image byte, the buffer is refilled with
+*           one ExternalMemoryCallback() when it is used up.
+*
+********************************************************************/
+static BYTE RLEExtGet(RLE_EXT_SOURCE *pSource)
+{
+    if(pSource->index == pSource->length)
+    {
+        pSource->address += pSource->length;
+        ExternalMemoryCallback(pSource->image, pSource->address, RLE_EXTERNAL_BUFFER_SIZE, pSource->buffer);
+        pSource->length = RLE_EXTERNAL_BUFFER_SIZE;
+        pSource->index = 0;
+    }
+    return (pSource->buffer[pSource->index++]);
+}
+
+    #endif //#ifdef USE_BITMAP_EXTERNAL
+
     #ifdef USE_BITMAP_FLASH
 
         #if (COLOR_DEPTH >= 8)
 /*********************************************************************
-* Function: WORD DecodeRLE8(FLASH_BYTE *flashAddress, BYTE *pixelrow, WORD size)
+* Function: static WORD BlitRLE8(FLASH_BYTE *flashAddress, RLE_SPAN *pSpan, WORD size, GFX_COLOR *pPalette)
 *
-* PreCondition: tempFlashAddress should point to the beginning of a RLE compressed block
+* PreCondition: flashAddress should point to the beginning of a RLE compressed row
 *
-* Input: flashAddress - Address of the beginning of a RLE compressed block
-*        pixelrow - Pointer to an array where the decoded row must be stored
-*        size - Size of the decoded data in bytes
+* Input: flashAddress - Address of the beginning of a RLE compressed row
+*        pSpan - Output position, the row is drawn from pSpan->x
+*        size - Number of pixels in the row
+*        pPalette - Image palette (not used with USE_PALETTE)
 *
 * Output: Number of source bytes traversed
 *
 * Side Effects: none
 *
-* Overview: Decodes the data
+* Overview: Decodes one row and draws it. Runs are drawn as single spans, 
+*           literal pixels as blocks of palette converted colors.
 *
 ********************************************************************/
-WORD DecodeRLE8(FLASH_BYTE *flashAddress, BYTE *pixel_row, WORD size)
+static WORD BlitRLE8(FLASH_BYTE *flashAddress, RLE_SPAN *pSpan, WORD size, GFX_COLOR *pPalette)
 {
     WORD sourceOffset = 0;
     WORD decodeSize = 0;
@@ -5225,34 +5748,33 @@ WORD DecodeRLE8(FLASH_BYTE *flashAddress, BYTE *pixel_row, WORD size)
         {
             decodeSize += code;
             
-            if(decodeSize > size) //To avoid writing oustide the array bounds
+            if(decodeSize > size) //To avoid writing oustide the row
             {
                 code -= (decodeSize - size);
             }
             
-            while(code)
-            {
-                *pixel_row++ = value;
-                code--;
-            }
+            RLESpanFill(pSpan, IMAGE_COLOR(pPalette, value), code);
         }
         else
         {
             decodeSize += value;
             sourceOffset += value;
             
-            if(decodeSize > size) //To avoid writing oustide the array bounds
+            if(decodeSize > size) //To avoid writing oustide the row
             {
                 value -= (decodeSize - size);
             }
             
             while(value)
             {
-                *pixel_row++ = *flashAddress++;
+                RLESpanPixel(pSpan, IMAGE_COLOR(pPalette, (BYTE)*flashAddress));
+                flashAddress++;
                 value--;
             }
         }
     }    
+
+    RLESpanFlush(pSpan);
     return (sourceOffset);
 }
 
@@ -5277,17 +5799,14 @@ void PutImageRLE8BPP(SHORT left, SHORT top, FLASH_BYTE *image, BYTE stretch)
 {
     register FLASH_BYTE *flashAddress;
     WORD                sizeX, sizeY;
-    WORD                x, y;
-    WORD                xc, yc;
-    BYTE                temp;
-    BYTE                stretchX, stretchY;
+    WORD                y;
+    BYTE                stretchY;
 #ifndef USE_PALETTE
     GFX_COLOR           imagePalette[256];
     WORD                counter;
 #endif
-    BYTE                pixelrow[GetMaxX() + 1];
-    WORD                offset;
-    BYTE                *pixelAddress;
+    RLE_SPAN            span;
+    WORD                offset = 0;
 
     // Move pointer to size information
     flashAddress = image + 2;
@@ -5329,44 +5848,24 @@ void PutImageRLE8BPP(SHORT left, SHORT top, FLASH_BYTE *image, BYTE stretch)
 
     #endif
     
-    yc = top;
+    span.stretch = stretch;
+    span.count = 0;
+    span.y = top;
 
     for(y = 0; y < sizeY; y++)
     {
-        offset = DecodeRLE8(flashAddress, pixelrow, sizeX);
-        flashAddress += offset;
-        
+        // a stretched row is decoded again for each of its screen rows
         for(stretchY = 0; stretchY < stretch; stretchY++)
         {
-            pixelAddress = pixelrow;
-            xc = left;
-            for(x = 0; x < sizeX; x++)
-            {
-
-                // Read pixels from flash
-                temp = *pixelAddress;
-                pixelAddress++;
-
-                // Set color
-            #ifdef USE_PALETTE
-                SetColor(temp);
-            #else
-                SetColor(imagePalette[temp]);
-            #endif
-
-                // Write pixel to screen
-                for(stretchX = 0; stretchX < stretch; stretchX++)
-                {
-                    #ifdef USE_TRANSPARENT_COLOR
-                        if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                    #endif
-                            PutPixel(xc, yc);
-                        xc++;    
-                }
-            }
-
-            yc++;
+            span.x = left;
+        #ifdef USE_PALETTE
+            offset = BlitRLE8(flashAddress, &span, sizeX, NULL);
+        #else
+            offset = BlitRLE8(flashAddress, &span, sizeX, imagePalette);
+        #endif
+            span.y++;
         }
+        flashAddress += offset;
     }
 }
         #endif //#if (COLOR_DEPTH >= 8)
@@ -5374,22 +5873,26 @@ void PutImageRLE8BPP(SHORT left, SHORT top, FLASH_BYTE *image, BYTE stretch)
         #if (COLOR_DEPTH >= 4)
         
 /*********************************************************************
-* Function: WORD DecodeRLE4(FLASH_BYTE *flashAddress, BYTE *pixelrow, WORD size)
+* Function: static WORD BlitRLE4(FLASH_BYTE *flashAddress, RLE_SPAN *pSpan, WORD size, GFX_COLOR *pPalette)
 *
-* PreCondition: tempFlashAddress should point to the beginning of a RLE compressed block
+* PreCondition: flashAddress should point to the beginning of a RLE compressed row
 *
-* Input: flashAddress - Address of the beginning of a RLE compressed block
-*        pixelrow - Pointer to an array where the decoded row must be stored
-*        size - Size of the decoded data in bytes
+* Input: flashAddress - Address of the beginning of a RLE compressed row
+*        pSpan - Output position, the row is drawn from pSpan->x
+*        size - Number of pixels in the row
+*        pPalette - Image palette (not used with USE_PALETTE)
 *
 * Output: Number of source bytes traversed
 *
 * Side Effects: none
 *
-* Overview: Decodes the data
+* Overview: Decodes one row and draws it. A run alternates the two 
+*           colors of its value byte, runs of one color are drawn as 
+*           single spans. Literal pixels are drawn as blocks of palette 
+*           converted colors.
 *
 ********************************************************************/
-WORD DecodeRLE4(FLASH_BYTE *flashAddress, BYTE *pixel_row, WORD size)
+static WORD BlitRLE4(FLASH_BYTE *flashAddress, RLE_SPAN *pSpan, WORD size, GFX_COLOR *pPalette)
 {
     WORD sourceOffset = 0;
     WORD decodeSize = 0;
@@ -5398,7 +5901,7 @@ WORD DecodeRLE4(FLASH_BYTE *flashAddress, BYTE *pixel_row, WORD size)
     {
         BYTE code = *flashAddress++;
         BYTE value = *flashAddress++;
-        BYTE counter;
+        BYTE counter, temp = 0;
         
         sourceOffset += 2;
         
@@ -5406,20 +5909,23 @@ WORD DecodeRLE4(FLASH_BYTE *flashAddress, BYTE *pixel_row, WORD size)
         {
             decodeSize += code;
             
-            if(decodeSize > size) //To avoid writing oustide the array bounds
+            if(decodeSize > size) //To avoid writing oustide the row
             {
                 code -= (decodeSize - size);
             }
             
-            for(counter = 0; counter < code; counter++)
+            if((code == 1) || ((value >> 4) == (value & 0x0F)))
             {
-                if(counter & 0x01)
-                {
-                    *pixel_row++ = (value >> 4) & 0x0F;
-                }
-                else
+                RLESpanFill(pSpan, IMAGE_COLOR(pPalette, value & 0x0F), code);
+            }
+            else
+            {
+                for(counter = 0; counter < code; counter++)
                 {
-                    *pixel_row++ = (value) & 0x0F;
+                    if(counter & 0x01)
+                        RLESpanPixel(pSpan, IMAGE_COLOR(pPalette, value >> 4));
+                    else
+                        RLESpanPixel(pSpan, IMAGE_COLOR(pPalette, value & 0x0F));
                 }
             }
         }
@@ -5428,7 +5934,7 @@ WORD DecodeRLE4(FLASH_BYTE *flashAddress, BYTE *pixel_row, WORD size)
             decodeSize += value;
             sourceOffset += (value + 1) >> 1;
             
-            if(decodeSize > size) //To avoid writing oustide the array bounds
+            if(decodeSize > size) //To avoid writing oustide the row
             {
                 value -= (decodeSize - size);
             }
@@ -5437,17 +5943,18 @@ WORD DecodeRLE4(FLASH_BYTE *flashAddress, BYTE *pixel_row, WORD size)
             {
                 if(counter & 0x01)
                 {
-                    *pixel_row++ = (*flashAddress >> 4) & 0x0F;
-                    flashAddress++;
+                    RLESpanPixel(pSpan, IMAGE_COLOR(pPalette, temp >> 4));
                 }
                 else
                 {
-                    *pixel_row++ = (*flashAddress) & 0x0F;
+                    temp = *flashAddress++;
+                    RLESpanPixel(pSpan, IMAGE_COLOR(pPalette, temp & 0x0F));
                 }
             }
         }
     }
 
+    RLESpanFlush(pSpan);
     return (sourceOffset);
 }
 
@@ -5472,17 +5979,14 @@ void PutImageRLE4BPP(SHORT left, SHORT top, FLASH_BYTE *image, BYTE stretch)
 {
     register FLASH_BYTE *flashAddress;
     WORD                sizeX, sizeY;
-    register WORD       x, y;
-    WORD                xc, yc;
-    BYTE                temp = 0;
-    register BYTE       stretchX, stretchY;
+    register WORD       y;
+    register BYTE       stretchY;
 #ifndef USE_PALETTE
     GFX_COLOR           imagePalette[16];
     WORD                counter;
 #endif
-    BYTE                pixelrow[GetMaxX() + 1];
-    WORD                offset;
-    BYTE                *pixelAddress;
+    RLE_SPAN            span;
+    WORD                offset = 0;
 
     // Move pointer to size information
     flashAddress = image + 2;
@@ -5521,41 +6025,24 @@ void PutImageRLE4BPP(SHORT left, SHORT top, FLASH_BYTE *image, BYTE stretch)
         }
     #endif
 
-    yc = top;
-    
+    span.stretch = stretch;
+    span.count = 0;
+    span.y = top;
+
     for(y = 0; y < sizeY; y++)
     {
-        offset = DecodeRLE4(flashAddress, pixelrow, sizeX);
-        flashAddress += offset;
-
+        // a stretched row is decoded again for each of its screen rows
         for(stretchY = 0; stretchY < stretch; stretchY++)
         {
-            pixelAddress = pixelrow;
-            xc = left;
-            for(x = 0; x < sizeX; x++)
-            {
-                temp = *pixelAddress;
-                pixelAddress++;
-
-                #ifdef USE_PALETTE
-                    SetColor(temp);
-                #else
-                    SetColor(imagePalette[temp]);
-                #endif
-
-                // Write pixel to screen
-                for(stretchX = 0; stretchX < stretch; stretchX++)
-                {
-                    #ifdef USE_TRANSPARENT_COLOR
-                        if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                    #endif
-                            PutPixel(xc, yc);
-                        xc++;    
-                }
-            }
-
-            yc++;
+            span.x = left;
+        #ifdef USE_PALETTE
+            offset = BlitRLE4(flashAddress, &span, sizeX, NULL);
+        #else
+            offset = BlitRLE4(flashAddress, &span, sizeX, imagePalette);
+        #endif
+            span.y++;
         }
+        flashAddress += offset;
     }
 }
         #endif //#if (COLOR_DEPTH >= 4)
@@ -5567,68 +6054,68 @@ void PutImageRLE4BPP(SHORT left, SHORT top, FLASH_BYTE *image, BYTE stretch)
         #if (COLOR_DEPTH >= 8)
 
 /*********************************************************************
-* Function: WORD DecodeRLE8Ext(void *image, DWORD  memAddress, BYTE *pixelrow, WORD size)
+* Function: static WORD BlitRLE8Ext(RLE_EXT_SOURCE *pSource, DWORD memAddress, RLE_SPAN *pSpan, WORD size, GFX_COLOR *pPalette)
 *
-* PreCondition: tempFlashAddress should point to the beginning of a RLE compressed block
+* PreCondition: memAddress should point to the beginning of a RLE compressed row
 *
-* Input: image - External memory image pointer
-*        memAddress - Address of the beginning of a RLE compressed block
-*        pixelrow - Pointer to an array where the decoded row must be stored
-*        size - Size of the decoded data in bytes
+* Input: pSource - Block reader of the external memory image
+*        memAddress - Address of the beginning of a RLE compressed row
+*        pSpan - Output position, the row is drawn from pSpan->x
+*        size - Number of pixels in the row
+*        pPalette - Image palette (not used with USE_PALETTE)
 *
 * Output: Number of source bytes traversed
 *
 * Side Effects: none
 *
-* Overview: Decodes the data from the external flash
+* Overview: Decodes one row from external memory and draws it. Runs are 
+*           drawn as single spans, literal pixels as blocks of palette 
+*           converted colors.
 *
 ********************************************************************/
-WORD DecodeRLE8Ext(void *image, DWORD memAddress, BYTE *pixel_row, WORD size)
+static WORD BlitRLE8Ext(RLE_EXT_SOURCE *pSource, DWORD memAddress, RLE_SPAN *pSpan, WORD size, GFX_COLOR *pPalette)
 {
     WORD sourceOffset = 0;
     WORD decodeSize = 0;
 
+    RLEExtSeek(pSource, memAddress);
+
     while(decodeSize < size)
     {
-        BYTE code, value;
-        
-        ExternalMemoryCallback(image, memAddress, sizeof(BYTE), &code);
-        memAddress++;
-        ExternalMemoryCallback(image, memAddress, sizeof(BYTE), &value);
-        memAddress++;
-
+        BYTE code = RLEExtGet(pSource);
+        BYTE value = RLEExtGet(pSource);
         sourceOffset += 2;
         
         if(code > 0)
         {
             decodeSize += code;
             
-            if(decodeSize > size) //To avoid writing oustide the array bounds
+            if(decodeSize > size) //To avoid writing oustide the row
             {
                 code -= (decodeSize - size);
             }
             
-            while(code)
-            {
-                *pixel_row++ = value;
-                code--;
-            }
+            RLESpanFill(pSpan, IMAGE_COLOR(pPalette, value), code);
         }
         else
         {
             decodeSize += value;
             sourceOffset += value;
             
-            if(decodeSize > size) //To avoid writing oustide the array bounds
+            if(decodeSize > size) //To avoid writing oustide the row
             {
                 value -= (decodeSize - size);
             }
             
-            ExternalMemoryCallback(image, memAddress, value * sizeof(BYTE), pixel_row);
-            pixel_row += value;
-            memAddress += value;
+            while(value)
+            {
+                RLESpanPixel(pSpan, IMAGE_COLOR(pPalette, RLEExtGet(pSource)));
+                value--;
+            }
         }
     }    
+
+    RLESpanFlush(pSpan);
     return (sourceOffset);
 }
 
@@ -5656,15 +6143,13 @@ void PutImageRLE8BPPExt(SHORT left, SHORT top, void *image, BYTE stretch)
 #ifndef USE_PALETTE
     GFX_COLOR       imagePalette[256];
 #endif
-    BYTE            pixelrow[(GetMaxX() + 1)];
-    BYTE            *pixelAddress;
+    RLE_EXT_SOURCE  source;
+    RLE_SPAN        span;
 
-    BYTE            temp;
     WORD            sizeX, sizeY;
-    WORD            x, y;
-    WORD            xc, yc;
-    BYTE            stretchX, stretchY;
-    WORD            offset;
+    WORD            y;
+    BYTE            stretchY;
+    WORD            offset = 0;
 
     // Get image header
     ExternalMemoryCallback(image, 0, sizeof(BITMAP_HEADER), &bmp);
@@ -5689,43 +6174,29 @@ void PutImageRLE8BPPExt(SHORT left, SHORT top, void *image, BYTE stretch)
     sizeX = bmp.width;
     sizeY = bmp.height;
 
-    yc = top;
+    source.image = image;
+    source.address = 0;
+    source.length = 0;
+    source.index = 0;
+
+    span.stretch = stretch;
+    span.count = 0;
+    span.y = top;
+
     for(y = 0; y < sizeY; y++)
     {
-        offset = DecodeRLE8Ext(image, memOffset, pixelrow, sizeX);
-        memOffset += offset;
-        
+        // a stretched row is decoded again for each of its screen rows
         for(stretchY = 0; stretchY < stretch; stretchY++)
         {
-            pixelAddress = pixelrow;
-            xc = left;
-            for(x = 0; x < sizeX; x++)
-            {
-
-                // Read pixels from flash
-                temp = *pixelAddress;
-                pixelAddress++;
-
-                // Set color
-            #ifdef USE_PALETTE
-                SetColor(temp);
-            #else
-                SetColor(imagePalette[temp]);
-            #endif
-
-                // Write pixel to screen
-                for(stretchX = 0; stretchX < stretch; stretchX++)
-                {
-                    #ifdef USE_TRANSPARENT_COLOR
-                        if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                    #endif
-                            PutPixel(xc, yc);
-                        xc++;    
-                }
-            }
-
-            yc++;
+            span.x = left;
+        #ifdef USE_PALETTE
+            offset = BlitRLE8Ext(&source, memOffset, &span, sizeX, NULL);
+        #else
+            offset = BlitRLE8Ext(&source, memOffset, &span, sizeX, imagePalette);
+        #endif
+            span.y++;
         }
+        memOffset += offset;
     }
 }
         #endif //#if (COLOR_DEPTH >= 8)
@@ -5733,36 +6204,38 @@ void PutImageRLE8BPPExt(SHORT left, SHORT top, void *image, BYTE stretch)
         #if (COLOR_DEPTH >= 4)
 
 /*********************************************************************
-* Function: WORD DecodeRLE4Ext(void *image, DWORD memAddress, BYTE *pixelrow, WORD size)
+* Function: static WORD BlitRLE4Ext(RLE_EXT_SOURCE *pSource, DWORD memAddress, RLE_SPAN *pSpan, WORD size, GFX_COLOR *pPalette)
 *
-* PreCondition: tempFlashAddress should point to the beginning of a RLE compressed block
+* PreCondition: memAddress should point to the beginning of a RLE compressed row
 *
-* Input: image - External memory image pointer
-*        memAddress - Address of the beginning of a RLE compressed block
-*        pixelrow - Pointer to an array where the decoded row must be stored
-*        size - Size of the decoded data in bytes
+* Input: pSource - Block reader of the external memory image
+*        memAddress - Address of the beginning of a RLE compressed row
+*        pSpan - Output position, the row is drawn from pSpan->x
+*        size - Number of pixels in the row
+*        pPalette - Image palette (not used with USE_PALETTE)
 *
 * Output: Number of source bytes traversed
 *
 * Side Effects: none
 *
-* Overview: Decodes the data
+* Overview: Decodes one row from external memory and draws it. A run 
+*           alternates the two colors of its value byte, runs of one 
+*           color are drawn as single spans. Literal pixels are drawn 
+*           as blocks of palette converted colors.
 *
 ********************************************************************/
-WORD DecodeRLE4Ext(void *image, DWORD memAddress, BYTE *pixel_row, WORD size)
+static WORD BlitRLE4Ext(RLE_EXT_SOURCE *pSource, DWORD memAddress, RLE_SPAN *pSpan, WORD size, GFX_COLOR *pPalette)
 {
     WORD sourceOffset = 0;
     WORD decodeSize = 0;
 
+    RLEExtSeek(pSource, memAddress);
+
     while(decodeSize < size)
     {
-        BYTE code, value;
-        BYTE counter, temp;
-        
-        ExternalMemoryCallback(image, memAddress, sizeof(BYTE), &code);
-        memAddress++;
-        ExternalMemoryCallback(image, memAddress, sizeof(BYTE), &value);
-        memAddress++;
+        BYTE code = RLEExtGet(pSource);
+        BYTE value = RLEExtGet(pSource);
+        BYTE counter, temp = 0;
         
         sourceOffset += 2;
         
@@ -5770,20 +6243,23 @@ WORD DecodeRLE4Ext(void *image, DWORD memAddress, BYTE *pixel_row, WORD size)
         {
             decodeSize += code;
             
-            if(decodeSize > size) //To avoid writing oustide the array bounds
+            if(decodeSize > size) //To avoid writing oustide the row
             {
                 code -= (decodeSize - size);
             }
             
-            for(counter = 0; counter < code; counter++)
+            if((code == 1) || ((value >> 4) == (value & 0x0F)))
             {
-                if(counter & 0x01)
-                {
-                    *pixel_row++ = (value >> 4) & 0x0F;
-                }
-                else
+                RLESpanFill(pSpan, IMAGE_COLOR(pPalette, value & 0x0F), code);
+            }
+            else
+            {
+                for(counter = 0; counter < code; counter++)
                 {
-                    *pixel_row++ = (value) & 0x0F;
+                    if(counter & 0x01)
+                        RLESpanPixel(pSpan, IMAGE_COLOR(pPalette, value >> 4));
+                    else
+                        RLESpanPixel(pSpan, IMAGE_COLOR(pPalette, value & 0x0F));
                 }
             }
         }
@@ -5792,7 +6268,7 @@ WORD DecodeRLE4Ext(void *image, DWORD memAddress, BYTE *pixel_row, WORD size)
             decodeSize += value;
             sourceOffset += (value + 1) >> 1;
             
-            if(decodeSize > size) //To avoid writing oustide the array bounds
+            if(decodeSize > size) //To avoid writing oustide the row
             {
                 value -= (decodeSize - size);
             }
@@ -5801,18 +6277,18 @@ WORD DecodeRLE4Ext(void *image, DWORD memAddress, BYTE *pixel_row, WORD size)
             {
                 if(counter & 0x01)
                 {
-                    *pixel_row++ = (temp >> 4) & 0x0F;
-                    memAddress++;
+                    RLESpanPixel(pSpan, IMAGE_COLOR(pPalette, temp >> 4));
                 }
                 else
                 {
-                    ExternalMemoryCallback(image, memAddress, sizeof(BYTE), &temp);
-                    *pixel_row++ = temp & 0x0F;
+                    temp = RLEExtGet(pSource);
+                    RLESpanPixel(pSpan, IMAGE_COLOR(pPalette, temp & 0x0F));
                 }
             }
         }
     }
 
+    RLESpanFlush(pSpan);
     return (sourceOffset);
 }
 
@@ -5840,15 +6316,13 @@ void PutImageRLE4BPPExt(SHORT left, SHORT top, void *image, BYTE stretch)
 #ifndef USE_PALETTE
     GFX_COLOR       imagePalette[16];
 #endif
-    BYTE            pixelrow[(GetMaxX() + 1)];
-    BYTE            *pixelAddress;
+    RLE_EXT_SOURCE  source;
+    RLE_SPAN        span;
 
-    BYTE            temp;
     WORD            sizeX, sizeY;
-    WORD            x, y;
-    WORD            xc, yc;
-    BYTE            stretchX, stretchY;
-    WORD            offset;
+    WORD            y;
+    BYTE            stretchY;
+    WORD            offset = 0;
 
     // Get image header
     ExternalMemoryCallback(image, 0, sizeof(BITMAP_HEADER), &bmp);
@@ -5872,43 +6346,29 @@ void PutImageRLE4BPPExt(SHORT left, SHORT top, void *image, BYTE stretch)
     sizeX = bmp.width;
     sizeY = bmp.height;
 
-    yc = top;
+    source.image = image;
+    source.address = 0;
+    source.length = 0;
+    source.index = 0;
+
+    span.stretch = stretch;
+    span.count = 0;
+    span.y = top;
+
     for(y = 0; y < sizeY; y++)
     {
-        offset = DecodeRLE4Ext(image, memOffset, pixelrow, sizeX);
-        memOffset += offset;
-        
+        // a stretched row is decoded again for each of its screen rows
         for(stretchY = 0; stretchY < stretch; stretchY++)
         {
-            pixelAddress = pixelrow;
-            xc = left;
-            for(x = 0; x < sizeX; x++)
-            {
-
-                // Read pixels from flash
-                temp = *pixelAddress;
-                pixelAddress++;
-
-                // Set color
-            #ifdef USE_PALETTE
-                SetColor(temp);
-            #else
-                SetColor(imagePalette[temp]);
-            #endif
-
-                // Write pixel to screen
-                for(stretchX = 0; stretchX < stretch; stretchX++)
-                {
-                    #ifdef USE_TRANSPARENT_COLOR
-                        if (!((GetTransparentColor() == GetColor()) && (GetTransparentColorStatus() == TRANSPARENT_COLOR_ENABLE)))
-                    #endif
-                            PutPixel(xc, yc);
-                        xc++;    
-                }
-            }
-
-            yc++;
+            span.x = left;
+        #ifdef USE_PALETTE
+            offset = BlitRLE4Ext(&source, memOffset, &span, sizeX, NULL);
+        #else
+            offset = BlitRLE4Ext(&source, memOffset, &span, sizeX, imagePalette);
+        #endif
+            span.y++;
         }
+        memOffset += offset;
     }
 }
         #endif //#if (COLOR_DEPTH >= 4)
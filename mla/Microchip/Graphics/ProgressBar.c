@@ -290,6 +290,8 @@ WORD PbDraw(void *pObj)
                     break;
                 } 
                 // else progress bar state = PB_DRAW_BAR, refresh only the level
+                GOLAddDamage(pPb->hdr.left + GOL_EMBOSS_SIZE, pPb->hdr.top + GOL_EMBOSS_SIZE,
+                             pPb->hdr.right - GOL_EMBOSS_SIZE, pPb->hdr.bottom - GOL_EMBOSS_SIZE);
                 state = BAR_DRAW_SET;
     
             case BAR_DRAW_SET:
@@ -51,11 +51,18 @@
 /* Local Function Prototypes            */
 void        PushRectangle(void);
 void        PlainCopyRectangle(void);
+void        TransitionFrameStart(void);
+void        TransitionFrameWait(void);
+void        TransitionMoveBlock(DWORD srcpageaddr, SHORT srcx, SHORT srcy, SHORT destx, SHORT desty, SHORT width, SHORT height);
 /****************************************/
 
 WORD _transitionpending, _left, _top, _right, _bottom, _type, _delay_ms, _param1, _param2;
 DWORD _srcpageaddr, _destpageaddr;
 
+static GFX_TICKS_CALLBACK _pTransitionTicksFn = NULL;
+static DWORD _transitionTicksPerSecond;
+static QWORD _transitionDeadline;
+
 WORD Startx;
 WORD Starty;
 WORD Width;
@@ -196,6 +203,175 @@ BYTE GFXSetupTransition(SHORT left, SHORT top, SHORT right, SHORT bottom, GFX_TR
     return 0;
 }
 
+/************************************************************************
+* Function: void GFXTransitionTimeSourceRegister(GFX_TICKS_CALLBACK pTicksFn, 
+*                                                DWORD ticksPerSecond)
+*                                                                       
+* Overview: This function registers the timer used to pace the steps of
+*           the transitions
+*                                                                       
+* Input:    pTicksFn       -> Function returning the free running 64-bit 
+*                             timer value, NULL to use DelayMs()
+*           ticksPerSecond -> Number of timer ticks per second
+*                                                                       
+* Output:   none
+*                                                                       
+************************************************************************/
+void GFXTransitionTimeSourceRegister(GFX_TICKS_CALLBACK pTicksFn, DWORD ticksPerSecond)
+{
+    _pTransitionTicksFn = pTicksFn;
+    _transitionTicksPerSecond = ticksPerSecond;
+}
+
+/************************************************************************
+* Function: void TransitionFrameStart(void)
+*                                                                       
+* Overview: Starts the timing of the first step of a transition 
+*           (local function)
+*                                                                       
+* Input:    none                                                          
+*                                                                       
+* Output:   none
+*                                                                       
+************************************************************************/
+void TransitionFrameStart(void)
+{
+    if(_pTransitionTicksFn != NULL)
+        _transitionDeadline = _pTransitionTicksFn();
+}
+
+/************************************************************************
+* Function: void TransitionFrameWait(void)
+*                                                                       
+* Overview: Waits until the next step of the transition is due and the 
+*           display controller is idle (local function). With a time 
+*           source the steps are delay_ms apart from the start of the
+*           transition, the time spent copying is not added to the delay
+*           and late steps are executed at once to catch up. Without a
+*           time source DelayMs() is used.
+*                                                                       
+* Input:    none                                                          
+*                                                                       
+* Output:   none
+*                                                                       
+************************************************************************/
+void TransitionFrameWait(void)
+{
+    if(_pTransitionTicksFn != NULL)
+    {
+        _transitionDeadline += ((QWORD)_delay_ms * _transitionTicksPerSecond) / 1000;
+        while(_pTransitionTicksFn() < _transitionDeadline);
+    }
+    else
+    {
+        DelayMs(_delay_ms);
+    }
+
+    while(IsDeviceBusy());
+}
+
+/************************************************************************
+* Function: void TransitionMoveBlock(DWORD srcpageaddr, SHORT srcx, 
+*                                    SHORT srcy, SHORT destx, SHORT desty,
+*                                    SHORT width, SHORT height)
+*                                                                       
+* Overview: Copies a block from the source page or from the destination
+*           page itself to the destination page (local function). The 
+*           positions are relative to the transition area. The copy goes
+*           through CopyBlock(), which is the ROPBlock() copy of the 
+*           controller on the drivers that have one. The copy engine 
+*           reads the rows from the top, so a block moved down on the 
+*           destination page is copied from the bottom in bands that do 
+*           not overlap their own destination. Empty blocks are skipped.
+*                                                                       
+* Input:    srcpageaddr   -> _srcpageaddr or _destpageaddr
+*           srcx, srcy    -> top left corner of the source block
+*           destx, desty  -> top left corner of the destination block
+*           width, height -> size of the block
+*                                                                       
+* Output:   none
+*                                                                       
+************************************************************************/
+void TransitionMoveBlock(DWORD srcpageaddr, SHORT srcx, SHORT srcy, SHORT destx, SHORT desty, SHORT width, SHORT height)
+{
+    SHORT band;
+
+    if((width <= 0) || (height <= 0))
+        return;
+
+    if((srcpageaddr == _destpageaddr) && (desty > srcy))
+    {
+        band = desty - srcy;
+        while(height > 0)
+        {
+            if(band > height)
+                band = height;
+            height -= band;
+            CopyBlock(_destpageaddr, _destpageaddr, ((DWORD)(Starty + srcy + height) * DISP_HOR_RESOLUTION) + Startx + srcx, ((DWORD)(Starty + desty + height) * DISP_HOR_RESOLUTION) + Startx + destx, width, band);
+            while(IsDeviceBusy());
+        }
+        return;
+    }
+
+    CopyBlock(srcpageaddr, _destpageaddr, ((DWORD)(Starty + srcy) * DISP_HOR_RESOLUTION) + Startx + srcx, ((DWORD)(Starty + desty) * DISP_HOR_RESOLUTION) + Startx + destx, width, height);
+    while(IsDeviceBusy());
+}
+
+/************************************************************************
+* Function: static void TransitionCopyBlock(SHORT x, SHORT y, 
+*                                           SHORT width, SHORT height)
+*                                                                       
+* Overview: Copies a block of the transition area from the source page 
+*           to the same place on the destination page. The position is
+*           relative to the transition area. Empty blocks are skipped.
+*                                                                       
+* Input:    x, y          -> top left corner of the block
+*           width, height -> size of the block
+*                                                                       
+* Output:   none
+*                                                                       
+************************************************************************/
+static void TransitionCopyBlock(SHORT x, SHORT y, SHORT width, SHORT height)
+{
+    TransitionMoveBlock(_srcpageaddr, x, y, x, y, width, height);
+}
+
+/************************************************************************
+* Function: static void TransitionCopyFrame(SHORT outerX, SHORT outerY, 
+*                                           SHORT outerWidth, SHORT outerHeight,
+*                                           SHORT innerX, SHORT innerY, 
+*                                           SHORT innerWidth, SHORT innerHeight)
+*                                                                       
+* Overview: Copies the part of the outer rectangle that is not covered 
+*           by the inner rectangle, as up to four strips. The inner 
+*           rectangle is the part already copied by the previous steps of
+*           the transition so each step only moves the newly exposed 
+*           pixels. An empty inner rectangle copies the whole outer one.
+*                                                                       
+* Input:    outerX, outerY, outerWidth, outerHeight -> area of this step
+*           innerX, innerY, innerWidth, innerHeight -> area of the 
+*                                                      previous step
+*                                                                       
+* Output:   none
+*                                                                       
+************************************************************************/
+static void TransitionCopyFrame(SHORT outerX, SHORT outerY, SHORT outerWidth, SHORT outerHeight, SHORT innerX, SHORT innerY, SHORT innerWidth, SHORT innerHeight)
+{
+    if((innerWidth <= 0) || (innerHeight <= 0))
+    {
+        TransitionCopyBlock(outerX, outerY, outerWidth, outerHeight);
+        return;
+    }
+
+    // strips above and below the inner rectangle span the whole width
+    TransitionCopyBlock(outerX, outerY, outerWidth, innerY - outerY);
+    TransitionCopyBlock(outerX, innerY + innerHeight, outerWidth, (outerY + outerHeight) - (innerY + innerHeight));
+
+    // strips on the left and on the right of the inner rectangle
+    TransitionCopyBlock(outerX, innerY, innerX - outerX, innerHeight);
+    TransitionCopyBlock(innerX + innerWidth, innerY, (outerX + outerWidth) - (innerX + innerWidth), innerHeight);
+}
+
 /************************************************************************
 * Function: void PlainCopyRectangle(void)
 *                                                                       
@@ -233,6 +409,7 @@ void ExpandRectangle(void)
     WORD xpitch = x * SCALE / den;
     WORD ypitch = y * SCALE / den;
     WORD i;
+    WORD w, h, prevx = 0, prevy = 0, prevw = 0, prevh = 0;
     WORD blocksize = _param1;
     
     if(blocksize == 0)
@@ -245,14 +422,22 @@ void ExpandRectangle(void)
     }
     
     while(IsDeviceBusy());
+    TransitionFrameStart();
     
     for(i = 0; i <= den; i += blocksize)
     {
         x = (Width / 2) - ((i * xpitch) / SCALE);
         y = (Height / 2) - ((i * ypitch) / SCALE);
-        CopyBlock(_srcpageaddr, _destpageaddr, ((DWORD)(Starty + y) * DISP_HOR_RESOLUTION) + Startx + x, ((DWORD)(Starty + y) * DISP_HOR_RESOLUTION) + Startx + x, 2 * xpitch * i / SCALE, 2 * ypitch * i / SCALE);
-        DelayMs(_delay_ms);
-        while(IsDeviceBusy());
+        w = 2 * xpitch * i / SCALE;
+        h = 2 * ypitch * i / SCALE;
+
+        // only the ring around the rectangle of the previous step is new
+        TransitionCopyFrame(x, y, w, h, prevx, prevy, prevw, prevh);
+        prevx = x;
+        prevy = y;
+        prevw = w;
+        prevh = h;
+        TransitionFrameWait();
     }
     PlainCopyRectangle();
 }
@@ -277,6 +462,7 @@ void ContractRectangle(void)
     WORD xpitch = x * SCALE / den;
     WORD ypitch = y * SCALE / den;
     WORD i;
+    WORD prevx = 0, prevy = 0;
     WORD blocksize = _param1;
     
     if(blocksize == 0)
@@ -289,17 +475,19 @@ void ContractRectangle(void)
     }
     
     while(IsDeviceBusy());
+    TransitionFrameStart();
     
     for(i = 0; i <= den; i += blocksize)
     {
         x = (i * xpitch) / SCALE;
         y = (i * ypitch) / SCALE;
-        CopyBlock(_srcpageaddr, _destpageaddr, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx, x, Height);
-        CopyBlock(_srcpageaddr, _destpageaddr, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx + Width - x, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx + Width - x, x, Height);
-        CopyBlock(_srcpageaddr, _destpageaddr, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx, Width, y);
-        CopyBlock(_srcpageaddr, _destpageaddr, ((DWORD)(Starty + Height - y) * DISP_HOR_RESOLUTION) + Startx, ((DWORD)(Starty + Height - y) * DISP_HOR_RESOLUTION) + Startx, Width, y);
-        DelayMs(_delay_ms);
-        while(IsDeviceBusy());
+
+        // the border copied so far grows by the strips between the 
+        // old and the new inner rectangle
+        TransitionCopyFrame(prevx, prevy, Width - 2 * prevx, Height - 2 * prevy, x, y, Width - 2 * x, Height - 2 * y);
+        prevx = x;
+        prevy = y;
+        TransitionFrameWait();
     }
     PlainCopyRectangle();
 }
@@ -333,15 +521,18 @@ void ExpandLine(void)
 
     while(IsDeviceBusy());
 
+    TransitionFrameStart();
+
     if(direction == HORIZONTAL)
     {
         WORD i;
         
         for(i = 1; i <= Width / (2 * blocksize); i++)
         {
-            CopyBlock(_srcpageaddr, _destpageaddr, ((DWORD)(Starty) * DISP_HOR_RESOLUTION) + Startx + (Width / 2) - (i * blocksize), ((DWORD)(Starty) * DISP_HOR_RESOLUTION) + Startx + (Width / 2) - (i * blocksize), 2 * i * blocksize, Height);
-            DelayMs(_delay_ms);
-            while(IsDeviceBusy());
+            // the band grows by one block on each side
+            TransitionCopyBlock((Width / 2) - (i * blocksize), 0, blocksize, Height);
+            TransitionCopyBlock((Width / 2) + ((i - 1) * blocksize), 0, blocksize, Height);
+            TransitionFrameWait();
         }
     }
     else if(direction == VERTICAL)
@@ -350,9 +541,9 @@ void ExpandLine(void)
         
         for(i = 1; i <= Height / (2 * blocksize); i++)
         {
-            CopyBlock(_srcpageaddr, _destpageaddr, (DWORD)(Starty + (Height / 2) - (i * blocksize)) * DISP_HOR_RESOLUTION + Startx, (DWORD)(Starty + (Height / 2) - (i * blocksize)) * DISP_HOR_RESOLUTION + Startx, Width, 2 * i * blocksize);
-            DelayMs(_delay_ms);
-            while(IsDeviceBusy());
+            TransitionCopyBlock(0, (Height / 2) - (i * blocksize), Width, blocksize);
+            TransitionCopyBlock(0, (Height / 2) + ((i - 1) * blocksize), Width, blocksize);
+            TransitionFrameWait();
         }
     }
 
@@ -388,16 +579,18 @@ void ContractLine(void)
 
     while(IsDeviceBusy());
 
+    TransitionFrameStart();
+
     if(direction == HORIZONTAL)
     {
         WORD i;
         
         for(i = 0; i < Width / (2 * blocksize); i++)
         {
-            CopyBlock(_srcpageaddr, _destpageaddr, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx, (i + 1) * blocksize, Height);
-            CopyBlock(_srcpageaddr, _destpageaddr, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx + Width - (i * blocksize) - blocksize, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx + Width - (i * blocksize) - blocksize, (i + 1) * blocksize, Height);
-            DelayMs(_delay_ms);
-            while(IsDeviceBusy());
+            // the bands on both sides grow by one block towards the middle
+            TransitionCopyBlock(i * blocksize, 0, blocksize, Height);
+            TransitionCopyBlock(Width - (i * blocksize) - blocksize, 0, blocksize, Height);
+            TransitionFrameWait();
         }
     }
     else if(direction == VERTICAL)
@@ -406,10 +599,9 @@ void ContractLine(void)
         
         for(i = 0; i < Height / (2 * blocksize); i++)
         {
-            CopyBlock(_srcpageaddr, _destpageaddr, (DWORD)Starty * DISP_HOR_RESOLUTION + Startx, (DWORD)Starty * DISP_HOR_RESOLUTION + Startx, Width, (i + 1) * blocksize);
-            CopyBlock(_srcpageaddr, _destpageaddr, (DWORD)(Starty + Height - (i * blocksize) - blocksize) * DISP_HOR_RESOLUTION + Startx, (DWORD)(Starty + Height - (i * blocksize) - blocksize) * DISP_HOR_RESOLUTION + Startx, Width, (i + 1) * blocksize);
-            DelayMs(_delay_ms);
-            while(IsDeviceBusy());
+            TransitionCopyBlock(0, i * blocksize, Width, blocksize);
+            TransitionCopyBlock(0, Height - (i * blocksize) - blocksize, Width, blocksize);
+            TransitionFrameWait();
         }
     }
 
@@ -429,7 +621,7 @@ void ContractLine(void)
 ************************************************************************/
 void SlideRectangle(void)
 {
-    SHORT x, y;
+    SHORT done, step;
     WORD blocksize = _param1;
     WORD direction = _param2;
     
@@ -445,41 +637,49 @@ void SlideRectangle(void)
     direction = GFXTranslateDirection(direction, DISP_ORIENTATION);
     
     while(IsDeviceBusy());
+    TransitionFrameStart();
     
+    // each step moves the part of the new screen shown so far by one 
+    // block on the destination page and copies the next block of the 
+    // new screen into the strip it uncovers
     if(direction == LEFT_TO_RIGHT)
     {
-        for(x = Width; x > 0; x -= blocksize)
+        for(done = 0; done < (SHORT)Width; done += step)
         {
-            CopyBlock(_srcpageaddr, _destpageaddr, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx + x - blocksize, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx, Width - x + blocksize, Height);
-            DelayMs(_delay_ms);
-            while(IsDeviceBusy());
+            step = (Width - done > blocksize)? blocksize: Width - done;
+            TransitionMoveBlock(_destpageaddr, 0, 0, step, 0, done, Height);
+            TransitionMoveBlock(_srcpageaddr, Width - done - step, 0, 0, 0, step, Height);
+            TransitionFrameWait();
         }
     }
     else if(direction == RIGHT_TO_LEFT)
     {
-        for(x = Width; x > 0; x -= blocksize)
+        for(done = 0; done < (SHORT)Width; done += step)
         {
-            CopyBlock(_srcpageaddr, _destpageaddr, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx + x - blocksize, Width - x + blocksize, Height);
-            DelayMs(_delay_ms);
-            while(IsDeviceBusy());
+            step = (Width - done > blocksize)? blocksize: Width - done;
+            TransitionMoveBlock(_destpageaddr, Width - done, 0, Width - done - step, 0, done, Height);
+            TransitionMoveBlock(_srcpageaddr, done, 0, Width - step, 0, step, Height);
+            TransitionFrameWait();
         }
     }
     else if(direction == TOP_TO_BOTTOM)
     {
-        for(y = Height; y > 0; y -= blocksize)
+        for(done = 0; done < (SHORT)Height; done += step)
         {
-            CopyBlock(_srcpageaddr, _destpageaddr, ((DWORD)(Starty + y - blocksize) * DISP_HOR_RESOLUTION) + Startx, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx, Width, Height - y + blocksize);
-            DelayMs(_delay_ms);
-            while(IsDeviceBusy());
+            step = (Height - done > blocksize)? blocksize: Height - done;
+            TransitionMoveBlock(_destpageaddr, 0, 0, 0, step, Width, done);
+            TransitionMoveBlock(_srcpageaddr, 0, Height - done - step, 0, 0, Width, step);
+            TransitionFrameWait();
         }
     }
     else if(direction == BOTTOM_TO_TOP)
     {
-        for(y = Height; y > 0; y -= blocksize)
+        for(done = 0; done < (SHORT)Height; done += step)
         {
-            CopyBlock(_srcpageaddr, _destpageaddr, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx, ((DWORD)(Starty + y - blocksize) * DISP_HOR_RESOLUTION) + Startx, Width, Height - y + blocksize);
-            DelayMs(_delay_ms);
-            while(IsDeviceBusy());
+            step = (Height - done > blocksize)? blocksize: Height - done;
+            TransitionMoveBlock(_destpageaddr, 0, Height - done, 0, Height - done - step, Width, done);
+            TransitionMoveBlock(_srcpageaddr, 0, done, 0, Height - step, Width, step);
+            TransitionFrameWait();
         }
     }
     PlainCopyRectangle();
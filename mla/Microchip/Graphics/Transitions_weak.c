@@ -48,6 +48,9 @@
 extern WORD _transitionpending, _left, _top, _right, _bottom, _type, _delay_ms, _param1, _param2;
 extern DWORD _srcpageaddr, _destpageaddr;
 extern void PlainCopyRectangle(void);
+extern void TransitionFrameStart(void);
+extern void TransitionFrameWait(void);
+extern void TransitionMoveBlock(DWORD srcpageaddr, SHORT srcx, SHORT srcy, SHORT destx, SHORT desty, SHORT width, SHORT height);
 
 #define RCC_SRC_ADDR_DISCONTINUOUS 1
 #define RCC_DEST_ADDR_DISCONTINUOUS 1
@@ -70,7 +73,7 @@ extern WORD Height;
 ************************************************************************/
 void __attribute__((weak)) PushRectangle(void)
 {
-    SHORT x, y;
+    SHORT done, step;
     WORD blocksize = _param1;
     WORD direction = _param2;
     
@@ -86,53 +89,48 @@ void __attribute__((weak)) PushRectangle(void)
     direction = GFXTranslateDirection(direction, DISP_ORIENTATION);
     
     while(IsDeviceBusy());
+    TransitionFrameStart();
     
+    // each step moves both screens by one block on the destination page
+    // and copies the next block of the new screen into the strip it uncovers
     if(direction == LEFT_TO_RIGHT)
     {
-        for(x = Width; x > 0; x -= blocksize)
+        for(done = 0; done < (SHORT)Width; done += step)
         {
-            CopyBlock(_destpageaddr, _destpageaddr, ((DWORD)(Starty) * DISP_HOR_RESOLUTION) + Startx + Width - x, ((DWORD)(Starty) * DISP_HOR_RESOLUTION) + Startx + Width - x + blocksize, (x - blocksize) > 0? (x - blocksize): 0, Height);
-            while(IsDeviceBusy());
-            CopyBlock(_srcpageaddr,  _destpageaddr, ((DWORD)(Starty) * DISP_HOR_RESOLUTION) + Startx + x - blocksize, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx, Width - x + blocksize, Height);
-            DelayMs(_delay_ms);
-            while(IsDeviceBusy());
+            step = (Width - done > blocksize)? blocksize: Width - done;
+            TransitionMoveBlock(_destpageaddr, 0, 0, step, 0, Width - step, Height);
+            TransitionMoveBlock(_srcpageaddr, Width - done - step, 0, 0, 0, step, Height);
+            TransitionFrameWait();
         }
     }
     else if(direction == RIGHT_TO_LEFT)
     {
-        for(x = Width; x > 0; x -= blocksize)
+        for(done = 0; done < (SHORT)Width; done += step)
         {
-            CopyBlock(_destpageaddr, _destpageaddr, ((DWORD)(Starty) * DISP_HOR_RESOLUTION) + Startx + blocksize, ((DWORD)(Starty) * DISP_HOR_RESOLUTION) + Startx, (x - blocksize) > 0? (x - blocksize): 0, Height);
-            while(IsDeviceBusy());
-            CopyBlock(_srcpageaddr, _destpageaddr, ((DWORD)Starty * DISP_HOR_RESOLUTION) + Startx, ((DWORD)(Starty) * DISP_HOR_RESOLUTION) + Startx + x - blocksize, Width - x + blocksize, Height);
-            DelayMs(_delay_ms);
-            while(IsDeviceBusy());
+            step = (Width - done > blocksize)? blocksize: Width - done;
+            TransitionMoveBlock(_destpageaddr, step, 0, 0, 0, Width - step, Height);
+            TransitionMoveBlock(_srcpageaddr, done, 0, Width - step, 0, step, Height);
+            TransitionFrameWait();
         }
     }
     else if(direction == TOP_TO_BOTTOM)
     {
-        for(y = Height; y > 0; y -= blocksize)
+        for(done = 0; done < (SHORT)Height; done += step)
         {
-            SHORT y1;
-            for(y1 = Height - blocksize; y1 > (Height - y); y1 -= blocksize)
-            {
-                CopyBlock(_destpageaddr, _destpageaddr, ((DWORD)(Starty + y1) * DISP_HOR_RESOLUTION) + Startx, ((DWORD)(Starty + y1 + blocksize) * DISP_HOR_RESOLUTION) + Startx, Width, blocksize);
-                while(IsDeviceBusy());
-            }
-            CopyBlock(_srcpageaddr, _destpageaddr, ((DWORD)(Starty + y - blocksize) * DISP_HOR_RESOLUTION) + Startx, ((DWORD)(Starty) * DISP_HOR_RESOLUTION) + Startx, Width, Height - y + blocksize);
-            DelayMs(_delay_ms);
-            while(IsDeviceBusy());
+            step = (Height - done > blocksize)? blocksize: Height - done;
+            TransitionMoveBlock(_destpageaddr, 0, 0, 0, step, Width, Height - step);
+            TransitionMoveBlock(_srcpageaddr, 0, Height - done - step, 0, 0, Width, step);
+            TransitionFrameWait();
         }
     }
     else if(direction == BOTTOM_TO_TOP)
     {
-        for(y = Height; y > 0; y -= blocksize)
+        for(done = 0; done < (SHORT)Height; done += step)
         {
-            CopyBlock(_destpageaddr, _destpageaddr, ((DWORD)(Starty + blocksize) * DISP_HOR_RESOLUTION) + Startx, ((DWORD)(Starty) * DISP_HOR_RESOLUTION) + Startx, Width, (y - blocksize) > 0? (y - blocksize): 0);
-            while(IsDeviceBusy());
-            CopyBlock(_srcpageaddr, _destpageaddr, ((DWORD)(Starty) * DISP_HOR_RESOLUTION) + Startx, ((DWORD)(Starty + y - blocksize) * DISP_HOR_RESOLUTION) + Startx, Width, Height - y + blocksize);
-            DelayMs(_delay_ms);
-            while(IsDeviceBusy());
+            step = (Height - done > blocksize)? blocksize: Height - done;
+            TransitionMoveBlock(_destpageaddr, 0, step, 0, 0, Width, Height - step);
+            TransitionMoveBlock(_srcpageaddr, 0, done, 0, Height - step, Width, step);
+            TransitionFrameWait();
         }
     }
     PlainCopyRectangle();
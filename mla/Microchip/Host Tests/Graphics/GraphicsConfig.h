@@ -0,0 +1,26 @@
+/*****************************************************************************
+ * FileName:        GraphicsConfig.h
+ * Processor:       Host (Linux, Windows)
+ * Compiler:        GCC
+ *
+ * Graphics Library configuration of HostFrameBufferTest.c.
+ *****************************************************************************/
+#ifndef _GRAPHICSCONFIG_H
+    #define _GRAPHICSCONFIG_H
+
+    #include <stdlib.h>
+
+    #define COLOR_DEPTH             16
+    #define GFX_DRV_PAGE_COUNT      2
+
+    #define USE_NONBLOCKING_CONFIG
+    #define USE_ALPHABLEND_LITE
+    #define USE_TRANSPARENT_COLOR
+    #define USE_FONT_FLASH
+    #define USE_GOL
+    #define USE_CHART
+
+    #define GFX_malloc(size)        malloc(size)
+    #define GFX_free(pObj)          free(pObj)
+
+#endif // _GRAPHICSCONFIG_H
@@ -0,0 +1,17 @@
+/*****************************************************************************
+ * FileName:        HardwareProfile.h
+ * Processor:       Host (Linux, Windows)
+ * Compiler:        GCC
+ *
+ * HostFrameBufferTest.c draws on a QVGA page of the host frame buffer 
+ * driver.
+ *****************************************************************************/
+#ifndef _HARDWAREPROFILE_H
+    #define _HARDWAREPROFILE_H
+
+    #define GFX_USE_DISPLAY_CONTROLLER_HOST_FRAMEBUFFER
+    #define DISP_HOR_RESOLUTION     320
+    #define DISP_VER_RESOLUTION     240
+    #define DISP_ORIENTATION        0
+
+#endif // _HARDWAREPROFILE_H
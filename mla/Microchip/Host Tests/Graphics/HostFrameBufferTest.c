@@ -0,0 +1,494 @@
+/*****************************************************************************
+ *  Module for Microchip Graphics Library
+ *  Host frame buffer self tests
+ *****************************************************************************
+ * FileName:        HostFrameBufferTest.c
+ * Dependencies:    HostFrameBuffer.c, Primitive.c, GOLFontDefault.c
+ * Processor:       Host (Linux, Windows)
+ * Compiler:        GCC
+ * Company:         Microchip Technology Incorporated
+ *
+ * Software License Agreement
+ *
+ * Copyright (C) 2012 Microchip Technology Inc.  All rights reserved.
+ * Microchip licenses to you the right to use, modify, copy and distribute
+ * Software only when embedded on a Microchip microcontroller or digital
+ * signal controller, which is integrated into your product or third party
+ * product (pursuant to the sublicense terms in the accompanying license
+ * agreement).  
+ *
+ * You should refer to the license agreement accompanying this Software
+ * for additional information regarding your rights and obligations.
+ *
+ * SOFTWARE AND DOCUMENTATION ARE PROVIDED "AS IS" WITHOUT WARRANTY OF ANY
+ * KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION, ANY WARRANTY
+ * OF MERCHANTABILITY, TITLE, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+ * PURPOSE. IN NO EVENT SHALL MICROCHIP OR ITS LICENSORS BE LIABLE OR
+ * OBLIGATED UNDER CONTRACT, NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION,
+ * BREACH OF WARRANTY, OR OTHER LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT
+ * DAMAGES OR EXPENSES INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL,
+ * INDIRECT, PUNITIVE OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA,
+ * COST OF PROCUREMENT OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY
+ * CLAIMS BY THIRD PARTIES (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF),
+ * OR OTHER SIMILAR COSTS.
+ *
+ * Date         Comment
+ *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Checks of the Graphics Library that run on the host frame buffer driver,
+ * built by Host Tests/run_tests.sh with the configuration in this directory.
+ * main() runs all the checks, prints the results and measures the frame 
+ * rate and pixel rate of each test scene.
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "HardwareProfile.h"
+#include "GraphicsConfig.h"
+#include "Graphics/DisplayDriver.h"
+#include "Graphics/HostFrameBuffer.h"
+#include "Graphics/Primitive.h"
+
+// Contents of page 0 before each drawing and the expected result
+static WORD     _testBackground[HOST_FB_PAGE_SIZE];
+static WORD     _testExpected[HOST_FB_PAGE_SIZE];
+
+static DWORD    _testSeed;
+
+/*********************************************************************
+* Function: static WORD TestRandom(void)
+*
+* Overview: Returns a pseudo random number, the sequence restarts when 
+*           _testSeed is set.
+*
+********************************************************************/
+static WORD TestRandom(void)
+{
+    _testSeed = _testSeed * 1103515245ul + 12345;
+    return ((WORD)(_testSeed >> 16));
+}
+
+/*********************************************************************
+* Function: static void TestFillBackground(void)
+*
+* Overview: Fills page 0 with pseudo random colors and keeps a copy.
+*
+********************************************************************/
+static void TestFillBackground(void)
+{
+    DWORD   counter;
+    WORD    *pPixel;
+
+    pPixel = HostFrameBufferGetPage(0);
+    for(counter = 0; counter < HOST_FB_PAGE_SIZE; counter++)
+        *pPixel++ = TestRandom();
+    memcpy(_testBackground, HostFrameBufferGetPage(0), sizeof(_testBackground));
+}
+
+#ifdef USE_ALPHABLEND_LITE
+
+/*********************************************************************
+* Function: static void BarAlphaReference(SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* Overview: The pixel by pixel BarAlpha() of version 3.06 of the 
+*           Graphics Library. BarAlpha() must give the same pixels.
+*
+********************************************************************/
+static void BarAlphaReference(SHORT left, SHORT top, SHORT right, SHORT bottom)
+{
+    SHORT x,y;
+    GFX_COLOR  fcolor, bcolor, newColor;
+    
+    // save current color
+    newColor = fcolor = GetColor();
+
+    for(y=top;y<bottom+1;y++)
+    {
+        if(GetPrevAlphaColor() != BLACK)
+        {
+            for(x=left;x<right+1;x++)
+            {
+                bcolor = GetPixel(x,y);
+                switch(GetAlpha())
+                {
+                    case 50: newColor = (bcolor - ConvertColor50(GetPrevAlphaColor())) + ConvertColor50(fcolor);break;
+                    case 75: newColor = (bcolor - ConvertColor75(GetPrevAlphaColor())) + ConvertColor75(fcolor);break;
+                    case 25: newColor = (bcolor - ConvertColor25(GetPrevAlphaColor())) + ConvertColor25(fcolor);break;
+                    default: break;
+                }
+                SetColor(newColor);
+                PutPixel(x,y);
+            }     
+        }
+        else
+        {                          
+            for(x=left;x<right+1;x++)
+            {
+                bcolor = GetPixel(x,y);
+                switch(GetAlpha())
+                {
+                    case 50: newColor = ConvertColor50(fcolor) + ConvertColor50(bcolor); break;
+                    case 25: newColor = ConvertColor25(fcolor) + ConvertColor75(bcolor); break;
+                    case 75: newColor = ConvertColor75(fcolor) + ConvertColor25(bcolor); break;
+                    default: break;
+                } 
+                SetColor(newColor);
+                PutPixel(x,y);
+            } 
+        }        
+    }
+
+    // reset to original _color
+    SetColor(fcolor); 
+}
+
+/*********************************************************************
+* Function: static WORD TestBarAlpha(void)
+*
+* PreCondition: ResetDevice() was called
+*
+* Input: none
+*
+* Output: Number of bars that do not match the reference, 0 on success.
+*
+* Side Effects: Changes page 0, the color, the alpha settings and the 
+*               clipping region.
+*
+* Overview: Draws bars of random size and position, partly outside of 
+*           the screen, with every alpha value, with and without a 
+*           previous alpha color and with and without clipping, over a
+*           random background. Each one is compared with the pixels of 
+*           BarAlphaReference().
+*
+********************************************************************/
+#define BAR_ALPHA_TEST_BARS     400
+
+static WORD TestBarAlpha(void)
+{
+    static const BYTE   alphaValues[] = {25, 50, 75, 60};
+    SHORT               left, top, right, bottom;
+    WORD                counter, errors = 0;
+
+    _testSeed = 1;
+    TestFillBackground();
+
+    for(counter = 0; counter < BAR_ALPHA_TEST_BARS; counter++)
+    {
+        left = (SHORT)(TestRandom() % (GetMaxX() + 41)) - 20;
+        top = (SHORT)(TestRandom() % (GetMaxY() + 41)) - 20;
+        right = left + (SHORT)(TestRandom() % 80);
+        bottom = top + (SHORT)(TestRandom() % 60);
+
+        SetAlpha(alphaValues[counter % sizeof(alphaValues)]);
+        SetPrevAlphaColor(((counter >> 2) & 1) ? TestRandom() : BLACK);
+        SetColor(TestRandom());
+
+        _clipRgn = (counter >> 3) & 1;
+        _clipLeft = TestRandom() % (GetMaxX() + 1);
+        _clipTop = TestRandom() % (GetMaxY() + 1);
+        _clipRight = _clipLeft + TestRandom() % 100;
+        _clipBottom = _clipTop + TestRandom() % 100;
+
+        memcpy(HostFrameBufferGetPage(0), _testBackground, sizeof(_testBackground));
+        BarAlphaReference(left, top, right, bottom);
+        memcpy(_testExpected, HostFrameBufferGetPage(0), sizeof(_testExpected));
+
+        memcpy(HostFrameBufferGetPage(0), _testBackground, sizeof(_testBackground));
+        BarAlpha(left, top, right, bottom);
+
+        if(memcmp(_testExpected, HostFrameBufferGetPage(0), sizeof(_testExpected)) != 0)
+            errors++;
+    }
+
+    _clipRgn = 0;
+    SetAlpha(100);
+    SetPrevAlphaColor(BLACK);
+    return (errors);
+}
+
+#endif // #ifdef USE_ALPHABLEND_LITE
+
+#ifdef USE_FONT_FLASH
+extern const FONT_FLASH GOLFontDefault;
+#endif
+
+/*********************************************************************
+* Function: static void TestSceneBars(void)
+*
+* Overview: Overlapping solid bars, partly outside of the screen.
+*
+********************************************************************/
+static void TestSceneBars(void)
+{
+    SHORT   i;
+
+    SetColor(BLACK);
+    ClearDevice();
+    for(i = 0; i < 48; i++)
+    {
+        SetColor(RGBConvert(i * 5, 255 - i * 5, (i * 37) & 0xFF));
+        while(!Bar(i * 7 - 20, i * 5 - 10, i * 7 + 60, i * 5 + 40));
+    }
+}
+
+/*********************************************************************
+* Function: static void TestSceneLines(void)
+*
+* Overview: Lines in every direction with all the line types and 
+*           thicknesses.
+*
+********************************************************************/
+static void TestSceneLines(void)
+{
+    static const BYTE   lineTypes[] = {SOLID_LINE, DOTTED_LINE, DASHED_LINE};
+    SHORT               x, y, i;
+
+    SetColor(BLACK);
+    ClearDevice();
+    for(i = 0; i < 6; i++)
+    {
+        SetLineType(lineTypes[i % 3]);
+        SetLineThickness((i < 3) ? NORMAL_LINE : THICK_LINE);
+        SetColor(RGBConvert(255 - i * 40, i * 40, 128));
+        for(x = i * 4; x <= GetMaxX(); x += 24)
+        {
+            while(!Line(GetMaxX() / 2, GetMaxY() / 2, x, 0));
+            while(!Line(GetMaxX() / 2, GetMaxY() / 2, GetMaxX() - x, GetMaxY()));
+        }
+        for(y = i * 4; y <= GetMaxY(); y += 24)
+        {
+            while(!Line(GetMaxX() / 2, GetMaxY() / 2, 0, y));
+            while(!Line(GetMaxX() / 2, GetMaxY() / 2, GetMaxX(), GetMaxY() - y));
+        }
+    }
+    SetLineType(SOLID_LINE);
+    SetLineThickness(NORMAL_LINE);
+}
+
+/*********************************************************************
+* Function: static void TestSceneShapes(void)
+*
+* Overview: Circles, rounded rectangles, arcs and a polygon.
+*
+********************************************************************/
+static void TestSceneShapes(void)
+{
+    SHORT   points[] = {20, 200, 60, 150, 110, 230, 160, 160, 20, 200};
+    SHORT   i;
+
+    SetColor(BLACK);
+    ClearDevice();
+    SetBevelDrawType(DRAWFULLBEVEL);
+    for(i = 0; i < 5; i++)
+    {
+        SetColor(RGBConvert(50 * i, 200, 255 - 50 * i));
+        while(!FillCircle(40 + i * 60, 40, 10 + i * 4));
+        SetColor(WHITE);
+        while(!Circle(40 + i * 60, 40, 12 + i * 4));
+        SetColor(RGBConvert(200, 50 * i, 80));
+        while(!FillBevel(10 + i * 60, 90, 50 + i * 60, 130, i * 3));
+        SetColor(WHITE);
+        while(!Bevel(8 + i * 60, 88, 52 + i * 60, 132, i * 3));
+        SetColor(RGBConvert(0, 255, 50 * i));
+        while(!Arc(180 + (i & 1) * 60, 150 + (i >> 1) * 35, 190 + (i & 1) * 60, 155 + (i >> 1) * 35, 
+                   4 + i, 14, (BYTE)(0xFF >> i)));
+    }
+    SetColor(RGBConvert(255, 255, 0));
+    while(!DrawPoly(sizeof(points) / sizeof(points[0]) / 2, points));
+}
+
+#ifdef USE_FONT_FLASH
+/*********************************************************************
+* Function: static void TestSceneText(void)
+*
+* Overview: All the characters of the default font.
+*
+********************************************************************/
+static void TestSceneText(void)
+{
+    XCHAR   text[17];
+    SHORT   row, i;
+
+    SetColor(RGBConvert(0, 0, 64));
+    ClearDevice();
+    SetFont((void *)&GOLFontDefault);
+    for(row = 0; row < 6; row++)
+    {
+        for(i = 0; i < 16; i++)
+            text[i] = (XCHAR)(0x20 + row * 16 + i);
+        text[16] = 0;
+        if(text[15] > 0x7E)
+            text[15] = 0x20;
+        SetColor((row & 1) ? WHITE : RGBConvert(255, 200, 0));
+        while(!OutTextXY(row * 3, row * (GetTextHeight((void *)&GOLFontDefault) + 2), text));
+    }
+}
+#endif
+
+#ifdef USE_ALPHABLEND_LITE
+/*********************************************************************
+* Function: static void TestSceneAlpha(void)
+*
+* Overview: Alpha blended bars over solid bars.
+*
+********************************************************************/
+static void TestSceneAlpha(void)
+{
+    static const BYTE   alphaValues[] = {25, 50, 75};
+    SHORT               i;
+
+    TestSceneBars();
+    for(i = 0; i < 12; i++)
+    {
+        SetAlpha(alphaValues[i % 3]);
+        SetPrevAlphaColor((i & 4) ? RGBConvert(0, 0, 255) : BLACK);
+        SetColor(RGBConvert(255, i * 20, 0));
+        while(!BarAlpha(i * 25, i * 18, i * 25 + 90, i * 18 + 50));
+    }
+    SetAlpha(100);
+    SetPrevAlphaColor(BLACK);
+}
+#endif
+
+/*********************************************************************
+* Overview: The test scenes and the CRC-32 of the page each one draws.
+*           The CRC values are those of the pages drawn by Primitive.c
+*           of version 3.06 of the Graphics Library, before Bar(), Line()
+*           and BarAlpha() drew spans, built with this driver and test.
+*           The span based primitives must draw the same pixels. A new
+*           scene, or a scene that is meant to draw differently, needs a
+*           new value; check its PNG (run with -save) before taking it.
+*
+*********************************************************************/
+typedef struct
+{
+    const char  *name;
+    void        (*pDraw)(void);
+    DWORD       crc;
+} HOST_FB_TEST_SCENE;
+
+static const HOST_FB_TEST_SCENE _testScenes[] =
+{
+    {"bars",    TestSceneBars,      0x5A49F8CEul},
+    {"lines",   TestSceneLines,     0xC73F034Cul},
+    {"shapes",  TestSceneShapes,    0xE5CDE03Bul},
+#ifdef USE_FONT_FLASH
+    {"text",    TestSceneText,      0xD1720E7Aul},
+#endif
+#ifdef USE_ALPHABLEND_LITE
+    {"alpha",   TestSceneAlpha,     0x454A5663ul},
+#endif
+};
+
+#define HOST_FB_TEST_SCENES     (sizeof(_testScenes) / sizeof(_testScenes[0]))
+
+/*********************************************************************
+* Function: static DWORD TestPageCRC(void)
+*
+* Overview: Returns the CRC-32 of page 0, each pixel taken as two bytes
+*           with the low byte first.
+*
+********************************************************************/
+static DWORD TestPageCRC(void)
+{
+    WORD    *pPixel;
+    DWORD   counter, crc;
+    WORD    data;
+    BYTE    bit;
+
+    crc = 0xFFFFFFFFul;
+    pPixel = HostFrameBufferGetPage(0);
+    for(counter = 0; counter < HOST_FB_PAGE_SIZE; counter++)
+    {
+        data = *pPixel++;
+        for(bit = 0; bit < 16; bit++)
+        {
+            crc = ((crc ^ (data >> bit)) & 1) ? (crc >> 1) ^ 0xEDB88320ul : (crc >> 1);
+        }
+    }
+    return (~crc & 0xFFFFFFFFul);
+}
+
+/*********************************************************************
+* Function: static void TestBenchmark(void)
+*
+* Overview: Draws each scene for at least one second of processor time
+*           and prints the frames and the pixels written per second.
+*
+********************************************************************/
+static void TestBenchmark(void)
+{
+    clock_t start, elapsed;
+    DWORD   frames;
+    double  seconds;
+    WORD    i;
+
+    for(i = 0; i < HOST_FB_TEST_SCENES; i++)
+    {
+        HostFrameBufferResetStats();
+        frames = 0;
+        start = clock();
+        do
+        {
+            _testScenes[i].pDraw();
+            frames++;
+            elapsed = clock() - start;
+        } while(elapsed < CLOCKS_PER_SEC);
+
+        seconds = (double)elapsed / CLOCKS_PER_SEC;
+        printf("bench: %-8s %8.1f frames/s %8.2f Mpixels/s\n", _testScenes[i].name, 
+            frames / seconds, HostFrameBufferStats.pixelsWritten / seconds / 1000000.0);
+    }
+}
+
+/*********************************************************************
+* Function: int main(int argc, char *argv[])
+*
+* Overview: Checks the scenes and BarAlpha(), then runs the benchmark.
+*           A scene that does not match its CRC is saved as 
+*           hostfb_<scene>.png in the current directory. Run with -save
+*           to save every scene.
+*
+********************************************************************/
+int main(int argc, char *argv[])
+{
+    int     failed = 0;
+    BOOL    saveAll;
+    WORD    i;
+    DWORD   crc;
+    char    fileName[32];
+#ifdef USE_ALPHABLEND_LITE
+    WORD    errors;
+#endif
+
+    saveAll = (argc > 1) && (strcmp(argv[1], "-save") == 0);
+
+    ResetDevice();
+
+    for(i = 0; i < HOST_FB_TEST_SCENES; i++)
+    {
+        _testScenes[i].pDraw();
+        crc = TestPageCRC();
+        printf("%s: scene %s, CRC 0x%08lX\n", (crc == _testScenes[i].crc) ? "pass" : "FAIL", 
+            _testScenes[i].name, (unsigned long)crc);
+        if(crc != _testScenes[i].crc)
+            failed++;
+        if(saveAll || (crc != _testScenes[i].crc))
+        {
+            // keep the page for a look at what changed
+            sprintf(fileName, "hostfb_%s.png", _testScenes[i].name);
+            HostFrameBufferSavePNG(fileName, 0);
+        }
+    }
+
+#ifdef USE_ALPHABLEND_LITE
+    errors = TestBarAlpha();
+    printf("%s: BarAlpha, %u of %u bars differ from the reference\n", errors ? "FAIL" : "pass", errors, BAR_ALPHA_TEST_BARS);
+    if(errors)
+        failed++;
+#endif
+
+    TestBenchmark();
+
+    return (failed);
+}
@@ -0,0 +1,450 @@
+/******************************************************************************
+
+* FileName:        GifDecoderTest.c
+* Dependencies:    ImageDecoder.c, GifDecoder.c
+* Processor:       Host (Linux, Windows)
+* Compiler:        GCC
+* Company:         Microchip Technology, Inc.
+
+ * Software License Agreement
+ *
+ * Copyright (C) 2012 Microchip Technology Inc.  All rights reserved.
+ * Microchip licenses to you the right to use, modify, copy and distribute
+ * Software only when embedded on a Microchip microcontroller or digital
+ * signal controller, which is integrated into your product or third party
+ * product (pursuant to the sublicense terms in the accompanying license
+ * agreement).
+ *
+ * You should refer to the license agreement accompanying this Software
+ * for additional information regarding your rights and obligations.
+ *
+ * SOFTWARE AND DOCUMENTATION ARE PROVIDED "AS IS" WITHOUT WARRANTY OF ANY
+ * KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION, ANY WARRANTY
+ * OF MERCHANTABILITY, TITLE, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+ * PURPOSE. IN NO EVENT SHALL MICROCHIP OR ITS LICENSORS BE LIABLE OR
+ * OBLIGATED UNDER CONTRACT, NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION,
+ * BREACH OF WARRANTY, OR OTHER LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT
+ * DAMAGES OR EXPENSES INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL,
+ * INDIRECT, PUNITIVE OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA,
+ * COST OF PROCUREMENT OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY
+ * CLAIMS BY THIRD PARTIES (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF),
+ * OR OTHER SIMILAR COSTS.
+
+ Checks and times the GIF decoder.  Test images are LZW encoded in memory,
+ decoded through a memory file, and every output pixel is compared with the
+ encoded palette index.  The cases cover random data (short strings), runs,
+ single color images whose strings run over many rows, one pixel wide
+ images and interlaced rows.  Then each benchmark image is decoded for at
+ least one second of processor time and the decoding speed is printed.
+
+ run_tests.sh builds the program twice: GifDecoderTest with the packed
+ dictionary and GifDecoderTestFlat with GIF_USE_FLAT_SYMBOL_TABLE set to 1,
+ so the two benchmark reports can be compared.
+*******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "Image Decoders/ImageDecoder.h"
+
+#define TEST_MAX_WIDTH          1024
+#define TEST_MAX_HEIGHT         1024
+#define TEST_GIF_BUFFER_SIZE    (2 * TEST_MAX_WIDTH * TEST_MAX_HEIGHT)
+#define TEST_NO_PIXEL           0xFFFF
+#define TEST_END_OF_STREAM      0x3B    /* GIF_bDecode() stopped at the trailer */
+
+typedef enum _TEST_CONTENT
+{
+     TEST_RANDOM = 0,       /* Random indices, short strings */
+     TEST_RUNS,             /* Runs of 1 to 60 pixels of 8 indices */
+     TEST_GRADIENT,         /* Diagonal bands, like a smooth picture */
+     TEST_CONSTANT          /* One index, strings of up to 4096 pixels */
+} TEST_CONTENT;
+
+typedef struct _TEST_CASE
+{
+     WORD         wWidth;
+     WORD         wHeight;
+     BYTE         blInterlaced;
+     TEST_CONTENT eContent;
+} TEST_CASE;
+
+typedef struct _TEST_FILE
+{
+     const BYTE *pbData;
+     DWORD      dwSize;
+     DWORD      dwPosition;
+} TEST_FILE;
+
+static const TEST_CASE TEST_asCases[] =
+{
+     {  37,   23, 0, TEST_RANDOM   },
+     {  37,   23, 1, TEST_RANDOM   },
+     {   1,   50, 1, TEST_RANDOM   },
+     {   3,  200, 0, TEST_RUNS     },
+     { 200,  150, 1, TEST_RUNS     },
+     { 640,  480, 0, TEST_RUNS     },
+     {   7,  900, 0, TEST_RUNS     },
+     { 320,  240, 0, TEST_GRADIENT },
+     {   1, 1000, 0, TEST_CONSTANT },
+     {   2, 1000, 1, TEST_CONSTANT },
+     {   3, 1024, 0, TEST_CONSTANT },
+     {1024,   64, 0, TEST_CONSTANT }
+};
+
+static const TEST_CASE TEST_asBenchmarks[] =
+{
+     { 320,  240, 0, TEST_RANDOM   },
+     { 320,  240, 0, TEST_RUNS     },
+     { 320,  240, 0, TEST_GRADIENT },
+     { 320,  240, 1, TEST_GRADIENT }
+};
+
+static const char *TEST_apszContent[] = {"random", "runs", "gradient", "constant"};
+
+static BYTE  TEST_abPixels[TEST_MAX_WIDTH * TEST_MAX_HEIGHT];      /* Palette index of each pixel */
+static WORD  TEST_awOutput[TEST_MAX_HEIGHT][TEST_MAX_WIDTH];       /* Decoded index, or TEST_NO_PIXEL */
+static BYTE  TEST_abGif[TEST_GIF_BUFFER_SIZE];
+static BYTE  TEST_abCodes[TEST_GIF_BUFFER_SIZE];
+static WORD  TEST_awChild[4096][256];                              /* LZW encoder dictionary */
+static DWORD TEST_dwBadColors;
+static DWORD TEST_dwSeed;
+
+/*******************************************************************************
+ Memory file of the decoder
+*******************************************************************************/
+static size_t TEST_Read(void *ptr, size_t size, size_t n, void *stream)
+{
+       TEST_FILE *pFile = (TEST_FILE *)stream;
+       size_t    count = size * n;
+
+       if(count > pFile->dwSize - pFile->dwPosition)
+       {
+                count = pFile->dwSize - pFile->dwPosition;
+       }
+       memcpy(ptr, &pFile->pbData[pFile->dwPosition], count);
+       pFile->dwPosition += count;
+       return (size != 0) ? count / size : 0;
+}
+
+static int TEST_Seek(void *stream, long offset, int whence)
+{
+       TEST_FILE *pFile = (TEST_FILE *)stream;
+
+       switch(whence)
+       {
+            case SEEK_SET: pFile->dwPosition = offset; break;
+            case SEEK_CUR: pFile->dwPosition += offset; break;
+            case SEEK_END: pFile->dwPosition = pFile->dwSize + offset; break;
+       }
+       return 0;
+}
+
+static long TEST_Tell(void *fo)
+{
+       return ((TEST_FILE *)fo)->dwPosition;
+}
+
+static int TEST_Feof(void *stream)
+{
+       return ((TEST_FILE *)stream)->dwPosition >= ((TEST_FILE *)stream)->dwSize;
+}
+
+static IMG_FILE_SYSTEM_API TEST_sFileAPIs = {TEST_Read, TEST_Seek, TEST_Tell, TEST_Feof};
+
+/*******************************************************************************
+ Pixel output: index i has the color (i, 3 * i, 255 - i), so the red value is
+ the index and green and blue only have to be checked.
+*******************************************************************************/
+static void TEST_vPixelOutput(IMG_PIXEL_XY_RGB_888 *pPix)
+{
+       if(pPix->X < TEST_MAX_WIDTH && pPix->Y < TEST_MAX_HEIGHT)
+       {
+                TEST_awOutput[pPix->Y][pPix->X] = pPix->R;
+       }
+       if(pPix->G != (BYTE)(pPix->R * 3) || pPix->B != (BYTE)(255 - pPix->R))
+       {
+                TEST_dwBadColors++;
+       }
+}
+
+static WORD TEST_wRandom(void)
+{
+       TEST_dwSeed = TEST_dwSeed * 1103515245ul + 12345;
+       return (WORD)((TEST_dwSeed >> 16) & 0x7FFF);
+}
+
+/*******************************************************************************
+Function:       static void TEST_vFillPixels(const TEST_CASE *pCase)
+
+Overview:       Fills TEST_abPixels with the content of the case
+*******************************************************************************/
+static void TEST_vFillPixels(const TEST_CASE *pCase)
+{
+       DWORD dwCount = (DWORD)pCase->wWidth * pCase->wHeight;
+       DWORD dwCounter = 0;
+       WORD  wRun;
+       BYTE  bIndex;
+
+       TEST_dwSeed = 1;
+       while(dwCounter < dwCount)
+       {
+                switch(pCase->eContent)
+                {
+                     case TEST_RANDOM:
+                          TEST_abPixels[dwCounter++] = (BYTE)TEST_wRandom();
+                          break;
+                     case TEST_RUNS:
+                          bIndex = TEST_wRandom() % 8;
+                          for(wRun = TEST_wRandom() % 60 + 1; wRun > 0 && dwCounter < dwCount; wRun--)
+                          {
+                                   TEST_abPixels[dwCounter++] = bIndex;
+                          }
+                          break;
+                     case TEST_GRADIENT:
+                          TEST_abPixels[dwCounter] = (BYTE)((dwCounter % pCase->wWidth) / 5 + (dwCounter / pCase->wWidth) / 7);
+                          dwCounter++;
+                          break;
+                     default:
+                          TEST_abPixels[dwCounter++] = 5;
+                          break;
+                }
+       }
+}
+
+/*******************************************************************************
+Function:       static DWORD TEST_dwEncode(const TEST_CASE *pCase)
+
+Overview:       Writes a GIF89a file of TEST_abPixels into TEST_abGif, with a
+                256 color global palette and 8 bit LZW codes. The dictionary
+                is cleared when it is full.
+
+Output:         Size of the file
+*******************************************************************************/
+static DWORD TEST_dwEncode(const TEST_CASE *pCase)
+{
+       BYTE  *pbOut = TEST_abGif;
+       DWORD dwCodeBytes = 0;
+       DWORD dwBits = 0;
+       BYTE  bBitCount = 0;
+       BYTE  bCodeSize = 9;
+       WORD  wNextCode = 258;
+       WORD  wPrefix = 0xFFFF;
+       WORD  wRow, wSourceRow, wX, wCounter;
+       BYTE  bPass, bIndex;
+       static const BYTE abPassStart[4] = {0, 4, 2, 1};
+       static const BYTE abPassStep[4] = {8, 8, 4, 2};
+
+       #define TEST_EMIT(wCode)  do { dwBits |= (DWORD)(wCode) << bBitCount; bBitCount += bCodeSize; \
+                                      while(bBitCount >= 8) { TEST_abCodes[dwCodeBytes++] = (BYTE)dwBits; \
+                                      dwBits >>= 8; bBitCount -= 8; } } while(0)
+
+       memcpy(pbOut, "GIF89a", 6);
+       pbOut += 6;
+       *pbOut++ = (BYTE)pCase->wWidth;
+       *pbOut++ = (BYTE)(pCase->wWidth >> 8);
+       *pbOut++ = (BYTE)pCase->wHeight;
+       *pbOut++ = (BYTE)(pCase->wHeight >> 8);
+       *pbOut++ = 0xF7;         /* global palette of 256 colors */
+       *pbOut++ = 0;
+       *pbOut++ = 0;
+       for(wCounter = 0; wCounter < 256; wCounter++)
+       {
+                *pbOut++ = (BYTE)wCounter;
+                *pbOut++ = (BYTE)(wCounter * 3);
+                *pbOut++ = (BYTE)(255 - wCounter);
+       }
+       *pbOut++ = 0x2C;         /* image descriptor */
+       memset(pbOut, 0, 4);
+       pbOut += 4;
+       *pbOut++ = (BYTE)pCase->wWidth;
+       *pbOut++ = (BYTE)(pCase->wWidth >> 8);
+       *pbOut++ = (BYTE)pCase->wHeight;
+       *pbOut++ = (BYTE)(pCase->wHeight >> 8);
+       *pbOut++ = pCase->blInterlaced ? 0x40 : 0;
+       *pbOut++ = 8;            /* LZW minimum code size */
+
+       memset(TEST_awChild, 0xFF, sizeof(TEST_awChild));
+       TEST_EMIT(256);
+       bPass = 0;
+       wSourceRow = 0;
+       for(wRow = 0; wRow < pCase->wHeight; wRow++)
+       {
+                if(pCase->blInterlaced)
+                {
+                     wSourceRow = (wRow == 0) ? 0 : wSourceRow + abPassStep[bPass];
+                     while(wSourceRow >= pCase->wHeight)
+                     {
+                              bPass++;
+                              wSourceRow = abPassStart[bPass];
+                     }
+                }
+                else
+                {
+                     wSourceRow = wRow;
+                }
+                for(wX = 0; wX < pCase->wWidth; wX++)
+                {
+                     bIndex = TEST_abPixels[(DWORD)wSourceRow * pCase->wWidth + wX];
+                     if(wPrefix == 0xFFFF)
+                     {
+                              wPrefix = bIndex;
+                     }
+                     else if(TEST_awChild[wPrefix][bIndex] != 0xFFFF)
+                     {
+                              wPrefix = TEST_awChild[wPrefix][bIndex];
+                     }
+                     else
+                     {
+                              TEST_EMIT(wPrefix);
+                              if(wNextCode < 4096)
+                              {
+                                       TEST_awChild[wPrefix][bIndex] = wNextCode++;
+                                       if(wNextCode - 1 == (1 << bCodeSize) && bCodeSize < 12)
+                                       {
+                                                bCodeSize++;
+                                       }
+                              }
+                              else
+                              {
+                                       TEST_EMIT(256);
+                                       memset(TEST_awChild, 0xFF, sizeof(TEST_awChild));
+                                       wNextCode = 258;
+                                       bCodeSize = 9;
+                              }
+                              wPrefix = bIndex;
+                     }
+                }
+       }
+       TEST_EMIT(wPrefix);
+       TEST_EMIT(257);
+       if(bBitCount > 0)
+       {
+                TEST_abCodes[dwCodeBytes++] = (BYTE)dwBits;
+       }
+       #undef TEST_EMIT
+
+       for(dwBits = 0; dwBits < dwCodeBytes; dwBits += 255)
+       {
+                bIndex = (dwCodeBytes - dwBits > 255) ? 255 : (BYTE)(dwCodeBytes - dwBits);
+                *pbOut++ = bIndex;
+                memcpy(pbOut, &TEST_abCodes[dwBits], bIndex);
+                pbOut += bIndex;
+       }
+       *pbOut++ = 0;            /* end of the image data */
+       *pbOut++ = 0x3B;         /* trailer */
+       return pbOut - TEST_abGif;
+}
+
+/*******************************************************************************
+Function:       static BYTE TEST_bDecode(DWORD dwSize)
+
+Overview:       Decodes the GIF file in TEST_abGif
+
+Output:         Error code of ImageDecode()
+*******************************************************************************/
+static BYTE TEST_bDecode(DWORD dwSize)
+{
+       TEST_FILE sFile;
+
+       sFile.pbData = TEST_abGif;
+       sFile.dwSize = dwSize;
+       sFile.dwPosition = 0;
+       return ImageDecode(&sFile, IMG_GIF, 0, 0, TEST_MAX_WIDTH, TEST_MAX_HEIGHT, 0, &TEST_sFileAPIs, TEST_vPixelOutput);
+}
+
+/*******************************************************************************
+Function:       static BYTE TEST_blCheck(const TEST_CASE *pCase)
+
+Overview:       Encodes and decodes the case and compares every pixel
+
+Output:         1 if the decoded image is the encoded one
+*******************************************************************************/
+static BYTE TEST_blCheck(const TEST_CASE *pCase)
+{
+       DWORD dwSize, dwWrong = 0;
+       WORD  wX, wY;
+       BYTE  bError;
+       BYTE  blPass;
+
+       TEST_vFillPixels(pCase);
+       dwSize = TEST_dwEncode(pCase);
+       memset(TEST_awOutput, 0xFF, sizeof(TEST_awOutput));
+       TEST_dwBadColors = 0;
+       bError = TEST_bDecode(dwSize);
+
+       for(wY = 0; wY < TEST_MAX_HEIGHT; wY++)
+       {
+                for(wX = 0; wX < TEST_MAX_WIDTH; wX++)
+                {
+                     if(wX < pCase->wWidth && wY < pCase->wHeight)
+                     {
+                              dwWrong += TEST_awOutput[wY][wX] != TEST_abPixels[(DWORD)wY * pCase->wWidth + wX];
+                     }
+                     else
+                     {
+                              dwWrong += TEST_awOutput[wY][wX] != TEST_NO_PIXEL;
+                     }
+                }
+       }
+       dwWrong += TEST_dwBadColors;
+       blPass = (bError == 0 || bError == TEST_END_OF_STREAM) && dwWrong == 0;
+
+       printf("%s: %4u x %4u %-8s %-11s returned 0x%02X, %lu pixels wrong\n", blPass ? "pass" : "FAIL",
+              pCase->wWidth, pCase->wHeight, TEST_apszContent[pCase->eContent],
+              pCase->blInterlaced ? "interlaced" : "progressive", bError, (unsigned long)dwWrong);
+       return blPass;
+}
+
+/*******************************************************************************
+Function:       static void TEST_vBenchmark(const TEST_CASE *pCase)
+
+Overview:       Decodes the case for at least one second of processor time and
+                prints the time per image and the decoded pixels per second
+*******************************************************************************/
+static void TEST_vBenchmark(const TEST_CASE *pCase)
+{
+       clock_t start, elapsed;
+       DWORD   dwSize, dwImages = 0;
+       double  dSeconds;
+
+       TEST_vFillPixels(pCase);
+       dwSize = TEST_dwEncode(pCase);
+       start = clock();
+       do
+       {
+                TEST_bDecode(dwSize);
+                dwImages++;
+                elapsed = clock() - start;
+       } while(elapsed < CLOCKS_PER_SEC);
+
+       dSeconds = (double)elapsed / CLOCKS_PER_SEC;
+       printf("bench: %u x %u %-8s %-11s %6lu bytes %8.3f ms/image %7.2f Mpixels/s\n",
+              pCase->wWidth, pCase->wHeight, TEST_apszContent[pCase->eContent],
+              pCase->blInterlaced ? "interlaced" : "progressive", (unsigned long)dwSize,
+              dSeconds * 1000.0 / dwImages, (double)pCase->wWidth * pCase->wHeight * dwImages / dSeconds / 1000000.0);
+}
+
+int main(void)
+{
+       WORD wCounter;
+       int  failed = 0;
+
+       printf("GIF decoder, %s dictionary\n", (GIF_USE_FLAT_SYMBOL_TABLE == 1) ? "flat" : "packed");
+       ImageDecoderInit();
+
+       for(wCounter = 0; wCounter < sizeof(TEST_asCases) / sizeof(TEST_asCases[0]); wCounter++)
+       {
+                if(!TEST_blCheck(&TEST_asCases[wCounter]))
+                {
+                     failed++;
+                }
+       }
+
+       for(wCounter = 0; wCounter < sizeof(TEST_asBenchmarks) / sizeof(TEST_asBenchmarks[0]); wCounter++)
+       {
+                TEST_vBenchmark(&TEST_asBenchmarks[wCounter]);
+       }
+
+       return failed;
+}
@@ -0,0 +1,16 @@
+/******************************************************************************
+* FileName:        ImageDecoderConfig.h
+* Processor:       Host (Linux, Windows)
+* Compiler:        GCC
+
+ Image decoder configuration of GifDecoderTest.c: GIF only, read through the
+ file system API pointers, output through the pixel callback.
+*******************************************************************************/
+#ifndef __IMAGEDECODERCONFIG_H__
+#define __IMAGEDECODERCONFIG_H__
+
+#include <stdlib.h>
+
+#define IMG_SUPPORT_GIF
+
+#endif
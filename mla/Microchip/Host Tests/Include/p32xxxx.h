@@ -0,0 +1,86 @@
+/******************************************************************************
+ File Name:       p32xxxx.h
+ Processor:       Host (Linux, Windows)
+ Compiler:        GCC
+
+ Stands in for the PIC32 device header in the host tests.  The host tests
+ build the libraries as PIC32 code (-D__PIC32MX__), so Compiler.h and the
+ USB HAL include this file.  It declares the USB module registers as plain
+ variables, with the bit fields that usb_host.c uses; a test that links
+ code using them must define the variables.  The interrupt controller
+ registers are reduced to the USB bits.
+******************************************************************************/
+#ifndef _HOST_TEST_P32XXXX_H
+#define _HOST_TEST_P32XXXX_H
+
+#define __ISR(vector, ipl)
+#define _USB_1_VECTOR                   45
+
+#define KVA_TO_PA(v)                    ((unsigned long)(v))
+#define PA_TO_KVA1(pa)                  ((void *)(pa))
+
+// Declares name##u, a register that can be read as a word (name) or as bit
+// fields (name##bits).
+#define HOST_TEST_REGISTER(name, bits)  typedef union { unsigned int w; struct { bits }; } name##_t; \
+                                        extern volatile name##_t name##u;
+
+HOST_TEST_REGISTER(U1IR,      unsigned URSTIF:1; unsigned UERRIF:1; unsigned SOFIF:1; unsigned TRNIF:1;
+                              unsigned IDLEIF:1; unsigned RESUMEIF:1; unsigned ATTACHIF:1; unsigned STALLIF:1;)
+HOST_TEST_REGISTER(U1IE,      unsigned URSTIE:1; unsigned UERRIE:1; unsigned SOFIE:1; unsigned TRNIE:1;
+                              unsigned IDLEIE:1; unsigned RESUMEIE:1; unsigned ATTACHIE:1; unsigned STALLIE:1;)
+HOST_TEST_REGISTER(U1STAT,    unsigned :2; unsigned PPBI:1; unsigned DIR:1; unsigned ENDPT:4;)
+HOST_TEST_REGISTER(U1CON,     unsigned SOFEN:1; unsigned PPBRST:1; unsigned RESUME:1; unsigned HOSTEN:1;
+                              unsigned USBRST:1; unsigned TOKBUSY:1; unsigned SE0:1; unsigned JSTATE:1;)
+HOST_TEST_REGISTER(U1EIR,     unsigned PIDEF:1; unsigned EOFEF:1; unsigned CRC16EF:1; unsigned DFN8EF:1;
+                              unsigned BTOEF:1; unsigned DMAEF:1; unsigned BMXEF:1; unsigned BTSEF:1;)
+HOST_TEST_REGISTER(U1OTGIR,   unsigned VBUSVDIF:1; unsigned :1; unsigned SESENDIF:1; unsigned SESVDIF:1;
+                              unsigned ACTVIF:1; unsigned LSTATEIF:1; unsigned T1MSECIF:1; unsigned IDIF:1;)
+HOST_TEST_REGISTER(U1OTGIE,   unsigned VBUSVDIE:1; unsigned :1; unsigned SESENDIE:1; unsigned SESVDIE:1;
+                              unsigned ACTVIE:1; unsigned LSTATEIE:1; unsigned T1MSECIE:1; unsigned IDIE:1;)
+HOST_TEST_REGISTER(U1OTGSTAT, unsigned ID:1; unsigned :1; unsigned LSTATE:1; unsigned SESEND:1;
+                              unsigned :1; unsigned SESVD:1; unsigned :1; unsigned VBUSVD:1;)
+HOST_TEST_REGISTER(U1PWRC,    unsigned USBPWR:1; unsigned USUSPEND:1;)
+HOST_TEST_REGISTER(U1EP0,     unsigned EPHSHK:1; unsigned EPSTALL:1; unsigned EPTXEN:1; unsigned EPRXEN:1;
+                              unsigned EPCONDIS:1; unsigned :1; unsigned RETRYDIS:1; unsigned LSPD:1;)
+
+typedef U1STAT_t                __U1STATbits_t;
+
+// Host mode names of the shared bits
+#define DETACHIF                URSTIF
+#define DETACHIE                URSTIE
+#define PKTDIS                  TOKBUSY
+
+#define U1IR                    U1IRu.w
+#define U1IRbits                U1IRu
+#define U1IE                    U1IEu.w
+#define U1IEbits                U1IEu
+#define U1STAT                  U1STATu.w
+#define U1STATbits              U1STATu
+#define U1CON                   U1CONu.w
+#define U1CONbits               U1CONu
+#define U1EIR                   U1EIRu.w
+#define U1EIRbits               U1EIRu
+#define U1OTGIR                 U1OTGIRu.w
+#define U1OTGIRbits             U1OTGIRu
+#define U1OTGIE                 U1OTGIEu.w
+#define U1OTGIEbits             U1OTGIEu
+#define U1OTGSTAT               U1OTGSTATu.w
+#define U1OTGSTATbits           U1OTGSTATu
+#define U1PWRC                  U1PWRCu.w
+#define U1PWRCbits              U1PWRCu
+#define U1EP0                   U1EP0u.w
+#define U1EP0bits               U1EP0u
+
+extern volatile unsigned int    U1ADDR, U1TOK, U1SOF, U1CNFG1, U1CNFG2, U1EIE, U1OTGCON,
+                                U1BDTP1, U1BDTP2, U1BDTP3,
+                                U1EP1, U1EP2, U1EP3, U1EP4, U1EP5, U1EP6, U1EP7, U1EP8,
+                                U1EP9, U1EP10, U1EP11, U1EP12, U1EP13, U1EP14, U1EP15,
+                                IFS1, IFS1CLR, IEC1, IEC1SET, IEC1CLR, IPC11CLR, IPC11SET;
+
+#define _IFS1_USBIF_MASK        0x02000000
+#define _IEC1_USBIE_MASK        0x02000000
+#define _IPC11_USBIP_MASK       0x0000001C
+#define _IPC11_USBIS_MASK       0x00000003
+#define _IPC11_USBIP_POSITION   2
+
+#endif
@@ -0,0 +1,9 @@
+/******************************************************************************
+ File Name:       plib.h
+ Processor:       Host (Linux, Windows)
+ Compiler:        GCC
+
+ Stands in for the PIC32 peripheral library in the host tests.  Compiler.h
+ includes it when __PIC32MX__ is defined; none of the code under test calls
+ the peripheral library, so it is empty.
+******************************************************************************/
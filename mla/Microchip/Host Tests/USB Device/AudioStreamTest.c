@@ -0,0 +1,382 @@
+/******************************************************************************
+
+    USB Audio Stream Test
+
+This program checks the sample FIFO and the feedback calculations of
+usb_function_audio_stream.c on a development host.  The file does not use the
+USB stack or the hardware, so it is built as is.
+
+The test checks that:
+    - sample frames come out of the FIFO in the order they went in, while the
+      head and the tail wrap around the end of the buffer many times,
+    - frames that do not fit are counted as overruns, and frames that are not
+      there as underruns,
+    - the feedback value follows the FIFO level and is clamped to one sample
+      of the nominal rate, in 10.14 format,
+    - a window measured with a missed or an extra SOF does not change the
+      sample rate estimate, and a window a little off the nominal rate does.
+
+*******************************************************************************/
+//DOM-IGNORE-BEGIN
+/******************************************************************************
+
+ File Name:       AudioStreamTest.c
+ Dependencies:    usb_function_audio_stream.c
+ Processor:       Host (Linux, Windows)
+ Compiler:        GCC
+ Company:         Microchip Technology, Inc.
+
+Software License Agreement
+
+The software supplied herewith by Microchip Technology Incorporated
+(the "Company") for its PICmicro(R) Microcontroller is intended and
+supplied to you, the Company's customer, for use solely and
+exclusively on Microchip PICmicro Microcontroller products. The
+software is owned by the Company and/or its supplier, and is
+protected under applicable copyright laws. All rights are reserved.
+Any use in violation of the foregoing restrictions may subject the
+user to criminal sanctions under applicable laws, as well as to
+civil liability for the breach of the terms and conditions of this
+license.
+
+THIS SOFTWARE IS PROVIDED IN AN "AS IS" CONDITION. NO WARRANTIES,
+WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+
+*******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "GenericTypeDefs.h"
+#include "USB/usb_function_audio_stream.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Constants
+// *****************************************************************************
+// *****************************************************************************
+
+// FIFO of 7 stereo 16-bit frames.  The size does not divide the transfer
+// lengths, so the head and the tail wrap at every position.
+#define TEST_FIFO_FRAMES        7
+#define TEST_FRAME_BYTES        4
+#define TEST_FIFO_ROUNDS        1000
+
+// 48 kHz against a 12 MHz timer, measured over 2^3 frames
+#define TEST_SAMPLE_RATE        48000ul
+#define TEST_TIMER_HZ           12000000ull
+#define TEST_TICKS_PER_FRAME    (TEST_TIMER_HZ / USB_AUDIO_FRAMES_PER_SECOND)
+#define TEST_REFRESH            3
+
+#define TEST_ONE_SAMPLE         (1ul << USB_AUDIO_FEEDBACK_FRACTION_BITS)
+#define TEST_NOMINAL            ((TEST_SAMPLE_RATE << USB_AUDIO_FEEDBACK_FRACTION_BITS) / USB_AUDIO_FRAMES_PER_SECOND)
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Variables
+// *****************************************************************************
+// *****************************************************************************
+
+static BYTE     fifoBuffer[TEST_FIFO_FRAMES * TEST_FRAME_BYTES];
+static DWORD    randomSeed = 1;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Helpers
+// *****************************************************************************
+// *****************************************************************************
+
+static WORD TestRandom( void )
+{
+    randomSeed = randomSeed * 1103515245ul + 12345;
+    return (WORD)((randomSeed >> 16) & 0x7FFF);
+}
+
+// Prints the result of a check and returns 1 if it failed.
+static int TestResult( BOOL pass, const char *check )
+{
+    printf( "%s: %s\n", pass ? "pass" : "FAIL", check );
+    return pass ? 0 : 1;
+}
+
+// Fills frames sample frames with the frame numbers from first on.
+static void TestFill( BYTE *data, DWORD first, WORD frames )
+{
+    WORD i;
+
+    for (i = 0; i < frames * TEST_FRAME_BYTES; i += TEST_FRAME_BYTES)
+    {
+        memcpy( &data[i], &first, TEST_FRAME_BYTES );
+        first++;
+    }
+}
+
+/****************************************************************************
+  Function:
+    static BOOL TestFeedbackWindow( USB_AUDIO_FEEDBACK *fb, QWORD *time,
+                                    QWORD ticks, QWORD lastTicks )
+
+  Description:
+    Timestamps the 2^TEST_REFRESH Start-of-Frames of the next window,
+    ticks timer ticks apart, except for the last one, which comes
+    lastTicks after the one before.
+
+  Parameters:
+    USB_AUDIO_FEEDBACK *fb  - Feedback state
+    QWORD *time             - Timer value of the previous SOF, updated
+    QWORD ticks             - Timer ticks from one SOF to the next
+    QWORD lastTicks         - Timer ticks before the last SOF
+
+  Return Values:
+    TRUE    - Only the last SOF ended a window.
+    FALSE   - Otherwise
+  ***************************************************************************/
+
+static BOOL TestFeedbackWindow( USB_AUDIO_FEEDBACK *fb, QWORD *time, QWORD ticks, QWORD lastTicks )
+{
+    WORD i;
+    BOOL ended;
+    BOOL pass = TRUE;
+
+    for (i = 1; i <= (1 << TEST_REFRESH); i++)
+    {
+        *time += (i == (1 << TEST_REFRESH)) ? lastTicks : ticks;
+        ended = USBAudioFeedbackSOF( fb, *time );
+        if (ended != (i == (1 << TEST_REFRESH)))
+        {
+            pass = FALSE;
+        }
+    }
+    return pass;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Tests
+// *****************************************************************************
+// *****************************************************************************
+
+/****************************************************************************
+  Function:
+    static int TestFifo( void )
+
+  Description:
+    Writes and reads random numbers of numbered frames, some more than fit
+    or than are there, and checks every frame read and the overrun and
+    underrun counts.
+
+  Return Values:
+    Number of failed checks
+  ***************************************************************************/
+
+static int TestFifo( void )
+{
+    USB_AUDIO_FIFO  fifo;
+    BYTE            data[(TEST_FIFO_FRAMES + 3) * TEST_FRAME_BYTES];
+    BYTE            expected[sizeof(data)];
+    DWORD           written = 0;
+    DWORD           read = 0;
+    DWORD           overruns = 0;
+    DWORD           underruns = 0;
+    DWORD           headWraps = 0;
+    DWORD           tailWraps = 0;
+    WORD            frames;
+    WORD            copied;
+    WORD            space;
+    WORD            count;
+    WORD            start;
+    WORD            round;
+    BOOL            pass = TRUE;
+    int             failed = 0;
+
+    USBAudioFifoInit( &fifo, fifoBuffer, TEST_FIFO_FRAMES, TEST_FRAME_BYTES );
+
+    for (round = 0; round < TEST_FIFO_ROUNDS; round++)
+    {
+        frames = TestRandom() % (TEST_FIFO_FRAMES + 3);
+        space = TEST_FIFO_FRAMES - USBAudioFifoCount( &fifo );
+        TestFill( data, written, frames );
+        start = fifo.head;
+        copied = USBAudioFifoWrite( &fifo, data, frames );
+        if (copied != ((frames < space) ? frames : space))
+        {
+            pass = FALSE;
+        }
+        if (start + copied >= TEST_FIFO_FRAMES)
+        {
+            headWraps++;
+        }
+        overruns += frames - copied;
+        written += copied;
+
+        frames = TestRandom() % (TEST_FIFO_FRAMES + 3);
+        count = USBAudioFifoCount( &fifo );
+        TestFill( expected, read, (frames < count) ? frames : count );
+        start = fifo.tail;
+        copied = USBAudioFifoRead( &fifo, data, frames );
+        if ((copied != ((frames < count) ? frames : count)) ||
+            (memcmp( data, expected, (DWORD)copied * TEST_FRAME_BYTES ) != 0))
+        {
+            pass = FALSE;
+        }
+        if (start + copied >= TEST_FIFO_FRAMES)
+        {
+            tailWraps++;
+        }
+        underruns += frames - copied;
+        read += copied;
+
+        if (USBAudioFifoCount( &fifo ) != written - read)
+        {
+            pass = FALSE;
+        }
+    }
+
+    printf( "%u rounds: %lu frames through the FIFO, head wrapped %lu times, tail %lu times\n", TEST_FIFO_ROUNDS,
+            (unsigned long)read, (unsigned long)headWraps, (unsigned long)tailWraps );
+    failed += TestResult( pass && (headWraps > 100) && (tailWraps > 100), "frames read in order across the end of the buffer" );
+
+    printf( "%lu overruns, %lu underruns counted, %u and %u in the FIFO\n", (unsigned long)overruns,
+            (unsigned long)underruns, fifo.overruns, fifo.underruns );
+    failed += TestResult( (overruns != 0) && (underruns != 0) &&
+                          (fifo.overruns == (WORD)overruns) && (fifo.underruns == (WORD)underruns),
+                          "overrun and underrun counts" );
+
+    // Full FIFO: nothing is copied, every frame is an overrun.
+    USBAudioFifoInit( &fifo, fifoBuffer, TEST_FIFO_FRAMES, TEST_FRAME_BYTES );
+    TestFill( data, 0, TEST_FIFO_FRAMES + 3 );
+    copied = USBAudioFifoWrite( &fifo, data, TEST_FIFO_FRAMES + 3 );
+    frames = USBAudioFifoWrite( &fifo, data, 2 );
+    failed += TestResult( (copied == TEST_FIFO_FRAMES) && (frames == 0) && (fifo.overruns == 5) &&
+                          (USBAudioFifoCount( &fifo ) == TEST_FIFO_FRAMES), "write to a full FIFO" );
+
+    // Empty FIFO: nothing is copied, every frame is an underrun.
+    copied = USBAudioFifoRead( &fifo, data, TEST_FIFO_FRAMES + 3 );
+    frames = USBAudioFifoRead( &fifo, data, 2 );
+    failed += TestResult( (copied == TEST_FIFO_FRAMES) && (frames == 0) && (fifo.underruns == 5) &&
+                          (USBAudioFifoCount( &fifo ) == 0), "read from an empty FIFO" );
+
+    return failed;
+}
+
+/****************************************************************************
+  Function:
+    static int TestFeedbackValue( void )
+
+  Description:
+    Checks the FIFO correction of USBAudioFeedbackValue() and that the value
+    stays within one sample of the nominal rate.
+
+  Return Values:
+    Number of failed checks
+  ***************************************************************************/
+
+static int TestFeedbackValue( void )
+{
+    USB_AUDIO_FEEDBACK  fb;
+    DWORD               step;
+    DWORD               value;
+    DWORD               low;
+    DWORD               high;
+    int                 failed = 0;
+
+    USBAudioFeedbackInit( &fb, TEST_SAMPLE_RATE, TEST_TIMER_HZ, TEST_REFRESH );
+    step = (DWORD)1 << (USB_AUDIO_FEEDBACK_FRACTION_BITS - USB_AUDIO_FEEDBACK_GAIN_SHIFT);
+
+    value = USBAudioFeedbackValue( &fb, 100, 100 );
+    printf( "nominal 0x%06lX, feedback at the target 0x%06lX\n", (unsigned long)fb.nominal, (unsigned long)value );
+    failed += TestResult( (fb.nominal == TEST_NOMINAL) && (value == TEST_NOMINAL), "48 kHz is 48.0 samples per frame" );
+
+    failed += TestResult( (USBAudioFeedbackValue( &fb, 90, 100 ) == TEST_NOMINAL + 10 * step) &&
+                          (USBAudioFeedbackValue( &fb, 110, 100 ) == TEST_NOMINAL - 10 * step),
+                          "feedback moves the FIFO level toward its target" );
+
+    low = USBAudioFeedbackValue( &fb, 1000, 0 );
+    high = USBAudioFeedbackValue( &fb, 0, 1000 );
+    printf( "feedback with the FIFO 1000 frames off: 0x%06lX to 0x%06lX\n", (unsigned long)low, (unsigned long)high );
+    failed += TestResult( (low == TEST_NOMINAL - TEST_ONE_SAMPLE) && (high == TEST_NOMINAL + TEST_ONE_SAMPLE),
+                          "feedback clamped to one sample of the nominal rate" );
+
+    // The clamp is around the nominal rate, not the estimate.
+    fb.estimate = TEST_NOMINAL + TEST_ONE_SAMPLE / 2;
+    failed += TestResult( (USBAudioFeedbackValue( &fb, 0, 1000 ) == TEST_NOMINAL + TEST_ONE_SAMPLE) &&
+                          (USBAudioFeedbackValue( &fb, 1000, 0 ) == TEST_NOMINAL - TEST_ONE_SAMPLE),
+                          "clamp around the nominal rate with a measured estimate" );
+
+    return failed;
+}
+
+/****************************************************************************
+  Function:
+    static int TestFeedbackSOF( void )
+
+  Description:
+    Measures windows at the nominal rate, 0.1% fast, with a missed SOF
+    (9 frames long), with an extra SOF (7 frames long) and more than 1/64
+    off, and checks which of them change the sample rate estimate.
+
+  Return Values:
+    Number of failed checks
+  ***************************************************************************/
+
+static int TestFeedbackSOF( void )
+{
+    USB_AUDIO_FEEDBACK  fb;
+    QWORD               time = 0x123456789ull;
+    DWORD               fast;
+    BOOL                pass;
+    int                 failed = 0;
+
+    USBAudioFeedbackInit( &fb, TEST_SAMPLE_RATE, TEST_TIMER_HZ, TEST_REFRESH );
+
+    // The first SOF only starts the window.
+    pass = (USBAudioFeedbackSOF( &fb, time ) == FALSE);
+    pass = pass && TestFeedbackWindow( &fb, &time, TEST_TICKS_PER_FRAME, TEST_TICKS_PER_FRAME );
+    failed += TestResult( pass && (fb.estimate == TEST_NOMINAL), "window at the nominal rate" );
+
+    // The local clock runs 0.1% slow, so the frames take 0.1% more ticks.
+    pass = TestFeedbackWindow( &fb, &time, TEST_TICKS_PER_FRAME * 1001 / 1000, TEST_TICKS_PER_FRAME * 1001 / 1000 );
+    fast = fb.estimate;
+    printf( "estimate with the frames 0.1%% long: 0x%06lX\n", (unsigned long)fast );
+    failed += TestResult( pass && (fast == (DWORD)((QWORD)TEST_NOMINAL * 1001 / 1000)), "window 0.1% off accepted" );
+
+    // One SOF missed: the window is 9 frames long.
+    pass = TestFeedbackWindow( &fb, &time, TEST_TICKS_PER_FRAME, 2 * TEST_TICKS_PER_FRAME );
+    failed += TestResult( pass && (fb.estimate == fast), "window with a missed SOF ignored" );
+
+    // One extra SOF: the window is 7 frames long.
+    pass = TestFeedbackWindow( &fb, &time, TEST_TICKS_PER_FRAME * 7 / 8, TEST_TICKS_PER_FRAME * 7 / 8 );
+    failed += TestResult( pass && (fb.estimate == fast), "window with an extra SOF ignored" );
+
+    // Just outside the 1/64 limit on both sides.
+    pass = TestFeedbackWindow( &fb, &time, TEST_TICKS_PER_FRAME * 61 / 60, TEST_TICKS_PER_FRAME * 61 / 60 );
+    pass = pass && TestFeedbackWindow( &fb, &time, TEST_TICKS_PER_FRAME * 59 / 60, TEST_TICKS_PER_FRAME * 59 / 60 );
+    failed += TestResult( pass && (fb.estimate == fast), "windows more than 1/64 off ignored" );
+
+    // The windows share their end points, so the next window is measured
+    // from the last SOF of an ignored one.
+    pass = TestFeedbackWindow( &fb, &time, TEST_TICKS_PER_FRAME, TEST_TICKS_PER_FRAME );
+    failed += TestResult( pass && (fb.estimate == TEST_NOMINAL), "next window at the nominal rate accepted" );
+
+    return failed;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Test
+// *****************************************************************************
+// *****************************************************************************
+
+int main( void )
+{
+    int failed = 0;
+
+    failed += TestFifo();
+    failed += TestFeedbackValue();
+    failed += TestFeedbackSOF();
+
+    return failed;
+}
@@ -0,0 +1,8 @@
+/******************************************************************************
+ File Name:       HardwareProfile.h
+ Processor:       Host (Linux, Windows)
+ Compiler:        GCC
+
+ UsbHostSchedulerTest.c runs the host stack against a simulated USB module,
+ there is no board to describe.
+******************************************************************************/
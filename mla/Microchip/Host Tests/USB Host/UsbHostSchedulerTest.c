@@ -0,0 +1,474 @@
+/******************************************************************************
+
+    USB Host Scheduler Test
+
+This program runs the transfer scheduler of usb_host.c on a development host,
+against a simulated USB module (SIE).  usb_host.c is included directly, so
+the test can set up an attached device and drive _USB1Interrupt() the way
+the hardware would.
+
+The simulated device has three bulk endpoints, one interrupt IN endpoint
+polled every frame, and an interface with three alternate settings:
+    alt 0 - no endpoints
+    alt 1 - one 192 byte isochronous OUT endpoint
+    alt 2 - 1023 byte isochronous OUT and IN endpoints, more than a frame
+
+The SIE runs each token the host writes to U1TOK at once and charges its bus
+time to the current frame.  Like the USB module, it holds a token that would
+not finish before the end of the frame, which then runs first in the next
+frame, ahead of the interrupt transfer.  Bulk IN tokens are NAKed at random.
+
+The test checks that:
+    - SET INTERFACE to alt 2 fails with USB_ERROR_INSUFFICIENT_BANDWIDTH and
+      SET INTERFACE to alt 1 succeeds,
+    - over 10000 frames no token is held past the end of a frame,
+    - the interrupt IN endpoint is serviced in every frame, first,
+    - every bulk endpoint moves data.
+
+*******************************************************************************/
+//DOM-IGNORE-BEGIN
+/******************************************************************************
+
+ File Name:       UsbHostSchedulerTest.c
+ Dependencies:    usb_host.c
+ Processor:       Host (Linux, Windows)
+ Compiler:        GCC
+ Company:         Microchip Technology, Inc.
+
+Software License Agreement
+
+The software supplied herewith by Microchip Technology Incorporated
+(the "Company") for its PICmicro(R) Microcontroller is intended and
+supplied to you, the Company's customer, for use solely and
+exclusively on Microchip PICmicro Microcontroller products. The
+software is owned by the Company and/or its supplier, and is
+protected under applicable copyright laws. All rights are reserved.
+Any use in violation of the foregoing restrictions may subject the
+user to criminal sanctions under applicable laws, as well as to
+civil liability for the breach of the terms and conditions of this
+license.
+
+THIS SOFTWARE IS PROVIDED IN AN "AS IS" CONDITION. NO WARRANTIES,
+WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+
+*******************************************************************************/
+
+#include <stdio.h>
+#include "p32xxxx.h"
+#include "GenericTypeDefs.h"
+#include "USB/usb.h"
+#include "usb_pic32.h"
+
+// The register stubs do not have the error flag values that
+// usb_hal_local.h checks, and usb_pic32.h is already included.
+#define _USB_HAL_LOCAL_H_
+
+// USB module registers of p32xxxx.h
+volatile U1IR_t         U1IRu;
+volatile U1IE_t         U1IEu;
+volatile U1STAT_t       U1STATu;
+volatile U1CON_t        U1CONu;
+volatile U1EIR_t        U1EIRu;
+volatile U1OTGIR_t      U1OTGIRu;
+volatile U1OTGIE_t      U1OTGIEu;
+volatile U1OTGSTAT_t    U1OTGSTATu;
+volatile U1PWRC_t       U1PWRCu;
+volatile U1EP0_t        U1EP0u;
+volatile unsigned int   U1ADDR, U1TOK, U1SOF, U1CNFG1, U1CNFG2, U1EIE, U1OTGCON,
+                        U1BDTP1, U1BDTP2, U1BDTP3,
+                        U1EP1, U1EP2, U1EP3, U1EP4, U1EP5, U1EP6, U1EP7, U1EP8,
+                        U1EP9, U1EP10, U1EP11, U1EP12, U1EP13, U1EP14, U1EP15,
+                        IFS1, IFS1CLR, IEC1, IEC1SET, IEC1CLR, IPC11CLR, IPC11SET;
+
+#include "usb_host.c"
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Constants
+// *****************************************************************************
+// *****************************************************************************
+
+#define TEST_FRAMES             10000
+#define TEST_BULK_ENDPOINTS     3
+#define TEST_INTERRUPT_ENDPOINT 0x82
+#define TEST_BULK_BUFFER_SIZE   4096
+#define TEST_DEVICE_ADDRESS     1
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Variables
+// *****************************************************************************
+// *****************************************************************************
+
+USB_TPL             usbTPL[NUM_TPL_ENTRIES];
+CLIENT_DRIVER_TABLE usbClientDrvTable[NUM_CLIENT_DRIVER_ENTRIES];
+
+static USB_ENDPOINT_INFO    *pBulkEndpoint[TEST_BULK_ENDPOINTS];
+static USB_ENDPOINT_INFO    *pInterruptEndpoint;
+static BYTE                 bulkBuffer[TEST_BULK_ENDPOINTS][TEST_BULK_BUFFER_SIZE];
+static BYTE                 interruptBuffer[8];
+
+static DWORD    bulkPackets[TEST_BULK_ENDPOINTS];
+static DWORD    interruptPackets;
+static DWORD    naks;
+static DWORD    heldTokens;
+static WORD     interruptMaxOffset;     // Latest start of an interrupt transaction in a frame, in byte times
+
+static WORD     frameByteTimes;         // Bus time used in the current frame
+static BOOL     tokenHeld;              // A token did not fit and waits for the next frame
+static DWORD    randomSeed = 1;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Simulated SIE
+// *****************************************************************************
+// *****************************************************************************
+
+BOOL USB_ApplicationEventHandler( BYTE address, USB_EVENT event, void *data, DWORD size )
+{
+    return TRUE;
+}
+
+static WORD TestRandom( void )
+{
+    randomSeed = randomSeed * 1103515245ul + 12345;
+    return (WORD)((randomSeed >> 16) & 0x7FFF);
+}
+
+static void TestInterrupt( DWORD flags )
+{
+    U1IR = flags;
+    U1IE = 0xFF;
+    _USB1Interrupt();
+}
+
+/****************************************************************************
+  Function:
+    static BOOL TestRunToken( void )
+
+  Description:
+    Runs the transaction of the token in U1TOK, fills in the armed buffer
+    descriptor and raises the transfer interrupt.  Endpoint 0 and the bulk
+    OUT endpoint always answer, the interrupt endpoint returns 8 bytes, and
+    bulk IN endpoints return a full buffer or, one time in eight, NAK.
+
+  Return Values:
+    TRUE    - The transaction ran.
+    FALSE   - The transaction does not fit in the rest of the frame, the
+              token is held.
+  ***************************************************************************/
+
+static BOOL TestRunToken( void )
+{
+    BYTE    token    = U1TOK >> 4;
+    BYTE    endpoint = U1TOK & 0x0F;
+    BYTE    first    = (token == PID_IN) ? 0 : 2;
+    BYTE    pid;
+    int     bd       = -1;
+    WORD    bytes;
+    WORD    byteTimes;
+    BYTE    i;
+
+    for (i = first; i < first + 2; i++)
+    {
+        if (BDT[i].STAT.UOWN)
+        {
+            if (bd >= 0)
+            {
+                printf( "FAIL: two buffer descriptors armed for one token\n" );
+                exit( 1 );
+            }
+            bd = i;
+        }
+    }
+    if (bd < 0)
+    {
+        printf( "FAIL: token written without a buffer descriptor\n" );
+        exit( 1 );
+    }
+
+    if (token == PID_IN)
+    {
+        pid = PID_DATA0;
+        if (endpoint == 0)
+        {
+            bytes = 0;
+        }
+        else if (endpoint == (TEST_INTERRUPT_ENDPOINT & 0x0F))
+        {
+            bytes = 8;
+        }
+        else if ((TestRandom() % 8) == 0)
+        {
+            pid   = PID_NAK;
+            bytes = 0;
+            naks++;
+        }
+        else
+        {
+            bytes = BDT[bd].CNT;
+        }
+    }
+    else
+    {
+        pid   = PID_ACK;
+        bytes = BDT[bd].CNT;
+    }
+
+    byteTimes = bytes + USB_OVERHEAD_NON_ISOCHRONOUS;
+    if (frameByteTimes + byteTimes > USB_FRAME_BYTE_TIMES - USB_FRAME_EOF_BYTE_TIMES)
+    {
+        return FALSE;
+    }
+
+    if (pid != PID_NAK)
+    {
+        if (endpoint == (TEST_INTERRUPT_ENDPOINT & 0x0F))
+        {
+            interruptPackets++;
+            if (frameByteTimes > interruptMaxOffset)
+            {
+                interruptMaxOffset = frameByteTimes;
+            }
+        }
+        for (i = 0; i < TEST_BULK_ENDPOINTS; i++)
+        {
+            if ((pBulkEndpoint[i]->bEndpointAddress & 0x0F) == endpoint)
+            {
+                bulkPackets[i]++;
+            }
+        }
+    }
+    frameByteTimes += byteTimes;
+
+    BDT[bd].STAT.Val = 0;
+    BDT[bd].STAT.PID = pid;
+    BDT[bd].count    = bytes;
+    U1STAT = 0;
+    U1STATbits.DIR  = (token != PID_IN);
+    U1STATbits.PPBI = bd & 1;
+    TestInterrupt( USB_INTERRUPT_TRANSFER );
+    return TRUE;
+}
+
+/****************************************************************************
+  Function:
+    static void TestFrame( void )
+
+  Description:
+    Runs one frame: a token held from the last frame, the SOF interrupt,
+    then every token the host writes until one does not fit.  The events
+    queued by the interrupt handler are dropped.
+  ***************************************************************************/
+
+static void TestFrame( void )
+{
+    frameByteTimes = 0;
+    if (tokenHeld)
+    {
+        tokenHeld = FALSE;
+        heldTokens++;
+        if (!TestRunToken())
+        {
+            printf( "FAIL: token held for two frames\n" );
+            exit( 1 );
+        }
+    }
+
+    TestInterrupt( USB_INTERRUPT_SOF );
+    while (usbBusInfo.flags.bfTokenAlreadyWritten)
+    {
+        if (!TestRunToken())
+        {
+            tokenHeld = TRUE;
+            break;
+        }
+    }
+
+    while (StructQueueIsNotEmpty( &usbEventQueue, USB_EVENT_QUEUE_DEPTH ))
+    {
+        StructQueueRemove( &usbEventQueue, USB_EVENT_QUEUE_DEPTH );
+    }
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Device
+// *****************************************************************************
+// *****************************************************************************
+
+static USB_ENDPOINT_INFO *TestEndpoint( USB_INTERFACE_SETTING_INFO *pSetting, BYTE address,
+        BYTE type, WORD maxPacketSize, WORD interval )
+{
+    USB_ENDPOINT_INFO *pEndpoint;
+
+    pEndpoint = calloc( 1, sizeof(USB_ENDPOINT_INFO) );
+    pEndpoint->bEndpointAddress         = address;
+    pEndpoint->bmAttributes.val         = type;
+    pEndpoint->wMaxPacketSize           = maxPacketSize;
+    pEndpoint->wInterval                = interval;
+    pEndpoint->wIntervalCount           = interval;
+    pEndpoint->status.bfUseDTS          = 1;
+    pEndpoint->status.bfTransferComplete = 1;
+    pEndpoint->transferState            = TSTATE_IDLE;
+    if (pSetting != NULL)
+    {
+        pEndpoint->next           = pSetting->pEndpointList;
+        pSetting->pEndpointList   = pEndpoint;
+    }
+    return pEndpoint;
+}
+
+static void TestAttachDevice( void )
+{
+    USB_INTERFACE_INFO          *pInterface0, *pInterface1;
+    USB_INTERFACE_SETTING_INFO  *pSetting0, *pAlt0, *pAlt1, *pAlt2;
+
+    pInterface0 = calloc( 1, sizeof(USB_INTERFACE_INFO) );
+    pInterface1 = calloc( 1, sizeof(USB_INTERFACE_INFO) );
+    pSetting0   = calloc( 1, sizeof(USB_INTERFACE_SETTING_INFO) );
+    pAlt0       = calloc( 1, sizeof(USB_INTERFACE_SETTING_INFO) );
+    pAlt1       = calloc( 1, sizeof(USB_INTERFACE_SETTING_INFO) );
+    pAlt2       = calloc( 1, sizeof(USB_INTERFACE_SETTING_INFO) );
+
+    StructQueueInit( &usbEventQueue, USB_EVENT_QUEUE_DEPTH );
+    pEP0Data                    = malloc( 64 );
+    usbHostState                = STATE_RUNNING | SUBSTATE_NORMAL_RUN;
+    usbDeviceInfo.deviceAddress = TEST_DEVICE_ADDRESS;
+    usbDeviceInfo.pEndpoint0    = TestEndpoint( NULL, 0, USB_TRANSFER_TYPE_CONTROL, 64, 0 );
+
+    // Interface 0: bulk and interrupt endpoints
+    pBulkEndpoint[0]   = TestEndpoint( pSetting0, 0x83, USB_TRANSFER_TYPE_BULK, 64, 0 );
+    pBulkEndpoint[1]   = TestEndpoint( pSetting0, 0x04, USB_TRANSFER_TYPE_BULK, 64, 0 );
+    pBulkEndpoint[2]   = TestEndpoint( pSetting0, 0x85, USB_TRANSFER_TYPE_BULK, 64, 0 );
+    pInterruptEndpoint = TestEndpoint( pSetting0, TEST_INTERRUPT_ENDPOINT, USB_TRANSFER_TYPE_INTERRUPT, 8, 1 );
+    pInterface0->interface          = 0;
+    pInterface0->pInterfaceSettings = pSetting0;
+    pInterface0->pCurrentSetting    = pSetting0;
+
+    // Interface 1: isochronous alternate settings
+    pAlt0->interfaceAltSetting = 0;
+    pAlt1->interfaceAltSetting = 1;
+    pAlt2->interfaceAltSetting = 2;
+    TestEndpoint( pAlt1, 0x06, USB_TRANSFER_TYPE_ISOCHRONOUS, 192, 1 );
+    TestEndpoint( pAlt2, 0x06, USB_TRANSFER_TYPE_ISOCHRONOUS, 1023, 1 );
+    TestEndpoint( pAlt2, 0x87, USB_TRANSFER_TYPE_ISOCHRONOUS, 1023, 1 );
+    pAlt0->next = pAlt1;
+    pAlt1->next = pAlt2;
+    pInterface1->interface          = 1;
+    pInterface1->pInterfaceSettings = pAlt0;
+    pInterface1->pCurrentSetting    = pAlt0;
+
+    pInterface0->next           = pInterface1;
+    usbDeviceInfo.pInterfaceList = pInterface0;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Test
+// *****************************************************************************
+// *****************************************************************************
+
+int main( void )
+{
+    DWORD   frame;
+    BYTE    i;
+    BYTE    result;
+    int     failed = 0;
+
+    TestAttachDevice();
+
+    printf( "periodic bandwidth, alt 0: %u byte times\n",
+            _USB_PeriodicByteTimes( usbDeviceInfo.pInterfaceList, NULL, NULL ) );
+
+    result = USBHostIssueDeviceRequest( TEST_DEVICE_ADDRESS, USB_SETUP_HOST_TO_DEVICE | USB_SETUP_TYPE_STANDARD | USB_SETUP_RECIPIENT_INTERFACE,
+            USB_REQUEST_SET_INTERFACE, 2, 1, 0, NULL, USB_DEVICE_REQUEST_SET, 0 );
+    printf( "%s: SET INTERFACE alt 2 returned 0x%02X\n", (result == USB_ERROR_INSUFFICIENT_BANDWIDTH) ? "pass" : "FAIL", result );
+    if (result != USB_ERROR_INSUFFICIENT_BANDWIDTH)
+    {
+        failed++;
+    }
+
+    result = USBHostIssueDeviceRequest( TEST_DEVICE_ADDRESS, USB_SETUP_HOST_TO_DEVICE | USB_SETUP_TYPE_STANDARD | USB_SETUP_RECIPIENT_INTERFACE,
+            USB_REQUEST_SET_INTERFACE, 1, 1, 0, NULL, USB_DEVICE_REQUEST_SET, 0 );
+    printf( "%s: SET INTERFACE alt 1 returned 0x%02X\n", (result == USB_SUCCESS) ? "pass" : "FAIL", result );
+    if (result != USB_SUCCESS)
+    {
+        return 1;
+    }
+
+    for (frame = 0; frame < TEST_FRAMES; frame++)
+    {
+        // Keep every endpoint busy.  The bulk OUT endpoint alternates
+        // between long and short transfers.
+        for (i = 0; i < TEST_BULK_ENDPOINTS; i++)
+        {
+            if (pBulkEndpoint[i]->status.bfTransferComplete)
+            {
+                if (pBulkEndpoint[i]->bEndpointAddress & 0x80)
+                {
+                    result = USBHostRead( TEST_DEVICE_ADDRESS, pBulkEndpoint[i]->bEndpointAddress, bulkBuffer[i], TEST_BULK_BUFFER_SIZE );
+                }
+                else
+                {
+                    result = USBHostWrite( TEST_DEVICE_ADDRESS, pBulkEndpoint[i]->bEndpointAddress, bulkBuffer[i],
+                            (frame & 1) ? 100 : TEST_BULK_BUFFER_SIZE );
+                }
+                if (result != USB_SUCCESS)
+                {
+                    printf( "FAIL: bulk endpoint 0x%02X did not restart, 0x%02X\n", pBulkEndpoint[i]->bEndpointAddress, result );
+                    return 1;
+                }
+            }
+        }
+        if (pInterruptEndpoint->status.bfTransferComplete)
+        {
+            USBHostRead( TEST_DEVICE_ADDRESS, TEST_INTERRUPT_ENDPOINT, interruptBuffer, sizeof(interruptBuffer) );
+        }
+
+        TestFrame();
+
+        if ((frame == 5) && !usbDeviceInfo.pEndpoint0->status.bfTransferComplete)
+        {
+            printf( "FAIL: SET INTERFACE did not complete\n" );
+            return 1;
+        }
+    }
+
+    printf( "periodic bandwidth, alt 1: %u byte times\n",
+            _USB_PeriodicByteTimes( usbDeviceInfo.pInterfaceList, NULL, NULL ) );
+    printf( "%u frames: bulk packets %lu %lu %lu, interrupt packets %lu, NAKs %lu\n", TEST_FRAMES,
+            (unsigned long)bulkPackets[0], (unsigned long)bulkPackets[1], (unsigned long)bulkPackets[2],
+            (unsigned long)interruptPackets, (unsigned long)naks );
+
+    printf( "%s: %lu tokens held past the end of a frame\n", (heldTokens == 0) ? "pass" : "FAIL", (unsigned long)heldTokens );
+    if (heldTokens != 0)
+    {
+        failed++;
+    }
+
+    printf( "%s: interrupt IN serviced in %lu of %u frames, at most %u byte times into the frame\n",
+            ((interruptPackets == TEST_FRAMES) && (interruptMaxOffset == 0)) ? "pass" : "FAIL",
+            (unsigned long)interruptPackets, TEST_FRAMES, interruptMaxOffset );
+    if ((interruptPackets != TEST_FRAMES) || (interruptMaxOffset != 0))
+    {
+        failed++;
+    }
+
+    for (i = 0; i < TEST_BULK_ENDPOINTS; i++)
+    {
+        if (bulkPackets[i] == 0)
+        {
+            printf( "FAIL: bulk endpoint 0x%02X moved no data\n", pBulkEndpoint[i]->bEndpointAddress );
+            failed++;
+        }
+    }
+
+    return failed;
+}
+
+//DOM-IGNORE-END
@@ -0,0 +1,33 @@
+/******************************************************************************
+ File Name:       usb_config.h
+ Processor:       Host (Linux, Windows)
+ Compiler:        GCC
+
+ USB host configuration of UsbHostSchedulerTest.c: one device with control,
+ bulk, interrupt and isochronous endpoints, and transfer events so that the
+ interrupt handler completes the transfers.
+******************************************************************************/
+#ifndef _USB_CONFIG_H
+#define _USB_CONFIG_H
+
+#define USB_SUPPORT_HOST
+
+#define USB_PING_PONG_MODE                  USB_PING_PONG__FULL_PING_PONG
+#define USB_INITIAL_VBUS_CURRENT            50
+#define USB_NUM_ENUMERATION_TRIES           3
+#define NUM_TPL_ENTRIES                     1
+#define NUM_CLIENT_DRIVER_ENTRIES           1
+
+#define USB_SUPPORT_INTERRUPT_TRANSFERS
+#define USB_SUPPORT_BULK_TRANSFERS
+#define USB_SUPPORT_ISOCHRONOUS_TRANSFERS
+#define USB_NUM_CONTROL_NAKS                20
+#define USB_NUM_INTERRUPT_NAKS              3
+#define USB_NUM_BULK_NAKS                   10000
+
+#define USB_ENABLE_TRANSFER_EVENT
+#define USB_EVENT_QUEUE_DEPTH               16
+
+#define USB_HOST_APP_EVENT_HANDLER          USB_ApplicationEventHandler
+
+#endif
@@ -0,0 +1,251 @@
+/********************************************************************
+* FileName:		ClockSyncTest.c
+* Dependencies: ClockSync.c
+* Processor:	Host (Linux, Windows)
+* Complier:     GCC
+* Company:		Microchip Technology, Inc.
+*
+* Copyright and Disclaimer Notice
+*
+* Copyright  2007-2010 Microchip Technology Inc.  All rights reserved.
+*
+* Microchip licenses to you the right to use, modify, copy and distribute 
+* Software only when embedded on a Microchip microcontroller or digital 
+* signal controller and used with a Microchip radio frequency transceiver, 
+* which are integrated into your product or third party product (pursuant 
+* to the terms in the accompanying license agreement).  
+*
+* You should refer to the license agreement accompanying this Software for 
+* additional information regarding your rights and obligations.
+*
+* SOFTWARE AND DOCUMENTATION ARE PROVIDED AS IS WITHOUT WARRANTY OF ANY 
+* KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION, ANY 
+* WARRANTY OF MERCHANTABILITY, TITLE, NON-INFRINGEMENT AND FITNESS FOR A 
+* PARTICULAR PURPOSE. IN NO EVENT SHALL MICROCHIP OR ITS LICENSORS BE 
+* LIABLE OR OBLIGATED UNDER CONTRACT, NEGLIGENCE, STRICT LIABILITY, 
+* CONTRIBUTION, BREACH OF WARRANTY, OR OTHER LEGAL EQUITABLE THEORY ANY 
+* DIRECT OR INDIRECT DAMAGES OR EXPENSES INCLUDING BUT NOT LIMITED TO 
+* ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE OR CONSEQUENTIAL DAMAGES, 
+* LOST PROFITS OR LOST DATA, COST OF PROCUREMENT OF SUBSTITUTE GOODS, 
+* TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES (INCLUDING BUT 
+* NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+*
+*********************************************************************
+* File Description:
+*
+*   Self test of the clock synchronization service.  A master and a
+*   slave, each with its own free running timer, exchange SYNC and
+*   FOLLOW_UP messages over a simulated channel.  The test checks that
+*   the slave locks and follows the master with timer frequency drift,
+*   32-bit timer rollover, and receive timestamp jitter.
+*
+*   The test does not use the radio.  Host Tests/run_tests.sh builds it
+*   with ClockSync.c and the SystemProfile.h of this directory.
+*
+* Change History:
+*  Rev   Date         Description
+*  4.2   10/18/2026   Initial revision
+********************************************************************/
+
+/************************ HEADERS **********************************/
+#include <stdio.h>
+#include "SystemProfile.h"
+#include "GenericTypeDefs.h"
+#include "WirelessProtocols/ClockSync.h"
+
+/************************ DEFINITIONS ******************************/
+
+// Timer frequencies of the two nodes.  The slave timer does not divide
+// a nanosecond evenly, so the fraction of the clocks is exercised.
+#define MASTER_TICK_HZ      40000000ul
+#define SLAVE_TICK_HZ       16000000ul
+
+#define NS_PER_SECOND       1000000000ull
+
+// Samples before the slave must be locked and within the error bound
+#define SETTLE_SAMPLES      40
+
+// Error bound without jitter, in nanoseconds.  It covers the timer
+// resolution of both nodes.
+#define BASE_ERROR_BOUND    200
+
+typedef struct _CLOCK_SYNC_TEST_CASE
+{
+    LONG    ppm;            // Slave timer frequency error, in ppm
+    LONG    jitter;         // Largest receive timestamp error, in nanoseconds
+    DWORD   masterTick0;    // Master timer value at time 0
+    DWORD   slaveTick0;     // Slave timer value at time 0
+    WORD    samples;        // One sample per second
+} CLOCK_SYNC_TEST_CASE;
+
+static const CLOCK_SYNC_TEST_CASE testCases[] =
+{
+    // drift
+    {  100,    0, 0x12345678ul, 0x9ABCDEF0ul,  60 },
+    { -250,    0, 0x00000000ul, 0x7FFFFFFFul,  60 },
+    // both timers roll over several times
+    {   50,    0, 0xFFFFFF00ul, 0xFFF00000ul, 600 },
+    // jitter
+    {  -30, 2000, 0x0BADF00Dul, 0xFEEDC0DEul, 300 },
+    {  400, 5000, 0xFFFF0000ul, 0x00010000ul, 300 }
+};
+
+#define TEST_CASES          (sizeof(testCases) / sizeof(testCases[0]))
+
+/************************ VARIABLES ********************************/
+
+static DWORD jitterSeed;
+
+/************************ FUNCTIONS ********************************/
+
+/*********************************************************************
+* Function:         static DWORD MasterTick(const CLOCK_SYNC_TEST_CASE *test, QWORD t)
+*
+* Overview:		    Returns the master timer value, in ticks of
+*                   MASTER_TICK_HZ, at true time t in nanoseconds.
+********************************************************************/
+static DWORD MasterTick(const CLOCK_SYNC_TEST_CASE *test, QWORD t)
+{
+    return test->masterTick0 + (DWORD)(t / (NS_PER_SECOND / MASTER_TICK_HZ));
+}
+
+/*********************************************************************
+* Function:         static DWORD SlaveTick(const CLOCK_SYNC_TEST_CASE *test, QWORD t)
+*
+* Overview:		    Returns the slave timer value, in ticks of
+*                   SLAVE_TICK_HZ, at true time t in nanoseconds.  The
+*                   timer runs test->ppm fast.
+********************************************************************/
+static DWORD SlaveTick(const CLOCK_SYNC_TEST_CASE *test, QWORD t)
+{
+    LONGLONG ticks = (LONGLONG)(t * (SLAVE_TICK_HZ / 1000) / (NS_PER_SECOND / 1000));
+
+    ticks += ticks * test->ppm / 1000000;
+    return test->slaveTick0 + (DWORD)ticks;
+}
+
+/*********************************************************************
+* Function:         static LONG Jitter(LONG range)
+*
+* Overview:		    Returns a pseudo random value from -range to range.
+********************************************************************/
+static LONG Jitter(LONG range)
+{
+    if( range == 0 )
+    {
+        return 0;
+    }
+    jitterSeed = jitterSeed * 1103515245ul + 12345;
+    return (LONG)((jitterSeed >> 8) % (DWORD)(2 * range + 1)) - range;
+}
+
+/*********************************************************************
+* Function:         static BOOL ClockSyncTestRun(const CLOCK_SYNC_TEST_CASE *test,
+*                                                LONG *maxError)
+*
+* PreCondition:     None
+*
+* Input:		    test - the case to run
+*                   maxError - returns the largest error after the
+*                              slave settled, in nanoseconds
+*
+* Output:		    BOOL - TRUE if the slave locked and stayed within
+*                          the error bound
+*
+* Side Effects:	    none
+*
+* Overview:		    Sends one SYNC and FOLLOW_UP pair per second.  The
+*                   clocks are updated three times per second, and the
+*                   slave time is compared with the master time a
+*                   quarter second after each sample.
+*
+* Note:			    None
+********************************************************************/
+static BOOL ClockSyncTestRun(const CLOCK_SYNC_TEST_CASE *test, LONG *maxError)
+{
+    CLOCK_SYNC master;
+    CLOCK_SYNC slave;
+    BYTE buffer[CLOCK_SYNC_FOLLOW_UP_SIZE];
+    QWORD t;
+    QWORD txTime;
+    LONGLONG error;
+    LONG bound;
+    WORD k;
+    BOOL pass = TRUE;
+
+    jitterSeed = 1;
+    bound = BASE_ERROR_BOUND + test->jitter;
+    *maxError = 0;
+
+    ClockSyncInit(&master, MASTER_TICK_HZ, MasterTick(test, 0));
+    ClockSyncInit(&slave, SLAVE_TICK_HZ, SlaveTick(test, 0));
+
+    for(k = 1; k <= test->samples; k++)
+    {
+        t = k * NS_PER_SECOND;
+
+        ClockSyncClockUpdate(&master.clock, MasterTick(test, t - NS_PER_SECOND / 3));
+        ClockSyncClockUpdate(&slave.clock, SlaveTick(test, t - NS_PER_SECOND / 3));
+
+        // SYNC, received with a timestamp error, then FOLLOW_UP
+        txTime = ClockSyncToMaster(&master, ClockSyncClockTime(&master.clock, MasterTick(test, t)));
+        ClockSyncReceive(&slave, buffer, ClockSyncBuildSync(&master, buffer),
+            ClockSyncClockTime(&slave.clock, SlaveTick(test, t + Jitter(test->jitter))));
+        ClockSyncReceive(&slave, buffer, ClockSyncBuildFollowUp(&master, txTime, buffer), 0);
+
+        t += NS_PER_SECOND / 4;
+        ClockSyncClockUpdate(&master.clock, MasterTick(test, t));
+        ClockSyncClockUpdate(&slave.clock, SlaveTick(test, t));
+        ClockSyncClockUpdate(&master.clock, MasterTick(test, t + NS_PER_SECOND / 3));
+        ClockSyncClockUpdate(&slave.clock, SlaveTick(test, t + NS_PER_SECOND / 3));
+
+        if( k < SETTLE_SAMPLES )
+        {
+            continue;
+        }
+
+        error = (LONGLONG)(ClockSyncToMaster(&slave, ClockSyncClockTime(&slave.clock, SlaveTick(test, t))) -
+                           ClockSyncToMaster(&master, ClockSyncClockTime(&master.clock, MasterTick(test, t))));
+        if( error < 0 )
+        {
+            error = -error;
+        }
+        if( error > *maxError )
+        {
+            *maxError = (error > 0x7FFFFFFF) ? 0x7FFFFFFF : (LONG)error;
+        }
+        if( (error > bound) || !ClockSyncIsLocked(&slave) )
+        {
+            pass = FALSE;
+        }
+    }
+
+    return pass;
+}
+
+/*********************************************************************
+* Function:         int main(void)
+*
+* Overview:		    Runs the drift, rollover and jitter cases and prints
+*                   the result of each.  Returns the number of failed
+*                   cases.
+********************************************************************/
+int main(void)
+{
+    LONG maxError;
+    BYTE i;
+    BOOL pass;
+    int failed = 0;
+
+    for(i = 0; i < TEST_CASES; i++)
+    {
+        pass = ClockSyncTestRun(&testCases[i], &maxError);
+        printf("%s: %ld ppm, %ld ns jitter, %u s, max error %ld ns\n", pass ? "pass" : "FAIL",
+            (long)testCases[i].ppm, (long)testCases[i].jitter, testCases[i].samples, (long)maxError);
+        if( !pass )
+        {
+            failed++;
+        }
+    }
+    return failed;
+}
@@ -0,0 +1,14 @@
+/********************************************************************
+* FileName:		SystemProfile.h
+* Processor:	Host (Linux, Windows)
+* Complier:     GCC
+*
+* Configuration of ClockSyncTest.c, which builds only the clock
+* synchronization service, without a radio or a protocol stack.
+********************************************************************/
+#ifndef _SYSTEM_PROFILE_H_
+#define _SYSTEM_PROFILE_H_
+
+#define ENABLE_CLOCK_SYNC
+
+#endif
@@ -0,0 +1,78 @@
+#!/bin/sh
+#
+# Builds and runs the host tests of the Microchip libraries.
+#
+# Usage:  sh run_tests.sh [output directory]
+#
+# Every test is a program with a main() that prints one "pass" or "FAIL"
+# line per check and returns the number of failed checks.  It is built
+# from its own directory, which holds its configuration headers, and from
+# the library sources listed below.  The libraries are compiled as PIC32
+# code (-D__PIC32MX__ -D__C32__), with the device and peripheral library headers
+# replaced by the stubs in Include.  Warnings are turned off because the
+# library sources are written for 16 and 32-bit targets.
+#
+# The programs are built and run in the output directory, /tmp/mla_host_tests
+# by default, so files written by a test end up there.  The script returns
+# the number of tests that failed to build or failed a check.  Set CC and
+# CFLAGS to use another compiler or other options.
+
+TESTS=$(cd "$(dirname "$0")" && pwd)
+MCHP=$(dirname "$TESTS")
+OUT=${1:-/tmp/mla_host_tests}
+CC=${CC:-gcc}
+CFLAGS=${CFLAGS:--O2 -w}
+
+FAILED=0
+
+mkdir -p "$OUT" || exit 1
+
+# run_test <program> <test directory> <compiler arguments>
+run_test()
+{
+    PROGRAM=$1
+    DIR=$2
+    shift 2
+
+    echo "=== $PROGRAM"
+    if ! $CC $CFLAGS -D__PIC32MX__ -D__C32__ -I"$TESTS/$DIR" -I"$TESTS/Include" -I"$MCHP/Include" "$@" -o "$OUT/$PROGRAM"
+    then
+        echo "FAIL: $PROGRAM does not build"
+        FAILED=$((FAILED + 1))
+    elif ! (cd "$OUT" && "./$PROGRAM")
+    then
+        FAILED=$((FAILED + 1))
+    fi
+}
+
+run_test HostFrameBufferTest "Graphics" \
+    "$TESTS/Graphics/HostFrameBufferTest.c" \
+    "$MCHP/Graphics/Drivers/HostFrameBuffer.c" \
+    "$MCHP/Graphics/Primitive.c" \
+    "$MCHP/Graphics/GOLFontDefault.c"
+
+run_test GifDecoderTest "Image Decoders" \
+    "$TESTS/Image Decoders/GifDecoderTest.c" \
+    "$MCHP/Image Decoders/ImageDecoder.c" \
+    "$MCHP/Image Decoders/GifDecoder.c"
+
+run_test GifDecoderTestFlat "Image Decoders" \
+    -DGIF_USE_FLAT_SYMBOL_TABLE=1 \
+    "$TESTS/Image Decoders/GifDecoderTest.c" \
+    "$MCHP/Image Decoders/ImageDecoder.c" \
+    "$MCHP/Image Decoders/GifDecoder.c"
+
+run_test AudioStreamTest "USB Device" \
+    "$TESTS/USB Device/AudioStreamTest.c" \
+    "$MCHP/USB/Audio Device Driver/usb_function_audio_stream.c"
+
+run_test UsbHostSchedulerTest "USB Host" \
+    -I"$MCHP/USB" \
+    "$TESTS/USB Host/UsbHostSchedulerTest.c"
+
+run_test ClockSyncTest "WirelessProtocols" \
+    "$TESTS/WirelessProtocols/ClockSyncTest.c" \
+    "$MCHP/WirelessProtocols/ClockSync.c"
+
+echo "=== $FAILED test(s) failed"
+exit $FAILED
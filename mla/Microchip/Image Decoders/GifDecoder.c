@@ -70,7 +70,12 @@ typedef struct _GIFDECODER
         /* For decoding */
         BYTE abSymbol[4096];
 
-        #if GIF_CRUSH_PREV_SYMBOL_PTR_TABLE == 0        
+        #if GIF_USE_FLAT_SYMBOL_TABLE == 1
+        BYTE abFirstSymbol[4096];                   /* First symbol of the string of each code */
+        WORD awPrevSymbolPtr[4096];
+        WORD awSymbolLength[4096];                  /* Length of the string of each code */
+        BYTE abScanline[GIF_SCANLINE_BUFFER_SIZE + 4096]; /* Palette indices of the row being decoded and of the string which runs past it */
+        #elif GIF_CRUSH_PREV_SYMBOL_PTR_TABLE == 0
         WORD awPrevSymbolPtr[4096];
         #else
         WORD awPrevSymbolPtr[(4096 * 3)/4];
@@ -87,6 +92,24 @@ typedef struct _GIFDECODER
         BYTE bRemainingBits;
         WORD wCurrentX;
         WORD wCurrentY;
+        #ifdef IMG_SUPPORT_GIF_ANIMATION
+        /* Graphic control extension of the current frame */
+        WORD wDelayTime;                            /* In 1/100 of a second */
+        BYTE bDisposalMethod;
+        BYTE bTransparentIndex;
+        BYTE blTransparentFlag : 1;
+        /* Animation */
+        BYTE blSavedBackgroundFlag : 1;             /* Pixels under the frame are in GIF_awSaveBuffer */
+        BYTE blLoopExtensionFlag : 1;               /* NETSCAPE2.0 loop count has been read */
+        BYTE blInfiniteLoopFlag : 1;
+        BYTE bPrevDisposalMethod;
+        WORD wPrevX;
+        WORD wPrevY;
+        WORD wPrevWidth;
+        WORD wPrevHeight;
+        WORD wRemainingLoops;
+        LONG lFirstFramePos;
+        #endif
 } GIFDECODER;
 
 
@@ -95,6 +118,20 @@ typedef struct _GIFDECODER
 /**************************/
 static const WORD GIF_awMask[] = { 0x000, 0x001, 0x003, 0x007, 0x00F, 0x01F, 0x03F, 0x07F, 0x0FF, 0x1FF, 0x3FF, 0x7FF, 0xFFF };
 
+#ifdef IMG_SUPPORT_GIF_ANIMATION
+/**************************/
+/**** ANIMATION STATE  ****/
+/**************************/
+static GIFDECODER GIF_AnimDec;                 /* Kept between the frames of the animation */
+static BYTE GIF_blAnimationActive;
+static QWORD GIF_qwNextFrameTicks;
+
+#if defined(IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT) && (GIF_ANIMATION_SAVE_BUFFER_SIZE > 0)
+    #define GIF_SUPPORT_RESTORE_TO_PREVIOUS
+    static WORD GIF_awSaveBuffer[GIF_ANIMATION_SAVE_BUFFER_SIZE];
+#endif
+#endif
+
 /**************************/
 /******* FUNCTIONS  *******/
 /**************************/
@@ -139,6 +176,22 @@ static void GIF_vResetData(GIFDECODER *pGifDec)
     pGifDec->wCurrentX = 0;
     pGifDec->wCurrentY = 0;
     pGifDec->lGlobalColorTablePos = 0;
+  #ifdef IMG_SUPPORT_GIF_ANIMATION
+    pGifDec->wDelayTime = 0;
+    pGifDec->bDisposalMethod = 0;
+    pGifDec->bTransparentIndex = 0;
+    pGifDec->blTransparentFlag = 0;
+    pGifDec->blSavedBackgroundFlag = 0;
+    pGifDec->blLoopExtensionFlag = 0;
+    pGifDec->blInfiniteLoopFlag = 0;
+    pGifDec->bPrevDisposalMethod = 0;
+    pGifDec->wPrevX = 0;
+    pGifDec->wPrevY = 0;
+    pGifDec->wPrevWidth = 0;
+    pGifDec->wPrevHeight = 0;
+    pGifDec->wRemainingLoops = 0;
+    pGifDec->lFirstFramePos = 0;
+  #endif
 }
 
 /*******************************************************************************
@@ -154,7 +207,7 @@ Output:         None
 *******************************************************************************/
 static void GIF_vPutPrevCode(GIFDECODER *pGifDec, WORD wAddress, WORD wCode)
 {
-    #if GIF_CRUSH_PREV_SYMBOL_PTR_TABLE == 0        
+    #if GIF_CRUSH_PREV_SYMBOL_PTR_TABLE == 0 || GIF_USE_FLAT_SYMBOL_TABLE == 1
         pGifDec->awPrevSymbolPtr[wAddress] = wCode;
     #else
         WORD wCrushedAddress = (wAddress * 3) / 4;
@@ -199,7 +252,7 @@ Output:         Data(Code)
 static WORD GIF_wGetPrevCode(GIFDECODER *pGifDec, WORD wAddress)
 {
         WORD wCode;
-    #if GIF_CRUSH_PREV_SYMBOL_PTR_TABLE == 0        
+    #if GIF_CRUSH_PREV_SYMBOL_PTR_TABLE == 0 || GIF_USE_FLAT_SYMBOL_TABLE == 1
         wCode = pGifDec->awPrevSymbolPtr[wAddress];
     #else
         WORD wCrushedAddress = (wAddress * 3) / 4;
@@ -245,6 +298,10 @@ static void GIF_vInitializeTable(GIFDECODER *pGifDec)
         {
                  pGifDec->abSymbol[wCounter] = wCounter;
                  GIF_vPutPrevCode(pGifDec, wCounter, pGifDec->wInitialSymbols);
+                 #if GIF_USE_FLAT_SYMBOL_TABLE == 1
+                 pGifDec->abFirstSymbol[wCounter] = wCounter;
+                 pGifDec->awSymbolLength[wCounter] = 1;
+                 #endif
         }
 }
 
@@ -326,6 +383,78 @@ static BYTE GIF_bReadHeader(GIFDECODER *pGifDec)
         return(0);
 }
 
+#ifdef IMG_SUPPORT_GIF_ANIMATION
+/*******************************************************************************
+Function:       void GIF_vReadGraphicControlExtension(GIFDECODER *pGifDec)
+
+Precondition:   File pointer must be pointing to the data of a graphic control
+                extension block
+
+Overview:       This function reads the delay, disposal method and transparent
+                color of the next frame
+
+Input:          GIF decoder's data structure
+
+Output:         None
+*******************************************************************************/
+static void GIF_vReadGraphicControlExtension(GIFDECODER *pGifDec)
+{
+       BYTE bFlags;
+
+       IMG_FREAD(&bFlags, sizeof(BYTE), 1, pGifDec->pImageFile);  /* Packed fields */
+       IMG_FREAD(&pGifDec->wDelayTime, sizeof(WORD), 1, pGifDec->pImageFile);
+       IMG_FREAD(&pGifDec->bTransparentIndex, sizeof(BYTE), 1, pGifDec->pImageFile);
+       pGifDec->bDisposalMethod = (bFlags >> 2) & 0x07;
+       pGifDec->blTransparentFlag = (bFlags & 0x01)? 1: 0;
+}
+
+/*******************************************************************************
+Function:       void GIF_vReadApplicationExtension(GIFDECODER *pGifDec)
+
+Precondition:   File pointer must be pointing to the 11 byte application
+                identifier
+
+Overview:       This function reads the loop count of the NETSCAPE2.0
+                application extension. Other extensions are skipped.
+
+Input:          GIF decoder's data structure
+
+Output:         None
+*******************************************************************************/
+static void GIF_vReadApplicationExtension(GIFDECODER *pGifDec)
+{
+       static const BYTE abNetscape[11] = { 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0' };
+       BYTE abIdentifier[11];
+       BYTE abData[3];
+       BYTE bBlockSize;
+       BYTE bCounter;
+
+       IMG_FREAD(abIdentifier, sizeof(BYTE), 11, pGifDec->pImageFile);
+       IMG_FREAD(&bBlockSize, sizeof(BYTE), 1, pGifDec->pImageFile);
+       for(bCounter = 0; bCounter < 11; bCounter++)
+       {
+            if(abIdentifier[bCounter] != abNetscape[bCounter])
+            {
+                 break;
+            }
+       }
+       if(bCounter == 11 && bBlockSize == 3)
+       {
+            IMG_FREAD(abData, sizeof(BYTE), 3, pGifDec->pImageFile);
+            if(pGifDec->blLoopExtensionFlag == 0) /* Read once, the extension is seen again on every loop */
+            {
+                 pGifDec->blLoopExtensionFlag = 1;
+                 pGifDec->wRemainingLoops = abData[1] | ((WORD)abData[2] << 8);
+                 pGifDec->blInfiniteLoopFlag = (pGifDec->wRemainingLoops == 0)? 1: 0;
+            }
+       }
+       else
+       {
+            IMG_FSEEK(pGifDec->pImageFile, bBlockSize, 1);
+       }
+}
+#endif
+
 /*******************************************************************************
 Function:       BYTE GIF_bReadNextImageDescriptor(GIFDECODER *pGifDec)
 
@@ -343,6 +472,11 @@ static BYTE GIF_bReadNextImageDescriptor(GIFDECODER *pGifDec)
        BYTE bSection, bSectionDetails, bBlockSize, bTemp;
        BYTE bFlags;
        BYTE bCounter;
+    #ifdef IMG_SUPPORT_GIF_ANIMATION
+       pGifDec->wDelayTime = 0;  /* A graphic control extension applies to one image only */
+       pGifDec->bDisposalMethod = 0;
+       pGifDec->blTransparentFlag = 0;
+    #endif
        do
        {
             IMG_FREAD(&bSection, sizeof(BYTE), 1, pGifDec->pImageFile);
@@ -352,10 +486,24 @@ static BYTE GIF_bReadNextImageDescriptor(GIFDECODER *pGifDec)
                         switch(bSectionDetails)
                         {
 /* GRAPHICS EXTENSION */           case 0xF9: IMG_FREAD(&bBlockSize, sizeof(BYTE), 1, pGifDec->pImageFile);
+                                          #ifdef IMG_SUPPORT_GIF_ANIMATION
+                                              if(bBlockSize == 4)
+                                              {
+                                                    GIF_vReadGraphicControlExtension(pGifDec);
+                                                    break;
+                                              }
+                                          #endif
                                               IMG_FSEEK(pGifDec->pImageFile, bBlockSize, 1);
                                               break;
 /* PLAIN TEXT EXTENSION */         case 0x01:
 /* APPLICATION EXTENSION */        case 0xFF: IMG_FREAD(&bBlockSize, sizeof(BYTE), 1, pGifDec->pImageFile);
+                                          #ifdef IMG_SUPPORT_GIF_ANIMATION
+                                              if(bSectionDetails == 0xFF && bBlockSize == 11)
+                                              {
+                                                    GIF_vReadApplicationExtension(pGifDec);
+                                                    break;
+                                              }
+                                          #endif
                                               IMG_FSEEK(pGifDec->pImageFile, bBlockSize, 1);
 /* COMMENT EXTENSION */            case 0xFE: IMG_FREAD(&bBlockSize, sizeof(BYTE), 1, pGifDec->pImageFile);
                                               for(bCounter = 0; bCounter < bBlockSize; bCounter++)
@@ -372,6 +520,10 @@ static BYTE GIF_bReadNextImageDescriptor(GIFDECODER *pGifDec)
                                    return(100);
                         }
             }
+            else if(bSection == 0x3B) /* End of GIF stream */
+            {
+                 return 0x3B;
+            }
             else if(bSection != 0x2C)
             {
                  return(100);
@@ -389,6 +541,8 @@ static BYTE GIF_bReadNextImageDescriptor(GIFDECODER *pGifDec)
        IMG_FREAD(&pGifDec->wImageWidth, sizeof(WORD), 1, pGifDec->pImageFile);
        IMG_FREAD(&pGifDec->wImageHeight, sizeof(WORD), 1, pGifDec->pImageFile);
        IMG_FREAD(&bFlags, sizeof(BYTE), 1, pGifDec->pImageFile);  /* Packed fields */
+       pGifDec->blInterlacedFlag = 0;
+       pGifDec->blLocalColorTableFlag = 0;
        if(bFlags & 0x40)
        {
             pGifDec->blInterlacedFlag = 1;
@@ -491,28 +645,19 @@ static WORD GIF_wGetNextSymbol(GIFDECODER *pGifDec)
 }
 
 /*******************************************************************************
-Function:       void GIF_vPaintData(GIFDECODER *pGifDec, BYTE bData)
+Function:       void GIF_vNextRow(GIFDECODER *pGifDec)
 
 Precondition:   pGifDec->blInterlacedFlag must be properly set
 
-Overview:       This function puts the actual pixel on the display. It also
-                takes care of the interlaced pixel arrangement.
+Overview:       This function moves the current position to the start of the
+                next row. It takes care of the interlaced row arrangement.
 
-Input:          GIF decoder's data structure, palette index
+Input:          GIF decoder's data structure
 
 Output:         None
 *******************************************************************************/
-static void GIF_vPaintData(GIFDECODER *pGifDec, BYTE bData)
+static void GIF_vNextRow(GIFDECODER *pGifDec)
 {
-    #if GIF_USE_16_BITS_PER_PIXEL == 0
-        IMG_vSetColor(pGifDec->aPalette[bData][0], pGifDec->aPalette[bData][1], pGifDec->aPalette[bData][2]);
-    #else
-        IMG_vSetColor565(pGifDec->awPalette[bData]);
-    #endif
-       IMG_vPutPixel(pGifDec->wCurrentX, pGifDec->wCurrentY);
-       pGifDec->wCurrentX++;
-       if(pGifDec->wCurrentX >= pGifDec->wImageWidth)
-       {
                 IMG_vLoopCallback();
                 pGifDec->wCurrentX = pGifDec->wImageX;
                 if(pGifDec->blInterlacedFlag == 0)
@@ -548,6 +693,38 @@ static void GIF_vPaintData(GIFDECODER *pGifDec, BYTE bData)
                                        pGifDec->bInterlacePass++;
                              }
                 }
+}
+
+#if GIF_USE_FLAT_SYMBOL_TABLE == 0
+/*******************************************************************************
+Function:       void GIF_vPaintData(GIFDECODER *pGifDec, BYTE bData)
+
+Precondition:   pGifDec->blInterlacedFlag must be properly set
+
+Overview:       This function puts the actual pixel on the display. It also
+                takes care of the interlaced pixel arrangement.
+
+Input:          GIF decoder's data structure, palette index
+
+Output:         None
+*******************************************************************************/
+static void GIF_vPaintData(GIFDECODER *pGifDec, BYTE bData)
+{
+    #ifdef IMG_SUPPORT_GIF_ANIMATION
+       if(pGifDec->blTransparentFlag == 0 || bData != pGifDec->bTransparentIndex)
+    #endif
+       {
+    #if GIF_USE_16_BITS_PER_PIXEL == 0
+        IMG_vSetColor(pGifDec->aPalette[bData][0], pGifDec->aPalette[bData][1], pGifDec->aPalette[bData][2]);
+    #else
+        IMG_vSetColor565(pGifDec->awPalette[bData]);
+    #endif
+       IMG_vPutPixel(pGifDec->wCurrentX, pGifDec->wCurrentY);
+       }
+       pGifDec->wCurrentX++;
+       if(pGifDec->wCurrentX - pGifDec->wImageX >= pGifDec->wImageWidth)
+       {
+                GIF_vNextRow(pGifDec);
        }
 }
 
@@ -593,6 +770,139 @@ static BYTE GIF_bTraceFirstData(GIFDECODER *pGifDec, WORD wCode)
        return pGifDec->abSymbol[wCode];
 }
 
+#else /* GIF_USE_FLAT_SYMBOL_TABLE == 1 */
+
+/*******************************************************************************
+Function:       void GIF_vFlushScanline(GIFDECODER *pGifDec, BYTE *pbData)
+
+Precondition:   pbData must point to a complete row in pGifDec->abScanline
+
+Overview:       This function puts the buffered row on the display and moves
+                to the next row. IMG_vPutPixel() is still called for every
+                pixel, but the color is set only when the palette index
+                changes, so a run of the same index sets it once.
+
+Input:          GIF decoder's data structure, start of the row
+
+Output:         None
+*******************************************************************************/
+static void GIF_vFlushScanline(GIFDECODER *pGifDec, BYTE *pbData)
+{
+       WORD wCounter;
+       WORD wX = pGifDec->wImageX;
+       WORD wY = pGifDec->wCurrentY;
+       WORD wLastData = 0xFFFF;
+
+       if(wY - pGifDec->wImageY < pGifDec->wImageHeight)
+       {
+                for(wCounter = 0; wCounter < pGifDec->wImageWidth; wCounter++, wX++, pbData++)
+                {
+                     #ifdef IMG_SUPPORT_GIF_ANIMATION
+                         if(pGifDec->blTransparentFlag == 1 && *pbData == pGifDec->bTransparentIndex)
+                         {
+                                  continue;
+                         }
+                     #endif
+                         if(*pbData != wLastData)
+                         {
+                                  wLastData = *pbData;
+                             #if GIF_USE_16_BITS_PER_PIXEL == 0
+                                  IMG_vSetColor(pGifDec->aPalette[wLastData][0], pGifDec->aPalette[wLastData][1], pGifDec->aPalette[wLastData][2]);
+                             #else
+                                  IMG_vSetColor565(pGifDec->awPalette[wLastData]);
+                             #endif
+                         }
+                         IMG_vPutPixel(wX, wY);
+                }
+       }
+       GIF_vNextRow(pGifDec);
+}
+
+/*******************************************************************************
+Function:       void GIF_vDisplayCode(GIFDECODER *pGifDec, WORD wCode)
+
+Precondition:   Length of the code must be set in pGifDec->awSymbolLength
+
+Overview:       This function writes the string of the code into the scanline
+                buffer. The string is written backwards from its last symbol,
+                so no decoder stack is needed. A string which runs past the
+                end of the row is still expanded once, the complete rows are
+                then put on the display and the start of the next row is
+                carried over to the start of the buffer.
+
+Input:          GIF decoder's data structure, code
+
+Output:         None
+*******************************************************************************/
+static void GIF_vDisplayCode(GIFDECODER *pGifDec, WORD wCode)
+{
+       WORD wOffset = pGifDec->wCurrentX - pGifDec->wImageX;
+       WORD wCounter = pGifDec->awSymbolLength[wCode];
+       BYTE *pbDest = &pGifDec->abScanline[wOffset + wCounter];
+       BYTE *pbRow = pGifDec->abScanline;
+
+       wOffset += wCounter;
+       for(; wCounter > 0; wCounter--)
+       {
+                *--pbDest = pGifDec->abSymbol[wCode];
+                wCode = pGifDec->awPrevSymbolPtr[wCode];
+       }
+
+       while(wOffset >= pGifDec->wImageWidth)
+       {
+                GIF_vFlushScanline(pGifDec, pbRow);
+                pbRow += pGifDec->wImageWidth;
+                wOffset -= pGifDec->wImageWidth;
+       }
+
+       if(pbRow != pGifDec->abScanline)
+       {
+                pbDest = pGifDec->abScanline;
+                for(wCounter = wOffset; wCounter > 0; wCounter--)
+                {
+                         *pbDest++ = *pbRow++;
+                }
+       }
+       pGifDec->wCurrentX = pGifDec->wImageX + wOffset;
+}
+
+/*******************************************************************************
+Function:       BYTE GIF_bTraceFirstData(GIFDECODER *pGifDec, WORD wCode)
+
+Precondition:   None
+
+Overview:       This function gets the first symbol of the code
+
+Input:          GIF decoder's data structure, code
+
+Output:         First symbol of the code
+*******************************************************************************/
+static BYTE GIF_bTraceFirstData(GIFDECODER *pGifDec, WORD wCode)
+{
+       return pGifDec->abFirstSymbol[wCode];
+}
+
+/*******************************************************************************
+Function:       void GIF_vCompleteSymbol(GIFDECODER *pGifDec, WORD wCode)
+
+Precondition:   The previous code of wCode must already be set
+
+Overview:       This function fills the first symbol and the length of a
+                newly added code from its previous code
+
+Input:          GIF decoder's data structure, code
+
+Output:         None
+*******************************************************************************/
+static void GIF_vCompleteSymbol(GIFDECODER *pGifDec, WORD wCode)
+{
+       WORD wPrevCode = pGifDec->awPrevSymbolPtr[wCode];
+       pGifDec->abFirstSymbol[wCode] = pGifDec->abFirstSymbol[wPrevCode];
+       pGifDec->awSymbolLength[wCode] = pGifDec->awSymbolLength[wPrevCode] + 1;
+}
+
+#endif /* GIF_USE_FLAT_SYMBOL_TABLE */
+
 /*******************************************************************************
 Function:       GIF_vExecuteClearCode(GIFDECODER *pGifDec)
 
@@ -611,6 +921,188 @@ static void GIF_vExecuteClearCode(GIFDECODER *pGifDec)
        pGifDec->blFirstcodeFlag = 1;
 }
 
+#ifdef IMG_SUPPORT_GIF_ANIMATION
+#ifdef GIF_SUPPORT_RESTORE_TO_PREVIOUS
+/*******************************************************************************
+Function:       void GIF_vCopyBackground(GIFDECODER *pGifDec, BYTE blRestore)
+
+Precondition:   pGifDec->wPrevX, wPrevY, wPrevWidth and wPrevHeight must hold
+                the area of the frame
+
+Overview:       This function copies the displayed pixels under the frame to
+                GIF_awSaveBuffer, or back to the display if blRestore is 1.
+                Only the pixels which are visible after downscaling are
+                copied. If the area does not fit into the buffer,
+                pGifDec->blSavedBackgroundFlag stays 0.
+
+Input:          GIF decoder's data structure, Direction of the copy
+
+Output:         None
+*******************************************************************************/
+static void GIF_vCopyBackground(GIFDECODER *pGifDec, BYTE blRestore)
+{
+       WORD wStep = (IMG_bDownScalingFactor <= 1)? 1: IMG_bDownScalingFactor;
+       WORD wRight = pGifDec->wPrevX + pGifDec->wPrevWidth;
+       WORD wBottom = pGifDec->wPrevY + pGifDec->wPrevHeight;
+       WORD wLeft = ((pGifDec->wPrevX + wStep - 1) / wStep) * wStep;
+       WORD wTop = ((pGifDec->wPrevY + wStep - 1) / wStep) * wStep;
+       WORD *pwData = GIF_awSaveBuffer;
+       WORD wX, wY;
+
+       if(wRight > IMG_wImageWidth)
+       {
+                wRight = IMG_wImageWidth;
+       }
+       if(wBottom > IMG_wImageHeight)
+       {
+                wBottom = IMG_wImageHeight;
+       }
+       if(blRestore == 0)
+       {
+                pGifDec->blSavedBackgroundFlag = 0;
+                if((DWORD)((wRight - wLeft + wStep - 1) / wStep) * ((wBottom - wTop + wStep - 1) / wStep) > GIF_ANIMATION_SAVE_BUFFER_SIZE)
+                {
+                         return;
+                }
+       }
+
+       for(wY = wTop; wY < wBottom; wY += wStep)
+       {
+                for(wX = wLeft; wX < wRight; wX += wStep)
+                {
+                         if(blRestore == 0)
+                         {
+                                  *pwData++ = GetPixel(IMG_wStartX + (wX / wStep), IMG_wStartY + (wY / wStep));
+                         }
+                         else
+                         {
+                                  SetColor(*pwData++);
+                                  PutPixel(IMG_wStartX + (wX / wStep), IMG_wStartY + (wY / wStep));
+                         }
+                }
+       }
+       pGifDec->blSavedBackgroundFlag = (blRestore == 0)? 1: 0;
+}
+#endif
+
+/*******************************************************************************
+Function:       void GIF_vFillBackground(GIFDECODER *pGifDec)
+
+Precondition:   pGifDec->wPrevX, wPrevY, wPrevWidth and wPrevHeight must hold
+                the area of the frame
+
+Overview:       This function fills the area of the frame with the background
+                color (disposal method 2)
+
+Input:          GIF decoder's data structure
+
+Output:         None
+*******************************************************************************/
+static void GIF_vFillBackground(GIFDECODER *pGifDec)
+{
+       WORD wRight = pGifDec->wPrevX + pGifDec->wPrevWidth;
+       WORD wBottom = pGifDec->wPrevY + pGifDec->wPrevHeight;
+       WORD wX, wY;
+
+    #if GIF_USE_16_BITS_PER_PIXEL == 0
+       IMG_vSetColor(pGifDec->aPalette[pGifDec->bBgColorIndex][0], pGifDec->aPalette[pGifDec->bBgColorIndex][1], pGifDec->aPalette[pGifDec->bBgColorIndex][2]);
+    #else
+       IMG_vSetColor565(pGifDec->awPalette[pGifDec->bBgColorIndex]);
+    #endif
+
+    #ifdef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
+       if(IMG_bDownScalingFactor <= 1)
+       {
+                if(wRight > IMG_wImageWidth)
+                {
+                         wRight = IMG_wImageWidth;
+                }
+                if(wBottom > IMG_wImageHeight)
+                {
+                         wBottom = IMG_wImageHeight;
+                }
+                if(pGifDec->wPrevX < wRight && pGifDec->wPrevY < wBottom)
+                {
+                         while(!Bar(IMG_wStartX + pGifDec->wPrevX, IMG_wStartY + pGifDec->wPrevY,
+                                    IMG_wStartX + wRight - 1, IMG_wStartY + wBottom - 1));
+                }
+                return;
+       }
+    #endif
+
+       for(wY = pGifDec->wPrevY; wY < wBottom; wY++)
+       {
+                for(wX = pGifDec->wPrevX; wX < wRight; wX++)
+                {
+                         IMG_vPutPixel(wX, wY);
+                }
+       }
+}
+
+/*******************************************************************************
+Function:       void GIF_vStartFrame(GIFDECODER *pGifDec)
+
+Precondition:   The image descriptor of the frame must have been read
+
+Overview:       This function remembers the area and disposal method of the
+                frame about to be drawn, and saves the pixels under it when the
+                disposal method is 3 (restore to previous)
+
+Input:          GIF decoder's data structure
+
+Output:         None
+*******************************************************************************/
+static void GIF_vStartFrame(GIFDECODER *pGifDec)
+{
+       pGifDec->bPrevDisposalMethod = pGifDec->bDisposalMethod;
+       pGifDec->wPrevX = pGifDec->wImageX;
+       pGifDec->wPrevY = pGifDec->wImageY;
+       pGifDec->wPrevWidth = pGifDec->wImageWidth;
+       pGifDec->wPrevHeight = pGifDec->wImageHeight;
+       pGifDec->blSavedBackgroundFlag = 0;
+
+    #ifdef GIF_SUPPORT_RESTORE_TO_PREVIOUS
+       if(pGifDec->bDisposalMethod == 3)
+       {
+                GIF_vCopyBackground(pGifDec, 0);
+       }
+    #endif
+}
+
+/*******************************************************************************
+Function:       void GIF_vDisposeFrame(GIFDECODER *pGifDec)
+
+Precondition:   None
+
+Overview:       This function applies the disposal method of the previously
+                drawn frame. Only the area of that frame is touched.
+
+Input:          GIF decoder's data structure
+
+Output:         None
+*******************************************************************************/
+static void GIF_vDisposeFrame(GIFDECODER *pGifDec)
+{
+       if(pGifDec->wPrevWidth == 0)
+       {
+                return;
+       }
+    #ifdef GIF_SUPPORT_RESTORE_TO_PREVIOUS
+       if(pGifDec->bPrevDisposalMethod == 3 && pGifDec->blSavedBackgroundFlag == 1)
+       {
+                GIF_vCopyBackground(pGifDec, 1);
+       }
+       else
+    #endif
+       if(pGifDec->bPrevDisposalMethod == 2 || pGifDec->bPrevDisposalMethod == 3)
+       {
+                GIF_vFillBackground(pGifDec);
+       }
+       pGifDec->wPrevWidth = 0;
+       pGifDec->blSavedBackgroundFlag = 0;
+}
+#endif
+
 /*******************************************************************************
 Function:       BYTE GIF_bDecodeNextImage(GIFDECODER *pGifDec)
 
@@ -627,11 +1119,23 @@ static BYTE GIF_bDecodeNextImage(GIFDECODER *pGifDec)
 {
         BYTE bBlockTerminator;
         WORD wCode;
-        if(GIF_bReadNextImageDescriptor(pGifDec) != 0)
+        bBlockTerminator = GIF_bReadNextImageDescriptor(pGifDec);
+        if(bBlockTerminator == 0x3B) /* No more images */
+        {
+            return 0x3B;
+        }
+        if(bBlockTerminator != 0)
         {
             return(100);
         }
 
+    #if GIF_USE_FLAT_SYMBOL_TABLE == 1
+        if(pGifDec->wImageWidth == 0 || pGifDec->wImageWidth > GIF_SCANLINE_BUFFER_SIZE)
+        {
+            return(100);
+        }
+    #endif
+
         IMG_FREAD(&pGifDec->bMaxSymbolBits, sizeof(BYTE), 1, pGifDec->pImageFile);
         if(pGifDec->bMaxSymbolBits > 11)
         {
@@ -643,6 +1147,10 @@ static BYTE GIF_bDecodeNextImage(GIFDECODER *pGifDec)
         pGifDec->bInitialSymbolBits = pGifDec->bMaxSymbolBits;
         GIF_vInitializeTable(pGifDec);
 
+    #ifdef IMG_SUPPORT_GIF_ANIMATION
+        GIF_vStartFrame(pGifDec);
+    #endif
+
         /* Actual decoding starts here */
         while(!IMG_FEOF(pGifDec->pImageFile))
         {
@@ -668,6 +1176,9 @@ static BYTE GIF_bDecodeNextImage(GIFDECODER *pGifDec)
                          {
                                    pGifDec->wMaxSymbol++;
                                    pGifDec->abSymbol[pGifDec->wMaxSymbol] = GIF_bTraceFirstData(pGifDec, wCode);
+                                   #if GIF_USE_FLAT_SYMBOL_TABLE == 1
+                                   GIF_vCompleteSymbol(pGifDec, pGifDec->wMaxSymbol);
+                                   #endif
                          }
                          if(pGifDec->wMaxSymbol < 4095)
                          {
@@ -683,6 +1194,9 @@ static BYTE GIF_bDecodeNextImage(GIFDECODER *pGifDec)
                          }
                          pGifDec->wMaxSymbol++;
                          pGifDec->abSymbol[pGifDec->wMaxSymbol] = GIF_bTraceFirstData(pGifDec, GIF_wGetPrevCode(pGifDec, pGifDec->wMaxSymbol));
+                         #if GIF_USE_FLAT_SYMBOL_TABLE == 1
+                         GIF_vCompleteSymbol(pGifDec, pGifDec->wMaxSymbol);
+                         #endif
                          GIF_vDisplayCode(pGifDec, wCode);
                          if(pGifDec->wMaxSymbol < 4095)
                          {
@@ -709,6 +1223,11 @@ static BYTE GIF_bDecodeNextImage(GIFDECODER *pGifDec)
                          IMG_FSEEK(pGifDec->pImageFile, lFilePos, 0);
                 }
         }
+        if(pGifDec->bRemainingDataInBlock > 0) /* Skip the padding after the end code */
+        {
+                IMG_FSEEK(pGifDec->pImageFile, pGifDec->bRemainingDataInBlock, 1);
+                pGifDec->bRemainingDataInBlock = 0;
+        }
         IMG_FREAD(&bBlockTerminator, sizeof(BYTE), 1, pGifDec->pImageFile);
         if(bBlockTerminator == 0)
         {
@@ -723,12 +1242,127 @@ static BYTE GIF_bDecodeNextImage(GIFDECODER *pGifDec)
         return bBlockTerminator;
 }
 
+#ifdef IMG_SUPPORT_GIF_ANIMATION
+/*******************************************************************************
+Function:       BYTE GIF_bDecodeNextFrame(GIFDECODER *pGifDec)
+
+Precondition:   GIF_bDecode() must have read the header
+
+Overview:       This function disposes the previous frame, draws the next one
+                and schedules the frame after it. At the end of the stream
+                the animation restarts from the first frame if the loop count
+                allows it.
+
+Input:          GIF decoder's data structure
+
+Output:         Error code - '0' means more frames follow
+*******************************************************************************/
+static BYTE GIF_bDecodeNextFrame(GIFDECODER *pGifDec)
+{
+        BYTE bRetVal;
+        BYTE bCounter;
+
+        GIF_blAnimationActive = 0;
+        for(bCounter = 0; bCounter < 2; bCounter++)
+        {
+                GIF_vDisposeFrame(pGifDec);
+                bRetVal = GIF_bDecodeNextImage(pGifDec);
+                if(bRetVal != 0x3B)
+                {
+                         break;
+                }
+                if(pGifDec->blInfiniteLoopFlag == 0)
+                {
+                         if(pGifDec->wRemainingLoops == 0)
+                         {
+                                   return 0x3B;
+                         }
+                         pGifDec->wRemainingLoops--;
+                }
+                IMG_FSEEK(pGifDec->pImageFile, pGifDec->lFirstFramePos, 0);
+                if(pGifDec->wPrevWidth != 0) /* A frame has been drawn, wait for its delay */
+                {
+                         bRetVal = 0;
+                         break;
+                }
+        }
+        if(bRetVal != 0)
+        {
+                return bRetVal;
+        }
+
+        if(IMG_pTicksFn != NULL)
+        {
+                QWORD qwNow = IMG_pTicksFn();
+                GIF_qwNextFrameTicks += ((QWORD)pGifDec->wDelayTime * IMG_dwTicksPerSecond) / 100;
+                if((LONGLONG)(qwNow - GIF_qwNextFrameTicks) > 0) /* Late, do not try to catch up */
+                {
+                         GIF_qwNextFrameTicks = qwNow;
+                }
+        }
+        GIF_blAnimationActive = 1;
+        return 0;
+}
+
+/*******************************************************************************
+Function:       BYTE GIF_bAnimationTask(void)
+
+Precondition:   None
+
+Overview:       This function draws the next frame of the animation if its
+                time has come. ImageAbort() stops the animation.
+
+Input:          None
+
+Output:         Status code - '1' means no animation is being played
+                            - '0' means the animation is still being played
+*******************************************************************************/
+BYTE GIF_bAnimationTask(void)
+{
+        if(GIF_blAnimationActive == 0)
+        {
+                return 1;
+        }
+        if(IMG_blAbortImageDecoding == 1)
+        {
+                IMG_blAbortImageDecoding = 0;
+                GIF_vAnimationStop();
+                return 1;
+        }
+        if(IMG_pTicksFn != NULL && (LONGLONG)(IMG_pTicksFn() - GIF_qwNextFrameTicks) < 0)
+        {
+                return 0;
+        }
+        GIF_bDecodeNextFrame(&GIF_AnimDec);
+        return (GIF_blAnimationActive == 1)? 0: 1;
+}
+
+/*******************************************************************************
+Function:       void GIF_vAnimationStop(void)
+
+Precondition:   None
+
+Overview:       This function stops the animation. The last drawn frame stays
+                on the display.
+
+Input:          None
+
+Output:         None
+*******************************************************************************/
+void GIF_vAnimationStop(void)
+{
+        GIF_blAnimationActive = 0;
+}
+#endif
+
 /*******************************************************************************
 Function:       BYTE GIF_bDecode(IMG_FILE *pFile)
 
 Precondition:   None
 
-Overview:       This function decodes and displays a GIF image
+Overview:       This function decodes and displays a GIF image. If
+                IMG_SUPPORT_GIF_ANIMATION is defined, this draws the first
+                frame and GIF_bAnimationTask() draws the following ones.
 
 Input:          Image file
 
@@ -736,19 +1370,33 @@ Output:         Error code - '0' means no error
 *******************************************************************************/
 BYTE GIF_bDecode(IMG_FILE *pFile)
 {
+    #ifdef IMG_SUPPORT_GIF_ANIMATION
+        GIFDECODER *pGifDec = &GIF_AnimDec;
+    #else
         GIFDECODER GifDec;
+        GIFDECODER *pGifDec = &GifDec;
+    #endif
 
-        GIF_vResetData(&GifDec);
-        GifDec.pImageFile = pFile;
-        GIF_bReadHeader(&GifDec);
-        if(GifDec.blGifMarkerFlag == 0)
+        GIF_vResetData(pGifDec);
+        pGifDec->pImageFile = pFile;
+        GIF_bReadHeader(pGifDec);
+        if(pGifDec->blGifMarkerFlag == 0)
         {
             return(100);
         }
-        IMG_wImageWidth = GifDec.wScreenWidth;
-        IMG_wImageHeight = GifDec.wScreenHeight;
+        IMG_wImageWidth = pGifDec->wScreenWidth;
+        IMG_wImageHeight = pGifDec->wScreenHeight;
         IMG_vSetboundaries();
-        return GIF_bDecodeNextImage(&GifDec);
+    #ifdef IMG_SUPPORT_GIF_ANIMATION
+        pGifDec->lFirstFramePos = IMG_FTELL(pFile);
+        if(IMG_pTicksFn != NULL)
+        {
+            GIF_qwNextFrameTicks = IMG_pTicksFn();
+        }
+        return GIF_bDecodeNextFrame(pGifDec);
+    #else
+        return GIF_bDecodeNextImage(pGifDec);
+    #endif
 }
 
 #endif
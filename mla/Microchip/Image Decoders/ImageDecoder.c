@@ -72,6 +72,11 @@ IMG_FILE_SYSTEM_API *IMG_pFileAPIs;
 IMG_LOOP_CALLBACK  IMG_pLoopCallbackFn;
 #endif
 
+#ifdef IMG_SUPPORT_GIF_ANIMATION
+IMG_TICKS_CALLBACK IMG_pTicksFn;
+DWORD IMG_dwTicksPerSecond;
+#endif
+
 /**************************/
 /*******************************************************************************
 Function:       void ImageDecoderInit(void)
@@ -109,6 +114,12 @@ void ImageDecoderInit(void)
    #ifdef IMG_SUPPORT_IMAGE_DECODER_LOOP_CALLBACK
      IMG_pLoopCallbackFn = NULL;
    #endif
+
+   #ifdef IMG_SUPPORT_GIF_ANIMATION
+     IMG_pTicksFn = NULL;
+     IMG_dwTicksPerSecond = 0;
+     GIF_vAnimationStop();
+   #endif
     IMG_blAbortImageDecoding = 0;
 
 #ifdef IMG_USE_NON_BLOCKING_DECODING
@@ -134,6 +145,25 @@ void ImageLoopCallbackRegister(IMG_LOOP_CALLBACK pLoopCallbackFn)
    #endif
 }
 
+/*******************************************************************************
+Function:       void ImageTimeSourceRegister(IMG_TICKS_CALLBACK pTicksFn, DWORD dwTicksPerSecond)
+
+Precondition:   None
+
+Overview:       This function registers the time source which paces animations
+
+Input:          64-bit timer read function pointer, Timer ticks per second
+
+Output:         None
+*******************************************************************************/
+void ImageTimeSourceRegister(IMG_TICKS_CALLBACK pTicksFn, DWORD dwTicksPerSecond)
+{
+   #ifdef IMG_SUPPORT_GIF_ANIMATION
+     IMG_pTicksFn = pTicksFn;
+     IMG_dwTicksPerSecond = dwTicksPerSecond;
+   #endif
+}
+
 /*******************************************************************************
 Function:       BYTE ImageDecode(IMG_FILE *pImageFile, IMG_FILE_FORMAT eImgFormat, WORD wStartx, WORD wStarty, WORD wWidth, WORD wHeight, WORD wFlags, IMG_FILE_SYSTEM_API *pFileAPIs, IMG_PIXEL_OUTPUT pPixelOutput)
 
@@ -171,6 +201,10 @@ BYTE ImageDecode(IMG_FILE *pImageFile, IMG_FILE_FORMAT eImgFormat,
      IMG_pFileAPIs = pFileAPIs;
    #endif
 
+   #ifdef IMG_SUPPORT_GIF_ANIMATION
+     GIF_vAnimationStop(); /* A new image replaces the animation being played */
+   #endif
+
      switch(eImgFormat)
      {
       #ifdef IMG_SUPPORT_BMP
@@ -207,6 +241,13 @@ Output:         Status code - '1' means decoding is completed
 *******************************************************************************/
 BYTE ImageDecodeTask(void)
 {
+	#ifdef IMG_SUPPORT_GIF_ANIMATION
+	if(GIF_bAnimationTask() == 0)
+	{
+	    return 0;
+	}
+	#endif
+
 	#ifdef IMG_USE_NON_BLOCKING_DECODING
 	{
 	    if(IMG_pCurrentFile != NULL) // At present, supports only JPEG
@@ -79,7 +79,7 @@ typedef struct _JPEGDECODER
         WORD awQuantTable[MAX_CHANNELS][64];    /* Supports only 8 & 16 bit resolutions */
 
         /*********** From DRI ***********/
-        WORD wRestartInterval;                  /* The restart interval in blocks */
+        WORD wRestartInterval;                  /* The restart interval in MCUs */
 
         /*********** From DHT ***********/
         BYTE bHuffTables;
@@ -102,7 +102,6 @@ typedef struct _JPEGDECODER
         BYTE bBitsAvailable;
         BYTE bBlocksInOnePass;
         SHORT asOneBlock[MAX_BLOCKS][64];     /* Temporary storage for a 8x8 block */
-        WORD  wBlockNumber;
         BYTE  abChannelMap[MAX_BLOCKS];
         BYTE  bSubSampleType;
         SHORT asPrevDcValue[MAX_CHANNELS];
@@ -117,6 +116,14 @@ typedef struct _JPEGDECODER
 
         WORD wPrevX;
         WORD wPrevY;
+
+        /*********** Scan progress ***********/
+        WORD  wMCUsPerRow;
+        DWORD dwMCUs;                           /* Number of MCUs in the image */
+        DWORD dwCurrentMCU;                     /* Next MCU to be decoded */
+        DWORD dwRestartMCU;                     /* First MCU of the current restart interval */
+        BYTE  bNextRestartMarker;               /* RSTn (0-7) expected at the end of the current interval */
+        BYTE  blMarkerFound;                    /* A marker was found inside the entropy coded data */
 } JPEGDECODER;
 
 /**************************/
@@ -309,6 +316,11 @@ static BYTE JPEG_bReadHeader(JPEGDECODER *pJpegDecoder)
                case RST6:
                case RST7: break;
 
+               case SOF2: /* Progressive frame: its scans refine the whole image, so all the coefficients of */
+                          /* the image would have to be kept in RAM till the last scan - not supported */
+                          JPEG_SendError(100);
+                          break;
+
                case SOF0: /* Start of frame */
                           wSegLen = JPEG_wReadWord(pJpegDecoder->pImageFile);
                           if(wSegLen <= 8)
@@ -564,7 +576,7 @@ static BYTE JPEG_bGet1Bit(JPEGDECODER *pJpegDecoder)
      if(pJpegDecoder->wBufferIndex >= pJpegDecoder->wBufferLen)
      {
             pJpegDecoder->wBufferLen = IMG_FREAD(&pJpegDecoder->abDataBuffer[0], sizeof(BYTE), MAX_DATA_BUF_LEN, pJpegDecoder->pImageFile);
-            while(pJpegDecoder->abDataBuffer[pJpegDecoder->wBufferLen - 1] == 0xFF)
+            while(pJpegDecoder->wBufferLen > 0 && pJpegDecoder->abDataBuffer[pJpegDecoder->wBufferLen - 1] == 0xFF)
             {
                    pJpegDecoder->wBufferLen--;
                    IMG_FSEEK(pJpegDecoder->pImageFile, -1, 1);
@@ -592,6 +604,12 @@ static BYTE JPEG_bGet1Bit(JPEGDECODER *pJpegDecoder)
                    {
                          pJpegDecoder->bBitsAvailable = 8;
                    }
+                   else /* A marker: the data of this restart interval ended early, i.e. it is corrupt */
+                   {
+                         pJpegDecoder->blMarkerFound = 1;
+                         pJpegDecoder->wBufferIndex -= 2; /* The marker is left for JPEG_bResync() */
+                         pJpegDecoder->wWorkBits = 0;     /* and zeros are returned till then */
+                   }
             }
      }
 
@@ -633,25 +651,50 @@ static WORD JPEG_wGetBits(JPEGDECODER *pJpegDecoder, BYTE bLen)
 }
 
 /*******************************************************************************
-Function:       WORD JPEG_wGetRestartWord(JPEGDECODER *pJpegDecoder)
+Function:       BYTE JPEG_bResync(JPEGDECODER *pJpegDecoder)
 
-Precondition:   File pointer must point to the restart word
+Precondition:   A restart interval is over or its data was found to be corrupt
 
-Overview:       Returns the restart word
+Overview:       Discards the bits left from the current interval and skips the
+                file till the next restart marker
 
 Input:          JPEGDECODER
 
-Output:         Restart word
+Output:         Number of the restart marker found (0-7), 0xFF if the end of
+                the image or of the file came first
 *******************************************************************************/
-static WORD JPEG_wGetRestartWord(JPEGDECODER *pJpegDecoder)
+static BYTE JPEG_bResync(JPEGDECODER *pJpegDecoder)
 {
-     WORD wRestartWord;
-     while((pJpegDecoder->bBitsAvailable & 0x07) != 0) /* This is to clearoff wnwanted bits to go to fresh byte */
+     BYTE bByte, blMarker = FALSE;
+
+     pJpegDecoder->bBitsAvailable = 0;
+     pJpegDecoder->blMarkerFound = 0;
+     while(1)
      {
-            JPEG_bGet1Bit(pJpegDecoder);
+            if(pJpegDecoder->wBufferIndex >= pJpegDecoder->wBufferLen)
+            {
+                   pJpegDecoder->wBufferLen = IMG_FREAD(&pJpegDecoder->abDataBuffer[0], sizeof(BYTE), MAX_DATA_BUF_LEN, pJpegDecoder->pImageFile);
+                   pJpegDecoder->wBufferIndex = 0;
+                   if(pJpegDecoder->wBufferLen == 0)
+                   {
+                          return 0xFF;
+                   }
+            }
+
+            bByte = pJpegDecoder->abDataBuffer[pJpegDecoder->wBufferIndex++];
+            if(blMarker == TRUE && bByte >= RST0 && bByte <= RST7)
+            {
+                   /* Give back the rest of the buffer, JPEG_bGet1Bit() needs it to be refilled by itself */
+                   IMG_FSEEK(pJpegDecoder->pImageFile, -(LONG)(pJpegDecoder->wBufferLen - pJpegDecoder->wBufferIndex), 1);
+                   pJpegDecoder->wBufferIndex = pJpegDecoder->wBufferLen;
+                   return bByte - RST0;
+            }
+            if(blMarker == TRUE && bByte == EOI)
+            {
+                   return 0xFF;
+            }
+            blMarker = (bByte == 0xFF)? TRUE: FALSE;
      }
-     wRestartWord = JPEG_wGetBits(pJpegDecoder, 16);
-     return(wRestartWord);
 }
 
 /*******************************************************************************
@@ -742,20 +785,6 @@ static BYTE JPEG_bDecodeOneBlock(JPEGDECODER *pJpegDecoder)
      {
             BYTE bByteCount, bHuffbyte;
 
-            if((pJpegDecoder->wRestartInterval > 0) && (pJpegDecoder->wBlockNumber == pJpegDecoder->wRestartInterval * pJpegDecoder->bBlocksInOnePass))
-            {
-                   WORD wRestartWord = JPEG_wGetRestartWord(pJpegDecoder);
-                   if(wRestartWord < 0xFFD0 || wRestartWord > 0xFFD7)
-                   {
-                            JPEG_SendError(100);
-                   }                          
-                   for(bCounter = 0; bCounter < MAX_CHANNELS; bCounter++)
-                   {
-                            pJpegDecoder->asPrevDcValue[bCounter] = 0;
-                   }                   
-                   pJpegDecoder->wBlockNumber = 0;
-            }
-
             for(bCounter = 0; bCounter < 64; bCounter++)
             {
                    pJpegDecoder->asOneBlock[bBlock][bCounter] = 0;
@@ -791,7 +820,6 @@ static BYTE JPEG_bDecodeOneBlock(JPEGDECODER *pJpegDecoder)
                    }
                    pJpegDecoder->asOneBlock[bBlock][abZigzag[bByteCount++]] = JPEG_sGetBitsValue(pJpegDecoder, bHuffbyte & 0x0F);
             }
-            pJpegDecoder->wBlockNumber++;
             jpeg_idct_islow(&pJpegDecoder->asOneBlock[bBlock][0],pJpegDecoder->pwCurrentQuantTable);
      }
 
@@ -1000,76 +1028,190 @@ static BYTE JPEG_bPaintOneBlock(JPEGDECODER *pJpegDecoder)
      return 0;
 }
 
-#ifndef IMG_USE_NON_BLOCKING_DECODING
-
 /*******************************************************************************
-Function:       BYTE JPEG_bDecode(IMG_FILE *pfile, BOOL bFirstTime)
+Function:       void JPEG_vStartScan(JPEGDECODER *pJpegDecoder)
 
-Precondition:   The global variables of Image decoder must be set
+Precondition:   JPEG_bReadHeader() must have been called
 
-Overview:       This function decodes and displays a jpeg image
+Overview:       Sets the output boundaries, builds the Huffman tables and
+                prepares the MCU count of the scan
 
-Input:          Image file, ignored BOOLean
+Input:          JPEGDECODER
 
-Output:         Error code - '0' means no error
+Output:         None
 *******************************************************************************/
-BYTE JPEG_bDecode(IMG_FILE *pfile, BOOL bFirstTime)
+static void JPEG_vStartScan(JPEGDECODER *pJpegDecoder)
 {
      WORD whblocks, wvblocks;
-     WORD wi, wj;
-     JPEGDECODER JPEG_JpegDecoder;
 
-     JPEG_vResetDecoder(&JPEG_JpegDecoder);
-     JPEG_JpegDecoder.pImageFile = pfile;
-     if(JPEG_bReadHeader(&JPEG_JpegDecoder) != 0)
-     {
-         return JPEG_JpegDecoder.bError;
-     }
-    
-     IMG_wImageWidth = JPEG_JpegDecoder.wWidth;
-     IMG_wImageHeight = JPEG_JpegDecoder.wHeight;
+     IMG_wImageWidth = pJpegDecoder->wWidth;
+     IMG_wImageHeight = pJpegDecoder->wHeight;
      IMG_vSetboundaries();
 
-     JPEG_bGenerateHuffmanTables(&JPEG_JpegDecoder);
+     JPEG_bGenerateHuffmanTables(pJpegDecoder);
 
-     whblocks = JPEG_JpegDecoder.wWidth >> 3;
-     wvblocks = JPEG_JpegDecoder.wHeight >> 3;
+     whblocks = pJpegDecoder->wWidth >> 3;
+     wvblocks = pJpegDecoder->wHeight >> 3;
 
-     if(whblocks * 8 < JPEG_JpegDecoder.wWidth) /* Odd sizes */
+     if(whblocks * 8 < pJpegDecoder->wWidth) /* Odd sizes */
      {
          whblocks++;
      }
 
-     if(wvblocks * 8 < JPEG_JpegDecoder.wHeight) /* Odd sizes */
+     if(wvblocks * 8 < pJpegDecoder->wHeight) /* Odd sizes */
      {
          wvblocks++;
      }
 
-     if(JPEG_JpegDecoder.bSubSampleType == JPEG_SAMPLE_1x2)
+     if(pJpegDecoder->bSubSampleType == JPEG_SAMPLE_1x2)
      {
          wvblocks =  (wvblocks>>1) + (wvblocks&1);
      }
-     else if(JPEG_JpegDecoder.bSubSampleType == JPEG_SAMPLE_2x1)
+     else if(pJpegDecoder->bSubSampleType == JPEG_SAMPLE_2x1)
      {
          whblocks = (whblocks>>1) + (whblocks&1);
      }
-     else if(JPEG_JpegDecoder.bSubSampleType == JPEG_SAMPLE_2x2)
+     else if(pJpegDecoder->bSubSampleType == JPEG_SAMPLE_2x2)
      {
          wvblocks =  (wvblocks>>1) + (wvblocks&1);
          whblocks = (whblocks>>1) + (whblocks&1);
      }
 
-     JPEG_vInitDisplay(&JPEG_JpegDecoder);
+     pJpegDecoder->wMCUsPerRow = whblocks;
+     pJpegDecoder->dwMCUs = (DWORD)whblocks * wvblocks;
+     pJpegDecoder->dwCurrentMCU = 0;
+     pJpegDecoder->dwRestartMCU = 0;
+     pJpegDecoder->bNextRestartMarker = 0;
 
-     for(wi = 0; wi < whblocks; wi++)
+     JPEG_vInitDisplay(pJpegDecoder);
+}
+
+/*******************************************************************************
+Function:       void JPEG_vRestart(JPEGDECODER *pJpegDecoder)
+
+Precondition:   A restart interval is over or its data was found to be corrupt
+
+Overview:       Finds the next restart marker and continues with the first MCU
+                of the interval following it. If the marker is not the expected
+                one, the intervals in between are lost and are not painted.
+                Once a marker is found, the error of the corrupt interval is
+                cleared as decoding has recovered
+
+Input:          JPEGDECODER
+
+Output:         None
+*******************************************************************************/
+static void JPEG_vRestart(JPEGDECODER *pJpegDecoder)
+{
+     BYTE bMarker, bCounter;
+
+     bMarker = JPEG_bResync(pJpegDecoder);
+     if(bMarker == 0xFF) /* Nothing more to decode */
+     {
+            pJpegDecoder->dwCurrentMCU = pJpegDecoder->dwMCUs;
+            return;
+     }
+
+     pJpegDecoder->bError = 0;
+     pJpegDecoder->dwRestartMCU += (DWORD)(((bMarker - pJpegDecoder->bNextRestartMarker) & 0x07) + 1) * pJpegDecoder->wRestartInterval;
+     pJpegDecoder->bNextRestartMarker = (bMarker + 1) & 0x07;
+
+     for(bCounter = 0; bCounter < MAX_CHANNELS; bCounter++)
+     {
+            pJpegDecoder->asPrevDcValue[bCounter] = 0;
+     }
+
+     if(pJpegDecoder->dwCurrentMCU != pJpegDecoder->dwRestartMCU)
      {
-            for(wj = 0; wj < wvblocks; wj++)
+            BYTE bMCUWidth = 8, bMCUHeight = 8;
+
+            if(pJpegDecoder->bSubSampleType == JPEG_SAMPLE_2x1 || pJpegDecoder->bSubSampleType == JPEG_SAMPLE_2x2)
+            {
+                   bMCUWidth = 16;
+            }
+            if(pJpegDecoder->bSubSampleType == JPEG_SAMPLE_1x2 || pJpegDecoder->bSubSampleType == JPEG_SAMPLE_2x2)
             {
-                   IMG_vCheckAndAbort();
-                   JPEG_bDecodeOneBlock(&JPEG_JpegDecoder); /* Fills a block after correcting the zigzag, dequantizing, IDCR and color conversion to RGB */
-                   JPEG_bPaintOneBlock(&JPEG_JpegDecoder); /* Sends the block to the Graphics unit */
+                   bMCUHeight = 16;
             }
+
+            pJpegDecoder->dwCurrentMCU = pJpegDecoder->dwRestartMCU;
+            pJpegDecoder->wPrevX = (pJpegDecoder->dwCurrentMCU % pJpegDecoder->wMCUsPerRow) * bMCUWidth;
+            pJpegDecoder->wPrevY = (pJpegDecoder->dwCurrentMCU / pJpegDecoder->wMCUsPerRow) * bMCUHeight;
      }
+}
+
+/*******************************************************************************
+Function:       BYTE JPEG_bDecodeMCUs(JPEGDECODER *pJpegDecoder, WORD wMaxMCUs)
+
+Precondition:   JPEG_vStartScan() must have been called
+
+Overview:       Decodes and displays up to wMaxMCUs MCUs of the scan. If the image
+                has restart intervals, an interval whose data is corrupt is
+                dropped at the point the corruption is seen and decoding goes on
+                from the next restart marker
+
+Input:          JPEGDECODER, Maximum number of MCUs to be decoded in this call
+
+Output:         Status code - '1' means the scan is completed
+*******************************************************************************/
+static BYTE JPEG_bDecodeMCUs(JPEGDECODER *pJpegDecoder, WORD wMaxMCUs)
+{
+     while(wMaxMCUs > 0 && pJpegDecoder->dwCurrentMCU < pJpegDecoder->dwMCUs)
+     {
+            if(pJpegDecoder->wRestartInterval > 0 &&
+               pJpegDecoder->dwCurrentMCU == pJpegDecoder->dwRestartMCU + pJpegDecoder->wRestartInterval)
+            {
+                   JPEG_vRestart(pJpegDecoder);
+                   continue;
+            }
+
+            if(JPEG_bDecodeOneBlock(pJpegDecoder) != 0 || pJpegDecoder->blMarkerFound) /* Fills a block after correcting the zigzag, dequantizing, IDCR and color conversion to RGB */
+            {
+                   if(pJpegDecoder->wRestartInterval > 0)
+                   {
+                          JPEG_vRestart(pJpegDecoder);
+                          continue;
+                   }
+            }
+            JPEG_bPaintOneBlock(pJpegDecoder); /* Sends the block to the Graphics unit */
+            pJpegDecoder->dwCurrentMCU++;
+            wMaxMCUs--;
+     }
+
+     return (pJpegDecoder->dwCurrentMCU >= pJpegDecoder->dwMCUs)? 1: 0;
+}
+
+#ifndef IMG_USE_NON_BLOCKING_DECODING
+
+/*******************************************************************************
+Function:       BYTE JPEG_bDecode(IMG_FILE *pfile, BOOL bFirstTime)
+
+Precondition:   The global variables of Image decoder must be set
+
+Overview:       This function decodes and displays a jpeg image
+
+Input:          Image file, ignored BOOLean
+
+Output:         Error code - '0' means no error
+*******************************************************************************/
+BYTE JPEG_bDecode(IMG_FILE *pfile, BOOL bFirstTime)
+{
+     JPEGDECODER JPEG_JpegDecoder;
+
+     JPEG_vResetDecoder(&JPEG_JpegDecoder);
+     JPEG_JpegDecoder.pImageFile = pfile;
+     if(JPEG_bReadHeader(&JPEG_JpegDecoder) != 0)
+     {
+         return JPEG_JpegDecoder.bError;
+     }
+
+     JPEG_vStartScan(&JPEG_JpegDecoder);
+
+     do
+     {
+            IMG_vCheckAndAbort();
+     } while(JPEG_bDecodeMCUs(&JPEG_JpegDecoder, 1) == 0);
+
      return JPEG_JpegDecoder.bError;
 }
 
@@ -1080,7 +1222,8 @@ Function:       BYTE JPEG_bDecode(IMG_FILE *pfile, BOOL bFirstTime)
 
 Precondition:   The global variables of Image decoder must be set
 
-Overview:       This function decodes and displays a jpeg image
+Overview:       This function decodes and displays a jpeg image, JPEG_MCUS_PER_CALL
+                MCUs at a time
 
 Input:          Image file, BOOLean indicating if this is the first time calling 
 				the JPEG_bDecode function (needed to reset internal decoding 
@@ -1092,8 +1235,6 @@ Output:         Error code - '0' means not yet completed
 *******************************************************************************/
 BYTE JPEG_bDecode(IMG_FILE *pfile, BOOL bFirstTime)
 {
-	static WORD whblocks, wvblocks;
-	static WORD wi, wj;
 	static JPEGDECODER JPEG_JpegDecoder;
 	static enum
 	{
@@ -1120,58 +1261,12 @@ BYTE JPEG_bDecode(IMG_FILE *pfile, BOOL bFirstTime)
                         return 0;
         
         case HEADER_DECODED:
-                            IMG_wImageWidth = JPEG_JpegDecoder.wWidth;
-                            IMG_wImageHeight = JPEG_JpegDecoder.wHeight;
-                            IMG_vSetboundaries();
-
-                            JPEG_bGenerateHuffmanTables(&JPEG_JpegDecoder);
-
-                            whblocks = JPEG_JpegDecoder.wWidth >> 3;
-                            wvblocks = JPEG_JpegDecoder.wHeight >> 3;
-
-                            if(whblocks * 8 < JPEG_JpegDecoder.wWidth) /* Odd sizes */
-                            {
-                                whblocks++;
-                            }
-
-                            if(wvblocks * 8 < JPEG_JpegDecoder.wHeight) /* Odd sizes */
-                            {
-                                wvblocks++;
-                            }
-
-                            if(JPEG_JpegDecoder.bSubSampleType == JPEG_SAMPLE_1x2)
-                            {
-                                wvblocks =  (wvblocks>>1) + (wvblocks&1);
-                            }
-                            else if(JPEG_JpegDecoder.bSubSampleType == JPEG_SAMPLE_2x1)
-                            {
-                                whblocks = (whblocks>>1) + (whblocks&1);
-                            }
-                            else if(JPEG_JpegDecoder.bSubSampleType == JPEG_SAMPLE_2x2)
-                            {
-                                wvblocks =  (wvblocks>>1) + (wvblocks&1);
-                                whblocks = (whblocks>>1) + (whblocks&1);
-                            }
-
-                            JPEG_vInitDisplay(&JPEG_JpegDecoder);
-                             
-                            wi = 0;
-                            wj = 0;
-
+                            JPEG_vStartScan(&JPEG_JpegDecoder);
                             decodestate = BLOCK_DECODE;
                             return 0;
 
-        case BLOCK_DECODE:  if(wi < whblocks)
+        case BLOCK_DECODE:  if(JPEG_bDecodeMCUs(&JPEG_JpegDecoder, JPEG_MCUS_PER_CALL) == 0)
                             {
-                                JPEG_bDecodeOneBlock(&JPEG_JpegDecoder); /* Fills a block after correcting the zigzag, dequantizing, IDCR and color conversion to RGB */
-                                JPEG_bPaintOneBlock(&JPEG_JpegDecoder); /* Sends the block to the Graphics unit */
-                                wj++;
-                                
-                                if(wj >= wvblocks)
-                                {
-                                    wj = 0;
-                                    wi++;
-                                }
                                 return 0;
                             }
 
@@ -89,6 +89,9 @@ Value Range - The scale for the value axis.
     #define CH_NUMERIC  	0x0080      // This bit is used only for bar charts. If this bit is set, it indicates that the
 										// bar chart labels for variables are numeric. If this bit is not set, it indicates
 										// that the bar chart labels for variables are alphabets.
+    #define CH_LINE         0x0020      // Bit to indicate the chart is type line. Each data series is drawn as a trace with one min/max span per pixel column.
+										// If PIE or BAR type is also set, PIE and BAR types have higher priority.
+    #define CH_DRAW_COLUMN  0x1000      // Bit to indicate only the newest pixel column of a line chart must be redrawn (set by ChAppendSample()).
     #define CH_DRAW_DATA    0x2000      // Bit to indicate data portion of the chart must be redrawn.
     #define CH_DRAW         0x4000      // Bit to indicate chart must be redrawn.
     #define CH_HIDE         0x8000      // Bit to indicate chart must be removed from screen.
@@ -105,6 +108,21 @@ Value Range - The scale for the value axis.
     #define USE_HORZ_ASCENDING_ORDER    // use ascending order when displaying variables on horizontal mode (bar chart only)
     #define USE_PIE_ENABLE_LABEL        // use labels:  A:10%,30 where each sample is labeled A-Z followed by a colon.
 
+/*********************************************************************
+* Overview: Pixel rows covered by the samples of one pixel column of 
+*			a line chart (CH_LINE). The rows are relative to the top of 
+*			the plot area. top is set to CH_COLUMN_EMPTY when no sample 
+*			falls in the column.
+*
+*********************************************************************/
+typedef struct
+{
+    SHORT   top;        // Row of the largest sample of the column.
+    SHORT   bottom;     // Row of the smallest sample of the column.
+} CHARTCOLUMN;
+
+    #define CH_COLUMN_EMPTY 0x7FFF      // CHARTCOLUMN top value of a column without samples.
+
 /*********************************************************************
 * Overview: Defines a variable for the CHART object. It specifies
 *			the number of samples, pointer to the array of samples
@@ -122,6 +140,12 @@ typedef struct
     BYTE    show;       // The flag to indicate if the data series will be shown or not. If this flag is set to SHOW_DATA, the data series will be shown. If HIDE_DATA, the data series will not be shown.
     WORD    *pData;     // Pointer to the array of data samples.
     void    *pNextData; // Pointer to the next data series. NULL if no other data series follows.
+    DWORD   total;      // Ring series only: number of samples appended with ChAppendSample().
+    WORD    count;      // Ring series only: number of valid samples in pData, up to samples.
+    BYTE    ring;       // Set if the series is a ring buffer created with ChAddRingSeries().
+    BYTE    cached;     // Set when pColumn matches the samples, the ranges and the plot area of a line chart.
+    CHARTCOLUMN *pColumn;   // Line charts only: min/max rows of each pixel column, allocated when the series is first drawn.
+    WORD    columns;    // Number of entries in pColumn.
 } DATASERIES;
 
 /*********************************************************************
@@ -371,6 +395,88 @@ CHART       *ChCreate
 ********************************************************************/
 DATASERIES  *ChAddDataSeries(CHART *pCh, WORD nSamples, WORD *pData, XCHAR *pName);
 
+/*********************************************************************
+* Function: ChAddRingSeries(CHART *pCh, WORD nSamples, WORD *pBuffer, XCHAR *pName)
+*
+* Overview: This function creates a DATASERIES object that keeps the 
+*			last nSamples samples given to ChAppendSample() in pBuffer.
+*			On a line chart (CH_LINE) the newest sample is drawn at the 
+*			right edge of the plot and the trace scrolls to the left 
+*			as samples are appended. The sample range of the chart is 
+*			not used for ring series.
+*
+* PreCondition: none
+*
+* Input: pCh - Pointer to the chart object.
+*        nSamples - The number of samples pBuffer can hold.
+* 		 pBuffer - Pointer to the array used to store the samples. 
+*		 pName - Pointer to the string used to label the data series.
+*
+* Output: Returns the pointer to the data variable (DATASERIES) object created.
+*		  If NULL is returned, the addition of the new object failed due to
+*		  not enough memory for the object.
+*
+* Example:
+*   <CODE> 
+*	WORD 		syncError[1000];
+*	DATASERIES	*pSeries;
+*
+*	SetState(pChart, CH_LINE);
+*	ChSetValueRange(pChart, 0, 500);
+*	pSeries = ChAddRingSeries(pChart, 1000, syncError, (XCHAR *)"Error");
+*	.....
+*	// every new measurement redraws only the newest pixel column
+*	ChAppendSample(pChart, pSeries, error);
+*	GOLDraw();
+*	</CODE> 
+*
+* Side Effects: Appends to the list of DATASERIES that the chart is operating on. 
+*
+********************************************************************/
+DATASERIES  *ChAddRingSeries(CHART *pCh, WORD nSamples, WORD *pBuffer, XCHAR *pName);
+
+/*********************************************************************
+* Function: void ChAppendSample(CHART *pCh, DATASERIES *pSeries, WORD value)
+*
+* Overview: This function stores a new sample in a ring series, the 
+*			oldest sample is dropped when the buffer is full. On a 
+*			line chart only the pixel column of the new sample is 
+*			recomputed. The chart state is set to CH_DRAW_COLUMN, or 
+*			to CH_DRAW_DATA when the sample starts a new pixel column 
+*			and the trace has to scroll.
+*
+* PreCondition: pSeries was created with ChAddRingSeries().
+*
+* Input: pCh - Pointer to the chart object.
+*        pSeries - Pointer to the ring series.
+*		 value - The new sample.
+*
+* Output: none.
+*
+* Side Effects: none.
+*
+********************************************************************/
+void        ChAppendSample(CHART *pCh, DATASERIES *pSeries, WORD value);
+
+/*********************************************************************
+* Macros: ChInvalidateSeries(pDSeries)
+*
+* Overview: This macro discards the line chart column cache of the data 
+*			series. Call it after the samples of an array series are
+*			modified, the cache is rebuilt the next time the chart 
+*			is drawn.
+*
+* PreCondition: none
+*
+* Input: pDSeries - Pointer to the data series (DATASERIES).
+*
+* Output: none.
+*
+* Side Effects: none.
+*
+********************************************************************/
+    #define ChInvalidateSeries(pDSeries)    ((pDSeries)->cached = 0)
+
 /*********************************************************************
 * Function: void ChFreeDataSeries(void *pObj)
 *
@@ -577,7 +683,8 @@ void        ChRemoveDataSeries(CHART *pCh, WORD number);
 *
 * Output: none.
 *
-* Side Effects: none.
+* Side Effects: The line chart column caches of all the data series are
+*				discarded.
 *
 ********************************************************************/
 void    ChSetValueRange(CHART *pCh, WORD min, WORD max);
@@ -702,7 +809,8 @@ void    ChSetPercentRange(CHART *pCh, WORD min, WORD max);
 *
 * Example: See ChCreate() example.
 *
-* Side Effects: none.
+* Side Effects: The line chart column caches of all the data series are
+*				discarded.
 *
 ********************************************************************/
 void    ChSetSampleRange(CHART *pCh, WORD start, WORD end);
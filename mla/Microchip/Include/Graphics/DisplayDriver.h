@@ -339,6 +339,104 @@ void SetVisualPage(WORD page);
 ********************************************************************/
 void PutPixel(SHORT x, SHORT y);
 
+/*********************************************************************
+* Function: void PutSpan(SHORT left, SHORT right, SHORT y)
+*
+* Overview: Fills the horizontal span from left to right on row y with
+*           the current color. Bar() and Line() clip the span once before
+*           calling this function, so the driver does not have to check
+*           each pixel. The Graphics Library provides a version that uses
+*           PutPixel(); drivers that can write consecutive pixels after
+*           setting the address once should implement their own.
+*
+* PreCondition: none
+*
+* Input: left - x position of the first pixel.
+*        right - x position of the last pixel.
+*        y - y position of the span.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void PutSpan(SHORT left, SHORT right, SHORT y);
+
+/*********************************************************************
+* Function: void PutSpanColors(SHORT left, SHORT right, SHORT y, GFX_COLOR *pColor)
+*
+* Overview: Writes the horizontal span from left to right on row y, 
+*           pixel n gets the color pColor[n]. The current color is not
+*           changed. The RLE image functions clip the span before calling 
+*           this function. The Graphics Library provides a version that 
+*           uses PutPixel(); drivers that can write consecutive pixels 
+*           after setting the address once should implement their own.
+*
+* PreCondition: none
+*
+* Input: left - x position of the first pixel.
+*        right - x position of the last pixel.
+*        y - y position of the span.
+*        pColor - pointer to right - left + 1 colors.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void PutSpanColors(SHORT left, SHORT right, SHORT y, GFX_COLOR *pColor);
+
+/*********************************************************************
+* Function: void GetSpanColors(SHORT left, SHORT right, SHORT y, GFX_COLOR *pColor)
+*
+* Overview: Reads the horizontal span from left to right on row y, 
+*           pColor[n] gets the color of pixel n. BarAlpha() clips the 
+*           span before calling this function. The Graphics Library 
+*           provides a version that uses GetPixel(); drivers that can 
+*           read consecutive pixels after setting the address once 
+*           should implement their own.
+*
+* PreCondition: none
+*
+* Input: left - x position of the first pixel.
+*        right - x position of the last pixel.
+*        y - y position of the span.
+*        pColor - pointer to room for right - left + 1 colors.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void GetSpanColors(SHORT left, SHORT right, SHORT y, GFX_COLOR *pColor);
+
+/*********************************************************************
+* Function: WORD ScrollWindow(SHORT left, SHORT top, SHORT right, 
+*                             SHORT bottom, SHORT dx, SHORT dy)
+*
+* Overview: Moves the contents of the window by dx pixels to the right 
+*           and dy pixels down (negative values move them left and up).
+*           Pixels moved out of the window are lost, the strips exposed
+*           by the move are not changed and have to be redrawn by the 
+*           caller. The Graphics Library provides a version that reads 
+*           the rows with GetPixel() and writes them with PutSpanColors();
+*           drivers with a frame buffer in memory or a copy engine 
+*           should implement their own.
+*
+* PreCondition: none
+*
+* Input: left,top - top left corner of the window.
+*        right,bottom - bottom right corner of the window.
+*        dx - horizontal distance of the move.
+*        dy - vertical distance of the move.
+*
+* Output: Returns 1 when the move is done.
+*
+* Side Effects: none
+*
+********************************************************************/
+WORD ScrollWindow(SHORT left, SHORT top, SHORT right, SHORT bottom, SHORT dx, SHORT dy);
+
 /*********************************************************************
 * Function: GFX_COLOR GetPixel(SHORT x, SHORT y)
 *
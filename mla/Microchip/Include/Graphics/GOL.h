@@ -341,6 +341,46 @@ extern OBJ_HEADER   *_pObjectFocused;
         #define GOL_EMBOSS_SIZE 3
     #endif
 
+#ifdef USE_DOUBLE_BUFFERING
+/*********************************************************************
+* Overview: With double buffering, GOLDraw() collects the areas redrawn
+*			in one pass and merges them before they are invalidated.
+*			This keeps the number of areas copied to the frame buffer
+*			within GOL_MAX_DAMAGE_AREAS, so the driver does not fall
+*			back to copying the whole screen. Two areas are merged when
+*			their bounding rectangle covers at most GOL_DAMAGE_MERGE_COST
+*			pixels that are in neither of them. If not defined in
+*			GraphicsConfig.h, the default values set in GOL.h are used.
+*
+*********************************************************************/
+    #ifndef GOL_MAX_DAMAGE_AREAS
+        #define GOL_MAX_DAMAGE_AREAS    GFX_MAX_INVALIDATE_AREAS
+    #endif
+
+    #ifndef GOL_DAMAGE_MERGE_COST
+        #define GOL_DAMAGE_MERGE_COST   1024
+    #endif
+#endif
+
+#ifdef USE_NONBLOCKING_CONFIG
+/*********************************************************************
+* Overview: Statistics of the GOLDraw() calls, used to check how long
+*			the drawing keeps the main loop busy (see GOLSetDrawBudget()).
+*			The times are measured with the time source registered by
+*			GFXTimeSliceSourceRegister() and are 0 without one.
+*
+*********************************************************************/
+typedef struct
+{
+    DWORD   calls;                  // number of GOLDraw() calls
+    DWORD   yields;                 // calls that stopped because the budget was used up
+    DWORD   lastSlice;              // time spent in the last call in microseconds
+    DWORD   maxSlice;               // longest call in microseconds
+} GOL_DRAW_STATS;
+
+extern GOL_DRAW_STATS   GOLDrawStats;
+#endif
+
 /*********************************************************************
 * Overview: The default font GOLFontDefault is declared in  
 *           GOLFontDefault.c file included in the Graphics Library. 
@@ -1215,6 +1255,79 @@ BOOL    GOLDeleteObjectByID(WORD ID);
 ********************************************************************/
 WORD    GOLDraw(void);
 
+#ifdef USE_NONBLOCKING_CONFIG
+/*********************************************************************
+* Function: void GOLSetDrawBudget(DWORD budget)
+*
+* Overview: This function limits the time spent in each GOLDraw() 
+*			call. When the budget is used up GOLDraw() returns 0 
+*			after the current span of a Bar() or before the next 
+*			object, and the next call continues from there. Bars
+*			drawn by primitives that do not check the return value
+*			of Bar(), such as BevelGradient(), are not split. This 
+*			keeps a long redraw from delaying the other tasks of the 
+*			main loop. The time is measured with the time source 
+*			registered by GFXTimeSliceSourceRegister().
+*
+* PreCondition: none
+*
+* Input: budget - time in microseconds, 0 removes the limit.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void    GOLSetDrawBudget(DWORD budget);
+
+/*********************************************************************
+* Function: void GOLResetDrawStats(void)
+*
+* Overview: This function clears GOLDrawStats.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void    GOLResetDrawStats(void);
+#endif
+
+/*********************************************************************
+* Function: void GOLAddDamage(SHORT left, SHORT top, SHORT right, SHORT bottom)
+*
+* Overview: This function reports a changed area of the draw buffer
+*			to the current GOLDraw() pass. The area is merged with the
+*			other areas of the pass and is copied to the frame buffer
+*			when the pass is completed.
+*			An object that redraws only a part of itself can call this
+*			from its draw function. GOLDraw() then uses the reported
+*			areas instead of the whole object.
+*			This is only used with double buffering, otherwise this
+*			does nothing.
+*
+* PreCondition: none
+*
+* Input: left - Defines the left most border of the changed area.
+*		 top - Defines the top most border of the changed area.
+*		 right - Defines the right most border of the changed area.
+*		 bottom - Defines the bottom most border of the changed area.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+#ifdef USE_DOUBLE_BUFFERING
+void    GOLAddDamage(SHORT left, SHORT top, SHORT right, SHORT bottom);
+#else
+    #define GOLAddDamage(left, top, right, bottom)
+#endif
+
 /*********************************************************************
 * Function: void GOLRedrawRec(SHORT left, SHORT top, SHORT right, SHORT bottom)
 *
@@ -0,0 +1,163 @@
+/*****************************************************************************
+ *  Module for Microchip Graphics Library
+ *  Host frame buffer display driver
+ *****************************************************************************
+ * FileName:        HostFrameBuffer.h
+ * Company:         Microchip Technology Incorporated
+ *
+ * Software License Agreement
+ *
+ * Copyright (C) 2012 Microchip Technology Inc.  All rights reserved.
+ * Microchip licenses to you the right to use, modify, copy and distribute
+ * Software only when embedded on a Microchip microcontroller or digital
+ * signal controller, which is integrated into your product or third party
+ * product (pursuant to the sublicense terms in the accompanying license
+ * agreement).  
+ *
+ * You should refer to the license agreement accompanying this Software
+ * for additional information regarding your rights and obligations.
+ *
+ * SOFTWARE AND DOCUMENTATION ARE PROVIDED "AS IS" WITHOUT WARRANTY OF ANY
+ * KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION, ANY WARRANTY
+ * OF MERCHANTABILITY, TITLE, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+ * PURPOSE. IN NO EVENT SHALL MICROCHIP OR ITS LICENSORS BE LIABLE OR
+ * OBLIGATED UNDER CONTRACT, NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION,
+ * BREACH OF WARRANTY, OR OTHER LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT
+ * DAMAGES OR EXPENSES INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL,
+ * INDIRECT, PUNITIVE OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA,
+ * COST OF PROCUREMENT OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY
+ * CLAIMS BY THIRD PARTIES (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF),
+ * OR OTHER SIMILAR COSTS.
+ *
+ * Date         Comment
+ *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ *****************************************************************************/
+#ifndef _HOST_FRAME_BUFFER_H
+    #define _HOST_FRAME_BUFFER_H
+
+    #include "HardwareProfile.h"
+    #include "GraphicsConfig.h"
+    #include "GenericTypeDefs.h"
+
+    #ifndef DISP_HOR_RESOLUTION
+        #error DISP_HOR_RESOLUTION must be defined in HardwareProfile.h
+    #endif
+    #ifndef DISP_VER_RESOLUTION
+        #error DISP_VER_RESOLUTION must be defined in HardwareProfile.h
+    #endif
+    #if (COLOR_DEPTH != 16)
+        #error The host frame buffer driver supports only 16 bpp (RGB565) color depth
+    #endif
+    #if (DISP_ORIENTATION != 0)
+        #error The host frame buffer driver supports only DISP_ORIENTATION 0
+    #endif
+
+/*********************************************************************
+* Overview: Number of pages kept in memory. The pages are addressed
+*           with GetPageAddress() like the pages of a display controller,
+*           an address is the offset of the first pixel of the page.
+*
+*********************************************************************/
+    #ifdef GFX_DRV_PAGE_COUNT
+        #define HOST_FB_PAGE_COUNT  GFX_DRV_PAGE_COUNT
+    #else
+        #define HOST_FB_PAGE_COUNT  1
+    #endif
+
+    #define HOST_FB_PAGE_SIZE       ((DWORD)DISP_HOR_RESOLUTION * DISP_VER_RESOLUTION)
+
+/*********************************************************************
+* Overview: Driver call and pixel counters. Every driver entry point 
+*           counts its calls, pixelsWritten and pixelsRead count the 
+*           pixels stored to and fetched from the frame buffer.
+*
+*********************************************************************/
+typedef struct
+{
+    DWORD   putPixel;
+    DWORD   putSpan;
+    DWORD   putSpanColors;
+    DWORD   getPixel;
+    DWORD   getSpanColors;
+    DWORD   bar;
+    DWORD   clearDevice;
+    DWORD   copyWindow;
+    DWORD   scrollWindow;
+    DWORD   pixelsWritten;
+    DWORD   pixelsRead;
+} HOST_FB_STATS;
+
+extern HOST_FB_STATS    HostFrameBufferStats;
+
+/*********************************************************************
+* Function: void HostFrameBufferResetStats(void)
+*
+* Overview: Clears all the counters in HostFrameBufferStats.
+*
+* PreCondition: none
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void    HostFrameBufferResetStats(void);
+
+/*********************************************************************
+* Function: WORD *HostFrameBufferGetPage(WORD page)
+*
+* Overview: Returns the RGB565 pixels of the given page, row by row,
+*           DISP_HOR_RESOLUTION pixels per row.
+*
+* PreCondition: none
+*
+* Input: page - page number, 0 to HOST_FB_PAGE_COUNT - 1.
+*
+* Output: pointer to the first pixel of the page.
+*
+* Side Effects: none
+*
+********************************************************************/
+WORD    *HostFrameBufferGetPage(WORD page);
+
+/*********************************************************************
+* Function: BYTE HostFrameBufferSavePPM(const char *fileName, WORD page)
+*
+* Overview: Writes the given page to a binary PPM (P6) file. The RGB565
+*           colors are expanded to 8 bits per channel.
+*
+* PreCondition: none
+*
+* Input: fileName - name of the file to create.
+*        page - page number, 0 to HOST_FB_PAGE_COUNT - 1.
+*
+* Output: Returns 0 when the file was written, 1 otherwise.
+*
+* Side Effects: none
+*
+********************************************************************/
+BYTE    HostFrameBufferSavePPM(const char *fileName, WORD page);
+
+/*********************************************************************
+* Function: BYTE HostFrameBufferSavePNG(const char *fileName, WORD page)
+*
+* Overview: Writes the given page to a 24 bit PNG file. The RGB565 
+*           colors are expanded to 8 bits per channel. The image data is
+*           stored without compression.
+*
+* PreCondition: none
+*
+* Input: fileName - name of the file to create.
+*        page - page number, 0 to HOST_FB_PAGE_COUNT - 1.
+*
+* Output: Returns 0 when the file was written, 1 otherwise.
+*
+* Side Effects: none
+*
+********************************************************************/
+BYTE    HostFrameBufferSavePNG(const char *fileName, WORD page);
+
+#endif // _HOST_FRAME_BUFFER_H
@@ -209,6 +209,41 @@ extern BYTE _bevelDrawType;
     #define EXTERNAL_FONT_BUFFER_SIZE   600
 #endif
 
+/*********************************************************************
+* Overview: This defines the size of the buffer used to read RLE 
+*			compressed images from the external memory. The image 
+*			data is fetched in blocks of this size, so the last 
+*			read of an image may go past its end.
+*           To modify the size used, declare this macro in the 
+*           GraphicsConfig.h file with the desired size.
+*
+********************************************************************/
+#ifndef RLE_EXTERNAL_BUFFER_SIZE
+    #define RLE_EXTERNAL_BUFFER_SIZE    256
+#endif
+
+/*********************************************************************
+* Overview: When USE_GLYPH_CACHE is defined in GraphicsConfig.h, 
+*			OutChar() keeps the most recently used characters in a 
+*			cache as horizontal runs. A cached character is drawn 
+*			with one span per run and without reading the font, 
+*			which saves the glyph entry and image reads of fonts in 
+*			external memory. GFX_GLYPH_CACHE_ENTRIES sets the number 
+*			of cached characters and GFX_GLYPH_CACHE_RUNS the number 
+*			of runs each one can hold (4 bytes per run). Characters 
+*			with more runs and characters of translucent anti-aliased 
+*			fonts are rendered from the font as before.
+*
+********************************************************************/
+#ifdef USE_GLYPH_CACHE
+    #ifndef GFX_GLYPH_CACHE_ENTRIES
+        #define GFX_GLYPH_CACHE_ENTRIES 8
+    #endif
+    #ifndef GFX_GLYPH_CACHE_RUNS
+        #define GFX_GLYPH_CACHE_RUNS    64
+    #endif
+#endif
+
 /*********************************************************************
 * Overview: Memory type enumeration to determine the source of data.
 *           Used in interpreting bitmap and font from different 
@@ -883,6 +918,26 @@ WORD    OutChar(XCHAR ch);
 ********************************************************************/
 WORD    OutText(XCHAR *textString);
 
+/*********************************************************************
+* Function: void GlyphCacheFlush(void)
+*
+* Overview: This function drops all the characters kept in the glyph 
+*			cache. Characters are cached per font and character code, 
+*			the cache must be flushed when the contents of a font that 
+*			was already used are changed in place. Available only when 
+*			USE_GLYPH_CACHE is defined.
+*
+* Input: none
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+#ifdef USE_GLYPH_CACHE
+void    GlyphCacheFlush(void);
+#endif
+
 /*********************************************************************
 * Function: WORD OutTextXY(SHORT x, SHORT y, XCHAR* textString)
 *
@@ -1558,6 +1613,84 @@ WORD    BarAlpha(SHORT left, SHORT top,WORD  right, WORD bottom);
 ********************************************************************/
 void    ClearDevice(void);
 
+/*********************************************************************
+* Overview: GFX_TICKS_CALLBACK is a callback function which returns the
+*           current value of a free running 64-bit timer. It is used to
+*           pace transitions and to limit the time spent drawing.
+*********************************************************************/
+typedef QWORD (*GFX_TICKS_CALLBACK)(void);
+
+#ifdef USE_NONBLOCKING_CONFIG
+
+/*********************************************************************
+* Function: void GFXTimeSliceSourceRegister(GFX_TICKS_CALLBACK pTicksFn, 
+*                                           DWORD ticksPerSecond)
+*
+* Overview: Registers the timer used to measure the drawing time 
+*           slices (see GFXTimeSliceStart()). Without a time source the
+*           slices never expire.
+*
+* Input: pTicksFn - function returning the free running 64-bit timer 
+*                   value, NULL to disable the time slices.
+*        ticksPerSecond - number of timer ticks per second.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void    GFXTimeSliceSourceRegister(GFX_TICKS_CALLBACK pTicksFn, DWORD ticksPerSecond);
+
+/*********************************************************************
+* Function: void GFXTimeSliceStart(DWORD budget)
+*
+* Overview: Starts a drawing time slice of budget microseconds. Once 
+*           the slice has expired Bar() returns 0 after the current 
+*           span and continues with the next span when it is called 
+*           again with the same parameters, the same way as when the 
+*           device is busy. At least one span is drawn by each call.
+*
+* Input: budget - length of the slice in microseconds, 0 ends the 
+*                 current slice.
+*
+* Output: none
+*
+* Side Effects: none
+*
+********************************************************************/
+void    GFXTimeSliceStart(DWORD budget);
+
+/*********************************************************************
+* Function: BYTE GFXTimeSliceExpired(void)
+*
+* Overview: Checks if the current drawing time slice has expired.
+*
+* Input: none
+*
+* Output: Returns non-zero when a slice was started and its budget is
+*         used up.
+*
+* Side Effects: none
+*
+********************************************************************/
+BYTE    GFXTimeSliceExpired(void);
+
+/*********************************************************************
+* Function: DWORD GFXTimeSliceElapsed(void)
+*
+* Overview: Returns the time spent in the current drawing time slice.
+*
+* Input: none
+*
+* Output: Elapsed time in microseconds, 0 without a time source.
+*
+* Side Effects: none
+*
+********************************************************************/
+DWORD   GFXTimeSliceElapsed(void);
+
+#endif // USE_NONBLOCKING_CONFIG
+
 /*********************************************************************
 * Function: WORD PutImagePartial(SHORT left, SHORT top, void* image, BYTE stretch, SHORT xoffset, SHORT yoffset, WORD width, WORD height)
 *
@@ -188,6 +188,25 @@ BYTE GFXSetupTransition(SHORT left, SHORT top, SHORT right, SHORT bottom, GFX_TR
 ************************************************************************/
 BYTE GFXTransition(SHORT left, SHORT top, SHORT right, SHORT bottom, GFX_TRANSITION_TYPE type, DWORD srcpageaddr, DWORD destpageaddr, WORD delay_ms, WORD param1, WORD param2);
 
+/************************************************************************
+* Function: void GFXTransitionTimeSourceRegister(GFX_TICKS_CALLBACK pTicksFn, 
+*                                                DWORD ticksPerSecond)
+*                                                                       
+* Overview: This function registers the timer used to pace the steps of
+*           the transitions. The steps are then delay_ms apart from the
+*           start of the transition whatever time the copies take.
+*           Without a time source each step is followed by 
+*           DelayMs(delay_ms).
+*                                                                       
+* Input:    pTicksFn       -> Function returning the free running 64-bit 
+*                             timer value, NULL to use DelayMs()
+*           ticksPerSecond -> Number of timer ticks per second
+*                                                                       
+* Output:   none
+*                                                                       
+************************************************************************/
+void GFXTransitionTimeSourceRegister(GFX_TICKS_CALLBACK pTicksFn, DWORD ticksPerSecond);
+
 /************************************************************************
 * Function: WORD GFXTranslateDirection(WORD direction, WORD orientation)
 *                                                                       
@@ -39,16 +39,54 @@ Pradeep Budagutta    14-Mar-2008    First release
 /* User configuration */
 #define GIF_CRUSH_PREV_SYMBOL_PTR_TABLE     1 /* If 1, this saves 2KB of RAM but requires more time to decode */
 
+/* If 1, the LZW dictionary is kept unpacked as (prefix, first symbol, last symbol, length)
+   and every code is written as a whole string into a scanline buffer which is output one
+   row at a time. The buffer has room for the longest string after the row, so a string
+   which runs into the following rows is still expanded only once. This removes the
+   crushed table arithmetic, the per-pixel recursion and the first-symbol trace of the
+   packed mode, but needs more RAM in the decoder structure:
+       Packed mode : abSymbol 4KB + awPrevSymbolPtr 6KB (8KB if not crushed)   = 10KB
+       Flat mode   : abSymbol 4KB + abFirstSymbol 4KB + awPrevSymbolPtr 8KB
+                     + awSymbolLength 8KB + GIF_SCANLINE_BUFFER_SIZE + 4KB      = 29KB
+   GIF_CRUSH_PREV_SYMBOL_PTR_TABLE is ignored when this is 1 */
+#ifndef GIF_USE_FLAT_SYMBOL_TABLE
+    #define GIF_USE_FLAT_SYMBOL_TABLE       0
+#endif
+
+#if GIF_USE_FLAT_SYMBOL_TABLE == 1
+    #ifndef GIF_SCANLINE_BUFFER_SIZE
+        #define GIF_SCANLINE_BUFFER_SIZE    1024 /* Widest image (in pixels) that can be decoded in flat mode */
+    #endif
+#endif
+
 #ifdef IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT
     #define GIF_USE_16_BITS_PER_PIXEL           1 /* If this is 1, then 16 bits/pixel is used and hence requires 256 Bytes less RAM */
 #else
     #define GIF_USE_16_BITS_PER_PIXEL           0
 #endif
 
+#ifdef IMG_SUPPORT_GIF_ANIMATION
+    /* Disposal method 3 (restore to previous) needs the pixels under the frame to be saved
+       before the frame is drawn. They are read back with GetPixel(), so this is only possible
+       with IMG_USE_ONLY_565_GRAPHICS_DRIVER_FOR_OUTPUT. Frames needing more pixels than the
+       buffer holds (or if set to 0) are restored to the background color instead.
+       Takes GIF_ANIMATION_SAVE_BUFFER_SIZE * 2 bytes of RAM */
+    #define GIF_ANIMATION_SAVE_BUFFER_SIZE  (32 * 32)
+#endif
+
 /* User configuration */
 
 /* Function prototype */
 /* This function must be called after setting proper values in the global variables of ImageDecoder.c */
 BYTE GIF_bDecode(IMG_FILE *pFile);
 
+#ifdef IMG_SUPPORT_GIF_ANIMATION
+/* Draws the next frame of the animation started by GIF_bDecode() when it is due.
+   Returns '1' if no animation is being played, '0' otherwise */
+BYTE GIF_bAnimationTask(void);
+
+/* Stops the animation being played */
+void GIF_vAnimationStop(void);
+#endif
+
 #endif
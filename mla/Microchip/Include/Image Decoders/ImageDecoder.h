@@ -106,6 +106,13 @@ typedef void (*IMG_PIXEL_OUTPUT)(IMG_PIXEL_XY_RGB_888 *pPix);
 *********************************************************************/
 typedef void (*IMG_LOOP_CALLBACK)(void);
 
+/*********************************************************************
+* Overview: IMG_TicksCallback is a callback function which returns the
+*           current value of a free running 64-bit timer. It is used to
+*           pace the frames of animated images
+*********************************************************************/
+typedef QWORD (*IMG_TICKS_CALLBACK)(void);
+
 /* The global variables which define the image position and size */
 #ifndef __IMAGEDECODER_C__
   extern BYTE IMG_blAbortImageDecoding;
@@ -130,6 +137,11 @@ typedef void (*IMG_LOOP_CALLBACK)(void);
  #ifdef IMG_SUPPORT_IMAGE_DECODER_LOOP_CALLBACK
   extern IMG_LOOP_CALLBACK  IMG_pLoopCallbackFn;
  #endif
+
+ #ifdef IMG_SUPPORT_GIF_ANIMATION
+  extern IMG_TICKS_CALLBACK IMG_pTicksFn;
+  extern DWORD IMG_dwTicksPerSecond;
+ #endif
 #endif
 
 #ifdef IMG_USE_ONLY_MDD_FILE_SYSTEM_FOR_INPUT
@@ -279,6 +291,44 @@ void ImageDecoderInit(void);
 ********************************************************************/
 void ImageLoopCallbackRegister(IMG_LOOP_CALLBACK pFn);
 
+/*********************************************************************
+* Function: void ImageTimeSourceRegister(IMG_TICKS_CALLBACK pTicksFn, DWORD dwTicksPerSecond)
+*
+* Overview: This function registers the time source used to pace the
+*           frames of animated images. If no time source is registered,
+*           every call of ImageDecodeTask() draws the next frame.
+*           Only available if IMG_SUPPORT_GIF_ANIMATION is defined.
+*
+* Input: pTicksFn         -> Function returning the free running 64-bit timer value
+*        dwTicksPerSecond -> Number of timer ticks per second
+*
+* Output: None
+*
+* Example:
+*   <PRE> 
+*   QWORD GetTicks(void)
+*   {
+*       return TimerGetTicks64().value;
+*   }
+*
+*	void main(void)
+*	{
+*		ImageDecoderInit();
+*       ImageTimeSourceRegister(GetTicks, TIMER_TICKS_PER_SECOND);
+*       ImageDecode(pImageFile, IMG_GIF, 0, 0, 64, 64, 0, NULL, NULL);
+*       while(1)
+*       {
+*           ImageDecodeTask();
+*           <- Other tasks ->
+*       }
+*	}
+*	</PRE> 
+*
+* Side Effects: None
+*
+********************************************************************/
+void ImageTimeSourceRegister(IMG_TICKS_CALLBACK pTicksFn, DWORD dwTicksPerSecond);
+
 /*********************************************************************
 * Function: BYTE ImageDecode(IMG_FILE *pImageFile, IMG_FILE_FORMAT eImgFormat, WORD wStartx, WORD wStarty, WORD wWidth, WORD wHeight, WORD wFlags, IMG_FILE_SYSTEM_API *pFileAPIs, IMG_PIXEL_OUTPUT pPixelOutput)
 *
@@ -373,7 +423,11 @@ BYTE ImageDecode(IMG_FILE *pImageFile, IMG_FILE_FORMAT eImgFormat,
 /*********************************************************************
 * Function: BYTE ImageDecodeTask(void)
 *
-* Overview: This function completes one small part of the image decode function
+* Overview: This function completes one small part of the image decode function.
+*           If IMG_SUPPORT_GIF_ANIMATION is defined and an animated GIF is
+*           playing, the next frame is drawn once its delay has elapsed.
+*           The image file must be kept open until this returns '1'.
+*           ImageAbort() stops the animation.
 *
 * Input: None
 *
@@ -44,6 +44,13 @@ Pradeep Budagutta    03-Mar-2008    First release
 #define MAX_HUFF_TABLES   2 /* Each causes 2 tables -> One for AC and another for DC - DONT REDUCE THIS */
 #define MAX_DATA_BUF_LEN  128 /* Increase if you have more data memory */
 
+/* With IMG_USE_NON_BLOCKING_DECODING, each call of ImageDecodeTask() decodes and displays at most this
+   many MCUs (8x8 to 16x16 pixels each), which bounds the time spent in one call. It can be defined
+   in ImageDecoderConfig.h */
+#ifndef JPEG_MCUS_PER_CALL
+#define JPEG_MCUS_PER_CALL  1
+#endif
+
 /* Error list */
 enum Errors
 {
@@ -54,6 +61,7 @@ enum Errors
 enum Markers
 {
      SOF0 = 0xC0,
+     SOF2 = 0xC2,
      DHT  = 0xC4,
      SOI  = 0xD8,
      EOI  = 0xD9,
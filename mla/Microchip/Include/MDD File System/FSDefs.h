@@ -555,4 +555,49 @@ typedef enum
 } MEDIA_ERRORS;                
 
 
+//Definition for a structure used when calling the asynchronous read and write
+//tasks functions of a physical layer (ex: MDD_SDSPI_AsyncReadTasks() or
+//MDD_SDSPI_AsyncWriteTasks()).
+typedef struct
+{
+    WORD wNumBytes;         //Number of bytes to attempt to read or write in the next call to the read or write tasks function.  May be updated between calls to the handler.
+    DWORD dwBytesRemaining; //Should be initialized to the total number of bytes that you wish to read or write.  This value is allowed to be greater than a single block size of the media.
+    BYTE* pBuffer;          //Pointer to where the read/written bytes should be copied to/from.  May be updated between calls to the handler function.
+    DWORD dwAddress;        //Starting block address to read or to write to on the media.  Should only get initialized, do not modify after that.
+    BYTE bStateVariable;    //State machine variable.  Should get initialized to ASYNC_READ_QUEUED or ASYNC_WRITE_QUEUED to start an operation.  After that, do not modify until the read or write is complete.
+}ASYNC_IO;   
+
+
+//Response codes for the asynchronous read tasks functions.
+#define ASYNC_READ_COMPLETE             0x00
+#define ASYNC_READ_BUSY                 0x01
+#define ASYNC_READ_NEW_PACKET_READY     0x02
+#define ASYNC_READ_ERROR                0xFF
+
+//Read state machine variable values.  Other than ASYNC_READ_QUEUED, these are
+//used internally by the physical layer.
+#define ASYNC_READ_COMPLETE             0x00
+#define ASYNC_READ_QUEUED               0x01    //Initialize to this to start a read sequence
+#define ASYNC_READ_WAIT_START_TOKEN     0x03
+#define ASYNC_READ_NEW_PACKET_READY     0x02
+#define ASYNC_READ_ABORT                0xFE
+#define ASYNC_READ_ERROR                0xFF
+
+//Possible return values when calling an asynchronous write tasks function
+#define ASYNC_WRITE_COMPLETE        0x00
+#define ASYNC_WRITE_SEND_PACKET     0x02
+#define ASYNC_WRITE_BUSY            0x03
+#define ASYNC_WRITE_ERROR           0xFF
+
+//Write state machine variable values.  Other than ASYNC_WRITE_QUEUED, these are
+//used internally by the physical layer.
+#define ASYNC_WRITE_COMPLETE            0x00
+#define ASYNC_WRITE_QUEUED              0x01    //Initialize to this to start a write sequence
+#define ASYNC_WRITE_TRANSMIT_PACKET     0x02
+#define ASYNC_WRITE_MEDIA_BUSY          0x03
+#define ASYNC_STOP_TOKEN_SENT_WAIT_BUSY 0x04
+#define ASYNC_WRITE_ABORT               0xFE
+#define ASYNC_WRITE_ERROR               0xFF
+
+
 #endif
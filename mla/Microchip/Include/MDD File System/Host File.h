@@ -0,0 +1,65 @@
+/******************************************************************************
+
+                Microchip Memory Disk Drive File System
+
+ *****************************************************************************
+  FileName:        Host File.h
+  Dependencies:    See includes section.
+  Processor:       Host (Linux, Windows)
+  Compiler:        GCC
+  Company:         Microchip Technology, Inc.
+
+  Software License Agreement
+
+  The software supplied herewith by Microchip Technology Incorporated
+  (the "Company") for its PICmicro(R) Microcontroller is intended and
+  supplied to you, the Company's customer, for use solely and
+  exclusively on Microchip PICmicro Microcontroller products. The
+  software is owned by the Company and/or its supplier, and is
+  protected under applicable copyright laws. All rights are reserved.
+  Any use in violation of the foregoing restrictions may subject the
+  user to criminal sanctions under applicable laws, as well as to
+  civil liability for the breach of the terms and conditions of this
+  license.
+
+  THIS SOFTWARE IS PROVIDED IN AN "AS IS" CONDITION. NO WARRANTIES,
+  WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+  TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+  PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+  IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+  CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+
+*****************************************************************************/
+
+#ifndef _HOST_FILE_H_
+#define _HOST_FILE_H_
+
+#include "GenericTypeDefs.h"
+#include "FSconfig.h"
+#include "MDD File System/FSDefs.h"
+
+/*****************************************************************************/
+/*                                 Public Prototypes                         */
+/*****************************************************************************/
+
+//Physical layer that keeps the media in a disk image file on a development
+//host.  Sector reads and writes, and the asynchronous tasks functions used by
+//usb_function_msd_multi_sector.c, behave like the SD-SPI ones, so the
+//libraries that use them can be run and profiled without the target hardware.
+BOOL MDD_HostFile_Open(const char* path, BOOL writeProtect);
+void MDD_HostFile_Close(void);
+void MDD_HostFile_SetLatency(WORD busyCalls);
+
+BYTE MDD_HostFile_MediaDetect(void);
+MEDIA_INFORMATION * MDD_HostFile_MediaInitialize(void);
+DWORD MDD_HostFile_ReadCapacity(void);
+WORD MDD_HostFile_ReadSectorSize(void);
+BYTE MDD_HostFile_InitIO(void);
+BYTE MDD_HostFile_SectorRead(DWORD sector_addr, BYTE* buffer);
+BYTE MDD_HostFile_SectorWrite(DWORD sector_addr, BYTE* buffer, BYTE allowWriteToZero);
+BYTE MDD_HostFile_AsyncReadTasks(ASYNC_IO* info);
+BYTE MDD_HostFile_AsyncWriteTasks(ASYNC_IO* info);
+BYTE MDD_HostFile_WriteProtectState(void);
+BYTE MDD_HostFile_ShutdownMedia(void);
+
+#endif
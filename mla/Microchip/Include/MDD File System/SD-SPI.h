@@ -473,48 +473,6 @@ typedef enum
 #define SD_MODE_HC      1
 
 
-//Definition for a structure used when calling either MDD_SDSPI_AsyncReadTasks() 
-//function, or the MDD_SDSPI_AsyncWriteTasks() function.
-typedef struct
-{
-    WORD wNumBytes;         //Number of bytes to attempt to read or write in the next call to MDD_SDSPI_AsyncReadTasks() or MDD_SDSPI_AsyncWriteTasks.  May be updated between calls to the handler.
-    DWORD dwBytesRemaining; //Should be initialized to the total number of bytes that you wish to read or write.  This value is allowed to be greater than a single block size of the media.
-    BYTE* pBuffer;          //Pointer to where the read/written bytes should be copied to/from.  May be updated between calls to the handler function.
-    DWORD dwAddress;        //Starting block address to read or to write to on the media.  Should only get initialized, do not modify after that.
-    BYTE bStateVariable;    //State machine variable.  Should get initialized to ASYNC_READ_QUEUED or ASYNC_WRITE_QUEUED to start an operation.  After that, do not modify until the read or write is complete.
-}ASYNC_IO;   
-
-
-//Response codes for the MDD_SDSPI_AsyncReadTasks() function.
-#define ASYNC_READ_COMPLETE             0x00
-#define ASYNC_READ_BUSY                 0x01
-#define ASYNC_READ_NEW_PACKET_READY     0x02
-#define ASYNC_READ_ERROR                0xFF
-
-//MDD_SDSPI_AsyncReadTasks() state machine variable values.  These are used internally to SD-SPI.c.
-#define ASYNC_READ_COMPLETE             0x00
-#define ASYNC_READ_QUEUED               0x01    //Initialize to this to start a read sequence
-#define ASYNC_READ_WAIT_START_TOKEN     0x03
-#define ASYNC_READ_NEW_PACKET_READY     0x02
-#define ASYNC_READ_ABORT                0xFE
-#define ASYNC_READ_ERROR                0xFF
-
-//Possible return values when calling MDD_SDSPI_AsyncWriteTasks()
-#define ASYNC_WRITE_COMPLETE        0x00
-#define ASYNC_WRITE_SEND_PACKET     0x02
-#define ASYNC_WRITE_BUSY            0x03
-#define ASYNC_WRITE_ERROR           0xFF
-
-//MDD_SDSPI_AsyncWriteTasks() state machine variable values.  These are used internally to SD-SPI.c.
-#define ASYNC_WRITE_COMPLETE            0x00
-#define ASYNC_WRITE_QUEUED              0x01    //Initialize to this to start a write sequence
-#define ASYNC_WRITE_TRANSMIT_PACKET     0x02
-#define ASYNC_WRITE_MEDIA_BUSY          0x03
-#define ASYNC_STOP_TOKEN_SENT_WAIT_BUSY 0x04
-#define ASYNC_WRITE_ABORT               0xFE
-#define ASYNC_WRITE_ERROR               0xFF
-
-
 //Constants
 #define MEDIA_BLOCK_SIZE            512u  //Should always be 512 for v1 and v2 devices.
 #define WRITE_RESPONSE_TOKEN_MASK   0x1F  //Bit mask to AND with the write token response byte from the media, to clear the don't care bits.
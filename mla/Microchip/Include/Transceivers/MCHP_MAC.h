@@ -155,6 +155,9 @@
             BOOL        altSourceAddress;               // Source address is the alternative network address
             WORD_VAL    SourcePANID;                    // PAN ID of the sender
         #endif
+        #if defined(ENABLE_CLOCK_SYNC)
+            DWORD       Timestamp;                      // MiWi_HighResTickGet() at the receive interrupt
+        #endif
     } MAC_RECEIVED_PACKET;
         
     /***************************************************************************
@@ -182,6 +185,45 @@
     
     extern MAC_RECEIVED_PACKET  MACRxPacket;
     
+    #if defined(ENABLE_CLOCK_SYNC)
+        #if !defined(MRF24J40)
+            #error "ENABLE_CLOCK_SYNC requires the MRF24J40 transceiver"
+        #endif
+        
+        /************************************************************************************
+         * Function:
+         *      BOOL MiMAC_GetTxTimestamp(DWORD *pTimestamp)
+         *
+         * Summary:
+         *      This function returns the timestamp of the last frame sent
+         *
+         * Description:        
+         *      This function waits for the transmission started by the last call
+         *      of MiMAC_SendPacket to complete, and returns MiWi_HighResTickGet()
+         *      taken in the transmit interrupt.
+         *
+         * PreCondition:    
+         *      A frame has been sent with MiMAC_SendPacket. 
+         *
+         * Parameters: 
+         *      DWORD *pTimestamp - Returns the timestamp of the end of the frame
+         *
+         * Returns: 
+         *      TRUE if the timestamp belongs to the last frame, FALSE if the 
+         *      transmission did not complete.
+         *
+         * Example:
+         *      <code>
+         *      MiMAC_GetTxTimestamp(&txTimestamp);
+         *      </code>
+         *
+         * Remarks:    
+         *      None
+         *
+         *****************************************************************************************/       
+        BOOL MiMAC_GetTxTimestamp(DWORD *pTimestamp);
+    #endif
+    
     /************************************************************************************
      * Function:
      *      BOOL MiMAC_SetChannel(BYTE channel, BYTE offsetFreq)
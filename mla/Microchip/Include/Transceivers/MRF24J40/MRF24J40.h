@@ -111,6 +111,10 @@
         #define RX_PACKET_SIZE 127
     #endif
 
+    // header length, packet length, frame control, sequence number, two
+    // PAN IDs, two long addresses and the security auxiliary header
+    #define TX_HEADER_SIZE  30
+
     //long address registers
     #define RFCTRL0 (0x200)
     #define RFCTRL1 (0x201)
@@ -81,12 +81,18 @@
   ----   -----------
   2.6    Initial Release
 
+  2.9j   Added the isochronous streaming engine, enabled with
+         USB_AUDIO_STREAM_OUT_EP and/or USB_AUDIO_STREAM_IN_EP.
+
 ********************************************************************/
 
 #ifndef AUDIO_H
 	#define AUDIO_H
 
 /** I N C L U D E S *******************************************************/
+#if defined(USB_AUDIO_STREAM_OUT_EP) || defined(USB_AUDIO_STREAM_IN_EP)
+    #include "USB/usb_function_audio_stream.h"
+#endif
 
 
 /** DEFINITIONS ****************************************************/
@@ -261,4 +267,158 @@ extern volatile BYTE CtrlTrfData[USB_EP0_BUFF_SIZE];
   
  *******************************************************************/
 void USBCheckAudioRequest(void);
+
+#if defined(USB_AUDIO_STREAM_OUT_EP) || defined(USB_AUDIO_STREAM_IN_EP)
+/******************************************************************************
+    Section: Isochronous streaming engine
+
+    Defining USB_AUDIO_STREAM_OUT_EP (samples from the host) and/or
+    USB_AUDIO_STREAM_IN_EP (samples to the host) in usb_config.h adds an
+    isochronous streaming engine to the driver.  Each endpoint keeps two
+    packets armed, on the even and odd buffer descriptors, and moves the
+    samples to or from a FIFO of whole sample frames.  The audio hardware
+    reads the OUT FIFO with USBAudioStreamRead() and fills the IN FIFO with
+    USBAudioStreamWrite().
+
+    The engine measures the Start-of-Frame period against a local 64-bit
+    timer, read with USB_AUDIO_STREAM_TIMESTAMP(), that must run from the
+    same master clock as the audio samples.  This gives the number of
+    samples the audio hardware uses per USB frame:
+        - Defining USB_AUDIO_FEEDBACK_EP adds an asynchronous feedback
+          endpoint for the OUT stream.  Every 2^USB_AUDIO_FEEDBACK_REFRESH
+          frames it sends the measured rate, corrected to keep the OUT FIFO
+          half full, so the host sends the samples at the rate the hardware
+          plays them.
+        - The IN stream sends the measured number of samples per frame,
+          corrected to keep the IN FIFO half full.
+
+    The following must also be defined in usb_config.h:
+        USB_AUDIO_STREAM_FRAME_BYTES - Bytes per sample frame (all channels)
+        USB_AUDIO_STREAM_MAX_PACKET  - wMaxPacketSize of the stream endpoints,
+                                       at most 255.  It must hold one sample
+                                       frame more than the nominal rate.
+        USB_AUDIO_STREAM_TIMESTAMP() - Returns the local timer as a QWORD
+
+    USB_AUDIO_FEEDBACK_REFRESH is the bRefresh value of the feedback
+    endpoint descriptor, 3 (8 ms) by default.  The engine needs 64-bit
+    integers, so it is not available on PIC18 devices.
+ *****************************************************************************/
+
+#ifndef USB_AUDIO_FEEDBACK_REFRESH
+    #define USB_AUDIO_FEEDBACK_REFRESH  3
+#endif
+
+/********************************************************************
+    Function:
+        void USBAudioStreamInit(BYTE *outFifo, WORD outFrames, BYTE *inFifo,
+                                WORD inFrames, DWORD sampleRate, QWORD timerHz)
+
+    Summary:
+        Starts the isochronous streaming engine.
+
+    Description:
+        Enables the stream endpoints, arms the OUT endpoint and starts
+        measuring the sample rate.  It is normally called when the host
+        selects the alternate setting of the streaming interface that has
+        the isochronous endpoints.
+
+    PreCondition:
+        The device is configured.
+
+    Parameters:
+        BYTE *outFifo    - Storage for the OUT FIFO, outFrames sample frames
+        WORD outFrames   - Capacity of the OUT FIFO in sample frames
+        BYTE *inFifo     - Storage for the IN FIFO, inFrames sample frames
+        WORD inFrames    - Capacity of the IN FIFO in sample frames
+        DWORD sampleRate - Sample rate in Hz
+        QWORD timerHz    - Frequency of the local timer
+
+    Return Values:
+        None
+
+    Remarks:
+        The FIFO parameters of a direction that is not enabled are ignored.
+        The FIFOs should hold several USB frames of samples.
+ *******************************************************************/
+void USBAudioStreamInit(BYTE *outFifo, WORD outFrames, BYTE *inFifo, WORD inFrames, DWORD sampleRate, QWORD timerHz);
+
+/********************************************************************
+    Function:
+        void USBAudioStreamSOFHandler(void)
+
+    Summary:
+        Moves the stream packets at each Start-of-Frame.
+
+    Description:
+        Timestamps the Start-of-Frame, moves the received OUT packets into
+        the OUT FIFO and re-arms them, prepares the next IN packet and sends
+        the feedback value when it is due.
+
+    PreCondition:
+        USBAudioStreamInit() has been called.
+
+    Parameters:
+        None
+
+    Return Values:
+        None
+
+    Remarks:
+        Call this function from the EVENT_SOF case of the
+        USER_USB_CALLBACK_EVENT_HANDLER() function.
+ *******************************************************************/
+void USBAudioStreamSOFHandler(void);
+
+/********************************************************************
+    Function:
+        WORD USBAudioStreamRead(BYTE *data, WORD frames)
+
+    Summary:
+        Reads sample frames received from the host.
+
+    Description:
+        Copies up to the requested number of sample frames out of the OUT
+        FIFO.
+
+    PreCondition:
+        USBAudioStreamInit() has been called.
+
+    Parameters:
+        BYTE *data  - Buffer for the sample frames
+        WORD frames - Number of sample frames requested
+
+    Return Values:
+        WORD - Number of sample frames copied
+
+    Remarks:
+        Only available when USB_AUDIO_STREAM_OUT_EP is defined.
+ *******************************************************************/
+WORD USBAudioStreamRead(BYTE *data, WORD frames);
+
+/********************************************************************
+    Function:
+        WORD USBAudioStreamWrite(BYTE *data, WORD frames)
+
+    Summary:
+        Queues sample frames to send to the host.
+
+    Description:
+        Copies as many of the sample frames as fit into the IN FIFO.
+
+    PreCondition:
+        USBAudioStreamInit() has been called.
+
+    Parameters:
+        BYTE *data  - Sample frames
+        WORD frames - Number of sample frames
+
+    Return Values:
+        WORD - Number of sample frames copied
+
+    Remarks:
+        Only available when USB_AUDIO_STREAM_IN_EP is defined.
+ *******************************************************************/
+WORD USBAudioStreamWrite(BYTE *data, WORD frames);
+#endif
+
 #endif //AUDIO_H
@@ -0,0 +1,338 @@
+/*******************************************************************************
+  File Information:
+    FileName:     	usb_function_audio_stream.h
+    Dependencies:	See INCLUDES section
+    Processor:		PIC24 or PIC32
+    Complier:  		C30 or C32
+    Company:		Microchip Technology, Inc.
+
+    Software License Agreement:
+
+    The software supplied herewith by Microchip Technology Incorporated
+    (the "Company") for its PIC(R) Microcontroller is intended and
+    supplied to you, the Company's customer, for use solely and
+    exclusively on Microchip PIC Microcontroller products. The
+    software is owned by the Company and/or its supplier, and is
+    protected under applicable copyright laws. All rights are reserved.
+    Any use in violation of the foregoing restrictions may subject the
+    user to criminal sanctions under applicable laws, as well as to
+    civil liability for the breach of the terms and conditions of this
+    license.
+
+    THIS SOFTWARE IS PROVIDED IN AN "AS IS" CONDITION. NO WARRANTIES,
+    WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+    TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+    IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+    CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+
+  Summary:
+    This file contains the sample FIFO and the feedback calculations used by
+    the isochronous streaming engine of the USB Device Audio function driver.
+
+  Description:
+    USB Device Audio Streaming FIFO and Feedback File
+
+    The sample FIFO holds whole sample frames (one sample of every channel).
+    The feedback calculations measure the Start-of-Frame period against a
+    local 64-bit timer that runs from the same master clock as the audio
+    samples, and convert it to the number of samples per USB frame, in the
+    10.14 format used by the asynchronous feedback endpoint.
+
+    This file only depends on GenericTypeDefs.h, so the calculations can be
+    compiled and checked on a development host.
+
+    This file is located in the "\<Install Directory\>\\Microchip\\Include\\USB"
+    directory.
+*******************************************************************/
+
+/********************************************************************
+ Change History:
+  Rev    Description
+  ----   -----------
+  2.9j   Initial Release
+
+********************************************************************/
+
+#ifndef AUDIO_STREAM_H
+	#define AUDIO_STREAM_H
+
+/** I N C L U D E S *******************************************************/
+#include "GenericTypeDefs.h"
+
+/** DEFINITIONS ****************************************************/
+
+// Number of fraction bits of the feedback value (10.14 format).
+#define USB_AUDIO_FEEDBACK_FRACTION_BITS    14
+
+// Number of USB frames per second at full speed.
+#define USB_AUDIO_FRAMES_PER_SECOND         1000
+
+// The FIFO correction added to the feedback value makes up the difference
+// between the FIFO level and its target over 2^n frames.  The value must
+// not be more than 14.
+#ifndef USB_AUDIO_FEEDBACK_GAIN_SHIFT
+    #define USB_AUDIO_FEEDBACK_GAIN_SHIFT   6
+#endif
+
+/** T Y P E S ****************************************************************/
+
+// Sample frame FIFO.  All counts and positions are in sample frames.
+typedef struct _USB_AUDIO_FIFO
+{
+    BYTE    *buffer;        // Storage for size sample frames.
+    WORD    size;           // Capacity in sample frames.
+    WORD    head;           // Position of the next frame written.
+    WORD    tail;           // Position of the next frame read.
+    WORD    count;          // Number of frames in the FIFO.
+    BYTE    frameBytes;     // Bytes per sample frame.
+    WORD    overruns;       // Number of frames dropped because the FIFO was full.
+    WORD    underruns;      // Number of frames requested while the FIFO was empty.
+} USB_AUDIO_FIFO;
+
+// Sample rate estimate and feedback state.  The rates are in samples per USB
+// frame, in 10.14 format.
+typedef struct _USB_AUDIO_FEEDBACK
+{
+    QWORD   timerHz;        // Frequency of the local timer.
+    QWORD   windowStart;    // Timer value at the first SOF of the window.
+    DWORD   sampleRate;     // Sample rate in Hz.
+    DWORD   nominal;        // Nominal samples per frame.
+    DWORD   estimate;       // Measured samples per frame.
+    DWORD   accumulator;    // Fraction of a sample carried to the next IN packet.
+    WORD    frames;         // Number of SOFs in the window so far.
+    BYTE    refresh;        // The window is 2^refresh frames (bRefresh).
+    BYTE    started;        // A SOF has been timestamped.
+} USB_AUDIO_FEEDBACK;
+
+/** F U N C T I O N S ********************************************************/
+
+/********************************************************************
+    Function:
+        void USBAudioFifoInit(USB_AUDIO_FIFO *fifo, BYTE *buffer,
+                              WORD frames, BYTE frameBytes)
+
+    Summary:
+        Initializes an empty sample frame FIFO.
+
+    Description:
+        Initializes an empty sample frame FIFO.
+
+    PreCondition:
+        None
+
+    Parameters:
+        USB_AUDIO_FIFO *fifo - FIFO to initialize
+        BYTE *buffer         - Storage of frames * frameBytes bytes
+        WORD frames          - Capacity in sample frames
+        BYTE frameBytes      - Bytes per sample frame
+
+    Return Values:
+        None
+
+    Remarks:
+        None
+ *******************************************************************/
+void USBAudioFifoInit(USB_AUDIO_FIFO *fifo, BYTE *buffer, WORD frames, BYTE frameBytes);
+
+/********************************************************************
+    Function:
+        WORD USBAudioFifoWrite(USB_AUDIO_FIFO *fifo, BYTE *data, WORD frames)
+
+    Summary:
+        Copies sample frames into the FIFO.
+
+    Description:
+        Copies as many of the sample frames as fit into the FIFO.  The
+        frames that do not fit are counted in fifo->overruns.
+
+    PreCondition:
+        USBAudioFifoInit() has been called.
+
+    Parameters:
+        USB_AUDIO_FIFO *fifo - FIFO
+        BYTE *data           - Sample frames
+        WORD frames          - Number of sample frames
+
+    Return Values:
+        WORD - Number of sample frames copied
+
+    Remarks:
+        None
+ *******************************************************************/
+WORD USBAudioFifoWrite(USB_AUDIO_FIFO *fifo, BYTE *data, WORD frames);
+
+/********************************************************************
+    Function:
+        WORD USBAudioFifoRead(USB_AUDIO_FIFO *fifo, BYTE *data, WORD frames)
+
+    Summary:
+        Copies sample frames out of the FIFO.
+
+    Description:
+        Copies up to the requested number of sample frames out of the FIFO.
+        The frames that were not available are counted in fifo->underruns.
+
+    PreCondition:
+        USBAudioFifoInit() has been called.
+
+    Parameters:
+        USB_AUDIO_FIFO *fifo - FIFO
+        BYTE *data           - Buffer for the sample frames
+        WORD frames          - Number of sample frames requested
+
+    Return Values:
+        WORD - Number of sample frames copied
+
+    Remarks:
+        None
+ *******************************************************************/
+WORD USBAudioFifoRead(USB_AUDIO_FIFO *fifo, BYTE *data, WORD frames);
+
+/********************************************************************
+    Function:
+        WORD USBAudioFifoCount(USB_AUDIO_FIFO *fifo)
+
+    Summary:
+        Returns the number of sample frames in the FIFO.
+
+    Description:
+        Returns the number of sample frames in the FIFO.
+
+    PreCondition:
+        USBAudioFifoInit() has been called.
+
+    Parameters:
+        USB_AUDIO_FIFO *fifo - FIFO
+
+    Return Values:
+        WORD - Number of sample frames in the FIFO
+
+    Remarks:
+        None
+ *******************************************************************/
+#define USBAudioFifoCount(fifo)     ((fifo)->count)
+
+/********************************************************************
+    Function:
+        void USBAudioFeedbackInit(USB_AUDIO_FEEDBACK *fb, DWORD sampleRate,
+                                  QWORD timerHz, BYTE refresh)
+
+    Summary:
+        Initializes the sample rate estimate.
+
+    Description:
+        Initializes the sample rate estimate to the nominal number of
+        samples per USB frame.
+
+    PreCondition:
+        None
+
+    Parameters:
+        USB_AUDIO_FEEDBACK *fb - Feedback state to initialize
+        DWORD sampleRate       - Sample rate in Hz
+        QWORD timerHz          - Frequency of the local timer
+        BYTE refresh           - The rate is measured over 2^refresh frames.
+                                 Use the bRefresh value of the feedback
+                                 endpoint descriptor.
+
+    Return Values:
+        None
+
+    Remarks:
+        None
+ *******************************************************************/
+void USBAudioFeedbackInit(USB_AUDIO_FEEDBACK *fb, DWORD sampleRate, QWORD timerHz, BYTE refresh);
+
+/********************************************************************
+    Function:
+        BOOL USBAudioFeedbackSOF(USB_AUDIO_FEEDBACK *fb, QWORD timestamp)
+
+    Summary:
+        Updates the sample rate estimate with the time of a Start-of-Frame.
+
+    Description:
+        Records the local timer value at a Start-of-Frame.  Every 2^refresh
+        frames, the number of samples per USB frame is measured from the
+        time the window took.  Since the local timer runs from the master
+        clock, this is the rate at which the audio hardware consumes or
+        produces samples, measured in USB frames.
+
+    PreCondition:
+        USBAudioFeedbackInit() has been called.
+
+    Parameters:
+        USB_AUDIO_FEEDBACK *fb - Feedback state
+        QWORD timestamp        - Local timer value at the Start-of-Frame
+
+    Return Values:
+        TRUE  - A window ended, and a new feedback value should be sent
+        FALSE - Otherwise
+
+    Remarks:
+        A measurement more than 1/64 off the nominal rate, which happens
+        when Start-of-Frames were missed, is ignored.
+ *******************************************************************/
+BOOL USBAudioFeedbackSOF(USB_AUDIO_FEEDBACK *fb, QWORD timestamp);
+
+/********************************************************************
+    Function:
+        DWORD USBAudioFeedbackValue(USB_AUDIO_FEEDBACK *fb, WORD level,
+                                    WORD target)
+
+    Summary:
+        Returns the value to send on the feedback endpoint.
+
+    Description:
+        Returns the measured samples per frame, plus a correction that
+        moves the level of the OUT FIFO toward its target over
+        2^USB_AUDIO_FEEDBACK_GAIN_SHIFT frames.  The value is kept within
+        one sample of the nominal rate.
+
+    PreCondition:
+        USBAudioFeedbackInit() has been called.
+
+    Parameters:
+        USB_AUDIO_FEEDBACK *fb - Feedback state
+        WORD level             - Sample frames in the OUT FIFO
+        WORD target            - Sample frames the OUT FIFO should hold
+
+    Return Values:
+        DWORD - Samples per frame in 10.14 format
+
+    Remarks:
+        None
+ *******************************************************************/
+DWORD USBAudioFeedbackValue(USB_AUDIO_FEEDBACK *fb, WORD level, WORD target);
+
+/********************************************************************
+    Function:
+        WORD USBAudioFeedbackFrameSamples(USB_AUDIO_FEEDBACK *fb, WORD level,
+                                          WORD target)
+
+    Summary:
+        Returns the number of sample frames to send in the next IN packet.
+
+    Description:
+        Adds the measured samples per frame to a fraction carried from the
+        previous packets, and returns the whole number of samples.  One
+        sample more is sent when the IN FIFO is more than a packet above its
+        target, and one less when it is more than a packet below it.
+
+    PreCondition:
+        USBAudioFeedbackInit() has been called.
+
+    Parameters:
+        USB_AUDIO_FEEDBACK *fb - Feedback state
+        WORD level             - Sample frames in the IN FIFO
+        WORD target            - Sample frames the IN FIFO should hold
+
+    Return Values:
+        WORD - Number of sample frames
+
+    Remarks:
+        None
+ *******************************************************************/
+WORD USBAudioFeedbackFrameSamples(USB_AUDIO_FEEDBACK *fb, WORD level, WORD target);
+
+#endif //AUDIO_STREAM_H
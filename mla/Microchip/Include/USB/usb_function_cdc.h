@@ -97,6 +97,9 @@
          structure definitions useful when sending serial state
          notifications over the CDC interrupt endpoint.
 
+  2.9j   Added the optional TX and RX packet rings, enabled with
+         USB_CDC_TX_RING_PACKETS and USB_CDC_RX_RING_PACKETS.
+
 ********************************************************************/
 
 #ifndef CDC_H
@@ -584,6 +587,274 @@
     cdc_trf_state = CDC_TX_BUSY;    \
 }
 
+#if defined(USB_CDC_TX_RING_PACKETS)
+    //With the TX ring, the data is copied into the ring right away, so the
+    //application may reuse its buffer as soon as the macro returns.
+    #undef mUSBUSARTTxRam
+    #undef mUSBUSARTTxRom
+    #define mUSBUSARTTxRam(pData,len)   CDCTxWrite((BYTE*)(pData),(len))
+    #define mUSBUSARTTxRom(pData,len)   CDCTxWriteROM((const ROM BYTE*)(pData),(len))
+#endif
+
+/******************************************************************************
+    Section: CDC TX and RX rings
+
+    Defining USB_CDC_TX_RING_PACKETS in usb_config.h replaces the single bulk
+    IN buffer with a ring of that many packet buffers.  CDCTxService() keeps
+    both the even and odd BDTs of the endpoint busy, coalesces small writes
+    into full packets while the host is reading, and sends the zero length
+    packet that ends a transfer when the last packet was full size.  Data
+    can be written with CDCTxWrite() at any time, or built directly in the
+    packet buffers with CDCTxReserve() and CDCTxCommit().
+
+    Defining USB_CDC_RX_RING_PACKETS does the same for the bulk OUT
+    endpoint: the host can send that many packets before the application
+    reads them with CDCRxRead(), or in place with CDCRxPeek() and
+    CDCRxRelease().
+
+    Both values must be at least 2 and the TX ring must hold at least 255
+    bytes.  putUSBUSART(), putsUSBUSART(), putrsUSBUSART() and getsUSBUSART()
+    keep working and use the rings.  USBUSARTIsTxTrfReady() returns TRUE
+    while the TX ring has room for 255 bytes.  The endpoints should use
+    ping-pong buffering (USB_PING_PONG__FULL_PING_PONG) for full throughput.
+    With C18, the rings are placed in the same USB RAM section as the single
+    buffers they replace.  The rings are not supported with XC8 on PIC18 and
+    PIC16 devices that place the CDC buffers at fixed USB RAM addresses.
+ *****************************************************************************/
+
+/******************************************************************************
+    Function:
+        WORD CDCTxGetFreeSpace(void)
+
+    Summary:
+        Returns the number of bytes that can be queued in the CDC TX ring.
+
+    Description:
+        Returns the number of bytes that CDCTxWrite() will accept.
+
+    PreCondition:
+        CDCInitEP() has been called.
+
+    Parameters:
+        None
+
+    Return Values:
+        WORD - Number of free bytes
+
+    Remarks:
+        Only available when USB_CDC_TX_RING_PACKETS is defined.
+ *****************************************************************************/
+WORD CDCTxGetFreeSpace(void);
+
+/******************************************************************************
+    Function:
+        BYTE* CDCTxReserve(BYTE* length)
+
+    Summary:
+        Gets a pointer into the IN packet buffer being filled.
+
+    Description:
+        Returns the free part of the packet buffer currently being filled,
+        so that the application can build its data there directly.  Call
+        CDCTxCommit() with the number of bytes written.
+
+    PreCondition:
+        CDCInitEP() has been called.
+
+    Parameters:
+        BYTE* length - Receives the number of bytes that can be written, 0
+                       if the ring is full
+
+    Return Values:
+        BYTE* - Location to write the data to, NULL if the ring is full
+
+    Remarks:
+        A reservation never spans two packets.  Only available when
+        USB_CDC_TX_RING_PACKETS is defined.
+ *****************************************************************************/
+BYTE* CDCTxReserve(BYTE* length);
+
+/******************************************************************************
+    Function:
+        void CDCTxCommit(BYTE length)
+
+    Summary:
+        Queues data written at the location returned by CDCTxReserve().
+
+    Description:
+        Queues data written at the location returned by CDCTxReserve().
+        The packet is sent by CDCTxService() once it is full, or earlier if
+        nothing else is queued or being sent.
+
+    PreCondition:
+        CDCTxReserve() returned at least length bytes.
+
+    Parameters:
+        BYTE length - Number of bytes written
+
+    Return Values:
+        None
+
+    Remarks:
+        Only available when USB_CDC_TX_RING_PACKETS is defined.
+ *****************************************************************************/
+void CDCTxCommit(BYTE length);
+
+/******************************************************************************
+    Function:
+        WORD CDCTxWrite(BYTE* data, WORD length)
+
+    Summary:
+        Copies data into the CDC TX ring.
+
+    Description:
+        Copies as much of the data as fits into the IN packet buffers.  It
+        can be called while earlier data is still being sent.
+
+    PreCondition:
+        CDCInitEP() has been called.
+
+    Parameters:
+        BYTE* data  - Data to send
+        WORD length - Number of bytes to send
+
+    Return Values:
+        WORD - Number of bytes queued
+
+    Remarks:
+        Only available when USB_CDC_TX_RING_PACKETS is defined.
+ *****************************************************************************/
+WORD CDCTxWrite(BYTE* data, WORD length);
+
+/******************************************************************************
+    Function:
+        WORD CDCTxWriteROM(const ROM BYTE* data, WORD length)
+
+    Summary:
+        Copies data located in program memory into the CDC TX ring.
+
+    Description:
+        Same as CDCTxWrite(), for data located in program memory.
+
+    PreCondition:
+        CDCInitEP() has been called.
+
+    Parameters:
+        const ROM BYTE* data - Data to send
+        WORD length          - Number of bytes to send
+
+    Return Values:
+        WORD - Number of bytes queued
+
+    Remarks:
+        Only available when USB_CDC_TX_RING_PACKETS is defined.
+ *****************************************************************************/
+WORD CDCTxWriteROM(const ROM BYTE* data, WORD length);
+
+/******************************************************************************
+    Function:
+        void CDCTxFlush(void)
+
+    Summary:
+        Sends the partly filled IN packet buffer without waiting for more
+        data.
+
+    Description:
+        Closes the packet buffer being filled, so that CDCTxService() sends
+        it after the packets queued before it.
+
+    PreCondition:
+        CDCInitEP() has been called.
+
+    Parameters:
+        None
+
+    Return Values:
+        None
+
+    Remarks:
+        Only available when USB_CDC_TX_RING_PACKETS is defined.
+ *****************************************************************************/
+void CDCTxFlush(void);
+
+/******************************************************************************
+    Function:
+        BYTE* CDCRxPeek(BYTE* length)
+
+    Summary:
+        Gets a pointer to the oldest unread data received on the CDC bulk
+        OUT endpoint.
+
+    Description:
+        Returns the unread part of the oldest received packet, in the packet
+        buffer itself.  Call CDCRxRelease() with the number of bytes used.
+
+    PreCondition:
+        CDCInitEP() has been called.
+
+    Parameters:
+        BYTE* length - Receives the number of bytes available, 0 if no data
+                       was received
+
+    Return Values:
+        BYTE* - Location of the data, NULL if no data was received
+
+    Remarks:
+        Only available when USB_CDC_RX_RING_PACKETS is defined.
+ *****************************************************************************/
+BYTE* CDCRxPeek(BYTE* length);
+
+/******************************************************************************
+    Function:
+        void CDCRxRelease(BYTE length)
+
+    Summary:
+        Marks data returned by CDCRxPeek() as read.
+
+    Description:
+        Marks data returned by CDCRxPeek() as read.  The packet buffer is
+        armed again for reception once all of its bytes are released.
+
+    PreCondition:
+        CDCRxPeek() returned at least length bytes.
+
+    Parameters:
+        BYTE length - Number of bytes read
+
+    Return Values:
+        None
+
+    Remarks:
+        Only available when USB_CDC_RX_RING_PACKETS is defined.
+ *****************************************************************************/
+void CDCRxRelease(BYTE length);
+
+/******************************************************************************
+    Function:
+        WORD CDCRxRead(BYTE* buffer, WORD length)
+
+    Summary:
+        Copies received data out of the CDC RX ring.
+
+    Description:
+        Copies up to length bytes, taken from as many received packets as
+        needed.  Data that does not fit is kept for the next call.
+
+    PreCondition:
+        CDCInitEP() has been called.
+
+    Parameters:
+        BYTE* buffer - Where to copy the data
+        WORD length  - Size of the buffer
+
+    Return Values:
+        WORD - Number of bytes copied, 0 if no data was received
+
+    Remarks:
+        Only available when USB_CDC_RX_RING_PACKETS is defined.
+ *****************************************************************************/
+WORD CDCRxRead(BYTE* buffer, WORD length);
+
 /**************************************************************************
   Function:
         void CDCInitEP(void)
@@ -486,7 +486,9 @@ typedef union __attribute__((packed)){
                 &amp;MDD_SDSPI_MediaDetect,
                 &amp;MDD_SDSPI_SectorRead,
                 &amp;MDD_SDSPI_WriteProtectState,
-                &amp;MDD_SDSPI_SectorWrite
+                &amp;MDD_SDSPI_SectorWrite,
+                &amp;MDD_SDSPI_AsyncReadTasks,
+                &amp;MDD_SDSPI_AsyncWriteTasks
             }
         };
     </code>
@@ -500,6 +502,15 @@ typedef union __attribute__((packed)){
     location in the structure. Incorrect alignment will cause the USB stack
     to call the incorrect function for a given command.
     
+    The AsyncReadTasks and AsyncWriteTasks members are only used by
+    usb_function_msd_multi_sector.c, which streams READ10/WRITE10 data
+    through them one endpoint packet at a time.  They may be left out (NULL)
+    when usb_function_msd.c is used.  If they are NULL with the multi-sector
+    driver, the SD-SPI functions are called instead when the SD-SPI layer is
+    built in, and the READ10/WRITE10 fails otherwise.  Any physical layer can
+    be used with the multi-sector driver, if it implements these two
+    functions with the same behavior as MDD_SDSPI_AsyncReadTasks() and MDD_SDSPI_AsyncWriteTasks().
+    
     See the MDD File System Library for additional information about the
     available physical media, their requirements, and how to use their
     associated functions.                                                  
@@ -527,6 +538,12 @@ typedef struct
     //Function pointer to the SectorWrite() function of the physical media 
     //  being used.
     BYTE  (*SectorWrite)(DWORD sector_addr, BYTE* buffer, BYTE allowWriteToZero);
+    //Function pointer to the AsyncReadTasks() function of the physical media
+    //  being used.  Only needed by the multi-sector driver.
+    BYTE  (*AsyncReadTasks)(ASYNC_IO* info);
+    //Function pointer to the AsyncWriteTasks() function of the physical media
+    //  being used.  Only needed by the multi-sector driver.
+    BYTE  (*AsyncWriteTasks)(ASYNC_IO* info);
 } LUN_FUNCTIONS;
 
 /** Section: Externs *********************************************************/
@@ -167,9 +167,17 @@ typedef union
 /* Host Transfer Information
 
 This structure is used when the event handler is used to notify the upper layer
-of transfer completion.
+of transfer completion.  If USB_HOST_TRANSFER_TIMESTAMP() is defined in
+usb_config.h, the timestamp member holds its value when the transfer completed.
+USB_HOST_TRANSFER_TIMESTAMP() is called from the USB interrupt and must return
+a QWORD.
 */
 
+// The MIDI event stream timestamps received transfers with its own clock.
+#if !defined( USB_HOST_TRANSFER_TIMESTAMP ) && defined( USB_HOST_MIDI_STREAM_QUEUE_SIZE ) && defined( USB_HOST_MIDI_TIMESTAMP )
+    #define USB_HOST_TRANSFER_TIMESTAMP()   USB_HOST_MIDI_TIMESTAMP()
+#endif
+
 typedef struct _HOST_TRANSFER_DATA
 {
    DWORD                dataCount;          // Count of bytes transferred.
@@ -178,6 +186,9 @@ typedef struct _HOST_TRANSFER_DATA
    BYTE                 bErrorCode;         // Transfer error code.
    TRANSFER_ATTRIBUTES  bmAttributes;       // INTERNAL USE ONLY - Endpoint transfer attributes.
    BYTE                 clientDriver;       // INTERNAL USE ONLY - Client driver index for sending the event.
+#if defined( USB_HOST_TRANSFER_TIMESTAMP )
+   QWORD                timestamp;          // Value of USB_HOST_TRANSFER_TIMESTAMP() at completion.
+#endif
 } HOST_TRANSFER_DATA;
 
 
@@ -940,6 +951,9 @@ void USBHostIsochronousBuffersReset( ISOCHRONOUS_DATA * isocData, BYTE numberOfB
     USB_ENDPOINT_BUSY           - A read or write is already in progress
     USB_ILLEGAL_REQUEST         - SET CONFIGURATION cannot be performed with
                                     this function.
+    USB_ERROR_INSUFFICIENT_BANDWIDTH - The isochronous and interrupt
+                                    endpoints of the requested interface
+                                    setting do not fit in the frame.
 
   Remarks:
     DTS reset is done before the command is issued.
@@ -1365,7 +1379,8 @@ void    USBHostTerminateTransfer( BYTE deviceAddress, BYTE endpoint );
     BYTE endpoint       - Endpoint number
     BYTE *errorCode     - Error code indicating the status of the transfer.
                             Only valid if the transfer is complete.
-    DWORD *byteCount    - The number of bytes sent or received.  Invalid
+    DWORD *byteCount    - The number of bytes sent or received, also
+                            when the transfer ended with an error.  Invalid
                             for isochronous transfers.
 
   Return Values:
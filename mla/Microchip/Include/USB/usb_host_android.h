@@ -42,6 +42,7 @@ Change History
   Rev      Description
   -----    ----------------------------------
   2.9      Initial revision
+  2.9j     Added the transfer queues, enabled with ANDROID_TRANSFER_QUEUE_SIZE
 *******************************************************************************/
 //DOM-IGNORE-END
 
@@ -79,6 +80,11 @@ Change History
 
 #define ANDROID_EVENT_BASE EVENT_USER_BASE + ANDROID_BASE_OFFSET
 
+/* ANDROID_TRANSFER_QUEUE_SIZE can be defined by the user to enable the transfer
+   queues.  It is the number of transfers that can be queued in each direction with
+   AndroidAppQueueWrite() and AndroidAppQueueRead(), including the transfer in
+   progress.  If it is not defined, the queues are not compiled in. */
+
 
 
 /* This event is thrown when an Android device is attached and successfully entered into
@@ -359,6 +365,156 @@ BYTE AndroidAppRead(void* handle, BYTE* data, DWORD size);
   ***************************************************************************/
 BOOL AndroidAppIsReadComplete(void* handle, BYTE* errorCode, DWORD* size);
 
+#if defined(ANDROID_TRANSFER_QUEUE_SIZE)
+/* Function called when a queued transfer has completed.  The handle is the handle
+   of the device, data and context are the values passed when the transfer was
+   queued, size is the number of bytes transferred and errorCode is the result of
+   the transfer (see AndroidAppIsWriteComplete() for the possible values).  When
+   the device is detached, the transfers that are still queued complete with
+   USB_UNKNOWN_DEVICE. */
+typedef void (*ANDROID_TRANSFER_CALLBACK)(void* handle, BYTE* data, DWORD size, BYTE errorCode, void* context);
+
+/****************************************************************************
+  Function:
+    BYTE AndroidAppQueueWrite(void* handle, BYTE* data, DWORD size,
+                    ANDROID_TRANSFER_CALLBACK callback, void* context)
+
+  Summary:
+    Queues data to be sent to the Android device.
+
+  Description:
+    Queues data to be sent to the Android device.  If no write is in progress
+    the write is started immediately.  Otherwise it is started as soon as the
+    writes queued before it have completed, without waiting for the
+    application, so several writes can be sent back to back.  When the write
+    completes, the callback function is called.
+
+  Precondition:
+    USB module is initialized and Android device has attached.
+
+  Parameters:
+    void* handle - the handle passed to the device in the EVENT_ANDROID_ATTACH event
+    BYTE* data - the data to send to the Android device.  It must not be changed
+                until the callback function is called.
+    DWORD size - the size of the data that needs to be sent
+    ANDROID_TRANSFER_CALLBACK callback - function called when the write
+                completes, or NULL
+    void* context - value passed to the callback function
+
+  Return Values:
+    USB_SUCCESS                     - Write queued successfully.
+    USB_UNKNOWN_DEVICE              - Device with the specified address not found.
+    USB_INVALID_STATE               - We are not in a normal running state.
+    USB_ENDPOINT_BUSY               - The queue is full, or a write started
+                                        with AndroidAppWrite() is in progress.
+    Others                          - See AndroidAppWrite().
+
+  Remarks:
+    ANDROID_TRANSFER_QUEUE_SIZE must be defined.  If USB_ENABLE_TRANSFER_EVENT
+    is defined, the callback function is called from the USB transfer event,
+    otherwise from AndroidTasks().  The callback function may queue another
+    transfer.  AndroidAppIsWriteComplete() must not be used for queued writes.
+  ***************************************************************************/
+BYTE AndroidAppQueueWrite(void* handle, BYTE* data, DWORD size, ANDROID_TRANSFER_CALLBACK callback, void* context);
+
+/****************************************************************************
+  Function:
+    BYTE AndroidAppQueueRead(void* handle, BYTE* data, DWORD size,
+                    ANDROID_TRANSFER_CALLBACK callback, void* context)
+
+  Summary:
+    Queues a read from the Android device.
+
+  Description:
+    Queues a read from the Android device.  If no read is in progress the read
+    is started immediately.  Otherwise it is started as soon as the reads
+    queued before it have completed, without waiting for the application, so
+    the IN endpoint is read back to back.  When the read completes, the
+    callback function is called with the number of bytes received.
+
+  Precondition:
+    USB module is initialized and Android device has attached.
+
+  Parameters:
+    void* handle - the handle passed to the device in the EVENT_ANDROID_ATTACH event
+    BYTE* data - a pointer to the location of where the data should be stored.  This location
+                should be accessible by the USB module
+    DWORD size - the amount of data to read.  This is rounded down to a
+                multiple of the endpoint size.
+    ANDROID_TRANSFER_CALLBACK callback - function called when the read
+                completes, or NULL
+    void* context - value passed to the callback function
+
+  Return Values:
+    USB_SUCCESS                     - Read queued successfully.
+    USB_UNKNOWN_DEVICE              - Device with the specified address not found.
+    USB_INVALID_STATE               - We are not in a normal running state.
+    USB_ENDPOINT_BUSY               - The queue is full, or a read started
+                                        with AndroidAppRead() is in progress.
+    USB_ERROR_BUFFER_TOO_SMALL      - The buffer passed to the read function was
+                                        smaller than the endpoint size being used.
+    Others                          - See AndroidAppRead().
+
+  Remarks:
+    ANDROID_TRANSFER_QUEUE_SIZE must be defined.  If USB_ENABLE_TRANSFER_EVENT
+    is defined, the callback function is called from the USB transfer event,
+    otherwise from AndroidTasks().  The callback function may queue another
+    transfer, for example to read into the same buffer again.
+    AndroidAppIsReadComplete() must not be used for queued reads.
+  ***************************************************************************/
+BYTE AndroidAppQueueRead(void* handle, BYTE* data, DWORD size, ANDROID_TRANSFER_CALLBACK callback, void* context);
+
+/****************************************************************************
+  Function:
+    BYTE AndroidAppWriteQueueCount(void* handle)
+
+  Summary:
+    Returns the number of queued writes.
+
+  Description:
+    Returns the number of writes queued with AndroidAppQueueWrite() that have
+    not completed, including the write in progress.
+
+  Precondition:
+    None
+
+  Parameters:
+    void* handle - the handle passed to the device in the EVENT_ANDROID_ATTACH event
+
+  Return Values:
+    The number of queued writes.  0 if the handle is not valid.
+
+  Remarks:
+    None
+  ***************************************************************************/
+BYTE AndroidAppWriteQueueCount(void* handle);
+
+/****************************************************************************
+  Function:
+    BYTE AndroidAppReadQueueCount(void* handle)
+
+  Summary:
+    Returns the number of queued reads.
+
+  Description:
+    Returns the number of reads queued with AndroidAppQueueRead() that have
+    not completed, including the read in progress.
+
+  Precondition:
+    None
+
+  Parameters:
+    void* handle - the handle passed to the device in the EVENT_ANDROID_ATTACH event
+
+  Return Values:
+    The number of queued reads.  0 if the handle is not valid.
+
+  Remarks:
+    None
+  ***************************************************************************/
+BYTE AndroidAppReadQueueCount(void* handle);
+#endif
+
 
 /****************************************************************************
   Function:
@@ -83,6 +83,12 @@ CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
          more than 256 bytes
 
  2.9     Fixed bug: changed USB_CDC_CONTROL_LINE_LENGTH to 0x00 (was 0x02).		 
+
+ 2.9j    Added the IN stream, enabled with USB_HOST_CDC_STREAM_BUFFER_SIZE,
+         and the EVENT_CDC_STREAM_DATA and EVENT_CDC_STREAM_ERROR events.
+
+         Added USBHostCDCTransferIsCompleteEx(), which returns a WORD byte
+         count.
 ********************************************************************************/
 //DOM-IGNORE-END
 
@@ -210,6 +216,8 @@ CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
 #define EVENT_CDC_DATA_WRITE_DONE      EVENT_CDC_BASE + EVENT_CDC_OFFSET + 5   // A CDC Data Write transfer has completed
 #define EVENT_CDC_RESET                EVENT_CDC_BASE + EVENT_CDC_OFFSET + 6   // CDC reset complete
 #define EVENT_CDC_NAK_TIMEOUT          EVENT_CDC_BASE + EVENT_CDC_OFFSET + 7   // CDC device NAK timeout has occurred
+#define EVENT_CDC_STREAM_DATA          EVENT_CDC_BASE + EVENT_CDC_OFFSET + 8   // Data was added to the IN stream ring (size: number of bytes)
+#define EVENT_CDC_STREAM_ERROR         EVENT_CDC_BASE + EVENT_CDC_OFFSET + 9   // The IN stream stopped because of an error (size: error code)
 
 
 #define USB_CDC_LINE_CODING_LENGTH          0x07   // Number of bytes Line Coding transfer
@@ -325,6 +333,38 @@ typedef struct _DATA_INTERFACE_DETAILS
     BYTE                            endpointOUT;          // IN endpoint for comm interface.
 }   DATA_INTERFACE_DETAILS;
 
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+/*
+   This structure holds the state of the data IN stream.  The stream is enabled
+   by defining USB_HOST_CDC_STREAM_BUFFER_SIZE in usb_config.h, the size of
+   each of the two buffers that the endpoint is read into.  It should be a
+   multiple of the endpoint's maximum packet size.
+*/
+typedef struct _USB_CDC_STREAM_INFO
+{
+    BYTE*                               ring;                  // Ring buffer supplied by the application.
+    WORD                                ringSize;              // Size of the ring buffer.
+    WORD                                ringHead;              // Index where the next received byte is stored.
+    WORD                                ringTail;              // Index of the next byte to be read by the application.
+    WORD                                ringCount;             // Number of bytes in the ring.
+    WORD                                bufferCount[2];        // Number of received bytes in each buffer, not yet in the ring.
+    WORD                                bufferOffset;          // Number of bytes of the oldest buffer already moved to the ring.
+    BYTE                                bufferArmed;           // Buffer of the last read started.
+    BYTE                                bufferDrain;           // Buffer holding the oldest received data.
+    BYTE                                errorCode;             // Error code that stopped the stream.
+    union
+    {
+        struct
+        {
+            BYTE                        bfActive             : 1;   // The stream is running.
+            BYTE                        bfArmed              : 1;   // A read is in progress.
+            BYTE                        bfBusy               : 1;   // The stream is being serviced.
+        };
+        BYTE                            val;
+    }                                   flags;
+} USB_CDC_STREAM_INFO;
+#endif
+
 /*
    This structure is used to hold information about an attached CDC device
 */
@@ -357,6 +397,9 @@ typedef struct _USB_CDC_DEVICE_INFO
     BYTE                                clientDriverID;        // Client driver ID for device requests.
     COMM_INTERFACE_DETAILS              commInterface;         // This structure stores communication interface details.
     DATA_INTERFACE_DETAILS              dataInterface;         // This structure stores data interface details.
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+    USB_CDC_STREAM_INFO                 stream;                // This structure stores the data IN stream state.
+#endif
 } USB_CDC_DEVICE_INFO;
 
 
@@ -551,7 +594,7 @@ BYTE USBHostCDCTransfer( BYTE deviceAddress,BYTE request , BYTE direction, BYTE
 /*******************************************************************************
   Function:
     BOOL USBHostCDCTransferIsComplete( BYTE deviceAddress,
-                        BYTE *errorCode, DWORD *byteCount )
+                        BYTE *errorCode, BYTE *byteCount )
 
   Summary:
     This function indicates whether or not the last transfer is complete.
@@ -569,14 +612,165 @@ BYTE USBHostCDCTransfer( BYTE deviceAddress,BYTE request , BYTE direction, BYTE
   Parameters:
     BYTE deviceAddress  - Device address
     BYTE *errorCode     - Error code from last transfer
-    DWORD *byteCount    - Number of bytes transferred
+    BYTE *byteCount     - Number of bytes transferred
 
   Return Values:
     TRUE    - Transfer is complete, errorCode is valid
     FALSE   - Transfer is not complete, errorCode is not valid
+
+  Remarks:
+    Only the low byte of the byte count is returned.  Use
+    USBHostCDCTransferIsCompleteEx() for transfers of more than 255 bytes.
 *******************************************************************************/
 BOOL    USBHostCDCTransferIsComplete( BYTE deviceAddress, BYTE *errorCode, BYTE *byteCount );
 
+/*******************************************************************************
+  Function:
+    BOOL USBHostCDCTransferIsCompleteEx( BYTE deviceAddress,
+                        BYTE *errorCode, WORD *byteCount )
+
+  Summary:
+    This function indicates whether or not the last transfer is complete.
+
+  Description:
+    This function is the same as USBHostCDCTransferIsComplete(), but
+    returns the full byte count of transfers of more than 255 bytes.
+
+  Precondition:
+    None
+
+  Parameters:
+    BYTE deviceAddress  - Device address
+    BYTE *errorCode     - Error code from last transfer
+    WORD *byteCount     - Number of bytes transferred
+
+  Return Values:
+    TRUE    - Transfer is complete, errorCode is valid
+    FALSE   - Transfer is not complete, errorCode is not valid
+*******************************************************************************/
+BOOL    USBHostCDCTransferIsCompleteEx( BYTE deviceAddress, BYTE *errorCode, WORD *byteCount );
+
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+/*******************************************************************************
+  Function:
+    BYTE USBHostCDCStreamStart( BYTE deviceAddress, BYTE *ring, WORD ringSize )
+
+  Summary:
+    This function starts streaming the data IN endpoint into a ring buffer.
+
+  Description:
+    This function starts streaming the data IN endpoint into a ring buffer.
+    A read is kept armed on the endpoint, alternating between two buffers of
+    USB_HOST_CDC_STREAM_BUFFER_SIZE bytes, so the device is polled while the
+    application handles the data that was already received.  Each time data
+    is added to the ring, the application event handler receives
+    EVENT_CDC_STREAM_DATA with the number of bytes added as the size.  The
+    data is read from the ring with USBHostCDCStreamRead().
+
+  Precondition:
+    The device is running.
+
+  Parameters:
+    BYTE deviceAddress  - Device address
+    BYTE *ring          - Ring buffer for the received data
+    WORD ringSize       - Size of the ring buffer
+
+  Return Values:
+    USB_SUCCESS                 - Streaming started
+    USB_CDC_DEVICE_NOT_FOUND    - No device with specified address
+    USB_CDC_DEVICE_BUSY         - A read is in progress on the data interface
+    USB_CDC_ILLEGAL_REQUEST     - The ring buffer is not valid
+
+  Remarks:
+    While the stream is running, the data IN endpoint cannot be read with
+    USBHostCDCRead_DATA().  Writes and communication interface requests can
+    still be performed.  If the ring is full, the received data is held in
+    the two buffers and no more reads are started, so the device NAKs until
+    the application reads from the ring.  No data is lost.
+*******************************************************************************/
+BYTE    USBHostCDCStreamStart( BYTE deviceAddress, BYTE *ring, WORD ringSize );
+
+/*******************************************************************************
+  Function:
+    void USBHostCDCStreamStop( BYTE deviceAddress )
+
+  Summary:
+    This function stops streaming the data IN endpoint.
+
+  Description:
+    This function stops streaming the data IN endpoint.  The read in
+    progress is terminated.  Data already in the ring can still be read
+    with USBHostCDCStreamRead().
+
+  Precondition:
+    None
+
+  Parameters:
+    BYTE deviceAddress  - Device address
+
+  Returns:
+    None
+
+  Remarks:
+    Data held in the two stream buffers is discarded.
+*******************************************************************************/
+void    USBHostCDCStreamStop( BYTE deviceAddress );
+
+/*******************************************************************************
+  Function:
+    WORD USBHostCDCStreamRead( BYTE deviceAddress, BYTE *data, WORD size )
+
+  Summary:
+    This function reads data received by the IN stream.
+
+  Description:
+    This function copies up to size bytes out of the ring buffer of the IN
+    stream.  If the stream was waiting for room in the ring, the held data
+    is moved into the ring and the next read is started.
+
+  Precondition:
+    USBHostCDCStreamStart() has been called.
+
+  Parameters:
+    BYTE deviceAddress  - Device address
+    BYTE *data          - Buffer for the data
+    WORD size           - Size of the buffer
+
+  Returns:
+    The number of bytes copied.
+
+  Remarks:
+    This function can be called from the application event handler when it
+    receives EVENT_CDC_STREAM_DATA.
+*******************************************************************************/
+WORD    USBHostCDCStreamRead( BYTE deviceAddress, BYTE *data, WORD size );
+
+/*******************************************************************************
+  Function:
+    WORD USBHostCDCStreamCount( BYTE deviceAddress )
+
+  Summary:
+    This function returns the number of bytes in the IN stream ring.
+
+  Description:
+    This function returns the number of bytes in the ring buffer of the IN
+    stream that can be read with USBHostCDCStreamRead().
+
+  Precondition:
+    None
+
+  Parameters:
+    BYTE deviceAddress  - Device address
+
+  Returns:
+    The number of bytes in the ring.
+
+  Remarks:
+    None
+*******************************************************************************/
+WORD    USBHostCDCStreamCount( BYTE deviceAddress );
+#endif
+
 
 // *****************************************************************************
 // *****************************************************************************
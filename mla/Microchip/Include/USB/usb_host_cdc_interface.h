@@ -60,6 +60,9 @@ ADG          9-Apr-2008 First release
               not fully comply with CDC specifications
               Modified API USBHostCDC_Api_Send_OUT_Data to allow data transfers
               more than 256 bytes
+ v2.9j        Modified API USBHostCDC_Api_Get_IN_Data and added API
+              USBHostCDC_ApiTransferIsCompleteEx to allow data transfers more
+              than 256 bytes.  Added the IN stream APIs.
 *******************************************************************************/
 //DOM-IGNORE-END
 
@@ -86,7 +89,7 @@ ADG          9-Apr-2008 First release
 
 /****************************************************************************
   Function:
-    BOOL USBHostCDC_Api_Get_IN_Data(BYTE no_of_bytes, BYTE* data)
+    BOOL USBHostCDC_Api_Get_IN_Data(WORD no_of_bytes, BYTE* data)
 
   Description:
     This function is called by application to receive Input data over DATA
@@ -106,7 +109,7 @@ ADG          9-Apr-2008 First release
   Remarks:
     None
 ***************************************************************************/
-BOOL USBHostCDC_Api_Get_IN_Data(BYTE no_of_bytes, BYTE* data);
+BOOL USBHostCDC_Api_Get_IN_Data(WORD no_of_bytes, BYTE* data);
 
 /****************************************************************************
   Function:
@@ -157,10 +160,36 @@ BOOL USBHostCDC_Api_Send_OUT_Data(WORD no_of_bytes, BYTE* data);
     FALSE   -   Transfer is pending.
 
   Remarks:
-    None
+    Only the low byte of the byte count is returned.  Use
+    USBHostCDC_ApiTransferIsCompleteEx for transfers of more than 255 bytes.
 ***************************************************************************/
 BOOL USBHostCDC_ApiTransferIsComplete(BYTE* errorCodeDriver, BYTE* byteCount );
 
+/****************************************************************************
+  Function:
+    BOOL USBHostCDC_ApiTransferIsCompleteEx(BYTE* errorCodeDriver,WORD* byteCount)
+
+  Description:
+    This function is the same as USBHostCDC_ApiTransferIsComplete, but
+    returns the full byte count of transfers of more than 255 bytes.
+
+  Precondition:
+    None
+
+  Parameters:
+    BYTE    *errorCodeDriver - returns.
+    WORD    *byteCount       - Number of bytes transferred.
+
+
+  Return Values:
+    TRUE    -   Transfer is has completed.
+    FALSE   -   Transfer is pending.
+
+  Remarks:
+    None
+***************************************************************************/
+BOOL USBHostCDC_ApiTransferIsCompleteEx(BYTE* errorCodeDriver, WORD* byteCount );
+
 /*******************************************************************************
   Function:
     BOOL USBHostCDC_ApiDeviceDetect( void )
@@ -224,4 +253,76 @@ BOOL USBHostCDC_ApiDeviceDetect( void );
  *******************************************************************************/
 BYTE USBHostCDC_Api_ACM_Request(BYTE requestType, BYTE size, BYTE* data);
 
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+/****************************************************************************
+  Function:
+    BOOL USBHostCDC_Api_Stream_Start(BYTE* ring, WORD ringSize)
+
+  Description:
+    This function is called by application to start receiving Input data over
+    DATA interface continuously.  The data is stored in the ring buffer, and
+    EVENT_CDC_STREAM_DATA is sent to the application each time data is added.
+
+  Precondition:
+    Device must be enumerated and attached successfully.
+
+  Parameters:
+    BYTE*   ring        - Pointer to application ring buffer.
+    WORD    ringSize    - Size of the ring buffer.
+
+  Return Values:
+    TRUE    -   Streaming is started.
+    FALSE   -   Streaming could not be started.
+
+  Remarks:
+    See USBHostCDCStreamStart().
+***************************************************************************/
+BOOL USBHostCDC_Api_Stream_Start(BYTE* ring, WORD ringSize);
+
+/****************************************************************************
+  Function:
+    void USBHostCDC_Api_Stream_Stop(void)
+
+  Description:
+    This function is called by application to stop receiving Input data over
+    DATA interface continuously.
+
+  Precondition:
+    None
+
+  Parameters:
+    None
+
+  Return Values:
+    None
+
+  Remarks:
+    None
+***************************************************************************/
+void USBHostCDC_Api_Stream_Stop(void);
+
+/****************************************************************************
+  Function:
+    WORD USBHostCDC_Api_Stream_Read(WORD no_of_bytes, BYTE* data)
+
+  Description:
+    This function is called by application to read the Input data received
+    since streaming was started.
+
+  Precondition:
+    None
+
+  Parameters:
+    WORD    no_of_bytes - Size of application receive data buffer.
+    BYTE*   data        - Pointer to application receive data buffer.
+
+  Return Values:
+    Number of bytes copied to the application buffer.
+
+  Remarks:
+    None
+***************************************************************************/
+WORD USBHostCDC_Api_Stream_Read(WORD no_of_bytes, BYTE* data);
+#endif
+
 #endif /* _USB_HOST_CDC_INTERFACE_H_ */
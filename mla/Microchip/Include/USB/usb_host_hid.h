@@ -220,6 +220,42 @@ This defines the data type required to hold the maximum field size data.
 #endif
 
 
+// *****************************************************************************
+/* HID Extraction Operation
+
+This structure describes how one data field is copied from a report into the
+application's buffer.  It is filled by USBHostHID_ApiCompileData() or
+USBHostHID_ApiCompileReport().
+*/
+typedef struct _HID_EXTRACT_OP
+{
+    DWORD mask;                       // mask - mask of the field bits, after the shift.
+    BYTE byteOffset;                  // byteOffset - first report byte holding the field.
+    BYTE shift;                       // shift - position of the field's first bit in that byte.
+    BYTE bytes;                       // bytes - number of report bytes holding the field (1 to 5).
+    BYTE signExtend;                  // signExtend - sign extend the field.
+    BYTE slot;                        // slot - index of the buffer entry that receives the field.
+}   HID_EXTRACT_OP;
+
+
+// *****************************************************************************
+/* HID Report Decoder
+
+This structure holds the compiled extraction operations for one report.
+USBHostHID_ApiDecodeReport() uses it to copy all the data fields the
+application needs from a report into the application's buffer in one pass.
+*/
+typedef struct _HID_REPORT_DECODER
+{
+    HID_EXTRACT_OP *ops;              // ops - array of extraction operations, supplied by the application.
+    BYTE maxOps;                      // maxOps - number of entries in the ops array.
+    BYTE opCount;                     // opCount - number of extraction operations compiled.
+    BYTE reportID;                    // reportID - report ID - the first byte of the report.
+    BYTE interfaceNum;                // interfaceNum - interface number of the report.
+    WORD reportLength;                // reportLength - the expected length of the report.
+}   HID_REPORT_DECODER;
+
+
 // *****************************************************************************
 /* HID Device ID Information
 
@@ -729,6 +765,125 @@ BYTE USBHostHID_ApiGetCurrentInterfaceNum(void);
 BOOL USBHostHID_ApiImportData(BYTE *report,WORD reportLength,HID_USER_DATA_SIZE *buffer, HID_DATA_DETAILS *pDataDetails);
 
 
+/*******************************************************************************
+  Function:
+    void USBHostHID_ApiDecoderInit(HID_REPORT_DECODER *pDecoder,
+                     HID_EXTRACT_OP *ops, BYTE maxOps)
+
+  Description:
+    This function prepares a report decoder for compiling.  The application
+    supplies the array that holds the extraction operations.
+
+  Precondition:
+    None
+
+  Parameters:
+    HID_REPORT_DECODER *pDecoder    - Decoder to initialize
+    HID_EXTRACT_OP *ops             - Array for the extraction operations
+    BYTE maxOps                     - Number of entries in ops
+
+  Returns:
+    None
+
+  Remarks:
+    None
+*******************************************************************************/
+#define USBHostHID_ApiDecoderInit(pDecoder,pOps,max) { (pDecoder)->ops = (pOps); (pDecoder)->maxOps = (max); (pDecoder)->opCount = 0; }
+
+
+/*******************************************************************************
+  Function:
+    BOOL USBHostHID_ApiCompileData(HID_REPORT_DECODER *pDecoder,
+                     HID_DATA_DETAILS *pDataDetails, BYTE slot)
+
+  Description:
+    This function adds the data described by 'HID_DATA_DETAILS' to a report
+    decoder.  Each of the pDataDetails->count fields gets one extraction
+    operation, and is written to buffer entries slot, slot+1, and so on by
+    USBHostHID_ApiDecodeReport().
+
+  Precondition:
+    The decoder has been initialized with USBHostHID_ApiDecoderInit().
+
+  Parameters:
+    HID_REPORT_DECODER *pDecoder    - Decoder to add the data to
+    HID_DATA_DETAILS *pDataDetails  - data details extracted from report
+                                      descriptor
+    BYTE slot                       - Buffer index of the first field
+
+  Return Values:
+    TRUE    - The data was added to the decoder
+    FALSE   - The data belongs to another report, does not fit in the report
+              or in the decoder, or a field is wider than 32 bits.
+
+  Remarks:
+    All the data compiled into one decoder must come from the same report.
+*******************************************************************************/
+BOOL USBHostHID_ApiCompileData(HID_REPORT_DECODER *pDecoder, HID_DATA_DETAILS *pDataDetails, BYTE slot);
+
+
+/*******************************************************************************
+  Function:
+    BOOL USBHostHID_ApiCompileReport(HID_REPORT_DECODER *pDecoder,
+                     HIDReportTypeEnum type, BYTE reportID)
+
+  Description:
+    This function adds every data field of a report to a report decoder, in
+    the order the fields appear in the report.  Constant (padding) fields are
+    skipped.  Fields with a negative logical minimum are sign extended.
+
+  Precondition:
+    The report descriptor has been parsed, and the decoder has been
+    initialized with USBHostHID_ApiDecoderInit().
+
+  Parameters:
+    HID_REPORT_DECODER *pDecoder    - Decoder to add the fields to
+    HIDReportTypeEnum type          - report type Input/Output/Feature
+    BYTE reportID                   - report ID, or 0 if the device does not
+                                      use report IDs
+
+  Return Values:
+    TRUE    - All the data fields of the report were added to the decoder
+    FALSE   - The report was not found, or it does not fit in the decoder.
+
+  Remarks:
+    The fields are written to consecutive buffer entries, starting after the
+    ones already compiled into the decoder.
+*******************************************************************************/
+BOOL USBHostHID_ApiCompileReport(HID_REPORT_DECODER *pDecoder, HIDReportTypeEnum type, BYTE reportID);
+
+
+/*******************************************************************************
+  Function:
+    BOOL USBHostHID_ApiDecodeReport(BYTE *report, WORD reportLength,
+                     HID_USER_DATA_SIZE *buffer, HID_REPORT_DECODER *pDecoder)
+
+  Description:
+    This function extracts all the data fields compiled into a report decoder
+    from a report, in one pass.  It can be used instead of calling
+    USBHostHID_ApiImportData() for each 'HID_DATA_DETAILS' of the report.
+
+  Precondition:
+    The decoder has been compiled with USBHostHID_ApiCompileData() or
+    USBHostHID_ApiCompileReport().
+
+  Parameters:
+    BYTE *report                    - Report received from device
+    WORD reportLength               - Length of the report
+    HID_USER_DATA_SIZE *buffer      - Buffer into which data needs to be
+                                      populated
+    HID_REPORT_DECODER *pDecoder    - Compiled decoder of the report
+
+  Return Values:
+    TRUE    - If the data is retrieved from the report
+    FALSE   - If the report does not match the decoder.
+
+  Remarks:
+    None
+*******************************************************************************/
+BOOL USBHostHID_ApiDecodeReport(BYTE *report, WORD reportLength, HID_USER_DATA_SIZE *buffer, HID_REPORT_DECODER *pDecoder);
+
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: USB Host Callback Function Prototypes
@@ -65,6 +65,9 @@ CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
 Author          Date    Comments
 --------------------------------------------------------------------------------
 TL       17-Oct-2011    Preliminary release
+         v2.9j          Added the timestamped event stream, enabled with
+                        USB_HOST_MIDI_STREAM_QUEUE_SIZE, and the coalescing
+                        write queue, enabled with USB_HOST_MIDI_WRITE_QUEUE_SIZE.
 
 *******************************************************************************/
 #ifndef __USBHOSTMIDI_H__
@@ -167,6 +170,23 @@ TL       17-Oct-2011    Preliminary release
         // number of bytes that were written to the device.
 #define EVENT_MIDI_TRANSFER_DONE (EVENT_AUDIO_BASE+EVENT_MIDI_OFFSET+2)
 
+        // This event indicates that events were added to the stream queue.
+        // When USB_HOST_APP_EVENT_HANDLER is called with this event, *data
+        // points to the MIDI_DEVICE structure, and size is the number of
+        // events added.
+#define EVENT_MIDI_STREAM_DATA   (EVENT_AUDIO_BASE+EVENT_MIDI_OFFSET+3)
+
+        // This event indicates that the stream stopped because of an error.
+        // When USB_HOST_APP_EVENT_HANDLER is called with this event, *data
+        // points to the MIDI_DEVICE structure, and size is the error code.
+#define EVENT_MIDI_STREAM_ERROR  (EVENT_AUDIO_BASE+EVENT_MIDI_OFFSET+4)
+
+        // This event indicates that a batch of the write queue could not be
+        // sent and was dropped.  When USB_HOST_APP_EVENT_HANDLER is called
+        // with this event, *data points to the MIDI_DEVICE structure, and
+        // size is the error code.
+#define EVENT_MIDI_WRITE_ERROR   (EVENT_AUDIO_BASE+EVENT_MIDI_OFFSET+5)
+
 
 // *****************************************************************************
 // *****************************************************************************
@@ -187,21 +207,6 @@ typedef struct
     WORD endpointSize;          // Size of the endpoint (we'll take any size <= 64)
 } MIDI_ENDPOINT_DATA;           // MIDI endpoints
 
-// *****************************************************************************
-/* MIDI Device Information
-
-This structure contains information about an attached device, including
-status flags and device identification.
-*/
-typedef struct
-{
-    BYTE deviceAddress;     // Address of the device on the USB
-    BYTE clientDriverID;    // ID to send when issuing a Device Request
-    
-    BYTE numEndpoints;               // Number of OUT endpoints for this interface
-    MIDI_ENDPOINT_DATA* endpoints;   // List of OUT endpoints
-} MIDI_DEVICE;
-
 // *****************************************************************************
 /* MIDI Packet information
 
@@ -232,6 +237,82 @@ typedef union
     };
 } USB_AUDIO_MIDI_PACKET;
 
+#if defined(USB_HOST_MIDI_STREAM_QUEUE_SIZE)
+// *****************************************************************************
+/* Timestamped MIDI Event
+
+This structure holds a USB MIDI packet received by the event stream, and the
+value of USB_HOST_MIDI_TIMESTAMP() when the driver received it.  All the
+packets of a transfer have the same timestamp.
+*/
+typedef struct
+{
+    QWORD                   timestamp;  // Time the packet was received
+    USB_AUDIO_MIDI_PACKET   packet;     // The USB MIDI packet
+} MIDI_TIMED_EVENT;
+
+// *****************************************************************************
+/* MIDI Event Stream Information
+
+This structure holds the state of the event stream of a device.
+*/
+typedef struct
+{
+    MIDI_TIMED_EVENT    events[USB_HOST_MIDI_STREAM_QUEUE_SIZE];    // Queue of received events
+    BYTE                buffer[2][64];  // The two buffers the stream reads into, in turn
+    WORD                head;           // Index of the next event added
+    WORD                tail;           // Index of the next event read
+    WORD                count;          // Number of events in the queue
+    WORD                overruns;       // Number of events dropped because the queue was full
+    BYTE                endpointIndex;  // Index of the IN endpoint being streamed
+    BYTE                bufferArmed;    // Buffer the armed read is using
+    BYTE                errorCode;      // Error that stopped the stream
+    BOOL                active;         // The stream is running
+} MIDI_STREAM_INFO;
+#endif
+
+#if defined(USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+// *****************************************************************************
+/* MIDI Write Queue Information
+
+This structure holds the packets waiting to be sent by the write queue, and
+the batch being sent.
+*/
+typedef struct
+{
+    USB_AUDIO_MIDI_PACKET   packets[USB_HOST_MIDI_WRITE_QUEUE_SIZE];    // Packets waiting to be sent
+    BYTE                    batch[64];      // The packets being sent
+    WORD                    head;           // Index of the next packet added
+    WORD                    tail;           // Index of the oldest packet waiting
+    WORD                    count;          // Number of packets waiting
+    WORD                    coalesced;      // Number of packets replaced by a newer value
+    BYTE                    batchLength;    // Number of bytes being sent, 0 if none
+    BYTE                    endpointIndex;  // Index of the OUT endpoint, 0xFF if none
+} MIDI_WRITE_QUEUE_INFO;
+#endif
+
+// *****************************************************************************
+/* MIDI Device Information
+
+This structure contains information about an attached device, including
+status flags and device identification.
+*/
+typedef struct
+{
+    BYTE deviceAddress;     // Address of the device on the USB
+    BYTE clientDriverID;    // ID to send when issuing a Device Request
+    
+    BYTE numEndpoints;               // Number of OUT endpoints for this interface
+    MIDI_ENDPOINT_DATA* endpoints;   // List of OUT endpoints
+
+    #if defined(USB_HOST_MIDI_STREAM_QUEUE_SIZE)
+    MIDI_STREAM_INFO stream;         // Event stream of the IN endpoint
+    #endif
+    #if defined(USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+    MIDI_WRITE_QUEUE_INFO writeQueue;   // Write queue of the OUT endpoint
+    #endif
+} MIDI_DEVICE;
+
 
 // *****************************************************************************
 // *****************************************************************************
@@ -595,6 +676,253 @@ BOOL USBHostMIDITransferIsComplete( void* handle, BYTE endpointIndex, BYTE *erro
 BYTE USBHostMIDIWrite(void* handle, BYTE endpointIndex, void *buffer, WORD length);
 
 
+#if defined(USB_HOST_MIDI_STREAM_QUEUE_SIZE) || defined(USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+// *****************************************************************************
+// *****************************************************************************
+// Section: Event Stream and Write Queue
+// *****************************************************************************
+// *****************************************************************************
+
+/* The event stream keeps a read armed on an IN endpoint, alternating between
+   two buffers, and splits each transfer into USB MIDI packets as soon as it
+   completes.  Each packet is queued with the value of
+   USB_HOST_MIDI_TIMESTAMP() at that time, so the application can forward
+   MIDI clock and MTC with the time they arrived rather than the time they
+   were read.  It is enabled by defining USB_HOST_MIDI_STREAM_QUEUE_SIZE, the
+   number of events the queue holds, and USB_HOST_MIDI_TIMESTAMP(), which
+   returns a free running QWORD tick count, in usb_config.h.
+
+   The write queue is enabled by defining USB_HOST_MIDI_WRITE_QUEUE_SIZE, the
+   number of packets it holds.  Packets are sent on the first OUT endpoint of
+   the interface, as many per transfer as the endpoint allows.  While a
+   transfer is in progress, a new Control Change, Pitch Bend, Channel
+   Pressure or Polyphonic Key Pressure packet replaces a waiting packet with
+   the same target, unless a note, program change or system message for the
+   same channel is queued after it.  Data entry controllers (RPN and NRPN)
+   are never replaced.
+
+   With USB_ENABLE_TRANSFER_EVENT, the host layer takes the timestamp in the
+   USB interrupt when the transfer completes (see USB_HOST_TRANSFER_TIMESTAMP()
+   in usb_host.h), so USB_HOST_MIDI_TIMESTAMP() must be safe to call from
+   the interrupt.  In polling mode, USBHostMIDITasks() must be called
+   regularly.  The timestamp is taken when the driver finds the transfer
+   complete, so the events of a transfer are timestamped to within the time
+   between two calls of USBHostTasks() or USBHostMIDITasks().
+*/
+
+#if defined(USB_HOST_MIDI_STREAM_QUEUE_SIZE) && !defined(USB_HOST_MIDI_TIMESTAMP)
+    #error USB_HOST_MIDI_TIMESTAMP() must be defined to use the MIDI event stream.
+#endif
+
+
+/****************************************************************************
+  Function:
+    void USBHostMIDITasks( void )
+
+  Summary:
+    This function performs the event stream and write queue tasks.
+
+  Description:
+    This function checks the transfers of the event stream and of the write
+    queue, and starts the next ones.
+
+  Preconditions:
+    None
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    This function is required in polling mode.  With transfer events, the
+    transfers are handled when their events are received, and calling this
+    function is optional.
+  ***************************************************************************/
+
+void USBHostMIDITasks( void );
+#endif
+
+
+#if defined(USB_HOST_MIDI_STREAM_QUEUE_SIZE)
+/****************************************************************************
+  Function:
+    BYTE USBHostMIDIStreamStart( void* handle, BYTE endpointIndex )
+
+  Summary:
+    This function starts the event stream on an IN endpoint.
+
+  Description:
+    This function starts the event stream on an IN endpoint.  Each time
+    events are added to the queue, the application event handler receives
+    EVENT_MIDI_STREAM_DATA with the number of events added as the size.
+    The events are read with USBHostMIDIStreamRead().
+
+  Preconditions:
+    The device must be connected and enumerated.
+
+  Parameters:
+    void* handle       - Pointer to a structure containing the Device Info
+    BYTE endpointIndex - Index of the IN endpoint
+
+  Return Values:
+    USB_SUCCESS             - The stream was started
+    USB_ILLEGAL_REQUEST     - The endpoint is not an IN endpoint
+    USB_ENDPOINT_BUSY       - A read is in progress on the endpoint
+    (USB error code)        - The first read was not started.  See
+                                USBHostRead() for a list of errors.
+
+  Remarks:
+    While the stream is running, the endpoint is busy and cannot be read
+    with USBHostMIDIRead().
+  ***************************************************************************/
+
+BYTE USBHostMIDIStreamStart( void* handle, BYTE endpointIndex );
+
+
+/****************************************************************************
+  Function:
+    void USBHostMIDIStreamStop( void* handle )
+
+  Summary:
+    This function stops the event stream.
+
+  Description:
+    This function stops the event stream, and terminates the read in
+    progress.  The events in the queue can still be read.
+
+  Preconditions:
+    None
+
+  Parameters:
+    void* handle - Pointer to a structure containing the Device Info
+
+  Returns:
+    None
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+void USBHostMIDIStreamStop( void* handle );
+
+
+/****************************************************************************
+  Function:
+    WORD USBHostMIDIStreamRead( void* handle, MIDI_TIMED_EVENT *events,
+                                WORD maxEvents )
+
+  Summary:
+    This function reads events from the event stream.
+
+  Description:
+    This function copies up to maxEvents of the oldest events out of the
+    event stream queue.
+
+  Preconditions:
+    None
+
+  Parameters:
+    void* handle             - Pointer to a structure containing the Device Info
+    MIDI_TIMED_EVENT *events - Buffer for the events
+    WORD maxEvents           - Number of events the buffer holds
+
+  Returns:
+    WORD - Number of events copied
+
+  Remarks:
+    This function can be called from the application event handler when it
+    receives EVENT_MIDI_STREAM_DATA.
+  ***************************************************************************/
+
+WORD USBHostMIDIStreamRead( void* handle, MIDI_TIMED_EVENT *events, WORD maxEvents );
+
+
+/****************************************************************************
+  Function:
+    WORD USBHostMIDIStreamCount( void* handle )
+
+  Description:
+    This function returns the number of events in the event stream queue.
+
+  Preconditions:
+    None
+
+  Parameters:
+    void* handle - Pointer to a structure containing the Device Info
+
+  Returns:
+    WORD - Number of events in the queue
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+#define USBHostMIDIStreamCount(a) ((MIDI_DEVICE*)a)->stream.count
+//WORD USBHostMIDIStreamCount( void* handle );
+#endif
+
+
+#if defined(USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+/****************************************************************************
+  Function:
+    BOOL USBHostMIDIQueueWrite( void* handle, USB_AUDIO_MIDI_PACKET packet )
+
+  Summary:
+    This function adds a packet to the write queue.
+
+  Description:
+    This function adds a USB MIDI packet to the write queue, or replaces a
+    waiting packet with the same target.  If the OUT endpoint is idle, the
+    packets are sent right away.  Otherwise, they are sent together when the
+    transfer in progress completes.
+
+  Preconditions:
+    The device must be connected and enumerated.
+
+  Parameters:
+    void* handle                 - Pointer to a structure containing the Device Info
+    USB_AUDIO_MIDI_PACKET packet - The packet to send
+
+  Return Values:
+    TRUE    - The packet was queued
+    FALSE   - The queue is full, or the interface has no OUT endpoint
+
+  Remarks:
+    Do not write to the OUT endpoint with USBHostMIDIWrite() while packets
+    are queued.
+  ***************************************************************************/
+
+BOOL USBHostMIDIQueueWrite( void* handle, USB_AUDIO_MIDI_PACKET packet );
+
+
+/****************************************************************************
+  Function:
+    WORD USBHostMIDIQueueCount( void* handle )
+
+  Description:
+    This function returns the number of packets waiting in the write queue.
+    The packets being sent are not counted.
+
+  Preconditions:
+    None
+
+  Parameters:
+    void* handle - Pointer to a structure containing the Device Info
+
+  Returns:
+    WORD - Number of packets waiting
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+#define USBHostMIDIQueueCount(a) ((MIDI_DEVICE*)a)->writeQueue.count
+//WORD USBHostMIDIQueueCount( void* handle );
+#endif
+
+
 /*************************************************************************
  * EOF usb_client_MIDI.h
  */
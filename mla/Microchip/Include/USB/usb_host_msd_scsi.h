@@ -297,6 +297,212 @@ BYTE    USBHostMSDSCSISectorRead( DWORD sectorAddress, BYTE *dataBuffer );
 BYTE    USBHostMSDSCSISectorWrite( DWORD sectorAddress, BYTE *dataBuffer, BYTE allowWriteToZero);
 
 
+/****************************************************************************
+  Function:
+    BYTE USBHostMSDSCSISectorsRead( DWORD sectorAddress, WORD sectorCount,
+                BYTE *dataBuffer )
+
+  Summary:
+    This function reads consecutive sectors.
+
+  Description:
+    This function uses one SCSI READ10 command to read sectorCount
+    consecutive sectors, so the CBW and CSW stages are performed once for
+    the whole run instead of once per sector.  The data is stored in the
+    application buffer, which must hold sectorCount sectors.
+
+  Precondition:
+    None
+
+  Parameters:
+    DWORD   sectorAddress   - address of the first sector to read
+    WORD    sectorCount     - number of sectors to read
+    BYTE    *dataBuffer     - buffer to store data
+
+  Return Values:
+    TRUE    - read performed successfully
+    FALSE   - read was not successful
+
+  Remarks:
+    This function blocks until the read is complete, calling USBTasks()
+    while waiting.  The READ10 command block is as follows:
+
+    <code>
+        Byte/Bit    7       6       5       4       3       2       1       0
+           0                    Operation Code (0x28)
+           1        [    RDPROTECT      ]  DPO     FUA      -     FUA_NV    -
+           2        [ (MSB)
+           3                        Logical Block Address
+           4
+           5                                                          (LSB) ]
+           6        [         -         ][          Group Number            ]
+           7        [ (MSB)         Transfer Length
+           8                                                          (LSB) ]
+           9        [                    Control                            ]
+    </code>
+  ***************************************************************************/
+
+BYTE    USBHostMSDSCSISectorsRead( DWORD sectorAddress, WORD sectorCount, BYTE *dataBuffer );
+
+
+/****************************************************************************
+  Function:
+    BYTE USBHostMSDSCSISectorsWrite( DWORD sectorAddress, WORD sectorCount,
+                BYTE *dataBuffer, BYTE allowWriteToZero )
+
+  Summary:
+    This function writes consecutive sectors.
+
+  Description:
+    This function uses one SCSI WRITE10 command to write sectorCount
+    consecutive sectors from the application buffer, so the CBW and CSW
+    stages are performed once for the whole run instead of once per sector.
+
+  Precondition:
+    None
+
+  Parameters:
+    DWORD   sectorAddress   - address of the first sector to write
+    WORD    sectorCount     - number of sectors to write
+    BYTE    *dataBuffer     - buffer with application data
+    BYTE    allowWriteToZero- If a write to sector 0 is allowed.
+
+  Return Values:
+    TRUE    - write performed successfully
+    FALSE   - write was not successful
+
+  Remarks:
+    This function blocks until the write is complete, calling USBTasks()
+    while waiting.  The WRITE10 command block is as follows:
+
+    <code>
+        Byte/Bit    7       6       5       4       3       2       1       0
+           0                    Operation Code (0x2A)
+           1        [    WRPROTECT      ]  DPO     FUA      -     FUA_NV    -
+           2        [ (MSB)
+           3                        Logical Block Address
+           4
+           5                                                          (LSB) ]
+           6        [         -         ][          Group Number            ]
+           7        [ (MSB)         Transfer Length
+           8                                                          (LSB) ]
+           9        [                    Control                            ]
+    </code>
+  ***************************************************************************/
+
+BYTE    USBHostMSDSCSISectorsWrite( DWORD sectorAddress, WORD sectorCount, BYTE *dataBuffer, BYTE allowWriteToZero );
+
+
+/****************************************************************************
+  Function:
+    BYTE USBHostMSDSCSISectorsReadSubmit( DWORD sectorAddress,
+                WORD sectorCount, BYTE *dataBuffer )
+
+  Summary:
+    This function starts reading consecutive sectors.
+
+  Description:
+    This function issues the READ10 command for sectorCount sectors and
+    returns without waiting for the data.  The transfer is performed while
+    the application keeps calling USBTasks() from its main loop.  Use
+    USBHostMSDSCSITransferPoll() to find out when it is complete.  The
+    buffer must not be used until then.
+
+  Precondition:
+    No other transfer is in progress.
+
+  Parameters:
+    DWORD   sectorAddress   - address of the first sector to read
+    WORD    sectorCount     - number of sectors to read
+    BYTE    *dataBuffer     - buffer to store data
+
+  Return Values:
+    USB_SUCCESS                 - The transfer was started
+    USB_MSD_DEVICE_NOT_FOUND    - No device is attached
+    USB_MSD_DEVICE_BUSY         - Another transfer is in progress
+    USB_MSD_INVALID_LUN         - The device has not reported its LUNs or
+                                  the sector size of LUN 0 is not known
+                                  (the media is not initialized)
+    USB_ILLEGAL_REQUEST         - sectorCount is 0
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+BYTE    USBHostMSDSCSISectorsReadSubmit( DWORD sectorAddress, WORD sectorCount, BYTE *dataBuffer );
+
+
+/****************************************************************************
+  Function:
+    BYTE USBHostMSDSCSISectorsWriteSubmit( DWORD sectorAddress,
+                WORD sectorCount, BYTE *dataBuffer, BYTE allowWriteToZero )
+
+  Summary:
+    This function starts writing consecutive sectors.
+
+  Description:
+    This function issues the WRITE10 command for sectorCount sectors and
+    returns without waiting for the data to be sent.  The transfer is
+    performed while the application keeps calling USBTasks() from its main
+    loop.  Use USBHostMSDSCSITransferPoll() to find out when it is complete.
+    The buffer must not be modified until then.
+
+  Precondition:
+    No other transfer is in progress.
+
+  Parameters:
+    DWORD   sectorAddress   - address of the first sector to write
+    WORD    sectorCount     - number of sectors to write
+    BYTE    *dataBuffer     - buffer with application data
+    BYTE    allowWriteToZero- If a write to sector 0 is allowed.
+
+  Return Values:
+    USB_SUCCESS                 - The transfer was started
+    USB_MSD_DEVICE_NOT_FOUND    - No device is attached
+    USB_MSD_DEVICE_BUSY         - Another transfer is in progress
+    USB_MSD_INVALID_LUN         - The device has not reported its LUNs or
+                                  the sector size of LUN 0 is not known
+                                  (the media is not initialized)
+    USB_ILLEGAL_REQUEST         - sectorCount is 0 or the write to sector 0
+                                  is not allowed
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+BYTE    USBHostMSDSCSISectorsWriteSubmit( DWORD sectorAddress, WORD sectorCount, BYTE *dataBuffer, BYTE allowWriteToZero );
+
+
+/****************************************************************************
+  Function:
+    BOOL USBHostMSDSCSITransferPoll( BYTE *errorCode )
+
+  Summary:
+    This function checks if a submitted transfer is complete.
+
+  Description:
+    This function checks the transfer started by
+    USBHostMSDSCSISectorsReadSubmit() or USBHostMSDSCSISectorsWriteSubmit().
+    It does not call USBTasks(), the application must keep calling it.
+
+  Precondition:
+    A transfer was submitted.
+
+  Parameters:
+    BYTE    *errorCode      - Error code of the completed transfer,
+                              USB_SUCCESS if the sectors were transferred
+
+  Return Values:
+    TRUE    - The transfer is complete (or the device was detached)
+    FALSE   - The transfer is still in progress
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+BOOL    USBHostMSDSCSITransferPoll( BYTE *errorCode );
+
+
 /****************************************************************************
   Function:
     BYTE USBHostMSDSCSIWriteProtectState( void )
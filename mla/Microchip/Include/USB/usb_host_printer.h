@@ -94,6 +94,8 @@ CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
   2.7           Minor updates to USBHostPrinterGetStatus() header
                 to better describe the function requirements and
                 operation.
+  2.9j          Added the USB_PRINTER_IMAGE_DATA_BAND command and
+                USBHostPrinterWriteIsQueued().
 ********************************************************************/
 //DOM-IGNORE-END
 
@@ -548,6 +550,22 @@ typedef enum
     // Help file for more information about printing images.
     USB_PRINTER_IMAGE_DATA,
 
+    // This command can be issued instead of the USB_PRINTER_IMAGE_DATA_HEADER
+    // and USB_PRINTER_IMAGE_DATA commands to send several rows of bitmapped
+    // image data in a single transfer.  The *data parameter should point to a
+    // variable of type USB_PRINTER_IMAGE_BAND, and size should be the width
+    // of the image in pixels.  Each row in the band is in the format of the
+    // USB_PRINTER_IMAGE_DATA command, and must be in RAM.  The rows, with
+    // the commands that introduce them, are formatted into the output buffer
+    // of the band, compressed if the printer language allows it, and the
+    // output buffer is sent to the printer without being copied.  The output
+    // buffer must not be changed until the transfer is complete.  Use
+    // USBHostPrinterWriteIsQueued() to check this, so that two output buffers
+    // can be used in turn.  The transferFlags parameter must not specify
+    // USB_PRINTER_TRANSFER_COPY_DATA.  Refer to the USB_PRINTER_IMAGE_START
+    // command for the sequence required to print an image.
+    USB_PRINTER_IMAGE_DATA_BAND,
+
     // This command is used to terminate printing a bitmapped image.  Refer to
     // the USB_PRINTER_IMAGE_START command for the sequence required to print
     // an image.
@@ -1267,6 +1285,32 @@ typedef struct
 } USB_PRINTER_IMAGE_INFO;
 
 
+//-----------------------------------------------------------------------------
+/* Bitmapped Image Band Information
+
+This structure is used with the USB_PRINTER_IMAGE_DATA_BAND command to send
+several rows of a bitmapped image in one transfer.  For full sheet printers, a
+row is one line of pixels, (width + 7) / 8 bytes long.  For POS printers, a row
+is one line of the bit image, as many dots high as the vertical density, and
+width times the number of bytes per column long.  The output buffer must be at
+least USB_PRINTER_IMAGE_BAND_SIZE( rowLength, rowCount ) bytes, where
+rowLength is the length of a row as described above.
+*/
+typedef struct
+{
+    BYTE    *rows;              // The image data, rowCount rows of rowBytes bytes each.
+    BYTE    *output;            // Buffer for the formatted band.  It is sent to
+                                // the printer without being copied.
+    WORD    rowBytes;           // Distance in bytes from one row to the next.
+    WORD    rowCount;           // Number of rows in the band.
+    DWORD   outputSize;         // Size of the output buffer.
+} USB_PRINTER_IMAGE_BAND;
+
+// Size of the output buffer needed for a band of rowCount rows of rowLength
+// bytes, for any of the supported printer languages.
+#define USB_PRINTER_IMAGE_BAND_SIZE(rowLength,rowCount)     ((DWORD)(rowCount) * (2 * (DWORD)(rowLength) + 16))
+
+
 //-----------------------------------------------------------------------------
 /* USB Printer Graphics Parameter Structures
 
@@ -2228,6 +2272,35 @@ BYTE USBHostPrinterWrite( BYTE deviceAddress, void *buffer, DWORD length,
             BYTE flags);
 
 
+/****************************************************************************
+  Function:
+    BOOL USBHostPrinterWriteIsQueued( BYTE deviceAddress, void *buffer )
+
+  Description:
+    This interface is used to check if a buffer is still in the output
+    queue, either waiting to be sent or being sent to the printer.
+
+  Preconditions:
+    None
+
+  Parameters:
+    BYTE deviceAddress  - USB Address of the device
+    void *buffer        - Pointer to the data buffer
+
+  Return Values:
+    TRUE    - A transfer of the buffer is queued or in progress.
+    FALSE   - The buffer is not in the output queue, or an invalid
+                deviceAddress is given.  The buffer can be reused.
+
+  Remarks:
+    This allows an application or a printer language to keep two output
+    buffers in use, filling one while the other is sent.  See the
+    USB_PRINTER_IMAGE_DATA_BAND command.
+  ***************************************************************************/
+
+BOOL USBHostPrinterWriteIsQueued( BYTE deviceAddress, void *buffer );
+
+
 /****************************************************************************
   Function:
     BOOL USBHostPrinterWriteComplete( BYTE deviceAddress )
@@ -13,6 +13,11 @@
     The label USE_GRAPHICS_LIBRARY_PRINTER_INTERFACE must be defining in the
     USB configuration header file usb_config.h to utilize these functions.
 
+    To send the screen image in bands, define the label
+    USB_PRINTER_PRINT_SCREEN_BAND_ROWS in usb_config.h as the number of rows
+    in each band.  Each band is sent to the printer in one transfer, and
+    compressed if the printer language allows it.
+
   Remarks:
     None
 
@@ -151,7 +156,12 @@ typedef struct
                 be returned upon successful completion.
 
   Remarks:
-    None
+    If USB_PRINTER_PRINT_SCREEN_BAND_ROWS is defined, the image is sent in
+    bands of that many rows with the USB_PRINTER_IMAGE_DATA_BAND command.
+    Two band buffers are used in turn, so the next band is read from the
+    display while the previous one is sent to the printer.  In this mode,
+    the function does not report completion until the printer has received
+    the whole image, so the buffers can be released.
   ***************************************************************************/
 
 SHORT PrintScreen( BYTE address, USB_PRINT_SCREEN_INFO *printScreenInfo );
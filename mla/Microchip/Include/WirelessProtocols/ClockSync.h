@@ -0,0 +1,171 @@
+/********************************************************************
+* FileName:		ClockSync.h
+* Dependencies: GenericTypeDefs.h
+* Processor:	PIC24F, PIC24H, PIC32, dsPIC30, dsPIC33
+* Complier:     Microchip C30 v2.03 or higher
+*               Microchip C32 v1.02 or higher
+* Company:		Microchip Technology, Inc.
+*
+* Copyright and Disclaimer Notice
+*
+* Copyright  2007-2010 Microchip Technology Inc.  All rights reserved.
+*
+* Microchip licenses to you the right to use, modify, copy and distribute 
+* Software only when embedded on a Microchip microcontroller or digital 
+* signal controller and used with a Microchip radio frequency transceiver, 
+* which are integrated into your product or third party product (pursuant 
+* to the terms in the accompanying license agreement).   
+*
+* You should refer to the license agreement accompanying this Software for 
+* additional information regarding your rights and obligations.
+*
+* SOFTWARE AND DOCUMENTATION ARE PROVIDED AS IS WITHOUT WARRANTY OF ANY 
+* KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION, ANY 
+* WARRANTY OF MERCHANTABILITY, TITLE, NON-INFRINGEMENT AND FITNESS FOR A 
+* PARTICULAR PURPOSE. IN NO EVENT SHALL MICROCHIP OR ITS LICENSORS BE 
+* LIABLE OR OBLIGATED UNDER CONTRACT, NEGLIGENCE, STRICT LIABILITY, 
+* CONTRIBUTION, BREACH OF WARRANTY, OR OTHER LEGAL EQUITABLE THEORY ANY 
+* DIRECT OR INDIRECT DAMAGES OR EXPENSES INCLUDING BUT NOT LIMITED TO 
+* ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE OR CONSEQUENTIAL DAMAGES, 
+* LOST PROFITS OR LOST DATA, COST OF PROCUREMENT OF SUBSTITUTE GOODS, 
+* TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES (INCLUDING BUT 
+* NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+*
+*********************************************************************
+* File Description:
+*
+*  This file provides the clock synchronization service.  A master
+*  broadcasts a SYNC frame and then a FOLLOW_UP frame with the time
+*  the SYNC frame was sent.  A slave pairs the time it received the
+*  SYNC frame with the master time in the FOLLOW_UP frame, and keeps
+*  a clock that follows the master.
+*
+*  All times are in nanoseconds.  The local clock extends a 32-bit
+*  free running timer to 64 bits, so that nodes with different timer
+*  frequencies share the same time base.
+*
+*  The calculations and the message format do not use the radio, so
+*  they can be compiled and checked on a development host.
+*
+* Change History:
+*  Rev   Date         Description
+*  4.2   10/18/2026   Initial revision
+********************************************************************/
+
+#ifndef __CLOCK_SYNC_H_
+#define __CLOCK_SYNC_H_
+
+/************************ HEADERS **********************************/
+
+#include "GenericTypeDefs.h"
+
+/************************ DEFINITIONS ******************************/
+
+#if defined(__18CXX)
+    #error "Clock synchronization requires 64-bit integers, which C18 does not support"
+#endif
+
+// Message types, in the first byte of the message
+#define CLOCK_SYNC_MSG_SYNC             0x01
+#define CLOCK_SYNC_MSG_FOLLOW_UP        0x02
+
+// A SYNC message is the type and a sequence number.  A FOLLOW_UP message
+// adds the 64-bit master time the SYNC frame was sent, least significant
+// byte first.
+#define CLOCK_SYNC_SYNC_SIZE            2
+#define CLOCK_SYNC_FOLLOW_UP_SIZE       10
+
+// A difference between the master time and the clock larger than this,
+// in nanoseconds, sets the clock to the master time instead of slewing it.
+#if !defined(CLOCK_SYNC_STEP_THRESHOLD)
+    #define CLOCK_SYNC_STEP_THRESHOLD   1000000
+#endif
+
+// Each sample moves the rate of the clock by 1/2^n of the rate
+// difference measured since the previous sample.
+#if !defined(CLOCK_SYNC_RATE_SHIFT)
+    #define CLOCK_SYNC_RATE_SHIFT       2
+#endif
+
+// Largest rate difference between the clock and the local timer, in
+// 2^-32 (500 ppm)
+#if !defined(CLOCK_SYNC_MAX_RATE)
+    #define CLOCK_SYNC_MAX_RATE         2147483
+#endif
+
+// Each sample moves the clock by 1/2^n of the difference between the
+// master time and the clock.
+#if !defined(CLOCK_SYNC_PHASE_SHIFT)
+    #define CLOCK_SYNC_PHASE_SHIFT      1
+#endif
+
+// The clock is locked after this many samples in a row within
+// CLOCK_SYNC_STEP_THRESHOLD.
+#if !defined(CLOCK_SYNC_LOCK_SAMPLES)
+    #define CLOCK_SYNC_LOCK_SAMPLES     4
+#endif
+
+// Time from the end of a frame on the air to the receive timestamp,
+// minus the time from the end of the frame to the transmit timestamp,
+// in nanoseconds.  It is subtracted from the receive time.
+#if !defined(CLOCK_SYNC_LATENCY)
+    #define CLOCK_SYNC_LATENCY          0
+#endif
+
+/************************ DATA TYPES *******************************/
+
+// Local clock.  Extends a 32-bit free running timer to nanoseconds.
+typedef struct _CLOCK_SYNC_CLOCK
+{
+    QWORD   time;           // Nanoseconds at tick
+    DWORD   tick;           // Timer value of the last update
+    DWORD   fraction;       // Fraction of a nanosecond at tick, in 2^-32
+    DWORD   nsPerTick;      // Whole nanoseconds per timer tick
+    DWORD   nsPerTickFrac;  // Fraction of a nanosecond per timer tick, in 2^-32
+} CLOCK_SYNC_CLOCK;
+
+// Clock synchronization state of a node
+typedef struct _CLOCK_SYNC
+{
+    CLOCK_SYNC_CLOCK clock; // Local clock
+    QWORD   localRef;       // Local time of the reference point
+    QWORD   masterRef;      // Master time of the reference point
+    LONG    rate;           // Master rate minus local rate, in 2^-32
+    LONG    lastError;      // Master time minus the clock at the last sample
+    QWORD   rxTime;         // Local time the last SYNC frame was received
+    BYTE    rxSeq;          // Sequence number of the last SYNC frame received
+    BYTE    txSeq;          // Sequence number of the next SYNC frame sent
+    BYTE    samples;        // Samples in a row within the step threshold
+    union
+    {
+        BYTE Val;
+        struct
+        {
+            BYTE rxPending  :1; // A SYNC frame waits for its FOLLOW_UP
+            BYTE sampled    :1; // The reference point is a master sample
+            BYTE locked     :1; // The clock follows the master
+        } bits;
+    } flags;
+} CLOCK_SYNC;
+
+/************************ FUNCTION PROTOTYPES **********************/
+
+void    ClockSyncClockInit(CLOCK_SYNC_CLOCK *clock, DWORD tickHz, DWORD tick);
+void    ClockSyncClockUpdate(CLOCK_SYNC_CLOCK *clock, DWORD tick);
+QWORD   ClockSyncClockTime(CLOCK_SYNC_CLOCK *clock, DWORD tick);
+
+void    ClockSyncInit(CLOCK_SYNC *sync, DWORD tickHz, DWORD tick);
+void    ClockSyncSetTime(CLOCK_SYNC *sync, QWORD localTime, QWORD masterTime);
+BOOL    ClockSyncAddSample(CLOCK_SYNC *sync, QWORD localTime, QWORD masterTime);
+QWORD   ClockSyncToMaster(CLOCK_SYNC *sync, QWORD localTime);
+QWORD   ClockSyncToLocal(CLOCK_SYNC *sync, QWORD masterTime);
+
+BYTE    ClockSyncBuildSync(CLOCK_SYNC *sync, BYTE *buffer);
+BYTE    ClockSyncBuildFollowUp(CLOCK_SYNC *sync, QWORD txTime, BYTE *buffer);
+BOOL    ClockSyncReceive(CLOCK_SYNC *sync, BYTE *buffer, BYTE length, QWORD rxTime);
+
+/************************ MACROS ***********************************/
+
+#define ClockSyncIsLocked(sync)     ((sync)->flags.bits.locked)
+
+#endif
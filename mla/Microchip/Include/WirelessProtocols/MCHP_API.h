@@ -64,6 +64,10 @@
         #include "WirelessProtocols/MiWiPRO/MiWiPRO.h"
     #endif
     
+    #if defined(ENABLE_CLOCK_SYNC)
+        #include "WirelessProtocols/ClockSync.h"
+    #endif
+    
     #define INPUT
     #define OUTPUT
     #define IOPUT
@@ -967,6 +971,124 @@
     BOOL MiApp_ResyncConnection(BYTE ConnectionIndex, DWORD ChannelMap);
 
 
+    #if defined(ENABLE_CLOCK_SYNC)
+    /************************************************************************************
+     * Function:
+     *      BOOL MiApp_ClockSyncSend(void)
+     *
+     * Summary:
+     *      This function broadcasts the time of the node to the nodes around it
+     *
+     * Description:        
+     *      This function broadcasts a SYNC command frame, reads the time it was sent
+     *      from the transmit interrupt of the transceiver, and broadcasts that time
+     *      in a FOLLOW_UP command frame. The nodes that receive both frames adjust 
+     *      their clocks toward the time of this node. The master calls it 
+     *      periodically. A node whose clock follows the master can call it as well,
+     *      to pass the time on to the nodes that cannot hear the master.
+     *
+     * PreCondition:    
+     *      Protocol initialization has been done. No message is being written in
+     *      TxBuffer.
+     *
+     * Parameters: 
+     *      None
+     *
+     * Returns: 
+     *      A boolean to indicate if both frames have been sent
+     *
+     * Example:
+     *      <code>
+     *      tick = MiWi_TickGet();
+     *      if( MiWi_TickGetDiff(tick, lastSyncTick) > ONE_SECOND )
+     *      {
+     *          MiApp_ClockSyncSend();
+     *          lastSyncTick = tick;
+     *      }
+     *      </code>
+     *
+     * Remarks:    
+     *      Define CLOCK_SYNC_MASTER on the node whose clock is the time base, so that
+     *      it ignores the frames of other nodes. The frames are not secured, as the 
+     *      MRF24J40 interrupts again after decrypting a frame, which would delay the
+     *      receive timestamp.
+     *
+     *****************************************************************************************/ 
+    BOOL    MiApp_ClockSyncSend(void);
+
+    /************************************************************************************
+     * Function:
+     *      QWORD MiApp_ClockSyncGetTime(void)
+     *
+     * Summary:
+     *      This function returns the master time
+     *
+     * Description:        
+     *      This function reads the high resolution timer and returns the time of the
+     *      master, in nanoseconds. Before the first FOLLOW_UP frame is received, it 
+     *      returns the time since the protocol was initialized.
+     *
+     * PreCondition:    
+     *      Protocol initialization has been done.
+     *
+     * Parameters: 
+     *      None
+     *
+     * Returns: 
+     *      The master time in nanoseconds
+     *
+     * Example:
+     *      <code>
+     *      if( MiApp_ClockSyncIsLocked() )
+     *      {
+     *          now = MiApp_ClockSyncGetTime();
+     *      }
+     *      </code>
+     *
+     * Remarks:    
+     *      The clock counts the high resolution timer in MiApp_MessageAvailable(), 
+     *      which must be called more often than half the time the timer takes to 
+     *      roll over, or 53 seconds for the core timer of a PIC32 at 80MHz.
+     *
+     *****************************************************************************************/ 
+    QWORD   MiApp_ClockSyncGetTime(void);
+
+    /************************************************************************************
+     * Function:
+     *      void MiApp_ClockSyncSetTime(QWORD Time)
+     *
+     * Summary:
+     *      This function sets the time of the node
+     *
+     * Description:        
+     *      This function sets the clock of the node to the input time, in nanoseconds.
+     *      The master uses it to follow an external time base, such as the time 
+     *      received over Ethernet, so that the nodes that follow the master share it.
+     *
+     * PreCondition:    
+     *      Protocol initialization has been done.
+     *
+     * Parameters: 
+     *      QWORD Time -    The current time in nanoseconds
+     *
+     * Returns: 
+     *      None
+     *
+     * Example:
+     *      <code>
+     *      MiApp_ClockSyncSetTime(EthernetTime);
+     *      </code>
+     *
+     * Remarks:    
+     *      None
+     *
+     *****************************************************************************************/ 
+    void    MiApp_ClockSyncSetTime(QWORD Time);
+    
+    #define MiApp_ClockSyncIsLocked()   ClockSyncIsLocked(&ClockSync)
+    #endif
+
+
     // Callback functions
     #define MiApp_CB_AllowConnection(handleInConnectionTable) TRUE
     //BOOL MiApp_CB_AllowConnection(BYTE handleInConnectionTable);
@@ -974,6 +1096,9 @@
     //void MiApp_CB_RFDAcknowledgement(WORD sourceAddr, BYTE Seq);
     
     extern RECEIVED_MESSAGE rxMessage;
+    #if defined(ENABLE_CLOCK_SYNC)
+        extern CLOCK_SYNC ClockSync;
+    #endif
     #if defined(ENABLE_TIME_SYNC)
         extern WORD_VAL CounterValue;
         extern WORD_VAL WakeupTimes;
@@ -46,6 +46,7 @@
 *  2.0   4/15/2009    MiMAC and MiApp revision
 *  2.1   06/20/2009   Add LCD support
 *  3.1   5/28/2010    MiWi DE 3.1
+*  4.2   10/18/2026   Add SPIPutArray and SPIGetArray
 ********************************************************************/
 
 #ifndef _SPI_H_
@@ -60,6 +61,9 @@
 void SPIPut(BYTE v);
 BYTE SPIGet(void);
 
+void SPIPutArray(BYTE *buffer, BYTE count);
+void SPIGetArray(BYTE *buffer, BYTE count);
+
 void SPIPut2(BYTE v);
 BYTE SPIGet2(void);
 
@@ -43,6 +43,7 @@
 *  1.0   01/09/2007   yfy       Initial release
 *  3.1   5/28/2010    yfy       MiWi DE 3.1
 *  4.1   6/3/2011     yfy       MAL v2011-06
+*  4.2   10/18/2026             Clock synchronization command
 ********************************************************************/
 
 #ifndef __MIWI_H_
@@ -96,6 +97,7 @@ void DumpConnection(BYTE index);
 
 #define MAC_COMMAND_TIME_SYNC_DATA_PACKET               0x8A
 #define MAC_COMMAND_TIME_SYNC_COMMAND_PACKET            0x8B
+#define MAC_COMMAND_CLOCK_SYNC                          0x8C
 
 
 #define MIWI_PROTOCOL_ID 0x4D
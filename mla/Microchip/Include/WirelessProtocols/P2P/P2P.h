@@ -46,6 +46,7 @@
 *  2.1   06/20/2009   yfy       Add LCD support
 *  3.1   5/28/2010    yfy       MiWi DE 3.1
 *  4.1   6/3/2011     yfy       MAL v2011-06
+*  4.2   10/18/2026             Clock synchronization command
 ********************************************************************/
 
 #ifndef __P2P_H_
@@ -85,6 +86,7 @@
 
 #define CMD_TIME_SYNC_DATA_PACKET               0x8A
 #define CMD_TIME_SYNC_COMMAND_PACKET            0x8B
+#define CMD_CLOCK_SYNC                          0x8C
 
 #define CMD_P2P_CONNECTION_RESPONSE             0x91
 #define CMD_P2P_CONNECTION_REMOVAL_RESPONSE     0x92
@@ -49,6 +49,7 @@
 *  2.1   06/20/2009   yfy       Add LCD support
 *  3.1   5/28/2010    yfy       MiWi DE 3.1
 *  4.1   6/3/2011     yfy       MAL v2011-06
+*  4.2   10/18/2026             Add MiWi_HighResTickGet
 ********************************************************************/
 
 #ifndef __SYMBOL_TIME_H_
@@ -186,6 +187,24 @@
 
 #define MiWi_TickGetDiff(a,b) (a.Val - b.Val)
 
+/******************************************************************
+ // MiWi_HighResTickGet() reads a free running 32-bit timer that
+ // timestamps frames for the clock synchronization, and
+ // HIGH_RES_TICK_FREQ is its frequency in Hz. PIC32 uses the core
+ // timer, which counts at half of the system clock. The other
+ // processors use the symbol timer, unless the application defines
+ // both macros for a faster timer.
+ *****************************************************************/
+#if !defined(HIGH_RES_TICK_FREQ)
+    #if defined(__PIC32MX__)
+        #define HIGH_RES_TICK_FREQ      (CLOCK_FREQ/2)
+        #define MiWi_HighResTickGet()   ReadCoreTimer()
+    #else
+        #define HIGH_RES_TICK_FREQ      ONE_SECOND
+        #define MiWi_HighResTickGet()   (MiWi_TickGet().Val)
+    #endif
+#endif
+
 /************************ DATA TYPES *******************************/
 
 
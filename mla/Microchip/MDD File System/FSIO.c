@@ -6833,7 +6833,11 @@ int FSfeof( FSFILE * stream )
     to 'n' unless an error occured or the user tried to read beyond the end
     of the file.
   Remarks:
-    None.
+    If the physical layer can read several consecutive sectors with one
+    command, define MDD_SectorsRead in FSconfig.h (for example,
+    #define MDD_SectorsRead USBHostMSDSCSISectorsRead).  Whole sectors that
+    lie in the same cluster are then read directly into 'ptr' with one call
+    instead of one sector at a time through the data buffer.
   **************************************************************************/
 
 size_t FSfread (void *ptr, size_t size, size_t n, FSFILE *stream)
@@ -6845,6 +6849,9 @@ size_t FSfread (void *ptr, size_t size, size_t n, FSFILE *stream)
     WORD    pos;       //position within sector
     CETYPE   error = CE_GOOD;
     WORD    readCount = 0;
+#ifdef MDD_SectorsRead
+    DWORD   count;
+#endif
 
     FSerrno = CE_GOOD;
 
@@ -6916,6 +6923,35 @@ size_t FSfread (void *ptr, size_t size, size_t n, FSFILE *stream)
             sec_sel = Cluster2Sector(dsk,stream->ccls);
             sec_sel += (WORD)stream->sec;      // add the sector number to it
 
+#ifdef MDD_SectorsRead
+            // Read the whole sectors left in this cluster straight into the
+            // caller's buffer.  The data buffer is not touched, so
+            // gLastDataSectorRead still describes its contents.
+            count = stream->size - seek;
+            if (count > len)
+                count = len;
+            count /= dsk->sectorSize;
+            if (count > (DWORD)(dsk->SecPerClus - stream->sec))
+                count = dsk->SecPerClus - stream->sec;
+
+            if (count)
+            {
+                if( !MDD_SectorsRead( sec_sel, (WORD)count, pointer) )
+                {
+                    FSerrno = CE_BAD_SECTOR_READ;
+                    error = CE_BAD_SECTOR_READ;
+                    break;
+                }
+                stream->sec += (WORD)count - 1;
+                count *= dsk->sectorSize;
+                pointer += count;
+                seek += count;
+                readCount += count;
+                len -= count;
+                pos = dsk->sectorSize;
+                continue;
+            }
+#endif
 
             gBufferOwner = stream;
             gBufferZeroed = FALSE;
@@ -0,0 +1,546 @@
+/******************************************************************************
+
+                Microchip Memory Disk Drive File System
+
+ *****************************************************************************
+  FileName:        Host File.c
+  Dependencies:    See includes section.
+  Processor:       Host (Linux, Windows)
+  Compiler:        GCC
+  Company:         Microchip Technology, Inc.
+
+  Software License Agreement
+
+  The software supplied herewith by Microchip Technology Incorporated
+  (the "Company") for its PICmicro(R) Microcontroller is intended and
+  supplied to you, the Company's customer, for use solely and
+  exclusively on Microchip PICmicro Microcontroller products. The
+  software is owned by the Company and/or its supplier, and is
+  protected under applicable copyright laws. All rights are reserved.
+  Any use in violation of the foregoing restrictions may subject the
+  user to criminal sanctions under applicable laws, as well as to
+  civil liability for the breach of the terms and conditions of this
+  license.
+
+  THIS SOFTWARE IS PROVIDED IN AN "AS IS" CONDITION. NO WARRANTIES,
+  WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+  TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+  PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+  IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+  CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+
+*****************************************************************************/
+
+#include <stdio.h>
+#include "GenericTypeDefs.h"
+#include "MDD File System/FSDefs.h"
+#include "MDD File System/Host File.h"
+#include "FSconfig.h"
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+
+static MEDIA_INFORMATION mediaInformation;
+static FILE* imageFile;             //Disk image, NULL if no media is "inserted"
+static DWORD imageSectors;          //Number of whole sectors in the image
+static BOOL imageWriteProtect;
+static WORD busyLatency;            //ASYNC_x_BUSY returns per block, to emulate media access time
+
+static ASYNC_IO ioInfo;             //Local copy of the async request
+static WORD blockCounter;           //Bytes left in the current block
+static WORD busyCounter;
+
+//Read state used while the emulated media fetches the next block.
+#define HOST_FILE_READ_MEDIA_BUSY   0x03
+
+/******************************************************************************
+ * Function:        BOOL MDD_HostFile_Open(const char* path, BOOL writeProtect)
+ *
+ * PreCondition:    None
+ *
+ * Input:           path         - Disk image file.  Its size should be a
+ *                                 multiple of MEDIA_SECTOR_SIZE.
+ *                  writeProtect - TRUE to report the media as write protected
+ *
+ * Output:          TRUE  - The image was opened, the media is "inserted"
+ *                  FALSE - The image could not be opened
+ *
+ * Side Effects:    Closes the image opened before, if any.
+ *
+ * Overview:        Selects the disk image that the other functions operate on.
+ *
+ * Note:            None
+ *****************************************************************************/
+BOOL MDD_HostFile_Open(const char* path, BOOL writeProtect)
+{
+    long size;
+
+    MDD_HostFile_Close();
+
+    imageFile = fopen(path, writeProtect ? "rb" : "r+b");
+    if(imageFile == NULL)
+    {
+        return FALSE;
+    }
+
+    fseek(imageFile, 0, SEEK_END);
+    size = ftell(imageFile);
+    if(size < MEDIA_SECTOR_SIZE)
+    {
+        MDD_HostFile_Close();
+        return FALSE;
+    }
+
+    imageSectors = (DWORD)(size / MEDIA_SECTOR_SIZE);
+    imageWriteProtect = writeProtect;
+    return TRUE;
+}
+
+/******************************************************************************
+ * Function:        void MDD_HostFile_Close(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Closes the disk image.  MDD_HostFile_MediaDetect() returns
+ *                  FALSE until another image is opened.
+ *
+ * Note:            None
+ *****************************************************************************/
+void MDD_HostFile_Close(void)
+{
+    if(imageFile != NULL)
+    {
+        fclose(imageFile);
+        imageFile = NULL;
+    }
+    imageSectors = 0;
+}
+
+/******************************************************************************
+ * Function:        void MDD_HostFile_SetLatency(WORD busyCalls)
+ *
+ * PreCondition:    None
+ *
+ * Input:           busyCalls - Number of calls to the async tasks functions
+ *                              that return ASYNC_READ_BUSY/ASYNC_WRITE_BUSY
+ *                              before each block is available or written.
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Emulates the access time of real media, so that the
+ *                  overlap between USB transfers and media access in the
+ *                  callers can be exercised.  The default is 0.
+ *
+ * Note:            None
+ *****************************************************************************/
+void MDD_HostFile_SetLatency(WORD busyCalls)
+{
+    busyLatency = busyCalls;
+}
+
+/******************************************************************************
+ * Function:        BYTE MDD_HostFile_MediaDetect(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          TRUE  - A disk image is open
+ *                  FALSE - No disk image
+ *
+ * Side Effects:    None
+ *
+ * Overview:        None
+ *
+ * Note:            None
+ *****************************************************************************/
+BYTE MDD_HostFile_MediaDetect(void)
+{
+    return (imageFile != NULL);
+}
+
+/******************************************************************************
+ * Function:        MEDIA_INFORMATION * MDD_HostFile_MediaInitialize(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          Returns a pointer to a MEDIA_INFORMATION structure
+ *
+ * Side Effects:    Aborts a read or write in progress.
+ *
+ * Overview:        None
+ *
+ * Note:            None
+ *****************************************************************************/
+MEDIA_INFORMATION * MDD_HostFile_MediaInitialize(void)
+{
+    ioInfo.bStateVariable = ASYNC_READ_COMPLETE;
+
+    mediaInformation.validityFlags.bits.sectorSize = TRUE;
+    mediaInformation.sectorSize = MEDIA_SECTOR_SIZE;
+
+    if(imageFile == NULL)
+    {
+        mediaInformation.errorCode = MEDIA_DEVICE_NOT_PRESENT;
+    }
+    else
+    {
+        mediaInformation.errorCode = MEDIA_NO_ERROR;
+    }
+    return &mediaInformation;
+}
+
+/******************************************************************************
+ * Function:        DWORD MDD_HostFile_ReadCapacity(void)
+ *
+ * PreCondition:    MediaInitialize() is complete
+ *
+ * Input:           None
+ *
+ * Output:          DWORD - The last valid LBA address of the image
+ *
+ * Side Effects:    None
+ *
+ * Overview:        None
+ *
+ * Note:            None
+ *****************************************************************************/
+DWORD MDD_HostFile_ReadCapacity(void)
+{
+    return (imageSectors - 1);
+}
+
+/******************************************************************************
+ * Function:        WORD MDD_HostFile_ReadSectorSize(void)
+ *
+ * PreCondition:    MediaInitialize() is complete
+ *
+ * Input:           None
+ *
+ * Output:          WORD - size of the sectors for this physical media.
+ *
+ * Side Effects:    None
+ *
+ * Overview:        None
+ *
+ * Note:            None
+ *****************************************************************************/
+WORD MDD_HostFile_ReadSectorSize(void)
+{
+    return MEDIA_SECTOR_SIZE;
+}
+
+/******************************************************************************
+ * Function:        BYTE MDD_HostFile_InitIO(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          TRUE
+ *
+ * Side Effects:    None
+ *
+ * Overview:        There is no I/O to initialize.
+ *
+ * Note:            None
+ *****************************************************************************/
+BYTE MDD_HostFile_InitIO(void)
+{
+    return TRUE;
+}
+
+/******************************************************************************
+ * Function:        BYTE MDD_HostFile_SectorRead(DWORD sector_addr, BYTE* buffer)
+ *
+ * PreCondition:    None
+ *
+ * Input:           sector_addr - Sector address
+ *                  buffer      - Buffer where data will be stored
+ *
+ * Output:          Returns TRUE if read successful, FALSE otherwise
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Reads MEDIA_SECTOR_SIZE bytes from the image.
+ *
+ * Note:            None
+ *****************************************************************************/
+BYTE MDD_HostFile_SectorRead(DWORD sector_addr, BYTE* buffer)
+{
+    if((imageFile == NULL) || (sector_addr >= imageSectors))
+    {
+        return FALSE;
+    }
+
+    if(fseek(imageFile, (long)sector_addr * MEDIA_SECTOR_SIZE, SEEK_SET) != 0)
+    {
+        return FALSE;
+    }
+    return (fread(buffer, 1, MEDIA_SECTOR_SIZE, imageFile) == MEDIA_SECTOR_SIZE);
+}
+
+/******************************************************************************
+ * Function:        BYTE MDD_HostFile_SectorWrite(DWORD sector_addr,
+ *                                    BYTE* buffer, BYTE allowWriteToZero)
+ *
+ * PreCondition:    None
+ *
+ * Input:           sector_addr      - Sector address
+ *                  buffer           - Buffer with the data to write
+ *                  allowWriteToZero - If a write to sector 0 is allowed.
+ *
+ * Output:          Returns TRUE if write successful, FALSE otherwise
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Writes MEDIA_SECTOR_SIZE bytes to the image.
+ *
+ * Note:            None
+ *****************************************************************************/
+BYTE MDD_HostFile_SectorWrite(DWORD sector_addr, BYTE* buffer, BYTE allowWriteToZero)
+{
+    if((imageFile == NULL) || imageWriteProtect || (sector_addr >= imageSectors))
+    {
+        return FALSE;
+    }
+    if((sector_addr == 0) && (allowWriteToZero == FALSE))
+    {
+        return FALSE;
+    }
+
+    if(fseek(imageFile, (long)sector_addr * MEDIA_SECTOR_SIZE, SEEK_SET) != 0)
+    {
+        return FALSE;
+    }
+    return (fwrite(buffer, 1, MEDIA_SECTOR_SIZE, imageFile) == MEDIA_SECTOR_SIZE);
+}
+
+/******************************************************************************
+ * Function:        BYTE MDD_HostFile_AsyncReadTasks(ASYNC_IO* info)
+ *
+ * PreCondition:    info->bStateVariable is set to ASYNC_READ_QUEUED to start
+ *                  a read, the other fields as for MDD_SDSPI_AsyncReadTasks().
+ *
+ * Input:           info - Read request
+ *
+ * Output:          ASYNC_READ_BUSY, ASYNC_READ_NEW_PACKET_READY,
+ *                  ASYNC_READ_COMPLETE or ASYNC_READ_ERROR, in the same
+ *                  sequence as MDD_SDSPI_AsyncReadTasks() returns them.
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Non-blocking read of info->dwBytesRemaining bytes,
+ *                  info->wNumBytes bytes per call.  ASYNC_READ_NEW_PACKET_READY
+ *                  means the next call copies a packet into info->pBuffer.
+ *                  At the start of each block, ASYNC_READ_BUSY is returned
+ *                  for the number of calls set with MDD_HostFile_SetLatency().
+ *
+ * Note:            info->wNumBytes must be an integer factor of the sector
+ *                  size.
+ *****************************************************************************/
+BYTE MDD_HostFile_AsyncReadTasks(ASYNC_IO* info)
+{
+    switch(info->bStateVariable)
+    {
+        case ASYNC_READ_COMPLETE:
+            return ASYNC_READ_COMPLETE;
+        case ASYNC_READ_QUEUED:
+            ioInfo = *info;
+            blockCounter = MEDIA_SECTOR_SIZE;
+            if((imageFile == NULL) ||
+               (ioInfo.dwAddress + (ioInfo.dwBytesRemaining + MEDIA_SECTOR_SIZE - 1) / MEDIA_SECTOR_SIZE > imageSectors) ||
+               (fseek(imageFile, (long)ioInfo.dwAddress * MEDIA_SECTOR_SIZE, SEEK_SET) != 0))
+            {
+                info->bStateVariable = ASYNC_READ_ABORT;
+                return ASYNC_READ_BUSY;
+            }
+            busyCounter = busyLatency;
+            info->bStateVariable = HOST_FILE_READ_MEDIA_BUSY;
+            return ASYNC_READ_BUSY;
+        case HOST_FILE_READ_MEDIA_BUSY:
+            if(busyCounter != 0)
+            {
+                busyCounter--;
+                return ASYNC_READ_BUSY;
+            }
+            info->bStateVariable = ASYNC_READ_NEW_PACKET_READY;
+            return ASYNC_READ_NEW_PACKET_READY;
+        case ASYNC_READ_NEW_PACKET_READY:
+            if(ioInfo.dwBytesRemaining != 0)
+            {
+                //The pointer and packet size may change between calls.
+                ioInfo.wNumBytes = info->wNumBytes;
+                ioInfo.pBuffer = info->pBuffer;
+
+                if(fread(ioInfo.pBuffer, 1, ioInfo.wNumBytes, imageFile) != ioInfo.wNumBytes)
+                {
+                    info->bStateVariable = ASYNC_READ_ERROR;
+                    return ASYNC_READ_ERROR;
+                }
+                ioInfo.dwBytesRemaining -= ioInfo.wNumBytes;
+                blockCounter -= ioInfo.wNumBytes;
+
+                if(blockCounter == 0)
+                {
+                    if(ioInfo.dwBytesRemaining != 0)
+                    {
+                        busyCounter = busyLatency;
+                        info->bStateVariable = HOST_FILE_READ_MEDIA_BUSY;
+                    }
+                    blockCounter = MEDIA_SECTOR_SIZE;
+                    return ASYNC_READ_BUSY;
+                }
+                return ASYNC_READ_NEW_PACKET_READY;
+            }
+            info->bStateVariable = ASYNC_READ_COMPLETE;
+            return ASYNC_READ_COMPLETE;
+        case ASYNC_READ_ABORT:
+            info->bStateVariable = ASYNC_READ_ERROR;
+            //Fall through
+        case ASYNC_READ_ERROR:
+        default:
+            return ASYNC_READ_ERROR;
+    }
+}
+
+/******************************************************************************
+ * Function:        BYTE MDD_HostFile_AsyncWriteTasks(ASYNC_IO* info)
+ *
+ * PreCondition:    info->bStateVariable is set to ASYNC_WRITE_QUEUED to start
+ *                  a write, the other fields as for MDD_SDSPI_AsyncWriteTasks().
+ *
+ * Input:           info - Write request
+ *
+ * Output:          ASYNC_WRITE_SEND_PACKET, ASYNC_WRITE_BUSY,
+ *                  ASYNC_WRITE_COMPLETE or ASYNC_WRITE_ERROR, in the same
+ *                  sequence as MDD_SDSPI_AsyncWriteTasks() returns them.
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Non-blocking write of info->dwBytesRemaining bytes,
+ *                  info->wNumBytes bytes per call.  ASYNC_WRITE_SEND_PACKET
+ *                  means the next call takes a packet from info->pBuffer.
+ *                  After each block, ASYNC_WRITE_BUSY is returned for the
+ *                  number of calls set with MDD_HostFile_SetLatency().
+ *
+ * Note:            info->wNumBytes must be an integer factor of the sector
+ *                  size.  Writes to sector 0 are allowed, as on SD-SPI.
+ *****************************************************************************/
+BYTE MDD_HostFile_AsyncWriteTasks(ASYNC_IO* info)
+{
+    switch(info->bStateVariable)
+    {
+        case ASYNC_WRITE_COMPLETE:
+            return ASYNC_WRITE_COMPLETE;
+        case ASYNC_WRITE_QUEUED:
+            ioInfo = *info;
+            blockCounter = MEDIA_SECTOR_SIZE;
+            if((imageFile == NULL) || imageWriteProtect ||
+               (ioInfo.dwAddress + (ioInfo.dwBytesRemaining + MEDIA_SECTOR_SIZE - 1) / MEDIA_SECTOR_SIZE > imageSectors) ||
+               (fseek(imageFile, (long)ioInfo.dwAddress * MEDIA_SECTOR_SIZE, SEEK_SET) != 0))
+            {
+                info->bStateVariable = ASYNC_WRITE_ERROR;
+                return ASYNC_WRITE_ERROR;
+            }
+            info->bStateVariable = ASYNC_WRITE_TRANSMIT_PACKET;
+            return ASYNC_WRITE_SEND_PACKET;
+        case ASYNC_WRITE_TRANSMIT_PACKET:
+            ioInfo.wNumBytes = info->wNumBytes;
+            ioInfo.pBuffer = info->pBuffer;
+
+            if(fwrite(ioInfo.pBuffer, 1, ioInfo.wNumBytes, imageFile) != ioInfo.wNumBytes)
+            {
+                info->bStateVariable = ASYNC_WRITE_ERROR;
+                return ASYNC_WRITE_ERROR;
+            }
+            ioInfo.dwBytesRemaining -= ioInfo.wNumBytes;
+            blockCounter -= ioInfo.wNumBytes;
+
+            if(blockCounter == 0)
+            {
+                //A whole block was received, the "media" is now programming it.
+                blockCounter = MEDIA_SECTOR_SIZE;
+                busyCounter = busyLatency;
+                info->bStateVariable = ASYNC_WRITE_MEDIA_BUSY;
+                return ASYNC_WRITE_BUSY;
+            }
+            return ASYNC_WRITE_SEND_PACKET;
+        case ASYNC_WRITE_MEDIA_BUSY:
+            if(busyCounter != 0)
+            {
+                busyCounter--;
+                return ASYNC_WRITE_BUSY;
+            }
+            if(ioInfo.dwBytesRemaining == 0)
+            {
+                fflush(imageFile);
+                info->bStateVariable = ASYNC_WRITE_COMPLETE;
+                return ASYNC_WRITE_COMPLETE;
+            }
+            info->bStateVariable = ASYNC_WRITE_TRANSMIT_PACKET;
+            return ASYNC_WRITE_SEND_PACKET;
+        case ASYNC_WRITE_ABORT:
+            info->bStateVariable = ASYNC_WRITE_ERROR;
+            //Fall through
+        case ASYNC_WRITE_ERROR:
+        default:
+            return ASYNC_WRITE_ERROR;
+    }
+}
+
+/******************************************************************************
+ * Function:        BYTE MDD_HostFile_WriteProtectState(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          TRUE  - The image was opened write protected
+ *                  FALSE - The image is writable
+ *
+ * Side Effects:    None
+ *
+ * Overview:        None
+ *
+ * Note:            None
+ *****************************************************************************/
+BYTE MDD_HostFile_WriteProtectState(void)
+{
+    return imageWriteProtect;
+}
+
+/******************************************************************************
+ * Function:        BYTE MDD_HostFile_ShutdownMedia(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          0
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Flushes the writes to the image.  The image stays open.
+ *
+ * Note:            None
+ *****************************************************************************/
+BYTE MDD_HostFile_ShutdownMedia(void)
+{
+    if(imageFile != NULL)
+    {
+        fflush(imageFile);
+    }
+    return 0;
+}
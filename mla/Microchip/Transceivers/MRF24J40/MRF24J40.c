@@ -49,6 +49,8 @@
 *  2.1   6/20/2009    yfy       Add LCD support
 *  3.1   5/28/2010    yfy       MiWi DE 3.1
 *  4.1   6/3/2011     yfy       MAL v2011-06
+*  4.2   10/18/2026             Burst access to the TX and RX FIFOs,
+*                               frame timestamps for the clock synchronization
 ********************************************************************/
 #include "SystemProfile.h"
 
@@ -111,6 +113,9 @@
 	    {
 	        BYTE PayloadLen;
 	        BYTE Payload[RX_PACKET_SIZE];
+	        #if defined(ENABLE_CLOCK_SYNC)
+	            DWORD Timestamp;
+	        #endif
 	    } RxBuffer[BANK_SIZE]; 
     #if defined(__18CXX)
         #pragma udata
@@ -126,6 +131,11 @@
 
     volatile MRF24J40_STATUS MRF24J40Status;
     
+    #if defined(ENABLE_CLOCK_SYNC)
+        volatile DWORD MACTxTimestamp;
+        volatile BOOL MACTxTimestampValid;  // MACTxTimestamp belongs to the last frame sent
+    #endif
+    
     void SPIPut(BYTE v);
     BYTE SPIGet(void);
     
@@ -258,6 +268,93 @@
         
         return toReturn;
     }
+    
+    /*********************************************************************
+     * void PHYSetLongRAMArray(INPUT WORD address, INPUT BYTE *data, 
+     *                         INPUT BYTE length)
+     *
+     * Overview:        This function writes a block of values to
+     *                  consecutive LONG RAM addresses
+     *
+     * PreCondition:    Communication port to the MRF24J40 initialized
+     *
+     * Input:           address - the first LONG RAM address that you
+     *                      want to write to
+     *                  data    - the values that you want to write
+     *                  length  - the number of values
+     *
+     * Output:          None
+     *
+     * Side Effects:    The register values are changed
+     *                  Interrupt from radio is turned off before accessing
+     *                  the SPI and turned back on after accessing the SPI
+     *
+     * Note:            The MRF24J40 increments the address after each
+     *                  byte while the chip select is held low, so the
+     *                  address is only sent once for the whole block.
+     *
+     ********************************************************************/
+    void PHYSetLongRAMArray(INPUT WORD address, INPUT BYTE *data, INPUT BYTE length)
+    {
+        volatile BYTE tmpRFIE;
+        
+        if( length == 0 )
+        {
+            return;
+        }
+        
+        tmpRFIE = RFIE;
+        RFIE = 0;
+        PHY_CS = 0;
+        SPIPut((((BYTE)(address>>3))&0x7F)|0x80);
+        SPIPut((((BYTE)(address<<5))&0xE0)|0x10);
+        SPIPutArray(data, length);
+        PHY_CS = 1;
+        RFIE = tmpRFIE;
+    }
+    
+    /*********************************************************************
+     * void PHYGetLongRAMArray(INPUT WORD address, OUTPUT BYTE *data, 
+     *                         INPUT BYTE length)
+     *
+     * Overview:        This function reads a block of values from
+     *                  consecutive LONG RAM addresses
+     *
+     * PreCondition:    Communication port to the MRF24J40 initialized
+     *
+     * Input:           address - the first LONG RAM address that you
+     *                      want to read from
+     *                  data    - the buffer for the values read
+     *                  length  - the number of values
+     *
+     * Output:          None
+     *
+     * Side Effects:    Interrupt from radio is turned off before accessing
+     *                  the SPI and turned back on after accessing the SPI
+     *
+     * Note:            The MRF24J40 increments the address after each
+     *                  byte while the chip select is held low, so the
+     *                  address is only sent once for the whole block.
+     *
+     ********************************************************************/
+    void PHYGetLongRAMArray(INPUT WORD address, OUTPUT BYTE *data, INPUT BYTE length)
+    {
+        volatile BYTE tmpRFIE;
+        
+        if( length == 0 )
+        {
+            return;
+        }
+        
+        tmpRFIE = RFIE;
+        RFIE = 0;
+        PHY_CS = 0;
+        SPIPut(((address>>3)&0x7F)|0x80);
+        SPIPut(((address<<5)&0xE0));
+        SPIGetArray(data, length);
+        PHY_CS = 1;
+        RFIE = tmpRFIE;
+    }
 
     void InitMRF24J40(void)
     {
@@ -475,6 +572,9 @@
             #endif
             MACRxPacket.flags.Val = 0;
             MACRxPacket.altSourceAddress = FALSE;
+            #if defined(ENABLE_CLOCK_SYNC)
+                MACRxPacket.Timestamp = RxBuffer[BankIndex].Timestamp;
+            #endif
 
             //Determine the start of the MAC payload
             addrMode = RxBuffer[BankIndex].Payload[1] & 0xCC;
@@ -779,6 +879,7 @@
             BOOL IntraPAN;
         #endif
         MIWI_TICK t1, t2;
+        BYTE header[TX_HEADER_SIZE];
 
     
         if( transParam.flags.bits.broadcast )
@@ -888,73 +989,73 @@
         }
     
         // set header length
-        PHYSetLongRAMAddr(loc++, headerLength);
+        header[loc++] = headerLength;
         // set packet length
         #ifdef ENABLE_SECURITY
             if( transParam.flags.bits.secEn )
             {
-                PHYSetLongRAMAddr(loc++, headerLength + MACPayloadLen + 5);
+                header[loc++] = headerLength + MACPayloadLen + 5;
             }
             else
         #endif
         {
-            PHYSetLongRAMAddr(loc++, headerLength + MACPayloadLen);
+            header[loc++] = headerLength + MACPayloadLen;
         }
         
         // set frame control LSB
-        PHYSetLongRAMAddr(loc++, i);
+        header[loc++] = i;
         
         // set frame control MSB
         if( transParam.flags.bits.packetType == PACKET_TYPE_RESERVE )
         {
-            PHYSetLongRAMAddr(loc++, 0x80);
+            header[loc++] = 0x80;
             // sequence number
-            PHYSetLongRAMAddr(loc++, IEEESeqNum++);
+            header[loc++] = IEEESeqNum++;
         }
         else 
         {
             if( transParam.altDestAddr && transParam.altSrcAddr )
             {
-                PHYSetLongRAMAddr(loc++, 0x88);
+                header[loc++] = 0x88;
             }
             else if( transParam.altDestAddr && transParam.altSrcAddr == 0 )
             {
-                PHYSetLongRAMAddr(loc++, 0xC8);
+                header[loc++] = 0xC8;
             }
             else if( transParam.altDestAddr == 0 && transParam.altSrcAddr == 1 )
             {
-                PHYSetLongRAMAddr(loc++, 0x8C);
+                header[loc++] = 0x8C;
             }
             else
             {
-                PHYSetLongRAMAddr(loc++, 0xCC);
+                header[loc++] = 0xCC;
             }
             
             // sequence number
-            PHYSetLongRAMAddr(loc++, IEEESeqNum++);
+            header[loc++] = IEEESeqNum++;
             
             // destination PANID     
-            PHYSetLongRAMAddr(loc++, transParam.DestPANID.v[0]);
-            PHYSetLongRAMAddr(loc++, transParam.DestPANID.v[1]);
+            header[loc++] = transParam.DestPANID.v[0];
+            header[loc++] = transParam.DestPANID.v[1];
             
             // destination address
             if( transParam.flags.bits.broadcast )
             {
-                PHYSetLongRAMAddr(loc++, 0xFF);
-                PHYSetLongRAMAddr(loc++, 0xFF);
+                header[loc++] = 0xFF;
+                header[loc++] = 0xFF;
             }
             else
             {
                 if( transParam.altDestAddr )
                 {
-                    PHYSetLongRAMAddr(loc++, transParam.DestAddress[0]);
-                    PHYSetLongRAMAddr(loc++, transParam.DestAddress[1]);
+                    header[loc++] = transParam.DestAddress[0];
+                    header[loc++] = transParam.DestAddress[1];
                 }
                 else
                 {
                     for(i = 0; i < 8; i++)
                     {
-                        PHYSetLongRAMAddr(loc++, transParam.DestAddress[i]);
+                        header[loc++] = transParam.DestAddress[i];
                     }
                 }
             }
@@ -964,22 +1065,22 @@
             // source PANID if necessary
             if( IntraPAN == FALSE )
             {
-                PHYSetLongRAMAddr(loc++, MAC_PANID.v[0]);
-                PHYSetLongRAMAddr(loc++, MAC_PANID.v[1]);
+                header[loc++] = MAC_PANID.v[0];
+                header[loc++] = MAC_PANID.v[1];
             }
         #endif
         
         // source address
         if( transParam.altSrcAddr )
         {
-            PHYSetLongRAMAddr(loc++, myNetworkAddress.v[0]);
-            PHYSetLongRAMAddr(loc++, myNetworkAddress.v[1]);
+            header[loc++] = myNetworkAddress.v[0];
+            header[loc++] = myNetworkAddress.v[1];
         }
         else
         {
             for(i = 0; i < 8; i++)
             {
-                PHYSetLongRAMAddr(loc++, MACInitParams.PAddress[i]);
+                header[loc++] = MACInitParams.PAddress[i];
             }
         }
         
@@ -989,7 +1090,7 @@
                 // fill the additional security aux header
                 for(i = 0; i < 4; i++)
                 {
-                    PHYSetLongRAMAddr(loc++, OutgoingFrameCounter.v[i]);
+                    header[loc++] = OutgoingFrameCounter.v[i];
                 }
                 OutgoingFrameCounter.Val++;
                 #if defined(ENABLE_NETWORK_FREEZER)
@@ -999,7 +1100,7 @@
                     }    
                 #endif
 
-                PHYSetLongRAMAddr(loc++, myKeySequenceNumber);
+                header[loc++] = myKeySequenceNumber;
                 
                 // fill the security key
                 for(i = 0; i < 16; i++)
@@ -1013,13 +1114,14 @@
         #endif
         
         
-        // write the payload
-        for(i = 0; i < MACPayloadLen; i++)
-        {
-            PHYSetLongRAMAddr(loc++, MACPayload[i]);
-        }
+        // write the header and the payload to the TX normal FIFO
+        PHYSetLongRAMArray(0, header, loc);
+        PHYSetLongRAMArray(loc, MACPayload, MACPayloadLen);
         
         MRF24J40Status.bits.TX_BUSY = 1;
+        #if defined(ENABLE_CLOCK_SYNC)
+            MACTxTimestampValid = FALSE;
+        #endif
     
         // set the trigger value
         if( transParam.flags.bits.ackReq && transParam.flags.bits.broadcast == FALSE )
@@ -1079,6 +1181,72 @@
     }
 
     
+    #if defined(ENABLE_CLOCK_SYNC)
+        /************************************************************************************
+         * Function:
+         *      BOOL MiMAC_GetTxTimestamp(DWORD *pTimestamp)
+         *
+         * Summary:
+         *      This function returns the timestamp of the last frame sent
+         *
+         * Description:        
+         *      This function waits for the transmission started by the last call
+         *      of MiMAC_SendPacket to complete, and returns the high resolution 
+         *      tick taken in the transmit interrupt. Without VERIFY_TRANSMIT, 
+         *      MiMAC_SendPacket returns as soon as the frame is triggered, so the
+         *      timestamp is not known at that time.
+         *
+         * PreCondition:    
+         *      A frame has been sent with MiMAC_SendPacket. 
+         *
+         * Parameters: 
+         *      DWORD *pTimestamp - Returns MiWi_HighResTickGet() at the end of the frame
+         *
+         * Returns: 
+         *      TRUE if the timestamp belongs to the last frame, FALSE if the 
+         *      transmission did not complete within 40 ms.
+         *
+         * Example:
+         *      <code>
+         *      if( MiMAC_SendPacket(transParam, MACPayload, MACPayloadLen) &&
+         *          MiMAC_GetTxTimestamp(&txTimestamp) )
+         *      {
+         *          // txTimestamp is the time the frame was sent
+         *      }
+         *      </code>
+         *
+         * Remarks:    
+         *      None
+         *
+         *****************************************************************************************/    
+        BOOL MiMAC_GetTxTimestamp(OUTPUT DWORD *pTimestamp)
+        {
+            MIWI_TICK t1, t2;
+            
+            t1 = MiWi_TickGet();
+            while( MRF24J40Status.bits.TX_BUSY )
+            {
+                if( RF_INT_PIN == 0 )
+                {
+                    RFIF = 1;
+                }
+                t2 = MiWi_TickGet();
+                if( MiWi_TickGetDiff(t2, t1) > FORTY_MILI_SECOND )
+                {
+                    return FALSE;
+                }
+            }
+            
+            if( MACTxTimestampValid == FALSE )
+            {
+                return FALSE;
+            }
+            *pTimestamp = MACTxTimestamp;
+            return TRUE;
+        }
+    #endif
+    
+    
     #if defined(ENABLE_ED_SCAN) 
         /************************************************************************************
          * Function:
@@ -1594,6 +1762,12 @@
         void _ISRFAST _INT1Interrupt(void)
     #endif
     {
+        #if defined(ENABLE_CLOCK_SYNC)
+            // The MRF24J40 interrupts at the end of a transmitted or
+            // received frame, so this marks the same moment on both sides
+            DWORD timestamp = MiWi_HighResTickGet();
+        #endif
+        
         if(RFIE && RFIF)
         {  
             BYTE i;
@@ -1614,6 +1788,11 @@
                 if(flags.bits.RF_TXIF)
                 {
                     //if the TX interrupt was triggered
+                    #if defined(ENABLE_CLOCK_SYNC)
+                        MACTxTimestamp = timestamp;
+                        MACTxTimestampValid = TRUE;
+                    #endif
+                    
                     //clear the busy flag indicating the transmission was complete
                     MRF24J40Status.bits.TX_BUSY = 0;
                     
@@ -1751,16 +1930,16 @@
                         //get the size of the packet
                         //2 more bytes for RSSI and LQI reading 
                         RxBuffer[RxBank].PayloadLen = PHYGetLongRAMAddr(0x300) + 2;
+                        #if defined(ENABLE_CLOCK_SYNC)
+                            RxBuffer[RxBank].Timestamp = timestamp;
+                        #endif
                         if(RxBuffer[RxBank].PayloadLen<RX_PACKET_SIZE)
                         {   
                             //indicate that data is now stored in the buffer
                             MRF24J40Status.bits.RX_BUFFERED = 1;
                             
                             //copy all of the data from the FIFO into the TxBuffer, plus RSSI and LQI
-                            for(i=1;i<=RxBuffer[RxBank].PayloadLen+2;i++)
-                            {
-                                RxBuffer[RxBank].Payload[i-1] = PHYGetLongRAMAddr(0x300+i);
-                            }
+                            PHYGetLongRAMArray(0x301, RxBuffer[RxBank].Payload, RxBuffer[RxBank].PayloadLen+2);
                             PHYSetShortRAMAddr(WRITE_RXFLUSH, 0x01);
                         }
                         else
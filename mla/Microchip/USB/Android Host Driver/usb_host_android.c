@@ -49,6 +49,9 @@ Change History:
               the transfer complete, then the driver would think that the device
               didn't successfully enter accessory mode resulting in communication
               failure.
+  2.9j        Added the transfer queues, enabled with ANDROID_TRANSFER_QUEUE_SIZE.
+              Several reads and writes can be queued in each direction, and the
+              next transfer is started as soon as the previous one completes.
 
 *******************************************************************************/
 
@@ -58,6 +61,9 @@ Change History:
 #include "USB/usb.h"
 #include "USB/usb_host_android.h"
 #include "usb_host_android_local.h"
+#if defined(ANDROID_TRANSFER_QUEUE_SIZE)
+    #include "struct_queue.h"
+#endif
 
 //************************************************************
 // Internal type definitions
@@ -130,6 +136,26 @@ typedef enum
 
 } ANDROID_DEVICE_STATUS;
 
+#if defined(ANDROID_TRANSFER_QUEUE_SIZE)
+typedef struct
+{
+    BYTE* data;
+    DWORD size;
+    ANDROID_TRANSFER_CALLBACK callback;
+    void* context;
+} ANDROID_TRANSFER;
+
+//The transfer at the tail of the queue is the one in progress.  The memset
+//  in the init function leaves the queues empty.
+typedef struct
+{
+    BYTE head;
+    BYTE tail;
+    BYTE count;
+    ANDROID_TRANSFER buffer[ANDROID_TRANSFER_QUEUE_SIZE];
+} ANDROID_TRANSFER_QUEUE;
+#endif
+
 typedef struct
 {
     BYTE address;
@@ -158,6 +184,11 @@ typedef struct
         BYTE  HIDEventSent      :1;
     } hid;
 
+#if defined(ANDROID_TRANSFER_QUEUE_SIZE)
+    ANDROID_TRANSFER_QUEUE writeQueue;
+    ANDROID_TRANSFER_QUEUE readQueue;
+#endif
+
 } ANDROID_DEVICE_DATA;
 
 //************************************************************
@@ -174,6 +205,12 @@ static BYTE AndroidCommandSendString(void *handle, ANDROID_ACCESSORY_STRINGS str
 static BYTE AndroidCommandStart(void *handle);
 static BOOL AndroidIsLastCommandComplete(BYTE address, BYTE *errorCode, DWORD *byteCount);
 static BYTE AndroidCommandGetProtocol(ANDROID_DEVICE_DATA* device, WORD *protocol);
+#if defined(ANDROID_TRANSFER_QUEUE_SIZE)
+static BYTE AndroidQueueAdd(ANDROID_DEVICE_DATA* device, ANDROID_TRANSFER_QUEUE* queue, BYTE endpoint, BYTE* data, DWORD size, ANDROID_TRANSFER_CALLBACK callback, void* context);
+static BYTE AndroidQueueStart(ANDROID_DEVICE_DATA* device, ANDROID_TRANSFER_QUEUE* queue, BYTE endpoint);
+static void AndroidQueueComplete(ANDROID_DEVICE_DATA* device, ANDROID_TRANSFER_QUEUE* queue, BYTE endpoint, BYTE errorCode, DWORD byteCount);
+static void AndroidQueueFlush(ANDROID_DEVICE_DATA* device);
+#endif
 //************************************************************
 // Internal macro helper functions
 //************************************************************
@@ -360,6 +397,14 @@ BOOL AndroidAppIsWriteComplete(void* handle, BYTE* errorCode, DWORD* size)
         return USB_INVALID_STATE;
     }    
 
+    #if defined(ANDROID_TRANSFER_QUEUE_SIZE)
+        //Queued writes are completed by the driver
+        if(StructQueueIsNotEmpty(&device->writeQueue, ANDROID_TRANSFER_QUEUE_SIZE))
+        {
+            return FALSE;
+        }
+    #endif
+
     //If there was a transfer pending, then get the state of the transfer
     if(USBHostTransferIsComplete(
                                     device->address, 
@@ -521,6 +566,14 @@ BOOL AndroidAppIsReadComplete(void* handle, BYTE* errorCode, DWORD* size)
         return USB_INVALID_STATE;
     }    
 
+    #if defined(ANDROID_TRANSFER_QUEUE_SIZE)
+        //Queued reads are completed by the driver
+        if(StructQueueIsNotEmpty(&device->readQueue, ANDROID_TRANSFER_QUEUE_SIZE))
+        {
+            return FALSE;
+        }
+    #endif
+
     //If there was a transfer pending, then get the state of the transfer
     if(USBHostTransferIsComplete(
                                     device->address, 
@@ -537,6 +590,225 @@ BOOL AndroidAppIsReadComplete(void* handle, BYTE* errorCode, DWORD* size)
     return FALSE;
 }
 
+#if defined(ANDROID_TRANSFER_QUEUE_SIZE)
+/****************************************************************************
+  Function:
+    BYTE AndroidAppQueueWrite(void* handle, BYTE* data, DWORD size,
+                    ANDROID_TRANSFER_CALLBACK callback, void* context)
+
+  Summary:
+    Queues data to be sent to the Android device.
+
+  Description:
+    Queues data to be sent to the Android device.  If no write is in progress
+    the write is started immediately.  Otherwise it is started as soon as the
+    writes queued before it have completed.  When the write completes, the
+    callback function is called.
+
+  Precondition:
+    USB module is initialized and Android device has attached.
+
+  Parameters:
+    void* handle - the handle passed to the device in the EVENT_ANDROID_ATTACH event
+    BYTE* data - the data to send to the Android device
+    DWORD size - the size of the data that needs to be sent
+    ANDROID_TRANSFER_CALLBACK callback - function called when the write
+                completes, or NULL
+    void* context - value passed to the callback function
+
+  Return Values:
+    USB_SUCCESS                     - Write queued successfully.
+    USB_UNKNOWN_DEVICE              - Device with the specified address not found.
+    USB_INVALID_STATE               - We are not in a normal running state.
+    USB_ENDPOINT_BUSY               - The queue is full, or a write started
+                                        with AndroidAppWrite() is in progress.
+    Others                          - See AndroidAppWrite().
+
+  Remarks:
+    None
+  ***************************************************************************/
+BYTE AndroidAppQueueWrite(void* handle, BYTE* data, DWORD size, ANDROID_TRANSFER_CALLBACK callback, void* context)
+{
+    ANDROID_DEVICE_DATA* device = (ANDROID_DEVICE_DATA*)handle;
+    BYTE errorCode;
+
+    if(device == NULL)
+    {
+        return USB_UNKNOWN_DEVICE;
+    }
+
+    if(device->address == 0)
+    {
+        return USB_UNKNOWN_DEVICE;
+    }
+
+    if(device->state < READY)
+    {
+        return USB_INVALID_STATE;
+    }    
+
+    //A write started with AndroidAppWrite() has to be finished first
+    if((device->status.TXBusy == 1) && StructQueueIsEmpty(&device->writeQueue, ANDROID_TRANSFER_QUEUE_SIZE))
+    {
+        return USB_ENDPOINT_BUSY;
+    }
+
+    errorCode = AndroidQueueAdd(device, &device->writeQueue, ANDROID_GetOUTEndpointNum(device), data, size, callback, context);
+
+    device->status.TXBusy = StructQueueIsNotEmpty(&device->writeQueue, ANDROID_TRANSFER_QUEUE_SIZE);
+
+    return errorCode;
+}
+
+/****************************************************************************
+  Function:
+    BYTE AndroidAppQueueRead(void* handle, BYTE* data, DWORD size,
+                    ANDROID_TRANSFER_CALLBACK callback, void* context)
+
+  Summary:
+    Queues a read from the Android device.
+
+  Description:
+    Queues a read from the Android device.  If no read is in progress the read
+    is started immediately.  Otherwise it is started as soon as the reads
+    queued before it have completed.  When the read completes, the callback
+    function is called with the number of bytes received.
+
+  Precondition:
+    USB module is initialized and Android device has attached.
+
+  Parameters:
+    void* handle - the handle passed to the device in the EVENT_ANDROID_ATTACH event
+    BYTE* data - a pointer to the location of where the data should be stored.  This location
+                should be accessible by the USB module
+    DWORD size - the amount of data to read.
+    ANDROID_TRANSFER_CALLBACK callback - function called when the read
+                completes, or NULL
+    void* context - value passed to the callback function
+
+  Return Values:
+    USB_SUCCESS                     - Read queued successfully.
+    USB_UNKNOWN_DEVICE              - Device with the specified address not found.
+    USB_INVALID_STATE               - We are not in a normal running state.
+    USB_ENDPOINT_BUSY               - The queue is full, or a read started
+                                        with AndroidAppRead() is in progress.
+    USB_ERROR_BUFFER_TOO_SMALL      - The buffer passed to the read function was
+                                        smaller than the endpoint size being used.
+    Others                          - See AndroidAppRead().
+
+  Remarks:
+    None
+  ***************************************************************************/
+BYTE AndroidAppQueueRead(void* handle, BYTE* data, DWORD size, ANDROID_TRANSFER_CALLBACK callback, void* context)
+{
+    ANDROID_DEVICE_DATA* device = (ANDROID_DEVICE_DATA*)handle;
+    BYTE errorCode;
+
+    if(device == NULL)
+    {
+        return USB_UNKNOWN_DEVICE;
+    }
+
+    if(device->address == 0)
+    {
+        return USB_UNKNOWN_DEVICE;
+    }
+
+    if(device->state < READY)
+    {
+        return USB_INVALID_STATE;
+    }    
+
+    //A read started with AndroidAppRead() has to be finished first
+    if((device->status.RXBusy == 1) && StructQueueIsEmpty(&device->readQueue, ANDROID_TRANSFER_QUEUE_SIZE))
+    {
+        return USB_ENDPOINT_BUSY;
+    }
+
+    if(size < device->INEndpointSize)
+    {
+        return USB_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    errorCode = AndroidQueueAdd(device, &device->readQueue, ANDROID_GetINEndpointNum(device), data,
+                                ((size / device->INEndpointSize) * device->INEndpointSize), callback, context);
+
+    device->status.RXBusy = StructQueueIsNotEmpty(&device->readQueue, ANDROID_TRANSFER_QUEUE_SIZE);
+
+    return errorCode;
+}
+
+/****************************************************************************
+  Function:
+    BYTE AndroidAppWriteQueueCount(void* handle)
+
+  Summary:
+    Returns the number of queued writes.
+
+  Description:
+    Returns the number of writes queued with AndroidAppQueueWrite() that have
+    not completed, including the write in progress.
+
+  Precondition:
+    None
+
+  Parameters:
+    void* handle - the handle passed to the device in the EVENT_ANDROID_ATTACH event
+
+  Return Values:
+    The number of queued writes.  0 if the handle is not valid.
+
+  Remarks:
+    None
+  ***************************************************************************/
+BYTE AndroidAppWriteQueueCount(void* handle)
+{
+    ANDROID_DEVICE_DATA* device = (ANDROID_DEVICE_DATA*)handle;
+
+    if(device == NULL)
+    {
+        return 0;
+    }
+
+    return StructQueueCount(&device->writeQueue, ANDROID_TRANSFER_QUEUE_SIZE);
+}
+
+/****************************************************************************
+  Function:
+    BYTE AndroidAppReadQueueCount(void* handle)
+
+  Summary:
+    Returns the number of queued reads.
+
+  Description:
+    Returns the number of reads queued with AndroidAppQueueRead() that have
+    not completed, including the read in progress.
+
+  Precondition:
+    None
+
+  Parameters:
+    void* handle - the handle passed to the device in the EVENT_ANDROID_ATTACH event
+
+  Return Values:
+    The number of queued reads.  0 if the handle is not valid.
+
+  Remarks:
+    None
+  ***************************************************************************/
+BYTE AndroidAppReadQueueCount(void* handle)
+{
+    ANDROID_DEVICE_DATA* device = (ANDROID_DEVICE_DATA*)handle;
+
+    if(device == NULL)
+    {
+        return 0;
+    }
+
+    return StructQueueCount(&device->readQueue, ANDROID_TRANSFER_QUEUE_SIZE);
+}
+#endif
+
 
 /****************************************************************************
   Function:
@@ -873,6 +1145,24 @@ void AndroidTasks(void)
                 //Don't know what state the device is in.  Do some recovery here?
                 break;
         }
+
+        #if defined(ANDROID_TRANSFER_QUEUE_SIZE) && !defined(USB_ENABLE_TRANSFER_EVENT)
+            //Without transfer events, poll the transfers in progress of the queues
+            if(device->state >= READY)
+            {
+                if( StructQueueIsNotEmpty(&device->writeQueue, ANDROID_TRANSFER_QUEUE_SIZE) &&
+                    (USBHostTransferIsComplete(device->address, ANDROID_GetOUTEndpointNum(device), &errorCode, &byteCount) == TRUE) )
+                {
+                    AndroidQueueComplete(device, &device->writeQueue, ANDROID_GetOUTEndpointNum(device), errorCode, byteCount);
+                }
+
+                if( StructQueueIsNotEmpty(&device->readQueue, ANDROID_TRANSFER_QUEUE_SIZE) &&
+                    (USBHostTransferIsComplete(device->address, ANDROID_GetINEndpointNum(device), &errorCode, &byteCount) == TRUE) )
+                {
+                    AndroidQueueComplete(device, &device->readQueue, ANDROID_GetINEndpointNum(device), errorCode, byteCount);
+                }
+            }
+        #endif
     }
 }
 
@@ -1157,6 +1447,11 @@ BOOL AndroidAppEventHandler( BYTE address, USB_EVENT event, void *data, DWORD si
 
                         USBHostTerminateTransfer( device->address, device->OUTEndpointNum );
                         USBHostTerminateTransfer( device->address, device->INEndpointNum );
+                        #if defined(ANDROID_TRANSFER_QUEUE_SIZE)
+                            //Keep the callbacks from queueing new transfers
+                            device->state = NO_DEVICE;
+                            AndroidQueueFlush(device);
+                        #endif
                         USB_HOST_APP_EVENT_HANDLER(device->address,EVENT_ANDROID_DETACH,device,sizeof(ANDROID_DEVICE_DATA*));
                         
                         //Device has timed out.  Destroy its info.
@@ -1200,6 +1495,22 @@ BOOL AndroidAppEventHandler( BYTE address, USB_EVENT event, void *data, DWORD si
                     USB_HOST_APP_EVENT_HANDLER(device->address, EVENT_ANDROID_HID_SEND_EVENT_COMPLETE, device, sizeof(ANDROID_DEVICE_DATA*));
                 }
             }
+            #if defined(ANDROID_TRANSFER_QUEUE_SIZE)
+            else
+            {
+                //Complete the queued transfer and start the next one
+                if( (transfer_data->bEndpointAddress == ANDROID_GetOUTEndpointNum(device)) &&
+                    StructQueueIsNotEmpty(&device->writeQueue, ANDROID_TRANSFER_QUEUE_SIZE) )
+                {
+                    AndroidQueueComplete(device, &device->writeQueue, ANDROID_GetOUTEndpointNum(device), transfer_data->bErrorCode, transfer_data->dataCount);
+                }
+                else if( (transfer_data->bEndpointAddress == ANDROID_GetINEndpointNum(device)) &&
+                    StructQueueIsNotEmpty(&device->readQueue, ANDROID_TRANSFER_QUEUE_SIZE) )
+                {
+                    AndroidQueueComplete(device, &device->readQueue, ANDROID_GetINEndpointNum(device), transfer_data->bErrorCode, transfer_data->dataCount);
+                }
+            }
+            #endif
             
             return TRUE;
         case EVENT_RESUME:           // Device-mode resume received
@@ -1215,6 +1526,30 @@ BOOL AndroidAppEventHandler( BYTE address, USB_EVENT event, void *data, DWORD si
             return TRUE;
 
         case EVENT_BUS_ERROR:            // BUS error has occurred
+            #if defined(ANDROID_TRANSFER_QUEUE_SIZE)
+                for(i=0;i<NUM_ANDROID_DEVICES_SUPPORTED;i++)
+                {
+                    if(devices[i].address == address)
+                    {
+                        device = &devices[i];
+                    }
+                }
+
+                //A queued transfer that failed is completed with its error code
+                if((device != NULL) && (transfer_data != NULL) && (size == sizeof(HOST_TRANSFER_DATA)))
+                {
+                    if( (transfer_data->bEndpointAddress == ANDROID_GetOUTEndpointNum(device)) &&
+                        StructQueueIsNotEmpty(&device->writeQueue, ANDROID_TRANSFER_QUEUE_SIZE) )
+                    {
+                        AndroidQueueComplete(device, &device->writeQueue, ANDROID_GetOUTEndpointNum(device), transfer_data->bErrorCode, transfer_data->dataCount);
+                    }
+                    else if( (transfer_data->bEndpointAddress == ANDROID_GetINEndpointNum(device)) &&
+                        StructQueueIsNotEmpty(&device->readQueue, ANDROID_TRANSFER_QUEUE_SIZE) )
+                    {
+                        AndroidQueueComplete(device, &device->readQueue, ANDROID_GetINEndpointNum(device), transfer_data->bErrorCode, transfer_data->dataCount);
+                    }
+                }
+            #endif
             return TRUE;
 
         default:
@@ -1493,4 +1828,223 @@ static BYTE AndroidCommandGetProtocol(ANDROID_DEVICE_DATA* device, WORD *protoco
                                       );
 }
 
+#if defined(ANDROID_TRANSFER_QUEUE_SIZE)
+/****************************************************************************
+  Function:
+    static BYTE AndroidQueueAdd(ANDROID_DEVICE_DATA* device, ANDROID_TRANSFER_QUEUE* queue,
+                    BYTE endpoint, BYTE* data, DWORD size,
+                    ANDROID_TRANSFER_CALLBACK callback, void* context)
+
+  Summary:
+    Adds a transfer to a queue.
+
+  Description:
+    Adds a transfer to a queue.  If the queue was empty, the transfer is
+    started.
+
+  Precondition:
+    None
+
+  Parameters:
+    ANDROID_DEVICE_DATA* device - the device
+    ANDROID_TRANSFER_QUEUE* queue - the read or write queue of the device
+    BYTE endpoint - the endpoint of the queue
+    BYTE* data - the data buffer
+    DWORD size - the size of the transfer
+    ANDROID_TRANSFER_CALLBACK callback - function called when the transfer completes
+    void* context - value passed to the callback function
+
+  Return Values:
+    USB_SUCCESS         - Transfer queued
+    USB_ENDPOINT_BUSY   - The queue is full
+    Others              - The transfer could not be started.  See USBHostRead()
+                            and USBHostWrite().
+
+  Remarks:
+    Internal API only.  Should not be called by a user.
+  ***************************************************************************/
+static BYTE AndroidQueueAdd(ANDROID_DEVICE_DATA* device, ANDROID_TRANSFER_QUEUE* queue, BYTE endpoint, BYTE* data, DWORD size, ANDROID_TRANSFER_CALLBACK callback, void* context)
+{
+    ANDROID_TRANSFER* transfer;
+    BYTE errorCode;
+
+    if(StructQueueIsFull(queue, ANDROID_TRANSFER_QUEUE_SIZE))
+    {
+        return USB_ENDPOINT_BUSY;
+    }
+
+    transfer = StructQueueAdd(queue, ANDROID_TRANSFER_QUEUE_SIZE);
+    transfer->data = data;
+    transfer->size = size;
+    transfer->callback = callback;
+    transfer->context = context;
+
+    //If nothing was in progress, start this transfer now
+    if(StructQueueCount(queue, ANDROID_TRANSFER_QUEUE_SIZE) == 1)
+    {
+        errorCode = AndroidQueueStart(device, queue, endpoint);
+        if(errorCode != USB_SUCCESS)
+        {
+            transfer = StructQueueRemove(queue, ANDROID_TRANSFER_QUEUE_SIZE);
+            return errorCode;
+        }
+    }
+
+    return USB_SUCCESS;
+}
+
+/****************************************************************************
+  Function:
+    static BYTE AndroidQueueStart(ANDROID_DEVICE_DATA* device,
+                    ANDROID_TRANSFER_QUEUE* queue, BYTE endpoint)
+
+  Summary:
+    Starts the transfer at the tail of a queue.
+
+  Description:
+    Starts the transfer at the tail of a queue.
+
+  Precondition:
+    The queue is not empty.
+
+  Parameters:
+    ANDROID_DEVICE_DATA* device - the device
+    ANDROID_TRANSFER_QUEUE* queue - the read or write queue of the device
+    BYTE endpoint - the endpoint of the queue
+
+  Return Values:
+    See USBHostRead() and USBHostWrite().
+
+  Remarks:
+    Internal API only.  Should not be called by a user.
+  ***************************************************************************/
+static BYTE AndroidQueueStart(ANDROID_DEVICE_DATA* device, ANDROID_TRANSFER_QUEUE* queue, BYTE endpoint)
+{
+    ANDROID_TRANSFER* transfer;
+
+    transfer = StructQueuePeekTail(queue, ANDROID_TRANSFER_QUEUE_SIZE);
+
+    if((endpoint & 0x80) == 0x80)
+    {
+        return USBHostRead(device->address, endpoint, transfer->data, transfer->size);
+    }
+
+    return USBHostWrite(device->address, endpoint, transfer->data, transfer->size);
+}
+
+/****************************************************************************
+  Function:
+    static void AndroidQueueComplete(ANDROID_DEVICE_DATA* device,
+                    ANDROID_TRANSFER_QUEUE* queue, BYTE endpoint,
+                    BYTE errorCode, DWORD byteCount)
+
+  Summary:
+    Completes the transfer in progress of a queue.
+
+  Description:
+    Removes the transfer in progress from the queue and starts the next
+    queued transfer before calling the callback function of the completed
+    one, so the endpoint is kept busy while the application handles the
+    data.  A queued transfer that cannot be started is completed with the
+    error code, and the one after it is started instead.
+
+  Precondition:
+    The queue is not empty.
+
+  Parameters:
+    ANDROID_DEVICE_DATA* device - the device
+    ANDROID_TRANSFER_QUEUE* queue - the read or write queue of the device
+    BYTE endpoint - the endpoint of the queue
+    BYTE errorCode - the result of the transfer
+    DWORD byteCount - the number of bytes transferred
+
+  Return Values:
+    None
+
+  Remarks:
+    Internal API only.  Should not be called by a user.
+  ***************************************************************************/
+static void AndroidQueueComplete(ANDROID_DEVICE_DATA* device, ANDROID_TRANSFER_QUEUE* queue, BYTE endpoint, BYTE errorCode, DWORD byteCount)
+{
+    ANDROID_TRANSFER transfer;
+    BYTE startErrorCode;
+
+    do
+    {
+        transfer = *StructQueueRemove(queue, ANDROID_TRANSFER_QUEUE_SIZE);
+
+        startErrorCode = USB_SUCCESS;
+        if(StructQueueIsNotEmpty(queue, ANDROID_TRANSFER_QUEUE_SIZE))
+        {
+            startErrorCode = AndroidQueueStart(device, queue, endpoint);
+        }
+
+        //Update the busy flag before the callback, which may queue another transfer
+        if((endpoint & 0x80) == 0x80)
+        {
+            device->status.RXBusy = StructQueueIsNotEmpty(queue, ANDROID_TRANSFER_QUEUE_SIZE);
+        }
+        else
+        {
+            device->status.TXBusy = StructQueueIsNotEmpty(queue, ANDROID_TRANSFER_QUEUE_SIZE);
+        }
+
+        if(transfer.callback != NULL)
+        {
+            transfer.callback(device, transfer.data, byteCount, errorCode, transfer.context);
+        }
+
+        //If the next transfer could not be started, complete it with the error
+        errorCode = startErrorCode;
+        byteCount = 0;
+    } while(errorCode != USB_SUCCESS);
+}
+
+/****************************************************************************
+  Function:
+    static void AndroidQueueFlush(ANDROID_DEVICE_DATA* device)
+
+  Summary:
+    Completes all queued transfers of a detached device.
+
+  Description:
+    Completes all queued transfers of a detached device with the error code
+    USB_UNKNOWN_DEVICE, so the application can release the buffers.
+
+  Precondition:
+    The transfers in progress have been terminated.
+
+  Parameters:
+    ANDROID_DEVICE_DATA* device - the device
+
+  Return Values:
+    None
+
+  Remarks:
+    Internal API only.  Should not be called by a user.
+  ***************************************************************************/
+static void AndroidQueueFlush(ANDROID_DEVICE_DATA* device)
+{
+    ANDROID_TRANSFER transfer;
+
+    while(StructQueueIsNotEmpty(&device->writeQueue, ANDROID_TRANSFER_QUEUE_SIZE))
+    {
+        transfer = *StructQueueRemove(&device->writeQueue, ANDROID_TRANSFER_QUEUE_SIZE);
+        if(transfer.callback != NULL)
+        {
+            transfer.callback(device, transfer.data, 0, USB_UNKNOWN_DEVICE, transfer.context);
+        }
+    }
+
+    while(StructQueueIsNotEmpty(&device->readQueue, ANDROID_TRANSFER_QUEUE_SIZE))
+    {
+        transfer = *StructQueueRemove(&device->readQueue, ANDROID_TRANSFER_QUEUE_SIZE);
+        if(transfer.callback != NULL)
+        {
+            transfer.callback(device, transfer.data, 0, USB_UNKNOWN_DEVICE, transfer.context);
+        }
+    }
+}
+#endif
+
 //DOM-IGNORE-END
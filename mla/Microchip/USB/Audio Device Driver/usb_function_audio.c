@@ -125,6 +125,29 @@
 
 
 /** V A R I A B L E S ********************************************************/
+#if defined(USB_AUDIO_STREAM_OUT_EP) || defined(USB_AUDIO_STREAM_IN_EP)
+    USB_AUDIO_FEEDBACK audioFeedback;
+
+    #if defined(USB_AUDIO_STREAM_OUT_EP)
+        USB_AUDIO_FIFO audioOutFifo;
+        BYTE audioOutPacket[2][USB_AUDIO_STREAM_MAX_PACKET];
+        USB_HANDLE audioOutHandle[2];
+        BYTE audioOutNext;
+    #endif
+
+    #if defined(USB_AUDIO_STREAM_IN_EP)
+        USB_AUDIO_FIFO audioInFifo;
+        BYTE audioInPacket[2][USB_AUDIO_STREAM_MAX_PACKET];
+        BYTE audioInNext;
+    #endif
+
+    #if defined(USB_AUDIO_FEEDBACK_EP)
+        BYTE audioFeedbackPacket[3];
+        USB_HANDLE audioFeedbackHandle;
+    #endif
+
+    static BYTE USBAudioStreamAddEP(BYTE *epNum, BYTE *epOptions, BYTE count, BYTE ep, BYTE options);
+#endif
 
 /** C L A S S  S P E C I F I C  R E Q ****************************************/
 /******************************************************************************
@@ -208,4 +231,269 @@ void USBCheckAudioRequest(void)
     }//end switch(SetupPkt.bRequest
 }//end USBCheckAudioRequest
 
+#if defined(USB_AUDIO_STREAM_OUT_EP) || defined(USB_AUDIO_STREAM_IN_EP)
+/** I S O C H R O N O U S  S T R E A M I N G *********************************/
+
+/******************************************************************************
+ 	Function:
+ 		void USBAudioStreamInit(BYTE *outFifo, WORD outFrames, BYTE *inFifo,
+ 		                        WORD inFrames, DWORD sampleRate, QWORD timerHz)
+
+ 	Description:
+ 		Enables the stream endpoints, arms both buffer descriptors of the
+ 		OUT endpoint and starts measuring the sample rate.
+
+ 	PreCondition:
+ 		The device is configured.
+
+	Parameters:
+		BYTE *outFifo    - Storage for the OUT FIFO, outFrames sample frames
+		WORD outFrames   - Capacity of the OUT FIFO in sample frames
+		BYTE *inFifo     - Storage for the IN FIFO, inFrames sample frames
+		WORD inFrames    - Capacity of the IN FIFO in sample frames
+		DWORD sampleRate - Sample rate in Hz
+		QWORD timerHz    - Frequency of the local timer
+
+	Return Values:
+		None
+
+	Remarks:
+		Isochronous endpoints are enabled without handshaking.  The stream
+		endpoints may share an endpoint number in opposite directions.
+
+ *****************************************************************************/
+void USBAudioStreamInit(BYTE *outFifo, WORD outFrames, BYTE *inFifo, WORD inFrames, DWORD sampleRate, QWORD timerHz)
+{
+    BYTE epNum[3];
+    BYTE epOptions[3];
+    BYTE count;
+    BYTE i;
+
+    USBMaskInterrupts();
+
+    USBAudioFeedbackInit(&audioFeedback, sampleRate, timerHz, USB_AUDIO_FEEDBACK_REFRESH);
+
+    //The options of endpoints that share a number must be written together.
+    count = 0;
+    #if defined(USB_AUDIO_STREAM_OUT_EP)
+        count = USBAudioStreamAddEP(epNum, epOptions, count, USB_AUDIO_STREAM_OUT_EP, USB_OUT_ENABLED);
+    #endif
+    #if defined(USB_AUDIO_STREAM_IN_EP)
+        count = USBAudioStreamAddEP(epNum, epOptions, count, USB_AUDIO_STREAM_IN_EP, USB_IN_ENABLED);
+    #endif
+    #if defined(USB_AUDIO_FEEDBACK_EP)
+        count = USBAudioStreamAddEP(epNum, epOptions, count, USB_AUDIO_FEEDBACK_EP, USB_IN_ENABLED);
+    #endif
+    for(i = 0; i < count; i++)
+    {
+        USBEnableEndpoint(epNum[i], epOptions[i] | USB_DISALLOW_SETUP);
+    }
+
+    #if defined(USB_AUDIO_STREAM_OUT_EP)
+        USBAudioFifoInit(&audioOutFifo, outFifo, outFrames, USB_AUDIO_STREAM_FRAME_BYTES);
+        audioOutHandle[0] = USBRxOnePacket(USB_AUDIO_STREAM_OUT_EP, audioOutPacket[0], USB_AUDIO_STREAM_MAX_PACKET);
+        audioOutHandle[1] = USBRxOnePacket(USB_AUDIO_STREAM_OUT_EP, audioOutPacket[1], USB_AUDIO_STREAM_MAX_PACKET);
+        audioOutNext = 0;
+    #endif
+
+    #if defined(USB_AUDIO_STREAM_IN_EP)
+        USBAudioFifoInit(&audioInFifo, inFifo, inFrames, USB_AUDIO_STREAM_FRAME_BYTES);
+        audioInNext = 0;
+    #endif
+
+    #if defined(USB_AUDIO_FEEDBACK_EP)
+        audioFeedbackHandle = 0;
+    #endif
+
+    USBUnmaskInterrupts();
+}//end USBAudioStreamInit
+
+/******************************************************************************
+ 	Function:
+ 		void USBAudioStreamSOFHandler(void)
+
+ 	Description:
+ 		Timestamps the Start-of-Frame, moves the received OUT packets into
+ 		the OUT FIFO and re-arms them, prepares the next IN packet and sends
+ 		the feedback value when it is due.
+
+ 	PreCondition:
+ 		USBAudioStreamInit() has been called.
+
+	Parameters:
+		None
+
+	Return Values:
+		None
+
+	Remarks:
+		Called from the EVENT_SOF case of USER_USB_CALLBACK_EVENT_HANDLER().
+
+ *****************************************************************************/
+void USBAudioStreamSOFHandler(void)
+{
+    BOOL refresh;
+    #if defined(USB_AUDIO_STREAM_OUT_EP) || defined(USB_AUDIO_STREAM_IN_EP)
+    BYTE i;
+    #endif
+    #if defined(USB_AUDIO_STREAM_IN_EP)
+    WORD frames;
+    #endif
+    #if defined(USB_AUDIO_FEEDBACK_EP)
+    DWORD value;
+    #endif
+
+    //Take the timestamp first, the rest of the handler adds latency.
+    refresh = USBAudioFeedbackSOF(&audioFeedback, USB_AUDIO_STREAM_TIMESTAMP());
+
+    #if defined(USB_AUDIO_STREAM_OUT_EP)
+        //The two buffer descriptors complete in the order they were armed.
+        for(i = 0; (i < 2) && !USBHandleBusy(audioOutHandle[audioOutNext]); i++)
+        {
+            USBAudioFifoWrite(&audioOutFifo, audioOutPacket[audioOutNext],
+                              USBHandleGetLength(audioOutHandle[audioOutNext]) / USB_AUDIO_STREAM_FRAME_BYTES);
+            audioOutHandle[audioOutNext] = USBRxOnePacket(USB_AUDIO_STREAM_OUT_EP, audioOutPacket[audioOutNext], USB_AUDIO_STREAM_MAX_PACKET);
+            audioOutNext ^= 1;
+        }
+    #endif
+
+    #if defined(USB_AUDIO_STREAM_IN_EP)
+        //Keep a packet queued for the next frame, the host reads one per frame.
+        for(i = 0; (i < 2) && !USBHandleBusy(USBGetNextHandle(USB_AUDIO_STREAM_IN_EP, IN_TO_HOST)); i++)
+        {
+            frames = USBAudioFeedbackFrameSamples(&audioFeedback, USBAudioFifoCount(&audioInFifo), audioInFifo.size / 2);
+            if(frames > (USB_AUDIO_STREAM_MAX_PACKET / USB_AUDIO_STREAM_FRAME_BYTES))
+            {
+                frames = USB_AUDIO_STREAM_MAX_PACKET / USB_AUDIO_STREAM_FRAME_BYTES;
+            }
+            frames = USBAudioFifoRead(&audioInFifo, audioInPacket[audioInNext], frames);
+            USBTxOnePacket(USB_AUDIO_STREAM_IN_EP, audioInPacket[audioInNext], frames * USB_AUDIO_STREAM_FRAME_BYTES);
+            audioInNext ^= 1;
+        }
+    #endif
+
+    #if defined(USB_AUDIO_FEEDBACK_EP)
+        //10.14 samples per frame, sent as three bytes, least significant first.
+        if(refresh && !USBHandleBusy(audioFeedbackHandle))
+        {
+            value = USBAudioFeedbackValue(&audioFeedback, USBAudioFifoCount(&audioOutFifo), audioOutFifo.size / 2);
+            audioFeedbackPacket[0] = (BYTE)value;
+            audioFeedbackPacket[1] = (BYTE)(value >> 8);
+            audioFeedbackPacket[2] = (BYTE)(value >> 16);
+            audioFeedbackHandle = USBTxOnePacket(USB_AUDIO_FEEDBACK_EP, audioFeedbackPacket, 3);
+        }
+    #else
+        (void)refresh;
+    #endif
+}//end USBAudioStreamSOFHandler
+
+#if defined(USB_AUDIO_STREAM_OUT_EP)
+/******************************************************************************
+ 	Function:
+ 		WORD USBAudioStreamRead(BYTE *data, WORD frames)
+
+ 	Description:
+ 		Copies up to the requested number of sample frames out of the OUT
+ 		FIFO.
+
+ 	PreCondition:
+ 		USBAudioStreamInit() has been called.
+
+	Parameters:
+		BYTE *data  - Buffer for the sample frames
+		WORD frames - Number of sample frames requested
+
+	Return Values:
+		WORD - Number of sample frames copied
+
+	Remarks:
+		None
+
+ *****************************************************************************/
+WORD USBAudioStreamRead(BYTE *data, WORD frames)
+{
+    USBMaskInterrupts();
+    frames = USBAudioFifoRead(&audioOutFifo, data, frames);
+    USBUnmaskInterrupts();
+
+    return frames;
+}//end USBAudioStreamRead
+#endif
+
+#if defined(USB_AUDIO_STREAM_IN_EP)
+/******************************************************************************
+ 	Function:
+ 		WORD USBAudioStreamWrite(BYTE *data, WORD frames)
+
+ 	Description:
+ 		Copies as many of the sample frames as fit into the IN FIFO.
+
+ 	PreCondition:
+ 		USBAudioStreamInit() has been called.
+
+	Parameters:
+		BYTE *data  - Sample frames
+		WORD frames - Number of sample frames
+
+	Return Values:
+		WORD - Number of sample frames copied
+
+	Remarks:
+		None
+
+ *****************************************************************************/
+WORD USBAudioStreamWrite(BYTE *data, WORD frames)
+{
+    USBMaskInterrupts();
+    frames = USBAudioFifoWrite(&audioInFifo, data, frames);
+    USBUnmaskInterrupts();
+
+    return frames;
+}//end USBAudioStreamWrite
+#endif
+
+/******************************************************************************
+ 	Function:
+ 		static BYTE USBAudioStreamAddEP(BYTE *epNum, BYTE *epOptions,
+ 		                                BYTE count, BYTE ep, BYTE options)
+
+ 	Description:
+ 		Adds the options of an endpoint to the list of endpoints to enable,
+ 		merging them with an entry of the same endpoint number.
+
+ 	PreCondition:
+ 		None
+
+	Parameters:
+		BYTE *epNum     - Endpoint numbers in the list
+		BYTE *epOptions - Options of the endpoints in the list
+		BYTE count      - Number of entries in the list
+		BYTE ep         - Endpoint number to add
+		BYTE options    - USB_OUT_ENABLED or USB_IN_ENABLED
+
+	Return Values:
+		BYTE - New number of entries in the list
+
+	Remarks:
+		None
+
+ *****************************************************************************/
+static BYTE USBAudioStreamAddEP(BYTE *epNum, BYTE *epOptions, BYTE count, BYTE ep, BYTE options)
+{
+    BYTE i;
+
+    for(i = 0; i < count; i++)
+    {
+        if(epNum[i] == ep)
+        {
+            epOptions[i] |= options;
+            return count;
+        }
+    }
+    epNum[count] = ep;
+    epOptions[count] = options;
+    return count + 1;
+}//end USBAudioStreamAddEP
+#endif
+
 #endif
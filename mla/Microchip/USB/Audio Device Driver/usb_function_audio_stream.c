@@ -0,0 +1,395 @@
+/********************************************************************************
+  File Information:
+    FileName:       usb_function_audio_stream.c
+    Dependencies:   See INCLUDES section
+    Processor:      Microchip USB Microcontrollers
+    Hardware:       Please see help file in "<install directory>\Microchip\Help"
+	                for details.
+    Complier:   	Microchip C30 (for PIC24) or C32 (for PIC32)
+    Company:        Microchip Technology, Inc.
+
+    Software License Agreement:
+
+    The software supplied herewith by Microchip Technology Incorporated
+    (the "Company") for its PIC(R) Microcontroller is intended and
+    supplied to you, the Company's customer, for use solely and
+    exclusively on Microchip PIC Microcontroller products. The
+    software is owned by the Company and/or its supplier, and is
+    protected under applicable copyright laws. All rights are reserved.
+    Any use in violation of the foregoing restrictions may subject the
+    user to criminal sanctions under applicable laws, as well as to
+    civil liability for the breach of the terms and conditions of this
+    license.
+
+    THIS SOFTWARE IS PROVIDED IN AN "AS IS" CONDITION. NO WARRANTIES,
+    WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+    TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+    IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+    CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+
+  Summary:
+    This file contains the sample FIFO and the feedback calculations used by
+    the isochronous streaming engine of the USB Device Audio function driver.
+
+  Description:
+    USB Device Audio Streaming FIFO and Feedback File
+
+    This file has no dependencies on the USB stack or on the hardware, so
+    it can also be compiled on a development host to check the FIFO and the
+    feedback calculations.  It must be added to the project when
+    USB_AUDIO_STREAM_OUT_EP or USB_AUDIO_STREAM_IN_EP is defined in
+    usb_config.h.
+
+    This file is located in the "\<Install Directory\>\\Microchip\\USB\\Audio
+    Device Driver" directory.
+  ********************************************************************************/
+
+ /** I N C L U D E S *******************************************************/
+#include <string.h>
+#include "GenericTypeDefs.h"
+#include "USB/usb_function_audio_stream.h"
+
+/** S A M P L E  F I F O *****************************************************/
+
+/******************************************************************************
+ 	Function:
+ 		void USBAudioFifoInit(USB_AUDIO_FIFO *fifo, BYTE *buffer,
+ 		                      WORD frames, BYTE frameBytes)
+
+ 	Description:
+ 		Initializes an empty sample frame FIFO.
+
+ 	PreCondition:
+ 		None
+
+	Parameters:
+		USB_AUDIO_FIFO *fifo - FIFO to initialize
+		BYTE *buffer         - Storage of frames * frameBytes bytes
+		WORD frames          - Capacity in sample frames
+		BYTE frameBytes      - Bytes per sample frame
+
+	Return Values:
+		None
+
+	Remarks:
+		None
+
+ *****************************************************************************/
+void USBAudioFifoInit(USB_AUDIO_FIFO *fifo, BYTE *buffer, WORD frames, BYTE frameBytes)
+{
+    fifo->buffer     = buffer;
+    fifo->size       = frames;
+    fifo->head       = 0;
+    fifo->tail       = 0;
+    fifo->count      = 0;
+    fifo->frameBytes = frameBytes;
+    fifo->overruns   = 0;
+    fifo->underruns  = 0;
+}//end USBAudioFifoInit
+
+/******************************************************************************
+ 	Function:
+ 		WORD USBAudioFifoWrite(USB_AUDIO_FIFO *fifo, BYTE *data, WORD frames)
+
+ 	Description:
+ 		Copies as many of the sample frames as fit into the FIFO.  The
+ 		frames that do not fit are counted in fifo->overruns.
+
+ 	PreCondition:
+ 		USBAudioFifoInit() has been called.
+
+	Parameters:
+		USB_AUDIO_FIFO *fifo - FIFO
+		BYTE *data           - Sample frames
+		WORD frames          - Number of sample frames
+
+	Return Values:
+		WORD - Number of sample frames copied
+
+	Remarks:
+		None
+
+ *****************************************************************************/
+WORD USBAudioFifoWrite(USB_AUDIO_FIFO *fifo, BYTE *data, WORD frames)
+{
+    WORD copied;
+    WORD length;
+
+    if(frames > (fifo->size - fifo->count))
+    {
+        fifo->overruns += frames - (fifo->size - fifo->count);
+        frames = fifo->size - fifo->count;
+    }
+
+    //Copy in at most two pieces, up to the end of the buffer and from the start.
+    copied = 0;
+    while(copied < frames)
+    {
+        length = fifo->size - fifo->head;
+        if(length > (frames - copied))
+        {
+            length = frames - copied;
+        }
+        memcpy(&fifo->buffer[(DWORD)fifo->head * fifo->frameBytes], &data[(DWORD)copied * fifo->frameBytes], (DWORD)length * fifo->frameBytes);
+        copied += length;
+        fifo->head += length;
+        if(fifo->head == fifo->size)
+        {
+            fifo->head = 0;
+        }
+    }
+    fifo->count += copied;
+
+    return copied;
+}//end USBAudioFifoWrite
+
+/******************************************************************************
+ 	Function:
+ 		WORD USBAudioFifoRead(USB_AUDIO_FIFO *fifo, BYTE *data, WORD frames)
+
+ 	Description:
+ 		Copies up to the requested number of sample frames out of the FIFO.
+ 		The frames that were not available are counted in fifo->underruns.
+
+ 	PreCondition:
+ 		USBAudioFifoInit() has been called.
+
+	Parameters:
+		USB_AUDIO_FIFO *fifo - FIFO
+		BYTE *data           - Buffer for the sample frames
+		WORD frames          - Number of sample frames requested
+
+	Return Values:
+		WORD - Number of sample frames copied
+
+	Remarks:
+		None
+
+ *****************************************************************************/
+WORD USBAudioFifoRead(USB_AUDIO_FIFO *fifo, BYTE *data, WORD frames)
+{
+    WORD copied;
+    WORD length;
+
+    if(frames > fifo->count)
+    {
+        fifo->underruns += frames - fifo->count;
+        frames = fifo->count;
+    }
+
+    copied = 0;
+    while(copied < frames)
+    {
+        length = fifo->size - fifo->tail;
+        if(length > (frames - copied))
+        {
+            length = frames - copied;
+        }
+        memcpy(&data[(DWORD)copied * fifo->frameBytes], &fifo->buffer[(DWORD)fifo->tail * fifo->frameBytes], (DWORD)length * fifo->frameBytes);
+        copied += length;
+        fifo->tail += length;
+        if(fifo->tail == fifo->size)
+        {
+            fifo->tail = 0;
+        }
+    }
+    fifo->count -= copied;
+
+    return copied;
+}//end USBAudioFifoRead
+
+/** F E E D B A C K **********************************************************/
+
+/******************************************************************************
+ 	Function:
+ 		void USBAudioFeedbackInit(USB_AUDIO_FEEDBACK *fb, DWORD sampleRate,
+ 		                          QWORD timerHz, BYTE refresh)
+
+ 	Description:
+ 		Initializes the sample rate estimate to the nominal number of
+ 		samples per USB frame.
+
+ 	PreCondition:
+ 		None
+
+	Parameters:
+		USB_AUDIO_FEEDBACK *fb - Feedback state to initialize
+		DWORD sampleRate       - Sample rate in Hz
+		QWORD timerHz          - Frequency of the local timer
+		BYTE refresh           - The rate is measured over 2^refresh frames
+
+	Return Values:
+		None
+
+	Remarks:
+		None
+
+ *****************************************************************************/
+void USBAudioFeedbackInit(USB_AUDIO_FEEDBACK *fb, DWORD sampleRate, QWORD timerHz, BYTE refresh)
+{
+    fb->timerHz     = timerHz;
+    fb->windowStart = 0;
+    fb->sampleRate  = sampleRate;
+    fb->nominal     = (DWORD)(((QWORD)sampleRate << USB_AUDIO_FEEDBACK_FRACTION_BITS) / USB_AUDIO_FRAMES_PER_SECOND);
+    fb->estimate    = fb->nominal;
+    fb->accumulator = 0;
+    fb->frames      = 0;
+    fb->refresh     = refresh;
+    fb->started     = FALSE;
+}//end USBAudioFeedbackInit
+
+/******************************************************************************
+ 	Function:
+ 		BOOL USBAudioFeedbackSOF(USB_AUDIO_FEEDBACK *fb, QWORD timestamp)
+
+ 	Description:
+ 		Records the local timer value at a Start-of-Frame.  Every 2^refresh
+ 		frames, the number of samples per USB frame is measured from the
+ 		time the window took:
+
+ 		    estimate = sampleRate * (window time / timerHz) / 2^refresh
+
+ 		Consecutive windows share their end points, so the interrupt latency
+ 		of a single SOF does not add up over time.
+
+ 	PreCondition:
+ 		USBAudioFeedbackInit() has been called.
+
+	Parameters:
+		USB_AUDIO_FEEDBACK *fb - Feedback state
+		QWORD timestamp        - Local timer value at the Start-of-Frame
+
+	Return Values:
+		TRUE  - A window ended, and a new feedback value should be sent
+		FALSE - Otherwise
+
+	Remarks:
+		A measurement more than 1/64 off the nominal rate is ignored.
+
+ *****************************************************************************/
+BOOL USBAudioFeedbackSOF(USB_AUDIO_FEEDBACK *fb, QWORD timestamp)
+{
+    QWORD estimate;
+
+    if(!fb->started)
+    {
+        fb->windowStart = timestamp;
+        fb->frames = 0;
+        fb->started = TRUE;
+        return FALSE;
+    }
+
+    if(++fb->frames < ((WORD)1 << fb->refresh))
+    {
+        return FALSE;
+    }
+
+    estimate = (((QWORD)fb->sampleRate * (timestamp - fb->windowStart)) << USB_AUDIO_FEEDBACK_FRACTION_BITS) /
+               (fb->timerHz << fb->refresh);
+
+    //A window with missed or extra SOFs is far off the nominal rate.
+    if((estimate + (fb->nominal >> 6) >= fb->nominal) && (estimate <= fb->nominal + (fb->nominal >> 6)))
+    {
+        fb->estimate = (DWORD)estimate;
+    }
+
+    fb->windowStart = timestamp;
+    fb->frames = 0;
+    return TRUE;
+}//end USBAudioFeedbackSOF
+
+/******************************************************************************
+ 	Function:
+ 		DWORD USBAudioFeedbackValue(USB_AUDIO_FEEDBACK *fb, WORD level,
+ 		                            WORD target)
+
+ 	Description:
+ 		Returns the measured samples per frame, plus a correction that
+ 		moves the level of the OUT FIFO toward its target over
+ 		2^USB_AUDIO_FEEDBACK_GAIN_SHIFT frames.  The value is kept within
+ 		one sample of the nominal rate.
+
+ 	PreCondition:
+ 		USBAudioFeedbackInit() has been called.
+
+	Parameters:
+		USB_AUDIO_FEEDBACK *fb - Feedback state
+		WORD level             - Sample frames in the OUT FIFO
+		WORD target            - Sample frames the OUT FIFO should hold
+
+	Return Values:
+		DWORD - Samples per frame in 10.14 format
+
+	Remarks:
+		None
+
+ *****************************************************************************/
+DWORD USBAudioFeedbackValue(USB_AUDIO_FEEDBACK *fb, WORD level, WORD target)
+{
+    LONG value;
+    LONG limit;
+
+    value = (LONG)fb->estimate +
+            ((LONG)target - (LONG)level) * ((LONG)1 << (USB_AUDIO_FEEDBACK_FRACTION_BITS - USB_AUDIO_FEEDBACK_GAIN_SHIFT));
+
+    limit = (LONG)1 << USB_AUDIO_FEEDBACK_FRACTION_BITS;
+    if(value > (LONG)fb->nominal + limit)
+    {
+        value = (LONG)fb->nominal + limit;
+    }
+    else if(value < (LONG)fb->nominal - limit)
+    {
+        value = (LONG)fb->nominal - limit;
+    }
+
+    return (DWORD)value;
+}//end USBAudioFeedbackValue
+
+/******************************************************************************
+ 	Function:
+ 		WORD USBAudioFeedbackFrameSamples(USB_AUDIO_FEEDBACK *fb, WORD level,
+ 		                                  WORD target)
+
+ 	Description:
+ 		Adds the measured samples per frame to a fraction carried from the
+ 		previous packets, and returns the whole number of samples.  One
+ 		sample more is sent when the IN FIFO is more than a packet above its
+ 		target, and one less when it is more than a packet below it.
+
+ 	PreCondition:
+ 		USBAudioFeedbackInit() has been called.
+
+	Parameters:
+		USB_AUDIO_FEEDBACK *fb - Feedback state
+		WORD level             - Sample frames in the IN FIFO
+		WORD target            - Sample frames the IN FIFO should hold
+
+	Return Values:
+		WORD - Number of sample frames
+
+	Remarks:
+		None
+
+ *****************************************************************************/
+WORD USBAudioFeedbackFrameSamples(USB_AUDIO_FEEDBACK *fb, WORD level, WORD target)
+{
+    WORD samples;
+
+    fb->accumulator += fb->estimate;
+    samples = (WORD)(fb->accumulator >> USB_AUDIO_FEEDBACK_FRACTION_BITS);
+    fb->accumulator &= ((DWORD)1 << USB_AUDIO_FEEDBACK_FRACTION_BITS) - 1;
+
+    if(level > target + samples)
+    {
+        samples++;
+    }
+    else if((level + samples < target) && (samples != 0))
+    {
+        samples--;
+    }
+
+    return samples;
+}//end USBAudioFeedbackFrameSamples
+
+/** EOF usb_function_audio_stream.c ******************************************/
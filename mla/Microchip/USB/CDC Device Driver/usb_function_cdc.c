@@ -99,9 +99,13 @@
   
   2.9b   Updated to implement optional support for DTS reporting.
 
+  2.9j   Added the optional TX and RX packet rings, with reserve/commit
+         access to the packet buffers and automatic zero length packets.
+
 ********************************************************************/
 
 /** I N C L U D E S **********************************************************/
+#include <string.h>
 #include "USB/usb.h"
 #include "USB/usb_function_cdc.h"
 #include "HardwareProfile.h"
@@ -110,9 +114,10 @@
 
 /** V A R I A B L E S ********************************************************/
 #if defined(__18CXX)
-    //The cdc_data_rx[] and cdc_data_tx[] arrays and associated variables are used 
-    //as USB packet buffers in this firmware.  Therefore, they must be located in
-    //a USB module accessible portion of microcontroller RAM.
+    //The cdc_data_rx[] and cdc_data_tx[] arrays (or the cdc_rx_ring[] and 
+    //cdc_tx_ring[] arrays) and associated variables are used as USB packet 
+    //buffers in this firmware.  Therefore, they must be located in a USB 
+    //module accessible portion of microcontroller RAM.
     #if defined(__18F14K50) || defined(__18F13K50) || defined(__18LF14K50) || defined(__18LF13K50) 
         #pragma udata usbram2
     #elif defined(__18F2455) || defined(__18F2550) || defined(__18F4455) || defined(__18F4550)\
@@ -138,6 +143,7 @@
         #define OUT_DATA_BUFFER_ADDRESS_TAG @OUT_DATA_BUFFER_ADDRESS
         #define LINE_CODING_ADDRESS_TAG     @LINE_CODING_ADDRESS
         #define NOTICE_ADDRESS_TAG          @NOTICE_ADDRESS
+        #define CDC_FIXED_BUFFER_ADDRESSES
     #elif  defined(_18F2455)   || defined(_18F2550)   || defined(_18F4455)  || defined(_18F4550)\
         || defined(_18F2458)   || defined(_18F2453)   || defined(_18F4558)  || defined(_18F4553)\
         || defined(_18LF24K50) || defined(_18F24K50)  || defined(_18LF25K50)\
@@ -151,6 +157,7 @@
         #define OUT_DATA_BUFFER_ADDRESS_TAG @OUT_DATA_BUFFER_ADDRESS
         #define LINE_CODING_ADDRESS_TAG     @LINE_CODING_ADDRESS
         #define NOTICE_ADDRESS_TAG          @NOTICE_ADDRESS
+        #define CDC_FIXED_BUFFER_ADDRESSES
     #elif defined(_18F4450) || defined(_18F2450)
         #define IN_DATA_BUFFER_ADDRESS 0x480
         #define OUT_DATA_BUFFER_ADDRESS (IN_DATA_BUFFER_ADDRESS + CDC_DATA_IN_EP_SIZE)
@@ -161,6 +168,7 @@
         #define OUT_DATA_BUFFER_ADDRESS_TAG @OUT_DATA_BUFFER_ADDRESS
         #define LINE_CODING_ADDRESS_TAG     @LINE_CODING_ADDRESS
         #define NOTICE_ADDRESS_TAG          @NOTICE_ADDRESS
+        #define CDC_FIXED_BUFFER_ADDRESSES
     #elif defined(_16F1459) || defined(_16LF1459) || defined(_16F1454) || defined(_16LF1454) || defined(_16F1455) || defined(_16LF1455)
         #define IN_DATA_BUFFER_ADDRESS 0x2140
         #define OUT_DATA_BUFFER_ADDRESS 0x2190
@@ -171,6 +179,7 @@
         #define OUT_DATA_BUFFER_ADDRESS_TAG @OUT_DATA_BUFFER_ADDRESS
         #define LINE_CODING_ADDRESS_TAG     @LINE_CODING_ADDRESS
         #define NOTICE_ADDRESS_TAG          @NOTICE_ADDRESS
+        #define CDC_FIXED_BUFFER_ADDRESSES
     #else
         #define IN_DATA_BUFFER_ADDRESS_TAG
         #define OUT_DATA_BUFFER_ADDRESS_TAG
@@ -184,8 +193,27 @@
     #define NOTICE_ADDRESS_TAG
 #endif
 
-volatile FAR unsigned char cdc_data_tx[CDC_DATA_IN_EP_SIZE] IN_DATA_BUFFER_ADDRESS_TAG;
-volatile FAR unsigned char cdc_data_rx[CDC_DATA_OUT_EP_SIZE] OUT_DATA_BUFFER_ADDRESS_TAG;
+//The fixed USB RAM layout above only has room for one packet in each
+//direction.
+#if defined(CDC_FIXED_BUFFER_ADDRESSES) && (defined(USB_CDC_TX_RING_PACKETS) || defined(USB_CDC_RX_RING_PACKETS))
+    #error "USB_CDC_TX_RING_PACKETS and USB_CDC_RX_RING_PACKETS are not supported on this device with XC8."
+#endif
+
+#if defined(USB_CDC_TX_RING_PACKETS)
+    //Each slot of the ring is one bulk IN packet.  The application writes
+    //into the slots directly (see CDCTxReserve()), and CDCTxService() hands
+    //them to the even and odd BDTs without copying.
+    volatile FAR unsigned char cdc_tx_ring[USB_CDC_TX_RING_PACKETS][CDC_DATA_IN_EP_SIZE];
+#else
+    volatile FAR unsigned char cdc_data_tx[CDC_DATA_IN_EP_SIZE] IN_DATA_BUFFER_ADDRESS_TAG;
+#endif
+#if defined(USB_CDC_RX_RING_PACKETS)
+    //Each slot of the ring receives one bulk OUT packet.  Free slots are armed
+    //on the even and odd BDTs, received ones are read in place (see CDCRxPeek()).
+    volatile FAR unsigned char cdc_rx_ring[USB_CDC_RX_RING_PACKETS][CDC_DATA_OUT_EP_SIZE];
+#else
+    volatile FAR unsigned char cdc_data_rx[CDC_DATA_OUT_EP_SIZE] OUT_DATA_BUFFER_ADDRESS_TAG;
+#endif
 
 LINE_CODING line_coding LINE_CODING_ADDRESS_TAG;    // Buffer to store line coding information
 volatile FAR CDC_NOTICE cdc_notice NOTICE_ADDRESS_TAG;
@@ -209,6 +237,36 @@ BYTE cdc_mem_type;          // _ROM, _RAM
 USB_HANDLE CDCDataOutHandle;
 USB_HANDLE CDCDataInHandle;
 
+#if defined(USB_CDC_TX_RING_PACKETS)
+    #if (USB_CDC_TX_RING_PACKETS < 2)
+        #error "USB_CDC_TX_RING_PACKETS must be at least 2."
+    #endif
+    #if ((USB_CDC_TX_RING_PACKETS * CDC_DATA_IN_EP_SIZE) < 255)
+        #error "The TX ring must hold the 255 bytes putUSBUSART() may be given."
+    #endif
+    static BYTE cdcTxLen[USB_CDC_TX_RING_PACKETS];          // Bytes in each slot
+    static USB_HANDLE cdcTxHandle[USB_CDC_TX_RING_PACKETS]; // IN transfer of each sent slot
+    static BYTE cdcTxHead;          // Slot being filled by the application
+    static BYTE cdcTxSend;          // Next closed slot to hand to the USB module
+    static BYTE cdcTxTail;          // Oldest slot not yet sent completely
+    static BYTE cdcTxClosed;        // Closed slots, queued or being sent
+    static BOOL cdcTxZLP;           // The last packet sent was full size
+#endif
+
+#if defined(USB_CDC_RX_RING_PACKETS)
+    #if (USB_CDC_RX_RING_PACKETS < 2)
+        #error "USB_CDC_RX_RING_PACKETS must be at least 2."
+    #endif
+    static BYTE cdcRxLen[USB_CDC_RX_RING_PACKETS];          // Bytes received in each slot
+    static USB_HANDLE cdcRxHandle[USB_CDC_RX_RING_PACKETS]; // OUT transfer of each armed slot
+    static BYTE cdcRxTail;          // Oldest received slot, read by the application
+    static BYTE cdcRxDone;          // Oldest armed slot not yet received
+    static BYTE cdcRxArm;           // Next free slot to arm
+    static BYTE cdcRxPending;       // Armed slots not yet received
+    static BYTE cdcRxReady;         // Received slots not yet released
+    static BYTE cdcRxPos;           // Read position in the tail slot
+#endif
+
 
 CONTROL_SIGNAL_BITMAP control_signal_bitmap;
 DWORD BaudRateGen;			// BRG value calculated from baudrate
@@ -234,6 +292,17 @@ CTRL_TRF_RETURN USB_CDC_SET_LINE_CODING_HANDLER(CTRL_TRF_PARAMS);
 
 /** P R I V A T E  P R O T O T Y P E S ***************************************/
 void USBCDCSetLineCoding(void);
+#if defined(USB_CDC_TX_RING_PACKETS)
+static void CDCTxRingInit(void);
+static void CDCTxRingRelease(void);
+static WORD CDCTxRingFreeSpace(void);
+static void CDCTxRingUpdateState(void);
+#endif
+#if defined(USB_CDC_RX_RING_PACKETS)
+static void CDCRxRingInit(void);
+static void CDCRxRingAdvance(BYTE length);
+static void CDCRxRingService(void);
+#endif
 
 /** D E C L A R A T I O N S **************************************************/
 //#pragma code
@@ -434,8 +503,15 @@ void CDCInitEP(void)
     USBEnableEndpoint(CDC_COMM_EP,USB_IN_ENABLED|USB_HANDSHAKE_ENABLED|USB_DISALLOW_SETUP);
     USBEnableEndpoint(CDC_DATA_EP,USB_IN_ENABLED|USB_OUT_ENABLED|USB_HANDSHAKE_ENABLED|USB_DISALLOW_SETUP);
 
-    CDCDataOutHandle = USBRxOnePacket(CDC_DATA_EP,(BYTE*)&cdc_data_rx,sizeof(cdc_data_rx));
+    #if defined(USB_CDC_RX_RING_PACKETS)
+        CDCRxRingInit();
+    #else
+        CDCDataOutHandle = USBRxOnePacket(CDC_DATA_EP,(BYTE*)&cdc_data_rx,sizeof(cdc_data_rx));
+    #endif
     CDCDataInHandle = NULL;
+    #if defined(USB_CDC_TX_RING_PACKETS)
+        CDCTxRingInit();
+    #endif
 
     #if defined(USB_CDC_SUPPORT_DSR_REPORTING)
       	CDCNotificationInHandle = NULL;
@@ -545,17 +621,45 @@ BOOL USBCDCEventHandler(USB_EVENT event, void *pdata, WORD size)
     switch( (INT)event )
     {  
         case EVENT_TRANSFER_TERMINATED:
-            if(pdata == CDCDataOutHandle)
-            {
-                CDCDataOutHandle = USBRxOnePacket(CDC_DATA_EP,(BYTE*)&cdc_data_rx,sizeof(cdc_data_rx));  
-            }
-            if(pdata == CDCDataInHandle)
-            {
-                //flush all of the data in the CDC buffer
-                cdc_trf_state = CDC_TX_READY;
-                cdc_tx_len = 0;
-            }
+        {
+            #if defined(USB_CDC_TX_RING_PACKETS) || defined(USB_CDC_RX_RING_PACKETS)
+                BYTE i;
+            #endif
+
+            #if defined(USB_CDC_RX_RING_PACKETS)
+                //The slot is received as an empty packet and re-armed in order.
+                for(i = 0; i < USB_CDC_RX_RING_PACKETS; i++)
+                {
+                    if(pdata == cdcRxHandle[i])
+                    {
+                        cdcRxHandle[i] = NULL;
+                    }
+                }
+            #else
+                if(pdata == CDCDataOutHandle)
+                {
+                    CDCDataOutHandle = USBRxOnePacket(CDC_DATA_EP,(BYTE*)&cdc_data_rx,sizeof(cdc_data_rx));  
+                }
+            #endif
+            #if defined(USB_CDC_TX_RING_PACKETS)
+                //The data of the slot is dropped, the slot is released.
+                for(i = 0; i < USB_CDC_TX_RING_PACKETS; i++)
+                {
+                    if(pdata == cdcTxHandle[i])
+                    {
+                        cdcTxHandle[i] = NULL;
+                    }
+                }
+            #else
+                if(pdata == CDCDataInHandle)
+                {
+                    //flush all of the data in the CDC buffer
+                    cdc_trf_state = CDC_TX_READY;
+                    cdc_tx_len = 0;
+                }
+            #endif
             break;
+        }
         default:
             return FALSE;
     }      
@@ -603,6 +707,10 @@ BOOL USBCDCEventHandler(USB_EVENT event, void *pdata, WORD size)
   **********************************************************************************/
 BYTE getsUSBUSART(char *buffer, BYTE len)
 {
+    #if defined(USB_CDC_RX_RING_PACKETS)
+        cdc_rx_len = (BYTE)CDCRxRead((BYTE*)buffer, len);
+        return cdc_rx_len;
+    #else
     cdc_rx_len = 0;
     
     if(!USBHandleBusy(CDCDataOutHandle))
@@ -629,7 +737,7 @@ BYTE getsUSBUSART(char *buffer, BYTE len)
     }//end if
     
     return cdc_rx_len;
-    
+    #endif
 }//end getsUSBUSART
 
 /******************************************************************************
@@ -697,12 +805,16 @@ void putUSBUSART(char *data, BYTE  length)
      * multi-tasking and a blocking code is not acceptable.
      * Use a state machine instead.
      */
+    #if defined(USB_CDC_TX_RING_PACKETS)
+        CDCTxWrite((BYTE*)data, length);
+    #else
     USBMaskInterrupts();
     if(cdc_trf_state == CDC_TX_READY)
     {
         mUSBUSARTTxRam((BYTE*)data, length);     // See cdc.h
     }
     USBUnmaskInterrupts();
+    #endif
 }//end putUSBUSART
 
 /******************************************************************************
@@ -773,12 +885,14 @@ void putsUSBUSART(char *data)
      * multi-tasking and a blocking code is not acceptable.
      * Use a state machine instead.
      */
+    #if !defined(USB_CDC_TX_RING_PACKETS)
     USBMaskInterrupts();
     if(cdc_trf_state != CDC_TX_READY)
     {
         USBUnmaskInterrupts();
         return;
     }
+    #endif
     
     /*
      * While loop counts the number of BYTEs to send including the
@@ -792,6 +906,11 @@ void putsUSBUSART(char *data)
         if(len == 255) break;       // Break loop once max len is reached.
     }while(*pData++);
     
+    #if defined(USB_CDC_TX_RING_PACKETS)
+        CDCTxWrite((BYTE*)data, len);
+        return;
+    #endif
+
     /*
      * Second piece of information (length of data to send) is ready.
      * Call mUSBUSARTTxRam to setup the transfer.
@@ -870,12 +989,14 @@ void putrsUSBUSART(const ROM char *data)
      * multi-tasking and a blocking code is not acceptable.
      * Use a state machine instead.
      */
+    #if !defined(USB_CDC_TX_RING_PACKETS)
     USBMaskInterrupts();
     if(cdc_trf_state != CDC_TX_READY)
     {
         USBUnmaskInterrupts();
         return;
     }
+    #endif
     
     /*
      * While loop counts the number of BYTEs to send including the
@@ -889,6 +1010,11 @@ void putrsUSBUSART(const ROM char *data)
         if(len == 255) break;       // Break loop once max len is reached.
     }while(*pData++);
     
+    #if defined(USB_CDC_TX_RING_PACKETS)
+        CDCTxWriteROM((const ROM BYTE*)data, len);
+        return;
+    #endif
+
     /*
      * Second piece of information (length of data to send) is ready.
      * Call mUSBUSARTTxRom to setup the transfer.
@@ -901,6 +1027,596 @@ void putrsUSBUSART(const ROM char *data)
 
 }//end putrsUSBUSART
 
+#if defined(USB_CDC_TX_RING_PACKETS)
+/******************************************************************************
+  Function:
+    WORD CDCTxGetFreeSpace(void)
+
+  Summary:
+    Returns the number of bytes that can be queued in the CDC TX ring.
+
+  Description:
+    Returns the number of bytes that CDCTxWrite() will accept, summed over
+    the free part of the slot being filled and the free slots of the ring.
+
+  PreCondition:
+    CDCInitEP() has been called.
+
+  Parameters:
+    None
+
+  Return Values:
+    WORD - Number of free bytes
+
+  Remarks:
+    Only available when USB_CDC_TX_RING_PACKETS is defined in usb_config.h.
+ *****************************************************************************/
+WORD CDCTxGetFreeSpace(void)
+{
+    WORD space;
+
+    USBMaskInterrupts();
+    CDCTxRingRelease();
+    space = CDCTxRingFreeSpace();
+    USBUnmaskInterrupts();
+
+    return space;
+}
+
+/******************************************************************************
+  Function:
+    BYTE* CDCTxReserve(BYTE* length)
+
+  Summary:
+    Gets a pointer into the IN packet buffer being filled, so that the
+    application can write its data there directly.
+
+  Description:
+    Returns the free part of the packet buffer currently being filled.  The
+    application writes up to *length bytes at the returned location and
+    then calls CDCTxCommit() with the number of bytes written.  The data is
+    sent from this buffer, it is not copied again.
+
+    Typical Usage:
+    <code>
+        BYTE* p;
+        BYTE  n;
+
+        p = CDCTxReserve(&n);
+        if(n >= sizeof(sample))
+        {
+            memcpy(p, &sample, sizeof(sample));
+            CDCTxCommit(sizeof(sample));
+        }
+    </code>
+
+  PreCondition:
+    CDCInitEP() has been called.
+
+  Parameters:
+    BYTE* length - Receives the number of bytes that can be written, 0 if
+                   the ring is full
+
+  Return Values:
+    BYTE* - Location to write the data to, NULL if the ring is full
+
+  Remarks:
+    A reservation never spans two packets.  To write more, commit and
+    reserve again.  Only available when USB_CDC_TX_RING_PACKETS is defined
+    in usb_config.h.
+ *****************************************************************************/
+BYTE* CDCTxReserve(BYTE* length)
+{
+    BYTE* p = NULL;
+
+    USBMaskInterrupts();
+    CDCTxRingRelease();
+    *length = CDC_DATA_IN_EP_SIZE - cdcTxLen[cdcTxHead];
+    if(*length != 0)
+    {
+        p = (BYTE*)&cdc_tx_ring[cdcTxHead][cdcTxLen[cdcTxHead]];
+    }
+    USBUnmaskInterrupts();
+
+    return p;
+}
+
+/******************************************************************************
+  Function:
+    void CDCTxCommit(BYTE length)
+
+  Summary:
+    Queues data written at the location returned by CDCTxReserve().
+
+  Description:
+    Adds length bytes to the packet buffer being filled.  Once the buffer
+    is full it is closed and sent by CDCTxService().  A partly filled
+    buffer is sent when nothing else is queued or being sent, or after
+    CDCTxFlush().
+
+  PreCondition:
+    CDCTxReserve() returned at least length bytes.
+
+  Parameters:
+    BYTE length - Number of bytes written
+
+  Return Values:
+    None
+
+  Remarks:
+    Only available when USB_CDC_TX_RING_PACKETS is defined in usb_config.h.
+ *****************************************************************************/
+void CDCTxCommit(BYTE length)
+{
+    USBMaskInterrupts();
+    cdcTxLen[cdcTxHead] += length;
+    CDCTxRingRelease();
+    CDCTxRingUpdateState();
+    USBUnmaskInterrupts();
+}
+
+/******************************************************************************
+  Function:
+    WORD CDCTxWrite(BYTE* data, WORD length)
+
+  Summary:
+    Copies data into the CDC TX ring.
+
+  Description:
+    Copies as much of the data as fits into the ring, straight into the IN
+    packet buffers.  Unlike putUSBUSART(), this function can be called
+    while earlier data is still being sent.
+
+  PreCondition:
+    CDCInitEP() has been called.
+
+  Parameters:
+    BYTE* data  - Data to send
+    WORD length - Number of bytes to send
+
+  Return Values:
+    WORD - Number of bytes queued.  The rest did not fit.
+
+  Remarks:
+    Only available when USB_CDC_TX_RING_PACKETS is defined in usb_config.h.
+ *****************************************************************************/
+WORD CDCTxWrite(BYTE* data, WORD length)
+{
+    WORD written = 0;
+    BYTE* p;
+    BYTE n;
+
+    while(written < length)
+    {
+        p = CDCTxReserve(&n);
+        if(n == 0)
+        {
+            break;
+        }
+        if(n > (length - written))
+        {
+            n = (BYTE)(length - written);
+        }
+        memcpy(p, data, n);
+        CDCTxCommit(n);
+        data += n;
+        written += n;
+    }
+
+    return written;
+}
+
+/******************************************************************************
+  Function:
+    WORD CDCTxWriteROM(const ROM BYTE* data, WORD length)
+
+  Summary:
+    Copies data located in program memory into the CDC TX ring.
+
+  Description:
+    Same as CDCTxWrite(), for data located in program memory.
+
+  PreCondition:
+    CDCInitEP() has been called.
+
+  Parameters:
+    const ROM BYTE* data - Data to send
+    WORD length          - Number of bytes to send
+
+  Return Values:
+    WORD - Number of bytes queued.  The rest did not fit.
+
+  Remarks:
+    Only available when USB_CDC_TX_RING_PACKETS is defined in usb_config.h.
+ *****************************************************************************/
+WORD CDCTxWriteROM(const ROM BYTE* data, WORD length)
+{
+    WORD written = 0;
+    BYTE* p;
+    BYTE n;
+    BYTE i;
+
+    while(written < length)
+    {
+        p = CDCTxReserve(&n);
+        if(n == 0)
+        {
+            break;
+        }
+        if(n > (length - written))
+        {
+            n = (BYTE)(length - written);
+        }
+        for(i = 0; i < n; i++)
+        {
+            *p++ = *data++;
+        }
+        CDCTxCommit(n);
+        written += n;
+    }
+
+    return written;
+}
+
+/******************************************************************************
+  Function:
+    void CDCTxFlush(void)
+
+  Summary:
+    Sends the partly filled IN packet buffer without waiting for more data.
+
+  Description:
+    Closes the packet buffer being filled, so that CDCTxService() sends it
+    after the packets queued before it.  Without this call, a partly filled
+    buffer is only sent when nothing else is queued or being sent, which
+    keeps the packets full while the application writes faster than the
+    host reads.
+
+  PreCondition:
+    CDCInitEP() has been called.
+
+  Parameters:
+    None
+
+  Return Values:
+    None
+
+  Remarks:
+    Nothing happens if the buffer is empty or all the other slots are in
+    use.  Only available when USB_CDC_TX_RING_PACKETS is defined in
+    usb_config.h.
+ *****************************************************************************/
+void CDCTxFlush(void)
+{
+    USBMaskInterrupts();
+    CDCTxRingRelease();
+    if((cdcTxLen[cdcTxHead] != 0) && (cdcTxClosed < (USB_CDC_TX_RING_PACKETS - 1)))
+    {
+        cdcTxClosed++;
+        cdcTxHead = (cdcTxHead + 1) % USB_CDC_TX_RING_PACKETS;
+        cdcTxLen[cdcTxHead] = 0;
+    }
+    USBUnmaskInterrupts();
+}
+
+/******************************************************************************
+  Function:
+    static void CDCTxRingInit(void)
+
+  Summary:
+    Empties the CDC TX ring.
+ *****************************************************************************/
+static void CDCTxRingInit(void)
+{
+    BYTE i;
+
+    for(i = 0; i < USB_CDC_TX_RING_PACKETS; i++)
+    {
+        cdcTxLen[i] = 0;
+        cdcTxHandle[i] = NULL;
+    }
+    cdcTxHead = 0;
+    cdcTxSend = 0;
+    cdcTxTail = 0;
+    cdcTxClosed = 0;
+    cdcTxZLP = FALSE;
+}
+
+/******************************************************************************
+  Function:
+    static void CDCTxRingRelease(void)
+
+  Summary:
+    Frees the slots whose IN transfer completed, and closes the slot being
+    filled if it is full and a free slot is available to replace it.
+    Must be called with the USB interrupts masked.
+ *****************************************************************************/
+static void CDCTxRingRelease(void)
+{
+    while((cdcTxTail != cdcTxSend) && !USBHandleBusy(cdcTxHandle[cdcTxTail]))
+    {
+        cdcTxHandle[cdcTxTail] = NULL;
+        cdcTxTail = (cdcTxTail + 1) % USB_CDC_TX_RING_PACKETS;
+        cdcTxClosed--;
+    }
+
+    if((cdcTxLen[cdcTxHead] == CDC_DATA_IN_EP_SIZE) && (cdcTxClosed < (USB_CDC_TX_RING_PACKETS - 1)))
+    {
+        cdcTxClosed++;
+        cdcTxHead = (cdcTxHead + 1) % USB_CDC_TX_RING_PACKETS;
+        cdcTxLen[cdcTxHead] = 0;
+    }
+}
+
+/******************************************************************************
+  Function:
+    static WORD CDCTxRingFreeSpace(void)
+
+  Summary:
+    Returns the free space of the CDC TX ring.  Must be called with the USB
+    interrupts masked.
+ *****************************************************************************/
+static WORD CDCTxRingFreeSpace(void)
+{
+    WORD space;
+
+    space = (WORD)(USB_CDC_TX_RING_PACKETS - 1 - cdcTxClosed) * CDC_DATA_IN_EP_SIZE;
+    space += CDC_DATA_IN_EP_SIZE - cdcTxLen[cdcTxHead];
+    return space;
+}
+
+/******************************************************************************
+  Function:
+    static void CDCTxRingUpdateState(void)
+
+  Summary:
+    Keeps cdc_trf_state meaningful for USBUSARTIsTxTrfReady(): the state is
+    CDC_TX_READY while the ring can take the 255 bytes that putUSBUSART()
+    may be given.  Must be called with the USB interrupts masked.
+ *****************************************************************************/
+static void CDCTxRingUpdateState(void)
+{
+    cdc_trf_state = (CDCTxRingFreeSpace() >= 255u) ? CDC_TX_READY : CDC_TX_BUSY;
+}
+#endif //USB_CDC_TX_RING_PACKETS
+
+#if defined(USB_CDC_RX_RING_PACKETS)
+/******************************************************************************
+  Function:
+    BYTE* CDCRxPeek(BYTE* length)
+
+  Summary:
+    Gets a pointer to the oldest unread data received on the CDC bulk OUT
+    endpoint.
+
+  Description:
+    Returns the unread part of the oldest received packet, in the packet
+    buffer itself.  After processing some or all of it, the application
+    calls CDCRxRelease() with the number of bytes used.  The packet buffer
+    is armed again for reception once all of its bytes are released.
+
+    Typical Usage:
+    <code>
+        BYTE* p;
+        BYTE  n;
+
+        p = CDCRxPeek(&n);
+        if(n != 0)
+        {
+            n = ParseCommands(p, n);    //returns the number of bytes used
+            CDCRxRelease(n);
+        }
+    </code>
+
+  PreCondition:
+    CDCInitEP() has been called.
+
+  Parameters:
+    BYTE* length - Receives the number of bytes available at the returned
+                   location, 0 if no data was received
+
+  Return Values:
+    BYTE* - Location of the data, NULL if no data was received
+
+  Remarks:
+    Data received in the following packets is returned by the next calls,
+    after this packet is released.  Only available when
+    USB_CDC_RX_RING_PACKETS is defined in usb_config.h.
+ *****************************************************************************/
+BYTE* CDCRxPeek(BYTE* length)
+{
+    BYTE* p = NULL;
+
+    USBMaskInterrupts();
+    CDCRxRingService();
+
+    //Skip zero length packets, and packets that were terminated.
+    while((cdcRxReady != 0) && (cdcRxPos >= cdcRxLen[cdcRxTail]))
+    {
+        CDCRxRingAdvance(0);
+    }
+
+    *length = 0;
+    if(cdcRxReady != 0)
+    {
+        *length = cdcRxLen[cdcRxTail] - cdcRxPos;
+        p = (BYTE*)&cdc_rx_ring[cdcRxTail][cdcRxPos];
+    }
+    USBUnmaskInterrupts();
+
+    return p;
+}
+
+/******************************************************************************
+  Function:
+    void CDCRxRelease(BYTE length)
+
+  Summary:
+    Marks data returned by CDCRxPeek() as read.
+
+  Description:
+    Advances past length bytes of the oldest received packet.  Once the
+    whole packet is read, its buffer is armed again for reception.
+
+  PreCondition:
+    CDCRxPeek() returned at least length bytes.
+
+  Parameters:
+    BYTE length - Number of bytes read
+
+  Return Values:
+    None
+
+  Remarks:
+    Only available when USB_CDC_RX_RING_PACKETS is defined in usb_config.h.
+ *****************************************************************************/
+void CDCRxRelease(BYTE length)
+{
+    USBMaskInterrupts();
+    CDCRxRingAdvance(length);
+    USBUnmaskInterrupts();
+}
+
+/******************************************************************************
+  Function:
+    WORD CDCRxRead(BYTE* buffer, WORD length)
+
+  Summary:
+    Copies received data out of the CDC RX ring.
+
+  Description:
+    Copies up to length bytes, taken from as many received packets as
+    needed, and releases them.  Unlike getsUSBUSART(), the data of a packet
+    that does not fit in the buffer is kept for the next call.
+
+  PreCondition:
+    CDCInitEP() has been called.
+
+  Parameters:
+    BYTE* buffer - Where to copy the data
+    WORD length  - Size of the buffer
+
+  Return Values:
+    WORD - Number of bytes copied, 0 if no data was received
+
+  Remarks:
+    Only available when USB_CDC_RX_RING_PACKETS is defined in usb_config.h.
+ *****************************************************************************/
+WORD CDCRxRead(BYTE* buffer, WORD length)
+{
+    WORD count = 0;
+    BYTE* p;
+    BYTE n;
+
+    while(count < length)
+    {
+        p = CDCRxPeek(&n);
+        if(n == 0)
+        {
+            break;
+        }
+        if(n > (length - count))
+        {
+            n = (BYTE)(length - count);
+        }
+        memcpy(buffer, p, n);
+        CDCRxRelease(n);
+        buffer += n;
+        count += n;
+    }
+
+    return count;
+}
+
+/******************************************************************************
+  Function:
+    static void CDCRxRingInit(void)
+
+  Summary:
+    Empties the CDC RX ring and arms the first slots.
+ *****************************************************************************/
+static void CDCRxRingInit(void)
+{
+    BYTE i;
+
+    for(i = 0; i < USB_CDC_RX_RING_PACKETS; i++)
+    {
+        cdcRxLen[i] = 0;
+        cdcRxHandle[i] = NULL;
+    }
+    cdcRxTail = 0;
+    cdcRxDone = 0;
+    cdcRxArm = 0;
+    cdcRxPending = 0;
+    cdcRxReady = 0;
+    cdcRxPos = 0;
+
+    CDCRxRingService();
+}
+
+/******************************************************************************
+  Function:
+    static void CDCRxRingAdvance(BYTE length)
+
+  Summary:
+    Advances past length bytes of the tail slot, and arms the slot again
+    once it is read completely.  Must be called with the USB interrupts
+    masked.
+ *****************************************************************************/
+static void CDCRxRingAdvance(BYTE length)
+{
+    if(cdcRxReady != 0)
+    {
+        cdcRxPos += length;
+        if(cdcRxPos >= cdcRxLen[cdcRxTail])
+        {
+            cdcRxPos = 0;
+            cdcRxTail = (cdcRxTail + 1) % USB_CDC_RX_RING_PACKETS;
+            cdcRxReady--;
+            CDCRxRingService();
+        }
+    }
+}
+
+/******************************************************************************
+  Function:
+    static void CDCRxRingService(void)
+
+  Summary:
+    Records the length of the packets received since the last call, in
+    the order they were armed, then arms free slots on the even and odd
+    BDTs.  The length has to be recorded first, because the BDT of a
+    received slot is reused for a later slot.  Must be called with the USB
+    interrupts masked.
+ *****************************************************************************/
+static void CDCRxRingService(void)
+{
+    while((cdcRxPending != 0) && !USBHandleBusy(cdcRxHandle[cdcRxDone]))
+    {
+        if(cdcRxHandle[cdcRxDone] == NULL)
+        {
+            cdcRxLen[cdcRxDone] = 0;
+        }
+        else
+        {
+            cdcRxLen[cdcRxDone] = USBHandleGetLength(cdcRxHandle[cdcRxDone]);
+        }
+        cdcRxDone = (cdcRxDone + 1) % USB_CDC_RX_RING_PACKETS;
+        cdcRxPending--;
+        cdcRxReady++;
+    }
+
+    while(((cdcRxPending + cdcRxReady) < USB_CDC_RX_RING_PACKETS) &&
+          !USBHandleBusy(USBGetNextHandle(CDC_DATA_EP, OUT_FROM_HOST)))
+    {
+        cdcRxHandle[cdcRxArm] = USBRxOnePacket(CDC_DATA_EP, (BYTE*)&cdc_rx_ring[cdcRxArm][0], CDC_DATA_OUT_EP_SIZE);
+        CDCDataOutHandle = cdcRxHandle[cdcRxArm];
+        cdcRxArm = (cdcRxArm + 1) % USB_CDC_RX_RING_PACKETS;
+        cdcRxPending++;
+    }
+}
+#endif //USB_CDC_RX_RING_PACKETS
+
 /************************************************************************
   Function:
         void CDCTxService(void)
@@ -954,13 +1670,52 @@ void putrsUSBUSART(const ROM char *data)
  
 void CDCTxService(void)
 {
+    #if !defined(USB_CDC_TX_RING_PACKETS)
     BYTE byte_to_send;
     BYTE i;
+    #endif
     
     USBMaskInterrupts();
     
     CDCNotificationHandler();
     
+    #if defined(USB_CDC_RX_RING_PACKETS)
+        //Re-arm the slots the application released.
+        CDCRxRingService();
+    #endif
+
+    #if defined(USB_CDC_TX_RING_PACKETS)
+        CDCTxRingRelease();
+
+        //Send the partly filled slot once the endpoint has nothing else to do.
+        if((cdcTxClosed == 0) && (cdcTxLen[cdcTxHead] != 0))
+        {
+            cdcTxClosed++;
+            cdcTxHead = (cdcTxHead + 1) % USB_CDC_TX_RING_PACKETS;
+            cdcTxLen[cdcTxHead] = 0;
+        }
+
+        //Hand the closed slots to the even and odd BDTs.
+        while((cdcTxSend != cdcTxHead) && !USBHandleBusy(USBGetNextHandle(CDC_DATA_EP, IN_TO_HOST)))
+        {
+            cdcTxHandle[cdcTxSend] = USBTxOnePacket(CDC_DATA_EP, (BYTE*)&cdc_tx_ring[cdcTxSend][0], cdcTxLen[cdcTxSend]);
+            CDCDataInHandle = cdcTxHandle[cdcTxSend];
+            cdcTxZLP = (cdcTxLen[cdcTxSend] == CDC_DATA_IN_EP_SIZE);
+            cdcTxSend = (cdcTxSend + 1) % USB_CDC_TX_RING_PACKETS;
+        }
+
+        //A transfer that ends with a full packet must be terminated with a
+        //zero length packet, see USB Specification 2.0: Section 5.8.3.
+        if(cdcTxZLP && (cdcTxSend == cdcTxHead) && (cdcTxLen[cdcTxHead] == 0) &&
+           !USBHandleBusy(USBGetNextHandle(CDC_DATA_EP, IN_TO_HOST)))
+        {
+            CDCDataInHandle = USBTxOnePacket(CDC_DATA_EP, NULL, 0);
+            cdcTxZLP = FALSE;
+        }
+
+        CDCTxRingUpdateState();
+    #else
+
     if(USBHandleBusy(CDCDataInHandle)) 
     {
         USBUnmaskInterrupts();
@@ -1046,6 +1801,7 @@ void CDCTxService(void)
         CDCDataInHandle = USBTxOnePacket(CDC_DATA_EP,(BYTE*)&cdc_data_tx,byte_to_send);
 
     }//end if(cdc_tx_sate == CDC_TX_BUSY)
+    #endif //USB_CDC_TX_RING_PACKETS
     
     USBUnmaskInterrupts();
 }//end CDCTxService
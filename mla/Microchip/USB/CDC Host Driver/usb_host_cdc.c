@@ -76,6 +76,13 @@ ADG          15-Sep-2008 First release
  v2.9         Fixed bug with sending SET_CONTROL_LINE_STATE command to device.
               The bit map settings were being sent as data stage bytes, rather
 			  than as the wValue of the SETUP packet.
+ v2.9j        Added the IN stream, enabled with USB_HOST_CDC_STREAM_BUFFER_SIZE.
+              A read is kept armed on the data IN endpoint, alternating
+              between two buffers, and the data is moved into a ring buffer
+              supplied by the application.
+              Added USBHostCDCTransferIsCompleteEx(), which returns a WORD
+              byte count, so transfers of more than 255 bytes can be
+              completed.
 ********************************************************************************/
 
 
@@ -222,6 +229,9 @@ Currently this must be set to 1, due to limitations in the USB Host layer.
 //******************************************************************************
 void _USBHostCDC_ResetStateJump( BYTE i );
 void USBHostCDC_Init_CDC_Buffers(void);
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+void _USBHostCDC_StreamTasks( BYTE i );
+#endif
 
 //******************************************************************************
 //******************************************************************************
@@ -260,6 +270,11 @@ USB_CDC_DEVICE_INFO           deviceInfoCDC[USB_MAX_CDC_DEVICES] __attribute__ (
 
 BYTE CDCdeviceAddress = 0; // Holds address of the attached device
 
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+    // The two buffers the IN stream reads into, in turn.
+    BYTE cdcStreamBuffer[USB_MAX_CDC_DEVICES][2][USB_HOST_CDC_STREAM_BUFFER_SIZE] __attribute__ ((aligned));
+#endif
+
 //******************************************************************************
 //******************************************************************************
 // Section: CDC Host External Variables
@@ -896,6 +911,13 @@ void USBHostCDCTasks( void )
                 break;
 
         }
+
+        #if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+            if ((deviceInfoCDC[i].state & STATE_MASK) == STATE_RUNNING)
+            {
+                _USBHostCDC_StreamTasks( i );
+            }
+        #endif
     }
 #endif
 }
@@ -957,6 +979,15 @@ BYTE USBHostCDCTransfer( BYTE deviceAddress,BYTE request , BYTE direction, BYTE
         {
             return USB_CDC_DEVICE_BUSY;
         }
+
+    #if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+        // The data IN endpoint belongs to the stream while it is running.
+        if (direction && deviceInfoCDC[i].stream.flags.bfActive &&
+            (endpointDATA == deviceInfoCDC[i].dataInterface.endpointIN))
+        {
+            return USB_CDC_DEVICE_BUSY;
+        }
+    #endif
      
     // Initialize the transfer information.
     deviceInfoCDC[i].bytesTransferred  = 0;
@@ -1032,8 +1063,8 @@ BYTE USBHostCDCTransfer( BYTE deviceAddress,BYTE request , BYTE direction, BYTE
 }
 /*******************************************************************************
   Function:
-    BOOL USBHostCDCTransferIsComplete( BYTE deviceAddress,
-                        BYTE *errorCode, DWORD *byteCount )
+    BOOL USBHostCDCTransferIsCompleteEx( BYTE deviceAddress,
+                        BYTE *errorCode, WORD *byteCount )
 
   Summary:
     This function indicates whether or not the last transfer is complete.
@@ -1051,14 +1082,14 @@ BYTE USBHostCDCTransfer( BYTE deviceAddress,BYTE request , BYTE direction, BYTE
   Parameters:
     BYTE deviceAddress  - Device address
     BYTE *errorCode     - Error code from last transfer
-    DWORD *byteCount    - Number of bytes transferred
+    WORD *byteCount     - Number of bytes transferred
 
   Return Values:
     TRUE    - Transfer is complete, errorCode is valid
     FALSE   - Transfer is not complete, errorCode is not valid
 *******************************************************************************/
 
-BOOL USBHostCDCTransferIsComplete( BYTE deviceAddress, BYTE *errorCode, BYTE *byteCount )
+BOOL USBHostCDCTransferIsCompleteEx( BYTE deviceAddress, BYTE *errorCode, WORD *byteCount )
 {
     BYTE    i;
 
@@ -1088,6 +1119,286 @@ BOOL USBHostCDCTransferIsComplete( BYTE deviceAddress, BYTE *errorCode, BYTE *by
                 }
 }
 
+/*******************************************************************************
+  Function:
+    BOOL USBHostCDCTransferIsComplete( BYTE deviceAddress,
+                        BYTE *errorCode, BYTE *byteCount )
+
+  Summary:
+    This function indicates whether or not the last transfer is complete.
+
+  Description:
+    This function calls USBHostCDCTransferIsCompleteEx() and returns the
+    low byte of the byte count, for applications written for the BYTE
+    count of earlier versions.
+
+  Precondition:
+    None
+
+  Parameters:
+    BYTE deviceAddress  - Device address
+    BYTE *errorCode     - Error code from last transfer
+    BYTE *byteCount     - Number of bytes transferred
+
+  Return Values:
+    TRUE    - Transfer is complete, errorCode is valid
+    FALSE   - Transfer is not complete, errorCode is not valid
+*******************************************************************************/
+
+BOOL USBHostCDCTransferIsComplete( BYTE deviceAddress, BYTE *errorCode, BYTE *byteCount )
+{
+    WORD    count;
+    BOOL    complete;
+
+    complete = USBHostCDCTransferIsCompleteEx( deviceAddress, errorCode, &count );
+    *byteCount = (BYTE)count;
+    return complete;
+}
+
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+/*******************************************************************************
+  Function:
+    BYTE USBHostCDCStreamStart( BYTE deviceAddress, BYTE *ring, WORD ringSize )
+
+  Summary:
+    This function starts streaming the data IN endpoint into a ring buffer.
+
+  Description:
+    This function starts streaming the data IN endpoint into a ring buffer.
+    A read is kept armed on the endpoint, alternating between two buffers of
+    USB_HOST_CDC_STREAM_BUFFER_SIZE bytes, so the device is polled while the
+    application handles the data that was already received.  Each time data
+    is added to the ring, the application event handler receives
+    EVENT_CDC_STREAM_DATA with the number of bytes added as the size.  The
+    data is read from the ring with USBHostCDCStreamRead().
+
+  Precondition:
+    The device is running.
+
+  Parameters:
+    BYTE deviceAddress  - Device address
+    BYTE *ring          - Ring buffer for the received data
+    WORD ringSize       - Size of the ring buffer
+
+  Return Values:
+    USB_SUCCESS                 - Streaming started
+    USB_CDC_DEVICE_NOT_FOUND    - No device with specified address
+    USB_CDC_DEVICE_BUSY         - A read is in progress on the data interface
+    USB_CDC_ILLEGAL_REQUEST     - The ring buffer is not valid
+
+  Remarks:
+    While the stream is running, the data IN endpoint cannot be read with
+    USBHostCDCRead_DATA().  Writes and communication interface requests can
+    still be performed.  If the ring is full, the received data is held in
+    the two buffers and no more reads are started, so the device NAKs until
+    the application reads from the ring.  No data is lost.
+*******************************************************************************/
+BYTE USBHostCDCStreamStart( BYTE deviceAddress, BYTE *ring, WORD ringSize )
+{
+    BYTE    i;
+
+    // Find the correct device.
+    for (i=0; (i<USB_MAX_CDC_DEVICES) && (deviceInfoCDC[i].deviceAddress != deviceAddress); i++);
+    if ((i == USB_MAX_CDC_DEVICES) || (deviceInfoCDC[i].state == STATE_DETACHED))
+    {
+        return USB_CDC_DEVICE_NOT_FOUND;
+    }
+
+    if ((ring == NULL) || (ringSize == 0))
+    {
+        return USB_CDC_ILLEGAL_REQUEST;
+    }
+
+    // A read of the data interface must not be in progress.
+    #ifndef USB_ENABLE_TRANSFER_EVENT
+        if ((deviceInfoCDC[i].state == (STATE_RUNNING | SUBSTATE_SEND_READ_REQ)) ||
+            (deviceInfoCDC[i].state == (STATE_RUNNING | SUBSTATE_READ_REQ_WAIT)))
+    #else
+        if (deviceInfoCDC[i].state == STATE_READ_REQ_WAIT)
+    #endif
+        {
+            if (deviceInfoCDC[i].endpointDATA == deviceInfoCDC[i].dataInterface.endpointIN)
+            {
+                return USB_CDC_DEVICE_BUSY;
+            }
+        }
+
+    deviceInfoCDC[i].stream.ring            = ring;
+    deviceInfoCDC[i].stream.ringSize        = ringSize;
+    deviceInfoCDC[i].stream.ringHead        = 0;
+    deviceInfoCDC[i].stream.ringTail        = 0;
+    deviceInfoCDC[i].stream.ringCount       = 0;
+    deviceInfoCDC[i].stream.bufferCount[0]  = 0;
+    deviceInfoCDC[i].stream.bufferCount[1]  = 0;
+    deviceInfoCDC[i].stream.bufferOffset    = 0;
+    deviceInfoCDC[i].stream.bufferArmed     = 1;
+    deviceInfoCDC[i].stream.bufferDrain     = 0;
+    deviceInfoCDC[i].stream.errorCode       = USB_SUCCESS;
+    deviceInfoCDC[i].stream.flags.val       = 0;
+    deviceInfoCDC[i].stream.flags.bfActive  = 1;
+
+    USBHostClearEndpointErrors( deviceInfoCDC[i].deviceAddress, deviceInfoCDC[i].dataInterface.endpointIN );
+    _USBHostCDC_StreamTasks( i );
+
+    return USB_SUCCESS;
+}
+
+/*******************************************************************************
+  Function:
+    void USBHostCDCStreamStop( BYTE deviceAddress )
+
+  Summary:
+    This function stops streaming the data IN endpoint.
+
+  Description:
+    This function stops streaming the data IN endpoint.  The read in
+    progress is terminated.  Data already in the ring can still be read
+    with USBHostCDCStreamRead().
+
+  Precondition:
+    None
+
+  Parameters:
+    BYTE deviceAddress  - Device address
+
+  Returns:
+    None
+
+  Remarks:
+    Data held in the two stream buffers is discarded.
+*******************************************************************************/
+void USBHostCDCStreamStop( BYTE deviceAddress )
+{
+    BYTE    i;
+
+    // Find the correct device.
+    for (i=0; (i<USB_MAX_CDC_DEVICES) && (deviceInfoCDC[i].deviceAddress != deviceAddress); i++);
+    if (i == USB_MAX_CDC_DEVICES)
+    {
+        return;
+    }
+
+    if (deviceInfoCDC[i].stream.flags.bfArmed)
+    {
+        USBHostTerminateTransfer( deviceInfoCDC[i].deviceAddress, deviceInfoCDC[i].dataInterface.endpointIN );
+    }
+    deviceInfoCDC[i].stream.flags.bfArmed   = 0;
+    deviceInfoCDC[i].stream.flags.bfActive  = 0;
+}
+
+/*******************************************************************************
+  Function:
+    WORD USBHostCDCStreamRead( BYTE deviceAddress, BYTE *data, WORD size )
+
+  Summary:
+    This function reads data received by the IN stream.
+
+  Description:
+    This function copies up to size bytes out of the ring buffer of the IN
+    stream.  If the stream was waiting for room in the ring, the held data
+    is moved into the ring and the next read is started.
+
+  Precondition:
+    USBHostCDCStreamStart() has been called.
+
+  Parameters:
+    BYTE deviceAddress  - Device address
+    BYTE *data          - Buffer for the data
+    WORD size           - Size of the buffer
+
+  Returns:
+    The number of bytes copied.
+
+  Remarks:
+    This function can be called from the application event handler when it
+    receives EVENT_CDC_STREAM_DATA.
+*******************************************************************************/
+WORD USBHostCDCStreamRead( BYTE deviceAddress, BYTE *data, WORD size )
+{
+    USB_CDC_STREAM_INFO *stream;
+    WORD    count;
+    WORD    length;
+    BYTE    i;
+
+    // Find the correct device.
+    for (i=0; (i<USB_MAX_CDC_DEVICES) && (deviceInfoCDC[i].deviceAddress != deviceAddress); i++);
+    if (i == USB_MAX_CDC_DEVICES)
+    {
+        return 0;
+    }
+    stream = &deviceInfoCDC[i].stream;
+
+    if (size > stream->ringCount)
+    {
+        size = stream->ringCount;
+    }
+
+    // Copy in at most two pieces, up to the end of the ring and from the start.
+    count = 0;
+    while (count < size)
+    {
+        length = stream->ringSize - stream->ringTail;
+        if (length > (size - count))
+        {
+            length = size - count;
+        }
+        memcpy( &data[count], &stream->ring[stream->ringTail], length );
+        count               += length;
+        stream->ringTail    += length;
+        if (stream->ringTail == stream->ringSize)
+        {
+            stream->ringTail = 0;
+        }
+    }
+    stream->ringCount -= count;
+
+    // Move any held data into the room we just made.
+    if (count && stream->flags.bfActive)
+    {
+        _USBHostCDC_StreamTasks( i );
+    }
+
+    return count;
+}
+
+/*******************************************************************************
+  Function:
+    WORD USBHostCDCStreamCount( BYTE deviceAddress )
+
+  Summary:
+    This function returns the number of bytes in the IN stream ring.
+
+  Description:
+    This function returns the number of bytes in the ring buffer of the IN
+    stream that can be read with USBHostCDCStreamRead().
+
+  Precondition:
+    None
+
+  Parameters:
+    BYTE deviceAddress  - Device address
+
+  Returns:
+    The number of bytes in the ring.
+
+  Remarks:
+    None
+*******************************************************************************/
+WORD USBHostCDCStreamCount( BYTE deviceAddress )
+{
+    BYTE    i;
+
+    // Find the correct device.
+    for (i=0; (i<USB_MAX_CDC_DEVICES) && (deviceInfoCDC[i].deviceAddress != deviceAddress); i++);
+    if (i == USB_MAX_CDC_DEVICES)
+    {
+        return 0;
+    }
+
+    return deviceInfoCDC[i].stream.ringCount;
+}
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Host Stack Interface Functions
@@ -1148,6 +1459,9 @@ BOOL USBHostCDCEventHandler( BYTE address, USB_EVENT event, void *data, DWORD si
             for (i=0; (i<USB_MAX_CDC_DEVICES) && (deviceInfoCDC[i].deviceAddress != address); i++);
             if (i < USB_MAX_CDC_DEVICES)
             {
+                #if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+                    deviceInfoCDC[i].stream.flags.val = 0;
+                #endif
                 deviceInfoCDC[i].deviceAddress    = 0;
                 deviceInfoCDC[i].state            = STATE_DETACHED;
                 CDCdeviceAddress = 0;
@@ -1175,6 +1489,14 @@ BOOL USBHostCDCEventHandler( BYTE address, USB_EVENT event, void *data, DWORD si
                     #endif
                     return FALSE;
                 }
+                #if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+                    if ((event == EVENT_TRANSFER) && deviceInfoCDC[i].stream.flags.bfActive &&
+                        (transfer_data->bEndpointAddress == deviceInfoCDC[i].dataInterface.endpointIN))
+                    {
+                        _USBHostCDC_StreamTasks( i );
+                        return TRUE;
+                    }
+                #endif
                 #ifdef DEBUG_MODE
                     UART2PrintString( "CDC: Device state: " );
                     UART2PutHex( deviceInfoCDC[i].state );
@@ -1364,6 +1686,14 @@ BOOL USBHostCDCEventHandler( BYTE address, USB_EVENT event, void *data, DWORD si
             for (i=0; (i<USB_MAX_CDC_DEVICES) && (deviceInfoCDC[i].deviceAddress != address); i++);
             if (i < USB_MAX_CDC_DEVICES)
             {
+                #if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE) && defined(USB_ENABLE_TRANSFER_EVENT)
+                    if (deviceInfoCDC[i].stream.flags.bfActive &&
+                        (transfer_data->bEndpointAddress == deviceInfoCDC[i].dataInterface.endpointIN))
+                    {
+                        _USBHostCDC_StreamTasks( i );
+                        return TRUE;
+                    }
+                #endif
                 if(transfer_data->bErrorCode == USB_ENDPOINT_NAK_TIMEOUT)
                 {
                     USB_HOST_APP_EVENT_HANDLER(deviceInfoCDC[i].deviceAddress,EVENT_CDC_NAK_TIMEOUT,NULL, 0);
@@ -1615,6 +1945,9 @@ BOOL USBHostCDCInitialize( BYTE address, DWORD flags, BYTE clientDriverID )
         }
 
         deviceInfoCDC[device].clientDriverID = clientDriverID;
+        #if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+            deviceInfoCDC[device].stream.flags.val = 0;
+        #endif
 
         #ifndef USB_ENABLE_TRANSFER_EVENT
            deviceInfoCDC[device].state                = STATE_INITIALIZE_DEVICE;
@@ -1696,6 +2029,147 @@ void _USBHostCDC_ResetStateJump( BYTE i )
 }
 
 
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+/*******************************************************************************
+  Function:
+    void _USBHostCDC_StreamTasks( BYTE i )
+
+  Summary:
+    This function keeps the IN stream running.
+
+  Description:
+    This function checks the read armed on the data IN endpoint.  When it is
+    complete, the next read is started on the other buffer right away,
+    before the received data is moved into the ring, so the device is polled
+    again as soon as possible.  A buffer is only read into again once all of
+    its data is in the ring.  The application is notified with
+    EVENT_CDC_STREAM_DATA when data is added to the ring, or with
+    EVENT_CDC_STREAM_ERROR if the stream stops because of an error.
+
+  Precondition:
+    The device information must be in the deviceInfo array.
+
+  Parameters:
+    BYTE i  - Index into the deviceInfoCDC structure for the device.
+
+  Returns:
+    None
+
+  Remarks:
+    A NAK timeout does not stop the stream.  The data received before the
+    timeout is kept, and the read is started again.
+*******************************************************************************/
+void _USBHostCDC_StreamTasks( BYTE i )
+{
+    USB_CDC_STREAM_INFO *stream;
+    DWORD   byteCount;
+    WORD    added;
+    WORD    length;
+    BYTE    errorCode;
+    BYTE    b;
+
+    stream = &deviceInfoCDC[i].stream;
+    if (!stream->flags.bfActive || stream->flags.bfBusy)
+    {
+        return;
+    }
+    stream->flags.bfBusy = 1;
+
+    // Collect the read that completed.
+    if (stream->flags.bfArmed &&
+        USBHostTransferIsComplete( deviceInfoCDC[i].deviceAddress, deviceInfoCDC[i].dataInterface.endpointIN, &errorCode, &byteCount ))
+    {
+        stream->flags.bfArmed = 0;
+        if ((errorCode != USB_SUCCESS) && (errorCode != USB_ENDPOINT_NAK_TIMEOUT))
+        {
+            USBHostClearEndpointErrors( deviceInfoCDC[i].deviceAddress, deviceInfoCDC[i].dataInterface.endpointIN );
+            stream->errorCode       = errorCode;
+            stream->flags.bfActive  = 0;
+            stream->flags.bfBusy    = 0;
+            USB_HOST_APP_EVENT_HANDLER(deviceInfoCDC[i].deviceAddress,EVENT_CDC_STREAM_ERROR,NULL, errorCode);
+            return;
+        }
+        if (errorCode == USB_ENDPOINT_NAK_TIMEOUT)
+        {
+            USBHostClearEndpointErrors( deviceInfoCDC[i].deviceAddress, deviceInfoCDC[i].dataInterface.endpointIN );
+        }
+        if (byteCount)
+        {
+            b = stream->bufferArmed;
+            stream->bufferCount[b] = byteCount;
+            if (stream->bufferCount[b ^ 1] == 0)
+            {
+                stream->bufferDrain = b;
+            }
+        }
+    }
+
+    added = 0;
+    for (b=0; b<2; b++)
+    {
+        // Start the next read on an empty buffer, the other one first.
+        if (!stream->flags.bfArmed)
+        {
+            if (stream->bufferCount[stream->bufferArmed ^ 1] == 0)
+            {
+                stream->bufferArmed ^= 1;
+            }
+            if (stream->bufferCount[stream->bufferArmed] == 0)
+            {
+                if (!USBHostRead( deviceInfoCDC[i].deviceAddress, deviceInfoCDC[i].dataInterface.endpointIN,
+                                  cdcStreamBuffer[i][stream->bufferArmed], USB_HOST_CDC_STREAM_BUFFER_SIZE ))
+                {
+                    stream->flags.bfArmed = 1;
+                }
+            }
+        }
+
+        // Move the oldest received data into the ring, as much as fits.
+        while ((stream->bufferCount[stream->bufferDrain] != 0) && (stream->ringCount < stream->ringSize))
+        {
+            length = stream->bufferCount[stream->bufferDrain] - stream->bufferOffset;
+            if (length > (stream->ringSize - stream->ringCount))
+            {
+                length = stream->ringSize - stream->ringCount;
+            }
+            if (length > (stream->ringSize - stream->ringHead))
+            {
+                length = stream->ringSize - stream->ringHead;
+            }
+            memcpy( &stream->ring[stream->ringHead], &cdcStreamBuffer[i][stream->bufferDrain][stream->bufferOffset], length );
+            stream->ringHead     += length;
+            if (stream->ringHead == stream->ringSize)
+            {
+                stream->ringHead = 0;
+            }
+            stream->ringCount    += length;
+            stream->bufferOffset += length;
+            added                += length;
+
+            if (stream->bufferOffset == stream->bufferCount[stream->bufferDrain])
+            {
+                stream->bufferCount[stream->bufferDrain] = 0;
+                stream->bufferOffset = 0;
+                stream->bufferDrain ^= 1;
+            }
+        }
+
+        // Done unless draining freed the buffer the next read is waiting for.
+        if (stream->flags.bfArmed)
+        {
+            break;
+        }
+    }
+
+    stream->flags.bfBusy = 0;
+    if (added)
+    {
+        USB_HOST_APP_EVENT_HANDLER(deviceInfoCDC[i].deviceAddress,EVENT_CDC_STREAM_DATA,NULL, added);
+    }
+}
+#endif
+
+
 
 /*******************************************************************************
   Function:
@@ -56,6 +56,9 @@ ADG          15-Sep-2008 First release
               not fully comply with CDC specifications
               Modified API USBHostCDC_Api_Send_OUT_Data to allow data transfers
               more than 256 bytes
+ v2.9j        Modified API USBHostCDC_Api_Get_IN_Data and added API
+              USBHostCDC_ApiTransferIsCompleteEx to allow data transfers more
+              than 256 bytes.  Added the IN stream APIs.
 ********************************************************************************/
 #include <stdlib.h>
 #include <string.h>
@@ -117,7 +120,7 @@ extern BYTE CDCdeviceAddress ;
 
 /****************************************************************************
   Function:
-    BOOL USBHostCDC_Api_Get_IN_Data(BYTE no_of_bytes, BYTE* data)
+    BOOL USBHostCDC_Api_Get_IN_Data(WORD no_of_bytes, BYTE* data)
 
   Description:
     This function is called by application to receive Input data over DATA 
@@ -127,7 +130,7 @@ extern BYTE CDCdeviceAddress ;
     None
 
   Parameters:
-    BYTE    no_of_bytes - No. of Bytes expected from the device.
+    WORD    no_of_bytes - No. of Bytes expected from the device.
     BYTE*   data        - Pointer to application receive data buffer.
 
   Return Values:
@@ -137,7 +140,7 @@ extern BYTE CDCdeviceAddress ;
   Remarks:
     None
 ***************************************************************************/
-BOOL USBHostCDC_Api_Get_IN_Data(BYTE no_of_bytes, BYTE* data)
+BOOL USBHostCDC_Api_Get_IN_Data(WORD no_of_bytes, BYTE* data)
 {
     BYTE    i;
 
@@ -165,7 +168,7 @@ BOOL USBHostCDC_Api_Get_IN_Data(BYTE no_of_bytes, BYTE* data)
     None
 
   Parameters:
-    BYTE    no_of_bytes - No. of Bytes expected from the device.
+    WORD    no_of_bytes - No. of Bytes expected from the device.
     BYTE*   data        - Pointer to application transmit data buffer.
 
 
@@ -214,13 +217,43 @@ BOOL USBHostCDC_Api_Send_OUT_Data(WORD no_of_bytes, BYTE* data)
     FALSE   -   Transfer is pending.
 
   Remarks:
-    None
+    Only the low byte of the byte count is returned.
 ***************************************************************************/
 BOOL USBHostCDC_ApiTransferIsComplete(BYTE* errorCodeDriver, BYTE* byteCount )
 {       
     return(USBHostCDCTransferIsComplete(CDCdeviceAddress,errorCodeDriver,byteCount));
 }
 
+
+/****************************************************************************
+  Function:
+    BOOL USBHostCDC_ApiTransferIsCompleteEx(BYTE* errorCodeDriver,WORD* byteCount)
+
+  Description:
+    This function is called by application to poll for transfer status. It
+    is the same as USBHostCDC_ApiTransferIsComplete, but returns the full
+    byte count of transfers of more than 255 bytes.
+
+  Precondition:
+    None
+
+  Parameters:
+    BYTE    *errorCodeDriver - returns.
+    WORD    *byteCount       - No. of bytes transferred.
+
+
+  Return Values:
+    TRUE    -   Transfer is has completed.
+    FALSE   -   Transfer is pending.
+
+  Remarks:
+    None
+***************************************************************************/
+BOOL USBHostCDC_ApiTransferIsCompleteEx(BYTE* errorCodeDriver, WORD* byteCount )
+{       
+    return(USBHostCDCTransferIsCompleteEx(CDCdeviceAddress,errorCodeDriver,byteCount));
+}
+
 /*******************************************************************************
   Function:
     BOOL USBHostCDC_ApiDeviceDetect( void )
@@ -351,3 +384,90 @@ BYTE USBHostCDC_Api_ACM_Request(BYTE requestType, BYTE size, BYTE* data)
     }
     return return_val;
 }
+
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+/****************************************************************************
+  Function:
+    BOOL USBHostCDC_Api_Stream_Start(BYTE* ring, WORD ringSize)
+
+  Description:
+    This function is called by application to start receiving Input data over
+    DATA interface continuously.  The data is stored in the ring buffer, and
+    EVENT_CDC_STREAM_DATA is sent to the application each time data is added.
+
+  Precondition:
+    Device must be enumerated and attached successfully.
+
+  Parameters:
+    BYTE*   ring        - Pointer to application ring buffer.
+    WORD    ringSize    - Size of the ring buffer.
+
+  Return Values:
+    TRUE    -   Streaming is started.
+    FALSE   -   Streaming could not be started.
+
+  Remarks:
+    See USBHostCDCStreamStart().
+***************************************************************************/
+BOOL USBHostCDC_Api_Stream_Start(BYTE* ring, WORD ringSize)
+{
+    if(!USBHostCDCStreamStart(CDCdeviceAddress, ring, ringSize))
+    {
+        return TRUE;
+    }
+    return FALSE;
+}
+
+
+/****************************************************************************
+  Function:
+    void USBHostCDC_Api_Stream_Stop(void)
+
+  Description:
+    This function is called by application to stop receiving Input data over
+    DATA interface continuously.
+
+  Precondition:
+    None
+
+  Parameters:
+    None
+
+  Return Values:
+    None
+
+  Remarks:
+    None
+***************************************************************************/
+void USBHostCDC_Api_Stream_Stop(void)
+{
+    USBHostCDCStreamStop(CDCdeviceAddress);
+}
+
+
+/****************************************************************************
+  Function:
+    WORD USBHostCDC_Api_Stream_Read(WORD no_of_bytes, BYTE* data)
+
+  Description:
+    This function is called by application to read the Input data received
+    since streaming was started.
+
+  Precondition:
+    None
+
+  Parameters:
+    WORD    no_of_bytes - Size of application receive data buffer.
+    BYTE*   data        - Pointer to application receive data buffer.
+
+  Return Values:
+    Number of bytes copied to the application buffer.
+
+  Remarks:
+    None
+***************************************************************************/
+WORD USBHostCDC_Api_Stream_Read(WORD no_of_bytes, BYTE* data)
+{
+    return(USBHostCDCStreamRead(CDCdeviceAddress, data, no_of_bytes));
+}
+#endif
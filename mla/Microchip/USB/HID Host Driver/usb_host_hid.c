@@ -86,6 +86,9 @@ ADG          9-Apr-2008 First release
             Fixed Issue with heap not freeing up for the variable 
             allocated in other file. 'parsedDataMem' needs to be freed in
             the file 'usb_host_hid_parser.c'.
+  2.9j      Added report decoders.  The data fields of a report can be
+            compiled into a list of extraction operations once, and
+            then extracted from each report in one pass.
 ********************************************************************/
 
 #include <stdlib.h>
@@ -1616,6 +1619,228 @@ BOOL USBHostHID_ApiImportData(BYTE *report, WORD reportLength, HID_USER_DATA_SIZ
 }
 
 
+/*******************************************************************************
+  Function:
+    BOOL USBHostHID_ApiCompileData(HID_REPORT_DECODER *pDecoder,
+                     HID_DATA_DETAILS *pDataDetails, BYTE slot)
+
+  Description:
+    This function adds the data described by 'HID_DATA_DETAILS' to a report
+    decoder.  Each of the pDataDetails->count fields gets one extraction
+    operation, and is written to buffer entries slot, slot+1, and so on by
+    USBHostHID_ApiDecodeReport().
+
+  Precondition:
+    The decoder has been initialized with USBHostHID_ApiDecoderInit().
+
+  Parameters:
+    HID_REPORT_DECODER *pDecoder    - Decoder to add the data to
+    HID_DATA_DETAILS *pDataDetails  - data details extracted from report
+                                      descriptor
+    BYTE slot                       - Buffer index of the first field
+
+  Return Values:
+    TRUE    - The data was added to the decoder
+    FALSE   - The data belongs to another report, does not fit in the report
+              or in the decoder, or a field is wider than 32 bits.
+
+  Remarks:
+    All the data compiled into one decoder must come from the same report.
+*******************************************************************************/
+BOOL USBHostHID_ApiCompileData(HID_REPORT_DECODER *pDecoder, HID_DATA_DETAILS *pDataDetails, BYTE slot)
+{
+    HID_EXTRACT_OP *op;
+    WORD start;
+    BYTE i;
+
+//  The field size must be supported, and all the fields must fit
+
+    if ((pDataDetails->bitLength == 0) || (pDataDetails->bitLength > 32)) return FALSE;
+    if ((pDecoder->opCount + pDataDetails->count) > pDecoder->maxOps) return FALSE;
+    if (((WORD)pDataDetails->bitOffset + (pDataDetails->bitLength * pDataDetails->count) + 7)/8
+            > pDataDetails->reportLength) return FALSE;
+
+//  The first data sets the report, the rest must be from the same one
+
+    if (pDecoder->opCount == 0)
+    {
+        pDecoder->reportID     = pDataDetails->reportID;
+        pDecoder->reportLength = pDataDetails->reportLength;
+        pDecoder->interfaceNum = pDataDetails->interfaceNum;
+    }
+    else if ((pDecoder->reportID != pDataDetails->reportID) ||
+             (pDecoder->reportLength != pDataDetails->reportLength))
+    {
+        return FALSE;
+    }
+
+//  Work out where each field is once, so decoding is only a few shifts
+
+    start = pDataDetails->bitOffset;
+    op = &pDecoder->ops[pDecoder->opCount];
+    for (i=0; i<pDataDetails->count; i++, op++)
+    {
+        op->byteOffset = start/8;
+        op->shift      = start&7;
+        op->bytes      = (op->shift + pDataDetails->bitLength + 7)/8;
+        op->mask       = 0xFFFFFFFF >> (32 - pDataDetails->bitLength);
+        op->signExtend = pDataDetails->signExtend;
+        op->slot       = slot + i;
+
+        start += pDataDetails->bitLength;
+    }
+    pDecoder->opCount += pDataDetails->count;
+
+    return TRUE;
+}
+
+
+/*******************************************************************************
+  Function:
+    BOOL USBHostHID_ApiCompileReport(HID_REPORT_DECODER *pDecoder,
+                     HIDReportTypeEnum type, BYTE reportID)
+
+  Description:
+    This function adds every data field of a report to a report decoder, in
+    the order the fields appear in the report.  Constant (padding) fields are
+    skipped.  Fields with a negative logical minimum are sign extended.
+
+  Precondition:
+    The report descriptor has been parsed, and the decoder has been
+    initialized with USBHostHID_ApiDecoderInit().
+
+  Parameters:
+    HID_REPORT_DECODER *pDecoder    - Decoder to add the fields to
+    HIDReportTypeEnum type          - report type Input/Output/Feature
+    BYTE reportID                   - report ID, or 0 if the device does not
+                                      use report IDs
+
+  Return Values:
+    TRUE    - All the data fields of the report were added to the decoder
+    FALSE   - The report was not found, or it does not fit in the decoder.
+
+  Remarks:
+    The fields are written to consecutive buffer entries, starting after the
+    ones already compiled into the decoder.
+*******************************************************************************/
+BOOL USBHostHID_ApiCompileReport(HID_REPORT_DECODER *pDecoder, HIDReportTypeEnum type, BYTE reportID)
+{
+    HID_DATA_DETAILS details;
+    HID_REPORTITEM *reportItem;
+    HID_REPORT *report;
+    WORD bits;
+    BYTE iR;
+    BOOL found;
+
+    found = FALSE;
+    for (iR=0; iR < deviceRptInfo.reportItems; iR++)
+    {
+        reportItem = &itemListPtrs.reportItemList[iR];
+        report = &itemListPtrs.reportList[reportItem->globals.reportIndex];
+
+//      Search only data items of the requested report
+
+        if ((reportItem->reportType != type) || (report->reportID != reportID)) continue;
+        if ((reportItem->dataModes & HIDData_ConstantBit) == HIDData_Constant) continue;
+
+        if (type == hidReportInput)
+            bits = report->inputBits;
+        else if (type == hidReportOutput)
+            bits = report->outputBits;
+        else
+            bits = report->featureBits;
+
+        details.reportLength = (bits + 7)/8;
+        details.reportID     = reportID;
+        details.bitOffset    = reportItem->startBit;
+        details.bitLength    = reportItem->globals.reportsize;
+        details.count        = reportItem->globals.reportCount;
+        details.signExtend   = (reportItem->globals.logicalMinimum < 0);
+        details.interfaceNum = deviceRptInfo.interfaceNumber;
+
+        if (!USBHostHID_ApiCompileData(pDecoder, &details, pDecoder->opCount)) return FALSE;
+        found = TRUE;
+    }
+    return found;
+}
+
+
+/*******************************************************************************
+  Function:
+    BOOL USBHostHID_ApiDecodeReport(BYTE *report, WORD reportLength,
+                     HID_USER_DATA_SIZE *buffer, HID_REPORT_DECODER *pDecoder)
+
+  Description:
+    This function extracts all the data fields compiled into a report decoder
+    from a report, in one pass.  It can be used instead of calling
+    USBHostHID_ApiImportData() for each 'HID_DATA_DETAILS' of the report.
+
+  Precondition:
+    The decoder has been compiled with USBHostHID_ApiCompileData() or
+    USBHostHID_ApiCompileReport().
+
+  Parameters:
+    BYTE *report                    - Report received from device
+    WORD reportLength               - Length of the report
+    HID_USER_DATA_SIZE *buffer      - Buffer into which data needs to be
+                                      populated
+    HID_REPORT_DECODER *pDecoder    - Compiled decoder of the report
+
+  Return Values:
+    TRUE    - If the data is retrieved from the report
+    FALSE   - If the report does not match the decoder.
+
+  Remarks:
+    None
+*******************************************************************************/
+BOOL USBHostHID_ApiDecodeReport(BYTE *report, WORD reportLength, HID_USER_DATA_SIZE *buffer, HID_REPORT_DECODER *pDecoder)
+{
+    HID_EXTRACT_OP *op;
+    BYTE *pData;
+    DWORD data;
+    BYTE i;
+
+//  Report must be ok, and must be the right report
+
+    if (report == NULL) return FALSE;
+    if ((pDecoder->reportID != 0) && (pDecoder->reportID != report[0])) return FALSE;
+    if (pDecoder->reportLength != reportLength) return FALSE;
+
+    op = pDecoder->ops;
+    for (i=pDecoder->opCount; i>0; i--, op++)
+    {
+
+//      Pick up only the bytes that hold the field
+
+        pData = &report[op->byteOffset];
+        data = 0;
+        switch (op->bytes)
+        {
+            case 5:
+            case 4:
+                data  = (DWORD)pData[3] << 24;
+            case 3:
+                data |= (DWORD)pData[2] << 16;
+            case 2:
+                data |= (WORD)pData[1] << 8;
+            default:
+                data |= pData[0];
+                break;
+        }
+        data >>= op->shift;
+        if (op->bytes == 5) data |= (DWORD)pData[4] << (32 - op->shift);
+
+//      Mask off the other bits, and sign extend if the top bit is set
+
+        data &= op->mask;
+        if (op->signExtend && (data & ~(op->mask >> 1))) data |= ~op->mask;
+
+        buffer[op->slot] = (HID_USER_DATA_SIZE)data;
+    }
+    return TRUE;
+}
+
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Host Stack Interface Functions
@@ -65,6 +65,13 @@ CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
 Author          Date    Comments
 --------------------------------------------------------------------------------
 TL       17-Oct-2011    Preliminary release
+         v2.9j          Added the timestamped event stream, enabled with
+                        USB_HOST_MIDI_STREAM_QUEUE_SIZE, and the coalescing
+                        write queue, enabled with USB_HOST_MIDI_WRITE_QUEUE_SIZE.
+                        USBHostMIDITransferIsComplete() passed the endpoint
+                        index to the host layer instead of the endpoint address.
+                        With transfer events, stream events are timestamped
+                        when the transfer completes in the USB interrupt.
 
 *******************************************************************************/
 //DOM-IGNORE-END
@@ -110,6 +117,21 @@ Currently this must be set to 1, due to limitations in the USB Host layer.
      
 static MIDI_DEVICE devices[USB_MAX_MIDI_DEVICES];
 
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Prototypes
+// *****************************************************************************
+// *****************************************************************************
+
+#if defined(USB_HOST_MIDI_STREAM_QUEUE_SIZE)
+static void _USBHostMIDI_StreamTasks( MIDI_DEVICE *device, QWORD *pTimestamp );
+#endif
+#if defined(USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+static void _USBHostMIDI_WriteTasks( MIDI_DEVICE *device );
+static BOOL _USBHostMIDI_IsReplaceable( USB_AUDIO_MIDI_PACKET *packet );
+static BOOL _USBHostMIDI_Coalesce( MIDI_WRITE_QUEUE_INFO *queue, USB_AUDIO_MIDI_PACKET *packet );
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Host Stack Interface Functions
@@ -291,6 +313,32 @@ BOOL USBHostMIDIInit ( BYTE address, DWORD flags, BYTE clientDriverID )
         }    
         return FALSE;
     }
+
+    #if defined(USB_HOST_MIDI_STREAM_QUEUE_SIZE)
+        device->stream.active = FALSE;
+        device->stream.count = 0;
+        device->stream.head = 0;
+        device->stream.tail = 0;
+        device->stream.overruns = 0;
+    #endif
+
+    #if defined(USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+        // The write queue uses the first OUT endpoint of the interface.
+        device->writeQueue.count = 0;
+        device->writeQueue.head = 0;
+        device->writeQueue.tail = 0;
+        device->writeQueue.coalesced = 0;
+        device->writeQueue.batchLength = 0;
+        device->writeQueue.endpointIndex = 0xFF;
+        for (currentEndpoint = 0; currentEndpoint < device->numEndpoints; currentEndpoint++)
+        {
+            if (!(device->endpoints[currentEndpoint].endpointAddress & 0x80))
+            {
+                device->writeQueue.endpointIndex = currentEndpoint;
+                break;
+            }
+        }
+    #endif
     
     #ifdef DEBUG_MODE
         UART2PrintString( "USB MIDI Client Initalized: " );
@@ -365,6 +413,14 @@ BOOL USBHostMIDIEventHandler ( BYTE address, USB_EVENT event, void *data, DWORD
         case EVENT_DETACH:
             // Notify that application that the device has been detached.
             USB_HOST_APP_EVENT_HANDLER(devices[i].deviceAddress, EVENT_MIDI_DETACH, &devices[i], sizeof(MIDI_DEVICE) );
+            #if defined(USB_HOST_MIDI_STREAM_QUEUE_SIZE)
+                devices[i].stream.active = FALSE;
+            #endif
+            #if defined(USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+                devices[i].writeQueue.count = 0;
+                devices[i].writeQueue.batchLength = 0;
+                devices[i].writeQueue.endpointIndex = 0xFF;
+            #endif
             devices[i].deviceAddress = 0;
             free(devices[i].endpoints);
             devices[i].endpoints = NULL;
@@ -386,8 +442,33 @@ BOOL USBHostMIDIEventHandler ( BYTE address, USB_EVENT event, void *data, DWORD
                 {
                     if ( ((HOST_TRANSFER_DATA *)data)->bEndpointAddress == devices[i].endpoints[currentEndpoint].endpointAddress )
                     {
+                        #if defined(USB_HOST_MIDI_STREAM_QUEUE_SIZE)
+                            if (devices[i].stream.active && (currentEndpoint == devices[i].stream.endpointIndex))
+                            {
+                                #if defined( USB_HOST_TRANSFER_TIMESTAMP )
+                                    _USBHostMIDI_StreamTasks( &devices[i], &((HOST_TRANSFER_DATA *)data)->timestamp );
+                                #else
+                                    _USBHostMIDI_StreamTasks( &devices[i], NULL );
+                                #endif
+                                return TRUE;
+                            }
+                        #endif
+                        #if defined(USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+                            if (devices[i].writeQueue.batchLength && (currentEndpoint == devices[i].writeQueue.endpointIndex))
+                            {
+                                _USBHostMIDI_WriteTasks( &devices[i] );
+                                return TRUE;
+                            }
+                        #endif
                         devices[i].endpoints[currentEndpoint].busy = 0;
                         USB_HOST_APP_EVENT_HANDLER(devices[i].deviceAddress, EVENT_MIDI_TRANSFER_DONE, &devices[i].endpoints[currentEndpoint], sizeof(MIDI_ENDPOINT_DATA));
+                        #if defined(USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+                            // Send the packets queued while the application was writing.
+                            if (currentEndpoint == devices[i].writeQueue.endpointIndex)
+                            {
+                                _USBHostMIDI_WriteTasks( &devices[i] );
+                            }
+                        #endif
                         return TRUE;
                     }
                 }    
@@ -558,6 +639,14 @@ BYTE USBHostMIDIRead( void* handle, BYTE endpointIndex, void *buffer, WORD lengt
 {
     MIDI_DEVICE *device = (MIDI_DEVICE*)handle;
     BYTE RetVal;
+
+    #if defined(USB_HOST_MIDI_STREAM_QUEUE_SIZE)
+        // The endpoint belongs to the event stream while it is running.
+        if (device->stream.active && (endpointIndex == device->stream.endpointIndex))
+        {
+            return USB_ENDPOINT_BUSY;
+        }
+    #endif
     
     RetVal = USBHostRead( device->deviceAddress, device->endpoints[endpointIndex].endpointAddress, (BYTE *)buffer, length );
     
@@ -654,7 +743,7 @@ BOOL USBHostMIDITransferIsComplete(void* handle, BYTE endpointIndex, BYTE* error
 {
     MIDI_DEVICE* device = (MIDI_DEVICE*)handle;
     
-    if (USBHostTransferIsComplete(device->deviceAddress, endpointIndex, errorCode, byteCount) == TRUE)
+    if (USBHostTransferIsComplete(device->deviceAddress, device->endpoints[endpointIndex].endpointAddress, errorCode, byteCount) == TRUE)
     {
         device->endpoints[endpointIndex].busy = 0;
         return TRUE;
@@ -718,6 +807,613 @@ BYTE USBHostMIDIWrite(void* handle, BYTE endpointIndex, void *buffer, WORD lengt
 } // USBHostMIDIWrite
 
 
+#if defined(USB_HOST_MIDI_STREAM_QUEUE_SIZE) || defined(USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+// *****************************************************************************
+// *****************************************************************************
+// Section: Event Stream and Write Queue
+// *****************************************************************************
+// *****************************************************************************
+
+/****************************************************************************
+  Function:
+    void USBHostMIDITasks( void )
+
+  Summary:
+    This function performs the event stream and write queue tasks.
+
+  Description:
+    This function checks the transfers of the event stream and of the write
+    queue, and starts the next ones.
+
+  Preconditions:
+    None
+
+  Parameters:
+    None
+
+  Returns:
+    None
+
+  Remarks:
+    This function is required in polling mode.  With transfer events, the
+    transfers are handled when their events are received, and calling this
+    function is optional.  It then leaves the event stream to the events, so
+    that its packets keep the completion time of their transfer.
+  ***************************************************************************/
+
+void USBHostMIDITasks( void )
+{
+    BYTE i;
+
+    for (i = 0; i < USB_MAX_MIDI_DEVICES; i++)
+    {
+        if ((devices[i].deviceAddress == 0) || (devices[i].endpoints == NULL))
+        {
+            continue;
+        }
+
+        #if defined(USB_HOST_MIDI_STREAM_QUEUE_SIZE) && !(defined(USB_ENABLE_TRANSFER_EVENT) && defined(USB_HOST_TRANSFER_TIMESTAMP))
+            _USBHostMIDI_StreamTasks( &devices[i], NULL );
+        #endif
+        #if defined(USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+            _USBHostMIDI_WriteTasks( &devices[i] );
+        #endif
+    }
+} // USBHostMIDITasks
+#endif
+
+
+#if defined(USB_HOST_MIDI_STREAM_QUEUE_SIZE)
+/****************************************************************************
+  Function:
+    BYTE USBHostMIDIStreamStart( void* handle, BYTE endpointIndex )
+
+  Description:
+    This function starts the event stream on an IN endpoint.  Each time
+    events are added to the queue, the application event handler receives
+    EVENT_MIDI_STREAM_DATA with the number of events added as the size.
+    The events are read with USBHostMIDIStreamRead().
+
+  Preconditions:
+    The device must be connected and enumerated.
+
+  Parameters:
+    void* handle       - Pointer to a structure containing the Device Info
+    BYTE endpointIndex - Index of the IN endpoint
+
+  Return Values:
+    USB_SUCCESS             - The stream was started
+    USB_ILLEGAL_REQUEST     - The endpoint is not an IN endpoint
+    USB_ENDPOINT_BUSY       - A read is in progress on the endpoint
+    (USB error code)        - The first read was not started.  See
+                                USBHostRead() for a list of errors.
+
+  Remarks:
+    While the stream is running, the endpoint is busy and cannot be read
+    with USBHostMIDIRead().
+  ***************************************************************************/
+
+BYTE USBHostMIDIStreamStart( void* handle, BYTE endpointIndex )
+{
+    MIDI_DEVICE *device = (MIDI_DEVICE*)handle;
+    MIDI_ENDPOINT_DATA *endpoint;
+    BYTE RetVal;
+
+    if ((endpointIndex >= device->numEndpoints) || !(device->endpoints[endpointIndex].endpointAddress & 0x80))
+    {
+        return USB_ILLEGAL_REQUEST;
+    }
+    endpoint = &device->endpoints[endpointIndex];
+
+    if (device->stream.active || endpoint->busy)
+    {
+        return USB_ENDPOINT_BUSY;
+    }
+
+    device->stream.endpointIndex = endpointIndex;
+    device->stream.bufferArmed = 0;
+    device->stream.errorCode = USB_SUCCESS;
+
+    USBHostClearEndpointErrors( device->deviceAddress, endpoint->endpointAddress );
+    RetVal = USBHostRead( device->deviceAddress, endpoint->endpointAddress, device->stream.buffer[0], endpoint->endpointSize );
+    if (RetVal == USB_SUCCESS)
+    {
+        device->stream.active = TRUE;
+        endpoint->busy = TRUE;
+    }
+
+    return RetVal;
+
+} // USBHostMIDIStreamStart
+
+
+/****************************************************************************
+  Function:
+    void USBHostMIDIStreamStop( void* handle )
+
+  Description:
+    This function stops the event stream, and terminates the read in
+    progress.  The events in the queue can still be read.
+
+  Preconditions:
+    None
+
+  Parameters:
+    void* handle - Pointer to a structure containing the Device Info
+
+  Returns:
+    None
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+void USBHostMIDIStreamStop( void* handle )
+{
+    MIDI_DEVICE *device = (MIDI_DEVICE*)handle;
+
+    if (device->stream.active)
+    {
+        USBHostTerminateTransfer( device->deviceAddress, device->endpoints[device->stream.endpointIndex].endpointAddress );
+        device->endpoints[device->stream.endpointIndex].busy = FALSE;
+        device->stream.active = FALSE;
+    }
+
+} // USBHostMIDIStreamStop
+
+
+/****************************************************************************
+  Function:
+    WORD USBHostMIDIStreamRead( void* handle, MIDI_TIMED_EVENT *events,
+                                WORD maxEvents )
+
+  Description:
+    This function copies up to maxEvents of the oldest events out of the
+    event stream queue.
+
+  Preconditions:
+    None
+
+  Parameters:
+    void* handle             - Pointer to a structure containing the Device Info
+    MIDI_TIMED_EVENT *events - Buffer for the events
+    WORD maxEvents           - Number of events the buffer holds
+
+  Returns:
+    WORD - Number of events copied
+
+  Remarks:
+    This function can be called from the application event handler when it
+    receives EVENT_MIDI_STREAM_DATA.
+  ***************************************************************************/
+
+WORD USBHostMIDIStreamRead( void* handle, MIDI_TIMED_EVENT *events, WORD maxEvents )
+{
+    MIDI_STREAM_INFO *stream = &((MIDI_DEVICE*)handle)->stream;
+    WORD count;
+
+    for (count = 0; (count < maxEvents) && stream->count; count++)
+    {
+        events[count] = stream->events[stream->tail];
+        if (++stream->tail == USB_HOST_MIDI_STREAM_QUEUE_SIZE)
+        {
+            stream->tail = 0;
+        }
+        stream->count--;
+    }
+
+    return count;
+
+} // USBHostMIDIStreamRead
+#endif
+
+
+#if defined(USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+/****************************************************************************
+  Function:
+    BOOL USBHostMIDIQueueWrite( void* handle, USB_AUDIO_MIDI_PACKET packet )
+
+  Description:
+    This function adds a USB MIDI packet to the write queue, or replaces a
+    waiting packet with the same target.  If the OUT endpoint is idle, the
+    packets are sent right away.  Otherwise, they are sent together when the
+    transfer in progress completes.
+
+  Preconditions:
+    The device must be connected and enumerated.
+
+  Parameters:
+    void* handle                 - Pointer to a structure containing the Device Info
+    USB_AUDIO_MIDI_PACKET packet - The packet to send
+
+  Return Values:
+    TRUE    - The packet was queued
+    FALSE   - The queue is full, or the interface has no OUT endpoint
+
+  Remarks:
+    Do not write to the OUT endpoint with USBHostMIDIWrite() while packets
+    are queued.
+  ***************************************************************************/
+
+BOOL USBHostMIDIQueueWrite( void* handle, USB_AUDIO_MIDI_PACKET packet )
+{
+    MIDI_DEVICE *device = (MIDI_DEVICE*)handle;
+    MIDI_WRITE_QUEUE_INFO *queue = &device->writeQueue;
+
+    if (queue->endpointIndex == 0xFF)
+    {
+        return FALSE;
+    }
+
+    if (_USBHostMIDI_Coalesce( queue, &packet ))
+    {
+        queue->coalesced++;
+    }
+    else
+    {
+        if (queue->count == USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+        {
+            return FALSE;
+        }
+        queue->packets[queue->head] = packet;
+        if (++queue->head == USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+        {
+            queue->head = 0;
+        }
+        queue->count++;
+    }
+
+    // Send right away if the endpoint is idle.  Otherwise the packet goes
+    // out with the next batch.
+    if (!device->endpoints[queue->endpointIndex].busy)
+    {
+        _USBHostMIDI_WriteTasks( device );
+    }
+
+    return TRUE;
+
+} // USBHostMIDIQueueWrite
+#endif
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Internal Functions
+// *****************************************************************************
+// *****************************************************************************
+
+#if defined(USB_HOST_MIDI_STREAM_QUEUE_SIZE)
+/****************************************************************************
+  Function:
+    static void _USBHostMIDI_StreamTasks( MIDI_DEVICE *device, QWORD *pTimestamp )
+
+  Description:
+    This function checks the read of the event stream.  When it is complete,
+    the time is taken, the next read is started on the other buffer, and
+    the USB MIDI packets received are added to the queue with that time.
+    Empty packets, which some devices use as padding, are skipped.  The
+    application is notified with EVENT_MIDI_STREAM_DATA, or with
+    EVENT_MIDI_STREAM_ERROR if the stream stops because of an error.
+
+  Preconditions:
+    None
+
+  Parameters:
+    MIDI_DEVICE *device - The device
+    QWORD *pTimestamp   - Completion time of the transfer, from its
+                          EVENT_TRANSFER event.  NULL to use the value of
+                          USB_HOST_MIDI_TIMESTAMP() when the transfer is
+                          found complete.
+
+  Returns:
+    None
+
+  Remarks:
+    A NAK timeout does not stop the stream.  Events that do not fit in the
+    queue are counted in stream.overruns and dropped.
+  ***************************************************************************/
+
+static void _USBHostMIDI_StreamTasks( MIDI_DEVICE *device, QWORD *pTimestamp )
+{
+    MIDI_STREAM_INFO *stream = &device->stream;
+    MIDI_ENDPOINT_DATA *endpoint;
+    MIDI_TIMED_EVENT *event;
+    QWORD timestamp;
+    DWORD byteCount;
+    BYTE *buffer;
+    WORD added;
+    BYTE errorCode;
+    BYTE i;
+
+    if (!stream->active)
+    {
+        return;
+    }
+    endpoint = &device->endpoints[stream->endpointIndex];
+
+    if (!USBHostTransferIsComplete( device->deviceAddress, endpoint->endpointAddress, &errorCode, &byteCount ))
+    {
+        return;
+    }
+    timestamp = (pTimestamp != NULL) ? *pTimestamp : USB_HOST_MIDI_TIMESTAMP();
+
+    if ((errorCode != USB_SUCCESS) && (errorCode != USB_ENDPOINT_NAK_TIMEOUT))
+    {
+        byteCount = 0;
+    }
+    else
+    {
+        if (errorCode == USB_ENDPOINT_NAK_TIMEOUT)
+        {
+            USBHostClearEndpointErrors( device->deviceAddress, endpoint->endpointAddress );
+        }
+
+        // Poll the device again before unpacking what it sent.
+        buffer = stream->buffer[stream->bufferArmed];
+        stream->bufferArmed ^= 1;
+        errorCode = USBHostRead( device->deviceAddress, endpoint->endpointAddress, stream->buffer[stream->bufferArmed], endpoint->endpointSize );
+    }
+
+    added = 0;
+    for (i = 0; (i + USB_MIDI_PACKET_LENGTH) <= byteCount; i += USB_MIDI_PACKET_LENGTH)
+    {
+        if ((buffer[i] | buffer[i+1] | buffer[i+2] | buffer[i+3]) == 0)
+        {
+            continue;
+        }
+        if (stream->count == USB_HOST_MIDI_STREAM_QUEUE_SIZE)
+        {
+            stream->overruns++;
+            continue;
+        }
+
+        event = &stream->events[stream->head];
+        event->timestamp = timestamp;
+        memcpy( event->packet.v, &buffer[i], USB_MIDI_PACKET_LENGTH );
+        if (++stream->head == USB_HOST_MIDI_STREAM_QUEUE_SIZE)
+        {
+            stream->head = 0;
+        }
+        stream->count++;
+        added++;
+    }
+
+    if (added)
+    {
+        USB_HOST_APP_EVENT_HANDLER(device->deviceAddress, EVENT_MIDI_STREAM_DATA, device, added);
+    }
+
+    if (errorCode != USB_SUCCESS)
+    {
+        USBHostClearEndpointErrors( device->deviceAddress, endpoint->endpointAddress );
+        stream->errorCode = errorCode;
+        stream->active = FALSE;
+        endpoint->busy = FALSE;
+        USB_HOST_APP_EVENT_HANDLER(device->deviceAddress, EVENT_MIDI_STREAM_ERROR, device, errorCode);
+    }
+} // _USBHostMIDI_StreamTasks
+#endif
+
+
+#if defined(USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+/****************************************************************************
+  Function:
+    static void _USBHostMIDI_WriteTasks( MIDI_DEVICE *device )
+
+  Description:
+    This function checks the batch being sent by the write queue.  When the
+    OUT endpoint is idle, as many of the waiting packets as the endpoint
+    allows are moved into the batch and sent in one transfer.
+
+  Preconditions:
+    None
+
+  Parameters:
+    MIDI_DEVICE *device - The device
+
+  Returns:
+    None
+
+  Remarks:
+    A batch that ends with a NAK timeout is sent again.  A batch that ends
+    with any other error is dropped, and the application receives
+    EVENT_MIDI_WRITE_ERROR.
+  ***************************************************************************/
+
+static void _USBHostMIDI_WriteTasks( MIDI_DEVICE *device )
+{
+    MIDI_WRITE_QUEUE_INFO *queue = &device->writeQueue;
+    MIDI_ENDPOINT_DATA *endpoint;
+    DWORD byteCount;
+    BYTE errorCode;
+
+    if (queue->endpointIndex == 0xFF)
+    {
+        return;
+    }
+    endpoint = &device->endpoints[queue->endpointIndex];
+
+    if (endpoint->busy)
+    {
+        // The application's own write is left to it.
+        if (!queue->batchLength ||
+            !USBHostTransferIsComplete( device->deviceAddress, endpoint->endpointAddress, &errorCode, &byteCount ))
+        {
+            return;
+        }
+        endpoint->busy = FALSE;
+
+        if (errorCode == USB_ENDPOINT_NAK_TIMEOUT)
+        {
+            USBHostClearEndpointErrors( device->deviceAddress, endpoint->endpointAddress );
+        }
+        else
+        {
+            if (errorCode != USB_SUCCESS)
+            {
+                USBHostClearEndpointErrors( device->deviceAddress, endpoint->endpointAddress );
+                USB_HOST_APP_EVENT_HANDLER(device->deviceAddress, EVENT_MIDI_WRITE_ERROR, device, errorCode);
+            }
+            queue->batchLength = 0;
+        }
+    }
+
+    if (!queue->batchLength)
+    {
+        // Packets in the batch can no longer be replaced.
+        while (queue->count && ((queue->batchLength + USB_MIDI_PACKET_LENGTH) <= endpoint->endpointSize))
+        {
+            memcpy( &queue->batch[queue->batchLength], queue->packets[queue->tail].v, USB_MIDI_PACKET_LENGTH );
+            queue->batchLength += USB_MIDI_PACKET_LENGTH;
+            if (++queue->tail == USB_HOST_MIDI_WRITE_QUEUE_SIZE)
+            {
+                queue->tail = 0;
+            }
+            queue->count--;
+        }
+        if (!queue->batchLength)
+        {
+            return;
+        }
+    }
+
+    if (USBHostWrite( device->deviceAddress, endpoint->endpointAddress, queue->batch, queue->batchLength ) == USB_SUCCESS)
+    {
+        endpoint->busy = TRUE;
+    }
+} // _USBHostMIDI_WriteTasks
+
+
+/****************************************************************************
+  Function:
+    static BOOL _USBHostMIDI_IsReplaceable( USB_AUDIO_MIDI_PACKET *packet )
+
+  Description:
+    This function checks whether a packet carries a value that only matters
+    until a newer one is sent: a Control Change, other than the RPN and NRPN
+    data entry controllers, a Pitch Bend, a Channel Pressure, or a
+    Polyphonic Key Pressure.
+
+  Preconditions:
+    None
+
+  Parameters:
+    USB_AUDIO_MIDI_PACKET *packet - The packet
+
+  Return Values:
+    TRUE    - A newer packet with the same target can replace this one
+    FALSE   - The packet must be sent
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+static BOOL _USBHostMIDI_IsReplaceable( USB_AUDIO_MIDI_PACKET *packet )
+{
+    switch (packet->v[0] & 0x0F)
+    {
+        case MIDI_CIN_CONTROL_CHANGE:
+            // Data entry (6, 38), increment/decrement (96, 97) and the
+            // parameter numbers (98 to 101) only make sense in order.
+            return !((packet->v[2] == 6) || (packet->v[2] == 38) || ((packet->v[2] >= 96) && (packet->v[2] <= 101)));
+
+        case MIDI_CIN_PITCH_BEND_CHANGE:
+        case MIDI_CIN_CHANNEL_PREASURE:
+        case MIDI_CIN_POLY_KEY_PRESS:
+            return TRUE;
+
+        default:
+            return FALSE;
+    }
+} // _USBHostMIDI_IsReplaceable
+
+
+/****************************************************************************
+  Function:
+    static BOOL _USBHostMIDI_Coalesce( MIDI_WRITE_QUEUE_INFO *queue,
+                                       USB_AUDIO_MIDI_PACKET *packet )
+
+  Description:
+    This function looks for a waiting packet that the new packet can
+    replace.  The queue is searched from the newest packet back.  Packets
+    for other cables and channels, other replaceable packets and system real
+    time messages are passed over.  The search stops at any other packet for
+    the same cable and channel, or at a system message for the same cable,
+    so the new value is never moved ahead of a message it followed.
+
+  Preconditions:
+    None
+
+  Parameters:
+    MIDI_WRITE_QUEUE_INFO *queue  - The write queue
+    USB_AUDIO_MIDI_PACKET *packet - The new packet
+
+  Return Values:
+    TRUE    - A waiting packet was replaced by the new packet
+    FALSE   - The new packet must be added to the queue
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+static BOOL _USBHostMIDI_Coalesce( MIDI_WRITE_QUEUE_INFO *queue, USB_AUDIO_MIDI_PACKET *packet )
+{
+    USB_AUDIO_MIDI_PACKET *waiting;
+    WORD index;
+    WORD n;
+    BYTE cin;
+
+    if (!_USBHostMIDI_IsReplaceable( packet ))
+    {
+        return FALSE;
+    }
+
+    index = queue->head;
+    for (n = queue->count; n; n--)
+    {
+        index = (index ? index : USB_HOST_MIDI_WRITE_QUEUE_SIZE) - 1;
+        waiting = &queue->packets[index];
+
+        if ((waiting->v[0] >> 4) != (packet->v[0] >> 4))
+        {
+            continue;   // Another cable
+        }
+
+        cin = waiting->v[0] & 0x0F;
+        if (cin == MIDI_CIN_SINGLE_BYTE)
+        {
+            if (waiting->v[1] >= MIDI_STATUS_MIDI_CLOCK)
+            {
+                continue;   // Real time messages may go anywhere
+            }
+            break;
+        }
+        if (cin < MIDI_CIN_NOTE_OFF)
+        {
+            break;  // System common and system exclusive
+        }
+        if ((waiting->v[1] & 0x0F) != (packet->v[1] & 0x0F))
+        {
+            continue;   // Another channel
+        }
+
+        if ((waiting->v[0] == packet->v[0]) && (waiting->v[1] == packet->v[1]) &&
+            (((cin != MIDI_CIN_CONTROL_CHANGE) && (cin != MIDI_CIN_POLY_KEY_PRESS)) || (waiting->v[2] == packet->v[2])))
+        {
+            *waiting = *packet;
+            return TRUE;
+        }
+        if (!_USBHostMIDI_IsReplaceable( waiting ))
+        {
+            break;
+        }
+    }
+
+    return FALSE;
+} // _USBHostMIDI_Coalesce
+#endif
+
+
 /*************************************************************************
  * EOF usb_client_midi.c
  */
@@ -89,7 +89,6 @@ Change History:
 #include "USB/usb.h"
 #include "HardwareProfile.h"
 #include "FSconfig.h"
-#include "MDD File System/SD-SPI.h"
 
 #include "USB/usb_function_msd.h"
 
@@ -118,6 +117,19 @@ Change History:
     #define LUNSectorWrite(bLBA,pDest,Write0)   LUN[LUN_INDEX].SectorWrite(bLBA, pDest, Write0)
     #define LUNWriteProtectState()              LUN[LUN_INDEX].WriteProtectState()
     #define LUNSectorRead(bLBA,pSrc)            LUN[LUN_INDEX].SectorRead(bLBA, pSrc)
+
+    //A LUN_FUNCTIONS entry written for usb_function_msd.c may leave the
+    //AsyncReadTasks/AsyncWriteTasks members NULL.  The SD-SPI ones are used
+    //then, or, without the SD-SPI layer, the read/write fails cleanly.
+    #if defined(USE_SD_INTERFACE_WITH_SPI)
+        #define MSDDefaultAsyncReadTasks(pInfo)     MDD_SDSPI_AsyncReadTasks(pInfo)
+        #define MSDDefaultAsyncWriteTasks(pInfo)    MDD_SDSPI_AsyncWriteTasks(pInfo)
+    #else
+        #define MSDDefaultAsyncReadTasks(pInfo)     ASYNC_READ_ERROR
+        #define MSDDefaultAsyncWriteTasks(pInfo)    ASYNC_WRITE_ERROR
+    #endif
+    #define LUNAsyncReadTasks(pInfo)            ((LUN[LUN_INDEX].AsyncReadTasks != NULL) ? LUN[LUN_INDEX].AsyncReadTasks(pInfo) : MSDDefaultAsyncReadTasks(pInfo))
+    #define LUNAsyncWriteTasks(pInfo)           ((LUN[LUN_INDEX].AsyncWriteTasks != NULL) ? LUN[LUN_INDEX].AsyncWriteTasks(pInfo) : MSDDefaultAsyncWriteTasks(pInfo))
 #else
     #if defined(USE_INTERNAL_FLASH)
         #include "MDD File System/Internal Flash.h"
@@ -134,6 +146,17 @@ Change History:
     #define LUNSectorWrite(bLBA,pDest,Write0)   MDD_SectorWrite(bLBA, pDest, Write0)
     #define LUNWriteProtectState()              MDD_WriteProtectState()
     #define LUNSectorRead(bLBA,pSrc)            MDD_SectorRead(bLBA, pSrc)
+
+    //FSconfig.h may point these at the tasks functions of another physical
+    //layer.  The SD-SPI ones are used otherwise.
+    #if !defined(MDD_AsyncReadTasks)
+        #define MDD_AsyncReadTasks                  MDD_SDSPI_AsyncReadTasks
+    #endif
+    #if !defined(MDD_AsyncWriteTasks)
+        #define MDD_AsyncWriteTasks                 MDD_SDSPI_AsyncWriteTasks
+    #endif
+    #define LUNAsyncReadTasks(pInfo)            MDD_AsyncReadTasks(pInfo)
+    #define LUNAsyncWriteTasks(pInfo)           MDD_AsyncWriteTasks(pInfo)
 #endif
 
 //Adjustable user options
@@ -1116,11 +1139,11 @@ BYTE MSDReadHandler(void)
    
     //Call our data fetching poller, unless we already have unprocessed data
     //ready for our retrieval.  In this case, we need to stop calling our
-    //MDD_SDSPI_AsyncReadTasks(), until we are ready to consume the new buffer 
+    //media read tasks function, until we are ready to consume the new buffer 
     //worth of data and update the AsyncReadWriteInfo structure with a new pointer.
     if((fetchStatus != ASYNC_READ_NEW_PACKET_READY) && (fetchStatus != ASYNC_READ_COMPLETE))
     {
-        fetchStatus = MDD_SDSPI_AsyncReadTasks(&AsyncReadWriteInfo);   
+        fetchStatus = LUNAsyncReadTasks(&AsyncReadWriteInfo);   
     }    
     
     switch(MSDReadState)
@@ -1160,19 +1183,19 @@ BYTE MSDReadHandler(void)
             NewDataAlreadyAvailable = FALSE;
             //Fall through...
         case MSD_READ10_XMITING_DATA:
-            //Check if the MDD_SDSPI_AsyncReadTasks() function has finished sending us
+            //Check if the media read tasks function has finished sending us
             //a new packet of data yet.  If not, keep calling it until we get some data.
             if(NewDataAlreadyAvailable == FALSE) 
             {
              	//Try to fetch a new packet of data
-             	if(fetchStatus == ASYNC_READ_NEW_PACKET_READY) //Check if the MDD_SDSPI_AsyncReadTasks() function is about to return on data on the next call
+             	if(fetchStatus == ASYNC_READ_NEW_PACKET_READY) //Check if the media read tasks function is about to return on data on the next call
              	{
-                	fetchStatus = MDD_SDSPI_AsyncReadTasks(&AsyncReadWriteInfo); 
+                	fetchStatus = LUNAsyncReadTasks(&AsyncReadWriteInfo); 
                 	NewDataAlreadyAvailable = TRUE;               
             	}
             	else
             	{
-                	fetchStatus = MDD_SDSPI_AsyncReadTasks(&AsyncReadWriteInfo);                 	
+                	fetchStatus = LUNAsyncReadTasks(&AsyncReadWriteInfo);                 	
                 }   	
             }    
 
@@ -1205,12 +1228,12 @@ BYTE MSDReadHandler(void)
             	//with the above USB transfer, for maximum transfer speeds.
    	            if(fetchStatus == ASYNC_READ_NEW_PACKET_READY)
    	            {
-                	fetchStatus = MDD_SDSPI_AsyncReadTasks(&AsyncReadWriteInfo);  
+                	fetchStatus = LUNAsyncReadTasks(&AsyncReadWriteInfo);  
                 	NewDataAlreadyAvailable = TRUE;
                 }	
                 else
                 {                    
-                 	fetchStatus = MDD_SDSPI_AsyncReadTasks(&AsyncReadWriteInfo);  
+                 	fetchStatus = LUNAsyncReadTasks(&AsyncReadWriteInfo);  
                 	NewDataAlreadyAvailable = FALSE;                   
                 }    
             }  
@@ -1330,7 +1353,7 @@ BYTE MSDWriteHandler(void)
           	    return MSDWriteState;
           	}
         	
-        	//Initialize our ASYNC_IO structure, so the MDD_SDSPI_AsyncWriteTasks()
+        	//Initialize our ASYNC_IO structure, so the media write tasks function
         	//API will know what to do.
         	AsyncReadWriteInfo.bStateVariable = ASYNC_WRITE_QUEUED;
         	AsyncReadWriteInfo.dwAddress = LBA.Val;
@@ -1436,7 +1459,7 @@ BYTE MSDWriteHandler(void)
               	//data to write to the media.
               	if(msd_csw.bCSWStatus == 0x00)
               	{
-              	    LastWriteStatus = MDD_SDSPI_AsyncWriteTasks(&AsyncReadWriteInfo);
+              	    LastWriteStatus = LUNAsyncWriteTasks(&AsyncReadWriteInfo);
               	}    
             } 
       	    
@@ -1465,7 +1488,7 @@ BYTE MSDWriteHandler(void)
                 if(msd_csw.bCSWStatus == 0x00)
                 {
               		msd_csw.dCSWDataResidue -= MSD_OUT_EP_SIZE;
-                    LastWriteStatus = MDD_SDSPI_AsyncWriteTasks(&AsyncReadWriteInfo);
+                    LastWriteStatus = LUNAsyncWriteTasks(&AsyncReadWriteInfo);
                 }    
 
                 //Update pointer to point to the next data location, so we will
@@ -105,6 +105,8 @@ Change History:
     BOOL    _USBHostMSDSCSI_TestUnitReady( void );
 #endif
 
+BYTE    _USBHostMSDSCSI_SectorsSubmit( BYTE direction, DWORD sectorAddress, WORD sectorCount, BYTE *dataBuffer );
+
 
 //******************************************************************************
 //******************************************************************************
@@ -669,7 +671,77 @@ BYTE USBHostMSDSCSIMediaReset( void  )
     FALSE   - read was not successful
 
   Remarks:
-    The READ10 command block is as follows:
+    See USBHostMSDSCSISectorsRead().
+  ***************************************************************************/
+
+BYTE USBHostMSDSCSISectorRead( DWORD sectorAddress, BYTE *dataBuffer )
+{
+    return USBHostMSDSCSISectorsRead( sectorAddress, 1, dataBuffer );
+}
+
+/****************************************************************************
+  Function:
+    BYTE USBHostMSDSCSISectorWrite( DWORD sectorAddress, BYTE *dataBuffer, BYTE allowWriteToZero )
+
+  Summary:
+    This function writes one sector.
+
+  Description:
+    This function uses the SCSI command WRITE10 to write one sector.  The size
+    of the sector was determined in the USBHostMSDSCSIMediaInitialize()
+    function.  The data is read from the application buffer.
+
+  Precondition:
+    None
+
+  Parameters:
+    DWORD   sectorAddress   - address of sector to write
+    BYTE    *dataBuffer     - buffer with application data
+    BYTE    allowWriteToZero- If a write to sector 0 is allowed.
+
+  Return Values:
+    TRUE    - write performed successfully
+    FALSE   - write was not successful
+
+  Remarks:
+    To follow convention, this function blocks until the write is complete.
+    See USBHostMSDSCSISectorsWrite().
+  ***************************************************************************/
+
+BYTE USBHostMSDSCSISectorWrite( DWORD sectorAddress, BYTE *dataBuffer, BYTE allowWriteToZero )
+{
+    return USBHostMSDSCSISectorsWrite( sectorAddress, 1, dataBuffer, allowWriteToZero );
+}
+
+/****************************************************************************
+  Function:
+    BYTE USBHostMSDSCSISectorsRead( DWORD sectorAddress, WORD sectorCount,
+                BYTE *dataBuffer )
+
+  Summary:
+    This function reads consecutive sectors.
+
+  Description:
+    This function uses one SCSI READ10 command to read sectorCount
+    consecutive sectors, so the CBW and CSW stages are performed once for
+    the whole run instead of once per sector.  The data is stored in the
+    application buffer, which must hold sectorCount sectors.
+
+  Precondition:
+    None
+
+  Parameters:
+    DWORD   sectorAddress   - address of the first sector to read
+    WORD    sectorCount     - number of sectors to read
+    BYTE    *dataBuffer     - buffer to store data
+
+  Return Values:
+    TRUE    - read performed successfully
+    FALSE   - read was not successful
+
+  Remarks:
+    This function blocks until the read is complete, calling USBTasks()
+    while waiting.  The READ10 command block is as follows:
 
     <code>
         Byte/Bit    7       6       5       4       3       2       1       0
@@ -686,10 +758,9 @@ BYTE USBHostMSDSCSIMediaReset( void  )
     </code>
   ***************************************************************************/
 
-BYTE USBHostMSDSCSISectorRead( DWORD sectorAddress, BYTE *dataBuffer )
+BYTE USBHostMSDSCSISectorsRead( DWORD sectorAddress, WORD sectorCount, BYTE *dataBuffer )
 {
     DWORD   byteCount;
-    BYTE    commandBlock[10];
     BYTE    errorCode;
 
     #ifdef DEBUG_MODE
@@ -698,30 +769,15 @@ BYTE USBHostMSDSCSISectorRead( DWORD sectorAddress, BYTE *dataBuffer )
         UART2PutHex(sectorAddress >> 16);
         UART2PutHex(sectorAddress >> 8);
         UART2PutHex(sectorAddress);
+        UART2PrintString( " Count " );
+        UART2PutHex(sectorCount >> 8);
+        UART2PutHex(sectorCount);
         UART2PrintString( " Device " );
         UART2PutHex(deviceAddress);
         UART2PrintString( "\r\n" );
     #endif
 
-    if (deviceAddress == 0)
-    {
-        return FALSE;       // USB_MSD_DEVICE_NOT_FOUND;
-    }
-
-    // Fill in the command block with the READ10 parameters.
-    commandBlock[0] = 0x28;     // Operation code
-    commandBlock[1] = RDPROTECT_NORMAL | FUA_ALLOW_CACHE;
-    commandBlock[2] = (BYTE) (sectorAddress >> 24);     // Big endian!
-    commandBlock[3] = (BYTE) (sectorAddress >> 16);
-    commandBlock[4] = (BYTE) (sectorAddress >> 8);
-    commandBlock[5] = (BYTE) (sectorAddress);
-    commandBlock[6] = 0x00;     // Group Number
-    commandBlock[7] = 0x00;     // Number of blocks - Big endian!
-    commandBlock[8] = 0x01;
-    commandBlock[9] = 0x00;     // Control
-
-    // Currently using LUN=0.  When the File System supports multiple LUN's, this will change.
-    errorCode = USBHostMSDRead( deviceAddress, 0, commandBlock, 10, dataBuffer, mediaInformation.sectorSize );
+    errorCode = USBHostMSDSCSISectorsReadSubmit( sectorAddress, sectorCount, dataBuffer );
     #ifdef DEBUG_MODE
         UART2PrintString( "SCSI: Read sector init error " );
         UART2PutHex( errorCode );
@@ -755,21 +811,23 @@ BYTE USBHostMSDSCSISectorRead( DWORD sectorAddress, BYTE *dataBuffer )
 
 /****************************************************************************
   Function:
-    BYTE USBHostMSDSCSISectorWrite( DWORD sectorAddress, BYTE *dataBuffer, BYTE allowWriteToZero )
+    BYTE USBHostMSDSCSISectorsWrite( DWORD sectorAddress, WORD sectorCount,
+                BYTE *dataBuffer, BYTE allowWriteToZero )
 
   Summary:
-    This function writes one sector.
+    This function writes consecutive sectors.
 
   Description:
-    This function uses the SCSI command WRITE10 to write one sector.  The size
-    of the sector was determined in the USBHostMSDSCSIMediaInitialize()
-    function.  The data is read from the application buffer.
+    This function uses one SCSI WRITE10 command to write sectorCount
+    consecutive sectors from the application buffer, so the CBW and CSW
+    stages are performed once for the whole run instead of once per sector.
 
   Precondition:
     None
 
   Parameters:
-    DWORD   sectorAddress   - address of sector to write
+    DWORD   sectorAddress   - address of the first sector to write
+    WORD    sectorCount     - number of sectors to write
     BYTE    *dataBuffer     - buffer with application data
     BYTE    allowWriteToZero- If a write to sector 0 is allowed.
 
@@ -778,9 +836,8 @@ BYTE USBHostMSDSCSISectorRead( DWORD sectorAddress, BYTE *dataBuffer )
     FALSE   - write was not successful
 
   Remarks:
-    To follow convention, this function blocks until the write is complete.
-
-    The WRITE10 command block is as follows:
+    This function blocks until the write is complete, calling USBTasks()
+    while waiting.  The WRITE10 command block is as follows:
 
     <code>
         Byte/Bit    7       6       5       4       3       2       1       0
@@ -797,10 +854,9 @@ BYTE USBHostMSDSCSISectorRead( DWORD sectorAddress, BYTE *dataBuffer )
     </code>
   ***************************************************************************/
 
-BYTE USBHostMSDSCSISectorWrite( DWORD sectorAddress, BYTE *dataBuffer, BYTE allowWriteToZero )
+BYTE USBHostMSDSCSISectorsWrite( DWORD sectorAddress, WORD sectorCount, BYTE *dataBuffer, BYTE allowWriteToZero )
 {
     DWORD   byteCount;
-    BYTE    commandBlock[10];
     BYTE    errorCode;
 
     #ifdef DEBUG_MODE
@@ -809,35 +865,15 @@ BYTE USBHostMSDSCSISectorWrite( DWORD sectorAddress, BYTE *dataBuffer, BYTE allo
         UART2PutHex(sectorAddress >> 16);
         UART2PutHex(sectorAddress >> 8);
         UART2PutHex(sectorAddress);
+        UART2PrintString( " Count " );
+        UART2PutHex(sectorCount >> 8);
+        UART2PutHex(sectorCount);
         UART2PrintString( " Device " );
         UART2PutHex(deviceAddress);
         UART2PrintString( "\r\n" );
     #endif
 
-    if (deviceAddress == 0)
-    {
-        return FALSE;   //USB_MSD_DEVICE_NOT_FOUND;
-    }
-
-    if ((sectorAddress == 0) && (allowWriteToZero == FALSE))
-    {
-        return FALSE;
-    }
-
-    // Fill in the command block with the WRITE 10 parameters.
-    commandBlock[0] = 0x2A;     // Operation code
-    commandBlock[1] = WRPROTECT_NORMAL | FUA_ALLOW_CACHE;
-    commandBlock[2] = (BYTE) (sectorAddress >> 24);     // Big endian!
-    commandBlock[3] = (BYTE) (sectorAddress >> 16);
-    commandBlock[4] = (BYTE) (sectorAddress >> 8);
-    commandBlock[5] = (BYTE) (sectorAddress);
-    commandBlock[6] = 0x00;     // Group Number
-    commandBlock[7] = 0x00;     // Number of blocks - Big endian!
-    commandBlock[8] = 0x01;
-    commandBlock[9] = 0x00;     // Control
-
-    // Currently using LUN=0.  When the File System supports multiple LUN's, this will change.
-    errorCode = USBHostMSDWrite( deviceAddress, 0, commandBlock, 10, dataBuffer, mediaInformation.sectorSize );
+    errorCode = USBHostMSDSCSISectorsWriteSubmit( sectorAddress, sectorCount, dataBuffer, allowWriteToZero );
     #ifdef DEBUG_MODE
         UART2PrintString( "SCSI: Write sector init error " );
         UART2PutHex( errorCode );
@@ -869,6 +905,129 @@ BYTE USBHostMSDSCSISectorWrite( DWORD sectorAddress, BYTE *dataBuffer, BYTE allo
     }
 }
 
+/****************************************************************************
+  Function:
+    BYTE USBHostMSDSCSISectorsReadSubmit( DWORD sectorAddress,
+                WORD sectorCount, BYTE *dataBuffer )
+
+  Summary:
+    This function starts reading consecutive sectors.
+
+  Description:
+    This function issues the READ10 command for sectorCount sectors and
+    returns without waiting for the data.  The transfer is performed while
+    the application keeps calling USBTasks() from its main loop.  Use
+    USBHostMSDSCSITransferPoll() to find out when it is complete.  The
+    buffer must not be used until then.
+
+  Precondition:
+    No other transfer is in progress.
+
+  Parameters:
+    DWORD   sectorAddress   - address of the first sector to read
+    WORD    sectorCount     - number of sectors to read
+    BYTE    *dataBuffer     - buffer to store data
+
+  Return Values:
+    USB_SUCCESS                 - The transfer was started
+    USB_MSD_DEVICE_NOT_FOUND    - No device is attached
+    USB_MSD_DEVICE_BUSY         - Another transfer is in progress
+    USB_MSD_INVALID_LUN         - The device has not reported its LUNs or
+                                  the sector size of LUN 0 is not known
+                                  (the media is not initialized)
+    USB_ILLEGAL_REQUEST         - sectorCount is 0
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+BYTE USBHostMSDSCSISectorsReadSubmit( DWORD sectorAddress, WORD sectorCount, BYTE *dataBuffer )
+{
+    return _USBHostMSDSCSI_SectorsSubmit( 1, sectorAddress, sectorCount, dataBuffer );
+}
+
+/****************************************************************************
+  Function:
+    BYTE USBHostMSDSCSISectorsWriteSubmit( DWORD sectorAddress,
+                WORD sectorCount, BYTE *dataBuffer, BYTE allowWriteToZero )
+
+  Summary:
+    This function starts writing consecutive sectors.
+
+  Description:
+    This function issues the WRITE10 command for sectorCount sectors and
+    returns without waiting for the data to be sent.  The transfer is
+    performed while the application keeps calling USBTasks() from its main
+    loop.  Use USBHostMSDSCSITransferPoll() to find out when it is complete.
+    The buffer must not be modified until then.
+
+  Precondition:
+    No other transfer is in progress.
+
+  Parameters:
+    DWORD   sectorAddress   - address of the first sector to write
+    WORD    sectorCount     - number of sectors to write
+    BYTE    *dataBuffer     - buffer with application data
+    BYTE    allowWriteToZero- If a write to sector 0 is allowed.
+
+  Return Values:
+    USB_SUCCESS                 - The transfer was started
+    USB_MSD_DEVICE_NOT_FOUND    - No device is attached
+    USB_MSD_DEVICE_BUSY         - Another transfer is in progress
+    USB_MSD_INVALID_LUN         - The device has not reported its LUNs or
+                                  the sector size of LUN 0 is not known
+                                  (the media is not initialized)
+    USB_ILLEGAL_REQUEST         - sectorCount is 0 or the write to sector 0
+                                  is not allowed
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+BYTE USBHostMSDSCSISectorsWriteSubmit( DWORD sectorAddress, WORD sectorCount, BYTE *dataBuffer, BYTE allowWriteToZero )
+{
+    if ((sectorAddress == 0) && (allowWriteToZero == FALSE))
+    {
+        return USB_ILLEGAL_REQUEST;
+    }
+
+    return _USBHostMSDSCSI_SectorsSubmit( 0, sectorAddress, sectorCount, dataBuffer );
+}
+
+/****************************************************************************
+  Function:
+    BOOL USBHostMSDSCSITransferPoll( BYTE *errorCode )
+
+  Summary:
+    This function checks if a submitted transfer is complete.
+
+  Description:
+    This function checks the transfer started by
+    USBHostMSDSCSISectorsReadSubmit() or USBHostMSDSCSISectorsWriteSubmit().
+    It does not call USBTasks(), the application must keep calling it.
+
+  Precondition:
+    A transfer was submitted.
+
+  Parameters:
+    BYTE    *errorCode      - Error code of the completed transfer,
+                              USB_SUCCESS if the sectors were transferred
+
+  Return Values:
+    TRUE    - The transfer is complete (or the device was detached)
+    FALSE   - The transfer is still in progress
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+BOOL USBHostMSDSCSITransferPoll( BYTE *errorCode )
+{
+    DWORD   byteCount;
+
+    return USBHostMSDTransferIsComplete( deviceAddress, errorCode, &byteCount );
+}
+
 
 /****************************************************************************
   Function:
@@ -935,6 +1094,81 @@ BYTE    USBHostMSDSCSIWriteProtectState( void )
     </code>
   ***************************************************************************/
 
+/*******************************************************************************
+  Function:
+    BYTE _USBHostMSDSCSI_SectorsSubmit( BYTE direction, DWORD sectorAddress,
+                WORD sectorCount, BYTE *dataBuffer )
+
+  Precondition:
+    None
+
+  Overview:
+    This function fills in a READ10 or WRITE10 command block for
+    sectorCount sectors of LUN 0 and starts the transfer.
+
+  Parameters:
+    BYTE    direction       - 1 = read (device to host), 0 = write
+    DWORD   sectorAddress   - address of the first sector
+    WORD    sectorCount     - number of sectors
+    BYTE    *dataBuffer     - sectorCount sectors of data
+
+  Return Values:
+    See USBHostMSDTransfer().  USB_MSD_DEVICE_NOT_FOUND if no device is
+    attached, USB_MSD_INVALID_LUN if LUN 0 is not ready for transfers,
+    USB_ILLEGAL_REQUEST if sectorCount is 0.
+
+  Remarks:
+    The command block is copied into the CBW by USBHostMSDTransfer(), so it
+    can be a local variable.
+  ***************************************************************************/
+
+BYTE _USBHostMSDSCSI_SectorsSubmit( BYTE direction, DWORD sectorAddress, WORD sectorCount, BYTE *dataBuffer )
+{
+    BYTE    commandBlock[10];
+
+    if (deviceAddress == 0)
+    {
+        return USB_MSD_DEVICE_NOT_FOUND;
+    }
+
+    // LUN 0 is valid once the device has reported its max LUN, and the
+    // transfer length is only known once the media has been initialized.
+    if (!mediaInformation.validityFlags.bits.maxLUN || !mediaInformation.validityFlags.bits.sectorSize)
+    {
+        return USB_MSD_INVALID_LUN;
+    }
+
+    if (sectorCount == 0)
+    {
+        return USB_ILLEGAL_REQUEST;
+    }
+
+    // Fill in the command block with the READ10 or WRITE 10 parameters.
+    if (direction)
+    {
+        commandBlock[0] = 0x28;     // Operation code
+        commandBlock[1] = RDPROTECT_NORMAL | FUA_ALLOW_CACHE;
+    }
+    else
+    {
+        commandBlock[0] = 0x2A;     // Operation code
+        commandBlock[1] = WRPROTECT_NORMAL | FUA_ALLOW_CACHE;
+    }
+    commandBlock[2] = (BYTE) (sectorAddress >> 24);     // Big endian!
+    commandBlock[3] = (BYTE) (sectorAddress >> 16);
+    commandBlock[4] = (BYTE) (sectorAddress >> 8);
+    commandBlock[5] = (BYTE) (sectorAddress);
+    commandBlock[6] = 0x00;     // Group Number
+    commandBlock[7] = (BYTE) (sectorCount >> 8);        // Number of blocks - Big endian!
+    commandBlock[8] = (BYTE) (sectorCount);
+    commandBlock[9] = 0x00;     // Control
+
+    // Currently using LUN=0.  When the File System supports multiple LUN's, this will change.
+    return USBHostMSDTransfer( deviceAddress, 0, direction, commandBlock, 10, dataBuffer,
+                               (DWORD)sectorCount * mediaInformation.sectorSize );
+}
+
+
 #ifdef PERFORM_TEST_UNIT_READY
 BOOL _USBHostMSDSCSI_TestUnitReady( void )
 {
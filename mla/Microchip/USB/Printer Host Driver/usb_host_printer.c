@@ -90,6 +90,7 @@ CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
 
                 Changed how transfer queues are handled to do a peek
                 now before removing the item from the queue.
+  2.9j          Added USBHostPrinterWriteIsQueued().
 ********************************************************************/
 
 //DOM-IGNORE-END
@@ -1339,6 +1340,58 @@ BOOL USBHostPrinterWriteComplete( BYTE deviceAddress )
 }
 
 
+/****************************************************************************
+  Function:
+    BOOL USBHostPrinterWriteIsQueued( BYTE deviceAddress, void *buffer )
+
+  Description:
+    This interface is used to check if a buffer is still in the output
+    queue, either waiting to be sent or being sent to the printer.
+
+  Preconditions:
+    None
+
+  Parameters:
+    BYTE deviceAddress  - USB Address of the device
+    void *buffer        - Pointer to the data buffer
+
+  Return Values:
+    TRUE    - A transfer of the buffer is queued or in progress.
+    FALSE   - The buffer is not in the output queue, or an invalid
+                deviceAddress is given.  The buffer can be reused.
+
+  Remarks:
+    The transfer in progress stays at the tail of the queue until its
+    transfer event is received.
+  ***************************************************************************/
+
+BOOL USBHostPrinterWriteIsQueued( BYTE deviceAddress, void *buffer )
+{
+    USB_PRINTER_QUEUE   *queue;
+    int                 count;
+    int                 index;
+
+    if (!_USBHostPrinter_FindDevice( deviceAddress ))
+    {
+        // The device was not found.
+        return FALSE;
+    }
+
+    // Queued items are stored after the tail, oldest first.
+    queue = &(usbPrinters[currentPrinterRecord].transferQueueOUT);
+    index = queue->tail;
+    for (count = 0; count < queue->count; count++)
+    {
+        index = (index < (USB_PRINTER_TRANSFER_QUEUE_SIZE - 1)) ? (index + 1) : 0;
+        if (queue->buffer[index].data == buffer)
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Internal Functions
@@ -85,6 +85,8 @@ Change History:
   ----------  ----------------------------------------------------------
   2.6 - 2.7a   No change
 
+  2.9j         Added the USB_PRINTER_IMAGE_DATA_BAND command.
+
 *******************************************************************************/
 //DOM-IGNORE-END
 
@@ -735,6 +737,52 @@ EjectPage:
             return USBHostPrinterWrite( address, buffer, size, transferFlags );
             break;
 
+        //---------------------------------------------------------------------
+        case USB_PRINTER_IMAGE_DATA_BAND:
+            // Each row is sent with the header of USB_PRINTER_IMAGE_DATA_HEADER
+            // and flipped as for USB_PRINTER_IMAGE_DATA.  ESC/POS bit images
+            // cannot be compressed.  The whole band is sent in one transfer
+            // from the output buffer of the band.
+            {
+                USB_PRINTER_IMAGE_BAND  *band;
+                BYTE                    *row;
+                WORD                    rowCount;
+                DWORD                   used;
+
+                band = (USB_PRINTER_IMAGE_BAND *)(data.pointerRAM);
+                size *= printerListESCPOS[printer].imageDataWidth;
+
+                if ((transferFlags & (USB_PRINTER_TRANSFER_COPY_DATA | USB_PRINTER_TRANSFER_FROM_ROM)) ||
+                    (band->outputSize < USB_PRINTER_IMAGE_BAND_SIZE( size, band->rowCount )))
+                {
+                    return USB_PRINTER_BAD_PARAMETER;
+                }
+
+                used = 0;
+                row  = band->rows;
+                for (rowCount = 0; rowCount < band->rowCount; rowCount++)
+                {
+                    band->output[used++] = LF_CHAR;
+
+                    band->output[used++] = ESC_CHAR;
+                    band->output[used++] = '*';
+                    band->output[used++] = printerListESCPOS[printer].density;
+
+                    band->output[used++] = printerListESCPOS[printer].imageWidth & 0xFF;
+                    band->output[used++] = printerListESCPOS[printer].imageWidth >> 8;
+
+                    for (i=0; i<size; i++)
+                    {
+                        band->output[used++] = ~row[i];
+                    }
+
+                    row += band->rowBytes;
+                }
+
+                return USBHostPrinterWrite( printerListESCPOS[printer].deviceAddress, band->output, used, transferFlags );
+            }
+            break;
+
         //---------------------------------------------------------------------
         case USB_PRINTER_IMAGE_STOP:
             // No termination required.
@@ -88,6 +88,9 @@ Change History:
 
   2.7         Changed the interface to _SetCurrentPosition to be able to
               take in the printer number as a parameter.
+
+  2.9j        Added the USB_PRINTER_IMAGE_DATA_BAND command, which sends
+              the rows using compression method 2 (TIFF PackBits).
 *******************************************************************************/
 //DOM-IGNORE-END
 
@@ -323,6 +326,7 @@ PRINTER_STATUS_PCL  printerListPCL[USB_MAX_PRINTER_DEVICES];
 
 static BYTE _PrintFontCommand( BYTE printer, BYTE transferFlags );
 static BYTE _PrintStaticCommand( BYTE address, char *command, BYTE transferFlags );
+static WORD _PackBitsRow( BYTE *dest, BYTE *row, WORD length, WORD rowLength, BYTE endMask );
 
 
 // *****************************************************************************
@@ -819,6 +823,62 @@ BYTE USBHostPrinterLanguagePCL5( BYTE address,
             return USBHostPrinterWrite( address, buffer, size, transferFlags );
             break;
 
+        //---------------------------------------------------------------------
+        case USB_PRINTER_IMAGE_DATA_BAND:
+            // Each row is flipped and masked as for USB_PRINTER_IMAGE_DATA,
+            // trailing white bytes are dropped, and the rest of the row is
+            // compressed with method 2 (TIFF PackBits).  The whole band is sent
+            // in one transfer from the output buffer of the band.
+            {
+                USB_PRINTER_IMAGE_BAND  *band;
+                char                    header[12];
+                WORD                    headerLength;
+                WORD                    length;
+                WORD                    packedLength;
+                BYTE                    *row;
+                WORD                    rowCount;
+                WORD                    rowLength;
+                DWORD                   used;
+
+                band        = (USB_PRINTER_IMAGE_BAND *)(data.pointerRAM);
+                rowLength   = (WORD)((size + 7) / 8);
+
+                if ((transferFlags & (USB_PRINTER_TRANSFER_COPY_DATA | USB_PRINTER_TRANSFER_FROM_ROM)) ||
+                    (band->outputSize < USB_PRINTER_IMAGE_BAND_SIZE( rowLength, band->rowCount )))
+                {
+                    return USB_PRINTER_BAD_PARAMETER;
+                }
+
+                strcpy( (char *)band->output, COMMAND_RASTER_COMPRESSION_TIFF );
+                used = strlen( (char *)band->output );
+
+                row = band->rows;
+                for (rowCount = 0; rowCount < band->rowCount; rowCount++)
+                {
+                    // Find the last byte with a black pixel.  The printer
+                    // fills the rest of the row with white.
+                    length = rowLength;
+                    while ((length > 0) && ((BYTE)(~row[length-1] & ((length == rowLength) ? printerListPCL[printer].imageEndMask : 0xFF)) == 0))
+                    {
+                        length--;
+                    }
+
+                    // Compress the row after the longest possible header, then
+                    // move it down behind the actual header.
+                    packedLength = _PackBitsRow( &(band->output[used + sizeof(header)]), row, length, rowLength, printerListPCL[printer].imageEndMask );
+                    sprintf( header, COMMAND_RASTER_DATA, packedLength );
+                    headerLength = strlen( header );
+                    memmove( &(band->output[used + headerLength]), &(band->output[used + sizeof(header)]), packedLength );
+                    memcpy( &(band->output[used]), header, headerLength );
+                    used += headerLength + packedLength;
+
+                    row += band->rowBytes;
+                }
+
+                return USBHostPrinterWrite( address, band->output, used, transferFlags );
+            }
+            break;
+
         //---------------------------------------------------------------------
         case USB_PRINTER_IMAGE_STOP:
             if (USING_VECTOR_GRAPHICS)
@@ -1694,4 +1754,88 @@ static BYTE _PrintFontCommand( BYTE printer, BYTE transferFlags )
 }
 
 
+/****************************************************************************
+  Function:
+    static WORD _PackBitsRow( BYTE *dest, BYTE *row, WORD length,
+                    WORD rowLength, BYTE endMask )
+
+  Description:
+    This function compresses one row of raster data with PCL compression
+    method 2 (TIFF PackBits).  The row is flipped to the PCL polarity, and
+    the last byte of the row is masked, as it is compressed.  A run of two or
+    more identical bytes is sent as a count from -1 to -127 followed by the
+    byte.  Other bytes are sent as a count from 0 to 127 followed by one to
+    128 literal bytes.
+
+  Preconditions:
+    None
+
+  Parameters:
+    BYTE *dest      - Buffer for the compressed data.  It must hold at least
+                        length + (length + 127) / 128 bytes.
+    BYTE *row       - Row of image data, in the format of the
+                        USB_PRINTER_IMAGE_DATA command.
+    WORD length     - Number of bytes of the row to compress.
+    WORD rowLength  - Number of bytes in the whole row.
+    BYTE endMask    - Mask for the last byte of the whole row.
+
+  Returns:
+    The number of bytes of compressed data.
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+static WORD _PackBitsRow( BYTE *dest, BYTE *row, WORD length, WORD rowLength, BYTE endMask )
+{
+    #define _RowByte(n)     ((BYTE)(~row[n] & (((n) == rowLength - 1) ? endMask : 0xFF)))
+
+    WORD    count;
+    WORD    i;
+    WORD    packed;
+    BYTE    value;
+
+    packed  = 0;
+    i       = 0;
+    while (i < length)
+    {
+        value = _RowByte( i );
+        count = 1;
+        while ((i + count < length) && (count < 128) && (_RowByte( i + count ) == value))
+        {
+            count++;
+        }
+
+        if (count > 1)
+        {
+            // Repeated byte.
+            dest[packed++]  = (BYTE)(1 - count);
+            dest[packed++]  = value;
+            i += count;
+        }
+        else
+        {
+            // Literal bytes, up to the start of a run of three.
+            count = 0;
+            packed++;
+            while ((i < length) && (count < 128))
+            {
+                if ((i + 2 < length) && (_RowByte( i + 1 ) == _RowByte( i )) && (_RowByte( i + 2 ) == _RowByte( i )))
+                {
+                    break;
+                }
+                dest[packed++] = _RowByte( i );
+                i++;
+                count++;
+            }
+            dest[packed - count - 1] = (BYTE)(count - 1);
+        }
+    }
+
+    return packed;
+
+    #undef _RowByte
+}
+
+
 #endif
@@ -57,6 +57,8 @@ Change History:
 
   2.7         Changed the interface to _SetCurrentPosition to be able to
               take in the printer number as a parameter.
+
+  2.9j        Added the USB_PRINTER_IMAGE_DATA_BAND command.
 *******************************************************************************/
 //DOM-IGNORE-END
 
@@ -638,6 +640,56 @@ BYTE USBHostPrinterLanguagePostScript( BYTE address,
             }
             break;
 
+        //---------------------------------------------------------------------
+        case USB_PRINTER_IMAGE_DATA_BAND:
+            // Each row is translated to ASCII as for USB_PRINTER_IMAGE_DATA,
+            // and ended with a new line, which PostScript ignores inside the
+            // hexadecimal string.  The image data is a string, so it is not
+            // compressed.  The whole band is sent in one transfer from the
+            // output buffer of the band.
+            {
+                USB_PRINTER_IMAGE_BAND  *band;
+                WORD                    i;
+                BYTE                    *row;
+                WORD                    rowCount;
+                char                    *tempNew;
+
+                band = (USB_PRINTER_IMAGE_BAND *)(data.pointerRAM);
+
+                if ((transferFlags & (USB_PRINTER_TRANSFER_COPY_DATA | USB_PRINTER_TRANSFER_FROM_ROM)) ||
+                    (band->outputSize < USB_PRINTER_IMAGE_BAND_SIZE( (size + 7) / 8, band->rowCount )))
+                {
+                    return USB_PRINTER_BAD_PARAMETER;
+                }
+
+                // Determine the number of data nibbles in each row.
+                size += 3;
+                size /= 4;
+
+                tempNew = (char *)band->output;
+                row     = band->rows;
+                for (rowCount = 0; rowCount < band->rowCount; rowCount++)
+                {
+                    for (i=0; i<size; i++)
+                    {
+                        if (!(i & 0x01))
+                        {
+                            *tempNew++ = _psCharacterArray[(row[i/2] >> 4) & 0x0F];
+                        }
+                        else
+                        {
+                            *tempNew++ = _psCharacterArray[row[i/2] & 0x0F];
+                        }
+                    }
+                    *tempNew++ = '\n';
+
+                    row += band->rowBytes;
+                }
+
+                return USBHostPrinterWrite( printerListPostScript[printer].deviceAddress, band->output, (BYTE *)tempNew - band->output, transferFlags );
+            }
+            break;
+
         //---------------------------------------------------------------------
         case USB_PRINTER_IMAGE_STOP:
             return _PrintStaticCommand( address, COMMAND_IMAGE_STOP, transferFlags );
@@ -51,6 +51,9 @@ Change History:
   ----------  ----------------------------------------------------------
   2.6 - 2.6a  No change
 
+  2.9j        Added the band buffered PrintScreen(), enabled by
+              USB_PRINTER_PRINT_SCREEN_BAND_ROWS.
+
 *******************************************************************************/
 //DOM-IGNORE-END
 
@@ -79,6 +82,18 @@ Change History:
 #ifdef USE_GRAPHICS_LIBRARY_PRINTER_INTERFACE
 
 
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Prototypes
+// *****************************************************************************
+// *****************************************************************************
+
+#ifdef USB_PRINTER_PRINT_SCREEN_BAND_ROWS
+    static SHORT _PrintScreenBand( BYTE address, USB_PRINT_SCREEN_INFO *printScreenInfo );
+    static void  _PrintScreenReadRow( USB_PRINT_SCREEN_INFO *printScreenInfo, WORD imageLine, BYTE lineDepth, BYTE *oneRow );
+#endif
+
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Subroutines
@@ -135,7 +150,12 @@ Change History:
                 be returned upon successful completion.
 
   Remarks:
-    None
+    If USB_PRINTER_PRINT_SCREEN_BAND_ROWS is defined, the image is sent in
+    bands of that many rows with the USB_PRINTER_IMAGE_DATA_BAND command.
+    Two band buffers are used in turn, so the next band is read from the
+    display while the previous one is sent to the printer.  In this mode,
+    the function does not report completion until the printer has received
+    the whole image, so the buffers can be released.
   ***************************************************************************/
 
 #define PRINT_SCREEN_STATE_BEGIN        0
@@ -143,11 +163,26 @@ Change History:
 #define PRINT_SCREEN_STATE_SEND_HEADER  2
 #define PRINT_SCREEN_STATE_SEND_DATA    3
 #define PRINT_SCREEN_STATE_SEND_STOP    4
+#define PRINT_SCREEN_STATE_SEND_BAND    5
+#define PRINT_SCREEN_STATE_FINISH       6
 
 
 SHORT PrintScreen( BYTE address, USB_PRINT_SCREEN_INFO *printScreenInfo )
 {
-    #ifdef USE_NONBLOCKING_CONFIG
+    #if defined( USB_PRINTER_PRINT_SCREEN_BAND_ROWS )
+        #ifdef USE_NONBLOCKING_CONFIG
+            return _PrintScreenBand( address, printScreenInfo );
+        #else
+            SHORT   returnCode;
+
+            while ((returnCode = _PrintScreenBand( address, printScreenInfo )) == 0)
+            {
+                USBTasks();
+            }
+            return returnCode;
+        #endif
+
+    #elif defined( USE_NONBLOCKING_CONFIG )
         static WORD     imageLine;
         WORD            imagePixel;
         static BYTE     lineDepth;
@@ -466,5 +501,286 @@ SHORT PrintScreen( BYTE address, USB_PRINT_SCREEN_INFO *printScreenInfo )
 
 
 
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Functions
+// *****************************************************************************
+// *****************************************************************************
+
+#ifdef USB_PRINTER_PRINT_SCREEN_BAND_ROWS
+
+/****************************************************************************
+  Function:
+    static SHORT _PrintScreenBand( BYTE address,
+                    USB_PRINT_SCREEN_INFO *printScreenInfo )
+
+  Description:
+    This routine is the state machine of the band buffered PrintScreen().
+    USB_PRINTER_PRINT_SCREEN_BAND_ROWS rows of the image are read from the
+    display into a band, and the printer language formats the band into one
+    of two output buffers.  Before an output buffer is used again, the
+    routine waits until the printer has received its previous contents.
+    After the image has been sent, the routine waits until both output
+    buffers have been received, and then releases all the buffers.
+
+  Precondition:
+    None
+
+  Parameters:
+    BYTE address                            - USB address of the printer.
+    USB_PRINT_SCREEN_INFO *printScreenInfo  - Information about the screen
+                            area to print.
+
+  Return Values:
+    0       -   Image output is not yet complete, but is proceeding normally.
+    (-1)    -   Image output was completed successfully.
+    other   -   Printing was aborted due to an error.  See the return values
+                for USBHostPrinterCommand().
+
+  Remarks:
+    USBTasks() must be called between calls to this routine.
+  ***************************************************************************/
+
+static SHORT _PrintScreenBand( BYTE address, USB_PRINT_SCREEN_INFO *printScreenInfo )
+{
+    static BYTE     *bandRows       = NULL;
+    static BYTE     *bandOutput[2]  = { NULL, NULL };
+    static DWORD    bandOutputSize;
+    static BYTE     currentOutput;
+    static WORD     imageLine;
+    static BYTE     lineDepth;
+    static BYTE     returnCode;
+    static WORD     rowLength;
+    static BYTE     state           = PRINT_SCREEN_STATE_BEGIN;
+
+    switch (state)
+    {
+        case PRINT_SCREEN_STATE_BEGIN:
+            printScreenInfo->printerInfo.width  = printScreenInfo->xR - printScreenInfo->xL + 1;
+            printScreenInfo->printerInfo.height = printScreenInfo->yB - printScreenInfo->yT + 1;
+
+            lineDepth = 1;
+            if (printScreenInfo->printerType.supportFlags.supportsPOS)
+            {
+                if (printScreenInfo->printerInfo.densityVertical == 24)
+                {
+                    lineDepth = 3;
+                }
+                else if (printScreenInfo->printerInfo.densityVertical == 36)
+                {
+                    lineDepth = 5;
+                }
+                rowLength = printScreenInfo->printerInfo.width * lineDepth;
+            }
+            else
+            {
+                rowLength = (printScreenInfo->printerInfo.width + 7) / 8;
+            }
+
+            bandOutputSize  = USB_PRINTER_IMAGE_BAND_SIZE( rowLength, USB_PRINTER_PRINT_SCREEN_BAND_ROWS );
+            bandRows        = (BYTE *)USB_MALLOC( rowLength * USB_PRINTER_PRINT_SCREEN_BAND_ROWS );
+            bandOutput[0]   = (BYTE *)USB_MALLOC( bandOutputSize );
+            bandOutput[1]   = (BYTE *)USB_MALLOC( bandOutputSize );
+            if ((bandRows == NULL) || (bandOutput[0] == NULL) || (bandOutput[1] == NULL))
+            {
+                returnCode  = USB_PRINTER_OUT_OF_MEMORY;
+                state       = PRINT_SCREEN_STATE_FINISH;
+                return 0;
+            }
+
+            imageLine       = 0;
+            currentOutput   = 0;
+            returnCode      = USB_PRINTER_SUCCESS;
+            state           = PRINT_SCREEN_STATE_SEND_START;
+            // Fall through.
+
+        case PRINT_SCREEN_STATE_SEND_START:
+            if (!USBHostPrinterCommandReady( address ))
+            {
+                return 0;
+            }
+
+            returnCode = USBHostPrinterCommand( address, USB_PRINTER_IMAGE_START,
+                        USB_DATA_POINTER_RAM(&(printScreenInfo->printerInfo)), sizeof(printScreenInfo->printerInfo), 0 );
+            state = returnCode ? PRINT_SCREEN_STATE_FINISH : PRINT_SCREEN_STATE_SEND_BAND;
+            return 0;
+            break;
+
+        case PRINT_SCREEN_STATE_SEND_BAND:
+            // Wait until the printer has received the last band sent from
+            // this buffer.
+            if (USBHostPrinterWriteIsQueued( address, bandOutput[currentOutput] ) ||
+                !USBHostPrinterCommandReady( address ))
+            {
+                return 0;
+            }
+
+            {
+                USB_PRINTER_IMAGE_BAND  band;
+
+                band.rows       = bandRows;
+                band.output     = bandOutput[currentOutput];
+                band.rowBytes   = rowLength;
+                band.rowCount   = 0;
+                band.outputSize = bandOutputSize;
+
+                while ((band.rowCount < USB_PRINTER_PRINT_SCREEN_BAND_ROWS) && (imageLine < printScreenInfo->printerInfo.height))
+                {
+                    _PrintScreenReadRow( printScreenInfo, imageLine, lineDepth, &(bandRows[band.rowCount * rowLength]) );
+                    band.rowCount++;
+
+                    if (printScreenInfo->printerType.supportFlags.supportsPOS)
+                    {
+                        imageLine += printScreenInfo->printerInfo.densityVertical;
+                    }
+                    else
+                    {
+                        imageLine++;
+                    }
+                }
+
+                returnCode = USBHostPrinterCommand( address, USB_PRINTER_IMAGE_DATA_BAND,
+                            USB_DATA_POINTER_RAM(&band), printScreenInfo->printerInfo.width, 0 );
+            }
+
+            currentOutput ^= 1;
+            if (returnCode)
+            {
+                state = PRINT_SCREEN_STATE_FINISH;
+            }
+            else if (imageLine >= printScreenInfo->printerInfo.height)
+            {
+                state = PRINT_SCREEN_STATE_SEND_STOP;
+            }
+            return 0;
+            break;
+
+        case PRINT_SCREEN_STATE_SEND_STOP:
+            if (!USBHostPrinterCommandReady( address ))
+            {
+                return 0;
+            }
+
+            returnCode  = USBHostPrinterCommand( address, USB_PRINTER_IMAGE_STOP, USB_NULL, 0, 0 );
+            state       = PRINT_SCREEN_STATE_FINISH;
+            return 0;
+            break;
+
+        case PRINT_SCREEN_STATE_FINISH:
+            // The buffers cannot be released until the printer has received
+            // them.
+            if (USBHostPrinterWriteIsQueued( address, bandOutput[0] ) ||
+                USBHostPrinterWriteIsQueued( address, bandOutput[1] ))
+            {
+                return 0;
+            }
+
+            if (bandRows != NULL)
+            {
+                USB_FREE_AND_CLEAR( bandRows );
+            }
+            if (bandOutput[0] != NULL)
+            {
+                USB_FREE_AND_CLEAR( bandOutput[0] );
+            }
+            if (bandOutput[1] != NULL)
+            {
+                USB_FREE_AND_CLEAR( bandOutput[1] );
+            }
+
+            state = PRINT_SCREEN_STATE_BEGIN;
+            if (returnCode)
+            {
+                return returnCode;
+            }
+            return -1;  // The image completed successfully.
+            break;
+    }
+
+    return 0;
+}
+
+
+/****************************************************************************
+  Function:
+    static void _PrintScreenReadRow( USB_PRINT_SCREEN_INFO *printScreenInfo,
+                    WORD imageLine, BYTE lineDepth, BYTE *oneRow )
+
+  Description:
+    This routine reads one row of the image from the display, in the format
+    of the USB_PRINTER_IMAGE_DATA command.  For POS printers, the row is
+    lineDepth bytes high.
+
+  Precondition:
+    None
+
+  Parameters:
+    USB_PRINT_SCREEN_INFO *printScreenInfo  - Information about the screen
+                            area to print.
+    WORD imageLine  - First line of the row, relative to the top of the image.
+    BYTE lineDepth  - Number of bytes in each column of a POS row.
+    BYTE *oneRow    - Buffer for the row.
+
+  Returns:
+    None
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+static void _PrintScreenReadRow( USB_PRINT_SCREEN_INFO *printScreenInfo, WORD imageLine, BYTE lineDepth, BYTE *oneRow )
+{
+    WORD    imagePixel;
+    BYTE    mask;
+
+    if (printScreenInfo->printerType.supportFlags.supportsPOS)
+    {
+        WORD    i;
+        WORD    j;
+
+        memset( oneRow, 0xFF, printScreenInfo->printerInfo.width * lineDepth );
+        mask = 0x80;
+        for (imagePixel=0; imagePixel<printScreenInfo->printerInfo.width; imagePixel++)
+        {
+            for (i=0; i<lineDepth; i++)
+            {
+                for (j=0; j<8; j++)
+                {
+                    if (((imageLine + (i*8) + j) < printScreenInfo->printerInfo.height) &&
+                        (GetPixel( printScreenInfo->xL + imagePixel, printScreenInfo->yT + imageLine + (i*8) + j) == printScreenInfo->colorBlack))
+                    {
+                        oneRow[imagePixel*lineDepth + i] &= ~mask;
+                    }
+                    mask >>= 1;
+                    if (mask == 0)
+                    {
+                        mask = 0x80;
+                    }
+                }
+            }
+        }
+    }
+    else
+    {
+        memset( oneRow, 0, (printScreenInfo->printerInfo.width + 7) / 8 );
+        mask = 0x80;
+        for (imagePixel=0; imagePixel<printScreenInfo->printerInfo.width; imagePixel++)
+        {
+            if (GetPixel( printScreenInfo->xL + imagePixel, printScreenInfo->yT + imageLine ) != printScreenInfo->colorBlack)
+            {
+                oneRow[imagePixel/8] |= mask;
+            }
+            mask >>= 1;
+            if (mask == 0)
+            {
+                mask = 0x80;
+            }
+        }
+    }
+}
+
+#endif
+
+
 #endif
 
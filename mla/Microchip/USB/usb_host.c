@@ -68,6 +68,16 @@ Change History:
   2.9d        Fixed PIC32 USB register mapping to be more universal
               Fixed a race condition between 1msec timer and USB device stack
 
+  2.9j        The transfer scheduler budgets the bus time of each frame.
+              Isochronous and interrupt bandwidth is reserved when a
+              configuration or interface setting is selected, periodic
+              transfers are sent ahead of control and bulk transfers, and bulk
+              endpoints are serviced round robin across frames.
+
+              USBHostTransferIsComplete() also returns the byte count when a
+              transfer ends with an error, so data received before a NAK
+              timeout is not lost.
+
 *******************************************************************************/
 
 #include <stdlib.h>
@@ -94,6 +104,13 @@ Change History:
     #include "struct_queue.h"
 #endif
 
+// Records the completion time in the event data of a transfer.
+#if defined( USB_HOST_TRANSFER_TIMESTAMP )
+    #define _USB_SetTransferTimestamp(pData)    (pData)->timestamp = USB_HOST_TRANSFER_TIMESTAMP()
+#else
+    #define _USB_SetTransferTimestamp(pData)
+#endif
+
 // *****************************************************************************
 // Low Level Functionality Configurations.
 
@@ -617,6 +634,9 @@ void USBHostIsochronousBuffersReset( ISOCHRONOUS_DATA * isocData, BYTE numberOfB
     USB_ENDPOINT_BUSY           - A read or write is already in progress
     USB_ILLEGAL_REQUEST         - SET CONFIGURATION cannot be performed with
                                     this function.
+    USB_ERROR_INSUFFICIENT_BANDWIDTH - The isochronous and interrupt
+                                    endpoints of the requested interface
+                                    setting do not fit in the frame.
 
   Remarks:
     DTS reset is done before the command is issued.
@@ -693,6 +713,13 @@ BYTE USBHostIssueDeviceRequest( BYTE deviceAddress, BYTE bmRequestType, BYTE bRe
             return USB_ILLEGAL_REQUEST;
         }
 
+        // Make sure the periodic endpoints of the new setting fit in the
+        // frame together with those of the other interfaces.
+        if (_USB_PeriodicByteTimes( usbDeviceInfo.pInterfaceList, pInterface, pSetting ) > USB_FRAME_PERIODIC_BYTE_TIMES)
+        {
+            return USB_ERROR_INSUFFICIENT_BANDWIDTH;
+        }
+
         // Set the pointer to the new setting.
         pInterface->pCurrentSetting = pSetting;
     }
@@ -1369,6 +1396,9 @@ void USBHostTasks( void )
                     usbDeviceInfo.flags.val             = 0;
                     usbDeviceInfo.pInterfaceList        = NULL;
                     usbBusInfo.flags.val                = 0;
+                    usbBusInfo.wFrameByteTimes          = 0;
+                    usbBusInfo.wTokenByteTimes          = 0;
+                    usbBusInfo.lastBulkTransaction      = 0;
                     
                     // Set up the hardware.
                     U1IE                = 0;        // Clear and turn off interrupts.
@@ -2500,7 +2530,8 @@ void USBHostTerminateTransfer( BYTE deviceAddress, BYTE endpoint )
     BYTE endpoint       - Endpoint number
     BYTE *errorCode     - Error code indicating the status of the transfer.
                             Only valid if the transfer is complete.
-    DWORD *byteCount    - The number of bytes sent or received.  Invalid
+    DWORD *byteCount    - The number of bytes sent or received, also
+                            when the transfer ended with an error.  Invalid
                             for isochronous transfers.
 
   Return Values:
@@ -2551,10 +2582,12 @@ BOOL USBHostTransferIsComplete( BYTE deviceAddress, BYTE endpoint, BYTE *errorCo
         transferComplete = ep->status.bfTransferComplete;
 
         // Set up error code.  This is only valid if the transfer is complete.
+        // The byte count is returned on errors too, so a client can keep the
+        // data received before a NAK timeout.
+        *byteCount = ep->dataCount;
         if (ep->status.bfTransferSuccessful)
         {
             *errorCode = USB_SUCCESS;
-            *byteCount = ep->dataCount;
         }
         else if (ep->status.bfStalled)
         {
@@ -3119,7 +3152,12 @@ USB_INTERFACE_INFO * _USB_FindInterface ( BYTE bInterface, BYTE bAltSetting )
 
   Description:
     This function determines the next token to send of all current pending
-    transfers.
+    transfers.  Each frame, the isochronous and interrupt endpoints that are
+    due are serviced first, since their bus time was reserved when the
+    configuration or interface setting was selected.  Then one control
+    transaction is allowed, and bulk transfers use the rest of the frame,
+    one packet at a time for each bulk endpoint in turn.  A bulk token is not
+    written if the transaction might not finish before the end of the frame.
 
   Precondition:
     None
@@ -3155,428 +3193,147 @@ void _USB_FindNextToken( void )
         return;
     }
 
-    // We will handle control transfers first.  We only allow one control
-    // transfer per frame.
-    if (!usbBusInfo.flags.bfControlTransfersDone)
-    {
-        // Look for any control transfers.
-        if (_USB_FindServiceEndpoint( USB_TRANSFER_TYPE_CONTROL ))
-        {
-            switch (pCurrentEndpoint->transferState & TSTATE_MASK)
-            {
-                case TSTATE_CONTROL_NO_DATA:
-                    switch (pCurrentEndpoint->transferState & TSUBSTATE_MASK)
-                    {
-                        case TSUBSTATE_CONTROL_NO_DATA_SETUP:
-                            _USB_SetDATA01( DTS_DATA0 );
-                            _USB_SetBDT( USB_TOKEN_SETUP );
-                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_SETUP );
-                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
-                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
-                            #endif
-                            return;
-                            break;
+    #ifdef USB_SUPPORT_ISOCHRONOUS_TRANSFERS
+        // We will handle isochronous transfers first.  The maximum packet size
+        // for an isochronous transfer is 1023 bytes, so we cannot use the
+        // threshold register (U1SOF) to ensure that we do not write too many
+        // tokens during a frame.  Instead, the bus time of the isochronous and
+        // interrupt endpoints is reserved when the configuration or interface
+        // setting is selected, and limited to 90% of the frame.  Since they are
+        // serviced at the start of the frame, they always fit.
 
-                        case TSUBSTATE_CONTROL_NO_DATA_ACK:
-                            pCurrentEndpoint->dataCountMax = pCurrentEndpoint->dataCount;
-                            _USB_SetDATA01( DTS_DATA1 );
-                            _USB_SetBDT( USB_TOKEN_IN );
-                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_IN );
-                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
-                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
-                            #endif
-                            return;
-                            break;
+        // Due to the nature of isochronous transfers, transfer events must be used.
+        #if !defined( USB_ENABLE_TRANSFER_EVENT )
+            #error Transfer events are required for isochronous transfers
+        #endif
 
-                        case TSUBSTATE_CONTROL_NO_DATA_COMPLETE:
-                            pCurrentEndpoint->transferState               = TSTATE_IDLE;
-                            pCurrentEndpoint->status.bfTransferComplete   = 1;
-                            #if defined( USB_ENABLE_TRANSFER_EVENT )
-                                if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
+        if (!usbBusInfo.flags.bfIsochronousTransfersDone)
+        {
+            // Look for any isochronous operations.
+            while (_USB_FindServiceEndpoint( USB_TRANSFER_TYPE_ISOCHRONOUS ))
+            {
+                switch (pCurrentEndpoint->transferState & TSTATE_MASK)
+                {
+                    case TSTATE_ISOCHRONOUS_READ:
+                        switch (pCurrentEndpoint->transferState & TSUBSTATE_MASK)
+                        {
+                            case TSUBSTATE_ISOCHRONOUS_READ_DATA:
+                                // Don't overwrite data the user has not yet processed.  We will skip this interval.    
+                                if (((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].bfDataLengthValid)
                                 {
-                                    USB_EVENT_DATA *data;
-
-                                    data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
-                                    data->event = EVENT_TRANSFER;
-                                    data->TransferData.dataCount        = pCurrentEndpoint->dataCount;
-                                    data->TransferData.pUserData        = pCurrentEndpoint->pUserData;
-                                    data->TransferData.bErrorCode       = USB_SUCCESS;
-                                    data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
-                                    data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
-                                    data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                    // We have buffer overflow.
                                 }
                                 else
                                 {
-                                    pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
-                                }
-                            #endif
-                    break;
+                                    // Initialize the data buffer.
+                                    ((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].bfDataLengthValid = 0;
+                                    pCurrentEndpoint->dataCount = 0;
 
-                        case TSUBSTATE_ERROR:
-                            pCurrentEndpoint->transferState               = TSTATE_IDLE;
-                            pCurrentEndpoint->status.bfTransferComplete   = 1;
-                            #if defined( USB_ENABLE_TRANSFER_EVENT )
-                                if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
-                                {
-                                    USB_EVENT_DATA *data;
+                                    _USB_SetDATA01( DTS_DATA0 );    // Always DATA0 for isochronous
+                                    _USB_SetBDT( USB_TOKEN_IN );
+                                    _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_IN );
+                                    return;
+                                }    
+                                break;
 
-                                    data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
-                                    data->event = EVENT_BUS_ERROR;
-                                    data->TransferData.dataCount        = 0;
-                                    data->TransferData.pUserData        = NULL;
-                                    data->TransferData.bErrorCode       = pCurrentEndpoint->bErrorCode;
-                                    data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
-                                    data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
-                                    data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
-                                }
-                                else
+                            case TSUBSTATE_ISOCHRONOUS_READ_COMPLETE:
+                                // Isochronous transfers are continuous until the user stops them.
+                                // Send an event that there is new data, and reset for the next
+                                // interval.
+                                pCurrentEndpoint->transferState     = TSTATE_ISOCHRONOUS_READ | TSUBSTATE_ISOCHRONOUS_READ_DATA;
+                                pCurrentEndpoint->wIntervalCount    = pCurrentEndpoint->wInterval;
+
+                                // Update the valid data length for this buffer.
+                                ((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].dataLength = pCurrentEndpoint->dataCount;
+                                ((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].bfDataLengthValid = 1;
+                                #if defined( USB_ENABLE_ISOC_TRANSFER_EVENT )
+                                    if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
+                                    {
+                                        USB_EVENT_DATA *data;
+
+                                        data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
+                                        data->event = EVENT_TRANSFER;
+                                        data->TransferData.dataCount        = pCurrentEndpoint->dataCount;
+                                        data->TransferData.pUserData        = ((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].pBuffer;
+                                        data->TransferData.bErrorCode       = USB_SUCCESS;
+                                        data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
+                                        data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
+                                        data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                        _USB_SetTransferTimestamp( &data->TransferData );
+                                    }
+                                    else
+                                    {
+                                        pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
+                                    }
+                                #endif
+                                
+                                // If the user wants an event from the interrupt handler to handle the data as quickly as
+                                // possible, send up the event.  Then mark the packet as used.
+                                #ifdef USB_HOST_APP_DATA_EVENT_HANDLER
+                                    usbClientDrvTable[pCurrentEndpoint->clientDriver].DataEventHandler( usbDeviceInfo.deviceAddress, EVENT_DATA_ISOC_READ, ((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].pBuffer, pCurrentEndpoint->dataCount );
+                                    ((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].bfDataLengthValid = 0;
+                                #endif
+                                
+                                // Move to the next data buffer.
+                                ((ISOCHRONOUS_DATA *)pCurrentEndpoint->pUserData)->currentBufferUSB++;
+                                if (((ISOCHRONOUS_DATA *)pCurrentEndpoint->pUserData)->currentBufferUSB >= ((ISOCHRONOUS_DATA *)pCurrentEndpoint->pUserData)->totalBuffers)
                                 {
-                                    pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
+                                    ((ISOCHRONOUS_DATA *)pCurrentEndpoint->pUserData)->currentBufferUSB = 0;
                                 }
-                            #endif
-                            break;
-
-                        default:
-                            illegalState = TRUE;
-                            break;
-                    }
-                    break;
+                                break;
 
-                case TSTATE_CONTROL_READ:
-                    switch (pCurrentEndpoint->transferState & TSUBSTATE_MASK)
-                    {
-                        case TSUBSTATE_CONTROL_READ_SETUP:
-                            _USB_SetDATA01( DTS_DATA0 );
-                            _USB_SetBDT( USB_TOKEN_SETUP );
-                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_SETUP );
-                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
-                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
-                            #endif
-                            return;
-                            break;
+                            case TSUBSTATE_ERROR:
+                                // Isochronous transfers are continuous until the user stops them.
+                                // Send an event that there is an error, and reset for the next
+                                // interval.
+                                pCurrentEndpoint->transferState     = TSTATE_ISOCHRONOUS_READ | TSUBSTATE_ISOCHRONOUS_READ_DATA;
+                                pCurrentEndpoint->wIntervalCount    = pCurrentEndpoint->wInterval;
+                                #if defined( USB_ENABLE_TRANSFER_EVENT )
+                                    if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
+                                    {
+                                        USB_EVENT_DATA *data;
 
-                        case TSUBSTATE_CONTROL_READ_DATA:
-                            _USB_SetBDT( USB_TOKEN_IN );
-                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_IN );
-                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
-                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
-                            #endif
-                            return;
-                            break;
+                                        data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
+                                        data->event = EVENT_BUS_ERROR;
+                                        data->TransferData.dataCount        = 0;
+                                        data->TransferData.pUserData        = NULL;
+                                        data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
+                                        data->TransferData.bErrorCode       = pCurrentEndpoint->bErrorCode;
+                                        data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
+                                        data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                        _USB_SetTransferTimestamp( &data->TransferData );
+                                    }
+                                    else
+                                    {
+                                        pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
+                                    }
+                                #endif
+                                break;
 
-                        case TSUBSTATE_CONTROL_READ_ACK:
-                            pCurrentEndpoint->dataCountMax = pCurrentEndpoint->dataCount;
-                            _USB_SetDATA01( DTS_DATA1 );
-                            _USB_SetBDT( USB_TOKEN_OUT );
-                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_OUT );
-                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
-                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
-                            #endif
-                            return;
-                            break;
+                            default:
+                                illegalState = TRUE;
+                                break;
+                        }
+                        break;
 
-                        case TSUBSTATE_CONTROL_READ_COMPLETE:
-                            pCurrentEndpoint->transferState               = TSTATE_IDLE;
-                            pCurrentEndpoint->status.bfTransferComplete   = 1;
-                            #if defined( USB_ENABLE_TRANSFER_EVENT )
-                                if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
+                    case TSTATE_ISOCHRONOUS_WRITE:
+                        switch (pCurrentEndpoint->transferState & TSUBSTATE_MASK)
+                        {
+                            case TSUBSTATE_ISOCHRONOUS_WRITE_DATA:
+                                if (!((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].bfDataLengthValid)
                                 {
-                                    USB_EVENT_DATA *data;
-
-                                    data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
-                                    data->event = EVENT_TRANSFER;
-                                    data->TransferData.dataCount        = pCurrentEndpoint->dataCount;
-                                    data->TransferData.pUserData        = pCurrentEndpoint->pUserData;
-                                    data->TransferData.bErrorCode       = USB_SUCCESS;
-                                    data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
-                                    data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
-                                    data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                    // We have buffer underrun.
                                 }
                                 else
                                 {
-                                    pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
-                                }
-                            #endif
-                            break;
+                                    pCurrentEndpoint->dataCount = ((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].dataLength;
 
-                        case TSUBSTATE_ERROR:
-                            pCurrentEndpoint->transferState               = TSTATE_IDLE;
-                            pCurrentEndpoint->status.bfTransferComplete   = 1;
-                            #if defined( USB_ENABLE_TRANSFER_EVENT )
-                                if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
-                                {
-                                    USB_EVENT_DATA *data;
-
-                                    data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
-                                    data->event = EVENT_BUS_ERROR;
-                                    data->TransferData.dataCount        = 0;
-                                    data->TransferData.pUserData        = NULL;
-                                    data->TransferData.bErrorCode       = pCurrentEndpoint->bErrorCode;
-                                    data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
-                                    data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
-                                    data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
-                                }
-                                else
-                                {
-                                    pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
-                                }
-                            #endif
-                            break;
-
-                        default:
-                            illegalState = TRUE;
-                            break;
-                    }
-                    break;
-
-                case TSTATE_CONTROL_WRITE:
-                    switch (pCurrentEndpoint->transferState & TSUBSTATE_MASK)
-                    {
-                        case TSUBSTATE_CONTROL_WRITE_SETUP:
-                            _USB_SetDATA01( DTS_DATA0 );
-                            _USB_SetBDT( USB_TOKEN_SETUP );
-                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_SETUP );
-                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
-                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
-                            #endif
-                            return;
-                            break;
-
-                        case TSUBSTATE_CONTROL_WRITE_DATA:
-                            _USB_SetBDT( USB_TOKEN_OUT );
-                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_OUT );
-                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
-                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
-                            #endif
-                            return;
-                            break;
-
-                        case TSUBSTATE_CONTROL_WRITE_ACK:
-                            pCurrentEndpoint->dataCountMax = pCurrentEndpoint->dataCount;
-                            _USB_SetDATA01( DTS_DATA1 );
-                            _USB_SetBDT( USB_TOKEN_IN );
-                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_IN );
-                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
-                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
-                            #endif
-                            return;
-                            break;
-
-                        case TSUBSTATE_CONTROL_WRITE_COMPLETE:
-                            pCurrentEndpoint->transferState               = TSTATE_IDLE;
-                            pCurrentEndpoint->status.bfTransferComplete   = 1;
-                            #if defined( USB_ENABLE_TRANSFER_EVENT )
-                                if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
-                                {
-                                    USB_EVENT_DATA *data;
-
-                                    data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
-                                    data->event = EVENT_TRANSFER;
-                                    data->TransferData.dataCount        = pCurrentEndpoint->dataCount;
-                                    data->TransferData.pUserData        = pCurrentEndpoint->pUserData;
-                                    data->TransferData.bErrorCode       = USB_SUCCESS;
-                                    data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
-                                    data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
-                                    data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
-                                }
-                                else
-                                {
-                                    pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
-                                }
-                            #endif
-                            break;
-
-                        case TSUBSTATE_ERROR:
-                            pCurrentEndpoint->transferState               = TSTATE_IDLE;
-                            pCurrentEndpoint->status.bfTransferComplete   = 1;
-                            #if defined( USB_ENABLE_TRANSFER_EVENT )
-                                if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
-                                {
-                                    USB_EVENT_DATA *data;
-
-                                    data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
-                                    data->event = EVENT_BUS_ERROR;
-                                    data->TransferData.dataCount        = 0;
-                                    data->TransferData.pUserData        = NULL;
-                                    data->TransferData.bErrorCode       = pCurrentEndpoint->bErrorCode;
-                                    data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
-                                    data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
-                                    data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
-                                }
-                                else
-                                {
-                                    pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
-                                }
-                            #endif
-                            break;
-
-                        default:
-                            illegalState = TRUE;
-                            break;
-                    }
-                    break;
-
-                default:
-                    illegalState = TRUE;
-            }
-
-            if (illegalState)
-            {
-                // We should never use this, but in case we do, put the endpoint
-                // in a recoverable state.
-                pCurrentEndpoint->transferState               = TSTATE_IDLE;
-                pCurrentEndpoint->status.bfTransferComplete   = 1;
-            }
-        }
-
-        // If we've gone through all the endpoints, we do not have any more control transfers.
-        usbBusInfo.flags.bfControlTransfersDone = 1;
-    }
-
-    #ifdef USB_SUPPORT_ISOCHRONOUS_TRANSFERS
-        // Next, we will handle isochronous transfers.  We must be careful with
-        // these.  The maximum packet size for an isochronous transfer is 1023
-        // bytes, so we cannot use the threshold register (U1SOF) to ensure that
-        // we do not write too many tokens during a frame.  Instead, we must count
-        // the number of bytes we are sending and stop sending isochronous
-        // transfers when we reach that limit.
-
-        // MCHP: Implement scheduling by using usbBusInfo.dBytesSentInFrame
-
-        // Current Limitation:  The stack currently supports only one attached
-        // device.  We will make the assumption that the control, isochronous, and
-        // interrupt transfers requested by a single device will not exceed one
-        // frame, and defer the scheduler.
-
-        // Due to the nature of isochronous transfers, transfer events must be used.
-        #if !defined( USB_ENABLE_TRANSFER_EVENT )
-            #error Transfer events are required for isochronous transfers
-        #endif
-
-        if (!usbBusInfo.flags.bfIsochronousTransfersDone)
-        {
-            // Look for any isochronous operations.
-            while (_USB_FindServiceEndpoint( USB_TRANSFER_TYPE_ISOCHRONOUS ))
-            {
-                switch (pCurrentEndpoint->transferState & TSTATE_MASK)
-                {
-                    case TSTATE_ISOCHRONOUS_READ:
-                        switch (pCurrentEndpoint->transferState & TSUBSTATE_MASK)
-                        {
-                            case TSUBSTATE_ISOCHRONOUS_READ_DATA:
-                                // Don't overwrite data the user has not yet processed.  We will skip this interval.    
-                                if (((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].bfDataLengthValid)
-                                {
-                                    // We have buffer overflow.
-                                }
-                                else
-                                {
-                                    // Initialize the data buffer.
-                                    ((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].bfDataLengthValid = 0;
-                                    pCurrentEndpoint->dataCount = 0;
-
-                                    _USB_SetDATA01( DTS_DATA0 );    // Always DATA0 for isochronous
-                                    _USB_SetBDT( USB_TOKEN_IN );
-                                    _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_IN );
-                                    return;
-                                }    
-                                break;
-
-                            case TSUBSTATE_ISOCHRONOUS_READ_COMPLETE:
-                                // Isochronous transfers are continuous until the user stops them.
-                                // Send an event that there is new data, and reset for the next
-                                // interval.
-                                pCurrentEndpoint->transferState     = TSTATE_ISOCHRONOUS_READ | TSUBSTATE_ISOCHRONOUS_READ_DATA;
-                                pCurrentEndpoint->wIntervalCount    = pCurrentEndpoint->wInterval;
-
-                                // Update the valid data length for this buffer.
-                                ((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].dataLength = pCurrentEndpoint->dataCount;
-                                ((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].bfDataLengthValid = 1;
-                                #if defined( USB_ENABLE_ISOC_TRANSFER_EVENT )
-                                    if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
-                                    {
-                                        USB_EVENT_DATA *data;
-
-                                        data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
-                                        data->event = EVENT_TRANSFER;
-                                        data->TransferData.dataCount        = pCurrentEndpoint->dataCount;
-                                        data->TransferData.pUserData        = ((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].pBuffer;
-                                        data->TransferData.bErrorCode       = USB_SUCCESS;
-                                        data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
-                                        data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
-                                        data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
-                                    }
-                                    else
-                                    {
-                                        pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
-                                    }
-                                #endif
-                                
-                                // If the user wants an event from the interrupt handler to handle the data as quickly as
-                                // possible, send up the event.  Then mark the packet as used.
-                                #ifdef USB_HOST_APP_DATA_EVENT_HANDLER
-                                    usbClientDrvTable[pCurrentEndpoint->clientDriver].DataEventHandler( usbDeviceInfo.deviceAddress, EVENT_DATA_ISOC_READ, ((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].pBuffer, pCurrentEndpoint->dataCount );
-                                    ((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].bfDataLengthValid = 0;
-                                #endif
-                                
-                                // Move to the next data buffer.
-                                ((ISOCHRONOUS_DATA *)pCurrentEndpoint->pUserData)->currentBufferUSB++;
-                                if (((ISOCHRONOUS_DATA *)pCurrentEndpoint->pUserData)->currentBufferUSB >= ((ISOCHRONOUS_DATA *)pCurrentEndpoint->pUserData)->totalBuffers)
-                                {
-                                    ((ISOCHRONOUS_DATA *)pCurrentEndpoint->pUserData)->currentBufferUSB = 0;
-                                }
-                                break;
-
-                            case TSUBSTATE_ERROR:
-                                // Isochronous transfers are continuous until the user stops them.
-                                // Send an event that there is an error, and reset for the next
-                                // interval.
-                                pCurrentEndpoint->transferState     = TSTATE_ISOCHRONOUS_READ | TSUBSTATE_ISOCHRONOUS_READ_DATA;
-                                pCurrentEndpoint->wIntervalCount    = pCurrentEndpoint->wInterval;
-                                #if defined( USB_ENABLE_TRANSFER_EVENT )
-                                    if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
-                                    {
-                                        USB_EVENT_DATA *data;
-
-                                        data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
-                                        data->event = EVENT_BUS_ERROR;
-                                        data->TransferData.dataCount        = 0;
-                                        data->TransferData.pUserData        = NULL;
-                                        data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
-                                        data->TransferData.bErrorCode       = pCurrentEndpoint->bErrorCode;
-                                        data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
-                                    }
-                                    else
-                                    {
-                                        pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
-                                    }
-                                #endif
-                                break;
-
-                            default:
-                                illegalState = TRUE;
-                                break;
-                        }
-                        break;
-
-                    case TSTATE_ISOCHRONOUS_WRITE:
-                        switch (pCurrentEndpoint->transferState & TSUBSTATE_MASK)
-                        {
-                            case TSUBSTATE_ISOCHRONOUS_WRITE_DATA:
-                                if (!((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].bfDataLengthValid)
-                                {
-                                    // We have buffer underrun.
-                                }
-                                else
-                                {
-                                    pCurrentEndpoint->dataCount = ((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->buffers[((ISOCHRONOUS_DATA *)(pCurrentEndpoint->pUserData))->currentBufferUSB].dataLength;
-
-                                    _USB_SetDATA01( DTS_DATA0 );    // Always DATA0 for isochronous
-                                    _USB_SetBDT( USB_TOKEN_OUT );
-                                    _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_OUT );
-                                    return;
-                                }    
-                                break;
+                                    _USB_SetDATA01( DTS_DATA0 );    // Always DATA0 for isochronous
+                                    _USB_SetBDT( USB_TOKEN_OUT );
+                                    _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_OUT );
+                                    return;
+                                }    
+                                break;
 
                             case TSUBSTATE_ISOCHRONOUS_WRITE_COMPLETE:
                                 // Isochronous transfers are continuous until the user stops them.
@@ -3600,6 +3357,7 @@ void _USB_FindNextToken( void )
                                         data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
                                         data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
                                         data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                        _USB_SetTransferTimestamp( &data->TransferData );
                                     }
                                     else
                                     {
@@ -3642,6 +3400,7 @@ void _USB_FindNextToken( void )
                                         data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
                                         data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
                                         data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                        _USB_SetTransferTimestamp( &data->TransferData );
                                     }
                                     else
                                     {
@@ -3710,6 +3469,7 @@ void _USB_FindNextToken( void )
                                         data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
                                         data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
                                         data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                        _USB_SetTransferTimestamp( &data->TransferData );
                                     }
                                     else
                                     {
@@ -3735,6 +3495,7 @@ void _USB_FindNextToken( void )
                                         data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
                                         data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
                                         data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                        _USB_SetTransferTimestamp( &data->TransferData );
                                     }
                                     else
                                     {
@@ -3758,81 +3519,367 @@ void _USB_FindNextToken( void )
                                 return;
                                 break;
 
-                            case TSUBSTATE_INTERRUPT_WRITE_COMPLETE:
-                                pCurrentEndpoint->transferState             = TSTATE_IDLE;
-                                pCurrentEndpoint->wIntervalCount            = pCurrentEndpoint->wInterval;
-                                pCurrentEndpoint->status.bfTransferComplete = 1;
-                                #if defined( USB_ENABLE_TRANSFER_EVENT )
-                                    if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
-                                    {
-                                        USB_EVENT_DATA *data;
+                            case TSUBSTATE_INTERRUPT_WRITE_COMPLETE:
+                                pCurrentEndpoint->transferState             = TSTATE_IDLE;
+                                pCurrentEndpoint->wIntervalCount            = pCurrentEndpoint->wInterval;
+                                pCurrentEndpoint->status.bfTransferComplete = 1;
+                                #if defined( USB_ENABLE_TRANSFER_EVENT )
+                                    if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
+                                    {
+                                        USB_EVENT_DATA *data;
+
+                                        data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
+                                        data->event = EVENT_TRANSFER;
+                                        data->TransferData.dataCount        = pCurrentEndpoint->dataCount;
+                                        data->TransferData.pUserData        = pCurrentEndpoint->pUserData;
+                                        data->TransferData.bErrorCode       = USB_SUCCESS;
+                                        data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
+                                        data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
+                                        data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                        _USB_SetTransferTimestamp( &data->TransferData );
+                                    }
+                                    else
+                                    {
+                                        pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
+                                    }
+                                #endif
+                                break;
+
+                            case TSUBSTATE_ERROR:
+                                pCurrentEndpoint->transferState             = TSTATE_IDLE;
+                                pCurrentEndpoint->wIntervalCount            = pCurrentEndpoint->wInterval;
+                                pCurrentEndpoint->status.bfTransferComplete = 1;
+                                #if defined( USB_ENABLE_TRANSFER_EVENT )
+                                    if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
+                                    {
+                                        USB_EVENT_DATA *data;
+
+                                        data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
+                                        data->event = EVENT_BUS_ERROR;
+                                        data->TransferData.dataCount        = 0;
+                                        data->TransferData.pUserData        = NULL;
+                                        data->TransferData.bErrorCode       = pCurrentEndpoint->bErrorCode;
+                                        data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
+                                        data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
+                                        data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                        _USB_SetTransferTimestamp( &data->TransferData );
+                                    }
+                                    else
+                                    {
+                                        pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
+                                    }
+                                #endif
+                                break;
+
+                            default:
+                                illegalState = TRUE;
+                                break;
+                        }
+                        break;
+
+                    default:
+                        illegalState = TRUE;
+                        break;
+                }
+
+                if (illegalState)
+                {
+                    // We should never use this, but in case we do, put the endpoint
+                    // in a recoverable state.
+                    pCurrentEndpoint->transferState             = TSTATE_IDLE;
+                    pCurrentEndpoint->wIntervalCount            = pCurrentEndpoint->wInterval;
+                    pCurrentEndpoint->status.bfTransferComplete = 1;
+                }
+            }
+
+            // If we've gone through all the endpoints, we do not have any more interrupt transfers.
+            usbBusInfo.flags.bfInterruptTransfersDone = 1;
+        }
+    #endif
+
+    // Control transfers use the part of the frame that is never reserved for
+    // periodic transfers.  We only allow one control transfer per frame.
+    if (!usbBusInfo.flags.bfControlTransfersDone)
+    {
+        // Look for any control transfers.
+        if (_USB_FindServiceEndpoint( USB_TRANSFER_TYPE_CONTROL ))
+        {
+            switch (pCurrentEndpoint->transferState & TSTATE_MASK)
+            {
+                case TSTATE_CONTROL_NO_DATA:
+                    switch (pCurrentEndpoint->transferState & TSUBSTATE_MASK)
+                    {
+                        case TSUBSTATE_CONTROL_NO_DATA_SETUP:
+                            _USB_SetDATA01( DTS_DATA0 );
+                            _USB_SetBDT( USB_TOKEN_SETUP );
+                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_SETUP );
+                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
+                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
+                            #endif
+                            return;
+                            break;
+
+                        case TSUBSTATE_CONTROL_NO_DATA_ACK:
+                            pCurrentEndpoint->dataCountMax = pCurrentEndpoint->dataCount;
+                            _USB_SetDATA01( DTS_DATA1 );
+                            _USB_SetBDT( USB_TOKEN_IN );
+                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_IN );
+                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
+                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
+                            #endif
+                            return;
+                            break;
+
+                        case TSUBSTATE_CONTROL_NO_DATA_COMPLETE:
+                            pCurrentEndpoint->transferState               = TSTATE_IDLE;
+                            pCurrentEndpoint->status.bfTransferComplete   = 1;
+                            #if defined( USB_ENABLE_TRANSFER_EVENT )
+                                if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
+                                {
+                                    USB_EVENT_DATA *data;
+
+                                    data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
+                                    data->event = EVENT_TRANSFER;
+                                    data->TransferData.dataCount        = pCurrentEndpoint->dataCount;
+                                    data->TransferData.pUserData        = pCurrentEndpoint->pUserData;
+                                    data->TransferData.bErrorCode       = USB_SUCCESS;
+                                    data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
+                                    data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
+                                    data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                    _USB_SetTransferTimestamp( &data->TransferData );
+                                }
+                                else
+                                {
+                                    pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
+                                }
+                            #endif
+                    break;
+
+                        case TSUBSTATE_ERROR:
+                            pCurrentEndpoint->transferState               = TSTATE_IDLE;
+                            pCurrentEndpoint->status.bfTransferComplete   = 1;
+                            #if defined( USB_ENABLE_TRANSFER_EVENT )
+                                if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
+                                {
+                                    USB_EVENT_DATA *data;
+
+                                    data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
+                                    data->event = EVENT_BUS_ERROR;
+                                    data->TransferData.dataCount        = 0;
+                                    data->TransferData.pUserData        = NULL;
+                                    data->TransferData.bErrorCode       = pCurrentEndpoint->bErrorCode;
+                                    data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
+                                    data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
+                                    data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                    _USB_SetTransferTimestamp( &data->TransferData );
+                                }
+                                else
+                                {
+                                    pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
+                                }
+                            #endif
+                            break;
+
+                        default:
+                            illegalState = TRUE;
+                            break;
+                    }
+                    break;
+
+                case TSTATE_CONTROL_READ:
+                    switch (pCurrentEndpoint->transferState & TSUBSTATE_MASK)
+                    {
+                        case TSUBSTATE_CONTROL_READ_SETUP:
+                            _USB_SetDATA01( DTS_DATA0 );
+                            _USB_SetBDT( USB_TOKEN_SETUP );
+                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_SETUP );
+                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
+                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
+                            #endif
+                            return;
+                            break;
+
+                        case TSUBSTATE_CONTROL_READ_DATA:
+                            _USB_SetBDT( USB_TOKEN_IN );
+                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_IN );
+                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
+                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
+                            #endif
+                            return;
+                            break;
+
+                        case TSUBSTATE_CONTROL_READ_ACK:
+                            pCurrentEndpoint->dataCountMax = pCurrentEndpoint->dataCount;
+                            _USB_SetDATA01( DTS_DATA1 );
+                            _USB_SetBDT( USB_TOKEN_OUT );
+                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_OUT );
+                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
+                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
+                            #endif
+                            return;
+                            break;
+
+                        case TSUBSTATE_CONTROL_READ_COMPLETE:
+                            pCurrentEndpoint->transferState               = TSTATE_IDLE;
+                            pCurrentEndpoint->status.bfTransferComplete   = 1;
+                            #if defined( USB_ENABLE_TRANSFER_EVENT )
+                                if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
+                                {
+                                    USB_EVENT_DATA *data;
+
+                                    data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
+                                    data->event = EVENT_TRANSFER;
+                                    data->TransferData.dataCount        = pCurrentEndpoint->dataCount;
+                                    data->TransferData.pUserData        = pCurrentEndpoint->pUserData;
+                                    data->TransferData.bErrorCode       = USB_SUCCESS;
+                                    data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
+                                    data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
+                                    data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                    _USB_SetTransferTimestamp( &data->TransferData );
+                                }
+                                else
+                                {
+                                    pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
+                                }
+                            #endif
+                            break;
+
+                        case TSUBSTATE_ERROR:
+                            pCurrentEndpoint->transferState               = TSTATE_IDLE;
+                            pCurrentEndpoint->status.bfTransferComplete   = 1;
+                            #if defined( USB_ENABLE_TRANSFER_EVENT )
+                                if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
+                                {
+                                    USB_EVENT_DATA *data;
+
+                                    data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
+                                    data->event = EVENT_BUS_ERROR;
+                                    data->TransferData.dataCount        = 0;
+                                    data->TransferData.pUserData        = NULL;
+                                    data->TransferData.bErrorCode       = pCurrentEndpoint->bErrorCode;
+                                    data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
+                                    data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
+                                    data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                    _USB_SetTransferTimestamp( &data->TransferData );
+                                }
+                                else
+                                {
+                                    pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
+                                }
+                            #endif
+                            break;
+
+                        default:
+                            illegalState = TRUE;
+                            break;
+                    }
+                    break;
+
+                case TSTATE_CONTROL_WRITE:
+                    switch (pCurrentEndpoint->transferState & TSUBSTATE_MASK)
+                    {
+                        case TSUBSTATE_CONTROL_WRITE_SETUP:
+                            _USB_SetDATA01( DTS_DATA0 );
+                            _USB_SetBDT( USB_TOKEN_SETUP );
+                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_SETUP );
+                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
+                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
+                            #endif
+                            return;
+                            break;
+
+                        case TSUBSTATE_CONTROL_WRITE_DATA:
+                            _USB_SetBDT( USB_TOKEN_OUT );
+                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_OUT );
+                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
+                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
+                            #endif
+                            return;
+                            break;
+
+                        case TSUBSTATE_CONTROL_WRITE_ACK:
+                            pCurrentEndpoint->dataCountMax = pCurrentEndpoint->dataCount;
+                            _USB_SetDATA01( DTS_DATA1 );
+                            _USB_SetBDT( USB_TOKEN_IN );
+                            _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_IN );
+                            #ifdef ONE_CONTROL_TRANSACTION_PER_FRAME
+                                usbBusInfo.flags.bfControlTransfersDone = 1; // Only one control transfer per frame.
+                            #endif
+                            return;
+                            break;
 
-                                        data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
-                                        data->event = EVENT_TRANSFER;
-                                        data->TransferData.dataCount        = pCurrentEndpoint->dataCount;
-                                        data->TransferData.pUserData        = pCurrentEndpoint->pUserData;
-                                        data->TransferData.bErrorCode       = USB_SUCCESS;
-                                        data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
-                                        data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
-                                        data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
-                                    }
-                                    else
-                                    {
-                                        pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
-                                    }
-                                #endif
-                                break;
+                        case TSUBSTATE_CONTROL_WRITE_COMPLETE:
+                            pCurrentEndpoint->transferState               = TSTATE_IDLE;
+                            pCurrentEndpoint->status.bfTransferComplete   = 1;
+                            #if defined( USB_ENABLE_TRANSFER_EVENT )
+                                if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
+                                {
+                                    USB_EVENT_DATA *data;
 
-                            case TSUBSTATE_ERROR:
-                                pCurrentEndpoint->transferState             = TSTATE_IDLE;
-                                pCurrentEndpoint->wIntervalCount            = pCurrentEndpoint->wInterval;
-                                pCurrentEndpoint->status.bfTransferComplete = 1;
-                                #if defined( USB_ENABLE_TRANSFER_EVENT )
-                                    if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
-                                    {
-                                        USB_EVENT_DATA *data;
+                                    data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
+                                    data->event = EVENT_TRANSFER;
+                                    data->TransferData.dataCount        = pCurrentEndpoint->dataCount;
+                                    data->TransferData.pUserData        = pCurrentEndpoint->pUserData;
+                                    data->TransferData.bErrorCode       = USB_SUCCESS;
+                                    data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
+                                    data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
+                                    data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                    _USB_SetTransferTimestamp( &data->TransferData );
+                                }
+                                else
+                                {
+                                    pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
+                                }
+                            #endif
+                            break;
 
-                                        data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
-                                        data->event = EVENT_BUS_ERROR;
-                                        data->TransferData.dataCount        = 0;
-                                        data->TransferData.pUserData        = NULL;
-                                        data->TransferData.bErrorCode       = pCurrentEndpoint->bErrorCode;
-                                        data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
-                                        data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
-                                        data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
-                                    }
-                                    else
-                                    {
-                                        pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
-                                    }
-                                #endif
-                                break;
+                        case TSUBSTATE_ERROR:
+                            pCurrentEndpoint->transferState               = TSTATE_IDLE;
+                            pCurrentEndpoint->status.bfTransferComplete   = 1;
+                            #if defined( USB_ENABLE_TRANSFER_EVENT )
+                                if (StructQueueIsNotFull(&usbEventQueue, USB_EVENT_QUEUE_DEPTH))
+                                {
+                                    USB_EVENT_DATA *data;
 
-                            default:
-                                illegalState = TRUE;
-                                break;
-                        }
-                        break;
+                                    data = StructQueueAdd(&usbEventQueue, USB_EVENT_QUEUE_DEPTH);
+                                    data->event = EVENT_BUS_ERROR;
+                                    data->TransferData.dataCount        = 0;
+                                    data->TransferData.pUserData        = NULL;
+                                    data->TransferData.bErrorCode       = pCurrentEndpoint->bErrorCode;
+                                    data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
+                                    data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
+                                    data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                    _USB_SetTransferTimestamp( &data->TransferData );
+                                }
+                                else
+                                {
+                                    pCurrentEndpoint->bmAttributes.val = USB_EVENT_QUEUE_FULL;
+                                }
+                            #endif
+                            break;
 
-                    default:
-                        illegalState = TRUE;
-                        break;
-                }
+                        default:
+                            illegalState = TRUE;
+                            break;
+                    }
+                    break;
 
-                if (illegalState)
-                {
-                    // We should never use this, but in case we do, put the endpoint
-                    // in a recoverable state.
-                    pCurrentEndpoint->transferState             = TSTATE_IDLE;
-                    pCurrentEndpoint->wIntervalCount            = pCurrentEndpoint->wInterval;
-                    pCurrentEndpoint->status.bfTransferComplete = 1;
-                }
+                default:
+                    illegalState = TRUE;
             }
 
-            // If we've gone through all the endpoints, we do not have any more interrupt transfers.
-            usbBusInfo.flags.bfInterruptTransfersDone = 1;
+            if (illegalState)
+            {
+                // We should never use this, but in case we do, put the endpoint
+                // in a recoverable state.
+                pCurrentEndpoint->transferState               = TSTATE_IDLE;
+                pCurrentEndpoint->status.bfTransferComplete   = 1;
+            }
         }
-    #endif
+
+        // If we've gone through all the endpoints, we do not have any more control transfers.
+        usbBusInfo.flags.bfControlTransfersDone = 1;
+    }
 
     #ifdef USB_SUPPORT_BULK_TRANSFERS
 #ifdef ALLOW_MULTIPLE_BULK_TRANSACTIONS_PER_FRAME
@@ -3856,6 +3903,14 @@ TryBulk:
                         switch (pCurrentEndpoint->transferState & TSUBSTATE_MASK)
                         {
                             case TSUBSTATE_BULK_READ_DATA:
+                                if (!_USB_FrameHasTime( pCurrentEndpoint ))
+                                {
+                                    // Leave the rest of the frame alone, so the
+                                    // token is not held over into the periodic
+                                    // part of the next frame.
+                                    usbBusInfo.flags.bfBulkTransfersDone = 1;
+                                    return;
+                                }
                                 _USB_SetBDT( USB_TOKEN_IN );
                                 _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_IN );
                                 return;
@@ -3877,6 +3932,7 @@ TryBulk:
                                         data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
                                         data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
                                         data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                        _USB_SetTransferTimestamp( &data->TransferData );
                                     }
                                     else
                                     {
@@ -3901,6 +3957,7 @@ TryBulk:
                                         data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
                                         data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
                                         data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                        _USB_SetTransferTimestamp( &data->TransferData );
                                     }
                                     else
                                     {
@@ -3919,6 +3976,14 @@ TryBulk:
                         switch (pCurrentEndpoint->transferState & TSUBSTATE_MASK)
                         {
                             case TSUBSTATE_BULK_WRITE_DATA:
+                                if (!_USB_FrameHasTime( pCurrentEndpoint ))
+                                {
+                                    // Leave the rest of the frame alone, so the
+                                    // token is not held over into the periodic
+                                    // part of the next frame.
+                                    usbBusInfo.flags.bfBulkTransfersDone = 1;
+                                    return;
+                                }
                                 _USB_SetBDT( USB_TOKEN_OUT );
                                 _USB_SendToken( pCurrentEndpoint->bEndpointAddress, USB_TOKEN_OUT );
                                 return;
@@ -3940,6 +4005,7 @@ TryBulk:
                                         data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
                                         data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
                                         data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                        _USB_SetTransferTimestamp( &data->TransferData );
                                     }
                                     else
                                     {
@@ -3964,6 +4030,7 @@ TryBulk:
                                         data->TransferData.bEndpointAddress = pCurrentEndpoint->bEndpointAddress;
                                         data->TransferData.bmAttributes.val = pCurrentEndpoint->bmAttributes.val;
                                         data->TransferData.clientDriver     = pCurrentEndpoint->clientDriver;
+                                        _USB_SetTransferTimestamp( &data->TransferData );
                                     }
                                     else
                                     {
@@ -3992,15 +4059,12 @@ TryBulk:
                 }
             }
 
-            // We've gone through all the bulk transactions, but we have time for more.
-            // If we have any bulk transactions, go back to the beginning of the list
-            // and start over.
+            // The endpoint did not need a token.  If other bulk endpoints are
+            // waiting, go on to the next one in turn.
             #ifdef ALLOW_MULTIPLE_BULK_TRANSACTIONS_PER_FRAME
                 if (usbBusInfo.countBulkTransactions)
                 {
-                    usbBusInfo.lastBulkTransaction = 0;
                     goto TryBulk;
-
                 }
             #endif
 
@@ -4039,11 +4103,20 @@ TryBulk:
 
   Remarks:
     The EP 0 block is retained.
+
+    Bulk endpoints are searched starting after the one returned last time,
+    wrapping around to the start of the list, so that every bulk endpoint
+    gets its turn, even if the frame ends before all of them are serviced.
   ***************************************************************************/
 BOOL _USB_FindServiceEndpoint( BYTE transferType )
 {
     USB_ENDPOINT_INFO           *pEndpoint;
     USB_INTERFACE_INFO          *pInterface;
+    #ifdef USB_SUPPORT_BULK_TRANSFERS
+        USB_ENDPOINT_INFO       *pFirstBulk;
+        BYTE                    firstBulkPosition;
+        BYTE                    bulkPosition;
+    #endif
 
     // Check endpoint 0.
     if ((usbDeviceInfo.pEndpoint0->bmAttributes.bfTransferType == transferType) &&
@@ -4054,6 +4127,11 @@ BOOL _USB_FindServiceEndpoint( BYTE transferType )
     }
 
     usbBusInfo.countBulkTransactions = 0;
+    #ifdef USB_SUPPORT_BULK_TRANSFERS
+        pFirstBulk          = NULL;
+        firstBulkPosition   = 0;
+        bulkPosition        = 0;
+    #endif
     pEndpoint = NULL;
     pInterface = usbDeviceInfo.pInterfaceList;
     if (pInterface && pInterface->pCurrentSetting)
@@ -4108,6 +4186,7 @@ BOOL _USB_FindServiceEndpoint( BYTE transferType )
 
 					#ifdef USB_SUPPORT_BULK_TRANSFERS
 					case USB_TRANSFER_TYPE_BULK:
+						bulkPosition ++;
 						#ifdef ALLOW_MULTIPLE_NAKS_PER_FRAME
 						if (!pEndpoint->status.bfTransferComplete)
 						#else
@@ -4116,12 +4195,17 @@ BOOL _USB_FindServiceEndpoint( BYTE transferType )
 						#endif
 						{
 							usbBusInfo.countBulkTransactions ++;
-							if (usbBusInfo.countBulkTransactions > usbBusInfo.lastBulkTransaction)
+							if (bulkPosition > usbBusInfo.lastBulkTransaction)
 							{
-								usbBusInfo.lastBulkTransaction  = usbBusInfo.countBulkTransactions;
+								usbBusInfo.lastBulkTransaction  = bulkPosition;
 								pCurrentEndpoint                = pEndpoint;
 								return TRUE;
 							}
+							if (pFirstBulk == NULL)
+							{
+								pFirstBulk          = pEndpoint;
+								firstBulkPosition   = bulkPosition;
+							}
 						}
 						break;
 					#endif
@@ -4143,11 +4227,53 @@ BOOL _USB_FindServiceEndpoint( BYTE transferType )
         }
     }
 
+    #ifdef USB_SUPPORT_BULK_TRANSFERS
+        // No bulk endpoint after the last one serviced is ready, so start over
+        // with the first one that is.
+        if (pFirstBulk != NULL)
+        {
+            usbBusInfo.lastBulkTransaction  = firstBulkPosition;
+            pCurrentEndpoint                = pFirstBulk;
+            return TRUE;
+        }
+    #endif
+
     // No endpoints with the desired description are ready for servicing.
     return FALSE;
 }
 
 
+/****************************************************************************
+  Function:
+    BOOL _USB_FrameHasTime( volatile USB_ENDPOINT_INFO *pEndpoint )
+
+  Description:
+    This function determines if a full packet transaction on the specified
+    endpoint can still be completed in the current frame.
+
+  Precondition:
+    None
+
+  Parameters:
+    USB_ENDPOINT_INFO *pEndpoint    - Endpoint of the transaction
+
+  Return Values:
+    TRUE    - The transaction fits before the end of the frame.
+    FALSE   - The transaction should wait for the next frame.
+
+  Remarks:
+    The bus time used in the frame is an estimate that is corrected as each
+    transaction completes.  The U1SOF threshold still protects the end of
+    the frame if the estimate is too low.
+  ***************************************************************************/
+
+BOOL _USB_FrameHasTime( volatile USB_ENDPOINT_INFO *pEndpoint )
+{
+    return (usbBusInfo.wFrameByteTimes + _USB_TransactionByteTimes( pEndpoint, pEndpoint->wMaxPacketSize ))
+                <= (USB_FRAME_BYTE_TIMES - USB_FRAME_EOF_BYTE_TIMES);
+}
+
+
 /****************************************************************************
   Function:
     void _USB_FreeConfigMemory( void )
@@ -4677,10 +4803,11 @@ void _USB_NotifyAllDataClients( BYTE address, USB_EVENT event, void *data, unsig
         Currently, there is no other mechanism for informing the user of
         an out of dynamic memory condition.
 
-    * We are assuming that we can support a single interface on a single
-        device.  When the driver is modified to support multiple devices,
-        each endpoint should be checked to ensure that we have enough
-        bandwidth to support it.
+    * The isochronous and interrupt endpoints of the default interface
+        settings must fit in 90% of a frame.  Other settings are checked
+        when they are selected with SET INTERFACE.  When the driver is
+        modified to support multiple devices, the endpoints of all devices
+        must be counted.
   ***************************************************************************/
 
 BOOL _USB_ParseConfigurationDescriptor( void )
@@ -4920,10 +5047,6 @@ BOOL _USB_ParseConfigurationDescriptor( void )
                         newEndpointInfo->next           = newSettingInfo->pEndpointList;
                         newSettingInfo->pEndpointList   = newEndpointInfo;
 
-                        // When multiple devices are supported, check the available
-                        // bandwidth here to make sure that we can support this
-                        // endpoint.
-
                         // Get ready for the next endpoint.
                         currentEndpoint++;
                         index += bLength;
@@ -4948,6 +5071,14 @@ BOOL _USB_ParseConfigurationDescriptor( void )
 //        error = TRUE;
 //    }
 
+    // Reserve the bus time for the periodic endpoints of the default
+    // interface settings.
+    if (!error && (_USB_PeriodicByteTimes( pTempInterfaceList, NULL, NULL ) > USB_FRAME_PERIODIC_BYTE_TIMES))
+    {
+        DEBUG_PutString( "HOST: Not enough bandwidth.\r\n" );
+        error = TRUE;
+    }
+
     if (pTempInterfaceList == NULL)
     {
         // We could find no supported interfaces.
@@ -5000,6 +5131,72 @@ BOOL _USB_ParseConfigurationDescriptor( void )
 }
 
 
+/****************************************************************************
+  Function:
+    WORD _USB_PeriodicByteTimes( USB_INTERFACE_INFO *pInterfaceList,
+                USB_INTERFACE_INFO *pInterface,
+                USB_INTERFACE_SETTING_INFO *pSetting )
+
+  Description:
+    This function calculates the bus time that the isochronous and interrupt
+    endpoints of the current interface settings can use in one frame.  Every
+    periodic endpoint is allowed one transaction per frame, so the full
+    transaction time of each endpoint is counted, regardless of its interval,
+    with worst case bit stuffing of the data.
+
+  Precondition:
+    None
+
+  Parameters:
+    USB_INTERFACE_INFO *pInterfaceList  - List of the interfaces to check
+    USB_INTERFACE_INFO *pInterface      - Interface that is changing its
+                                            setting, or NULL
+    USB_INTERFACE_SETTING_INFO *pSetting - New setting of pInterface
+
+  Returns:
+    The number of byte times needed each frame.
+
+  Remarks:
+    None
+  ***************************************************************************/
+
+WORD _USB_PeriodicByteTimes( USB_INTERFACE_INFO *pInterfaceList, USB_INTERFACE_INFO *pInterface,
+        USB_INTERFACE_SETTING_INFO *pSetting )
+{
+    WORD                        byteTimes;
+    USB_ENDPOINT_INFO           *pEndpoint;
+    USB_INTERFACE_SETTING_INFO  *pCurrentSetting;
+
+    byteTimes = 0;
+    while (pInterfaceList)
+    {
+        pCurrentSetting = pInterfaceList->pCurrentSetting;
+        if (pInterfaceList == pInterface)
+        {
+            pCurrentSetting = pSetting;
+        }
+
+        if (pCurrentSetting)
+        {
+            pEndpoint = pCurrentSetting->pEndpointList;
+            while (pEndpoint)
+            {
+                if ((pEndpoint->bmAttributes.bfTransferType == USB_TRANSFER_TYPE_ISOCHRONOUS) ||
+                    (pEndpoint->bmAttributes.bfTransferType == USB_TRANSFER_TYPE_INTERRUPT))
+                {
+                    byteTimes += _USB_TransactionByteTimes( pEndpoint, pEndpoint->wMaxPacketSize + (pEndpoint->wMaxPacketSize / 6) );
+                }
+                pEndpoint = pEndpoint->next;
+            }
+        }
+
+        pInterfaceList = pInterfaceList->next;
+    }
+
+    return byteTimes;
+}
+
+
 /****************************************************************************
   Function:
     void _USB_ResetDATA0( BYTE endpoint )
@@ -5109,6 +5306,10 @@ void _USB_SendToken( BYTE endpoint, BYTE tokenType )
 
     U1EP0 = temp;
 
+    // Charge the frame for a full packet until the transaction completes.
+    usbBusInfo.wTokenByteTimes  = _USB_TransactionByteTimes( pCurrentEndpoint, pCurrentEndpoint->wMaxPacketSize );
+    usbBusInfo.wFrameByteTimes += usbBusInfo.wTokenByteTimes;
+
     U1ADDR = usbDeviceInfo.deviceAddressAndSpeed;
     U1TOK = (tokenType << 4) | (endpoint & 0x7F);
 
@@ -5263,6 +5464,54 @@ void _USB_SetBDT( BYTE token )
 }
 
 
+/****************************************************************************
+  Function:
+    WORD _USB_TransactionByteTimes( volatile USB_ENDPOINT_INFO *pEndpoint, WORD wBytes )
+
+  Description:
+    This function estimates the bus time of one transaction on the specified
+    endpoint, in full speed byte times.
+
+  Precondition:
+    None
+
+  Parameters:
+    USB_ENDPOINT_INFO *pEndpoint    - Endpoint of the transaction
+    WORD wBytes                     - Number of data bytes in the transaction
+
+  Returns:
+    The number of full speed byte times used by the transaction.
+
+  Remarks:
+    The estimate includes the token, handshake, and inter-packet delays, but
+    not bit stuffing.  The end of frame margin covers the bit stuffing of the
+    bulk transactions in a frame, and _USB_PeriodicByteTimes() adds the worst
+    case itself.
+  ***************************************************************************/
+
+WORD _USB_TransactionByteTimes( volatile USB_ENDPOINT_INFO *pEndpoint, WORD wBytes )
+{
+    WORD    byteTimes;
+
+    byteTimes = wBytes;
+    if (pEndpoint->bmAttributes.bfTransferType == USB_TRANSFER_TYPE_ISOCHRONOUS)
+    {
+        byteTimes += USB_OVERHEAD_ISOCHRONOUS;
+    }
+    else
+    {
+        byteTimes += USB_OVERHEAD_NON_ISOCHRONOUS;
+    }
+
+    if (usbDeviceInfo.flags.bfIsLowSpeed)
+    {
+        byteTimes *= USB_LOW_SPEED_BYTE_TIMES;
+    }
+
+    return byteTimes;
+}
+
+
 /****************************************************************************
   Function:
     BOOL _USB_TransferInProgress( void )
@@ -5641,6 +5890,19 @@ void __ISR(_USB_1_VECTOR, ipl4) _USB1Interrupt(void)
                 #endif
             }
 
+            // Replace the full packet charged when the token was written with
+            // the bus time that the transaction actually used.
+            usbBusInfo.wFrameByteTimes -= usbBusInfo.wTokenByteTimes;
+            if ((pBDT->STAT.PID == PID_ACK) || (pBDT->STAT.PID == PID_DATA0) || (pBDT->STAT.PID == PID_DATA1))
+            {
+                usbBusInfo.wFrameByteTimes += _USB_TransactionByteTimes( pCurrentEndpoint, pBDT->count );
+            }
+            else
+            {
+                usbBusInfo.wFrameByteTimes += _USB_TransactionByteTimes( pCurrentEndpoint, 0 );
+            }
+            usbBusInfo.wTokenByteTimes = 0;
+
             if (pBDT->STAT.PID == PID_ACK)
             {
                 // We will only get this PID from an OUT or SETUP packet.
@@ -5893,8 +6155,8 @@ void __ISR(_USB_1_VECTOR, ipl4) _USB1Interrupt(void)
         usbBusInfo.flags.bfInterruptTransfersDone   = 0;
         usbBusInfo.flags.bfIsochronousTransfersDone = 0;
         usbBusInfo.flags.bfBulkTransfersDone        = 0;
-        //usbBusInfo.dBytesSentInFrame                = 0;
-        usbBusInfo.lastBulkTransaction              = 0;
+        usbBusInfo.wFrameByteTimes                  = 0;
+        usbBusInfo.wTokenByteTimes                  = 0;
 
         _USB_FindNextToken();
     }
@@ -359,6 +359,14 @@ HOLDING state machine values
 #define USB_SOF_THRESHOLD_32                0x2A    // U1SOF - Threshold for a max packet size of 32
 #define USB_SOF_THRESHOLD_64                0x4A    // U1SOF - Threshold for a max packet size of 64
 
+// Bus time is budgeted in full speed byte times (8 bit times, 667 ns).
+#define USB_FRAME_BYTE_TIMES                1500    // Byte times in one 1 ms frame.
+#define USB_FRAME_PERIODIC_BYTE_TIMES       1350    // Periodic transfers may reserve 90% of a frame.
+#define USB_FRAME_EOF_BYTE_TIMES            USB_SOF_THRESHOLD_64    // Keep clear of the end of the frame.
+#define USB_OVERHEAD_ISOCHRONOUS            9       // Protocol overhead of an isochronous transaction.
+#define USB_OVERHEAD_NON_ISOCHRONOUS        13      // Protocol overhead of a control, interrupt, or bulk transaction.
+#define USB_LOW_SPEED_BYTE_TIMES            8       // Full speed byte times per low speed byte.
+
 #define USB_1MS_TIMER_FLAG                  0x40
 #ifndef USB_INSERT_TIME
     #define USB_INSERT_TIME                 (250+1) // Insertion delay time (spec minimum is 100 ms)
@@ -402,8 +410,9 @@ typedef struct _USB_BUS_INFO
         };
         WORD            val;                                //
     }                   flags;                              //
-//    volatile DWORD      dBytesSentInFrame;                  // The number of bytes sent during the current frame. Isochronous use only.
-    volatile BYTE       lastBulkTransaction;                // The last bulk transaction sent.
+    volatile WORD       wFrameByteTimes;                    // Bus time used during the current frame.
+    volatile WORD       wTokenByteTimes;                    // Bus time charged for the token in progress.
+    volatile BYTE       lastBulkTransaction;                // List position of the last bulk endpoint serviced.
     volatile BYTE       countBulkTransactions;              // The number of active bulk transactions.
 } USB_BUS_INFO;
 
@@ -650,6 +659,7 @@ USB_ENDPOINT_INFO *  _USB_FindEndpoint( BYTE endpoint );
 USB_INTERFACE_INFO * _USB_FindInterface ( BYTE bInterface, BYTE bAltSetting );
 void                 _USB_FindNextToken( void );
 BOOL                 _USB_FindServiceEndpoint( BYTE transferType );
+BOOL                 _USB_FrameHasTime( volatile USB_ENDPOINT_INFO *pEndpoint );
 void                 _USB_FreeConfigMemory( void );
 void                 _USB_FreeMemory( void );
 void                 _USB_InitControlRead( USB_ENDPOINT_INFO *pEndpoint, BYTE *pControlData, WORD controlSize,
@@ -660,9 +670,12 @@ void                 _USB_InitRead( USB_ENDPOINT_INFO *pEndpoint, BYTE *pData, W
 void                 _USB_InitWrite( USB_ENDPOINT_INFO *pEndpoint, BYTE *pData, WORD size );
 void                 _USB_NotifyClients( BYTE DevAddress, USB_EVENT event, void *data, unsigned int size );
 BOOL                 _USB_ParseConfigurationDescriptor( void );
+WORD                 _USB_PeriodicByteTimes( USB_INTERFACE_INFO *pInterfaceList, USB_INTERFACE_INFO *pInterface,
+                              USB_INTERFACE_SETTING_INFO *pSetting );
 void                 _USB_ResetDATA0( BYTE endpoint );
 void                 _USB_SendToken( BYTE endpoint, BYTE tokenType );
 void                 _USB_SetBDT( BYTE  direction );
+WORD                 _USB_TransactionByteTimes( volatile USB_ENDPOINT_INFO *pEndpoint, WORD wBytes );
 BOOL                 _USB_TransferInProgress( void );
 
 
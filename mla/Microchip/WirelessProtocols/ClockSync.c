@@ -0,0 +1,478 @@
+/********************************************************************
+* FileName:		ClockSync.c
+* Dependencies: ClockSync.h
+* Processor:	PIC24F, PIC24H, PIC32, dsPIC30, dsPIC33
+* Complier:     Microchip C30 v2.03 or higher
+*               Microchip C32 v1.02 or higher
+* Company:		Microchip Technology, Inc.
+*
+* Copyright and Disclaimer Notice
+*
+* Copyright  2007-2010 Microchip Technology Inc.  All rights reserved.
+*
+* Microchip licenses to you the right to use, modify, copy and distribute 
+* Software only when embedded on a Microchip microcontroller or digital 
+* signal controller and used with a Microchip radio frequency transceiver, 
+* which are integrated into your product or third party product (pursuant 
+* to the terms in the accompanying license agreement).  
+*
+* You should refer to the license agreement accompanying this Software for 
+* additional information regarding your rights and obligations.
+*
+* SOFTWARE AND DOCUMENTATION ARE PROVIDED AS IS WITHOUT WARRANTY OF ANY 
+* KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION, ANY 
+* WARRANTY OF MERCHANTABILITY, TITLE, NON-INFRINGEMENT AND FITNESS FOR A 
+* PARTICULAR PURPOSE. IN NO EVENT SHALL MICROCHIP OR ITS LICENSORS BE 
+* LIABLE OR OBLIGATED UNDER CONTRACT, NEGLIGENCE, STRICT LIABILITY, 
+* CONTRIBUTION, BREACH OF WARRANTY, OR OTHER LEGAL EQUITABLE THEORY ANY 
+* DIRECT OR INDIRECT DAMAGES OR EXPENSES INCLUDING BUT NOT LIMITED TO 
+* ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE OR CONSEQUENTIAL DAMAGES, 
+* LOST PROFITS OR LOST DATA, COST OF PROCUREMENT OF SUBSTITUTE GOODS, 
+* TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES (INCLUDING BUT 
+* NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+*
+*********************************************************************
+* File Description:
+*
+*   Clock synchronization calculations and message format
+*
+* Change History:
+*  Rev   Date         Description
+*  4.2   10/18/2026   Initial revision
+********************************************************************/
+
+/************************ HEADERS **********************************/
+#include "SystemProfile.h"
+
+#if defined(ENABLE_CLOCK_SYNC)
+
+#include "GenericTypeDefs.h"
+#include "WirelessProtocols/ClockSync.h"
+
+/************************ DEFINITIONS ******************************/
+
+#define NS_PER_SECOND   1000000000ull
+
+/************************ FUNCTIONS ********************************/
+
+/*********************************************************************
+* Function:         static QWORD ClockSyncTicksToNs(CLOCK_SYNC_CLOCK *clock, 
+*                                                   DWORD ticks, DWORD *fraction)
+*
+* PreCondition:     ClockSyncClockInit() has been called
+*
+* Input:		    clock - the local clock
+*                   ticks - a number of timer ticks
+*                   fraction - fraction of a nanosecond to add, in 2^-32.
+*                              Holds the fraction of the result on return.
+*
+* Output:		    QWORD - the whole nanoseconds
+*
+* Side Effects:	    none
+*
+* Overview:		    This function converts a number of timer ticks to
+*                   nanoseconds.
+*
+* Note:			    None
+********************************************************************/
+static QWORD ClockSyncTicksToNs(CLOCK_SYNC_CLOCK *clock, DWORD ticks, DWORD *fraction)
+{
+    QWORD part;
+    
+    part = (QWORD)ticks * clock->nsPerTickFrac + *fraction;
+    *fraction = (DWORD)(part & 0xFFFFFFFFul);
+    
+    return (QWORD)ticks * clock->nsPerTick + (part >> 32);
+}
+
+/*********************************************************************
+* Function:         void ClockSyncClockInit(CLOCK_SYNC_CLOCK *clock, 
+*                                           DWORD tickHz, DWORD tick)
+*
+* PreCondition:     none
+*
+* Input:		    clock - the local clock
+*                   tickHz - frequency of the timer
+*                   tick - current timer value
+*
+* Output:		    none
+*
+* Side Effects:	    none
+*
+* Overview:		    This function starts the local clock at 0 ns.
+*
+* Note:			    None
+********************************************************************/
+void ClockSyncClockInit(CLOCK_SYNC_CLOCK *clock, DWORD tickHz, DWORD tick)
+{
+    QWORD period = (NS_PER_SECOND << 32) / tickHz;
+    
+    clock->time = 0;
+    clock->tick = tick;
+    clock->fraction = 0;
+    clock->nsPerTick = (DWORD)(period >> 32);
+    clock->nsPerTickFrac = (DWORD)(period & 0xFFFFFFFFul);
+}
+
+/*********************************************************************
+* Function:         void ClockSyncClockUpdate(CLOCK_SYNC_CLOCK *clock, DWORD tick)
+*
+* PreCondition:     ClockSyncClockInit() has been called
+*
+* Input:		    clock - the local clock
+*                   tick - current timer value
+*
+* Output:		    none
+*
+* Side Effects:	    none
+*
+* Overview:		    This function moves the local clock to the current
+*                   timer value.
+*
+* Note:			    It must be called more often than half the time the
+*                   timer takes to roll over.  A timer value older than
+*                   the last update is ignored.
+********************************************************************/
+void ClockSyncClockUpdate(CLOCK_SYNC_CLOCK *clock, DWORD tick)
+{
+    DWORD ticks = (tick - clock->tick) & 0xFFFFFFFFul;
+    
+    if( ticks & 0x80000000ul )
+    {
+        return;
+    }
+    
+    clock->time += ClockSyncTicksToNs(clock, ticks, &(clock->fraction));
+    clock->tick = tick;
+}
+
+/*********************************************************************
+* Function:         QWORD ClockSyncClockTime(CLOCK_SYNC_CLOCK *clock, DWORD tick)
+*
+* PreCondition:     ClockSyncClockInit() has been called
+*
+* Input:		    clock - the local clock
+*                   tick - a timer value, such as a frame timestamp
+*
+* Output:		    QWORD - the local time of the timer value, in ns
+*
+* Side Effects:	    none
+*
+* Overview:		    This function converts a timer value to local time.
+*
+* Note:			    The timer value may be up to half the roll over
+*                   time before or after the last update.
+********************************************************************/
+QWORD ClockSyncClockTime(CLOCK_SYNC_CLOCK *clock, DWORD tick)
+{
+    DWORD ticks = (tick - clock->tick) & 0xFFFFFFFFul;
+    DWORD fraction;
+    
+    if( ticks & 0x80000000ul )
+    {
+        fraction = 0;
+        ticks = (clock->tick - tick) & 0xFFFFFFFFul;
+        return clock->time - ClockSyncTicksToNs(clock, ticks, &fraction);
+    }
+    
+    fraction = clock->fraction;
+    return clock->time + ClockSyncTicksToNs(clock, ticks, &fraction);
+}
+
+/*********************************************************************
+* Function:         void ClockSyncInit(CLOCK_SYNC *sync, DWORD tickHz, DWORD tick)
+*
+* PreCondition:     none
+*
+* Input:		    sync - the clock synchronization state
+*                   tickHz - frequency of the timer
+*                   tick - current timer value
+*
+* Output:		    none
+*
+* Side Effects:	    none
+*
+* Overview:		    This function starts the local clock, and makes the
+*                   master time equal to the local time until a sample
+*                   is received.
+*
+* Note:			    None
+********************************************************************/
+void ClockSyncInit(CLOCK_SYNC *sync, DWORD tickHz, DWORD tick)
+{
+    ClockSyncClockInit(&(sync->clock), tickHz, tick);
+    sync->localRef = 0;
+    sync->masterRef = 0;
+    sync->rate = 0;
+    sync->lastError = 0;
+    sync->rxTime = 0;
+    sync->rxSeq = 0;
+    sync->txSeq = 0;
+    sync->samples = 0;
+    sync->flags.Val = 0;
+}
+
+/*********************************************************************
+* Function:         QWORD ClockSyncToMaster(CLOCK_SYNC *sync, QWORD localTime)
+*
+* PreCondition:     ClockSyncInit() has been called
+*
+* Input:		    sync - the clock synchronization state
+*                   localTime - a local time, in ns
+*
+* Output:		    QWORD - the master time, in ns
+*
+* Side Effects:	    none
+*
+* Overview:		    This function converts a local time to master time.
+*
+* Note:			    None
+********************************************************************/
+QWORD ClockSyncToMaster(CLOCK_SYNC *sync, QWORD localTime)
+{
+    LONGLONG elapsed = (LONGLONG)(localTime - sync->localRef);
+    
+    return sync->masterRef + elapsed + ((elapsed * sync->rate) >> 32);
+}
+
+/*********************************************************************
+* Function:         QWORD ClockSyncToLocal(CLOCK_SYNC *sync, QWORD masterTime)
+*
+* PreCondition:     ClockSyncInit() has been called
+*
+* Input:		    sync - the clock synchronization state
+*                   masterTime - a master time, in ns
+*
+* Output:		    QWORD - the local time, in ns
+*
+* Side Effects:	    none
+*
+* Overview:		    This function converts a master time to local time,
+*                   for example to schedule a wake up at a master time.
+*
+* Note:			    None
+********************************************************************/
+QWORD ClockSyncToLocal(CLOCK_SYNC *sync, QWORD masterTime)
+{
+    LONGLONG elapsed = (LONGLONG)(masterTime - sync->masterRef);
+    
+    return sync->localRef + elapsed - ((elapsed * sync->rate) >> 32);
+}
+
+/*********************************************************************
+* Function:         void ClockSyncSetTime(CLOCK_SYNC *sync, QWORD localTime, 
+*                                         QWORD masterTime)
+*
+* PreCondition:     ClockSyncInit() has been called
+*
+* Input:		    sync - the clock synchronization state
+*                   localTime - a local time, in ns
+*                   masterTime - the master time at localTime, in ns
+*
+* Output:		    none
+*
+* Side Effects:	    none
+*
+* Overview:		    This function sets the clock, keeping its rate.  The
+*                   master uses it to follow an external time base.
+*
+* Note:			    None
+********************************************************************/
+void ClockSyncSetTime(CLOCK_SYNC *sync, QWORD localTime, QWORD masterTime)
+{
+    sync->localRef = localTime;
+    sync->masterRef = masterTime;
+}
+
+/*********************************************************************
+* Function:         BOOL ClockSyncAddSample(CLOCK_SYNC *sync, QWORD localTime, 
+*                                           QWORD masterTime)
+*
+* PreCondition:     ClockSyncInit() has been called
+*
+* Input:		    sync - the clock synchronization state
+*                   localTime - a local time, in ns
+*                   masterTime - the master time at localTime, in ns
+*
+* Output:		    TRUE - the clock was adjusted
+*                   FALSE - the clock was set to the master time
+*
+* Side Effects:	    none
+*
+* Overview:		    This function adjusts the clock toward the master
+*                   time.  The difference between the master time and
+*                   the clock, divided by the time since the previous
+*                   sample, is the remaining rate difference.  The rate
+*                   moves by 1/2^CLOCK_SYNC_RATE_SHIFT of it, and the
+*                   clock by 1/2^CLOCK_SYNC_PHASE_SHIFT of the
+*                   difference.  A difference above
+*                   CLOCK_SYNC_STEP_THRESHOLD sets the clock instead.
+*
+* Note:			    None
+********************************************************************/
+BOOL ClockSyncAddSample(CLOCK_SYNC *sync, QWORD localTime, QWORD masterTime)
+{
+    QWORD predicted = ClockSyncToMaster(sync, localTime);
+    LONGLONG error = (LONGLONG)(masterTime - predicted);
+    LONGLONG elapsed = (LONGLONG)(localTime - sync->localRef);
+    
+    if( (error > CLOCK_SYNC_STEP_THRESHOLD) || (error < -CLOCK_SYNC_STEP_THRESHOLD) )
+    {
+        sync->localRef = localTime;
+        sync->masterRef = masterTime;
+        sync->lastError = (error > 0) ? CLOCK_SYNC_STEP_THRESHOLD : -CLOCK_SYNC_STEP_THRESHOLD;
+        sync->samples = 0;
+        sync->flags.bits.sampled = 1;
+        sync->flags.bits.locked = 0;
+        return FALSE;
+    }
+    
+    if( sync->flags.bits.sampled && (elapsed > 0) )
+    {
+        LONGLONG rate = sync->rate + (((error * 0x100000000LL) / elapsed) >> CLOCK_SYNC_RATE_SHIFT);
+        
+        if( rate > CLOCK_SYNC_MAX_RATE )
+        {
+            rate = CLOCK_SYNC_MAX_RATE;
+        }
+        else if( rate < -CLOCK_SYNC_MAX_RATE )
+        {
+            rate = -CLOCK_SYNC_MAX_RATE;
+        }
+        sync->rate = (LONG)rate;
+    }
+    
+    sync->localRef = localTime;
+    sync->masterRef = predicted + (error >> CLOCK_SYNC_PHASE_SHIFT);
+    sync->lastError = (LONG)error;
+    sync->flags.bits.sampled = 1;
+    
+    if( sync->samples < CLOCK_SYNC_LOCK_SAMPLES )
+    {
+        sync->samples++;
+    }
+    if( sync->samples >= CLOCK_SYNC_LOCK_SAMPLES )
+    {
+        sync->flags.bits.locked = 1;
+    }
+    
+    return TRUE;
+}
+
+/*********************************************************************
+* Function:         BYTE ClockSyncBuildSync(CLOCK_SYNC *sync, BYTE *buffer)
+*
+* PreCondition:     ClockSyncInit() has been called
+*
+* Input:		    sync - the clock synchronization state
+*                   buffer - buffer for CLOCK_SYNC_SYNC_SIZE bytes
+*
+* Output:		    BYTE - the size of the message
+*
+* Side Effects:	    none
+*
+* Overview:		    This function writes a SYNC message.  The time the
+*                   frame is sent goes in the FOLLOW_UP message.
+*
+* Note:			    None
+********************************************************************/
+BYTE ClockSyncBuildSync(CLOCK_SYNC *sync, BYTE *buffer)
+{
+    buffer[0] = CLOCK_SYNC_MSG_SYNC;
+    buffer[1] = sync->txSeq;
+    
+    return CLOCK_SYNC_SYNC_SIZE;
+}
+
+/*********************************************************************
+* Function:         BYTE ClockSyncBuildFollowUp(CLOCK_SYNC *sync, QWORD txTime, 
+*                                               BYTE *buffer)
+*
+* PreCondition:     The SYNC frame has been sent
+*
+* Input:		    sync - the clock synchronization state
+*                   txTime - master time the SYNC frame was sent, in ns
+*                   buffer - buffer for CLOCK_SYNC_FOLLOW_UP_SIZE bytes
+*
+* Output:		    BYTE - the size of the message
+*
+* Side Effects:	    The sequence number is incremented
+*
+* Overview:		    This function writes the FOLLOW_UP message of the
+*                   last SYNC message.
+*
+* Note:			    None
+********************************************************************/
+BYTE ClockSyncBuildFollowUp(CLOCK_SYNC *sync, QWORD txTime, BYTE *buffer)
+{
+    BYTE i;
+    
+    buffer[0] = CLOCK_SYNC_MSG_FOLLOW_UP;
+    buffer[1] = sync->txSeq++;
+    for(i = 0; i < 8; i++)
+    {
+        buffer[2+i] = (BYTE)(txTime >> (i * 8));
+    }
+    
+    return CLOCK_SYNC_FOLLOW_UP_SIZE;
+}
+
+/*********************************************************************
+* Function:         BOOL ClockSyncReceive(CLOCK_SYNC *sync, BYTE *buffer, 
+*                                         BYTE length, QWORD rxTime)
+*
+* PreCondition:     ClockSyncInit() has been called
+*
+* Input:		    sync - the clock synchronization state
+*                   buffer - the message
+*                   length - the size of the message
+*                   rxTime - local time the frame was received, in ns
+*
+* Output:		    TRUE - the message completed a sample and the clock
+*                          was adjusted
+*                   FALSE - otherwise
+*
+* Side Effects:	    none
+*
+* Overview:		    This function handles a received message.  The
+*                   receive time of a SYNC message is kept until the
+*                   FOLLOW_UP message with the same sequence number
+*                   brings the master time it was sent.
+*
+* Note:			    None
+********************************************************************/
+BOOL ClockSyncReceive(CLOCK_SYNC *sync, BYTE *buffer, BYTE length, QWORD rxTime)
+{
+    QWORD masterTime;
+    BYTE i;
+    
+    if( length < CLOCK_SYNC_SYNC_SIZE )
+    {
+        return FALSE;
+    }
+    
+    if( buffer[0] == CLOCK_SYNC_MSG_SYNC )
+    {
+        sync->rxSeq = buffer[1];
+        sync->rxTime = rxTime - CLOCK_SYNC_LATENCY;
+        sync->flags.bits.rxPending = 1;
+        return FALSE;
+    }
+    
+    if( (buffer[0] != CLOCK_SYNC_MSG_FOLLOW_UP) || (length < CLOCK_SYNC_FOLLOW_UP_SIZE) ||
+        (sync->flags.bits.rxPending == 0) || (buffer[1] != sync->rxSeq) )
+    {
+        return FALSE;
+    }
+    sync->flags.bits.rxPending = 0;
+    
+    masterTime = 0;
+    for(i = 0; i < 8; i++)
+    {
+        masterTime |= (QWORD)buffer[2+i] << (i * 8);
+    }
+    
+    return ClockSyncAddSample(sync, sync->rxTime, masterTime);
+}
+
+#endif
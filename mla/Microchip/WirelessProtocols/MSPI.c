@@ -45,6 +45,8 @@
 *  2.0   4/15/2009    yfy       MiMAC and MiApp revision
 *  3.1   5/28/2010    yfy       MiWi DE 3.1
 *  4.1   6/3/2011     yfy       MAL v2011-06
+*  4.2   10/18/2026             Add SPIPutArray and SPIGetArray, with an
+*                               optional DMA path on PIC32
 ********************************************************************/
 
 /************************ HEADERS **********************************/
@@ -441,6 +443,171 @@ BYTE SPIGet(void)
     #error Unknown processor.  See Compiler.h
 #endif
 
+#if defined(__PIC32MX__) && defined(HARDWARE_SPI) && defined(SPI_DMA_CHANNEL_TX) && defined(SPI_DMA_CHANNEL_RX)
+    #define SPI_USE_DMA
+
+    // Shorter transfers are done by the CPU, as setting up the DMA channels
+    // takes longer than sending a few bytes.
+    #if !defined(SPI_DMA_MIN_TRANSFER)
+        #define SPI_DMA_MIN_TRANSFER    8
+    #endif
+
+    /*********************************************************************
+    * Function:         static void SPITransferDMA(BYTE *txBuffer, BYTE *rxBuffer, BYTE count)
+    *
+    * PreCondition:     SPI has been configured, count > 0
+    *
+    * Input:		    txBuffer - the bytes to send
+    *                   rxBuffer - the buffer for the received bytes, NULL
+    *                              to discard them
+    *                   count - the number of bytes
+    *
+    * Output:		    none
+    *
+    * Side Effects:	    Uses DMA channels SPI_DMA_CHANNEL_TX and SPI_DMA_CHANNEL_RX
+    *
+    * Overview:		    This function sends count bytes over SPI1 with the TX
+    *                   channel, triggered by the SPI transmit interrupt, and
+    *                   reads the bytes received with the RX channel, triggered
+    *                   by the SPI receive interrupt.  It waits until the
+    *                   last byte has been received.
+    *
+    * Note:			    The RX channel runs at a higher priority, so a
+    *                   received byte is always read before the next one
+    *                   arrives.  The same buffer can be used for txBuffer and
+    *                   rxBuffer, since a byte is sent before it is overwritten.
+    ********************************************************************/
+    static void SPITransferDMA(BYTE *txBuffer, BYTE *rxBuffer, BYTE count)
+    {
+        BYTE dummy;
+
+        // Empty the receive buffer
+        while( SPI1STATbits.SPIRBF )
+        {
+            dummy = SPI1BUF;
+        }
+        SPI1STATCLR = _SPI1STAT_SPIROV_MASK;
+
+        // When the received bytes are discarded, the RX channel reads them
+        // all into one byte, re-enabling itself after each of them.
+        if( rxBuffer )
+        {
+            DmaChnOpen(SPI_DMA_CHANNEL_RX, DMA_CHN_PRI3, DMA_OPEN_DEFAULT);
+            DmaChnSetTxfer(SPI_DMA_CHANNEL_RX, (void*)&SPI1BUF, rxBuffer, 1, count, 1);
+        }
+        else
+        {
+            DmaChnOpen(SPI_DMA_CHANNEL_RX, DMA_CHN_PRI3, DMA_OPEN_AUTO);
+            DmaChnSetTxfer(SPI_DMA_CHANNEL_RX, (void*)&SPI1BUF, &dummy, 1, 1, 1);
+        }
+        DmaChnSetEventControl(SPI_DMA_CHANNEL_RX, DMA_EV_START_IRQ_EN | DMA_EV_START_IRQ(_SPI1_RX_IRQ));
+        DmaChnClrEvFlags(SPI_DMA_CHANNEL_RX, DMA_EV_ALL_EVNTS);
+
+        DmaChnOpen(SPI_DMA_CHANNEL_TX, DMA_CHN_PRI2, DMA_OPEN_DEFAULT);
+        DmaChnSetEventControl(SPI_DMA_CHANNEL_TX, DMA_EV_START_IRQ_EN | DMA_EV_START_IRQ(_SPI1_TX_IRQ));
+        DmaChnSetTxfer(SPI_DMA_CHANNEL_TX, txBuffer, (void*)&SPI1BUF, count, 1, 1);
+        DmaChnClrEvFlags(SPI_DMA_CHANNEL_TX, DMA_EV_ALL_EVNTS);
+
+        DmaChnEnable(SPI_DMA_CHANNEL_RX);
+        DmaChnStartTxfer(SPI_DMA_CHANNEL_TX, DMA_WAIT_NOT, 0);
+
+        // The TX channel finishes when the last byte is written to the
+        // buffer, so wait for the last byte to come back.  When the received
+        // bytes are discarded, wait for the transmitter to become idle
+        // instead.
+        if( rxBuffer )
+        {
+            while( (DmaChnGetEvFlags(SPI_DMA_CHANNEL_RX) & DMA_EV_BLOCK_DONE) == 0 ){}
+        }
+        else
+        {
+            while( (DmaChnGetEvFlags(SPI_DMA_CHANNEL_TX) & DMA_EV_BLOCK_DONE) == 0 ){}
+            while( SPI1STATbits.SPIBUSY || !SPI1STATbits.SPITBE ){}
+        }
+
+        DmaChnDisable(SPI_DMA_CHANNEL_TX);
+        DmaChnDisable(SPI_DMA_CHANNEL_RX);
+
+        while( SPI1STATbits.SPIRBF )
+        {
+            dummy = SPI1BUF;
+        }
+        SPI1STATCLR = _SPI1STAT_SPIROV_MASK;
+    }
+#endif
+
+/*********************************************************************
+* Function:         void SPIPutArray(BYTE *buffer, BYTE count)
+*
+* PreCondition:     SPI has been configured 
+*
+* Input:		    buffer - the bytes that need to be transfered
+*                   count - the number of bytes
+*
+* Output:		    none
+*
+* Side Effects:	    SPI transmits the bytes
+*
+* Overview:		    This function will send a block of bytes over the SPI,
+*                   without releasing the chip select between them.
+*
+* Note:			    On PIC32 with the hardware SPI, the block is sent by
+*                   DMA when SPI_DMA_CHANNEL_TX and SPI_DMA_CHANNEL_RX are
+*                   defined and it is at least SPI_DMA_MIN_TRANSFER bytes.
+********************************************************************/
+void SPIPutArray(BYTE *buffer, BYTE count)
+{
+    #if defined(SPI_USE_DMA)
+        if( count >= SPI_DMA_MIN_TRANSFER )
+        {
+            SPITransferDMA(buffer, NULL, count);
+            return;
+        }
+    #endif
+
+    while( count-- )
+    {
+        SPIPut(*buffer++);
+    }
+}
+
+/*********************************************************************
+* Function:         void SPIGetArray(BYTE *buffer, BYTE count)
+*
+* PreCondition:     SPI has been configured 
+*
+* Input:		    buffer - the buffer for the bytes received
+*                   count - the number of bytes
+*
+* Output:		    none
+*
+* Side Effects:	    SPI transmits count 0x00 bytes
+*
+* Overview:		    This function will read a block of bytes over the SPI,
+*                   without releasing the chip select between them.
+*
+* Note:			    On PIC32 with the hardware SPI, the block is read by
+*                   DMA when SPI_DMA_CHANNEL_TX and SPI_DMA_CHANNEL_RX are
+*                   defined and it is at least SPI_DMA_MIN_TRANSFER bytes.
+********************************************************************/
+void SPIGetArray(BYTE *buffer, BYTE count)
+{
+    #if defined(SPI_USE_DMA)
+        if( count >= SPI_DMA_MIN_TRANSFER )
+        {
+            // The buffer is sent as it is received, so clear it first
+            memset(buffer, 0x00, count);
+            SPITransferDMA(buffer, buffer, count);
+            return;
+        }
+    #endif
+
+    while( count-- )
+    {
+        *buffer++ = SPIGet();
+    }
+}
+
 
 
 
@@ -45,6 +45,7 @@
 *  2.1   6/20/2009    yfy       Add LCD support
 *  3.1   5/28/2010    yfy       MiWi DE 3.1
 *  4.1   6/3/2011     yfy       MAL v2011-06
+*  4.2   10/18/2026             Clock synchronization
 ********************************************************************/
 
 /************************ HEADERS **********************************/
@@ -191,6 +192,10 @@ MAC_RECEIVED_PACKET MACRxPacket;
     MIWI_TICK nvmDelayTick;
 #endif
 
+#if defined(ENABLE_CLOCK_SYNC)
+    CLOCK_SYNC ClockSync;
+#endif
+
 
 #if defined(ENABLE_TIME_SYNC)
     #if defined(ENABLE_SLEEP)
@@ -307,6 +312,11 @@ void P2PTasks(void)
         }
     #endif
 
+    #if defined(ENABLE_CLOCK_SYNC)
+        // count the high resolution timer before it rolls over
+        ClockSyncClockUpdate(&(ClockSync.clock), MiWi_HighResTickGet());
+    #endif
+
     #if defined(ENABLE_TIME_SYNC) && !defined(ENABLE_SLEEP) && defined(ENABLE_INDIRECT_MESSAGE)
         tmpTick = MiWi_TickGet();
         if( MiWi_TickGetDiff(tmpTick, TimeSyncTick) > ((ONE_SECOND) * RFD_WAKEUP_INTERVAL) )
@@ -811,6 +821,19 @@ END_OF_SENDING_INDIRECT_MESSAGE:
                 
                 
                      
+                #if defined(ENABLE_CLOCK_SYNC)
+                    case CMD_CLOCK_SYNC:
+                        #if !defined(CLOCK_SYNC_MASTER)
+                            if( rxMessage.flags.bits.secEn == 0 )
+                            {
+                                ClockSyncReceive(&ClockSync, &(rxMessage.Payload[1]), rxMessage.PayloadSize - 1, 
+                                                 ClockSyncClockTime(&(ClockSync.clock), MACRxPacket.Timestamp));
+                            }
+                        #endif
+                        MiMAC_DiscardPacket();
+                        break;
+                #endif
+                
                 #if defined(ENABLE_FREQUENCY_AGILITY) 
                     case CMD_CHANNEL_HOPPING:
                         if( rxMessage.Payload[1] != currentChannel )
@@ -894,6 +917,10 @@ BOOL MiApp_ProtocolInit(BOOL bNetworkFreezer)
     
     //clear all status bits
     P2PStatus.Val = 0;
+    
+    #if defined(ENABLE_CLOCK_SYNC)
+        ClockSyncInit(&ClockSync, HIGH_RES_TICK_FREQ, MiWi_HighResTickGet());
+    #endif
 
     for(i = 0; i < CONNECTION_SIZE; i++)
     {
@@ -2674,6 +2701,166 @@ void MiApp_ConnectionMode(INPUT BYTE Mode)
     #endif
 }
 
+
+#if defined(ENABLE_CLOCK_SYNC)
+/************************************************************************************
+ * Function:
+ *      BOOL MiApp_ClockSyncSend(void)
+ *
+ * Summary:
+ *      This function broadcasts the time of the node to the nodes around it
+ *
+ * Description:        
+ *      This function broadcasts a SYNC command frame, reads the time it was sent
+ *      from the transmit interrupt of the transceiver, and broadcasts that time
+ *      in a FOLLOW_UP command frame. The nodes that receive both frames adjust 
+ *      their clocks toward the time of this node. The master calls it 
+ *      periodically. A node whose clock follows the master can call it as well,
+ *      to pass the time on to the nodes that cannot hear the master.
+ *
+ * PreCondition:    
+ *      Protocol initialization has been done. No message is being written in
+ *      TxBuffer.
+ *
+ * Parameters: 
+ *      None
+ *
+ * Returns: 
+ *      A boolean to indicate if both frames have been sent
+ *
+ * Example:
+ *      <code>
+ *      tick = MiWi_TickGet();
+ *      if( MiWi_TickGetDiff(tick, lastSyncTick) > ONE_SECOND )
+ *      {
+ *          MiApp_ClockSyncSend();
+ *          lastSyncTick = tick;
+ *      }
+ *      </code>
+ *
+ * Remarks:    
+ *      Define CLOCK_SYNC_MASTER on the node whose clock is the time base, so that
+ *      it ignores the frames of other nodes. The frames are not secured, as the 
+ *      MRF24J40 interrupts again after decrypting a frame, which would delay the
+ *      receive timestamp.
+ *
+ *****************************************************************************************/
+BOOL MiApp_ClockSyncSend(void)
+{
+    QWORD txTime;
+    DWORD txTimestamp;
+    
+    TxData = 0;
+    MiApp_WriteData(CMD_CLOCK_SYNC);
+    TxData += ClockSyncBuildSync(&ClockSync, &(TxBuffer[TxData]));
+    #if defined(IEEE_802_15_4)
+        if( SendPacket(TRUE, myPANID, NULL, TRUE, FALSE) == FALSE )
+    #else
+        if( SendPacket(TRUE, NULL, TRUE, FALSE) == FALSE )
+    #endif
+    {
+        return FALSE;
+    }
+    
+    // the transceiver timestamps the end of the SYNC frame in its interrupt,
+    // which may come after SendPacket returns
+    if( MiMAC_GetTxTimestamp(&txTimestamp) == FALSE )
+    {
+        return FALSE;
+    }
+    txTime = ClockSyncToMaster(&ClockSync, ClockSyncClockTime(&(ClockSync.clock), txTimestamp));
+    
+    MiApp_WriteData(CMD_CLOCK_SYNC);
+    TxData += ClockSyncBuildFollowUp(&ClockSync, txTime, &(TxBuffer[TxData]));
+    #if defined(IEEE_802_15_4)
+        return SendPacket(TRUE, myPANID, NULL, TRUE, FALSE);
+    #else
+        return SendPacket(TRUE, NULL, TRUE, FALSE);
+    #endif
+}
+
+/************************************************************************************
+ * Function:
+ *      QWORD MiApp_ClockSyncGetTime(void)
+ *
+ * Summary:
+ *      This function returns the master time
+ *
+ * Description:        
+ *      This function reads the high resolution timer and returns the time of the
+ *      master, in nanoseconds. Before the first FOLLOW_UP frame is received, it 
+ *      returns the time since the protocol was initialized.
+ *
+ * PreCondition:    
+ *      Protocol initialization has been done.
+ *
+ * Parameters: 
+ *      None
+ *
+ * Returns: 
+ *      The master time in nanoseconds
+ *
+ * Example:
+ *      <code>
+ *      if( MiApp_ClockSyncIsLocked() )
+ *      {
+ *          now = MiApp_ClockSyncGetTime();
+ *      }
+ *      </code>
+ *
+ * Remarks:    
+ *      The clock counts the high resolution timer in MiApp_MessageAvailable(), 
+ *      which must be called more often than half the time the timer takes to 
+ *      roll over, or 53 seconds for the core timer of a PIC32 at 80MHz.
+ *
+ *****************************************************************************************/
+QWORD MiApp_ClockSyncGetTime(void)
+{
+    DWORD tick = MiWi_HighResTickGet();
+    
+    ClockSyncClockUpdate(&(ClockSync.clock), tick);
+    return ClockSyncToMaster(&ClockSync, ClockSyncClockTime(&(ClockSync.clock), tick));
+}
+
+/************************************************************************************
+ * Function:
+ *      void MiApp_ClockSyncSetTime(QWORD Time)
+ *
+ * Summary:
+ *      This function sets the time of the node
+ *
+ * Description:        
+ *      This function sets the clock of the node to the input time, in nanoseconds.
+ *      The master uses it to follow an external time base, such as the time 
+ *      received over Ethernet, so that the nodes that follow the master share it.
+ *
+ * PreCondition:    
+ *      Protocol initialization has been done.
+ *
+ * Parameters: 
+ *      QWORD Time -    The current time in nanoseconds
+ *
+ * Returns: 
+ *      None
+ *
+ * Example:
+ *      <code>
+ *      MiApp_ClockSyncSetTime(EthernetTime);
+ *      </code>
+ *
+ * Remarks:    
+ *      None
+ *
+ *****************************************************************************************/
+void MiApp_ClockSyncSetTime(INPUT QWORD Time)
+{
+    DWORD tick = MiWi_HighResTickGet();
+    
+    ClockSyncClockUpdate(&(ClockSync.clock), tick);
+    ClockSyncSetTime(&ClockSync, ClockSyncClockTime(&(ClockSync.clock), tick), Time);
+}
+#endif
+
 #else  // defined PROTOCOL_P2P
     /*******************************************************************
      * C18 compiler cannot compile an empty C file. define following 